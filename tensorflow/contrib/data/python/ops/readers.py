@@ -403,3 +403,43 @@ class LMDBDataset(dataset_ops.DatasetSource):
   def element_spec(self):
     return (tensor_spec.TensorSpec([], dtypes.string),
             tensor_spec.TensorSpec([], dtypes.string))
+
+
+class ArrowFileDataset(dataset_ops.DatasetSource):
+  """A dataset that reads record batches from Arrow IPC files."""
+
+  def __init__(self, filenames, columns, output_types):
+    """Creates an `ArrowFileDataset`.
+
+    Reads memory-mapped Arrow IPC files (the Arrow "file" or "Feather V2"
+    format) and yields one element per record batch: a tuple with one rank-1
+    tensor per requested column. Columns whose buffers are suitably aligned
+    are handed out zero-copy, backed by the file mapping. Only flat
+    fixed-width primitive columns (integers, floats, booleans) without nulls
+    are supported.
+
+    For example:
+    ```python
+    dataset = tf.contrib.data.ArrowFileDataset(
+        "/foo/bar.arrow",
+        columns=["label", "score"],
+        output_types=(tf.int64, tf.float32))
+    ```
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      columns: A list of strings, the names of the columns to read.
+      output_types: A list of `tf.DType` objects, one per column.
+    """
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    self._columns = columns
+    self._element_spec = tuple(
+        tensor_spec.TensorSpec([None], dtype) for dtype in output_types)
+    variant_tensor = gen_experimental_dataset_ops.arrow_file_dataset(
+        self._filenames, columns=columns, **self._flat_structure)
+    super(ArrowFileDataset, self).__init__(variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._element_spec
@@ -14,7 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/util/convert_graphdef_memmapped_format_lib.h"
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <unordered_set>
+
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/immutable_constant_op.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/memmapped_file_system_writer.h"
 
 namespace tensorflow {
@@ -131,6 +136,91 @@ class NodeConverter {
   std::unordered_set<string> used_names_;
 };
 
+// Streams the top-level fields of a binary GraphDef out of a read-only memory
+// region, so that graphs larger than protobuf's 2GB single-message limit can
+// be read.  Each field gets its own coded stream window starting at its tag,
+// so only individual fields (in practice, single NodeDefs) must fit under the
+// limit, not the whole graph.  "node_callback" is invoked on every parsed
+// node before the next one is read; converting large constants there keeps
+// peak memory at the stripped graph plus one constant, rather than the whole
+// unconverted graph.
+Status StreamGraphDefFromRegion(
+    const ReadOnlyMemoryRegion& region,
+    const std::function<Status(NodeDef*)>& node_callback,
+    GraphDef* graph_def) {
+  const uint8* data = static_cast<const uint8*>(region.data());
+  const uint64 size = region.length();
+  uint64 pos = 0;
+  while (pos < size) {
+    const int window = static_cast<int>(std::min<uint64>(
+        size - pos, std::numeric_limits<int>::max()));
+    protobuf::io::CodedInputStream stream(data + pos, window);
+    stream.SetTotalBytesLimit(std::numeric_limits<int>::max(),
+                              std::numeric_limits<int>::max());
+    const uint32 tag = stream.ReadTag();
+    const uint32 field_number = tag >> 3;
+    const uint32 wire_type = tag & 0x7;
+    bool ok = tag != 0;
+    if (ok) {
+      switch (wire_type) {
+        case 0: {  // Varint.
+          protobuf_uint64 value = 0;
+          ok = stream.ReadVarint64(&value);
+          if (ok && field_number == 3) {  // GraphDef.version (deprecated).
+            graph_def->set_version(static_cast<int32>(value));
+          }
+          break;
+        }
+        case 1:  // 64-bit.
+          ok = stream.Skip(8);
+          break;
+        case 2: {  // Length-delimited.
+          uint32 length = 0;
+          ok = stream.ReadVarint32(&length);
+          if (ok) {
+            const auto limit = stream.PushLimit(length);
+            protobuf::MessageLite* submessage = nullptr;
+            switch (field_number) {
+              case 1:  // GraphDef.node
+                submessage = graph_def->add_node();
+                break;
+              case 2:  // GraphDef.library
+                submessage = graph_def->mutable_library();
+                break;
+              case 4:  // GraphDef.versions
+                submessage = graph_def->mutable_versions();
+                break;
+            }
+            if (submessage != nullptr) {
+              ok = submessage->MergeFromCodedStream(&stream) &&
+                   stream.BytesUntilLimit() == 0;
+            } else {
+              ok = stream.Skip(length);
+            }
+            stream.PopLimit(limit);
+            if (ok && field_number == 1) {
+              TF_RETURN_IF_ERROR(node_callback(
+                  graph_def->mutable_node(graph_def->node_size() - 1)));
+            }
+          }
+          break;
+        }
+        case 5:  // 32-bit.
+          ok = stream.Skip(4);
+          break;
+        default:
+          ok = false;
+      }
+    }
+    if (!ok) {
+      return errors::DataLoss("Can't parse binary GraphDef: error at byte ",
+                              pos);
+    }
+    pos += stream.CurrentPosition();
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 // Loads the graph, replaces operators, and writes it out.
@@ -138,14 +228,6 @@ Status ConvertConstantsToImmutable(const string& in_graph_filename,
                                    const string& out_graph_filename,
                                    int min_conversion_size_bytes) {
   Env* default_env = Env::Default();
-  GraphDef graph_def;
-  const auto load_graph_status =
-      ReadBinaryProto(default_env, in_graph_filename, &graph_def);
-  if (!load_graph_status.ok()) {
-    return tensorflow::errors::NotFound(
-        "Failed to load graph at '", in_graph_filename,
-        "' : ", load_graph_status.error_message());
-  }
 
   NodeConverter node_converter;
 
@@ -153,16 +235,39 @@ Status ConvertConstantsToImmutable(const string& in_graph_filename,
   MemmappedFileSystemWriter writer;
   TF_RETURN_IF_ERROR(writer.InitializeToFile(default_env, out_graph_filename));
 
-  // Iterate over graph nodes, looking for Const and replacing it with
-  // ImmutableConst.
+  // Convert Const nodes to ImmutableConst as they are encountered.
   int convert_counter = 0;
-  for (int i = 0; i < graph_def.node_size(); ++i) {
-    const NodeDef& node = graph_def.node(i);
-    if (node.op() == "Const") {
+  auto convert_node = [&](NodeDef* node) {
+    if (node->op() == "Const") {
       // Try to convert to ImmutableConst
-      TF_RETURN_IF_ERROR(node_converter.ConvertConstantsToImmutable(
-          graph_def.mutable_node(i), &writer, &convert_counter,
-          min_conversion_size_bytes));
+      return node_converter.ConvertConstantsToImmutable(
+          node, &writer, &convert_counter, min_conversion_size_bytes);
+    }
+    return Status::OK();
+  };
+
+  GraphDef graph_def;
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  if (default_env
+          ->NewReadOnlyMemoryRegionFromFile(in_graph_filename, &region)
+          .ok()) {
+    // Stream the graph out of the mapping, converting nodes as they are
+    // parsed.  This has no 2GB limit on the overall graph size and does not
+    // hold the unconverted constants in memory all at once.
+    TF_RETURN_IF_ERROR(
+        StreamGraphDefFromRegion(*region, convert_node, &graph_def));
+  } else {
+    // Filesystems that cannot be memory-mapped fall back to a bounded
+    // whole-proto read.
+    const auto load_graph_status =
+        ReadBinaryProto(default_env, in_graph_filename, &graph_def);
+    if (!load_graph_status.ok()) {
+      return tensorflow::errors::NotFound(
+          "Failed to load graph at '", in_graph_filename,
+          "' : ", load_graph_status.error_message());
+    }
+    for (int i = 0; i < graph_def.node_size(); ++i) {
+      TF_RETURN_IF_ERROR(convert_node(graph_def.mutable_node(i)));
     }
   }
   TF_RETURN_IF_ERROR(writer.SaveProtobuf(
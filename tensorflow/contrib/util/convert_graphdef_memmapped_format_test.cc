@@ -80,6 +80,10 @@ TEST(ConvertGraphdefMemmappedFormatTest, ConvertModel) {
       &loaded_graph_def));
   ASSERT_TRUE(GraphHasImmutableConstNodes(loaded_graph_def));
 
+  // Top-level fields other than the nodes must survive the streamed parse.
+  EXPECT_EQ(loaded_graph_def.versions().producer(),
+            graph_def.versions().producer());
+
   TF_ASSERT_OK(session->Create(loaded_graph_def)) << "Can't create test graph";
   std::vector<Tensor> outputs;
   TF_ASSERT_OK(session->Run({}, {result_name + ":0"}, {}, &outputs));
@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
 #include <atomic>
+#include <unordered_set>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
@@ -26,9 +28,110 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+// ----------------------------------------------------------------------------
+// Per-thread small-chunk cache
+// ----------------------------------------------------------------------------
+//
+// When TF_BFC_THREAD_CACHE_BYTES is positive, small freed chunks are parked in
+// a per-thread, per-allocator cache and handed back to later requests that
+// round to the same chunk size, skipping lock_ entirely on the fast path. A
+// ledger of live thread-cached allocations (sharded by pointer) decides on
+// free whether a pointer takes the fast path; whichever thread frees a pointer
+// consumes its ledger entry, so a chunk allocated on one thread and freed on
+// another simply migrates to the freeing thread's cache.
+//
+// Chunks parked in a cache remain allocated from the central allocator's
+// point of view: RequestedSize() and AllocationId() report the values from
+// the chunk's first central allocation, and bytes_in_use includes parked
+// bytes, bounded by the per-thread capacity. A cache flushes back to the
+// central pool in one batched lock_ acquisition when it overflows, when its
+// thread exits, or when a central allocation on its thread fails.
+//
+// Allocators that use timestamped chunks (SetTimingCounter) never use the
+// cache, since reuse without a fresh freed_at_count would break the stream
+// safety the timestamps provide.
+
+namespace {
+
+struct BFCThreadCache {
+  // Keyed by exact rounded chunk size; a parked pointer is only returned for
+  // requests that round to the same size.
+  absl::flat_hash_map<size_t, std::vector<void*>> bins;
+  size_t total_bytes = 0;
+};
+
+}  // namespace
+
+// Holds one thread's caches, one per allocator. Instances register in a
+// global set so ~BFCAllocator can purge its entries from every thread; the
+// registry lock also serializes thread-exit flushes against allocator
+// destruction, which guarantees that any allocator still present in a map is
+// alive when the map flushes to it.
+class BFCThreadCacheMap {
+ public:
+  BFCThreadCacheMap() {
+    mutex_lock l(*registry_lock());
+    registry()->insert(this);
+  }
+
+  ~BFCThreadCacheMap() {
+    mutex_lock rl(*registry_lock());
+    registry()->erase(this);
+    mutex_lock l(mu);
+    for (auto& entry : caches) {
+      std::vector<void*> ptrs;
+      for (auto& bin : entry.second.bins) {
+        ptrs.insert(ptrs.end(), bin.second.begin(), bin.second.end());
+      }
+      entry.first->ReturnThreadCacheChunks(ptrs);
+    }
+  }
+
+  // Removes (and frees back to the allocator) every entry for the given
+  // allocator across all threads. Called from ~BFCAllocator.
+  static void PurgeAllocator(BFCAllocator* allocator) {
+    mutex_lock rl(*registry_lock());
+    for (BFCThreadCacheMap* map : *registry()) {
+      std::vector<void*> ptrs;
+      {
+        mutex_lock l(map->mu);
+        auto it = map->caches.find(allocator);
+        if (it == map->caches.end()) continue;
+        for (auto& bin : it->second.bins) {
+          ptrs.insert(ptrs.end(), bin.second.begin(), bin.second.end());
+        }
+        map->caches.erase(it);
+      }
+      allocator->ReturnThreadCacheChunks(ptrs);
+    }
+  }
+
+  static BFCThreadCacheMap* GetForThisThread() {
+    static thread_local BFCThreadCacheMap map;
+    return &map;
+  }
+
+  // Almost always uncontended: taken by the owning thread on the fast path
+  // and by PurgeAllocator when an allocator is destroyed.
+  mutex mu;
+  absl::flat_hash_map<BFCAllocator*, BFCThreadCache> caches GUARDED_BY(mu);
+
+ private:
+  static mutex* registry_lock() {
+    static mutex lock(LINKER_INITIALIZED);
+    return &lock;
+  }
+  static std::unordered_set<BFCThreadCacheMap*>* registry() {
+    static auto* maps = new std::unordered_set<BFCThreadCacheMap*>;
+    return maps;
+  }
+};
+
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
                            bool garbage_collection,
@@ -77,6 +180,10 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
 }
 
 BFCAllocator::~BFCAllocator() {
+  if (ThreadCacheCapacityBytes() > 0) {
+    BFCThreadCacheMap::PurgeAllocator(this);
+  }
+
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -232,8 +339,166 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
 }
 
+size_t BFCAllocator::ThreadCacheCapacityBytes() {
+  static const size_t capacity = [] {
+    int64 bytes;
+    Status s = ReadInt64FromEnvVar("TF_BFC_THREAD_CACHE_BYTES", 0, &bytes);
+    if (!s.ok() || bytes < 0) {
+      return size_t{0};
+    }
+    return static_cast<size_t>(bytes);
+  }();
+  return capacity;
+}
+
+bool BFCAllocator::ThreadCacheEligible(
+    size_t num_bytes, const AllocationAttributes& allocation_attr) const {
+  return ThreadCacheCapacityBytes() > 0 && timing_counter_ == nullptr &&
+         num_bytes > 0 && num_bytes <= kThreadCacheMaxChunkBytes &&
+         allocation_attr.freed_by_func == nullptr;
+}
+
+void BFCAllocator::LiveAllocInsert(const void* ptr, size_t rounded_bytes) {
+  LiveThreadCacheAllocShard& shard = LiveAllocShard(ptr);
+  mutex_lock l(shard.mu);
+  shard.sizes[ptr] = rounded_bytes;
+}
+
+bool BFCAllocator::LiveAllocErase(const void* ptr, size_t* rounded_bytes) {
+  LiveThreadCacheAllocShard& shard = LiveAllocShard(ptr);
+  mutex_lock l(shard.mu);
+  auto it = shard.sizes.find(ptr);
+  if (it == shard.sizes.end()) {
+    return false;
+  }
+  *rounded_bytes = it->second;
+  shard.sizes.erase(it);
+  return true;
+}
+
+void* BFCAllocator::ThreadCacheAllocate(size_t rounded_bytes) {
+  BFCThreadCacheMap* map = BFCThreadCacheMap::GetForThisThread();
+  mutex_lock l(map->mu);
+  auto cache_it = map->caches.find(this);
+  if (cache_it == map->caches.end()) {
+    return nullptr;
+  }
+  auto bin_it = cache_it->second.bins.find(rounded_bytes);
+  if (bin_it == cache_it->second.bins.end() || bin_it->second.empty()) {
+    return nullptr;
+  }
+  void* ptr = bin_it->second.back();
+  bin_it->second.pop_back();
+  cache_it->second.total_bytes -= rounded_bytes;
+  return ptr;
+}
+
+bool BFCAllocator::ThreadCacheDeallocate(void* ptr) {
+  if (ThreadCacheCapacityBytes() == 0) {
+    return false;
+  }
+  size_t rounded_bytes;
+  if (!LiveAllocErase(ptr, &rounded_bytes)) {
+    return false;
+  }
+  if (timing_counter_ != nullptr) {
+    // A timing counter was installed after this allocation was made; the
+    // chunk needs a fresh timestamp, so free it centrally.
+    return false;
+  }
+  BFCThreadCacheMap* map = BFCThreadCacheMap::GetForThisThread();
+  std::vector<void*> overflow;
+  {
+    mutex_lock l(map->mu);
+    BFCThreadCache& cache = map->caches[this];
+    cache.bins[rounded_bytes].push_back(ptr);
+    cache.total_bytes += rounded_bytes;
+    if (cache.total_bytes > ThreadCacheCapacityBytes()) {
+      for (auto& bin : cache.bins) {
+        overflow.insert(overflow.end(), bin.second.begin(), bin.second.end());
+      }
+      cache.bins.clear();
+      cache.total_bytes = 0;
+    }
+  }
+  if (!overflow.empty()) {
+    ReturnThreadCacheChunks(overflow);
+    retry_helper_.NotifyDealloc();
+  }
+  return true;
+}
+
+void BFCAllocator::FlushThreadCache() {
+  BFCThreadCacheMap* map = BFCThreadCacheMap::GetForThisThread();
+  std::vector<void*> ptrs;
+  {
+    mutex_lock l(map->mu);
+    auto it = map->caches.find(this);
+    if (it == map->caches.end()) {
+      return;
+    }
+    for (auto& bin : it->second.bins) {
+      ptrs.insert(ptrs.end(), bin.second.begin(), bin.second.end());
+    }
+    map->caches.erase(it);
+  }
+  if (!ptrs.empty()) {
+    ReturnThreadCacheChunks(ptrs);
+    retry_helper_.NotifyDealloc();
+  }
+}
+
+void BFCAllocator::ReturnThreadCacheChunks(const std::vector<void*>& ptrs) {
+  if (ptrs.empty()) {
+    return;
+  }
+  mutex_lock l(lock_);
+  for (void* ptr : ptrs) {
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    MarkFree(h);
+    if (timing_counter_) {
+      InsertFreeChunkIntoBin(h);
+      timestamped_chunks_.push_back(h);
+    } else {
+      InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+    }
+  }
+}
+
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
+  const bool use_thread_cache =
+      ThreadCacheEligible(num_bytes, allocation_attr);
+  size_t rounded_bytes = 0;
+  if (use_thread_cache) {
+    rounded_bytes = RoundedBytes(num_bytes);
+    void* cached = ThreadCacheAllocate(rounded_bytes);
+    if (cached != nullptr) {
+      VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes
+              << " (thread cache)";
+      LiveAllocInsert(cached, rounded_bytes);
+      return cached;
+    }
+  }
+
+  void* result = AllocateRawCentral(unused_alignment, num_bytes,
+                                    allocation_attr);
+  if (result == nullptr && ThreadCacheCapacityBytes() > 0) {
+    // Memory parked in this thread's cache may be what the central pool is
+    // missing; other threads' caches are bounded but unreachable from here.
+    FlushThreadCache();
+    result = AllocateRawCentral(unused_alignment, num_bytes, allocation_attr);
+  }
+  if (use_thread_cache && result != nullptr) {
+    LiveAllocInsert(result, rounded_bytes);
+  }
+  return result;
+}
+
+void* BFCAllocator::AllocateRawCentral(
+    size_t unused_alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
   if (allocation_attr.no_retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
@@ -544,6 +809,11 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 }
 
 void BFCAllocator::DeallocateRaw(void* ptr) {
+  if (ptr != nullptr && ThreadCacheDeallocate(ptr)) {
+    // Parked in the calling thread's cache; nothing became visible to waiters
+    // on the central pool, so there is no deallocation to notify about.
+    return;
+  }
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
   DeallocateRawInternal(ptr);
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -84,6 +85,8 @@ class BFCAllocator : public Allocator {
  private:
   struct Bin;
 
+  friend class BFCThreadCacheMap;
+
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
                             uint64 freed_before_count);
@@ -92,8 +95,73 @@ class BFCAllocator : public Allocator {
       size_t alignment, size_t num_bytes,
       const AllocationAttributes& allocation_attr);
 
+  // The pre-thread-cache AllocateRaw path: takes lock_ and allocates from the
+  // central pool, retrying (or not) per allocation_attr.
+  void* AllocateRawCentral(size_t alignment, size_t num_bytes,
+                           const AllocationAttributes& allocation_attr);
+
   void DeallocateRawInternal(void* ptr);
 
+  // ----- Per-thread small-chunk cache -----
+  //
+  // When TF_BFC_THREAD_CACHE_BYTES is set to a positive value, each thread
+  // keeps up to that many bytes of recently freed small chunks per allocator
+  // and serves matching allocation requests from them without taking lock_,
+  // the way tcmalloc fronts its central heap with thread caches. See the
+  // implementation comment in bfc_allocator.cc for the exact semantics and
+  // caveats.
+
+  // Per-thread cache capacity in bytes; 0 disables the cache entirely.
+  static size_t ThreadCacheCapacityBytes();
+
+  // Largest request (pre-rounding) the thread cache will serve. Larger
+  // allocations always go through the central pool.
+  static const size_t kThreadCacheMaxChunkBytes = 16 * 1024;
+
+  // Returns true if this request may be served by (and later returned to) the
+  // calling thread's cache.
+  bool ThreadCacheEligible(size_t num_bytes,
+                           const AllocationAttributes& allocation_attr) const;
+
+  // Pops a cached chunk of exactly rounded_bytes from the calling thread's
+  // cache, or returns nullptr on a cache miss.
+  void* ThreadCacheAllocate(size_t rounded_bytes);
+
+  // Routes ptr into the calling thread's cache if it is a live thread-cached
+  // allocation; returns false if the pointer must be freed centrally.
+  bool ThreadCacheDeallocate(void* ptr);
+
+  // Returns everything in the calling thread's cache for this allocator to
+  // the central pool.
+  void FlushThreadCache();
+
+  // Frees a batch of thread-cached chunks back into the central pool under a
+  // single lock_ acquisition.
+  void ReturnThreadCacheChunks(const std::vector<void*>& ptrs);
+
+  // Ledger of live allocations that were served through the thread cache
+  // path, keyed by pointer. Sharded so that the (very short) critical
+  // sections on the fast path don't all contend on one mutex. An entry exists
+  // exactly while the allocation is live; whichever thread frees the pointer
+  // consumes the entry, so cross-thread frees are handled by transferring the
+  // chunk to the freeing thread's cache.
+  struct LiveThreadCacheAllocShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, size_t> sizes GUARDED_BY(mu);
+  };
+  static const int kNumLiveThreadCacheAllocShards = 16;
+  LiveThreadCacheAllocShard& LiveAllocShard(const void* ptr) {
+    // Chunk pointers are at least min-allocation aligned, so drop the low
+    // bits before sharding.
+    return live_thread_cache_allocs_[(reinterpret_cast<uintptr_t>(ptr) >> 8) %
+                                     kNumLiveThreadCacheAllocShards];
+  }
+  void LiveAllocInsert(const void* ptr, size_t rounded_bytes);
+  bool LiveAllocErase(const void* ptr, size_t* rounded_bytes);
+
+  std::array<LiveThreadCacheAllocShard, kNumLiveThreadCacheAllocShards>
+      live_thread_cache_allocs_;
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
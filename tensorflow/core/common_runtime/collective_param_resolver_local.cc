@@ -297,10 +297,10 @@ void OrderTaskDeviceMap(const string& gpu_ring_order, TaskDeviceMap* tdm) {
     if (selected.size() == tdm->size()) {
       break;
     }
-    // For the present time we assume Locality links only cover GPUs.
-    // For multiple CPUs, just take them in order.
+    // For the present time we assume Locality links only cover GPUs and DML
+    // devices.  For multiple CPUs, just take them in order.
     const InterconnectLink* best_link = nullptr;
-    if (parsed_name.type == "GPU") {
+    if (parsed_name.type == "GPU" || parsed_name.type == "DML") {
       for (const InterconnectLink& il : dr->locality->links().link()) {
         parsed_name.id = il.device_id();
         string endpoint_device =
@@ -93,6 +93,17 @@ class Device : public DeviceBase {
     op_kernel->ComputeAsync(context, std::move(done));
   }
 
+  // Called by executors around a run of ops dispatched back-to-back to this
+  // device, and by function-call kernels around the nested executor that runs
+  // the callee. Devices which batch submitted work (e.g. DML) can use these
+  // to align their internal submission boundaries with the structure of the
+  // executing graph instead of relying purely on timing heuristics. Runs may
+  // overlap across threads, and a run may end on a different thread than it
+  // began on (e.g. in a function call's done callback); every BeginOpRun is
+  // paired with exactly one EndOpRun.
+  virtual void BeginOpRun() {}
+  virtual void EndOpRun() {}
+
   // Takes ownership of the references in tensors. If necessary, a
   // device may override this method to keep a reference to the
   // accessed tensors until the async computation has completed.
@@ -211,6 +222,25 @@ class Device : public DeviceBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Device);
 };
 
+// Keeps a device's op-run bracket (see Device::BeginOpRun) open for the
+// lifetime of this object. The executor holds one around each inline run of
+// ops, and function-call kernels hold one for the duration of the call so
+// that the callee's nested executor extends the caller's run instead of
+// introducing a submission boundary at the function call.
+class ScopedOpRun {
+ public:
+  explicit ScopedOpRun(Device* device) : device_(device) {
+    device_->BeginOpRun();
+  }
+  ~ScopedOpRun() { device_->EndOpRun(); }
+
+  ScopedOpRun(const ScopedOpRun&) = delete;
+  ScopedOpRun& operator=(const ScopedOpRun&) = delete;
+
+ private:
+  Device* const device_;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/direct_session.h"
 
 #include <atomic>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
+#include "tensorflow/core/common_runtime/kernel_warmup_registry.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
@@ -440,9 +442,7 @@ Status DirectSession::ExtendLocked(GraphDef graph) {
   } else {
     TF_RETURN_IF_ERROR(flib_def_->AddLibrary(graph.library()));
     std::unique_ptr<GraphExecutionState> state;
-    // TODO(mrry): Rewrite GraphExecutionState::Extend() to take `graph` by
-    // value and move `graph` in here.
-    TF_RETURN_IF_ERROR(execution_state_->Extend(graph, &state));
+    TF_RETURN_IF_ERROR(execution_state_->Extend(std::move(graph), &state));
     execution_state_.swap(state);
   }
   return Status::OK();
@@ -881,6 +881,40 @@ Status DirectSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+Status DirectSession::WarmupKernels(
+    const std::vector<std::pair<string, TensorShape>>& feed_shapes,
+    const std::vector<string>& output_names,
+    const std::vector<string>& target_nodes) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  TF_RETURN_IF_ERROR(CheckGraphCreated("WarmupKernels()"));
+
+  std::vector<string> input_names;
+  input_names.reserve(feed_shapes.size());
+  std::map<string, TensorShape> feeds;
+  for (const auto& feed : feed_shapes) {
+    input_names.push_back(feed.first);
+    feeds.emplace(feed.first, feed.second);
+  }
+
+  // Creating the executors here is itself part of the warmup: it takes graph
+  // partitioning and OpKernel creation off the first Run's critical path.
+  ExecutorsAndKeys* executors_and_keys;
+  DebugOptions debug_options;
+  RunStateArgs run_state_args(debug_options);
+  TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_names, output_names,
+                                          target_nodes, &executors_and_keys,
+                                          &run_state_args));
+
+  for (const PerPartitionExecutorsAndLib& item : executors_and_keys->items) {
+    const KernelWarmupRegistry::WarmupFn* warmup_fn =
+        KernelWarmupRegistry::Lookup(item.device->device_type());
+    if (warmup_fn != nullptr) {
+      TF_RETURN_IF_ERROR((*warmup_fn)(item.device, *item.graph, feeds));
+    }
+  }
+  return Status::OK();
+}
+
 Status DirectSession::PRunSetup(const std::vector<string>& input_names,
                                 const std::vector<string>& output_names,
                                 const std::vector<string>& target_nodes,
@@ -94,6 +94,18 @@ class DirectSession : public Session {
                             const std::vector<string>& output_names,
                             std::vector<Tensor>* outputs) override;
 
+  // Pre-builds ("warms up") device kernels for the subgraphs that a Run call
+  // with the given signature would execute, so that the first Run after
+  // process start doesn't pay for lazy kernel compilation. `feed_shapes`
+  // names the tensors that will later be fed, exactly as they will be passed
+  // to Run, together with the shapes that will be fed; nodes whose shapes
+  // can't be derived from these are skipped and compile lazily as before.
+  // Only devices with a registered warmup function (currently DML) take part.
+  ::tensorflow::Status WarmupKernels(
+      const std::vector<std::pair<string, TensorShape>>& feed_shapes,
+      const std::vector<string>& output_names,
+      const std::vector<string>& target_nodes);
+
   // Reset clears 'containers' from the device_mgr of the DirectSession.
   // If 'containers' is empty, then Reset clears the default container.
   ::tensorflow::Status Reset(const std::vector<string>& containers);
@@ -45,6 +45,10 @@ uint64_t DmlAdapter::QueryAvailableLocalMemory() const {
   return impl_->QueryAvailableLocalMemory();
 }
 
+DmlAdapterMemoryInfo DmlAdapter::QueryMemoryInfo() const {
+  return impl_->QueryMemoryInfo();
+}
+
 const char* GetVendorName(VendorID id) {
   switch (id) {
     case VendorID::kAmd:
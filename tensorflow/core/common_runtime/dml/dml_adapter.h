@@ -72,6 +72,14 @@ enum class VendorID {
   kIntel = 0x8086,
 };
 
+// Snapshot of the OS-reported video memory state for an adapter's local
+// segment group, as reported by DXGI/DXCore. The budget may change at any time
+// as other processes claim or release memory.
+struct DmlAdapterMemoryInfo {
+  uint64_t budget;         // bytes this process should stay within
+  uint64_t current_usage;  // bytes currently used by this process
+};
+
 // Use a pimpl to firewall DML/D3D-specific headers from the rest of TF.
 class DmlAdapterImpl;
 
@@ -91,6 +99,7 @@ class DmlAdapter {
   uint64_t GetTotalDedicatedMemory() const;
   uint64_t GetTotalSharedMemory() const;
   uint64_t QueryAvailableLocalMemory() const;
+  DmlAdapterMemoryInfo QueryMemoryInfo() const;
 
  private:
   // This object is immutable, so this is shared to allow copies.
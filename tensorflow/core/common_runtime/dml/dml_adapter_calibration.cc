@@ -0,0 +1,485 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_adapter_calibration.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/dml/dml_adapter_impl.h"
+#include "tensorflow/core/common_runtime/dml/dml_common.h"
+#include "tensorflow/core/common_runtime/dml/dml_gpu_event.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace tensorflow {
+namespace {
+
+// Probe shape and repetition count. A 1024^3 fp32 GEMM is ~2.1 GFLOP, large
+// enough to saturate any adapter's ALUs yet small enough (12MB of buffers)
+// to fit on anything DirectML supports; eight timed dispatches keep the
+// measured interval well above timer resolution even on fast parts (~2ms on
+// a 10 TFLOPS adapter) without stalling startup on slow ones (~270ms at
+// 0.5 TFLOPS).
+constexpr uint32_t kGemmDim = 1024;
+constexpr uint32_t kTimedIterations = 8;
+
+// The score file is two lines: a format-version header and the measured
+// GFLOPS in decimal.
+constexpr const char* kCalibrationHeader = "tfdml-calibration-v1";
+
+// The adapter/driver identity is baked into the filename, so a driver
+// upgrade or a different adapter naturally invalidates the cached score (the
+// same scheme DmlPersistentKernelCache uses for its manifests).
+string CalibrationFileName(const DmlAdapter& adapter) {
+  DriverVersion driver = adapter.DriverVersion();
+  return strings::StrCat(
+      "dml_calibration_",
+      strings::Hex(static_cast<uint32>(adapter.VendorID())), "_",
+      strings::Hex(adapter.DeviceID()), "_", driver.parts.a, ".",
+      driver.parts.b, ".", driver.parts.c, ".", driver.parts.d, ".txt");
+}
+
+string CalibrationDirectory() {
+  const char* dir = getenv("TF_DIRECTML_CALIBRATION_CACHE_PATH");
+  if (dir && *dir) {
+    return dir;
+  }
+  std::vector<string> temp_dirs;
+  Env::Default()->GetLocalTempDirectories(&temp_dirs);
+  return temp_dirs.empty() ? string() : temp_dirs[0];
+}
+
+absl::optional<double> ReadCachedScore(const string& path) {
+  string contents;
+  if (!ReadFileToString(Env::Default(), path, &contents).ok()) {
+    return absl::nullopt;
+  }
+
+  std::vector<absl::string_view> lines =
+      str_util::Split(contents, '\n', str_util::SkipWhitespace());
+  double gflops;
+  if (lines.size() < 2 || lines[0] != kCalibrationHeader ||
+      !strings::safe_strtod(lines[1], &gflops) || gflops <= 0.0) {
+    return absl::nullopt;
+  }
+  return gflops;
+}
+
+void WriteCachedScore(const string& path, double gflops) {
+  string contents =
+      strings::StrCat(kCalibrationHeader, "\n", gflops, "\n");
+
+  // Write-then-rename so a crash mid-save never leaves a truncated file.
+  string tmp_path = strings::StrCat(path, ".tmp");
+  Status s = WriteStringToFile(Env::Default(), tmp_path, contents);
+  if (s.ok()) {
+    s = Env::Default()->RenameFile(tmp_path, path);
+  }
+  if (!s.ok()) {
+    VLOG(1) << "DirectML: could not cache calibration score at '" << path
+            << "': " << s;
+  }
+}
+
+// Runs the GEMM probe on a throwaway device. Every D3D/DML call is checked
+// and failure reported as nullopt rather than aborting: an adapter that can't
+// run the probe shouldn't take the process down, it should just keep its
+// enumerated position.
+absl::optional<double> RunGemmProbe(const DmlAdapter& adapter) {
+  D3D_FEATURE_LEVEL feature_level = adapter.IsComputeOnly()
+                                        ? D3D_FEATURE_LEVEL_1_0_CORE
+                                        : D3D_FEATURE_LEVEL_11_0;
+
+  ComPtr<ID3D12Device> d3d_device;
+  if (FAILED(D3D12CreateDevice(adapter.Impl()->Get(), feature_level,
+                               IID_PPV_ARGS(&d3d_device)))) {
+    return absl::nullopt;
+  }
+
+  ComPtr<IDMLDevice> dml_device =
+      TryCreateDmlDevice(d3d_device.Get(), DML_CREATE_DEVICE_FLAG_NONE);
+  if (!dml_device) {
+    return absl::nullopt;
+  }
+
+  // Compile a square fp32 GEMM.
+  uint32_t sizes[4] = {1, 1, kGemmDim, kGemmDim};
+
+  DML_BUFFER_TENSOR_DESC buffer_tensor_desc = {};
+  buffer_tensor_desc.DataType = DML_TENSOR_DATA_TYPE_FLOAT32;
+  buffer_tensor_desc.Flags = DML_TENSOR_FLAG_NONE;
+  buffer_tensor_desc.DimensionCount = 4;
+  buffer_tensor_desc.Sizes = sizes;
+  buffer_tensor_desc.Strides = nullptr;
+  buffer_tensor_desc.TotalTensorSizeInBytes =
+      DMLCalcBufferTensorSize(DML_TENSOR_DATA_TYPE_FLOAT32, 4, sizes, nullptr);
+  buffer_tensor_desc.GuaranteedBaseOffsetAlignment = 0;
+
+  DML_TENSOR_DESC tensor_desc = {DML_TENSOR_TYPE_BUFFER, &buffer_tensor_desc};
+
+  DML_GEMM_OPERATOR_DESC gemm_desc = {};
+  gemm_desc.ATensor = &tensor_desc;
+  gemm_desc.BTensor = &tensor_desc;
+  gemm_desc.CTensor = nullptr;
+  gemm_desc.OutputTensor = &tensor_desc;
+  gemm_desc.TransA = DML_MATRIX_TRANSFORM_NONE;
+  gemm_desc.TransB = DML_MATRIX_TRANSFORM_NONE;
+  gemm_desc.Alpha = 1.0f;
+  gemm_desc.Beta = 0.0f;
+  gemm_desc.FusedActivation = nullptr;
+
+  DML_OPERATOR_DESC op_desc = {DML_OPERATOR_GEMM, &gemm_desc};
+
+  ComPtr<IDMLOperator> op;
+  if (FAILED(dml_device->CreateOperator(&op_desc, IID_PPV_ARGS(&op)))) {
+    return absl::nullopt;
+  }
+
+  ComPtr<IDMLCompiledOperator> compiled_op;
+  if (FAILED(dml_device->CompileOperator(op.Get(), DML_EXECUTION_FLAG_NONE,
+                                         IID_PPV_ARGS(&compiled_op)))) {
+    return absl::nullopt;
+  }
+
+  IDMLCompiledOperator* compiled_ops[] = {compiled_op.Get()};
+  ComPtr<IDMLOperatorInitializer> initializer;
+  if (FAILED(dml_device->CreateOperatorInitializer(
+          1, compiled_ops, IID_PPV_ARGS(&initializer)))) {
+    return absl::nullopt;
+  }
+
+  DML_BINDING_PROPERTIES init_props = initializer->GetBindingProperties();
+  DML_BINDING_PROPERTIES exec_props = compiled_op->GetBindingProperties();
+
+  // A COMPUTE-type queue works on both graphics-capable and compute-only
+  // adapters.
+  D3D12_COMMAND_QUEUE_DESC queue_desc = {};
+  queue_desc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+
+  ComPtr<ID3D12CommandQueue> queue;
+  ComPtr<ID3D12CommandAllocator> command_allocator;
+  ComPtr<ID3D12GraphicsCommandList> command_list;
+  ComPtr<ID3D12Fence> fence;
+  if (FAILED(d3d_device->CreateCommandQueue(&queue_desc,
+                                            IID_PPV_ARGS(&queue))) ||
+      FAILED(d3d_device->CreateCommandAllocator(
+          D3D12_COMMAND_LIST_TYPE_COMPUTE,
+          IID_PPV_ARGS(&command_allocator))) ||
+      FAILED(d3d_device->CreateCommandList(
+          0, D3D12_COMMAND_LIST_TYPE_COMPUTE, command_allocator.Get(), nullptr,
+          IID_PPV_ARGS(&command_list))) ||
+      FAILED(d3d_device->CreateFence(0, D3D12_FENCE_FLAG_NONE,
+                                     IID_PPV_ARGS(&fence)))) {
+    return absl::nullopt;
+  }
+
+  uint64_t fence_value = 0;
+  auto execute_and_wait = [&]() -> bool {
+    if (FAILED(command_list->Close())) {
+      return false;
+    }
+    ID3D12CommandList* lists[] = {command_list.Get()};
+    queue->ExecuteCommandLists(1, lists);
+    ++fence_value;
+    if (FAILED(queue->Signal(fence.Get(), fence_value))) {
+      return false;
+    }
+    DmlGpuEvent{fence_value, fence}.WaitForSignal();
+    return SUCCEEDED(command_allocator->Reset()) &&
+           SUCCEEDED(command_list->Reset(command_allocator.Get(), nullptr));
+  };
+
+  // A, B and the output plus whatever scratch the operator asks for. D3D12
+  // zeroes new heaps, so the inputs multiply zeros — fine for a throughput
+  // probe, and free of denormal or NaN slow paths.
+  auto create_buffer = [&](uint64_t size) -> ComPtr<ID3D12Resource> {
+    ComPtr<ID3D12Resource> buffer;
+    CD3DX12_HEAP_PROPERTIES heap_props(D3D12_HEAP_TYPE_DEFAULT);
+    CD3DX12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Buffer(
+        size, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    if (FAILED(d3d_device->CreateCommittedResource(
+            &heap_props, D3D12_HEAP_FLAG_NONE, &resource_desc,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+            IID_PPV_ARGS(&buffer)))) {
+      return nullptr;
+    }
+    return buffer;
+  };
+
+  const uint64_t tensor_bytes = buffer_tensor_desc.TotalTensorSizeInBytes;
+  ComPtr<ID3D12Resource> buffer_a = create_buffer(tensor_bytes);
+  ComPtr<ID3D12Resource> buffer_b = create_buffer(tensor_bytes);
+  ComPtr<ID3D12Resource> buffer_out = create_buffer(tensor_bytes);
+  if (!buffer_a || !buffer_b || !buffer_out) {
+    return absl::nullopt;
+  }
+
+  const uint64_t temp_bytes = std::max(init_props.TemporaryResourceSize,
+                                       exec_props.TemporaryResourceSize);
+  ComPtr<ID3D12Resource> buffer_temp;
+  if (temp_bytes > 0) {
+    buffer_temp = create_buffer(temp_bytes);
+    if (!buffer_temp) {
+      return absl::nullopt;
+    }
+  }
+
+  ComPtr<ID3D12Resource> buffer_persistent;
+  if (exec_props.PersistentResourceSize > 0) {
+    buffer_persistent = create_buffer(exec_props.PersistentResourceSize);
+    if (!buffer_persistent) {
+      return absl::nullopt;
+    }
+  }
+
+  const uint32_t descriptor_count = std::max(
+      1u, std::max(init_props.RequiredDescriptorCount,
+                   exec_props.RequiredDescriptorCount));
+
+  D3D12_DESCRIPTOR_HEAP_DESC descriptor_heap_desc = {};
+  descriptor_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+  descriptor_heap_desc.NumDescriptors = descriptor_count;
+  descriptor_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+  ComPtr<ID3D12DescriptorHeap> descriptor_heap;
+  if (FAILED(d3d_device->CreateDescriptorHeap(
+          &descriptor_heap_desc, IID_PPV_ARGS(&descriptor_heap)))) {
+    return absl::nullopt;
+  }
+
+  DML_BINDING_TABLE_DESC binding_table_desc = {};
+  binding_table_desc.Dispatchable = initializer.Get();
+  binding_table_desc.CPUDescriptorHandle =
+      descriptor_heap->GetCPUDescriptorHandleForHeapStart();
+  binding_table_desc.GPUDescriptorHandle =
+      descriptor_heap->GetGPUDescriptorHandleForHeapStart();
+  binding_table_desc.SizeInDescriptors = descriptor_count;
+
+  ComPtr<IDMLBindingTable> binding_table;
+  if (FAILED(dml_device->CreateBindingTable(&binding_table_desc,
+                                            IID_PPV_ARGS(&binding_table)))) {
+    return absl::nullopt;
+  }
+
+  ComPtr<IDMLCommandRecorder> recorder;
+  if (FAILED(dml_device->CreateCommandRecorder(IID_PPV_ARGS(&recorder)))) {
+    return absl::nullopt;
+  }
+
+  // Initialize the operator.
+  if (init_props.TemporaryResourceSize > 0) {
+    DML_BUFFER_BINDING temp_binding = {buffer_temp.Get(), 0,
+                                       init_props.TemporaryResourceSize};
+    DML_BINDING_DESC temp_desc = {DML_BINDING_TYPE_BUFFER, &temp_binding};
+    binding_table->BindTemporaryResource(&temp_desc);
+  }
+  if (exec_props.PersistentResourceSize > 0) {
+    // The initializer writes the persistent resource as its output.
+    DML_BUFFER_BINDING persistent_binding = {
+        buffer_persistent.Get(), 0, exec_props.PersistentResourceSize};
+    DML_BINDING_DESC persistent_desc = {DML_BINDING_TYPE_BUFFER,
+                                        &persistent_binding};
+    binding_table->BindOutputs(1, &persistent_desc);
+  }
+
+  ID3D12DescriptorHeap* heaps[] = {descriptor_heap.Get()};
+  command_list->SetDescriptorHeaps(1, heaps);
+  recorder->RecordDispatch(command_list.Get(), initializer.Get(),
+                           binding_table.Get());
+  if (!execute_and_wait()) {
+    return absl::nullopt;
+  }
+
+  // Rebind the table to the compiled operator for execution.
+  binding_table_desc.Dispatchable = compiled_op.Get();
+  if (FAILED(binding_table->Reset(&binding_table_desc))) {
+    return absl::nullopt;
+  }
+
+  DML_BUFFER_BINDING a_binding = {buffer_a.Get(), 0, tensor_bytes};
+  DML_BUFFER_BINDING b_binding = {buffer_b.Get(), 0, tensor_bytes};
+  DML_BINDING_DESC input_bindings[3] = {
+      {DML_BINDING_TYPE_BUFFER, &a_binding},
+      {DML_BINDING_TYPE_BUFFER, &b_binding},
+      {DML_BINDING_TYPE_NONE, nullptr},  // no C tensor
+  };
+  binding_table->BindInputs(3, input_bindings);
+
+  DML_BUFFER_BINDING out_binding = {buffer_out.Get(), 0, tensor_bytes};
+  DML_BINDING_DESC output_binding = {DML_BINDING_TYPE_BUFFER, &out_binding};
+  binding_table->BindOutputs(1, &output_binding);
+
+  if (exec_props.TemporaryResourceSize > 0) {
+    DML_BUFFER_BINDING temp_binding = {buffer_temp.Get(), 0,
+                                       exec_props.TemporaryResourceSize};
+    DML_BINDING_DESC temp_desc = {DML_BINDING_TYPE_BUFFER, &temp_binding};
+    binding_table->BindTemporaryResource(&temp_desc);
+  }
+  if (exec_props.PersistentResourceSize > 0) {
+    DML_BUFFER_BINDING persistent_binding = {
+        buffer_persistent.Get(), 0, exec_props.PersistentResourceSize};
+    DML_BINDING_DESC persistent_desc = {DML_BINDING_TYPE_BUFFER,
+                                        &persistent_binding};
+    binding_table->BindPersistentResource(&persistent_desc);
+  }
+
+  // One untimed warmup dispatch absorbs first-use costs (shader residency,
+  // clock ramp-up) that would otherwise pollute the measurement.
+  command_list->SetDescriptorHeaps(1, heaps);
+  recorder->RecordDispatch(command_list.Get(), compiled_op.Get(),
+                          binding_table.Get());
+  if (!execute_and_wait()) {
+    return absl::nullopt;
+  }
+
+  // Timed run: back-to-back dispatches serialized with UAV barriers, one
+  // submission, one fence wait.
+  command_list->SetDescriptorHeaps(1, heaps);
+  D3D12_RESOURCE_BARRIER uav_barrier = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+  for (uint32_t i = 0; i < kTimedIterations; ++i) {
+    recorder->RecordDispatch(command_list.Get(), compiled_op.Get(),
+                             binding_table.Get());
+    command_list->ResourceBarrier(1, &uav_barrier);
+  }
+
+  if (FAILED(command_list->Close())) {
+    return absl::nullopt;
+  }
+
+  const uint64 start_usecs = Env::Default()->NowMicros();
+
+  ID3D12CommandList* lists[] = {command_list.Get()};
+  queue->ExecuteCommandLists(1, lists);
+  ++fence_value;
+  if (FAILED(queue->Signal(fence.Get(), fence_value))) {
+    return absl::nullopt;
+  }
+  DmlGpuEvent{fence_value, fence}.WaitForSignal();
+
+  const uint64 elapsed_usecs = Env::Default()->NowMicros() - start_usecs;
+  if (elapsed_usecs == 0) {
+    return absl::nullopt;
+  }
+
+  const double flop = 2.0 * kGemmDim * kGemmDim * kGemmDim * kTimedIterations;
+  return flop / (elapsed_usecs * 1e3);  // GFLOPS
+}
+
+}  // namespace
+
+double MeasureAdapterGemmThroughput(const DmlAdapter& adapter) {
+  string cache_dir = CalibrationDirectory();
+  string cache_path =
+      cache_dir.empty()
+          ? string()
+          : io::JoinPath(cache_dir, CalibrationFileName(adapter));
+
+  if (!cache_path.empty()) {
+    absl::optional<double> cached = ReadCachedScore(cache_path);
+    if (cached) {
+      VLOG(1) << "DirectML: adapter '" << adapter.Name() << "' scored "
+              << *cached << " GFLOPS (cached at '" << cache_path << "')";
+      return *cached;
+    }
+  }
+
+  absl::optional<double> measured = RunGemmProbe(adapter);
+  if (!measured) {
+    LOG(WARNING) << "DirectML: calibration probe failed for adapter '"
+                 << adapter.Name() << "'";
+    return 0.0;
+  }
+
+  LOG(INFO) << "DirectML: adapter '" << adapter.Name() << "' measured "
+            << *measured << " GFLOPS (fp32 GEMM probe)";
+
+  if (!cache_path.empty()) {
+    WriteCachedScore(cache_path, *measured);
+  }
+  return *measured;
+}
+
+void SortAdaptersByMeasuredThroughput(std::vector<DmlAdapter>* adapters) {
+  if (adapters->size() < 2) {
+    return;
+  }
+
+  bool calibrate;
+  Status s = ReadBoolFromEnvVar("TF_DIRECTML_ADAPTER_CALIBRATION",
+                                /*default_val=*/true, &calibrate);
+  if (!s.ok()) {
+    calibrate = true;
+  }
+  if (!calibrate) {
+    return;
+  }
+
+  // Probe adapters in parallel, as the compatibility probe already does; the
+  // devices are independent so their GEMMs don't contend. Not a
+  // std::vector<bool>-like container: plain doubles are safe to write
+  // concurrently from different threads.
+  std::vector<double> scores(adapters->size(), 0.0);
+  {
+    thread::ThreadPool pool(Env::Default(), "dml_adapter_calibration",
+                            static_cast<int>(adapters->size()));
+    for (size_t i = 0; i < adapters->size(); ++i) {
+      pool.Schedule([adapters, &scores, i] {
+        scores[i] = MeasureAdapterGemmThroughput((*adapters)[i]);
+      });
+    }
+    // The pool's destructor waits for all scheduled probes to finish.
+  }
+
+  // Only reorder on complete information: a spuriously failed probe must not
+  // banish a healthy adapter to the back of the list.
+  if (std::any_of(scores.begin(), scores.end(),
+                  [](double score) { return score <= 0.0; })) {
+    LOG(WARNING) << "DirectML: keeping enumerated adapter order because at "
+                 << "least one calibration probe failed";
+    return;
+  }
+
+  std::vector<size_t> order(adapters->size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&scores](size_t a, size_t b) {
+    return scores[a] > scores[b];
+  });
+
+  if (std::is_sorted(order.begin(), order.end())) {
+    return;  // calibration agrees with the enumeration order
+  }
+
+  std::vector<DmlAdapter> sorted_adapters;
+  sorted_adapters.reserve(adapters->size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    sorted_adapters.push_back(std::move((*adapters)[order[i]]));
+    LOG(INFO) << "DirectML: adapter " << i << " after calibration: '"
+              << sorted_adapters.back().Name() << "' (" << scores[order[i]]
+              << " GFLOPS)";
+  }
+  *adapters = std::move(sorted_adapters);
+}
+
+}  // namespace tensorflow
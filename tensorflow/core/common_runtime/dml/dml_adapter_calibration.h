@@ -0,0 +1,43 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/dml/dml_adapter.h"
+
+namespace tensorflow {
+
+// Measures the fp32 GEMM throughput an adapter actually achieves by running a
+// short one-shot probe on a throwaway D3D12/DML device, in GFLOPS. The result
+// is cached on disk keyed by adapter and driver identity (vendor ID, device
+// ID and driver version), so the probe runs once per driver install rather
+// than once per process; the cache lives in the directory named by
+// TF_DIRECTML_CALIBRATION_CACHE_PATH, or the local temp directory when that
+// is unset. Returns 0.0 if the probe fails.
+double MeasureAdapterGemmThroughput(const DmlAdapter& adapter);
+
+// Reorders `adapters` in descending order of measured GEMM throughput, so
+// that DML:0 lands on the adapter that is actually fastest rather than the
+// one the OS enumeration heuristics (vendor, memory size) guessed would be.
+// The two can disagree on heterogeneous workstations where the nominally
+// bigger adapter is thermally throttled or driver-impaired. The sort is
+// stable, adapters are probed in parallel, and the original enumeration order
+// is kept untouched if any probe fails, if there are fewer than two adapters,
+// or if calibration is disabled with TF_DIRECTML_ADAPTER_CALIBRATION=0.
+void SortAdaptersByMeasuredThroughput(std::vector<DmlAdapter>* adapters);
+
+}  // namespace tensorflow
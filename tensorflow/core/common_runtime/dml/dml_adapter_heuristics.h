@@ -48,4 +48,51 @@ struct DmlAdapterArchetype {
   static constexpr int64 kComputeFlops = 6.5e12;  // 6.5 TFLOPS
 };
 
+// Returns true if an adapter with the given PCI vendor ID is expected to run
+// fp16 math at least as fast as fp32. The major hardware vendors all ship
+// full-rate (or better) fp16 ALUs on the architectures that meet DirectML's
+// feature level; software adapters such as WARP emulate fp16 and gain nothing
+// from reduced precision.
+inline bool DmlAdapterSupportsFastFp16(uint32 vendor_id) {
+  switch (vendor_id) {
+    case 0x1002:  // AMD
+    case 0x10de:  // NVIDIA
+    case 0x8086:  // Intel
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the element count at or below which an int32/int64 tensor is cheap
+// enough to compute on the host instead of dispatching to DirectML. Used by
+// the pin-to-host grappler optimizer, whose baseline threshold of 64 elements
+// is tuned for CUDA launch latency; a DirectML dispatch (command list
+// recording plus binding table updates) costs several times that, and
+// software adapters execute on the CPU anyway, so the crossover moves up
+// accordingly.
+inline int64 DmlPinToHostMaxTensorSize(uint32 vendor_id) {
+  switch (vendor_id) {
+    case 0x1002:  // AMD
+    case 0x10de:  // NVIDIA
+    case 0x8086:  // Intel
+      return 512;
+    default:
+      // Unknown or software adapters (e.g. WARP).
+      return 4096;
+  }
+}
+
+// Returns the convolution data format that DirectML execution favors on an
+// adapter with the given PCI vendor ID. DirectML operators are NCHW-native,
+// so NCHW is the default; NVIDIA's fp16 metacommands are the exception and
+// run fastest on NHWC when the model is predominantly half precision.
+inline const char* DmlPreferredConvLayout(uint32 vendor_id, bool mostly_fp16) {
+  constexpr uint32 kNvidiaVendorId = 0x10de;
+  if (vendor_id == kNvidiaVendorId && mostly_fp16) {
+    return "NHWC";
+  }
+  return "NCHW";
+}
+
 }  // namespace tensorflow
\ No newline at end of file
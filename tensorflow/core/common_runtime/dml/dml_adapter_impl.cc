@@ -168,6 +168,17 @@ uint64_t DmlAdapterImpl::QueryAvailableLocalMemory() const {
   return info.Budget;
 }
 
+DmlAdapterMemoryInfo DmlAdapterImpl::QueryMemoryInfo() const {
+  ComPtr<IDXGIAdapter3> adapter3;
+  DML_CHECK_SUCCEEDED(adapter_.As(&adapter3));
+
+  DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+  DML_CHECK_SUCCEEDED(adapter3->QueryVideoMemoryInfo(
+      0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info));
+
+  return DmlAdapterMemoryInfo{info.Budget, info.CurrentUsage};
+}
+
 bool IsSoftwareAdapter(IDXGIAdapter1* adapter) {
   // The only way this can fail is if a nullptr is passed in, so
   // using DML_CHECK_SUCCEEDED is OK.
@@ -297,6 +308,21 @@ uint64_t DmlAdapterImpl::QueryAvailableLocalMemory() const {
   return info.budget;
 }
 
+DmlAdapterMemoryInfo DmlAdapterImpl::QueryMemoryInfo() const {
+  ComPtr<IDXCoreAdapter> dxcore_adapter;
+  DML_CHECK_SUCCEEDED(adapter_.As(&dxcore_adapter));
+
+  DXCoreAdapterMemoryBudgetNodeSegmentGroup query = {};
+  query.nodeIndex = 0;
+  query.segmentGroup = DXCoreSegmentGroup::Local;
+
+  DXCoreAdapterMemoryBudget info = {};
+  DML_CHECK_SUCCEEDED(dxcore_adapter->QueryState(
+      DXCoreAdapterState::AdapterMemoryBudget, &query, &info));
+
+  return DmlAdapterMemoryInfo{info.budget, info.currentUsage};
+}
+
 std::vector<DmlAdapterImpl> EnumerateAdapterImpls() {
   const GUID dxcore_adapter = DXCORE_ADAPTER_ATTRIBUTE_D3D12_CORE_COMPUTE;
 
@@ -49,6 +49,7 @@ class DmlAdapterImpl {
   }
 
   uint64_t QueryAvailableLocalMemory() const;
+  DmlAdapterMemoryInfo QueryMemoryInfo() const;
 
  private:
 #if _WIN32
@@ -0,0 +1,348 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+bool IsBatchMatMul(const Node* n) {
+  return n->type_string() == "BatchMatMul" ||
+         n->type_string() == "BatchMatMulV2";
+}
+
+// True if `consumer` is the only node reading `n`'s data outputs. The
+// intermediate scores and probabilities may only feed the next link of the
+// attention chain; any other reader still needs the full matrix.
+bool HasSoleDataConsumer(const Node* n, const Node* consumer) {
+  for (const Edge* e : n->out_edges()) {
+    if (!e->IsControlEdge() && e->dst() != consumer) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads the scalar fp value of a Const node into `scale`. Returns false if
+// the node isn't a floating-point scalar Const.
+bool GetScalarConstValue(const Node* n, float* scale) {
+  if (!n->IsConstant()) {
+    return false;
+  }
+  Tensor value;
+  if (!GetNodeAttr(n->attrs(), "value", &value).ok() ||
+      value.NumElements() != 1) {
+    return false;
+  }
+  if (value.dtype() == DT_FLOAT) {
+    *scale = value.flat<float>()(0);
+  } else if (value.dtype() == DT_HALF) {
+    *scale = static_cast<float>(value.flat<Eigen::half>()(0));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// One matched attention chain:
+//   matmul_qk -> [mul by scalar] -> [add mask] -> softmax -> matmul_v
+struct AttentionMatch {
+  Node* matmul_qk;
+  Node* mul = nullptr;   // Optional scale multiply.
+  Node* add = nullptr;   // Optional mask add.
+  Node* softmax;
+  Node* matmul_v;
+  NodeBuilder::NodeOut query;
+  NodeBuilder::NodeOut key;
+  NodeBuilder::NodeOut value;
+  NodeBuilder::NodeOut mask;  // Valid only when `add` is set.
+  float scale = 1.0f;
+};
+
+// Tries to match the attention chain that ends in `softmax`. The chain is
+// matched strictly: every intermediate feeds only the next link, every node
+// sits on the same DML device with the same dtype, and the two matmuls carry
+// the canonical adjoint flags (q * k^T, then probs * v).
+bool MatchAttention(Node* softmax, AttentionMatch* match) {
+  if (softmax->type_string() != "Softmax" || !IsDmlDevice(softmax)) {
+    return false;
+  }
+  DataType dtype;
+  if (!TryGetNodeAttr(softmax->attrs(), "T", &dtype) ||
+      (dtype != DT_FLOAT && dtype != DT_HALF)) {
+    return false;
+  }
+
+  auto chain_member = [&](const Node* n, const Node* consumer) {
+    DataType node_dtype;
+    return IsDmlDevice(n) && HasSoleDataConsumer(n, consumer) &&
+           n->assigned_device_name() == softmax->assigned_device_name() &&
+           TryGetNodeAttr(n->attrs(), "T", &node_dtype) &&
+           node_dtype == dtype;
+  };
+
+  // The softmax's only reader must be the probs * value matmul, consuming
+  // the probabilities as its left operand without adjoints.
+  Node* matmul_v = nullptr;
+  for (const Edge* e : softmax->out_edges()) {
+    if (e->IsControlEdge()) continue;
+    if (matmul_v != nullptr || e->dst_input() != 0) {
+      return false;
+    }
+    matmul_v = e->dst();
+  }
+  if (matmul_v == nullptr || !IsBatchMatMul(matmul_v) ||
+      !IsDmlDevice(matmul_v) ||
+      matmul_v->assigned_device_name() != softmax->assigned_device_name()) {
+    return false;
+  }
+  bool adj_x, adj_y;
+  if (!TryGetNodeAttr(matmul_v->attrs(), "adj_x", &adj_x) ||
+      !TryGetNodeAttr(matmul_v->attrs(), "adj_y", &adj_y) || adj_x || adj_y) {
+    return false;
+  }
+
+  // Walk upwards from the softmax: optional mask add, optional scalar
+  // scale multiply, then the q * k^T matmul.
+  const Edge* e;
+  if (!softmax->input_edge(0, &e).ok()) {
+    return false;
+  }
+  Node* cur = e->src();
+
+  Node* add = nullptr;
+  NodeBuilder::NodeOut mask;
+  if (cur->type_string() == "Add" || cur->type_string() == "AddV2") {
+    if (!chain_member(cur, softmax)) {
+      return false;
+    }
+    const Edge* lhs;
+    const Edge* rhs;
+    if (!cur->input_edge(0, &lhs).ok() || !cur->input_edge(1, &rhs).ok()) {
+      return false;
+    }
+    // One operand continues the chain; the other is the mask. Prefer the
+    // operand that looks like the scores (a Mul or BatchMatMul).
+    const Edge* scores_edge = lhs;
+    const Edge* mask_edge = rhs;
+    if (!IsBatchMatMul(lhs->src()) && lhs->src()->type_string() != "Mul") {
+      std::swap(scores_edge, mask_edge);
+    }
+    add = cur;
+    mask = NodeBuilder::NodeOut(mask_edge->src(), mask_edge->src_output());
+    cur = scores_edge->src();
+  }
+
+  Node* mul = nullptr;
+  float scale = 1.0f;
+  if (cur->type_string() == "Mul") {
+    if (!chain_member(cur, add != nullptr ? add : softmax)) {
+      return false;
+    }
+    const Edge* lhs;
+    const Edge* rhs;
+    if (!cur->input_edge(0, &lhs).ok() || !cur->input_edge(1, &rhs).ok()) {
+      return false;
+    }
+    const Edge* scores_edge = lhs;
+    const Edge* scale_edge = rhs;
+    if (!IsBatchMatMul(scores_edge->src())) {
+      std::swap(scores_edge, scale_edge);
+    }
+    if (!GetScalarConstValue(scale_edge->src(), &scale)) {
+      return false;
+    }
+    mul = cur;
+    cur = scores_edge->src();
+  }
+
+  Node* first = mul != nullptr ? mul : add != nullptr ? add : softmax;
+  if (!IsBatchMatMul(cur) || !chain_member(cur, first)) {
+    return false;
+  }
+  if (!TryGetNodeAttr(cur->attrs(), "adj_x", &adj_x) ||
+      !TryGetNodeAttr(cur->attrs(), "adj_y", &adj_y) || adj_x || !adj_y) {
+    return false;
+  }
+
+  const Edge* query_edge;
+  const Edge* key_edge;
+  const Edge* value_edge;
+  if (!cur->input_edge(0, &query_edge).ok() ||
+      !cur->input_edge(1, &key_edge).ok() ||
+      !matmul_v->input_edge(1, &value_edge).ok()) {
+    return false;
+  }
+
+  // The mask and value must come from outside the chain being replaced.
+  Node* pattern_nodes[] = {cur, mul, add, softmax, matmul_v};
+  for (Node* producer : {query_edge->src(), key_edge->src(), value_edge->src(),
+                         add != nullptr ? mask.node : nullptr}) {
+    if (producer == nullptr) continue;
+    for (Node* pattern_node : pattern_nodes) {
+      if (producer == pattern_node) {
+        return false;
+      }
+    }
+  }
+
+  match->matmul_qk = cur;
+  match->mul = mul;
+  match->add = add;
+  match->softmax = softmax;
+  match->matmul_v = matmul_v;
+  match->query = NodeBuilder::NodeOut(query_edge->src(),
+                                      query_edge->src_output());
+  match->key = NodeBuilder::NodeOut(key_edge->src(), key_edge->src_output());
+  match->value = NodeBuilder::NodeOut(value_edge->src(),
+                                      value_edge->src_output());
+  match->mask = mask;
+  match->scale = scale;
+  return true;
+}
+
+Status ReplaceMatch(Graph* g, const AttentionMatch& match) {
+  DataType dtype;
+  TF_RETURN_IF_ERROR(GetNodeAttr(match.softmax->attrs(), "T", &dtype));
+
+  std::vector<NodeBuilder::NodeOut> masks;
+  if (match.add != nullptr) {
+    masks.push_back(match.mask);
+  }
+
+  NodeDebugInfo debug_info(*match.matmul_v);
+  NodeBuilder builder(
+      g->NewName(strings::StrCat(match.matmul_v->name(), "/dml_attention")),
+      "_DmlScaledDotProductAttention", OpRegistry::Global(), &debug_info);
+
+  Node* fused = nullptr;
+  TF_RETURN_IF_ERROR(builder.Device(match.matmul_v->requested_device())
+                         .Input(match.query)
+                         .Input(match.key)
+                         .Input(match.value)
+                         .Input(masks)
+                         .Attr("T", dtype)
+                         .Attr("num_masks",
+                               static_cast<int64>(masks.size()))
+                         .Attr("scale", match.scale)
+                         .Finalize(g, &fused));
+  fused->set_assigned_device_name(match.matmul_v->assigned_device_name());
+
+  // The final matmul's data consumers move to the fused node; the interior
+  // nodes only had each other. Control edges anywhere in the chain transfer.
+  std::vector<const Edge*> out_edges(match.matmul_v->out_edges().begin(),
+                                     match.matmul_v->out_edges().end());
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(fused, e->dst());
+    } else {
+      g->AddEdge(fused, 0, e->dst(), e->dst_input());
+    }
+    g->RemoveEdge(e);
+  }
+
+  for (Node* n :
+       {match.matmul_qk, match.mul, match.add, match.softmax, match.matmul_v}) {
+    if (n == nullptr) continue;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+    if (n != match.matmul_v) {
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge()) {
+          g->AddControlEdge(fused, e->dst());
+        }
+      }
+    }
+    g->RemoveNode(n);
+  }
+
+  return Status::OK();
+}
+
+// Rewrites the scaled-dot-product-attention chain
+//   BatchMatMul(q, k, adj_y=true) -> [Mul scale] -> [Add mask] -> Softmax
+//     -> BatchMatMul(probs, v)
+// on DML devices into a single _DmlScaledDotProductAttention node. The fused
+// kernel tiles along the query dimension, so the sequence x sequence score
+// and probability matrices — the dominant activations of a transformer layer
+// at long sequence lengths — never materialize in full.
+class DmlAttentionFusionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool fusion_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_ATTENTION_FUSION",
+                                          /*default_val=*/true,
+                                          &fusion_enabled));
+    if (!fusion_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather first, then rewrite, so iteration never walks deleted nodes.
+    // Matched chains are disjoint by construction: each chain is identified
+    // by its unique Softmax, and its interior nodes feed nothing else.
+    std::vector<AttentionMatch> matches;
+    for (Node* n : g->op_nodes()) {
+      AttentionMatch match;
+      if (MatchAttention(n, &match)) {
+        matches.push_back(match);
+      }
+    }
+
+    for (const AttentionMatch& match : matches) {
+      VLOG(1) << "DmlAttentionFusionPass: fusing attention chain at '"
+              << match.softmax->name() << "'";
+      TF_RETURN_IF_ERROR(ReplaceMatch(g, match));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement so device assignments are known, but before the cluster
+// and elementwise fusion passes at phases 24-25, which would otherwise absorb
+// the Mul/Add links and hide the chain.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 23,
+                      DmlAttentionFusionPass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "dml_bfc_allocator.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
@@ -33,14 +37,245 @@ static uint64_t GetMaxAllocationSize() {
 DmlAllocator::DmlAllocator(D3D12HeapAllocator* heap_allocator,
                            uint64_t memory_limit_in_bytes,
                            const GPUOptions& gpu_options, const string& name)
-    : GPUBFCAllocator(new SubAllocatorWrapper(heap_allocator),
+    : GPUBFCAllocator(new SubAllocatorWrapper(heap_allocator, this),
                       memory_limit_in_bytes, gpu_options, name,
                       GetMaxAllocationSize()),
-      heap_allocator_(heap_allocator) {}
+      heap_allocator_(heap_allocator) {
+  Status s = ReadBoolFromEnvVar("TF_DIRECTML_ZERO_INIT_ELISION",
+                                /*default_val=*/true,
+                                &zero_init_elision_enabled_);
+  if (!s.ok()) {
+    zero_init_elision_enabled_ = true;
+  }
+}
 
 D3D12BufferRegion DmlAllocator::CreateBufferRegion(const void* ptr,
                                                    uint64_t size_in_bytes) {
   return heap_allocator_->CreateBufferRegion(ptr, size_in_bytes);
 }
 
+void* DmlAllocator::AllocateRaw(size_t alignment, size_t num_bytes,
+                                const AllocationAttributes& allocation_attr) {
+  void* ptr = GPUBFCAllocator::AllocateRaw(alignment, num_bytes,
+                                           allocation_attr);
+  if (ptr == nullptr) {
+    // The BFC base class has already logged its bin occupancy on this path;
+    // add the physical heap state underneath the arena, which is where
+    // fragmentation actually lives on DML. Allocations that opted out of
+    // retries fail routinely (the caller has a fallback), so stay quiet for
+    // those.
+    if (!allocation_attr.no_retry_on_failure) {
+      LOG(WARNING) << "DML allocation of "
+                   << strings::HumanReadableNumBytes(num_bytes)
+                   << " failed; allocator state:\n"
+                   << DebugString();
+
+      if (has_observers_.load(std::memory_order_relaxed)) {
+        absl::optional<AllocatorStats> stats = GetStats();
+        NotifyAllObservers(
+            kMemoryEventAllocationFailed,
+            stats ? static_cast<uint64>(stats->bytes_in_use) : 0,
+            stats && stats->bytes_limit
+                ? static_cast<uint64>(*stats->bytes_limit)
+                : 0);
+      }
+    }
+    return nullptr;
+  }
+
+  // Raise the step watermark to the new bytes-in-use. The monotonic CAS loop
+  // keeps concurrent allocations from regressing the peak.
+  if (absl::optional<AllocatorStats> stats = GetStats()) {
+    uint64 in_use = static_cast<uint64>(stats->bytes_in_use);
+    uint64 peak = step_peak_bytes_.load(std::memory_order_relaxed);
+    while (in_use > peak &&
+           !step_peak_bytes_.compare_exchange_weak(peak, in_use)) {
+    }
+  }
+
+  CheckObserverThresholds();
+
+  if (!zero_init_elision_enabled_) {
+    return ptr;
+  }
+
+  const uint64_t begin = reinterpret_cast<uint64_t>(ptr);
+  const uint64_t end = begin + num_bytes;
+
+  std::unique_lock<std::mutex> lock(zero_init_mutex_);
+
+  // An allocation reads as zero iff none of its bytes were ever handed out:
+  // arena regions backed by fresh heaps start untouched (recycled heap
+  // memory is pre-marked by SubAllocatorWrapper::Alloc), and each allocation
+  // marks its bytes on the way out.
+  if (!IsRangeTouched(begin, end)) {
+    zero_initialized_allocations_.insert(ptr);
+  }
+
+  MarkRangeTouchedLocked(begin, end);
+
+  return ptr;
+}
+
+void DmlAllocator::DeallocateRaw(void* ptr) {
+  if (zero_init_elision_enabled_) {
+    std::unique_lock<std::mutex> lock(zero_init_mutex_);
+    zero_initialized_allocations_.erase(ptr);
+  }
+  GPUBFCAllocator::DeallocateRaw(ptr);
+  CheckObserverThresholds();
+}
+
+int64 DmlAllocator::AddMemoryObserver(double threshold_fraction,
+                                      MemoryObserver observer) {
+  threshold_fraction = std::min(std::max(threshold_fraction, 0.01), 1.0);
+
+  std::unique_lock<std::mutex> lock(observers_mutex_);
+  int64 id = next_observer_id_++;
+
+  MemoryObserverEntry entry = {};
+  entry.threshold_fraction = threshold_fraction;
+  entry.observer = std::move(observer);
+
+  // New observers start in the below-threshold state, so one registered while
+  // usage is already over its threshold receives an exceeded event on the
+  // next allocation or free instead of missing the crossing.
+  observers_.emplace(id, std::move(entry));
+  has_observers_.store(true, std::memory_order_relaxed);
+  return id;
+}
+
+void DmlAllocator::RemoveMemoryObserver(int64 observer_id) {
+  std::unique_lock<std::mutex> lock(observers_mutex_);
+  observers_.erase(observer_id);
+  has_observers_.store(!observers_.empty(), std::memory_order_relaxed);
+}
+
+void DmlAllocator::NotifyBudgetChanged(uint64 new_budget_in_bytes) {
+  if (!has_observers_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  absl::optional<AllocatorStats> stats = GetStats();
+  NotifyAllObservers(kMemoryEventBudgetChanged,
+                     stats ? static_cast<uint64>(stats->bytes_in_use) : 0,
+                     new_budget_in_bytes);
+}
+
+void DmlAllocator::CheckObserverThresholds() {
+  if (!has_observers_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  absl::optional<AllocatorStats> stats = GetStats();
+  if (!stats || !stats->bytes_limit) {
+    return;
+  }
+  const uint64 in_use = static_cast<uint64>(stats->bytes_in_use);
+  const uint64 limit = static_cast<uint64>(*stats->bytes_limit);
+
+  // Collect the callbacks to fire under the lock and invoke them outside it,
+  // so an observer may allocate or unregister from within its callback.
+  absl::InlinedVector<std::pair<MemoryObserver, MemoryEvent>, 4> pending;
+  {
+    std::unique_lock<std::mutex> lock(observers_mutex_);
+    for (auto& observer : observers_) {
+      MemoryObserverEntry& entry = observer.second;
+      const bool above =
+          in_use > static_cast<uint64>(entry.threshold_fraction * limit);
+      if (above != entry.above) {
+        entry.above = above;
+        pending.push_back({entry.observer, above ? kMemoryEventThresholdExceeded
+                                                 : kMemoryEventThresholdCleared});
+      }
+    }
+  }
+
+  for (auto& fire : pending) {
+    fire.first(fire.second, in_use, limit);
+  }
+}
+
+void DmlAllocator::NotifyAllObservers(MemoryEvent event, uint64 bytes_in_use,
+                                      uint64 limit) {
+  absl::InlinedVector<MemoryObserver, 4> pending;
+  {
+    std::unique_lock<std::mutex> lock(observers_mutex_);
+    for (auto& observer : observers_) {
+      pending.push_back(observer.second.observer);
+    }
+  }
+  for (auto& fire : pending) {
+    fire(event, bytes_in_use, limit);
+  }
+}
+
+void DmlAllocator::ResetStepPeakBytes() {
+  absl::optional<AllocatorStats> stats = GetStats();
+  step_peak_bytes_.store(
+      stats ? static_cast<uint64>(stats->bytes_in_use) : 0,
+      std::memory_order_relaxed);
+}
+
+string DmlAllocator::DebugString() {
+  string result;
+
+  absl::optional<AllocatorStats> stats = GetStats();
+  if (stats) {
+    strings::StrAppend(&result, stats->DebugString(), "\n");
+  }
+
+  strings::StrAppend(&result, heap_allocator_->DebugString());
+  return result;
+}
+
+bool DmlAllocator::ConsumeZeroInitializedState(const void* ptr) {
+  if (!zero_init_elision_enabled_) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(zero_init_mutex_);
+  return zero_initialized_allocations_.erase(ptr) != 0;
+}
+
+void DmlAllocator::MarkRangeTouched(const void* ptr, uint64_t size_in_bytes) {
+  const uint64_t begin = reinterpret_cast<uint64_t>(ptr);
+  std::unique_lock<std::mutex> lock(zero_init_mutex_);
+  MarkRangeTouchedLocked(begin, begin + size_in_bytes);
+}
+
+void DmlAllocator::MarkRangeTouchedLocked(uint64_t begin, uint64_t end) {
+  // Insert [begin, end), merging with any overlapping or adjacent ranges.
+  auto range = touched_ranges_.emplace(begin, end).first;
+  if (range->second < end) {
+    range->second = end;
+  }
+  auto next = std::next(range);
+  while (next != touched_ranges_.end() && next->first <= range->second) {
+    range->second = std::max(range->second, next->second);
+    next = touched_ranges_.erase(next);
+  }
+  if (range != touched_ranges_.begin()) {
+    auto prev = std::prev(range);
+    if (prev->second >= range->first) {
+      prev->second = std::max(prev->second, range->second);
+      touched_ranges_.erase(range);
+    }
+  }
+}
+
+bool DmlAllocator::IsRangeTouched(uint64_t begin, uint64_t end) const {
+  // Find the first range starting after `begin`; it overlaps if it starts
+  // before `end`. The preceding range overlaps if it extends past `begin`.
+  auto it = touched_ranges_.upper_bound(begin);
+  if (it != touched_ranges_.end() && it->first < end) {
+    return true;
+  }
+  if (it != touched_ranges_.begin()) {
+    --it;
+    if (it->second > begin) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,12 @@ limitations under the License.
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "absl/container/flat_hash_set.h"
 #include "dml_buffer_region.h"
 #include "dml_common.h"
 #include "dml_heap_allocator.h"
@@ -28,12 +34,17 @@ class DmlAllocator : public GPUBFCAllocator {
   // A SubAllocator that wraps a D3D12HeapAllocator
   class SubAllocatorWrapper final : public tensorflow::SubAllocator {
    public:
-    SubAllocatorWrapper(D3D12HeapAllocator* impl)
-        : SubAllocator({}, {}), impl_(impl) {}
+    SubAllocatorWrapper(D3D12HeapAllocator* impl, DmlAllocator* owner)
+        : SubAllocator({}, {}), impl_(impl), owner_(owner) {}
 
    public:  // SubAllocator overrides
     void* Alloc(size_t alignment, size_t num_bytes) override {
       void* p = impl_->Alloc(num_bytes);
+      if (p != nullptr && !impl_->IsAllocationZeroed(p)) {
+        // The BFC arena grew into recycled heap memory; nothing carved out
+        // of this region may claim to be zero-initialized.
+        owner_->MarkRangeTouched(p, num_bytes);
+      }
       VisitAlloc(p, 0, num_bytes);
       return p;
     }
@@ -45,6 +56,7 @@ class DmlAllocator : public GPUBFCAllocator {
 
    private:
     D3D12HeapAllocator* impl_;
+    DmlAllocator* owner_;  // not owned
   };
 
  public:
@@ -54,8 +66,143 @@ class DmlAllocator : public GPUBFCAllocator {
 
   D3D12BufferRegion CreateBufferRegion(const void* ptr, uint64_t size_in_bytes);
 
+  // See D3D12HeapAllocator::OwnsPointer.
+  bool OwnsPointer(const void* ptr) {
+    return heap_allocator_->OwnsPointer(ptr);
+  }
+
+  // See D3D12HeapAllocator::ImportExternalResource. Imported resources bypass
+  // the BFC arena entirely; the returned pointer is only valid as a DML tensor
+  // data pointer and must be released with ReleaseExternalResource.
+  void* ImportExternalResource(ID3D12Resource* resource,
+                               uint64_t size_in_bytes) {
+    return heap_allocator_->ImportExternalResource(resource, size_in_bytes);
+  }
+
+  void ReleaseExternalResource(void* ptr) {
+    heap_allocator_->ReleaseExternalResource(ptr);
+  }
+
+  // Returns true if allocations served by this allocator live in CPU-visible
+  // device memory (see D3D12HeapAllocator::IsCpuVisible), in which case the
+  // device context can write uploaded tensor data through a mapped pointer
+  // instead of staging it through the upload heap.
+  bool IsCpuVisible() const { return heap_allocator_->IsCpuVisible(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Step watermark: the peak bytes-in-use observed since the last reset.
+  // DmlDeviceTracer resets it at the start of a traced Session::Run and
+  // attaches the peak to RunMetadata step stats when the run completes, so a
+  // batch-size tuner can read the true high-water mark of each step instead
+  // of the process-lifetime peak in AllocatorStats.
+  void ResetStepPeakBytes();
+  uint64 GetStepPeakBytes() const {
+    return step_peak_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Returns a combined report of the BFC arena statistics and the physical
+  // heap state underneath it (see D3D12HeapAllocator::DebugString). Logged
+  // automatically when an allocation fails, and retrievable at any time
+  // through TFDML_GetMemoryReport, so OOM investigations don't require a
+  // rebuilt binary.
+  string DebugString();
+
+  // Events delivered to memory observers (see AddMemoryObserver). The values
+  // are stable; they are forwarded verbatim through the C API
+  // (TFDML_RegisterMemoryObserver).
+  enum MemoryEvent : int {
+    // Bytes-in-use rose above the observer's threshold fraction of the
+    // allocator's memory limit.
+    kMemoryEventThresholdExceeded = 0,
+    // Bytes-in-use fell back below the observer's threshold.
+    kMemoryEventThresholdCleared = 1,
+    // A retryable allocation failed. `bytes_in_use` reflects usage at the
+    // time of the failure.
+    kMemoryEventAllocationFailed = 2,
+    // The OS changed the adapter's video memory budget. `limit_in_bytes`
+    // carries the new budget rather than the allocator limit.
+    kMemoryEventBudgetChanged = 3,
+  };
+
+  // Observer callbacks are invoked outside the allocator's locks, so they may
+  // allocate, query stats, or unregister themselves. They can run on any
+  // thread that allocates, so they should be quick and must not block on GPU
+  // work.
+  using MemoryObserver =
+      std::function<void(MemoryEvent, uint64 bytes_in_use, uint64 limit)>;
+
+  // Registers an observer and returns an id to unregister it with.
+  // `threshold_fraction` is the fraction of the memory limit whose crossing
+  // (in either direction) fires threshold events; values outside (0, 1] are
+  // clamped into it. Failure and budget events go to every observer.
+  int64 AddMemoryObserver(double threshold_fraction, MemoryObserver observer);
+  void RemoveMemoryObserver(int64 observer_id);
+
+  // Broadcasts kMemoryEventBudgetChanged. Called by the budget manager when
+  // its poll observes a different OS-reported budget for this adapter.
+  void NotifyBudgetChanged(uint64 new_budget_in_bytes);
+
+  // Returns true (at most once per allocation) if the given pointer was
+  // returned by AllocateRaw and its memory is still in the zero-initialized
+  // state D3D12 left it in at heap creation: the underlying bytes have never
+  // been handed out by this allocator or its heap allocator before, so they
+  // are guaranteed to read as zero. Callers use this to elide a zero-fill
+  // they were about to dispatch; consuming the flag keeps a later occupant of
+  // the same bytes from making the same claim. Always returns false when
+  // elision is disabled with TF_DIRECTML_ZERO_INIT_ELISION=0.
+  bool ConsumeZeroInitializedState(const void* ptr);
+
  private:
+  // Records that the bytes of [ptr, ptr + size_in_bytes) may have held data
+  // at some point, so no future allocation of them is zero-initialized.
+  // Called for every allocation handed out, and for arena regions that grow
+  // into recycled heap memory.
+  void MarkRangeTouched(const void* ptr, uint64_t size_in_bytes);
+  void MarkRangeTouchedLocked(uint64_t begin, uint64_t end);
+
+  // Returns true if any byte of [begin, end) has been marked touched. The
+  // zero-init mutex must be held.
+  bool IsRangeTouched(uint64_t begin, uint64_t end) const;
+
+  // Fires threshold-crossing events for observers whose threshold the current
+  // bytes-in-use has crossed since the last check. Cheap when no observers
+  // are registered.
+  void CheckObserverThresholds();
+
+  // Broadcasts `event` to every observer with the given payload.
+  void NotifyAllObservers(MemoryEvent event, uint64 bytes_in_use, uint64 limit);
+
   D3D12HeapAllocator* heap_allocator_;  // not owned
+
+  // Zero-init elision state. Tagged-pointer ranges ever handed out (kept
+  // coalesced, so steady-state reuse collapses to a few entries per arena
+  // region), and the live allocations still known to read as zero.
+  bool zero_init_elision_enabled_ = true;
+  mutable std::mutex zero_init_mutex_;
+  std::map<uint64_t, uint64_t> touched_ranges_;  // begin -> end
+  absl::flat_hash_set<const void*> zero_initialized_allocations_;
+
+  // Peak bytes-in-use since the last ResetStepPeakBytes; raised by every
+  // successful allocation.
+  std::atomic<uint64> step_peak_bytes_{0};
+
+  // Memory observer state. `above` tracks which side of its threshold each
+  // observer last saw, so crossings fire exactly once per direction change.
+  struct MemoryObserverEntry {
+    double threshold_fraction;
+    bool above = false;
+    MemoryObserver observer;
+  };
+  mutable std::mutex observers_mutex_;
+  std::map<int64, MemoryObserverEntry> observers_;  // id -> entry
+  int64 next_observer_id_ = 1;
+
+  // Mirrors observers_.empty(), so the allocation hot path can skip the
+  // observer mutex and a GetStats call when nobody is listening.
+  std::atomic<bool> has_observers_{false};
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,193 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_budget_manager.h"
+
+#include "absl/memory/memory.h"
+#include "dml_bfc_allocator.h"
+#include "dml_heap_allocator.h"
+#include "dml_kernel_manager.h"
+#include "dml_shared_budget_ledger.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+/*static*/ std::unique_ptr<DmlBudgetManager> DmlBudgetManager::MaybeCreate(
+    const DmlAdapter& adapter, D3D12HeapAllocator* heap_allocator,
+    DmlAllocator* dml_allocator, DmlKernelManager* kernel_manager) {
+  bool enabled = true;
+  Status s = ReadBoolFromEnvVar("TF_DIRECTML_BUDGET_MANAGER",
+                                /*default_val=*/true, &enabled);
+  if (s.ok() && !enabled) {
+    return nullptr;
+  }
+
+  int64 poll_interval_ms = 1000;
+  s = ReadInt64FromEnvVar("TF_DIRECTML_BUDGET_POLL_INTERVAL_MS",
+                          /*default_val=*/1000, &poll_interval_ms);
+  if (!s.ok() || poll_interval_ms <= 0) {
+    poll_interval_ms = 1000;
+  }
+
+  bool shared_budget = false;
+  s = ReadBoolFromEnvVar("TF_DIRECTML_SHARED_BUDGET",
+                         /*default_val=*/false, &shared_budget);
+  if (!s.ok()) {
+    shared_budget = false;
+  }
+
+  std::unique_ptr<DmlSharedBudgetLedger> shared_ledger;
+  if (shared_budget) {
+    // Create may fail (e.g. the ledger is full); the budget manager then
+    // degrades to per-process behavior.
+    shared_ledger = DmlSharedBudgetLedger::Create(adapter);
+  }
+
+  return absl::WrapUnique(new DmlBudgetManager(adapter, heap_allocator,
+                                               dml_allocator, kernel_manager,
+                                               poll_interval_ms,
+                                               std::move(shared_ledger)));
+}
+
+DmlBudgetManager::DmlBudgetManager(
+    const DmlAdapter& adapter, D3D12HeapAllocator* heap_allocator,
+    DmlAllocator* dml_allocator, DmlKernelManager* kernel_manager,
+    int64 poll_interval_ms,
+    std::unique_ptr<DmlSharedBudgetLedger> shared_ledger)
+    : adapter_(adapter),
+      heap_allocator_(heap_allocator),
+      dml_allocator_(dml_allocator),
+      kernel_manager_(kernel_manager),
+      poll_interval_ms_(poll_interval_ms),
+      shared_ledger_(std::move(shared_ledger)) {
+  thread_ = std::thread([this] { ThreadProc(); });
+}
+
+DmlBudgetManager::~DmlBudgetManager() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    exit_requested_ = true;
+  }
+  exit_requested_cv_.notify_all();
+
+  // The thread's waits are all bounded, so this join is prompt. Joining (as
+  // opposed to detaching) is required because the thread dereferences the
+  // allocator and kernel manager, which DmlDeviceState destroys after us.
+  thread_.join();
+}
+
+void DmlBudgetManager::ThreadProc() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      exit_requested_cv_.wait_for(
+          lock, std::chrono::milliseconds(poll_interval_ms_),
+          [this] { return exit_requested_; });
+      if (exit_requested_) {
+        return;
+      }
+    }
+
+    DmlAdapterMemoryInfo info = adapter_.QueryMemoryInfo();
+    if (info.budget == 0) {
+      // Some drivers report a zero budget transiently (e.g. during a mode
+      // switch); there's nothing meaningful to compare against.
+      continue;
+    }
+
+    // Surface OS budget changes to registered allocator observers, so host
+    // applications learn that their headroom moved without polling. The first
+    // observed budget is a baseline, not a change.
+    if (info.budget != last_budget_) {
+      if (last_budget_ != 0 && dml_allocator_ != nullptr) {
+        dml_allocator_->NotifyBudgetChanged(info.budget);
+      }
+      last_budget_ = info.budget;
+    }
+
+    // Hysteresis: enter the pressured state at ~95% of the budget, leave it
+    // below ~85%.
+    const uint64_t pressure_threshold = info.budget - info.budget / 20;
+    const uint64_t relief_threshold = info.budget - info.budget * 3 / 20;
+
+    // With the cross-process ledger, this process is also pressured when the
+    // *group's* combined usage nears the budget and it holds more than an
+    // equal share of it — even if its own usage alone looks comfortable.
+    // Only the over-share processes trim, so one greedy process can't make
+    // its well-behaved neighbors shed memory.
+    bool over_fair_share = false;
+    if (shared_ledger_ != nullptr) {
+      shared_ledger_->PublishUsage(info.current_usage);
+
+      uint32 process_count = 0;
+      const uint64 group_usage =
+          shared_ledger_->QueryGroupUsage(&process_count);
+      over_fair_share = process_count > 1 &&
+                        group_usage > pressure_threshold &&
+                        info.current_usage > info.budget / process_count;
+    }
+
+    if (!under_pressure_ &&
+        (info.current_usage > pressure_threshold || over_fair_share)) {
+      under_pressure_ = true;
+
+      uint64_t bytes_evicted = heap_allocator_->EvictUnusedBlockHeaps();
+
+      // Cached kernels pin persistent operator resources for as long as they
+      // stay cached, and unlike BFC regions those bytes are safe to give
+      // back - eviction only costs a recompile. Halve the cache's resident
+      // bytes per pressured sweep, so sustained pressure decays it
+      // geometrically instead of dumping the whole cache on a transient dip.
+      const uint64 kernel_bytes_before = kernel_manager_->GetResidentBytes();
+      kernel_manager_->TrimCacheToBytes(kernel_bytes_before / 2);
+      const uint64 kernel_bytes_trimmed =
+          kernel_bytes_before - kernel_manager_->GetResidentBytes();
+
+      kernel_manager_->ReleaseCompletedReferences();
+
+      LOG(WARNING) << "DirectML video memory usage ("
+                   << strings::HumanReadableNumBytes(info.current_usage)
+                   << ") is near the "
+                   << (over_fair_share ? "fair share of the shared"
+                                       : "OS-assigned")
+                   << " budget (" << strings::HumanReadableNumBytes(info.budget)
+                   << "); evicted "
+                   << strings::HumanReadableNumBytes(bytes_evicted)
+                   << " of unused heaps and "
+                   << strings::HumanReadableNumBytes(kernel_bytes_trimmed)
+                   << " of cached kernel state. If this persists, consider "
+                      "lowering per_process_gpu_memory_fraction.";
+    } else if (under_pressure_ && info.current_usage < relief_threshold &&
+               !over_fair_share) {
+      under_pressure_ = false;
+
+      VLOG(1) << "DirectML video memory usage ("
+              << strings::HumanReadableNumBytes(info.current_usage)
+              << ") is back under the OS-assigned budget ("
+              << strings::HumanReadableNumBytes(info.budget) << ")";
+    } else if (under_pressure_) {
+      // Still pressured: keep sweeping, since heaps freed since the last pass
+      // only become evictable over time as their GPU work retires, and keep
+      // halving the kernel cache's resident bytes.
+      heap_allocator_->EvictUnusedBlockHeaps();
+      kernel_manager_->TrimCacheToBytes(kernel_manager_->GetResidentBytes() /
+                                        2);
+      kernel_manager_->ReleaseCompletedReferences();
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "dml_adapter.h"
+#include "dml_common.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class D3D12HeapAllocator;
+class DmlAllocator;
+class DmlKernelManager;
+class DmlSharedBudgetLedger;
+
+// Watches the OS-reported video memory budget for an adapter and sheds
+// reclaimable device memory when the process approaches it. The OS can lower
+// our budget at any time (e.g. another process starts using the GPU); without
+// a response, the video memory manager starts demoting our heaps behind our
+// back and every access to a demoted page stalls the queue.
+//
+// The memory we can actually give back without breaking live tensors is:
+//   - block heaps in D3D12HeapAllocator with no live sub-allocations, which
+//     are demoted with ID3D12Device::Evict and restored on reuse,
+//   - persistent operator resources pinned by DmlKernelManager's cache, which
+//     are trimmed by resident bytes (eviction only costs a recompile), and
+//   - GPU-lifetime references (kernels, transient resources) whose completion
+//     events have signaled.
+// Regions handed to the BFC allocator and still in use can never be revoked,
+// so staying inside the budget ultimately relies on the per_process_gpu_
+// memory_fraction / memory limit chosen at device creation.
+//
+// A background thread polls the budget (DXCore has no budget-change
+// notification, so both backends use the same polling path). Eviction kicks
+// in with hysteresis: it starts when usage exceeds ~95% of the budget and
+// stops once usage drops below ~85%, so a process hovering near the threshold
+// doesn't thrash between evicting and restoring the same heaps.
+//
+// With TF_DIRECTML_SHARED_BUDGET=1, processes sharing the adapter also
+// publish their usage to a cross-process ledger (DmlSharedBudgetLedger) each
+// poll. When the *group's* combined usage nears the budget, the processes
+// using more than an equal share trim, instead of the OS picking victims by
+// demoting whoever touched their pages least recently. Off by default since
+// single-process hosts pay the shared memory for nothing.
+//
+// This class is thread-safe.
+class DmlBudgetManager {
+ public:
+  // Returns null if the budget manager is disabled via the
+  // TF_DIRECTML_BUDGET_MANAGER environment variable. The allocators and
+  // kernel manager are weak pointers and must outlive this object.
+  // `dml_allocator` receives budget-change notifications for its registered
+  // memory observers (see DmlAllocator::AddMemoryObserver) and may be null.
+  static std::unique_ptr<DmlBudgetManager> MaybeCreate(
+      const DmlAdapter& adapter, D3D12HeapAllocator* heap_allocator,
+      DmlAllocator* dml_allocator, DmlKernelManager* kernel_manager);
+
+  ~DmlBudgetManager();
+
+ private:
+  DmlBudgetManager(const DmlAdapter& adapter,
+                   D3D12HeapAllocator* heap_allocator,
+                   DmlAllocator* dml_allocator,
+                   DmlKernelManager* kernel_manager, int64 poll_interval_ms,
+                   std::unique_ptr<DmlSharedBudgetLedger> shared_ledger);
+
+  void ThreadProc();
+
+  const DmlAdapter adapter_;
+  D3D12HeapAllocator* heap_allocator_;  // weak; owned by DmlDeviceState
+  DmlAllocator* dml_allocator_;         // weak; owned by DmlDeviceState
+  DmlKernelManager* kernel_manager_;    // weak; owned by DmlDeviceState
+  const int64 poll_interval_ms_;
+
+  // Null unless cross-process coordination is enabled.
+  std::unique_ptr<DmlSharedBudgetLedger> shared_ledger_;
+
+  // Only touched by the polling thread.
+  bool under_pressure_ = false;
+  uint64_t last_budget_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable exit_requested_cv_;
+  bool exit_requested_ = false;  // protected by mutex_
+
+  std::thread thread_;  // must be last
+};
+
+}  // namespace tensorflow
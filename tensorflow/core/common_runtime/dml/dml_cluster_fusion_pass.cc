@@ -0,0 +1,549 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/common_runtime/dml/dml_fused_elementwise.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Largest cluster we'll collapse into a single _DmlFusedGraph node. This
+// bounds the size of the compiled DML graph and keeps kernel cache keys from
+// growing without bound.
+constexpr int kMaxClusterSize = 32;
+
+// Bound on the fused node's external inputs plus outputs, which together
+// determine the size of its binding table.
+constexpr int kMaxClusterBindings = 24;
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+const string& NodeDevice(const Node* n) {
+  return n->assigned_device_name().empty() ? n->requested_device()
+                                           : n->assigned_device_name();
+}
+
+bool IsFusableNode(const Node* n) {
+  if (DmlFusedElementwiseArity(n->type_string()) == 0) {
+    return false;
+  }
+
+  if (!IsDmlDevice(n)) {
+    return false;
+  }
+
+  // The fused kernel is only registered for float types; integer elementwise
+  // ops go through int64 emulation paths which the fused kernel doesn't
+  // implement.
+  DataType dtype;
+  if (!TryGetNodeAttr(n->attrs(), "T", &dtype) ||
+      (dtype != DT_FLOAT && dtype != DT_HALF)) {
+    return false;
+  }
+
+  return true;
+}
+
+struct FusionCluster {
+  // The cluster nodes in a topological order of the original graph. Unlike a
+  // fusion chain, a node's result may fan out to several cluster nodes, and
+  // several nodes may have consumers outside the cluster.
+  std::vector<Node*> nodes;
+
+  // fp16/fp32 bridging Casts absorbed into the fused node's input types: Casts
+  // all of whose consumers are cluster nodes get bypassed, and the fused node
+  // converts as it loads.
+  std::vector<Node*> cast_nodes;
+};
+
+// Grows the connected component of fusable nodes containing `seed` (bounded by
+// kMaxClusterSize), restricted to nodes placed on the same device and
+// computing in the same type: the fused kernel evaluates the whole cluster in
+// one compute type.
+void GrowCluster(Node* seed, const std::unordered_set<Node*>& consumed,
+                 std::unordered_set<Node*>* members) {
+  DataType seed_type;
+  TF_CHECK_OK(GetNodeAttr(seed->attrs(), "T", &seed_type));
+
+  std::deque<Node*> worklist = {seed};
+  members->insert(seed);
+
+  while (!worklist.empty() &&
+         members->size() < static_cast<size_t>(kMaxClusterSize)) {
+    Node* n = worklist.front();
+    worklist.pop_front();
+
+    auto maybe_add = [&](Node* candidate) {
+      if (members->count(candidate) || consumed.count(candidate) ||
+          !IsFusableNode(candidate) ||
+          NodeDevice(candidate) != NodeDevice(seed)) {
+        return;
+      }
+      DataType candidate_type;
+      if (!TryGetNodeAttr(candidate->attrs(), "T", &candidate_type) ||
+          candidate_type != seed_type) {
+        return;
+      }
+      if (members->size() >= static_cast<size_t>(kMaxClusterSize)) {
+        return;
+      }
+      members->insert(candidate);
+      worklist.push_back(candidate);
+    };
+
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge()) {
+        maybe_add(e->src());
+      }
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge()) {
+        maybe_add(e->dst());
+      }
+    }
+  }
+}
+
+// Collapsing a cluster into one node is only legal if no path leaves the
+// cluster and re-enters it; such a path would become a self-loop. Walks
+// forward from every edge that exits the cluster and removes any cluster node
+// the walk reaches, repeating until the contraction is acyclic. The chain pass
+// sidesteps this with its single-consumer rule; arbitrary DAG clusters have to
+// check.
+void TrimToAcyclic(std::unordered_set<Node*>* members) {
+  while (true) {
+    std::unordered_set<const Node*> visited;
+    std::deque<const Node*> worklist;
+
+    for (const Node* n : *members) {
+      for (const Edge* e : n->out_edges()) {
+        if (!members->count(e->dst()) && !visited.count(e->dst())) {
+          visited.insert(e->dst());
+          worklist.push_back(e->dst());
+        }
+      }
+    }
+
+    std::vector<Node*> reached;
+    while (!worklist.empty()) {
+      const Node* n = worklist.front();
+      worklist.pop_front();
+
+      for (const Edge* e : n->out_edges()) {
+        const Node* dst = e->dst();
+        if (visited.count(dst)) {
+          continue;
+        }
+        if (members->count(const_cast<Node*>(dst))) {
+          reached.push_back(const_cast<Node*>(dst));
+        }
+        visited.insert(dst);
+        worklist.push_back(dst);
+      }
+    }
+
+    if (reached.empty()) {
+      return;
+    }
+    for (Node* n : reached) {
+      members->erase(n);
+    }
+  }
+}
+
+// A Cast that only bridges the half/float boundary can fold into the fused
+// kernel's tensor descs, converting in-flight instead of as a standalone
+// read-write pass. The DML Cast kernel ignores the Truncate attr, so
+// absorbing one keeps parity with the standalone kernel.
+bool IsAbsorbableCast(const Node* n) {
+  if (n->type_string() != "Cast" || !IsDmlDevice(n)) {
+    return false;
+  }
+
+  DataType src_type, dst_type;
+  if (!TryGetNodeAttr(n->attrs(), "SrcT", &src_type) ||
+      !TryGetNodeAttr(n->attrs(), "DstT", &dst_type)) {
+    return false;
+  }
+
+  auto is_fusable_type = [](DataType t) {
+    return t == DT_FLOAT || t == DT_HALF;
+  };
+  return is_fusable_type(src_type) && is_fusable_type(dst_type) &&
+         src_type != dst_type;
+}
+
+// Finalizes `members` into a FusionCluster: orders the nodes topologically
+// (the fused kernel evaluates them in list order) and absorbs producer Casts
+// all of whose consumers lie inside the cluster.
+void BuildCluster(const std::unordered_set<Node*>& members,
+                  const std::unordered_set<Node*>& consumed,
+                  FusionCluster* cluster) {
+  // Kahn's algorithm over the edges internal to the cluster.
+  std::unordered_map<Node*, int> internal_in_degree;
+  for (Node* n : members) {
+    int degree = 0;
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge() && members.count(e->src())) {
+        ++degree;
+      }
+    }
+    internal_in_degree[n] = degree;
+  }
+
+  std::deque<Node*> ready;
+  for (Node* n : members) {
+    if (internal_in_degree[n] == 0) {
+      ready.push_back(n);
+    }
+  }
+  while (!ready.empty()) {
+    Node* n = ready.front();
+    ready.pop_front();
+    cluster->nodes.push_back(n);
+
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || !members.count(e->dst())) {
+        continue;
+      }
+      if (--internal_in_degree[e->dst()] == 0) {
+        ready.push_back(e->dst());
+      }
+    }
+  }
+  CHECK(cluster->nodes.size() == members.size());
+
+  std::unordered_set<Node*> absorbed;
+  for (Node* n : cluster->nodes) {
+    for (const Edge* e : n->in_edges()) {
+      Node* src = e->src();
+      if (e->IsControlEdge() || members.count(src) || absorbed.count(src) ||
+          !IsAbsorbableCast(src) || consumed.count(src)) {
+        continue;
+      }
+
+      bool all_consumers_internal = true;
+      for (const Edge* out : src->out_edges()) {
+        if (out->IsControlEdge() || !members.count(out->dst())) {
+          all_consumers_internal = false;
+          break;
+        }
+      }
+      if (all_consumers_internal) {
+        absorbed.insert(src);
+        cluster->cast_nodes.push_back(src);
+      }
+    }
+  }
+}
+
+// Counts the bindings the fused node would need: distinct external input
+// tensors plus cluster outputs. Used to reject clusters whose binding tables
+// would grow past kMaxClusterBindings.
+int CountBindings(const FusionCluster& cluster) {
+  std::unordered_set<Node*> members(cluster.nodes.begin(),
+                                    cluster.nodes.end());
+  std::unordered_set<Node*> absorbed(cluster.cast_nodes.begin(),
+                                     cluster.cast_nodes.end());
+
+  std::set<std::pair<const Node*, int>> external_inputs;
+  int num_outputs = 0;
+
+  for (Node* n : cluster.nodes) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge() || members.count(e->src())) {
+        continue;
+      }
+      const Edge* source = e;
+      if (absorbed.count(e->src())) {
+        TF_CHECK_OK(e->src()->input_edge(0, &source));
+      }
+      external_inputs.insert({source->src(), source->src_output()});
+    }
+
+    bool has_data_consumer = false;
+    bool has_external_consumer = false;
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) {
+        continue;
+      }
+      has_data_consumer = true;
+      if (!members.count(e->dst())) {
+        has_external_consumer = true;
+      }
+    }
+    if (has_external_consumer || !has_data_consumer) {
+      ++num_outputs;
+    }
+  }
+
+  return static_cast<int>(external_inputs.size()) + num_outputs;
+}
+
+Status ReplaceCluster(Graph* g, const FusionCluster& cluster) {
+  std::unordered_set<Node*> members(cluster.nodes.begin(),
+                                    cluster.nodes.end());
+  std::unordered_set<Node*> absorbed(cluster.cast_nodes.begin(),
+                                     cluster.cast_nodes.end());
+
+  Node* head = cluster.nodes.front();
+
+  DataType dtype;
+  TF_RETURN_IF_ERROR(GetNodeAttr(head->attrs(), "T", &dtype));
+
+  // Collect external inputs (deduplicated by source tensor) and encode every
+  // cluster node's operands. An operand reference below num external inputs
+  // names a fused-node input; larger values name an earlier cluster node's
+  // result. This runs at rewrite time rather than while gathering clusters,
+  // because replacing an earlier cluster rewires edges that feed this one.
+  std::map<std::pair<const Node*, int>, int> external_input_indices;
+  std::vector<NodeBuilder::NodeOut> inputs;
+  std::vector<DataType> input_types;
+
+  std::unordered_map<const Node*, int> node_indices;
+  for (size_t i = 0; i < cluster.nodes.size(); ++i) {
+    node_indices[cluster.nodes[i]] = static_cast<int>(i);
+  }
+
+  std::vector<string> op_names;
+  std::vector<int32> node_args;
+  std::vector<int32> output_nodes;
+  std::vector<DataType> out_types;
+  std::vector<Node*> output_cluster_nodes;
+
+  // The operand encoding is only stable if the external input count is fixed
+  // before node_args is emitted, so gather inputs in a first walk.
+  for (Node* n : cluster.nodes) {
+    for (int input_index = 0; input_index < n->num_inputs(); ++input_index) {
+      const Edge* e;
+      TF_RETURN_IF_ERROR(n->input_edge(input_index, &e));
+      if (members.count(e->src())) {
+        continue;
+      }
+      if (absorbed.count(e->src())) {
+        TF_RETURN_IF_ERROR(e->src()->input_edge(0, &e));
+      }
+
+      auto key = std::make_pair<const Node*, int>(e->src(), e->src_output());
+      if (external_input_indices.emplace(key, inputs.size()).second) {
+        inputs.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+        input_types.push_back(e->src()->output_type(e->src_output()));
+      }
+    }
+  }
+
+  const int num_external_inputs = static_cast<int>(inputs.size());
+
+  for (Node* n : cluster.nodes) {
+    op_names.push_back(n->type_string());
+
+    for (int input_index = 0; input_index < n->num_inputs(); ++input_index) {
+      const Edge* e;
+      TF_RETURN_IF_ERROR(n->input_edge(input_index, &e));
+
+      if (members.count(e->src())) {
+        node_args.push_back(num_external_inputs + node_indices[e->src()]);
+        continue;
+      }
+      if (absorbed.count(e->src())) {
+        TF_RETURN_IF_ERROR(e->src()->input_edge(0, &e));
+      }
+      auto key = std::make_pair<const Node*, int>(e->src(), e->src_output());
+      node_args.push_back(external_input_indices.at(key));
+    }
+
+    // A node's result becomes a fused-node output if anything outside the
+    // cluster consumes it, or if nothing consumes it at all (so the value
+    // isn't silently dead-code eliminated out of the compiled graph).
+    bool has_data_consumer = false;
+    bool has_external_consumer = false;
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) {
+        continue;
+      }
+      has_data_consumer = true;
+      if (!members.count(e->dst())) {
+        has_external_consumer = true;
+      }
+    }
+    if (has_external_consumer || !has_data_consumer) {
+      output_nodes.push_back(node_indices[n]);
+      out_types.push_back(n->output_type(0));
+      output_cluster_nodes.push_back(n);
+    }
+  }
+
+  NodeDebugInfo debug_info(*cluster.nodes.back());
+  NodeBuilder builder(g->NewName(strings::StrCat(head->name(), "/dml_cluster")),
+                      "_DmlFusedGraph", OpRegistry::Global(), &debug_info);
+
+  Node* fused = nullptr;
+  TF_RETURN_IF_ERROR(builder.Device(head->requested_device())
+                         .Input(inputs)
+                         .Attr("T", dtype)
+                         .Attr("input_types", input_types)
+                         .Attr("out_types", out_types)
+                         .Attr("op_names", op_names)
+                         .Attr("node_args", node_args)
+                         .Attr("output_nodes", output_nodes)
+                         .Finalize(g, &fused));
+  fused->set_assigned_device_name(head->assigned_device_name());
+
+  // Move control edges from all fused-away nodes onto the fused node, and
+  // rewire each output node's external data consumers to the matching fused
+  // output slot.
+  for (Node* n : cluster.nodes) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge() && !members.count(e->src())) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() && !members.count(e->dst())) {
+        g->AddControlEdge(fused, e->dst());
+      }
+    }
+  }
+  for (Node* n : cluster.cast_nodes) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+  }
+
+  for (size_t o = 0; o < output_cluster_nodes.size(); ++o) {
+    Node* n = output_cluster_nodes[o];
+    std::vector<const Edge*> out_edges(n->out_edges().begin(),
+                                       n->out_edges().end());
+    for (const Edge* e : out_edges) {
+      if (!e->IsControlEdge() && !members.count(e->dst())) {
+        g->AddEdge(fused, static_cast<int>(o), e->dst(), e->dst_input());
+      }
+    }
+  }
+
+  for (Node* n : cluster.nodes) {
+    g->RemoveNode(n);
+  }
+  for (Node* n : cluster.cast_nodes) {
+    g->RemoveNode(n);
+  }
+
+  return Status::OK();
+}
+
+// Collapses maximal connected clusters of elementwise ops placed on DML
+// devices into single _DmlFusedGraph nodes. Where the elementwise fusion pass
+// only follows single-consumer producer/consumer chains, this pass clusters
+// arbitrary DAGs - fan-out to several consumers inside the cluster, several
+// externally visible results - and compiles each cluster to one DML graph, so
+// a cluster of N ops costs one binding table and one dispatch instead of N.
+// Runs ahead of the chain pass; whatever this pass declines (or everything,
+// when disabled) still falls through to chain fusion.
+class DmlClusterFusionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool fusion_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_CLUSTER_FUSION",
+                                          /*default_val=*/true,
+                                          &fusion_enabled));
+    if (!fusion_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather clusters first, then rewrite, so that iteration never walks over
+    // deleted nodes. `consumed` tracks nodes already claimed by a cluster.
+    std::vector<FusionCluster> clusters;
+    std::unordered_set<Node*> consumed;
+
+    for (Node* n : g->op_nodes()) {
+      if (consumed.count(n) || !IsFusableNode(n)) {
+        continue;
+      }
+
+      std::unordered_set<Node*> members;
+      GrowCluster(n, consumed, &members);
+      TrimToAcyclic(&members);
+      if (members.empty() || !members.count(n)) {
+        continue;
+      }
+
+      FusionCluster cluster;
+      BuildCluster(members, consumed, &cluster);
+
+      // A cluster is worth fusing once it eliminates at least one dispatch;
+      // absorbed Casts count, so even a lone op bracketed by AMP Casts fuses.
+      if (cluster.nodes.size() + cluster.cast_nodes.size() < 2 ||
+          CountBindings(cluster) > kMaxClusterBindings) {
+        continue;
+      }
+
+      consumed.insert(cluster.nodes.begin(), cluster.nodes.end());
+      consumed.insert(cluster.cast_nodes.begin(), cluster.cast_nodes.end());
+      clusters.push_back(std::move(cluster));
+    }
+
+    for (const FusionCluster& cluster : clusters) {
+      if (VLOG_IS_ON(1)) {
+        std::vector<string> op_names;
+        for (const Node* n : cluster.nodes) {
+          op_names.push_back(n->type_string());
+        }
+        VLOG(1) << "DmlClusterFusionPass: fusing "
+                << absl::StrJoin(op_names, "+") << " rooted at '"
+                << cluster.nodes.front()->name() << "'";
+      }
+      TF_RETURN_IF_ERROR(ReplaceCluster(options.graph->get(), cluster));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement so that device assignments are known, and just ahead of
+// DmlElementwiseFusionPass (priority 25) so clusters get first claim on the
+// graph's elementwise nodes.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 24,
+                      DmlClusterFusionPass);
+
+}  // namespace
+}  // namespace tensorflow
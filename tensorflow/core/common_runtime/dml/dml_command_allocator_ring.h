@@ -17,17 +17,25 @@ limitations under the License.
 
 #include "dml_common.h"
 #include "dml_gpu_event.h"
+#include "dml_tracing.h"
 
 namespace tensorflow {
 
-// A fixed-size ring of command allocators. Each time an allocator is retrieved,
-// the allocator will be reset if its previously recorded commands have finished
-// executing on the GPU.
-template <size_t allocator_count>
+// A ring of command allocators. Each time an allocator is retrieved, the
+// allocator will be reset if its previously recorded commands have finished
+// executing on the GPU. If the next allocator in line is still in flight on
+// the GPU, the ring grows by inserting a fresh allocator rather than reusing
+// an un-reset one (which would leak recorded command memory for the rest of
+// the allocator's lifetime). When demand subsides, surplus allocators are
+// released and the ring shrinks back to its minimum size, given by the
+// template parameter.
+template <size_t minimum_allocator_count>
 class DmlCommandAllocatorRing {
  public:
   DmlCommandAllocatorRing(ID3D12Device* device,
-                          D3D12_COMMAND_LIST_TYPE command_list_type) {
+                          D3D12_COMMAND_LIST_TYPE command_list_type)
+      : device_(device), command_list_type_(command_list_type) {
+    command_allocators_.resize(minimum_allocator_count);
     for (auto& info : command_allocators_) {
       DML_CHECK_SUCCEEDED(device->CreateCommandAllocator(
           command_list_type, IID_PPV_ARGS(&info.allocator)));
@@ -38,10 +46,42 @@ class DmlCommandAllocatorRing {
     CommandAllocatorInfo& allocator_info =
         command_allocators_[current_command_allocator_];
 
-    // Take the opportunity to reset the command allocator if possible.
     if (allocator_info.completion_event.fence &&
-        allocator_info.completion_event.IsSignaled()) {
-      DML_CHECK_SUCCEEDED(allocator_info.Get()->Reset());
+        !allocator_info.completion_event.IsSignaled()) {
+      // The current allocator's commands are still executing on the GPU, so
+      // it can't be reset yet. Grow the ring with a fresh allocator instead
+      // of reusing the un-reset one.
+      DmlTracing::Instance().LogCommandAllocatorRingGrowth();
+
+      CommandAllocatorInfo new_info = {};
+      DML_CHECK_SUCCEEDED(device_->CreateCommandAllocator(
+          command_list_type_, IID_PPV_ARGS(&new_info.allocator)));
+      command_allocators_.insert(
+          command_allocators_.begin() + current_command_allocator_,
+          std::move(new_info));
+    } else {
+      // Take the opportunity to reset the command allocator if possible.
+      if (allocator_info.completion_event.fence) {
+        DML_CHECK_SUCCEEDED(allocator_info.Get()->Reset());
+        allocator_info.completion_event = {};
+      }
+
+      // The ring has spare capacity if the allocator after this one is also
+      // idle; release it until we're back down to the minimum size.
+      while (command_allocators_.size() > minimum_allocator_count) {
+        size_t next =
+            (current_command_allocator_ + 1) % command_allocators_.size();
+        CommandAllocatorInfo& next_info = command_allocators_[next];
+        if (next_info.completion_event.fence &&
+            !next_info.completion_event.IsSignaled()) {
+          break;
+        }
+
+        command_allocators_.erase(command_allocators_.begin() + next);
+        if (next < current_command_allocator_) {
+          --current_command_allocator_;
+        }
+      }
     }
 
     return command_allocators_[current_command_allocator_].Get();
@@ -55,7 +95,7 @@ class DmlCommandAllocatorRing {
 
     // Advance to the next allocator.
     current_command_allocator_ =
-        (current_command_allocator_ + 1) % allocator_count;
+        (current_command_allocator_ + 1) % command_allocators_.size();
   }
 
  private:
@@ -69,8 +109,11 @@ class DmlCommandAllocatorRing {
     ID3D12CommandAllocator* Get() const { return allocator.Get(); }
   };
 
-  std::array<CommandAllocatorInfo, allocator_count> command_allocators_;
+  ID3D12Device* device_;  // Weak; owned by the device state
+  D3D12_COMMAND_LIST_TYPE command_list_type_;
+
+  std::vector<CommandAllocatorInfo> command_allocators_;
   size_t current_command_allocator_ = 0;
 };
 
-}  // namespace tensorflow
\ No newline at end of file
+}  // namespace tensorflow
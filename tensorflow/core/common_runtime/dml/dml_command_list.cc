@@ -24,13 +24,15 @@ namespace tensorflow {
 
 DmlCommandList::DmlCommandList(ID3D12Device* d3d_device, IDMLDevice* dml_device,
                                D3D12_COMMAND_LIST_TYPE command_list_type,
-                               DmlAllocator* allocator)
+                               DmlAllocator* allocator,
+                               std::unique_ptr<DmlGpuProfiler> profiler)
     : d3d_device_(d3d_device),
       dml_device_(dml_device),
       command_list_type_(command_list_type),
       descriptor_pool_(d3d_device, 2048),
       allocator_(allocator),
-      command_allocator_ring_(d3d_device, command_list_type) {
+      command_allocator_ring_(d3d_device, command_list_type),
+      profiler_(std::move(profiler)) {
   DML_CHECK_SUCCEEDED(
       dml_device->CreateCommandRecorder(IID_PPV_ARGS(&recorder_)));
 }
@@ -164,8 +166,12 @@ void DmlCommandList::InitializeOperator(IDMLOperatorInitializer* initializer,
 
 void DmlCommandList::ExecuteOperator(IDMLCompiledOperator* op,
                                      IDMLBindingTable* binding_table,
-                                     ID3D12DescriptorHeap* descriptor_heap) {
+                                     ID3D12DescriptorHeap* descriptor_heap,
+                                     const std::string& op_name) {
   DmlTracing::Instance().LogExecuteOperatorStart(op, d3d_command_list_.Get());
+  if (profiler_) {
+    profiler_->BeginOp(d3d_command_list_.Get(), op, op_name);
+  }
 
   // Record the execution work.
   SetDescriptorHeap(descriptor_heap);
@@ -177,6 +183,9 @@ void DmlCommandList::ExecuteOperator(IDMLCompiledOperator* op,
       CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, nullptr)};
   d3d_command_list_->ResourceBarrier(ABSL_ARRAYSIZE(barriers), barriers);
 
+  if (profiler_) {
+    profiler_->EndOp(d3d_command_list_.Get());
+  }
   DmlTracing::Instance().LogExecuteOperatorEnd(d3d_command_list_.Get());
 }
 
@@ -220,9 +229,17 @@ void DmlCommandList::Open(DmlGpuEvent completion_event) {
   // The current command allocator will become eligible for reset once this
   // command list completes execution
   command_allocator_ring_.AdvanceAllocator(completion_event);
+
+  if (profiler_) {
+    profiler_->BeginFlush(std::move(completion_event));
+  }
 }
 
 Status DmlCommandList::Close() {
+  if (profiler_) {
+    profiler_->EndFlush(d3d_command_list_.Get());
+  }
+
   HRESULT hr = d3d_command_list_->Close();
   if (dml_util::HrIsOutOfMemory(hr)) {
     return errors::ResourceExhausted("OOM when closing the command list");
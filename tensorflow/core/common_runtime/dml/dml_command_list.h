@@ -18,6 +18,7 @@ limitations under the License.
 #include "dml_command_allocator_ring.h"
 #include "dml_common.h"
 #include "dml_descriptor_pool.h"
+#include "dml_gpu_profiler.h"
 #include "dml_status.h"
 
 namespace tensorflow {
@@ -28,10 +29,12 @@ class DmlCommandQueue;
 // command allocator. This class is NOT thread safe.
 class DmlCommandList {
  public:
-  // Constructs a command list.
+  // Constructs a command list. The profiler is optional; when supplied, each
+  // recorded operator dispatch is bracketed with GPU timestamp queries.
   DmlCommandList(ID3D12Device* d3d12_device, IDMLDevice* dml_device,
                  D3D12_COMMAND_LIST_TYPE command_list_type,
-                 DmlAllocator* allocator);
+                 DmlAllocator* allocator,
+                 std::unique_ptr<DmlGpuProfiler> profiler = nullptr);
 
   // Records a CopyBufferRegion (see
   // ID3D12GraphicsCommandList::CopyBufferRegion) for execution. Transition
@@ -55,10 +58,13 @@ class DmlCommandList {
                           ID3D12DescriptorHeap* descriptor_heap);
 
   // Records DML operator execution into the command list. It's safe to release
-  // the binding table immediately after this is called.
+  // the binding table immediately after this is called. op_name is only used
+  // to attribute profiler timings and may be empty (see
+  // DmlGpuProfiler::BeginOp).
   void ExecuteOperator(IDMLCompiledOperator* op,
                        IDMLBindingTable* binding_table,
-                       ID3D12DescriptorHeap* descriptor_heap);
+                       ID3D12DescriptorHeap* descriptor_heap,
+                       const std::string& op_name = std::string());
 
   // Records a resoruce barrier into the command list.
   void ResourceBarrier(absl::Span<const D3D12_RESOURCE_BARRIER> barriers);
@@ -80,6 +86,10 @@ class DmlCommandList {
   // Returns a pointer to the underlying D3D command list.
   ID3D12CommandList* Get() { return d3d_command_list_.Get(); }
 
+  // Returns the GPU timestamp profiler, or null if the queue doesn't support
+  // timestamp queries.
+  DmlGpuProfiler* GetProfiler() const { return profiler_.get(); }
+
  private:
   Microsoft::WRL::ComPtr<ID3D12Device> d3d_device_;
   Microsoft::WRL::ComPtr<IDMLDevice> dml_device_;
@@ -98,6 +108,9 @@ class DmlCommandList {
   DmlAllocator* allocator_ = nullptr;
   DmlCommandAllocatorRing<2> command_allocator_ring_;
 
+  // Optional GPU timestamp profiler; null if timestamps are unsupported.
+  std::unique_ptr<DmlGpuProfiler> profiler_;
+
   void SetDescriptorHeap(ID3D12DescriptorHeap* descriptor_heap);
 };
 
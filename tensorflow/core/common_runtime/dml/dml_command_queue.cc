@@ -35,6 +35,59 @@ void DmlCommandQueue::ExecuteCommandLists(
   DML_CHECK_SUCCEEDED(queue_->Signal(fence_.Get(), last_fence_value_));
 }
 
+void DmlCommandQueue::ExecuteCommandListsWithoutSignal(
+    absl::Span<ID3D12CommandList*> command_lists) {
+  queue_->ExecuteCommandLists(static_cast<uint32_t>(command_lists.size()),
+                              command_lists.data());
+}
+
+void DmlCommandQueue::Wait(ID3D12Fence* fence, uint64_t value) {
+  // Waiting on this queue's own fence at an already-submitted value is a
+  // no-op: command lists on a queue execute in submission order, so the work
+  // that signals that value completes before anything submitted after this
+  // call begins.
+  if (fence == fence_.Get() && value <= last_fence_value_) {
+    return;
+  }
+
+  // A fence that has already reached the value would retire the wait
+  // immediately; skip the kernel call.
+  if (fence->GetCompletedValue() >= value) {
+    return;
+  }
+
+  // A previously queued wait at an equal or higher value gates everything
+  // submitted after it — including whatever this wait was meant to guard —
+  // so this wait is dominated.
+  auto it = waited_fences_.find(fence);
+  if (it != waited_fences_.end() && it->second.value >= value) {
+    return;
+  }
+
+  DML_CHECK_SUCCEEDED(queue_->Wait(fence, value));
+
+  if (it != waited_fences_.end()) {
+    it->second.value = value;
+    return;
+  }
+
+  // Bound the map by dropping entries the completed-value check above now
+  // covers. Only a handful of fences ever wait on a given queue (the other
+  // queues' fences, the residency fence, imported interop fences), so this
+  // rarely triggers.
+  if (waited_fences_.size() >= 8) {
+    for (auto entry = waited_fences_.begin(); entry != waited_fences_.end();) {
+      if (entry->first->GetCompletedValue() >= entry->second.value) {
+        waited_fences_.erase(entry++);
+      } else {
+        ++entry;
+      }
+    }
+  }
+
+  waited_fences_.emplace(fence, WaitedFence{fence, value});
+}
+
 DmlGpuEvent DmlCommandQueue::GetCurrentCompletionEvent() {
   return DmlGpuEvent{last_fence_value_, fence_};
 }
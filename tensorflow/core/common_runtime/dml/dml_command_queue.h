@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <deque>
 
+#include "absl/container/flat_hash_map.h"
 #include "dml_common.h"
 #include "dml_gpu_event.h"
 
@@ -35,6 +36,21 @@ class DmlCommandQueue {
 
   void ExecuteCommandLists(absl::Span<ID3D12CommandList*> command_lists);
 
+  // Same as ExecuteCommandLists, but without signaling the fence. Used to
+  // submit intermediate segments of a batch that completes on a single fence
+  // value; the final segment must be submitted with ExecuteCommandLists.
+  void ExecuteCommandListsWithoutSignal(
+      absl::Span<ID3D12CommandList*> command_lists);
+
+  // Queues a GPU-side wait: work submitted to this queue after this call does
+  // not begin executing until the given fence reaches `value`. Waits that the
+  // queue's timeline already implies — the fence has reached the value, a
+  // previously queued wait on the same fence covers it, or it is this queue's
+  // own fence at an already-submitted value — are dropped without touching
+  // the kernel, since fence operations are measurable kernel-mode overhead at
+  // the submission rates small-op graphs produce.
+  void Wait(ID3D12Fence* fence, uint64_t value);
+
   // Returns an event that will become signaled when everything submitted to the
   // queue thus far has completed execution on the GPU.
   DmlGpuEvent GetCurrentCompletionEvent();
@@ -49,6 +65,16 @@ class DmlCommandQueue {
 
   Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
   uint64_t last_fence_value_ = 0;
+
+  // The highest value this queue has been made to wait for, per foreign
+  // fence; later waits at or below that value are dominated and skipped. The
+  // ComPtr keeps the keyed fence alive so a recycled pointer can't alias a
+  // stale entry. Satisfied entries are pruned once the map grows.
+  struct WaitedFence {
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+    uint64_t value;
+  };
+  absl::flat_hash_map<ID3D12Fence*, WaitedFence> waited_fences_;
 };
 
 }  // namespace tensorflow
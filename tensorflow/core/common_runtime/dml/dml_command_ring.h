@@ -0,0 +1,122 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <utility>
+
+namespace tensorflow {
+
+// A bounded, lock-free multi-producer/single-consumer ring buffer (Vyukov's
+// bounded queue). Producers never block each other: enqueueing is a single
+// fetch_add plus a per-cell sequence handshake, so op threads recording GPU
+// commands don't contend on a shared mutex.
+//
+// TryEnqueue/TryDequeue fail (returning false) when the ring is full/empty
+// respectively; producers are expected to yield and retry on a full ring.
+template <typename T>
+class DmlCommandRing {
+ public:
+  // `capacity` must be a power of two.
+  explicit DmlCommandRing(size_t capacity)
+      : cells_(new Cell[capacity]), mask_(capacity - 1) {
+    assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+    for (size_t i = 0; i < capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    enqueue_pos_.store(0, std::memory_order_relaxed);
+    dequeue_pos_.store(0, std::memory_order_relaxed);
+  }
+
+  DmlCommandRing(const DmlCommandRing&) = delete;
+  DmlCommandRing& operator=(const DmlCommandRing&) = delete;
+
+  // Thread-safe; may be called from any number of producer threads.
+  bool TryEnqueue(T&& value) {
+    Cell* cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // Full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // NOT thread-safe; must only be called from the single consumer thread.
+  bool TryDequeue(T* out) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell = &cells_[pos & mask_];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff < 0) {
+      return false;  // Empty
+    }
+    assert(diff == 0);
+
+    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    *out = std::move(cell->value);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate; safe to call from any thread.
+  bool Empty() const {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    const Cell& cell = cells_[pos & mask_];
+    return cell.sequence.load(std::memory_order_acquire) < pos + 1;
+  }
+
+  // Approximate number of queued elements; safe to call from any thread. The
+  // result may be momentarily stale, so it's only suitable for heuristics
+  // (e.g. deciding when a batch is big enough to flush).
+  size_t ApproxSize() const {
+    size_t enqueue_pos = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t dequeue_pos = dequeue_pos_.load(std::memory_order_relaxed);
+    return enqueue_pos >= dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+
+  // Padded apart so producers and the consumer don't false-share.
+  alignas(64) std::atomic<size_t> enqueue_pos_;
+  alignas(64) std::atomic<size_t> dequeue_pos_;
+};
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_constant_pool.h"
+
+#include "dml_upload_heap.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+
+namespace tensorflow {
+
+DmlConstantPool::DmlConstantPool(DmlAllocator* allocator,
+                                 DmlUploadHeap* upload_heap)
+    : allocator_(allocator), upload_heap_(upload_heap) {}
+
+StatusOr<std::shared_ptr<const DmlBuffer>> DmlConstantPool::AcquireBuffer(
+    absl::Span<const uint8_t> data) {
+  uint64 hash = Hash64(reinterpret_cast<const char*>(data.data()), data.size());
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto range = entries_.equal_range(hash);
+  for (auto it = range.first; it != range.second;) {
+    if (it->second.data.size() == data.size() &&
+        memcmp(it->second.data.data(), data.data(), data.size()) == 0) {
+      if (auto buffer = it->second.buffer.lock()) {
+        VLOG(2) << "DmlConstantPool: sharing existing constant buffer of "
+                << data.size() << " bytes";
+        return buffer;
+      }
+
+      // The last kernel referencing this constant was released; fall through
+      // and upload it again into a fresh buffer.
+      it = entries_.erase(it);
+      continue;
+    }
+    ++it;
+  }
+
+  auto buffer = std::make_shared<DmlBuffer>(allocator_, data.size());
+  if (!*buffer) {
+    return errors::ResourceExhausted("OOM when allocating a buffer of ",
+                                     data.size(), " bytes");
+  }
+
+  // The upload is queued onto the device's execution context (or copy queue),
+  // which orders it before any subsequent kernel that binds this buffer. The
+  // upload heap copies the source bytes into staging memory, so `data` does
+  // not need to outlive this call.
+  TF_RETURN_IF_ERROR(upload_heap_
+                         ->BeginUploadToGpu(
+                             buffer->Resource(), buffer->Offset(),
+                             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, data)
+                         .status());
+
+  Entry entry;
+  entry.data.assign(data.begin(), data.end());
+  entry.buffer = buffer;
+  entries_.emplace(hash, std::move(entry));
+
+  return std::shared_ptr<const DmlBuffer>(std::move(buffer));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "dml_buffer.h"
+#include "dml_common.h"
+#include "dml_status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class DmlAllocator;
+class DmlUploadHeap;
+
+// A content-addressed pool of immutable GPU buffers. Many kernels upload
+// small constant data (e.g. stride/shape arrays derived from tensor shapes)
+// which is frequently identical across kernel instances; this pool hashes the
+// byte contents and hands out a shared buffer so identical constants are
+// uploaded and stored on the GPU only once.
+//
+// Returned buffers must never be written to. The pool holds only weak
+// references: a pooled buffer lives for as long as at least one caller holds
+// the returned shared_ptr (kernels typically hold it for their lifetime, so
+// sharing follows the kernel cache), and its memory returns to the allocator
+// when the last reference is dropped.
+//
+// This class is thread-safe.
+class DmlConstantPool {
+ public:
+  DmlConstantPool(DmlAllocator* allocator, DmlUploadHeap* upload_heap);
+
+  // Returns an immutable GPU buffer whose contents equal `data`, allocating
+  // and uploading it if no live buffer with identical contents exists. The
+  // upload is merely queued; it is ordered before any subsequent work
+  // submitted to the device's execution context, so the buffer is safe to
+  // bind immediately.
+  StatusOr<std::shared_ptr<const DmlBuffer>> AcquireBuffer(
+      absl::Span<const uint8_t> data);
+
+ private:
+  struct Entry {
+    // The exact bytes this entry was created with. Entries are bucketed by
+    // content hash, so this is what makes lookups collision-proof.
+    std::vector<uint8_t> data;
+    std::weak_ptr<const DmlBuffer> buffer;
+  };
+
+  DmlAllocator* allocator_;      // weak; owned by the DML device factory
+  DmlUploadHeap* upload_heap_;   // weak; owned by the DML device factory
+
+  std::mutex mutex_;
+
+  // Keyed by Hash64 of the buffer contents; a multimap because distinct
+  // contents may (rarely) share a hash.
+  std::unordered_multimap<uint64, Entry> entries_;
+};
+
+}  // namespace tensorflow
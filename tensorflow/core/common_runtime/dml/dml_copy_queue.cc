@@ -0,0 +1,128 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_copy_queue.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+using Microsoft::WRL::ComPtr;
+
+static ComPtr<ID3D12CommandQueue> CreateCopyQueue(
+    ID3D12Device* d3d_device, D3D12_COMMAND_QUEUE_PRIORITY priority) {
+  D3D12_COMMAND_QUEUE_DESC desc = {};
+  desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+  desc.Priority = priority;
+  desc.Flags = D3D12_COMMAND_QUEUE_FLAG_DISABLE_GPU_TIMEOUT;
+  desc.NodeMask = 0;
+
+  ComPtr<ID3D12CommandQueue> queue;
+  HRESULT hr = d3d_device->CreateCommandQueue(&desc, IID_PPV_ARGS(&queue));
+  if (FAILED(hr) && priority != D3D12_COMMAND_QUEUE_PRIORITY_NORMAL) {
+    LOG(WARNING) << "DirectML: creating the copy queue at the requested "
+                    "priority failed; falling back to normal priority.";
+    desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+    hr = d3d_device->CreateCommandQueue(&desc, IID_PPV_ARGS(&queue));
+  }
+  DML_CHECK_SUCCEEDED(hr);
+  return queue;
+}
+
+DmlCopyQueue::DmlCopyQueue(ID3D12Device* d3d_device,
+                           D3D12_COMMAND_QUEUE_PRIORITY priority)
+    : queue_(std::make_shared<DmlCommandQueue>(
+          CreateCopyQueue(d3d_device, priority).Get())),
+      allocator_ring_(d3d_device, D3D12_COMMAND_LIST_TYPE_COPY) {
+  DML_CHECK_SUCCEEDED(d3d_device->CreateCommandList(
+      0, D3D12_COMMAND_LIST_TYPE_COPY, allocator_ring_.GetCurrentAllocator(),
+      nullptr, IID_PPV_ARGS(&command_list_)));
+
+  // Command lists are created in the recording state, but we want to open them
+  // explicitly per copy.
+  DML_CHECK_SUCCEEDED(command_list_->Close());
+}
+
+StatusOr<DmlGpuEvent> DmlCopyQueue::EnqueueCopy(
+    ID3D12Resource* dst_buffer, uint64_t dst_offset, ID3D12Resource* src_buffer,
+    uint64_t src_offset, uint64_t byte_count,
+    absl::Span<const DmlGpuEvent> wait_events) {
+  CopyRegion region = {dst_buffer, dst_offset, src_buffer, src_offset,
+                       byte_count};
+  return EnqueueCopies(absl::Span<const CopyRegion>(&region, 1), wait_events);
+}
+
+StatusOr<DmlGpuEvent> DmlCopyQueue::EnqueueCopies(
+    absl::Span<const CopyRegion> regions,
+    absl::Span<const DmlGpuEvent> wait_events) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  assert(!regions.empty());
+
+  ID3D12CommandAllocator* allocator = allocator_ring_.GetCurrentAllocator();
+
+  HRESULT hr = command_list_->Reset(allocator, nullptr);
+  if (FAILED(hr)) {
+    return errors::Internal("Failed to reset copy command list: hr=", hr);
+  }
+
+  // No resource barriers: buffers decayed to COMMON after the command lists
+  // that the wait events guard completed, and COMMON buffers are implicitly
+  // promoted to the copy states on a COPY queue.
+  for (const CopyRegion& region : regions) {
+    assert(region.dst_buffer->GetDesc().Dimension ==
+           D3D12_RESOURCE_DIMENSION_BUFFER);
+    assert(region.src_buffer->GetDesc().Dimension ==
+           D3D12_RESOURCE_DIMENSION_BUFFER);
+
+    command_list_->CopyBufferRegion(region.dst_buffer, region.dst_offset,
+                                    region.src_buffer, region.src_offset,
+                                    region.byte_count);
+  }
+
+  hr = command_list_->Close();
+  if (FAILED(hr)) {
+    return errors::Internal("Failed to close copy command list: hr=", hr);
+  }
+
+  for (const DmlGpuEvent& pending_wait : pending_waits_) {
+    queue_->Wait(pending_wait.fence.Get(), pending_wait.fence_value);
+  }
+  pending_waits_.clear();
+
+  for (const DmlGpuEvent& wait_event : wait_events) {
+    queue_->Wait(wait_event.fence.Get(), wait_event.fence_value);
+  }
+
+  ID3D12CommandList* command_lists[] = {command_list_.Get()};
+  queue_->ExecuteCommandLists(command_lists);
+
+  DmlGpuEvent completion_event = queue_->GetCurrentCompletionEvent();
+  allocator_ring_.AdvanceAllocator(completion_event);
+
+  return completion_event;
+}
+
+void DmlCopyQueue::QueueDependency(DmlGpuEvent event) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_waits_.push_back(std::move(event));
+}
+
+DmlGpuEvent DmlCopyQueue::GetCurrentCompletionEvent() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return queue_->GetCurrentCompletionEvent();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include "dml_command_allocator_ring.h"
+#include "dml_command_queue.h"
+#include "dml_common.h"
+#include "dml_gpu_event.h"
+#include "dml_status.h"
+
+namespace tensorflow {
+
+// Owns a dedicated D3D12 COPY-type command queue used for upload (host to
+// device) and readback (device to host) transfers, so that transfers can
+// execute on the hardware copy engine in parallel with compute work on the
+// main DmlCommandQueue. Cross-queue ordering is expressed with fences: each
+// enqueued copy can be made to wait for GPU events from other queues, and the
+// returned event can in turn be waited on by other queues.
+//
+// Note that the copy command lists deliberately record no resource barriers.
+// COPY queues cannot transition resources out of states owned by other queue
+// types; instead, this class relies on D3D12's implicit state decay/promotion
+// for buffers: waiting on the main queue's fence guarantees that previously
+// submitted command lists have completed, at which point all buffers have
+// decayed to COMMON and are implicitly promoted to COPY_SOURCE/COPY_DEST.
+//
+// This class is thread-safe.
+class DmlCopyQueue {
+ public:
+  // `priority` matches the compute queue's priority (see
+  // TF_DIRECTML_QUEUE_PRIORITY); creation falls back to normal priority if
+  // the requested one is denied.
+  DmlCopyQueue(ID3D12Device* d3d_device, D3D12_COMMAND_QUEUE_PRIORITY priority);
+
+  // A single buffer-to-buffer copy within a batched submission.
+  struct CopyRegion {
+    ID3D12Resource* dst_buffer;
+    uint64_t dst_offset;
+    ID3D12Resource* src_buffer;
+    uint64_t src_offset;
+    uint64_t byte_count;
+  };
+
+  // Records and submits a buffer copy onto the copy queue. The copy waits (on
+  // the GPU timeline) for all of `wait_events` before beginning. Returns an
+  // event which is signaled when the copy completes; the caller is
+  // responsible for keeping both resources alive until then.
+  StatusOr<DmlGpuEvent> EnqueueCopy(ID3D12Resource* dst_buffer,
+                                    uint64_t dst_offset,
+                                    ID3D12Resource* src_buffer,
+                                    uint64_t src_offset, uint64_t byte_count,
+                                    absl::Span<const DmlGpuEvent> wait_events);
+
+  // Same as above, but records all of `regions` into one command list and
+  // submits them with a single ExecuteCommandLists/Signal, amortizing the
+  // per-submission overhead across many small copies. The returned event is
+  // signaled when every region has copied.
+  StatusOr<DmlGpuEvent> EnqueueCopies(
+      absl::Span<const CopyRegion> regions,
+      absl::Span<const DmlGpuEvent> wait_events);
+
+  // Causes the next enqueued copy (and, since the queue executes submissions
+  // in order, every copy after it) to wait for the given event before
+  // executing. Used by the heap allocator's asynchronous residency path to
+  // order uploads against an in-flight page-in of the destination's heap.
+  void QueueDependency(DmlGpuEvent event);
+
+  // Returns the fence that the copy queue signals when copies complete, for
+  // use with a DmlEventQueue.
+  Microsoft::WRL::ComPtr<ID3D12Fence> GetFence() const {
+    return queue_->GetFence();
+  }
+
+  DmlGpuEvent GetCurrentCompletionEvent();
+
+ private:
+  std::mutex mutex_;
+
+  // All of these members are protected by mutex_
+  std::shared_ptr<DmlCommandQueue> queue_;
+  DmlCommandAllocatorRing<2> allocator_ring_;
+  Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> command_list_;
+
+  // Events queued with QueueDependency; drained into the next submission's
+  // waits.
+  absl::InlinedVector<DmlGpuEvent, 4> pending_waits_;
+};
+
+}  // namespace tensorflow
@@ -0,0 +1,469 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Device-to-device tensor copies between DML devices. Without a registered
+// copy function, copy_tensor.cc bounces every DML -> DML transfer through a
+// host tensor (GPU readback, CPU copy, GPU upload). This file registers a
+// direct path instead:
+//
+//   * Devices sharing one device state (virtual devices on one adapter) are
+//     a plain same-queue copy.
+//   * Devices on the same adapter with private queues copy directly, ordered
+//     by a fence between the two queues.
+//   * Devices on different adapters copy through a cross-adapter shared heap
+//     (ID3D12Device::CreateSharedHandle), synchronized with shared fences, so
+//     neither the bytes nor the synchronization ever involve the CPU. Where
+//     the driver can't create cross-adapter heaps, the copy falls back to
+//     staging through host memory (still cheaper than the framework's
+//     fallback, which allocates and fills an intermediate host tensor).
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "dml_device.h"
+#include "dml_tensor_ref_tracker.h"
+#include "dml_util.h"
+#include "tensorflow/core/common_runtime/copy_tensor.h"
+#include "tensorflow/core/framework/tensor_reference.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/env_var.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace tensorflow {
+
+namespace {
+
+bool CrossAdapterCopyEnabled() {
+  static bool enabled = [] {
+    bool value = true;
+    Status s =
+        ReadBoolFromEnvVar("TF_DIRECTML_CROSS_ADAPTER_COPY", true, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+// Staging state for copies between one ordered (source, destination) pair of
+// adapters: a cross-adapter shared heap with a buffer placed in it on both
+// devices, and a shared fence in each direction. The write fence tells the
+// destination when the staged bytes are ready; the read fence tells the
+// source when the staging buffer may be overwritten. The buffer is a single
+// slot, so back-to-back copies between the same pair pipeline through the
+// fences rather than through extra memory.
+class CrossAdapterStaging {
+ public:
+  // Stages `byte_count` bytes from src_region (on src_device) to dst_region
+  // (on dst_device) and invokes `done` when the bytes have landed in the
+  // destination tensor. Returns an error without calling `done` if the
+  // staging state can't be created, in which case the caller should fall
+  // back to copying through the host.
+  Status Copy(DmlDevice* src_device, DmlDevice* dst_device,
+              const D3D12BufferRegion& src_region,
+              const D3D12BufferRegion& dst_region, const Tensor* input,
+              uint64_t byte_count, StatusCallback done) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (unsupported_) {
+      return errors::Unimplemented(
+          "Cross-adapter shared heaps are not supported for this device "
+          "pair");
+    }
+
+    TF_RETURN_IF_ERROR(EnsureCapacity(src_device, dst_device, byte_count));
+
+    const uint64_t seq = ++sequence_;
+
+    DmlExecutionContext* src_ctx = src_device->GetExecutionContext();
+    DmlExecutionContext* dst_ctx = dst_device->GetExecutionContext();
+
+    // Don't overwrite the single staging slot until the previous copy's read
+    // has retired on the destination GPU.
+    if (seq > 1) {
+      src_ctx->QueueDependency(DmlGpuEvent{seq - 1, read_fence_src_});
+    }
+
+    // Source: stage the bytes, then signal the write fence once the copy has
+    // completed on the source GPU. Cross-adapter buffers stay in the COMMON
+    // state and rely on implicit promotion/decay, so no barriers are needed
+    // on the staging side.
+    (void)src_ctx->CopyBufferRegion(
+        src_staging_.Get(), 0, D3D12_RESOURCE_STATE_COPY_DEST,
+        src_region.Resource(), src_region.Offset(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, byte_count);
+
+    StatusOr<DmlGpuEvent> src_flush_event = src_ctx->Flush();
+    TF_RETURN_IF_ERROR(src_flush_event.status());
+
+    // The source may free and reuse the input's memory the moment the tensor
+    // is released, so keep it referenced until the staging copy has executed.
+    TensorReference input_ref(*input);
+    DmlGpuEvent staging_copy_event = src_flush_event.ConsumeValueOrDie();
+    int64 ref_id =
+        DmlTensorRefTracker::Instance()->Track(input_ref, staging_copy_event);
+    ComPtr<ID3D12Fence> write_fence = write_fence_src_;
+    src_device->GetEventQueue()->Enqueue(
+        std::move(staging_copy_event), [write_fence, seq, input_ref, ref_id] {
+          DML_CHECK_SUCCEEDED(write_fence->Signal(seq));
+          DmlTensorRefTracker::Instance()->Untrack(ref_id);
+          input_ref.Unref();
+        });
+
+    // Destination: wait for the staged bytes on the GPU timeline, copy them
+    // into the output tensor, then signal the read fence and complete.
+    dst_ctx->QueueDependency(DmlGpuEvent{seq, write_fence_dst_});
+
+    (void)dst_ctx->CopyBufferRegion(
+        dst_region.Resource(), dst_region.Offset(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, dst_staging_.Get(), 0,
+        D3D12_RESOURCE_STATE_COPY_SOURCE, byte_count);
+
+    StatusOr<DmlGpuEvent> dst_flush_event = dst_ctx->Flush();
+    TF_RETURN_IF_ERROR(dst_flush_event.status());
+
+    ComPtr<ID3D12Fence> read_fence = read_fence_dst_;
+    dst_device->GetEventQueue()->Enqueue(
+        dst_flush_event.ConsumeValueOrDie(), [read_fence, seq, done] {
+          DML_CHECK_SUCCEEDED(read_fence->Signal(seq));
+          done(Status::OK());
+        });
+
+    return Status::OK();
+  }
+
+ private:
+  // Creates (or grows) the shared staging heap and fences. The mutex must
+  // already be held.
+  Status EnsureCapacity(DmlDevice* src_device, DmlDevice* dst_device,
+                        uint64_t byte_count) {
+    if (capacity_ >= byte_count) {
+      return Status::OK();
+    }
+
+    // Wait for any in-flight copy to retire before replacing the buffers.
+    if (sequence_ > 0) {
+      DmlGpuEvent{sequence_, read_fence_src_}.WaitForSignal();
+    }
+
+    ID3D12Device* src_d3d = src_device->GetD3D12Device();
+    ID3D12Device* dst_d3d = dst_device->GetD3D12Device();
+
+    if (!write_fence_src_) {
+      TF_RETURN_IF_ERROR(CreateSharedFence(src_d3d, dst_d3d, &write_fence_src_,
+                                           &write_fence_dst_));
+      TF_RETURN_IF_ERROR(CreateSharedFence(dst_d3d, src_d3d, &read_fence_dst_,
+                                           &read_fence_src_));
+    }
+
+    // Round up to heap alignment so small copies don't each reallocate.
+    const uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    const uint64_t new_capacity =
+        (byte_count + alignment - 1) & ~(alignment - 1);
+
+    D3D12_HEAP_DESC heap_desc = CD3DX12_HEAP_DESC(
+        new_capacity, CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), 0,
+        D3D12_HEAP_FLAG_SHARED | D3D12_HEAP_FLAG_SHARED_CROSS_ADAPTER |
+            D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+
+    ComPtr<ID3D12Heap> src_heap;
+    HRESULT hr = src_d3d->CreateHeap(&heap_desc, IID_PPV_ARGS(&src_heap));
+    if (FAILED(hr)) {
+      // E_INVALIDARG/E_NOTIMPL here means the driver can't create
+      // cross-adapter heaps at all; don't retry on every copy.
+      unsupported_ = true;
+      return errors::Unimplemented(
+          "Failed to create a cross-adapter shared heap (HRESULT: ", hr, ")");
+    }
+
+    HANDLE heap_handle = nullptr;
+    DML_CHECK_SUCCEEDED(src_d3d->CreateSharedHandle(
+        src_heap.Get(), nullptr, GENERIC_ALL, nullptr, &heap_handle));
+
+    ComPtr<ID3D12Heap> dst_heap;
+    hr = dst_d3d->OpenSharedHandle(heap_handle, IID_PPV_ARGS(&dst_heap));
+    CloseHandle(heap_handle);
+    if (FAILED(hr)) {
+      unsupported_ = true;
+      return errors::Unimplemented(
+          "Failed to open a cross-adapter shared heap (HRESULT: ", hr, ")");
+    }
+
+    D3D12_RESOURCE_DESC buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+        new_capacity, D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER);
+
+    ComPtr<ID3D12Resource> src_staging;
+    ComPtr<ID3D12Resource> dst_staging;
+    DML_CHECK_SUCCEEDED(src_d3d->CreatePlacedResource(
+        src_heap.Get(), 0, &buffer_desc, D3D12_RESOURCE_STATE_COMMON, nullptr,
+        IID_PPV_ARGS(&src_staging)));
+    DML_CHECK_SUCCEEDED(dst_d3d->CreatePlacedResource(
+        dst_heap.Get(), 0, &buffer_desc, D3D12_RESOURCE_STATE_COMMON, nullptr,
+        IID_PPV_ARGS(&dst_staging)));
+
+    src_heap_ = std::move(src_heap);
+    dst_heap_ = std::move(dst_heap);
+    src_staging_ = std::move(src_staging);
+    dst_staging_ = std::move(dst_staging);
+    capacity_ = new_capacity;
+
+    VLOG(1) << "Created cross-adapter staging heap of " << new_capacity
+            << " bytes";
+
+    return Status::OK();
+  }
+
+  // Creates a fence on `owner`, shares it with `peer`, and returns both
+  // sides' fence objects.
+  static Status CreateSharedFence(ID3D12Device* owner, ID3D12Device* peer,
+                                  ComPtr<ID3D12Fence>* owner_fence,
+                                  ComPtr<ID3D12Fence>* peer_fence) {
+    HRESULT hr = owner->CreateFence(
+        0, D3D12_FENCE_FLAG_SHARED | D3D12_FENCE_FLAG_SHARED_CROSS_ADAPTER,
+        IID_PPV_ARGS(&*owner_fence));
+    if (FAILED(hr)) {
+      return errors::Unimplemented(
+          "Failed to create a cross-adapter shared fence (HRESULT: ", hr, ")");
+    }
+
+    HANDLE fence_handle = nullptr;
+    DML_CHECK_SUCCEEDED(owner->CreateSharedHandle(
+        owner_fence->Get(), nullptr, GENERIC_ALL, nullptr, &fence_handle));
+
+    hr = peer->OpenSharedHandle(fence_handle, IID_PPV_ARGS(&*peer_fence));
+    CloseHandle(fence_handle);
+    if (FAILED(hr)) {
+      return errors::Unimplemented(
+          "Failed to open a cross-adapter shared fence (HRESULT: ", hr, ")");
+    }
+
+    return Status::OK();
+  }
+
+  std::mutex mutex_;
+  bool unsupported_ = false;
+
+  uint64_t capacity_ = 0;
+  ComPtr<ID3D12Heap> src_heap_;
+  ComPtr<ID3D12Heap> dst_heap_;
+  ComPtr<ID3D12Resource> src_staging_;
+  ComPtr<ID3D12Resource> dst_staging_;
+
+  // Signaled to `sequence_` when the source has finished writing the staging
+  // buffer (write) and when the destination has finished reading it (read).
+  ComPtr<ID3D12Fence> write_fence_src_;
+  ComPtr<ID3D12Fence> write_fence_dst_;
+  ComPtr<ID3D12Fence> read_fence_src_;
+  ComPtr<ID3D12Fence> read_fence_dst_;
+
+  uint64_t sequence_ = 0;
+};
+
+CrossAdapterStaging* GetCrossAdapterStaging(DmlDevice* src_device,
+                                            DmlDevice* dst_device) {
+  // Keyed by execution context, which uniquely identifies a device state.
+  // Entries live for the process lifetime, like the device states they
+  // reference.
+  using Key = std::pair<const void*, const void*>;
+  static std::mutex* map_mutex = new std::mutex;
+  static auto* stagings =
+      new std::map<Key, std::unique_ptr<CrossAdapterStaging>>;
+
+  Key key = {src_device->GetExecutionContext(),
+             dst_device->GetExecutionContext()};
+
+  std::unique_lock<std::mutex> lock(*map_mutex);
+  auto& staging = (*stagings)[key];
+  if (!staging) {
+    staging = absl::make_unique<CrossAdapterStaging>();
+  }
+  return staging.get();
+}
+
+// Fallback for hardware without cross-adapter heap support: stage through
+// host memory using the source's readback heap and the destination's upload
+// heap directly.
+void CopyViaHostStaging(DmlDevice* src_device, DmlDevice* dst_device,
+                        const D3D12BufferRegion& src_region,
+                        const Tensor* input, Tensor* output,
+                        uint64_t byte_count, StatusCallback done) {
+  auto host_buffer = std::make_shared<std::vector<uint8_t>>(byte_count);
+
+  StatusOr<DmlGpuEvent> status_or_event =
+      src_device->GetReadbackHeap()->ReadbackFromGpu(
+          absl::MakeSpan(host_buffer->data(), byte_count),
+          src_region.Resource(), src_region.Offset(),
+          D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+  if (!status_or_event.ok()) {
+    done(status_or_event.status());
+    return;
+  }
+
+  DmlGpuEvent readback_event = status_or_event.ConsumeValueOrDie();
+
+  // Kick off the GPU now in case TF blocks waiting on this copy.
+  status_or_event = src_device->GetExecutionContext()->Flush();
+  if (!status_or_event.ok()) {
+    done(status_or_event.status());
+    return;
+  }
+
+  TensorReference input_ref(*input);
+  int64 ref_id =
+      DmlTensorRefTracker::Instance()->Track(input_ref, readback_event);
+
+  // Once the readback lands in host memory, feed it to the destination
+  // device's upload heap (which copies it into staging memory synchronously,
+  // so the host buffer may be released as soon as the upload is queued).
+  auto upload_and_done = [host_buffer, input_ref, ref_id, dst_device, output,
+                          byte_count, done] {
+    DmlTensorRefTracker::Instance()->Untrack(ref_id);
+    input_ref.Unref();
+
+    D3D12BufferRegion dst_region =
+        dml_util::CreateBufferForTensor(dst_device, *output);
+
+    StatusOr<DmlGpuEvent> status_or_event =
+        dst_device->GetUploadHeap()->BeginUploadToGpu(
+            dst_region.Resource(), dst_region.Offset(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+            absl::Span<const uint8_t>(host_buffer->data(), byte_count));
+
+    // The upload is ordered before any later work on the destination device,
+    // so completion is observable to the framework from here on; this
+    // mirrors CopyCPUTensorToDevice.
+    done(status_or_event.status());
+  };
+
+  // Completion must ride the readback's own event: with the dedicated COPY
+  // queue the compute queue's flush event signals when the copy is merely
+  // allowed to start, not when the host buffer holds the data.
+  src_device->GetReadbackHeap()->EnqueueCompletionCallback(
+      std::move(readback_event), std::move(upload_and_done));
+}
+
+void DmlDeviceToDeviceCopy(DeviceContext* send_dev_context,
+                           DeviceContext* recv_dev_context, Device* src,
+                           Device* dst, const AllocatorAttributes src_alloc_attr,
+                           const AllocatorAttributes dst_alloc_attr,
+                           const Tensor* input, Tensor* output,
+                           int dev_to_dev_stream_index, StatusCallback done) {
+  auto* src_device = static_cast<DmlDevice*>(src);
+  auto* dst_device = static_cast<DmlDevice*>(dst);
+
+  const uint64_t byte_count = output->TotalBytes();
+  if (byte_count == 0) {
+    done(Status::OK());
+    return;
+  }
+
+  D3D12BufferRegion src_region =
+      dml_util::CreateBufferForTensor(src_device, *input);
+
+  DmlExecutionContext* src_ctx = src_device->GetExecutionContext();
+  DmlExecutionContext* dst_ctx = dst_device->GetExecutionContext();
+
+  if (src_ctx == dst_ctx) {
+    // Both TF devices share one device state (virtual devices on one
+    // adapter), so this is an ordinary same-queue copy; see
+    // CopyTensorInSameDevice for why completion is signaled immediately.
+    D3D12BufferRegion dst_region =
+        dml_util::CreateBufferForTensor(dst_device, *output);
+
+    (void)src_ctx->CopyBufferRegion(
+        dst_region.Resource(), dst_region.Offset(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, src_region.Resource(),
+        src_region.Offset(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        byte_count);
+
+    done(Status::OK());
+    return;
+  }
+
+  if (src_device->GetD3D12Device() == dst_device->GetD3D12Device()) {
+    // Same adapter, private queues (TF_DIRECTML_QUEUE_PER_VIRTUAL_DEVICE):
+    // the destination queue can reference both resources directly; it only
+    // needs to be ordered after the source queue's pending writes.
+    StatusOr<DmlGpuEvent> src_flush_event = src_ctx->Flush();
+    if (!src_flush_event.ok()) {
+      done(src_flush_event.status());
+      return;
+    }
+
+    dst_ctx->QueueDependency(src_flush_event.ConsumeValueOrDie());
+
+    D3D12BufferRegion dst_region =
+        dml_util::CreateBufferForTensor(dst_device, *output);
+
+    (void)dst_ctx->CopyBufferRegion(
+        dst_region.Resource(), dst_region.Offset(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, src_region.Resource(),
+        src_region.Offset(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        byte_count);
+
+    StatusOr<DmlGpuEvent> dst_flush_event = dst_ctx->Flush();
+    if (!dst_flush_event.ok()) {
+      done(dst_flush_event.status());
+      return;
+    }
+
+    // The source allocator may recycle the input's memory for new source
+    // queue work the moment the tensor is released, so hold a reference
+    // until the destination queue has finished reading it.
+    TensorReference input_ref(*input);
+    DmlGpuEvent dst_copy_event = dst_flush_event.ConsumeValueOrDie();
+    int64 ref_id =
+        DmlTensorRefTracker::Instance()->Track(input_ref, dst_copy_event);
+    dst_device->GetEventQueue()->Enqueue(
+        std::move(dst_copy_event), [input_ref, ref_id, done] {
+          DmlTensorRefTracker::Instance()->Untrack(ref_id);
+          input_ref.Unref();
+          done(Status::OK());
+        });
+    return;
+  }
+
+  // Different adapters.
+  if (CrossAdapterCopyEnabled()) {
+    CrossAdapterStaging* staging =
+        GetCrossAdapterStaging(src_device, dst_device);
+
+    D3D12BufferRegion dst_region =
+        dml_util::CreateBufferForTensor(dst_device, *output);
+
+    Status status = staging->Copy(src_device, dst_device, src_region,
+                                  dst_region, input, byte_count, done);
+    if (status.ok()) {
+      return;
+    }
+
+    VLOG(1) << "Cross-adapter copy unavailable (" << status.error_message()
+            << "); staging through host memory";
+  }
+
+  CopyViaHostStaging(src_device, dst_device, src_region, input, output,
+                     byte_count, done);
+}
+
+}  // namespace
+
+static CopyTensor::Registration register_dml_to_dml_copy(
+    DeviceType(DEVICE_DML), DeviceType(DEVICE_DML), DmlDeviceToDeviceCopy);
+
+}  // namespace tensorflow
@@ -20,8 +20,8 @@ namespace tensorflow {
 DmlDescriptorHeap::DmlDescriptorHeap(ID3D12DescriptorHeap* heap)
     : heap_(heap),
       capacity_(heap->GetDesc().NumDescriptors),
-      head_cpu_handle_(heap->GetCPUDescriptorHandleForHeapStart()),
-      head_gpu_handle_(heap->GetGPUDescriptorHandleForHeapStart()),
+      heap_start_cpu_handle_(heap->GetCPUDescriptorHandleForHeapStart()),
+      heap_start_gpu_handle_(heap->GetGPUDescriptorHandleForHeapStart()),
       heap_flags_(heap->GetDesc().Flags) {
   Microsoft::WRL::ComPtr<ID3D12Device> device;
   DML_CHECK_SUCCEEDED(heap->GetDevice(IID_PPV_ARGS(&device)));
@@ -30,6 +30,24 @@ DmlDescriptorHeap::DmlDescriptorHeap(ID3D12DescriptorHeap* heap)
       device->GetDescriptorHandleIncrementSize(heap->GetDesc().Type);
 }
 
+void DmlDescriptorHeap::ReclaimCompletedGenerations() {
+  while (!generations_.empty() &&
+         generations_.front().completion_event.IsSignaled()) {
+    // A generation's allocations never outlive its completion event, so the
+    // whole range up to its end offset is free again. Note that this may jump
+    // the tail over any padding skipped when the head wrapped around.
+    tail_ = generations_.front().end_offset;
+    generations_.pop_front();
+  }
+
+  if (generations_.empty()) {
+    // The entire heap is free; normalize to keep allocations contiguous for
+    // as long as possible.
+    head_ = 0;
+    tail_ = 0;
+  }
+}
+
 absl::optional<DmlDescriptorRange> DmlDescriptorHeap::TryAllocDescriptors(
     uint32_t num_descriptors, DmlGpuEvent completion_event,
     D3D12_DESCRIPTOR_HEAP_FLAGS heap_flags) {
@@ -39,29 +57,56 @@ absl::optional<DmlDescriptorRange> DmlDescriptorHeap::TryAllocDescriptors(
     return absl::nullopt;
   }
 
-  if ((completion_event_.fence != nullptr) &&
-      (completion_event_.IsSignaled())) {
-    // This class always allocates descriptors from the end of the heap.
-    // If the most recent completion event is signaled, then all previous
-    // allocations have completed; the entire capacity is available to use.
-    size_ = 0;
-    head_cpu_handle_ = heap_->GetCPUDescriptorHandleForHeapStart();
-    head_gpu_handle_ = heap_->GetGPUDescriptorHandleForHeapStart();
+  ReclaimCompletedGenerations();
+
+  // Find a contiguous run of free descriptors. The free region of the ring is
+  // [head_, capacity_) plus [0, tail_) when the head hasn't wrapped, or
+  // [head_, tail_) when it has.
+  absl::optional<uint32_t> allocation_offset;
+  if (!generations_.empty() && head_ == tail_) {
+    // Full; no space to allocate
+  } else if (head_ >= tail_) {
+    if (capacity_ - head_ >= num_descriptors) {
+      allocation_offset = head_;
+    } else if (tail_ >= num_descriptors) {
+      // Not enough room before the end of the heap; wrap around. The skipped
+      // range [head_, capacity_) is recovered when the current generation
+      // retires.
+      allocation_offset = 0;
+    }
+  } else {
+    if (tail_ - head_ >= num_descriptors) {
+      allocation_offset = head_;
+    }
   }
 
-  // The caller will need to create a new heap if there is no space left in this
-  // one.
-  uint32_t space_remaining = capacity_ - size_;
-  if (space_remaining < num_descriptors) {
+  // The caller will need to allocate from another heap if there is no
+  // contiguous space left in this one.
+  if (!allocation_offset) {
     return absl::nullopt;
   }
 
-  DmlDescriptorRange range = {heap_.Get(), head_cpu_handle_, head_gpu_handle_};
+  DmlDescriptorRange range = {
+      heap_.Get(),
+      CD3DX12_CPU_DESCRIPTOR_HANDLE(heap_start_cpu_handle_, *allocation_offset,
+                                    handle_increment_size_),
+      CD3DX12_GPU_DESCRIPTOR_HANDLE(heap_start_gpu_handle_, *allocation_offset,
+                                    handle_increment_size_)};
 
-  size_ += num_descriptors;
+  head_ = (*allocation_offset + num_descriptors) % capacity_;
   completion_event_ = completion_event;
-  head_cpu_handle_.Offset(num_descriptors, handle_increment_size_);
-  head_gpu_handle_.Offset(num_descriptors, handle_increment_size_);
+
+  // Extend the current generation if this allocation completes on the same
+  // event as the previous one; otherwise start a new generation.
+  if (!generations_.empty() &&
+      generations_.back().completion_event.fence.Get() ==
+          completion_event.fence.Get() &&
+      generations_.back().completion_event.fence_value ==
+          completion_event.fence_value) {
+    generations_.back().end_offset = head_;
+  } else {
+    generations_.push_back(Generation{head_, std::move(completion_event)});
+  }
 
   return range;
 }
@@ -84,9 +129,23 @@ DmlDescriptorRange DmlDescriptorPool::AllocDescriptors(
     }
   }
 
-  // A new descriptor heap must be created.
+  // A new descriptor heap must be created. Grow geometrically past the
+  // largest existing heap so the pool converges on a single heap big enough
+  // for a whole frame's worth of in-flight descriptors; once that happens,
+  // generational recycling within the heap takes over and the bound
+  // descriptor heap never changes again in steady state.
+  uint32_t largest_capacity = 0;
+  for (const DmlDescriptorHeap& heap : heaps_) {
+    largest_capacity = std::max(largest_capacity, heap.GetCapacity());
+  }
+
   uint32_t new_heap_capacity =
-      std::max(num_descriptors, initial_heap_capacity_);
+      std::max(initial_heap_capacity_, largest_capacity * 2);
+  if (new_heap_capacity > kMaxHeapCapacity) {
+    new_heap_capacity = kMaxHeapCapacity;
+  }
+  new_heap_capacity = std::max(num_descriptors, new_heap_capacity);
+
   CreateHeap(new_heap_capacity, heap_flags);
   auto descriptor_range = heaps_.back().TryAllocDescriptors(
       num_descriptors, completion_event, heap_flags);
@@ -95,9 +154,27 @@ DmlDescriptorRange DmlDescriptorPool::AllocDescriptors(
 }
 
 void DmlDescriptorPool::Trim() {
-  // Remove any heaps that are not pending execution.
+  // Find the largest heap that is not pending execution. It survives the trim
+  // below: releasing it would just force a fresh heap (and a descriptor heap
+  // switch on the command list) the next time anything is scheduled.
+  const DmlDescriptorHeap* retained_heap = nullptr;
+  for (const DmlDescriptorHeap& heap : heaps_) {
+    auto completion_event = heap.GetLastCompletionEvent();
+    bool idle = !completion_event.fence || completion_event.IsSignaled();
+
+    if (idle && (retained_heap == nullptr ||
+                 heap.GetCapacity() > retained_heap->GetCapacity())) {
+      retained_heap = &heap;
+    }
+  }
+
+  // Remove all other heaps that are not pending execution.
   auto it = std::remove_if(
-      heaps_.begin(), heaps_.end(), [](const DmlDescriptorHeap& heap) {
+      heaps_.begin(), heaps_.end(),
+      [retained_heap](const DmlDescriptorHeap& heap) {
+        if (&heap == retained_heap) {
+          return false;
+        }
         auto completion_event = heap.GetLastCompletionEvent();
         return !completion_event.fence || completion_event.IsSignaled();
       });
@@ -45,16 +45,35 @@ class DmlDescriptorHeap {
   uint32_t GetCapacity() const { return capacity_; }
 
  private:
+  // Descriptors are allocated ring-style: consecutive allocations sharing a
+  // completion event form a "generation", and space is reclaimed generation by
+  // generation as the GPU retires them. This lets a single heap keep recycling
+  // in steady state instead of filling up and forcing the pool to create (and
+  // the command list to switch to) a fresh heap, which is an expensive GPU
+  // state flush.
+  struct Generation {
+    uint32_t end_offset;  // tail_ advances here once the generation retires
+    DmlGpuEvent completion_event;
+  };
+
+  // Pops all leading generations whose completion events have signaled,
+  // advancing the tail of the ring.
+  void ReclaimCompletedGenerations();
+
   Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap_;
   uint32_t capacity_ = 0;
-  uint32_t size_ = 0;
   uint32_t handle_increment_size_ = 0;
-  CD3DX12_CPU_DESCRIPTOR_HANDLE head_cpu_handle_;
-  CD3DX12_GPU_DESCRIPTOR_HANDLE head_gpu_handle_;
+  CD3DX12_CPU_DESCRIPTOR_HANDLE heap_start_cpu_handle_;
+  CD3DX12_GPU_DESCRIPTOR_HANDLE heap_start_gpu_handle_;
   D3D12_DESCRIPTOR_HEAP_FLAGS heap_flags_ = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 
-  // Most recent GPU completion event. Allocations are always done at the end,
-  // so there is no fragmentation of the heap.
+  // Live generations, oldest first. The heap is full when head_ == tail_ and
+  // this is non-empty; empty generations mean the whole heap is free.
+  std::deque<Generation> generations_;
+  uint32_t head_ = 0;  // offset of the next descriptor to allocate
+  uint32_t tail_ = 0;  // offset of the start of the oldest live generation
+
+  // Most recent GPU completion event supplied to TryAllocDescriptors.
   DmlGpuEvent completion_event_;
 };
 
@@ -72,14 +91,20 @@ class DmlDescriptorPool {
       D3D12_DESCRIPTOR_HEAP_FLAGS heap_flags =
           D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE);
 
-  // Releases all descriptor heaps that contain only descriptors which have
-  // completed their work on the GPU.
+  // Releases descriptor heaps that contain only descriptors which have
+  // completed their work on the GPU, except for the largest such heap, which
+  // is retained so steady-state execution can settle into a single
+  // generationally-recycled heap.
   void Trim();
 
   // Returns the total capacity of all heaps.
   uint32_t GetTotalCapacity() const;
 
  private:
+  // Shader-visible CBV/SRV/UAV heaps are limited to one million descriptors
+  // on all hardware tiers.
+  static constexpr uint32_t kMaxHeapCapacity = 1000000;
+
   Microsoft::WRL::ComPtr<ID3D12Device> device_;
   std::vector<DmlDescriptorHeap> heaps_;
   const uint32_t initial_heap_capacity_;
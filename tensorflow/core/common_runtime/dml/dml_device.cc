@@ -20,12 +20,14 @@ limitations under the License.
 #include "dml_device_context.h"
 #include "dml_event_queue.h"
 #include "dml_kernel_manager.h"
+#include "dml_pinned_allocator.h"
 #include "dml_readback_heap.h"
 #include "dml_tracing.h"
 #include "dml_upload_heap.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/util/env_var.h"
 
 // {D113B493-BBA2-4993-8608-D706A73B91CE}
 static const GUID PIX_EVAL_CAPTURABLE_WORK_GUID = {
@@ -38,7 +40,9 @@ namespace tensorflow {
 
 DmlDevice::DmlDevice(const DmlDeviceState* state, const SessionOptions& options,
                      const DeviceAttributes& attributes)
-    : LocalDevice(options, attributes), state_(state) {
+    : LocalDevice(options, attributes),
+      state_(state),
+      scoped_allocator_mgr_(new ScopedAllocatorMgr(attributes.name())) {
   // Create the DML BFC allocator
   D3D12HeapAllocator* heap_allocator = state_->heap_allocator.get();
   uint64_t memory_limit_in_bytes = attributes.memory_limit();
@@ -48,11 +52,54 @@ DmlDevice::DmlDevice(const DmlDeviceState* state, const SessionOptions& options,
 
   device_context_ = new DMLDeviceContext(
       state_->execution_context.get(), state_->event_queue.get(),
-      state_->upload_heap.get(), state_->readback_heap.get());
+      state_->upload_heap.get(), state_->readback_heap.get(),
+      state_->dml_allocator.get(), state_->copy_queue.get(),
+      state_->copy_event_queue.get(), state_->pinned_allocator.get(),
+      state_->upload_cache.get());
   set_dml_device_context(device_context_);
+
+  Status s = ReadBoolFromEnvVar("TF_DIRECTML_PIPELINED_EXECUTION",
+                                /*default_val=*/false, &pipelined_execution_);
+  if (!s.ok()) {
+    pipelined_execution_ = false;
+  }
 }
 
 Status DmlDevice::Sync() {
+  // The executor calls Sync at the end of every step, which serializes the
+  // CPU and GPU: Run(N) doesn't return until step N's GPU work has drained,
+  // so step N+1's host-side work (feed processing, executor scheduling,
+  // command recording) can't overlap it. In pipelined mode, flush this step's
+  // work but wait only for the *previous* step's flush: Run(N) returns while
+  // step N drains and Run(N+1) records against it, double-buffered so the
+  // CPU never gets more than one full step ahead of the GPU.
+  //
+  // This is safe because every cross-step hazard is already fence-ordered
+  // through the execution context: feeds enqueue on the GPU timeline behind
+  // the previous step's work, host-bound fetches wait on the exact fence
+  // value of their readback, and freed buffers are recycled only after their
+  // GPU references retire. What pipelined mode gives up is the guarantee
+  // that untracked side effects (e.g. a kernel's debug print) have finished
+  // when Run returns.
+  if (pipelined_execution_) {
+    auto status_or_event = state_->execution_context->Flush();
+    TF_RETURN_IF_ERROR(status_or_event.status());
+
+    absl::optional<DmlGpuEvent> previous_step_event;
+    {
+      std::unique_lock<std::mutex> lock(pipeline_mutex_);
+      previous_step_event = std::move(last_step_event_);
+      last_step_event_ = status_or_event.ConsumeValueOrDie();
+    }
+
+    if (previous_step_event) {
+      previous_step_event->WaitForSignal();
+    }
+
+    state_->kernel_manager->ReleaseCompletedReferences();
+    return Status::OK();
+  }
+
   VLOG(2) << "DirectML device: performing GPU sync.";
 
   auto start_time = std::chrono::high_resolution_clock::now();
@@ -72,7 +119,28 @@ Status DmlDevice::Sync() {
 }
 
 Allocator* DmlDevice::GetAllocator(AllocatorAttributes attributes) {
-  return attributes.on_host() ? cpu_allocator_ : state_->dml_allocator.get();
+  if (attributes.on_host()) {
+    // gpu_compatible host allocations (tf.data's final stage, feed paths)
+    // come from pinned upload memory when available, so the subsequent
+    // host-to-device copy is a single GPU read instead of a staging memcpy
+    // followed by one.
+    if (attributes.gpu_compatible() && state_->pinned_allocator != nullptr) {
+      return state_->pinned_allocator.get();
+    }
+    return cpu_allocator_;
+  }
+  return state_->dml_allocator.get();
+}
+
+Allocator* DmlDevice::GetScopedAllocator(AllocatorAttributes attr,
+                                         int64 step_id) {
+  if (attr.scope_id > 0) {
+    return scoped_allocator_mgr_->GetContainer(step_id)->GetInstance(
+        attr.scope_id);
+  }
+  LOG(FATAL) << "Unexpected call to DmlDevice::GetScopedAllocator "
+             << "attr.scope_id = " << attr.scope_id;
+  return state_->dml_allocator.get();
 }
 
 Status DmlDevice::MakeTensorFromProto(const TensorProto& tensor_proto,
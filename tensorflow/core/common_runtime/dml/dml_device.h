@@ -15,10 +15,14 @@ limitations under the License.
 
 #pragma once
 
+#include <mutex>
+
 #include "dml_common.h"
 #include "dml_device_context.h"
+#include "dml_gpu_event.h"
 #include "dml_device_state.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -48,6 +52,19 @@ class DmlDevice : public LocalDevice {
 
   DmlUploadHeap* GetUploadHeap() const { return state_->upload_heap.get(); }
 
+  // May return null if variable packing is disabled.
+  DmlVariableArena* GetVariableArena() const {
+    return state_->variable_arena.get();
+  }
+
+  DmlConstantPool* GetConstantPool() const {
+    return state_->constant_pool.get();
+  }
+
+  DmlScratchBufferPool* GetScratchPool() const {
+    return state_->scratch_pool.get();
+  }
+
   DmlReadbackHeap* GetReadbackHeap() const {
     return state_->readback_heap.get();
   }
@@ -60,6 +77,17 @@ class DmlDevice : public LocalDevice {
   Status Sync() override;
   Allocator* GetAllocator(AllocatorAttributes attributes) override;
 
+  // Scoped allocators let the graph optimizer lay out a group of tensors
+  // (e.g. gradients feeding a collective) contiguously in one backing
+  // allocation. The aliased tensors are plain offsets into the backing
+  // tensor's tagged pointer, which DmlAllocator::CreateBufferRegion resolves
+  // to views over a single D3D12 buffer region.
+  Allocator* GetScopedAllocator(AllocatorAttributes attr,
+                                int64 step_id) override;
+  ScopedAllocatorMgr* GetScopedAllocatorMgr() const override {
+    return scoped_allocator_mgr_.get();
+  }
+
   Status MakeTensorFromProto(const TensorProto& tensor_proto,
                              const AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
@@ -75,6 +103,12 @@ class DmlDevice : public LocalDevice {
                                            done);
   }
 
+  // Align the execution context's submission boundaries with the executor's
+  // op runs, so a chain of back-to-back kernels lands in one submission
+  // instead of being split by the flush timer.
+  void BeginOpRun() override { state_->execution_context->BeginOpRun(); }
+  void EndOpRun() override { state_->execution_context->EndOpRun(); }
+
   void DebugOnSessionRunStart() override;
   void DebugOnSessionRunEnd() override;
 
@@ -83,6 +117,14 @@ class DmlDevice : public LocalDevice {
 
   Allocator* cpu_allocator_;          // not owned
   DMLDeviceContext* device_context_;  // ref-counted
+  std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+
+  // Pipelined (double-buffered) step execution, enabled with
+  // TF_DIRECTML_PIPELINED_EXECUTION; see Sync(). `last_step_event_` is the
+  // completion event of the most recent step's flush.
+  bool pipelined_execution_ = false;
+  std::mutex pipeline_mutex_;
+  absl::optional<DmlGpuEvent> last_step_event_;  // protected by pipeline_mutex_
 
   Status MaybeCopyTensorToDML(const AllocatorAttributes alloc_attrs,
                               const Tensor& from, Tensor& to,
@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dml/dml_device_cache.h"
 
 #include "tensorflow/core/common_runtime/dml/dml_adapter.h"
+#include "tensorflow/core/common_runtime/dml/dml_adapter_calibration.h"
 #include "tensorflow/core/common_runtime/dml/dml_adapter_impl.h"
 #include "tensorflow/core/common_runtime/dml/dml_device.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/stream_executor/platform/default/dso_loader.h"
 
 using Microsoft::WRL::ComPtr;
@@ -140,13 +143,44 @@ static std::vector<DmlAdapter> FilterAdapters() {
   }
 
   std::vector<DmlAdapter> adapters = EnumerateAdapters();
-  adapters.erase(std::remove_if(adapters.begin(), adapters.end(),
-                                [](const DmlAdapter& adapter) {
-                                  return !SupportsDmlDevice(adapter);
-                                }),
-                 adapters.end());
 
-  return adapters;
+  // The compatibility probe creates a D3D12 and DML device and compiles an
+  // operator, which can take on the order of a second per adapter on some
+  // drivers. Probe each adapter on its own thread so multi-adapter machines
+  // don't pay that cost serially. Don't use std::vector<bool> here: its
+  // packed elements can't be written concurrently.
+  std::vector<uint8_t> supported(adapters.size(), 0);
+  if (adapters.size() > 1) {
+    thread::ThreadPool pool(Env::Default(), "dml_adapter_probe",
+                            static_cast<int>(adapters.size()));
+    for (size_t i = 0; i < adapters.size(); ++i) {
+      pool.Schedule([&adapters, &supported, i] {
+        supported[i] = SupportsDmlDevice(adapters[i]) ? 1 : 0;
+      });
+    }
+    // The pool's destructor waits for all scheduled probes to finish.
+  } else {
+    for (size_t i = 0; i < adapters.size(); ++i) {
+      supported[i] = SupportsDmlDevice(adapters[i]) ? 1 : 0;
+    }
+  }
+
+  // Preserve the enumeration order of the supported adapters.
+  std::vector<DmlAdapter> filtered_adapters;
+  filtered_adapters.reserve(adapters.size());
+  for (size_t i = 0; i < adapters.size(); ++i) {
+    if (supported[i]) {
+      filtered_adapters.push_back(std::move(adapters[i]));
+    }
+  }
+
+  // With more than one adapter, rank them by measured throughput rather than
+  // trusting the OS's static high-performance ordering, which can pick wrong
+  // when the nominally faster adapter is throttled or driver-impaired. The
+  // probe results are cached per driver version, so this is a one-time cost.
+  SortAdaptersByMeasuredThroughput(&filtered_adapters);
+
+  return filtered_adapters;
 }
 
 DmlDeviceCache& DmlDeviceCache::Instance() {
@@ -179,23 +213,74 @@ const DmlDeviceState* DmlDeviceCache::GetOrCreateDeviceState(
   assert(adapter_index < adapters_.size());
   assert(adapters_.size() == device_states_.size());
 
+  // If another thread is already creating this adapter's state, wait for it
+  // rather than racing to create a second one.
+  device_state_created_.wait(lock, [&] {
+    return device_states_in_creation_.count(adapter_index) == 0;
+  });
+
   if (!device_states_[adapter_index]) {
     const DmlAdapter& adapter = adapters_[adapter_index];
 
     LOG(INFO) << "DirectML: creating device on adapter " << adapter_index
               << " (" << adapter.Name() << ")";
 
-    device_states_[adapter_index] =
+    // Device state creation builds D3D12/DML devices, queues and allocators,
+    // which takes a while; drop the mutex so that first-touch initialization
+    // of *different* adapters can proceed in parallel (see the device
+    // factory's warmup pool). The in-creation set keeps other threads asking
+    // for this same adapter waiting above.
+    device_states_in_creation_.insert(adapter_index);
+    lock.unlock();
+
+    auto state =
         DmlDeviceState::Create(adapter, gpu_options, memory_limit_in_bytes);
+
+    lock.lock();
+    device_states_[adapter_index] = std::move(state);
+    device_states_in_creation_.erase(adapter_index);
+    device_state_created_.notify_all();
   }
 
   return device_states_[adapter_index].get();
 }
 
+const DmlDeviceState* DmlDeviceCache::CreatePrivateDeviceState(
+    uint32_t adapter_index, const GPUOptions& gpu_options,
+    uint64_t memory_limit_in_bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  assert(adapter_index < adapters_.size());
+  const DmlAdapter& adapter = adapters_[adapter_index];
+
+  LOG(INFO) << "DirectML: creating device with a private compute queue on "
+            << "adapter " << adapter_index << " (" << adapter.Name() << ")";
+
+  private_device_states_.push_back(
+      DmlDeviceState::Create(adapter, gpu_options, memory_limit_in_bytes));
+  return private_device_states_.back().get();
+}
+
 const DmlAdapter& DmlDeviceCache::GetAdapter(uint32_t adapter_index) const {
   return adapters_[adapter_index];
 }
 
+void DmlDeviceCache::ForEachDeviceState(
+    const std::function<void(int adapter_index, const DmlDeviceState& state)>&
+        fn) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  for (size_t i = 0; i < device_states_.size(); ++i) {
+    if (device_states_[i]) {
+      fn(static_cast<int>(i), *device_states_[i]);
+    }
+  }
+
+  for (const auto& state : private_device_states_) {
+    fn(-1, *state);
+  }
+}
+
 Status DmlDeviceCache::MapDeviceIdToAdapterIndex(int device_id,
                                                  uint32_t adapter_index) {
   // Try to insert the device_id -> adapter_index mapping. This will fail if the
@@ -15,6 +15,10 @@ limitations under the License.
 
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <set>
+
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 
 namespace tensorflow {
@@ -36,6 +40,17 @@ class DmlDeviceCache {
                                                const GPUOptions& gpu_options,
                                                uint64_t memory_limit_in_bytes);
 
+  // Creates a device state private to a single TF device instance, instead of
+  // the per-adapter state shared by GetOrCreateDeviceState. A private state
+  // has its own hardware compute queue (and its own allocators and heaps,
+  // sized by the caller's memory limit), so work submitted through it runs in
+  // parallel with other queues on the same adapter. Note that D3D12 devices
+  // are process-wide singletons per adapter, so only the queues and pools are
+  // duplicated, not the underlying D3D12/DML device objects.
+  const DmlDeviceState* CreatePrivateDeviceState(uint32_t adapter_index,
+                                                 const GPUOptions& gpu_options,
+                                                 uint64_t memory_limit_in_bytes);
+
   const DmlAdapter& GetAdapter(uint32_t adapter_index) const;
 
   // Parts of the grappler will look up physical hardware properties using a TF
@@ -66,6 +81,14 @@ class DmlDeviceCache {
   Status MapDeviceIdToAdapterIndex(int device_id, uint32_t adapter_index);
   Status GetAdapterIndexFromDeviceId(int device_id, uint32_t* adapter_index);
 
+  // Invokes fn for every device state created so far, passing the adapter
+  // index the state was created for (shared states) or -1 (private states,
+  // which aren't tracked per adapter). Used by the profiler to reach each
+  // device's execution context; the states themselves outlive any session.
+  void ForEachDeviceState(
+      const std::function<void(int adapter_index, const DmlDeviceState& state)>&
+          fn) const;
+
  private:
   DmlDeviceCache();
 
@@ -78,6 +101,17 @@ class DmlDeviceCache {
 
   // Lazily constructed
   std::vector<std::unique_ptr<DmlDeviceState>> device_states_;
+
+  // Adapters whose shared state is currently being created by some thread
+  // (outside the mutex, so first-touch initialization of different adapters
+  // can overlap; see the device factory's parallel warmup). Waiters for the
+  // same adapter block on the condition variable.
+  std::set<uint32_t> device_states_in_creation_;
+  std::condition_variable device_state_created_;
+
+  // States created by CreatePrivateDeviceState. These are never shared or
+  // looked up again; this vector just owns them for the process lifetime.
+  std::vector<std::unique_ptr<DmlDeviceState>> private_device_states_;
 };
 
 }  // namespace tensorflow
\ No newline at end of file
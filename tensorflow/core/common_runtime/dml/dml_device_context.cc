@@ -16,12 +16,70 @@ limitations under the License.
 #include "dml_device_context.h"
 
 #include "dml_bfc_allocator.h"
+#include "dml_copy_queue.h"
+#include "dml_metrics.h"
+#include "dml_pinned_allocator.h"
 #include "dml_status.h"
+#include "dml_tensor_ref_tracker.h"
+#include "dml_upload_cache.h"
 #include "dml_util.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Backs a tensor whose memory is an imported, caller-owned D3D12 resource.
+// The allocator registration (and with it the reference that keeps the
+// resource alive on the GPU timeline) is released only once all GPU work
+// enqueued before this buffer's destruction has completed.
+class DmlImportedTensorBuffer : public TensorBuffer {
+ public:
+  DmlImportedTensorBuffer(void* data, uint64_t size_in_bytes,
+                          DmlAllocator* allocator,
+                          DmlExecutionContext* execution_context,
+                          DmlEventQueue* event_queue)
+      : TensorBuffer(data),
+        size_in_bytes_(size_in_bytes),
+        allocator_(allocator),
+        execution_context_(execution_context),
+        event_queue_(event_queue) {}
+
+  ~DmlImportedTensorBuffer() override {
+    // Completion events are monotonic, so the current one covers everything
+    // recorded against this buffer.
+    DmlAllocator* allocator = allocator_;
+    void* ptr = data();
+    event_queue_->Enqueue(
+        execution_context_->GetCurrentCompletionEvent(),
+        [allocator, ptr] { allocator->ReleaseExternalResource(ptr); });
+  }
+
+  size_t size() const override { return size_in_bytes_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  // The underlying memory is caller-owned, so TF must never recycle or
+  // forward it the way it can its own device allocations.
+  bool OwnsMemory() const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_in_bytes_);
+    proto->set_allocated_bytes(size_in_bytes_);
+    proto->set_allocator_name("dml_imported");
+  }
+
+ private:
+  uint64_t size_in_bytes_;
+  DmlAllocator* allocator_;
+  DmlExecutionContext* execution_context_;
+  DmlEventQueue* event_queue_;
+};
+
+}  // namespace
+
 void DMLDeviceContext::CopyCPUTensorToDevice(const Tensor* cpu_tensor,
                                              Device* device,
                                              Tensor* device_tensor,
@@ -43,18 +101,160 @@ void DMLDeviceContext::CopyCPUTensorToDevice(const Tensor* cpu_tensor,
       D3D12_RESOURCE_STATE_UNORDERED_ACCESS;  // GPU resources are always kept
                                               // in UAV state
 
+  // On cache-coherent UMA adapters the allocator serves CPU-visible device
+  // memory (see DmlDeviceState::Create), so the bytes can be written straight
+  // through a mapped pointer with no staging copy and no GPU work at all. A
+  // CPU write is only ordered against GPU work by completion, though, so this
+  // path is taken only when nothing the GPU might still execute can touch the
+  // destination memory: either its bytes have never been handed out before
+  // (so no recorded command can reference them), or everything recorded so
+  // far — on the execution context and the dedicated copy queue — has already
+  // completed. Feeding inputs at the start of a step, when the GPU is
+  // drained, satisfies the latter; anything else falls back to the upload
+  // heap, which orders the copy on the GPU timeline.
+  if (allocator_->IsCpuVisible()) {
+    const bool never_used = allocator_->ConsumeZeroInitializedState(
+        DMAHelper::base(device_tensor));
+    const bool gpu_idle =
+        never_used ||
+        (execution_context_->GetCurrentCompletionEvent().IsSignaled() &&
+         (copy_queue_ == nullptr ||
+          copy_queue_->GetCurrentCompletionEvent().IsSignaled()));
+
+    void* mapped = nullptr;
+    CD3DX12_RANGE read_range(0, 0);  // the CPU won't read through this mapping
+    if (gpu_idle && SUCCEEDED(dst_data->Map(0, &read_range, &mapped))) {
+      memcpy(static_cast<uint8_t*>(mapped) + dst_offset, src_data, total_bytes);
+      CD3DX12_RANGE written_range(dst_offset, dst_offset + total_bytes);
+      dst_data->Unmap(0, &written_range);
+      dml_metrics::RecordHostToDeviceCopy("zero_copy");
+      done(Status::OK());
+      return;
+    }
+  }
+
+  // Serving pipelines re-feed the same preprocessing constants and lookup
+  // results across requests. When an upload's source bytes fingerprint to a
+  // previously cached region, the bus transfer is replaced by a
+  // device-to-device copy from the cache; any GPU work that later overwrites
+  // the cached region's memory (after eviction frees it) is recorded after
+  // this copy and therefore ordered after it on the timeline.
+  uint64_t fingerprint = 0;
+  bool fingerprinted = false;
+  if (upload_cache_ != nullptr && upload_cache_->IsCacheableSize(total_bytes)) {
+    fingerprint = DmlUploadCache::FingerprintBytes(src_data, total_bytes);
+    fingerprinted = true;
+
+    ID3D12Resource* cached_data = nullptr;
+    uint64_t cached_offset = 0;
+    if (upload_cache_->Lookup(fingerprint, total_bytes, &cached_data,
+                              &cached_offset)) {
+      (void)execution_context_->CopyBufferRegion(
+          dst_data, dst_offset, dst_state, cached_data, cached_offset,
+          D3D12_RESOURCE_STATE_UNORDERED_ACCESS, total_bytes);
+      dml_metrics::RecordHostToDeviceCopy("cache_hit");
+
+      // As with same-device copies, completion can be signaled as soon as the
+      // copy is recorded; the framework has no way to observe it earlier.
+      done(Status::OK());
+      return;
+    }
+  }
+
+  // Tensors allocated from the pinned allocator already live in GPU-readable
+  // upload memory, so the transfer is a single enqueued GPU copy — no staging
+  // reservation and no CPU memcpy. The source must stay alive and unmodified
+  // until the GPU has read it, so the tensor references are released on the
+  // copy's completion event rather than when the copy is merely recorded.
+  ID3D12Resource* src_buffer = nullptr;
+  uint64_t src_buffer_offset = 0;
+  if (pinned_allocator_ != nullptr &&
+      pinned_allocator_->GetBufferForPointer(src_data, &src_buffer,
+                                             &src_buffer_offset)) {
+    StatusOr<DmlGpuEvent> status_or_event =
+        upload_heap_->BeginUploadFromPinnedBuffer(dst_data, dst_offset,
+                                                  dst_state, src_buffer,
+                                                  src_buffer_offset,
+                                                  total_bytes);
+    if (status_or_event.ok()) {
+      dml_metrics::RecordHostToDeviceCopy("pinned");
+
+      TensorReference src_ref(*cpu_tensor);
+      TensorReference dst_ref(*device_tensor);
+
+      // The completion event lives on the copy queue's fence when the
+      // dedicated copy queue is in use, and on the main fence otherwise.
+      DmlEventQueue* completion_queue =
+          copy_queue_ != nullptr ? copy_event_queue_ : event_queue_;
+      completion_queue->Enqueue(status_or_event.ConsumeValueOrDie(),
+                                [src_ref, dst_ref] {
+                                  src_ref.Unref();
+                                  dst_ref.Unref();
+                                });
+
+      done(Status::OK());
+      return;
+    }
+    done(status_or_event.status());
+    return;
+  }
+
   auto byte_span = absl::Span<const uint8_t>(
       static_cast<const uint8_t*>(src_data), total_bytes);
 
-  StatusOr<DmlGpuEvent> status_or_event = upload_heap_->BeginUploadToGpu(
-      dst_data, dst_offset, dst_state, byte_span);
+  dml_metrics::RecordHostToDeviceCopy("staged");
 
-  // Immediately signal completion even though we haven't actually kicked off
-  // the GPU, or waited for it to complete. This is because from the framework's
-  // point of view, there's no way for it to observe this state (except when
-  // copying a tensor back to CPU, at which point we correctly flush and queue a
-  // callback)
-  done(status_or_event.status());
+  // Keep both tensors alive until the upload has been recorded: the source
+  // bytes are read when the batch is staged, and the destination memory must
+  // not be recycled (and potentially rewritten by later GPU work) before the
+  // copy has been ordered on the GPU timeline.
+  TensorReference src_ref(*cpu_tensor);
+  TensorReference dst_ref(*device_tensor);
+
+  // On a cache miss, reserve an entry for these bytes up front and populate
+  // it from the destination once the upload has been recorded. Until Commit
+  // the entry is invisible to lookups and protected from eviction, so a
+  // concurrent upload of the same bytes neither hits a half-filled region nor
+  // frees memory the fill copy still targets.
+  ID3D12Resource* cache_data = nullptr;
+  uint64_t cache_offset = 0;
+  const bool cache_reserved =
+      fingerprinted && upload_cache_->Reserve(fingerprint, total_bytes,
+                                              &cache_data, &cache_offset);
+
+  // The upload heap coalesces concurrently pending uploads into gathered
+  // submissions, so feeding a step with many small inputs costs a few staging
+  // reservations and fence signals rather than one per tensor. The callback
+  // runs as soon as the batch is recorded — without waiting for the GPU —
+  // because from the framework's point of view there's no way for it to
+  // observe an incomplete upload (except when copying a tensor back to CPU,
+  // at which point we correctly flush and queue a callback).
+  DmlUploadCache* upload_cache = upload_cache_;
+  DmlExecutionContext* execution_context = execution_context_;
+  upload_heap_->EnqueueUploadToGpu(
+      DmlUploadHeap::UploadRequest{dst_data, dst_offset, dst_state, byte_span},
+      [done, src_ref, dst_ref, upload_cache, execution_context, cache_reserved,
+       fingerprint, cache_data, cache_offset, dst_data, dst_offset, dst_state,
+       total_bytes](const Status& status) {
+        if (cache_reserved) {
+          if (status.ok()) {
+            // The upload is now ordered on the GPU timeline, so a copy
+            // recorded here reads the fresh destination bytes. The
+            // destination memory is still referenced (dst_ref is released
+            // below), so it can't be recycled before the copy is recorded.
+            (void)execution_context->CopyBufferRegion(
+                cache_data, cache_offset,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS, dst_data, dst_offset,
+                dst_state, total_bytes);
+            upload_cache->Commit(fingerprint);
+          } else {
+            upload_cache->Abandon(fingerprint);
+          }
+        }
+        src_ref.Unref();
+        dst_ref.Unref();
+        done(status);
+      });
 }
 
 void DMLDeviceContext::CopyTensorInSameDevice(const Tensor* input_tensor,
@@ -128,6 +328,10 @@ void DMLDeviceContext::CopyDeviceTensorToCPU(const Tensor* device_tensor,
     return;
   }
 
+  // The readback heap's completion event, signaled once the destination
+  // buffer has been fully populated.
+  DmlGpuEvent readback_event = status_or_event.ConsumeValueOrDie();
+
   // We have to kick off the GPU now to prevent a potential deadlock, because
   // we don't know if TF is going to block waiting on this copy to complete.
   status_or_event = execution_context_->Flush();
@@ -137,15 +341,85 @@ void DMLDeviceContext::CopyDeviceTensorToCPU(const Tensor* device_tensor,
     return;
   }
 
-  // Keep a ref on the source tensor to keep it alive until we're done with it
+  // Keep a ref on the source tensor to keep it alive until we're done with
+  // it. Track it so variable update kernels can tell that this reference only
+  // guards an already-recorded GPU read, not a program-level alias.
   TensorReference input_ref(*device_tensor);
+  int64 ref_id =
+      DmlTensorRefTracker::Instance()->Track(input_ref, readback_event);
 
-  // Invoke the "done" callback once the readback completes
-  auto callback = [done, input_ref] {
+  // Complete on the readback's own event rather than the compute queue's
+  // flush event: with the dedicated COPY queue the flush event signals when
+  // the copy is merely *allowed to start*, and on the compute queue it
+  // needlessly orders the caller after every other command in the flushed
+  // batch. While-loop predicates (LoopCond's HostMemory input) cross the
+  // device boundary through this path once per iteration, so their latency
+  // directly bounds how quickly the executor can feed the next iteration.
+  auto callback = [done, input_ref, ref_id] {
+    DmlTensorRefTracker::Instance()->Untrack(ref_id);
     input_ref.Unref();
     done(Status::OK());
   };
-  event_queue_->Enqueue(status_or_event.ConsumeValueOrDie(), callback);
+  readback_heap_->EnqueueCompletionCallback(std::move(readback_event),
+                                            std::move(callback));
+}
+
+Status DMLDeviceContext::ImportExternalBuffer(ID3D12Resource* buffer,
+                                              DataType dtype,
+                                              const TensorShape& shape,
+                                              ID3D12Fence* wait_fence,
+                                              uint64_t wait_fence_value,
+                                              Tensor* tensor) const {
+  if (buffer == nullptr) {
+    return errors::InvalidArgument("Imported resource must not be null");
+  }
+
+  D3D12_RESOURCE_DESC desc = buffer->GetDesc();
+  if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER) {
+    return errors::InvalidArgument(
+        "Imported resources must be buffers; textures need to be copied into "
+        "a buffer with row-major layout before import");
+  }
+
+  if (!DataTypeCanUseMemcpy(dtype)) {
+    return errors::InvalidArgument("Cannot import a tensor of type ",
+                                   DataTypeString(dtype));
+  }
+
+  const uint64_t required_bytes =
+      static_cast<uint64_t>(shape.num_elements()) * DataTypeSize(dtype);
+  if (desc.Width < required_bytes) {
+    return errors::InvalidArgument(
+        "Imported buffer is too small: tensor of shape ", shape.DebugString(),
+        " requires ", required_bytes, " bytes, but the buffer is only ",
+        desc.Width, " bytes");
+  }
+
+  // DML always requires at least 4 byte alignment
+  if (desc.Width % 4 != 0) {
+    return errors::InvalidArgument(
+        "Imported buffers must have a 4-byte-aligned width");
+  }
+
+  void* ptr = allocator_->ImportExternalResource(buffer, desc.Width);
+  if (ptr == nullptr) {
+    return errors::ResourceExhausted(
+        "Failed to register the imported resource with the DML allocator");
+  }
+
+  // Order all subsequently submitted GPU work after the producer's fence, so
+  // kernels never read the buffer before the caller finished writing it.
+  if (wait_fence != nullptr) {
+    execution_context_->QueueDependency(
+        DmlGpuEvent{wait_fence_value, wait_fence});
+  }
+
+  auto* tensor_buffer = new DmlImportedTensorBuffer(
+      ptr, desc.Width, allocator_, execution_context_, event_queue_);
+  *tensor = Tensor(dtype, shape, tensor_buffer);
+  tensor_buffer->Unref();  // the tensor now holds the only reference
+
+  return Status::OK();
 }
 
 }  // namespace tensorflow
\ No newline at end of file
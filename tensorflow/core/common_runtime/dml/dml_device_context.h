@@ -24,22 +24,43 @@ limitations under the License.
 
 namespace tensorflow {
 
+class DmlAllocator;
+class DmlCopyQueue;
+class DmlPinnedAllocator;
+class DmlUploadCache;
+
 class DMLDeviceContext : public DeviceContext {
  private:
-  // These are all weak pointers; owned by the DML device factory
+  // These are all weak pointers; owned by the DML device factory.
+  // copy_queue/copy_event_queue may be null if the dedicated copy queue is
+  // disabled, pinned_allocator if the pinned host allocator is, and
+  // upload_cache if the upload cache is.
   DmlExecutionContext* execution_context_;
   DmlEventQueue* event_queue_;
   DmlUploadHeap* upload_heap_;
   DmlReadbackHeap* readback_heap_;
+  DmlAllocator* allocator_;
+  DmlCopyQueue* copy_queue_;
+  DmlEventQueue* copy_event_queue_;
+  DmlPinnedAllocator* pinned_allocator_;
+  DmlUploadCache* upload_cache_;
 
  public:
   DMLDeviceContext(DmlExecutionContext* execution_context,
                    DmlEventQueue* event_queue, DmlUploadHeap* upload_heap,
-                   DmlReadbackHeap* readback_heap)
+                   DmlReadbackHeap* readback_heap, DmlAllocator* allocator,
+                   DmlCopyQueue* copy_queue, DmlEventQueue* copy_event_queue,
+                   DmlPinnedAllocator* pinned_allocator,
+                   DmlUploadCache* upload_cache)
       : execution_context_(execution_context),
         event_queue_(event_queue),
         upload_heap_(upload_heap),
-        readback_heap_(readback_heap) {}
+        readback_heap_(readback_heap),
+        allocator_(allocator),
+        copy_queue_(copy_queue),
+        copy_event_queue_(copy_event_queue),
+        pinned_allocator_(pinned_allocator),
+        upload_cache_(upload_cache) {}
 
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor, StatusCallback done,
@@ -52,6 +73,25 @@ class DMLDeviceContext : public DeviceContext {
   void CopyDeviceTensorToCPU(const Tensor* device_tensor, StringPiece edge_name,
                              Device* device, Tensor* cpu_tensor,
                              StatusCallback done) override;
+
+  // Wraps a caller-owned D3D12 buffer as a device-resident tensor without
+  // copying it, so GPU-produced data (e.g. rendered camera frames) can be fed
+  // straight into inference. The buffer must be large enough for the given
+  // dtype/shape (with a 4-byte-aligned width, as DML requires) and must be in
+  // the COMMON or UNORDERED_ACCESS state.
+  //
+  // Handoff is fence-based in both directions: if `wait_fence` is non-null,
+  // all GPU work submitted through this device after this call waits until
+  // the fence reaches `wait_fence_value` (i.e. until the producer has finished
+  // writing the buffer). In the other direction, this context takes a
+  // reference on the resource and releases it only once all GPU work enqueued
+  // before the tensor's destruction has completed, so the caller may safely
+  // Release() their resource as soon as the tensor and any pending Run() calls
+  // are done with it.
+  Status ImportExternalBuffer(ID3D12Resource* buffer, DataType dtype,
+                              const TensorShape& shape,
+                              ID3D12Fence* wait_fence,
+                              uint64_t wait_fence_value, Tensor* tensor) const;
 };
 
 }  // namespace tensorflow
\ No newline at end of file
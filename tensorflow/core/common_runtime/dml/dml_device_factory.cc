@@ -20,6 +20,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dml/dml_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/dml/dml_device.h"
 #include "tensorflow/core/common_runtime/dml/dml_device_cache.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/env_var.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -53,17 +57,94 @@ static std::string GetPhysicalDeviceDesc(const DmlAdapter& adapter) {
 
 static std::unique_ptr<DmlDevice> CreateDevice(
     const SessionOptions& options, const string& name_prefix, int device_index,
-    const DmlDeviceState* device_state, int64 memory_limit) {
+    const DmlDeviceState* device_state, int64 memory_limit,
+    const DeviceLocality& locality) {
   string name =
       strings::StrCat(name_prefix, "/device:", DEVICE_DML, ":", device_index);
 
   const DeviceAttributes attributes = Device::BuildDeviceAttributes(
-      name, tensorflow::DeviceType(DEVICE_DML), Bytes(memory_limit),
-      DeviceLocality(), GetPhysicalDeviceDesc(*device_state->adapter));
+      name, tensorflow::DeviceType(DEVICE_DML), Bytes(memory_limit), locality,
+      GetPhysicalDeviceDesc(*device_state->adapter));
 
   return absl::make_unique<DmlDevice>(device_state, options, attributes);
 }
 
+// Interconnect link strengths recorded in each DML device's DeviceLocality.
+// The collective param resolver's ring ordering follows the strongest
+// not-yet-visited link, so higher values make two devices more likely to be
+// ring neighbors.
+static constexpr int kLinkStrengthSameAdapter = 3;
+static constexpr int kLinkStrengthSameGroup = 2;
+static constexpr int kLinkStrengthSameHost = 1;
+
+// Returns one link-group id per physical adapter. Adapters in the same group
+// are treated as sharing a fast interconnect (e.g. the same PCIe root complex
+// or an xGMI bridge) when collective ring orders are laid out. Neither DXGI
+// nor DXCore exposes PCIe topology, so the grouping comes from the
+// TF_DIRECTML_ADAPTER_GROUPS environment variable: a comma-separated group id
+// per adapter, e.g. "0,0,1,1". When unset or malformed every adapter is its
+// own group, which leaves ring orders unchanged.
+static std::vector<int> GetAdapterLinkGroups(uint32_t adapter_count) {
+  std::vector<int> groups(adapter_count);
+  for (uint32_t i = 0; i < adapter_count; ++i) {
+    groups[i] = static_cast<int>(i);
+  }
+
+  string value;
+  Status s = ReadStringFromEnvVar("TF_DIRECTML_ADAPTER_GROUPS", "", &value);
+  if (!s.ok() || value.empty()) {
+    return groups;
+  }
+
+  std::vector<string> parts = str_util::Split(value, ',');
+  if (parts.size() != adapter_count) {
+    LOG(WARNING) << "TF_DIRECTML_ADAPTER_GROUPS names " << parts.size()
+                 << " adapters but " << adapter_count
+                 << " are present; ignoring it.";
+    return groups;
+  }
+  std::vector<int> parsed(adapter_count);
+  for (uint32_t i = 0; i < adapter_count; ++i) {
+    int32 group = 0;
+    if (!strings::safe_strto32(parts[i], &group)) {
+      LOG(WARNING) << "TF_DIRECTML_ADAPTER_GROUPS entry '" << parts[i]
+                   << "' is not an integer; ignoring it.";
+      return groups;
+    }
+    parsed[i] = group;
+  }
+  return parsed;
+}
+
+// Builds the locality for one DML device: a link to every peer device,
+// strongest for peers carved from the same adapter, then peers whose adapters
+// share a link group, then everything else on the host. OrderTaskDeviceMap in
+// the collective param resolver follows these strengths when assigning ring
+// orders, so devices that share a root complex become ring neighbors and a
+// reduction ring crosses the slow inter-complex hop only twice instead of on
+// every step.
+static DeviceLocality GetDeviceLocality(
+    int device_index, const std::vector<uint32_t>& device_adapters,
+    const std::vector<int>& adapter_groups) {
+  DeviceLocality locality;
+  LocalLinks* links = locality.mutable_links();
+  for (int peer = 0; peer < static_cast<int>(device_adapters.size()); ++peer) {
+    if (peer == device_index) continue;
+    InterconnectLink* link = links->add_link();
+    link->set_device_id(peer);
+    link->set_type(DEVICE_DML);
+    if (device_adapters[peer] == device_adapters[device_index]) {
+      link->set_strength(kLinkStrengthSameAdapter);
+    } else if (adapter_groups[device_adapters[peer]] ==
+               adapter_groups[device_adapters[device_index]]) {
+      link->set_strength(kLinkStrengthSameGroup);
+    } else {
+      link->set_strength(kLinkStrengthSameHost);
+    }
+  }
+  return locality;
+}
+
 static bool IsUmaAdapter(const DmlAdapter& adapter) {
   D3D_FEATURE_LEVEL feature_level = adapter.IsComputeOnly()
                                         ? D3D_FEATURE_LEVEL_1_0_CORE
@@ -88,6 +169,42 @@ static bool IsUmaAdapter(const DmlAdapter& adapter) {
   return feature_data.CacheCoherentUMA;
 }
 
+// Computes the memory limit for devices on `adapter` when no explicit
+// per-virtual-device limit was configured. The limit caps the BFC arena
+// (DmlAllocator); allow_growth controls whether the arena commits its full
+// region up front or grows on demand, same as the CUDA device.
+static int64 ComputeAdapterMemoryLimit(const DmlAdapter& adapter,
+                                       bool is_uma_adapter, bool allow_growth,
+                                       double memory_fraction) {
+  uint64_t total_gpu_memory = adapter.GetTotalDedicatedMemory();
+
+  if (is_uma_adapter) {
+    // For adapters with unified memory architecture (UMA), add shared
+    // memory to the total GPU memory
+    total_gpu_memory += adapter.GetTotalSharedMemory();
+  }
+
+  if (memory_fraction > 0.0f) {
+    // A per_process_gpu_memory_fraction was specified: compute the memory
+    // limit as a fraction of TOTAL GPU memory
+    return total_gpu_memory * memory_fraction;
+  }
+
+  if (allow_growth) {
+    // In growth mode the arena only commits what it actually uses, so the
+    // cap doesn't need to reflect instantaneous availability. Using total
+    // memory matches the CUDA device and keeps a process that happens to
+    // start while memory is temporarily scarce from being pinned to a small
+    // arena for its whole lifetime.
+    return total_gpu_memory;
+  }
+
+  // No per_process_gpu_memory_fraction was specified and the arena reserves
+  // its full region up front: use a memory limit equal to the AVAILABLE GPU
+  // memory
+  return adapter.QueryAvailableLocalMemory();
+}
+
 class DmlDeviceFactory : public DeviceFactory {
  public:
   Status ListPhysicalDevices(std::vector<string>* devices) override {
@@ -137,6 +254,17 @@ class DmlDeviceFactory : public DeviceFactory {
     const auto& virtual_devices = gpu_options.experimental().virtual_devices();
     double memory_fraction = gpu_options.per_process_gpu_memory_fraction();
 
+    if (memory_fraction < 0.0) {
+      return errors::InvalidArgument(
+          "per_process_gpu_memory_fraction must be non-negative, got ",
+          memory_fraction);
+    }
+    if (memory_fraction > 1.0) {
+      LOG(WARNING) << "per_process_gpu_memory_fraction is " << memory_fraction
+                   << "; values above 1.0 oversubscribe the adapter's "
+                      "physical memory and rely on shared memory paging.";
+    }
+
     if (!virtual_devices.empty()) {
       if (memory_fraction > 0.0f) {
         return errors::InvalidArgument(
@@ -154,13 +282,96 @@ class DmlDeviceFactory : public DeviceFactory {
       dml_device_count = virtual_devices.size();
     }
 
+    // By default all virtual devices carved out of an adapter share one
+    // DmlDeviceState, so their GPU work serializes on a single hardware
+    // compute queue even when the subgraphs are independent. When enabled,
+    // each virtual device gets a private state (and therefore its own compute
+    // queue), letting e.g. multi-tower inference run towers in parallel on
+    // the GPU. Cross-device exchanges are unaffected: they route through the
+    // host and are ordered by each queue's fence.
+    bool queue_per_virtual_device = false;
+    Status s = ReadBoolFromEnvVar("TF_DIRECTML_QUEUE_PER_VIRTUAL_DEVICE",
+                                  /*default_val=*/false,
+                                  &queue_per_virtual_device);
+    if (!s.ok()) {
+      queue_per_virtual_device = false;
+    }
+
+    // The UMA query creates a throwaway D3D12 device, and first-touch device
+    // state creation builds the real D3D12/DML devices, queues and
+    // allocators; each can take on the order of a second per adapter. Do this
+    // work for all selected adapters in parallel instead of paying for it
+    // serially in the loop below, which then finds everything cached. States
+    // are only warmed for adapters without explicit per-virtual-device memory
+    // limits: first touch of those must see the limits computed in the loop.
+    // (std::vector<bool> packs its elements, so it can't be written
+    // concurrently; use uint8_t.)
+    std::vector<uint8_t> is_uma(valid_adapter_indices.size(), 0);
+    std::vector<int64> warm_memory_limits(valid_adapter_indices.size(), 0);
+    {
+      thread::ThreadPool pool(
+          Env::Default(), "dml_device_warmup",
+          std::max<int>(1, static_cast<int>(valid_adapter_indices.size())));
+      for (size_t ordinal = 0; ordinal < valid_adapter_indices.size();
+           ++ordinal) {
+        pool.Schedule([&, ordinal] {
+          uint32_t adapter_index = valid_adapter_indices[ordinal];
+          const auto& adapter = device_cache.GetAdapter(adapter_index);
+
+          const bool is_uma_adapter = IsUmaAdapter(adapter);
+          is_uma[ordinal] = is_uma_adapter ? 1 : 0;
+
+          if (!virtual_devices.empty() &&
+              virtual_devices.Get(adapter_index).memory_limit_mb_size() != 0) {
+            return;
+          }
+
+          tensorflow::GPUOptions adapter_gpu_options = gpu_options;
+          if (is_uma_adapter) {
+            adapter_gpu_options.set_allow_growth(true);
+          }
+
+          int64 memory_limit = ComputeAdapterMemoryLimit(
+              adapter, is_uma_adapter, adapter_gpu_options.allow_growth(),
+              memory_fraction);
+          warm_memory_limits[ordinal] = memory_limit;
+
+          device_cache.GetOrCreateDeviceState(adapter_index,
+                                              adapter_gpu_options,
+                                              memory_limit);
+        });
+      }
+      // The pool's destructor waits for all warmup tasks to finish.
+    }
+
+    // Lay out the device -> adapter mapping up front so that each device's
+    // locality can carry links to all of its peers.
+    std::vector<uint32_t> device_adapters;
+    for (size_t ordinal = 0; ordinal < valid_adapter_indices.size();
+         ++ordinal) {
+      uint32_t i = valid_adapter_indices[ordinal];
+      if (virtual_devices.empty() ||
+          virtual_devices.Get(i).memory_limit_mb_size() == 0) {
+        device_adapters.push_back(i);
+      } else {
+        for (int vd = 0; vd < virtual_devices.Get(i).memory_limit_mb_size();
+             ++vd) {
+          device_adapters.push_back(i);
+        }
+      }
+    }
+    const std::vector<int> adapter_groups =
+        GetAdapterLinkGroups(device_cache.GetAdapterCount());
+
     int virtual_device_index = 0;
 
-    for (uint32_t i : valid_adapter_indices) {
+    for (size_t ordinal = 0; ordinal < valid_adapter_indices.size();
+         ++ordinal) {
+      uint32_t i = valid_adapter_indices[ordinal];
       const auto& adapter = device_cache.GetAdapter(i);
 
       tensorflow::GPUOptions adapter_gpu_options = gpu_options;
-      const bool is_uma_adapter = IsUmaAdapter(adapter);
+      const bool is_uma_adapter = is_uma[ordinal] != 0;
       if (is_uma_adapter) {
         // For adapters with unified memory architecture (UMA), which use system
         // memory, allocate memory as needed rather than all of it upfront.
@@ -169,34 +380,30 @@ class DmlDeviceFactory : public DeviceFactory {
 
       if (virtual_devices.empty() ||
           virtual_devices.Get(i).memory_limit_mb_size() == 0) {
-        int64 memory_limit = 0;
-        if (memory_fraction > 0.0f) {
-          // A per_process_gpu_memory_fraction was specified: compute the memory
-          // limit as a fraction of TOTAL GPU memory
-          uint64_t total_gpu_memory = adapter.GetTotalDedicatedMemory();
-
-          if (is_uma_adapter) {
-            // For adapters with unified memory architecture (UMA), add shared
-            // memory to the total GPU memory
-            total_gpu_memory += adapter.GetTotalSharedMemory();
-          }
-
-          memory_limit = total_gpu_memory * memory_fraction;
-        } else {
-          // No per_process_gpu_memory_fraction was specified: use a memory
-          // limit equal to the AVAILALBLE GPU memory
-          uint64_t available_gpu_memory = adapter.QueryAvailableLocalMemory();
-
-          memory_limit = available_gpu_memory;
-        }
+        int64 memory_limit = warm_memory_limits[ordinal];
 
         const DmlDeviceState* device_state =
             device_cache.GetOrCreateDeviceState(i, adapter_gpu_options,
                                                 memory_limit);
 
+        // Log the effective settings so operators can verify what the config
+        // resolved to (e.g. when co-locating processes on one adapter).
+        LOG(INFO) << "DirectML: DML:" << virtual_device_index << " -> adapter "
+                  << i << ", memory limit "
+                  << strings::HumanReadableNumBytes(memory_limit) << " ("
+                  << (memory_fraction > 0.0
+                          ? "per_process_gpu_memory_fraction"
+                          : adapter_gpu_options.allow_growth()
+                                ? "growth mode, capped at total memory"
+                                : "reserved from available memory")
+                  << "), allow_growth="
+                  << adapter_gpu_options.allow_growth();
+
         auto dml_device =
             CreateDevice(options, name_prefix, virtual_device_index,
-                         device_state, memory_limit);
+                         device_state, memory_limit,
+                         GetDeviceLocality(virtual_device_index,
+                                           device_adapters, adapter_groups));
 
         TF_RETURN_IF_ERROR(
             device_cache.MapDeviceIdToAdapterIndex(virtual_device_index++, i));
@@ -211,12 +418,26 @@ class DmlDeviceFactory : public DeviceFactory {
              ++it) {
           int64 memory_limit = static_cast<int64>(*it) * (1ll << 20);
 
+          // A private queue is only worth the duplicated pools when the
+          // adapter is actually split into multiple sub-devices.
           const DmlDeviceState* device_state =
-              device_cache.GetOrCreateDeviceState(i, adapter_gpu_options,
-                                                  memory_limit);
+              (queue_per_virtual_device && memory_limit_mb.size() > 1)
+                  ? device_cache.CreatePrivateDeviceState(
+                        i, adapter_gpu_options, memory_limit)
+                  : device_cache.GetOrCreateDeviceState(i, adapter_gpu_options,
+                                                        memory_limit);
+
+          LOG(INFO) << "DirectML: DML:" << virtual_device_index
+                    << " -> adapter " << i << ", memory limit "
+                    << strings::HumanReadableNumBytes(memory_limit)
+                    << " (virtual_devices), allow_growth="
+                    << adapter_gpu_options.allow_growth();
+
           auto dml_device =
               CreateDevice(options, name_prefix, virtual_device_index,
-                           device_state, memory_limit);
+                           device_state, memory_limit,
+                           GetDeviceLocality(virtual_device_index,
+                                             device_adapters, adapter_groups));
 
           TF_RETURN_IF_ERROR(device_cache.MapDeviceIdToAdapterIndex(
               virtual_device_index++, i));
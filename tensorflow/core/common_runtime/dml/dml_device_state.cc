@@ -15,14 +15,24 @@ limitations under the License.
 
 #include "dml_device_state.h"
 
+#include "absl/strings/ascii.h"
 #include "dml_adapter_impl.h"
 #include "dml_bfc_allocator.h"
+#include "dml_budget_manager.h"
+#include "dml_constant_pool.h"
+#include "dml_variable_arena.h"
+#include "dml_copy_queue.h"
 #include "dml_device_context.h"
 #include "dml_event_queue.h"
+#include "dml_kernel_context.h"
 #include "dml_kernel_manager.h"
+#include "dml_persistent_kernel_cache.h"
+#include "dml_pinned_allocator.h"
 #include "dml_readback_heap.h"
+#include "dml_upload_cache.h"
 #include "dml_upload_heap.h"
 #include "dml_util.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/stream_executor/platform/default/dso_loader.h"
@@ -37,6 +47,38 @@ static constexpr GUID kTensorflowDirectmlCreatorId = {
 
 namespace tensorflow {
 
+// Parses TF_DIRECTML_QUEUE_PRIORITY ("normal", "high" or "realtime") into a
+// D3D12 queue priority. A process hosting latency-sensitive inference can run
+// its compute and copy queues at an elevated priority so the GPU scheduler
+// services its submissions ahead of normal-priority work from other processes
+// sharing the adapter (e.g. background batch scoring). Session configuration
+// never reaches device creation in this fork - the device and its queues are
+// created once per process and shared by every session - so the selection is
+// per process rather than per session. GLOBAL_REALTIME additionally requires
+// elevated OS privileges; queue creation falls back to normal priority with a
+// warning if the requested priority is denied.
+static D3D12_COMMAND_QUEUE_PRIORITY GetQueuePriorityFromEnvVar() {
+  string priority_str;
+  Status s = ReadStringFromEnvVar("TF_DIRECTML_QUEUE_PRIORITY",
+                                  /*default_val=*/"normal", &priority_str);
+  if (!s.ok()) {
+    return D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+  }
+
+  priority_str = absl::AsciiStrToLower(priority_str);
+  if (priority_str == "high") {
+    return D3D12_COMMAND_QUEUE_PRIORITY_HIGH;
+  }
+  if (priority_str == "realtime") {
+    return D3D12_COMMAND_QUEUE_PRIORITY_GLOBAL_REALTIME;
+  }
+  if (priority_str != "normal") {
+    LOG(WARNING) << "Unrecognized TF_DIRECTML_QUEUE_PRIORITY value \""
+                 << priority_str << "\"; using normal priority.";
+  }
+  return D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+}
+
 /*static*/ std::unique_ptr<DmlDeviceState> DmlDeviceState::Create(
     const DmlAdapter& adapter, const GPUOptions& gpu_options,
     uint64_t memory_limit_in_bytes) {
@@ -83,46 +125,111 @@ namespace tensorflow {
                                            ? D3D12_COMMAND_LIST_TYPE_COMPUTE
                                            : D3D12_COMMAND_LIST_TYPE_DIRECT;
 
-  D3D12_COMMAND_QUEUE_DESC command_queue_desc = {};
-  command_queue_desc.Type = queue_type;
-  command_queue_desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
-  command_queue_desc.Flags = D3D12_COMMAND_QUEUE_FLAG_DISABLE_GPU_TIMEOUT;
-  command_queue_desc.NodeMask = 0;
+  const D3D12_COMMAND_QUEUE_PRIORITY queue_priority =
+      GetQueuePriorityFromEnvVar();
 
-  ComPtr<ID3D12CommandQueue> command_queue;
+  auto create_command_queue = [&](D3D12_COMMAND_QUEUE_PRIORITY priority,
+                                  ComPtr<ID3D12CommandQueue>* queue) {
+    D3D12_COMMAND_QUEUE_DESC command_queue_desc = {};
+    command_queue_desc.Type = queue_type;
+    command_queue_desc.Priority = priority;
+    command_queue_desc.Flags = D3D12_COMMAND_QUEUE_FLAG_DISABLE_GPU_TIMEOUT;
+    command_queue_desc.NodeMask = 0;
 
 #ifdef DIRECTML_ENABLE_TELEMETRY
-  Microsoft::WRL::ComPtr<ID3D12Device9> d3d_device9;
-  if (SUCCEEDED(d3d_device->QueryInterface(IID_PPV_ARGS(&d3d_device9)))) {
-    // If ID3D12Device9 is available, create with the DMLTF CreatorID for
-    // telemetry. This call should succeed even if the ID is unrecognized.
-    DML_CHECK_SUCCEEDED(d3d_device9->CreateCommandQueue1(
-        &command_queue_desc, kTensorflowDirectmlCreatorId,
-        IID_PPV_ARGS(&command_queue)));
-  }
+    Microsoft::WRL::ComPtr<ID3D12Device9> d3d_device9;
+    if (SUCCEEDED(d3d_device->QueryInterface(IID_PPV_ARGS(&d3d_device9)))) {
+      // If ID3D12Device9 is available, create with the DMLTF CreatorID for
+      // telemetry. This call should succeed even if the ID is unrecognized;
+      // if it fails anyway, fall through to the plain creation path below.
+      HRESULT hr = d3d_device9->CreateCommandQueue1(
+          &command_queue_desc, kTensorflowDirectmlCreatorId,
+          IID_PPV_ARGS(queue));
+      if (SUCCEEDED(hr)) {
+        return hr;
+      }
+    }
 #endif
 
-  // Create a queue without a client hint if telemetry is disabled or we're
-  // running on an older version of D3D.
-  if (!command_queue) {
-    DML_CHECK_SUCCEEDED(d3d_device->CreateCommandQueue(
-        &command_queue_desc, IID_PPV_ARGS(&command_queue)));
+    // Create a queue without a client hint if telemetry is disabled or we're
+    // running on an older version of D3D.
+    return d3d_device->CreateCommandQueue(&command_queue_desc,
+                                          IID_PPV_ARGS(queue));
+  };
+
+  ComPtr<ID3D12CommandQueue> command_queue;
+  HRESULT create_queue_hr = create_command_queue(queue_priority, &command_queue);
+  if (FAILED(create_queue_hr) &&
+      queue_priority != D3D12_COMMAND_QUEUE_PRIORITY_NORMAL) {
+    LOG(WARNING) << "DirectML: creating the compute queue at the requested "
+                    "priority failed (GLOBAL_REALTIME requires elevated "
+                    "privileges); falling back to normal priority.";
+    create_queue_hr =
+        create_command_queue(D3D12_COMMAND_QUEUE_PRIORITY_NORMAL,
+                             &command_queue);
   }
+  DML_CHECK_SUCCEEDED(create_queue_hr);
 
   // Retrieve the sharing contract which we use to delimit capture boundaries.
   // This may fail, so sharing_contract_ may end up null.
   ComPtr<ID3D12SharingContract> sharing_contract;
   (void)command_queue->QueryInterface(IID_PPV_ARGS(&sharing_contract));
 
+  // On cache-coherent UMA adapters (iGPUs), "device" memory is plain system
+  // memory that the CPU caches coherently, so serve tensor memory from
+  // CPU-visible custom heaps instead of DEFAULT heaps. This lets the device
+  // context write uploaded tensor data straight through a mapped pointer,
+  // skipping the staging copy through the upload heap entirely (see
+  // DMLDeviceContext::CopyCPUTensorToDevice). GetCustomHeapProperties returns
+  // WRITE_BACK/L0 on such adapters, which has identical GPU access
+  // characteristics to a DEFAULT heap there. Can be disabled with
+  // TF_DIRECTML_UMA_ZERO_COPY=0.
+  D3D12_FEATURE_DATA_ARCHITECTURE architecture = {};
+  const bool cache_coherent_uma =
+      SUCCEEDED(d3d_device->CheckFeatureSupport(D3D12_FEATURE_ARCHITECTURE,
+                                                &architecture,
+                                                sizeof(architecture))) &&
+      architecture.CacheCoherentUMA;
+
+  bool uma_zero_copy;
+  s = ReadBoolFromEnvVar("TF_DIRECTML_UMA_ZERO_COPY",
+                         /*default_val=*/true, &uma_zero_copy);
+  if (!s.ok()) {
+    uma_zero_copy = true;
+  }
+
+  D3D12_HEAP_PROPERTIES heap_properties =
+      CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+  if (cache_coherent_uma && uma_zero_copy) {
+    heap_properties =
+        d3d_device->GetCustomHeapProperties(0, D3D12_HEAP_TYPE_DEFAULT);
+    LOG(INFO) << "DirectML: cache-coherent UMA adapter; serving device memory "
+                 "from CPU-visible heaps (zero-copy uploads enabled).";
+  }
+
   auto heap_allocator = absl::make_unique<D3D12HeapAllocator>(
-      d3d_device.Get(), CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-      D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+      d3d_device.Get(), heap_properties, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
       D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
       D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
   auto dml_allocator = absl::make_unique<DmlAllocator>(
       heap_allocator.get(), memory_limit_in_bytes, gpu_options, "DmlAllocator");
 
+  // Pinned host memory for gpu_compatible allocations: tensors feeding the
+  // device land in GPU-readable upload memory, so CopyCPUTensorToDevice can
+  // skip the staging memcpy and enqueue a single bus transfer.
+  bool use_pinned_allocator;
+  s = ReadBoolFromEnvVar("TF_DIRECTML_PINNED_ALLOCATOR",
+                         /*default_val=*/true, &use_pinned_allocator);
+  if (!s.ok()) {
+    use_pinned_allocator = true;
+  }
+  std::unique_ptr<DmlPinnedAllocator> pinned_allocator;
+  if (use_pinned_allocator) {
+    pinned_allocator = absl::make_unique<DmlPinnedAllocator>(
+        d3d_device.Get(), "DmlPinnedAllocator");
+  }
+
   auto descriptor_heap_allocator =
       absl::make_unique<D3D12DescriptorHeapAllocator>(
           d3d_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
@@ -138,13 +245,75 @@ namespace tensorflow {
   auto event_queue = absl::make_unique<DmlEventQueue>(
       execution_context->GetCurrentCompletionEvent().fence.Get());
 
-  auto upload_heap = absl::make_unique<DmlUploadHeap>(d3d_device.Get(),
-                                                      execution_context.get());
+  // Publish the compute queue's busy time so tf.data autotuning can account
+  // for accelerator utilization. DmlDeviceState instances are cached for the
+  // lifetime of the process, so the raw pointer never dangles.
+  data::model::AcceleratorBusyTimeRegistry::Global()->Register(
+      [queue = event_queue.get()]() { return queue->GetTotalBusyMicros(); });
+
+  // Use a dedicated COPY queue so that uploads/readbacks overlap with compute
+  // on the main queue, synchronized with fences.
+  bool use_copy_queue;
+  s = ReadBoolFromEnvVar("TF_DIRECTML_DEDICATED_COPY_QUEUE",
+                         /*default_val=*/true, &use_copy_queue);
+
+  std::unique_ptr<DmlCopyQueue> copy_queue;
+  std::unique_ptr<DmlEventQueue> copy_event_queue;
+  if (s.ok() && use_copy_queue) {
+    copy_queue =
+        absl::make_unique<DmlCopyQueue>(d3d_device.Get(), queue_priority);
+    copy_event_queue =
+        absl::make_unique<DmlEventQueue>(copy_queue->GetFence().Get());
+  }
+
+  // Route asynchronous page-in completion fences into both queues, so GPU
+  // work that binds a freshly-restored heap waits on the GPU timeline instead
+  // of the allocator blocking in MakeResident. The raw pointers are safe: all
+  // of these objects live in the same DmlDeviceState, which is cached for the
+  // lifetime of the process.
+  heap_allocator->SetResidencyWaitHandler(
+      [context = execution_context.get(),
+       copies = copy_queue.get()](DmlGpuEvent event) {
+        if (copies != nullptr) {
+          copies->QueueDependency(event);
+        }
+        context->QueueDependency(std::move(event));
+      });
+
+  auto upload_heap = absl::make_unique<DmlUploadHeap>(
+      d3d_device.Get(), execution_context.get(), copy_queue.get());
+
+  // Memoizes repeated host-to-device feeds by content fingerprint, so
+  // identical bytes uploaded across steps become device-to-device copies
+  // instead of bus transfers (see DMLDeviceContext::CopyCPUTensorToDevice).
+  auto upload_cache = DmlUploadCache::MaybeCreate(dml_allocator.get());
 
   auto readback_heap = absl::make_unique<DmlReadbackHeap>(
-      d3d_device.Get(), execution_context.get(), event_queue.get());
+      d3d_device.Get(), execution_context.get(), event_queue.get(),
+      copy_queue.get(), copy_event_queue.get());
+
+  auto constant_pool = absl::make_unique<DmlConstantPool>(dml_allocator.get(),
+                                                          upload_heap.get());
+
+  auto scratch_pool =
+      absl::make_unique<DmlScratchBufferPool>(dml_allocator.get());
+
+  // Packs small resource variables into shared backing allocations.
+  bool use_variable_arena;
+  s = ReadBoolFromEnvVar("TF_DIRECTML_VARIABLE_ARENA",
+                         /*default_val=*/true, &use_variable_arena);
+
+  std::unique_ptr<DmlVariableArena> variable_arena;
+  if (s.ok() && use_variable_arena) {
+    variable_arena = absl::make_unique<DmlVariableArena>(dml_allocator.get());
+  }
+
+  auto kernel_manager = absl::make_unique<DmlKernelManager>(
+      DmlPersistentKernelCache::MaybeCreate(adapter));
 
-  auto kernel_manager = absl::make_unique<DmlKernelManager>();
+  auto budget_manager = DmlBudgetManager::MaybeCreate(
+      adapter, heap_allocator.get(), dml_allocator.get(),
+      kernel_manager.get());
 
   // Construct the final state object
   auto state = absl::make_unique<DmlDeviceState>();
@@ -155,13 +324,21 @@ namespace tensorflow {
   state->dml_device = std::move(dml_device);
   state->execution_context = std::move(execution_context);
   state->event_queue = std::move(event_queue);
+  state->copy_queue = std::move(copy_queue);
+  state->copy_event_queue = std::move(copy_event_queue);
   state->heap_allocator = std::move(heap_allocator);
   state->dml_allocator = std::move(dml_allocator);
+  state->pinned_allocator = std::move(pinned_allocator);
   state->descriptor_heap_allocator = std::move(descriptor_heap_allocator);
   state->descriptor_allocator = std::move(descriptor_allocator);
   state->upload_heap = std::move(upload_heap);
+  state->upload_cache = std::move(upload_cache);
   state->readback_heap = std::move(readback_heap);
+  state->constant_pool = std::move(constant_pool);
+  state->scratch_pool = std::move(scratch_pool);
+  state->variable_arena = std::move(variable_arena);
   state->kernel_manager = std::move(kernel_manager);
+  state->budget_manager = std::move(budget_manager);
   return state;
 }
 
@@ -23,14 +23,21 @@ namespace tensorflow {
 
 class DmlAdapter;
 class DmlExecutionContext;
+class DmlCopyQueue;
 class DmlEventQueue;
 class D3D12HeapAllocator;
 class DmlAllocator;
 class D3D12DescriptorHeapAllocator;
 class DmlDescriptorAllocator;
+class DmlPinnedAllocator;
 class DmlUploadHeap;
+class DmlUploadCache;
 class DmlReadbackHeap;
+class DmlConstantPool;
+class DmlScratchBufferPool;
+class DmlVariableArena;
 class DmlKernelManager;
+class DmlBudgetManager;
 class GPUOptions;
 
 // Holds device state that is shared across one or more DmlDevice instances.
@@ -54,13 +61,33 @@ struct DmlDeviceState {
   Microsoft::WRL::ComPtr<IDMLDevice> dml_device;
   std::unique_ptr<DmlExecutionContext> execution_context;
   std::unique_ptr<DmlEventQueue> event_queue;
+
+  // Dedicated COPY-type queue for overlapping transfers with compute. These
+  // may be null if the dedicated copy queue is disabled.
+  std::unique_ptr<DmlCopyQueue> copy_queue;
+  std::unique_ptr<DmlEventQueue> copy_event_queue;
   std::unique_ptr<D3D12HeapAllocator> heap_allocator;
   std::unique_ptr<DmlAllocator> dml_allocator;
+  // Pinned (persistently mapped UPLOAD-heap) host allocator, served for
+  // gpu_compatible host allocations so uploads need no staging copy. May be
+  // null if disabled.
+  std::unique_ptr<DmlPinnedAllocator> pinned_allocator;
   std::unique_ptr<D3D12DescriptorHeapAllocator> descriptor_heap_allocator;
   std::unique_ptr<DmlDescriptorAllocator> descriptor_allocator;
   std::unique_ptr<DmlUploadHeap> upload_heap;
+  // Fingerprint-keyed cache of repeated uploads. May be null if disabled.
+  std::unique_ptr<DmlUploadCache> upload_cache;
   std::unique_ptr<DmlReadbackHeap> readback_heap;
+  std::unique_ptr<DmlConstantPool> constant_pool;
+  std::unique_ptr<DmlScratchBufferPool> scratch_pool;
+
+  // May be null if variable packing is disabled.
+  std::unique_ptr<DmlVariableArena> variable_arena;
   std::unique_ptr<DmlKernelManager> kernel_manager;
+
+  // May be null if disabled. Declared last so its polling thread is joined
+  // before the allocator and kernel manager it references are destroyed.
+  std::unique_ptr<DmlBudgetManager> budget_manager;
 };
 
 }  // namespace tensorflow
\ No newline at end of file
@@ -0,0 +1,375 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <unordered_set>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/common_runtime/dml/dml_fused_elementwise.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Longest chain we'll collapse into a single _DmlFusedElementwise node. This
+// bounds the number of bindings in the fused kernel and keeps kernel cache
+// keys from growing without bound.
+constexpr int kMaxChainLength = 16;
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+bool IsFusableNode(const Node* n) {
+  if (DmlFusedElementwiseArity(n->type_string()) == 0) {
+    return false;
+  }
+
+  if (!IsDmlDevice(n)) {
+    return false;
+  }
+
+  // The fused kernel is only registered for float types; integer elementwise
+  // ops go through int64 emulation paths which the fused kernel doesn't
+  // implement.
+  DataType dtype;
+  if (!TryGetNodeAttr(n->attrs(), "T", &dtype) ||
+      (dtype != DT_FLOAT && dtype != DT_HALF)) {
+    return false;
+  }
+
+  return true;
+}
+
+// Returns the single data consumer of `n`'s output if `n` is eligible to be a
+// non-terminal link of a fusion chain, or nullptr otherwise.
+const Edge* GetSingleConsumerEdge(const Node* n) {
+  const Edge* consumer = nullptr;
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge()) {
+      // A control edge out of a non-terminal chain node could reach a producer
+      // of one of the chain's side inputs, which would form a cycle once the
+      // chain collapses into a single node. Rather than do a reachability
+      // analysis, simply don't fuse through nodes with outgoing control edges.
+      return nullptr;
+    }
+
+    if (consumer != nullptr) {
+      return nullptr;  // More than one data consumer
+    }
+    consumer = e;
+  }
+  return consumer;
+}
+
+struct FusionChain {
+  // The chain nodes in execution order. All nodes have a single data consumer
+  // except the last.
+  std::vector<Node*> nodes;
+
+  // fp16/fp32 bridging Casts absorbed into the fused node's tensor types: one
+  // optional producer Cast per external input, plus at most one consumer Cast
+  // of the tail (recorded separately in `output_cast`).
+  std::vector<Node*> cast_nodes;
+  Node* output_cast = nullptr;
+
+  std::vector<string> op_names;
+};
+
+// Grows a fusion chain starting at `head`. Whether the chain is worth fusing
+// is decided by the caller, after boundary Casts have been absorbed.
+void BuildChain(Node* head, const std::unordered_set<Node*>& consumed,
+                FusionChain* chain) {
+  Node* node = head;
+
+  while (true) {
+    chain->nodes.push_back(node);
+    chain->op_names.push_back(node->type_string());
+
+    if (chain->nodes.size() >= kMaxChainLength) {
+      break;
+    }
+
+    const Edge* consumer_edge = GetSingleConsumerEdge(node);
+    if (!consumer_edge) {
+      break;
+    }
+
+    Node* next = consumer_edge->dst();
+    if (!IsFusableNode(next) || consumed.count(next)) {
+      break;
+    }
+
+    // The chain value must flow into the consumer as an elementwise operand.
+    // For binary consumers we require it to be input 0, so that the fused
+    // kernel's left-to-right evaluation matches the original dataflow.
+    // (Add/AddV2/Mul are commutative, so input 1 is acceptable too.)
+    int chain_input_index = consumer_edge->dst_input();
+    bool commutative = next->type_string() == "Add" ||
+                       next->type_string() == "AddV2" ||
+                       next->type_string() == "Mul";
+    if (chain_input_index != 0 && !commutative) {
+      break;
+    }
+
+    // Note that a binary op consuming the previous result on *both* operands
+    // (e.g. Square written as Mul(x, x)) never gets here, because the previous
+    // node then has two data out-edges and GetSingleConsumerEdge rejects it.
+    node = next;
+  }
+}
+
+// A Cast that only bridges the half/float boundary can fold into the fused
+// kernel's tensor descs: DML elementwise operators accept distinct input and
+// output data types, so the conversion happens in-flight instead of as a
+// standalone read-write pass. The DML Cast kernel ignores the Truncate attr,
+// so absorbing one keeps parity with the standalone kernel.
+bool IsAbsorbableCast(const Node* n) {
+  if (n->type_string() != "Cast" || !IsDmlDevice(n)) {
+    return false;
+  }
+
+  DataType src_type, dst_type;
+  if (!TryGetNodeAttr(n->attrs(), "SrcT", &src_type) ||
+      !TryGetNodeAttr(n->attrs(), "DstT", &dst_type)) {
+    return false;
+  }
+
+  auto is_fusable_type = [](DataType t) {
+    return t == DT_FLOAT || t == DT_HALF;
+  };
+  return is_fusable_type(src_type) && is_fusable_type(dst_type) &&
+         src_type != dst_type;
+}
+
+// Folds fp16/fp32 bridging Casts at the chain's boundaries into the fused
+// node's input/output types. Post-AMP graphs surround fp16 regions with such
+// Casts, each of which otherwise costs a full pass over the tensor.
+void AbsorbBoundaryCasts(const std::unordered_set<Node*>& consumed,
+                         FusionChain* chain) {
+  // Producer Casts: a Cast whose only consumer is the chain gets bypassed;
+  // the fused node reads the Cast's input and converts as it loads.
+  for (size_t i = 0; i < chain->nodes.size(); ++i) {
+    Node* n = chain->nodes[i];
+    Node* prev = (i == 0) ? nullptr : chain->nodes[i - 1];
+
+    for (int input_index = 0; input_index < n->num_inputs(); ++input_index) {
+      const Edge* e;
+      TF_CHECK_OK(n->input_edge(input_index, &e));
+
+      if (e->src() == prev) {
+        continue;  // Internal chain edge
+      }
+
+      Node* src = e->src();
+      if (IsAbsorbableCast(src) && !consumed.count(src) &&
+          GetSingleConsumerEdge(src) == e) {
+        chain->cast_nodes.push_back(src);
+      }
+    }
+  }
+
+  // Consumer Cast: if the tail's only consumer is a bridging Cast, the fused
+  // node emits the Cast's type directly.
+  const Edge* consumer_edge = GetSingleConsumerEdge(chain->nodes.back());
+  if (consumer_edge != nullptr && IsAbsorbableCast(consumer_edge->dst()) &&
+      !consumed.count(consumer_edge->dst())) {
+    chain->output_cast = consumer_edge->dst();
+    chain->cast_nodes.push_back(consumer_edge->dst());
+  }
+}
+
+Status ReplaceChain(Graph* g, const FusionChain& chain) {
+  Node* head = chain.nodes.front();
+  Node* tail = chain.nodes.back();
+
+  DataType dtype;
+  TF_RETURN_IF_ERROR(GetNodeAttr(head->attrs(), "T", &dtype));
+
+  DataType out_type = dtype;
+  if (chain.output_cast != nullptr) {
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(chain.output_cast->attrs(), "DstT", &out_type));
+  }
+
+  // Collect the external data inputs in binding order: the chain input first,
+  // then one side input per binary op in chain order. This runs at rewrite
+  // time rather than while gathering chains, because replacing an earlier
+  // chain rewires edges that feed this one. Absorbed producer Casts are
+  // skipped over; the fused node reads the Cast's own input instead.
+  std::unordered_set<const Node*> absorbed_casts(chain.cast_nodes.begin(),
+                                                 chain.cast_nodes.end());
+  std::vector<NodeBuilder::NodeOut> inputs;
+  std::vector<DataType> input_types;
+
+  for (size_t i = 0; i < chain.nodes.size(); ++i) {
+    Node* n = chain.nodes[i];
+    Node* prev = (i == 0) ? nullptr : chain.nodes[i - 1];
+
+    for (int input_index = 0; input_index < n->num_inputs(); ++input_index) {
+      const Edge* e;
+      TF_RETURN_IF_ERROR(n->input_edge(input_index, &e));
+
+      if (e->src() == prev) {
+        continue;  // Internal chain edge
+      }
+      if (absorbed_casts.count(e->src())) {
+        TF_RETURN_IF_ERROR(e->src()->input_edge(0, &e));
+      }
+
+      inputs.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+      input_types.push_back(e->src()->output_type(e->src_output()));
+    }
+  }
+
+  NodeDebugInfo debug_info(*tail);
+  NodeBuilder builder(g->NewName(strings::StrCat(head->name(), "/dml_fused")),
+                      "_DmlFusedElementwise", OpRegistry::Global(),
+                      &debug_info);
+
+  Node* fused = nullptr;
+  TF_RETURN_IF_ERROR(builder.Device(head->requested_device())
+                         .Input(inputs)
+                         .Attr("T", dtype)
+                         .Attr("input_types", input_types)
+                         .Attr("out_type", out_type)
+                         .Attr("op_names", chain.op_names)
+                         .Finalize(g, &fused));
+  fused->set_assigned_device_name(tail->assigned_device_name());
+
+  // Move incoming control edges from all fused-away nodes, and the final
+  // node's outgoing edges, onto the fused node. When a consumer Cast was
+  // absorbed, its out edges are the fused node's out edges.
+  for (Node* n : chain.nodes) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+  }
+  for (Node* n : chain.cast_nodes) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+  }
+
+  Node* out_node = chain.output_cast != nullptr ? chain.output_cast : tail;
+  std::vector<const Edge*> out_edges(out_node->out_edges().begin(),
+                                     out_node->out_edges().end());
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(fused, e->dst());
+    } else {
+      g->AddEdge(fused, 0, e->dst(), e->dst_input());
+    }
+  }
+
+  for (Node* n : chain.nodes) {
+    g->RemoveNode(n);
+  }
+  for (Node* n : chain.cast_nodes) {
+    g->RemoveNode(n);
+  }
+
+  return Status::OK();
+}
+
+// Collapses producer/consumer chains of elementwise ops placed on DML devices
+// into single _DmlFusedElementwise nodes. The fused kernel compiles the whole
+// chain into one DML graph, so a chain of N ops costs one binding table and
+// one dispatch instead of N. fp16/fp32 bridging Casts at the chain's
+// boundaries fold into the fused node's input/output types rather than
+// surviving as standalone passes over the tensor.
+class DmlElementwiseFusionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool fusion_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_ELEMENTWISE_FUSION",
+                                          /*default_val=*/true,
+                                          &fusion_enabled));
+    if (!fusion_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather chains first, then rewrite, so that iteration never walks over
+    // deleted nodes. `consumed` tracks nodes already claimed by a chain.
+    std::vector<FusionChain> chains;
+    std::unordered_set<Node*> consumed;
+
+    for (Node* n : g->op_nodes()) {
+      if (consumed.count(n) || !IsFusableNode(n)) {
+        continue;
+      }
+
+      // Only start a chain at its head: skip nodes whose value flows in from
+      // another fusable node, since those are picked up as chain links.
+      const Edge* input0 = nullptr;
+      Status s = n->input_edge(0, &input0);
+      if (s.ok() && IsFusableNode(input0->src()) && !consumed.count(input0->src()) &&
+          GetSingleConsumerEdge(input0->src()) != nullptr) {
+        continue;
+      }
+
+      FusionChain chain;
+      BuildChain(n, consumed, &chain);
+      AbsorbBoundaryCasts(consumed, &chain);
+
+      // A chain is worth fusing once it eliminates at least one dispatch;
+      // absorbed Casts count, so even a lone op bracketed by AMP Casts fuses.
+      if (chain.nodes.size() + chain.cast_nodes.size() < 2) {
+        continue;
+      }
+
+      consumed.insert(chain.nodes.begin(), chain.nodes.end());
+      consumed.insert(chain.cast_nodes.begin(), chain.cast_nodes.end());
+      chains.push_back(std::move(chain));
+    }
+
+    for (const FusionChain& chain : chains) {
+      VLOG(1) << "DmlElementwiseFusionPass: fusing "
+              << absl::StrJoin(chain.op_names, "+") << " rooted at '"
+              << chain.nodes.front()->name() << "'";
+      TF_RETURN_IF_ERROR(ReplaceChain(options.graph->get(), chain));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement so that device assignments are known, but before the
+// executor sees the graph.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 25,
+                      DmlElementwiseFusionPass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,7 +15,18 @@ limitations under the License.
 
 #include "dml_event_queue.h"
 
+#include <chrono>
+
 namespace tensorflow {
+namespace {
+
+uint64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
 
 DmlEventQueue::DmlEventQueue(ID3D12Fence* fence) {
   shared_state_ = std::make_shared<SharedState>();
@@ -26,11 +37,11 @@ DmlEventQueue::DmlEventQueue(ID3D12Fence* fence) {
 }
 
 DmlEventQueue::~DmlEventQueue() {
-  // Request exit of the background thread
-  std::unique_lock<std::mutex> lock(shared_state_->mutex);
-  shared_state_->exit_requested = true;
-  shared_state_->new_event_enqueued.notify_all();  // wake the thread
-  lock.unlock();
+  shared_state_->exit_requested.store(true);
+  {
+    std::unique_lock<std::mutex> lock(shared_state_->wake_mutex);
+    shared_state_->event_enqueued.notify_all();  // wake the thread
+  }
 
   // detach() rather than join(), because we don't want (or need) to wait for
   // it to complete. This prevents blocking in a destructor, which would be
@@ -39,110 +50,139 @@ DmlEventQueue::~DmlEventQueue() {
 }
 
 void DmlEventQueue::Enqueue(DmlGpuEvent gpu_event, DoneCallback done_callback) {
-  std::unique_lock<std::mutex> lock(shared_state_->mutex);
-  const auto& state = shared_state_;
+  SharedState* state = shared_state_.get();
 
   // Sanity: double check that we're only using one fence at a time, because
   // otherwise monotonically increasing fence values no longer describe a
   // linear timeline...
   CHECK(state->fence.Get() == gpu_event.fence.Get());
-  DCHECK(state->fence->GetCompletedValue() + 1 >=
-         state->current_awaited_fence_value);
-
-  // If the thread is currently waiting on a fence value less or equal than the
-  // supplied gpu_event, it means the fence may or may not be signaled, and
-  // therefore should be queued to be processed by the thread. Otherwise, if the
-  // fence value is greater, it means it's definitely already been signaled and
-  // the callback should be invoked immediately.
-  if (state->current_awaited_fence_value <= gpu_event.fence_value) {
-    // Queue the event and notify the thread.
-    state->events_by_fence_value.emplace(gpu_event.fence_value,
-                                         Event{std::move(done_callback)});
-    state->new_event_enqueued.notify_all();
-  } else {
-    // Sanity: all prior events in the queue should have been processed already
-    DCHECK(state->events_by_fence_value.lower_bound(gpu_event.fence_value) ==
-           state->events_by_fence_value.begin());
 
+  // If the fence has already reached this value there's nothing to wait for;
+  // fire the callback inline rather than round-tripping it through the waiter
+  // thread. This is exact (not racy): fence values only ever increase.
+  if (state->fence->GetCompletedValue() >= gpu_event.fence_value) {
     done_callback();
+    return;
+  }
+
+  // Otherwise hand the event to the waiter thread. A full ring means the
+  // waiter is behind; yield until it catches up.
+  Event event = {gpu_event.fence_value, std::move(done_callback)};
+  while (!state->ring.TryEnqueue(std::move(event))) {
+    std::this_thread::yield();
+  }
+
+  // Publish/subscribe handshake with the waiter thread: the seq_cst fences
+  // here and in ThreadProc guarantee that either this thread observes
+  // `thread_sleeping` and wakes the waiter, or the waiter's final emptiness
+  // check observes the event just enqueued.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (state->thread_sleeping.load(std::memory_order_relaxed)) {
+    std::unique_lock<std::mutex> lock(state->wake_mutex);
+    state->event_enqueued.notify_all();
   }
 }
 
+uint64_t DmlEventQueue::GetTotalBusyMicros() const {
+  SharedState* state = shared_state_.get();
+  uint64_t busy = state->busy_micros.load(std::memory_order_relaxed);
+  uint64_t since = state->busy_since_micros.load(std::memory_order_relaxed);
+  if (since != 0) {
+    // The current busy interval is still open; include it. The two loads
+    // above aren't atomic with respect to the waiter thread closing the
+    // interval, so this can over-count by at most one interval - harmless for
+    // a utilization estimate.
+    uint64_t now = NowMicros();
+    if (now > since) {
+      busy += now - since;
+    }
+  }
+  return busy;
+}
+
 /*static*/ void DmlEventQueue::ThreadProc(std::shared_ptr<SharedState> state) {
+  // Events drained from the ring whose fence values haven't been reached yet,
+  // ordered by fence value. Only this thread touches it, so no lock is needed.
+  std::multimap<uint64_t, Event> pending_events;
   std::vector<Event> events_to_process;
 
-  while (true) {
-    std::unique_lock<std::mutex> lock(state->mutex);
-    if (state->exit_requested) {
-      break;
+  while (!state->exit_requested.load()) {
+    // Drain everything producers have published since the last pass.
+    Event event;
+    while (state->ring.TryDequeue(&event)) {
+      uint64_t fence_value = event.fence_value;
+      pending_events.emplace(fence_value, std::move(event));
     }
 
-    if (state->events_by_fence_value.empty()) {
-      // Wait for new events
-      state->new_event_enqueued.wait(lock);
+    // Fire every callback whose fence value has been reached, as one batch.
+    // One GetCompletedValue poll covers all of them; equal fence values fire
+    // in the order they were enqueued (multimap preserves insertion order for
+    // equivalent keys).
+    uint64_t completed_value = state->fence->GetCompletedValue();
 
-      // No need for a loop around the wait() in case of spurious wakeup; just
-      // return to the top. This also handles the case where exit is
-      // requested.
-      continue;
-    }
+    auto begin = pending_events.begin();
+    auto end = pending_events.upper_bound(completed_value);
 
-    DCHECK(!state->events_by_fence_value.empty());
-    DCHECK(events_to_process.empty());
-
-    // Decide the next fence value to wait on. Using GetCompletedValue + 1
-    // ensures that *any* signal wakes this thread (assuming monotonically
-    // increasing fence values, which we require.)
-    //
-    // Note that because fences are asynchronous, this next_fence_value could
-    // become signaled at any time (even immediately). This is okay; it just
-    // means that the wait we perform below will return immediately, and the
-    // loop will continue.
-    uint64_t next_fence_value = state->fence->GetCompletedValue() + 1;
-    state->current_awaited_fence_value = next_fence_value;
-
-    // Find all the events that have fence values < next_fence_values. These
-    // events, by definition, have had their fence values signaled and can now
-    // be processed.
-    auto begin = state->events_by_fence_value.begin();
-    auto end = state->events_by_fence_value.lower_bound(next_fence_value);
-
-    // Move the signaled events into the vector
     events_to_process.reserve(std::distance(begin, end));
     for (auto it = begin; it != end; ++it) {
-      DCHECK(it->first < next_fence_value);
       events_to_process.push_back(std::move(it->second));
     }
-    state->events_by_fence_value.erase(begin, end);
-
-    // Process the events by invoking their done callback
-    for (const auto& event : events_to_process) {
-      event.done_callback();
+    pending_events.erase(begin, end);
+
+    // Busy-time accounting: the queue counts as busy while any event is
+    // pending on an unsignaled fence value. Record transitions here, where
+    // `pending_events` reflects the fence poll above.
+    {
+      uint64_t now = NowMicros();
+      if (!pending_events.empty()) {
+        if (state->busy_since_micros.load(std::memory_order_relaxed) == 0) {
+          state->busy_since_micros.store(now, std::memory_order_relaxed);
+        }
+      } else {
+        uint64_t since =
+            state->busy_since_micros.load(std::memory_order_relaxed);
+        if (since != 0) {
+          state->busy_micros.fetch_add(now - since,
+                                       std::memory_order_relaxed);
+          state->busy_since_micros.store(0, std::memory_order_relaxed);
+        }
+      }
     }
 
-    bool event_queue_empty = state->events_by_fence_value.empty();
-
-    // We've finished processing the events, so we can unlock the mutex now.
-    lock.unlock();
-
+    for (const auto& e : events_to_process) {
+      e.done_callback();
+    }
     events_to_process.clear();
 
-    // If the queue isn't empty then there are still events waiting for a fence
-    // value that hasn't been reached. The WaitForSignal below is to avoid a
-    // busy wait, but it's not required for correctness. WaitForSignal should
-    // NOT be invoked if the queue is already empty since another signal may
-    // never come (i.e. no more events are enqueued).
-    if (!event_queue_empty) {
-      // Now wait for the fence to become signaled again. Recall that the choice
-      // of next_fence_value ensures this wait will complete no matter what
-      // value is signaled.
-      DmlGpuEvent next_event{next_fence_value, state->fence};
+    if (!pending_events.empty()) {
+      // Some events are still waiting on the fence. Block until *any* value
+      // beyond `completed_value` is signaled; because fence values increase
+      // monotonically and the pending events' values are all greater than
+      // `completed_value`, this wait is guaranteed to eventually complete, and
+      // any newly enqueued events are picked up on the next pass.
+      DmlGpuEvent next_event{completed_value + 1, state->fence};
       next_event.WaitForSignal();
 
       // We require monotonically increasing fence values; time is not allowed
       // to go backward!
-      CHECK(state->fence->GetCompletedValue() >= next_fence_value);
+      CHECK(state->fence->GetCompletedValue() >= completed_value + 1);
+      continue;
+    }
+
+    // Nothing pending: sleep until a producer enqueues. `thread_sleeping` is
+    // set before the final emptiness check (paired with the fence in
+    // Enqueue), and the wait is bounded as belt-and-braces against a missed
+    // wakeup.
+    std::unique_lock<std::mutex> lock(state->wake_mutex);
+    state->thread_sleeping.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (state->ring.Empty() && !state->exit_requested.load()) {
+      state->event_enqueued.wait_for(lock, std::chrono::milliseconds(1));
     }
+
+    state->thread_sleeping.store(false);
   }
 }
 
@@ -15,11 +15,13 @@ limitations under the License.
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <map>
 #include <thread>
 
+#include "dml_command_ring.h"
 #include "dml_common.h"
 #include "dml_gpu_event.h"
 
@@ -29,6 +31,13 @@ namespace tensorflow {
 // instance of this queue can only be used with a single fence, and the fence's
 // signaled values are assumed to only ever increase in a monotonic fashion.
 // This class is thread-safe.
+//
+// The enqueue path is lock-free: producers push events onto a bounded MPSC
+// ring (or invoke the callback inline if its fence value has already been
+// reached), and a single waiter thread drains the ring and fires *all*
+// callbacks whose fence values have completed in one batch per wakeup.
+// Deallocation-heavy graphs enqueue thousands of events per step, so per-event
+// locking and per-event fence waits are the overhead this design avoids.
 class DmlEventQueue {
  public:
   using DoneCallback = std::function<void()>;
@@ -37,31 +46,56 @@ class DmlEventQueue {
   ~DmlEventQueue();
 
   // Enqueues an arbitrary callback to fire once the given GPU event becomes
-  // signaled. The callback is invoked asynchronously, on an arbitrary thread.
-  // If there are multiple callbacks enqueued for a single fence value, those
-  // callbacks are executed in the order they were queued. This method is
-  // thread-safe.
+  // signaled. The callback is invoked asynchronously, on an arbitrary thread;
+  // if the event is already signaled, it may be invoked directly on the
+  // calling thread. If there are multiple callbacks enqueued for a single
+  // fence value, those callbacks are executed in the order they were queued.
+  // This method is thread-safe and does not take any locks.
   void Enqueue(DmlGpuEvent gpu_event, DoneCallback done_callback);
 
+  // Returns the cumulative wall-clock microseconds during which this queue had
+  // events pending on an unsignaled fence value - i.e. time during which the
+  // GPU demonstrably had work in flight. Since every kernel launch enqueues at
+  // least one event (buffer deallocations), this is a close proxy for device
+  // busy time. Thread-safe; the value is approximate to within one waiter
+  // wakeup.
+  uint64_t GetTotalBusyMicros() const;
+
  private:
   struct Event {
+    uint64_t fence_value;
     DoneCallback done_callback;
   };
 
-  // State shared with the background thread. Protected by `mutex`.
+  static constexpr size_t kEventRingCapacity = 4096;  // must be a power of two
+
+  // State shared with the background thread.
   struct SharedState {
-    // The fence associated with this queue.
+    // The fence associated with this queue. Immutable after construction.
     Microsoft::WRL::ComPtr<ID3D12Fence> fence;
-    std::mutex mutex;
-    std::condition_variable new_event_enqueued;  // An event that fires whenever
-                                                 // a new event is added.
-    std::multimap<uint64_t, Event> events_by_fence_value;
-
-    // The current fence value that the thread is waiting to be signaled. This
-    // value is guaranteed to be <= fence->GetCompletedValue()+1.
-    uint64_t current_awaited_fence_value = 0;
 
-    bool exit_requested = false;
+    // Events not yet known to be signaled. Producers enqueue here; only the
+    // waiter thread dequeues.
+    DmlCommandRing<Event> ring{kEventRingCapacity};
+
+    std::atomic<bool> exit_requested{false};
+
+    // Wake handshake for the idle waiter thread. The mutex only guards the
+    // condition variable; it is never held on the enqueue fast path unless the
+    // waiter is asleep with an empty ring. Same scheme as the execution
+    // context's batching thread: the waiter sets `thread_sleeping` before its
+    // final emptiness check, and producers re-check it after publishing to the
+    // ring, so one side always observes the other.
+    std::mutex wake_mutex;
+    std::condition_variable event_enqueued;
+    std::atomic<bool> thread_sleeping{false};
+
+    // Busy-time accounting, maintained by the waiter thread and read by
+    // GetTotalBusyMicros. `busy_since_micros` is the timestamp at which the
+    // queue most recently transitioned from empty to non-empty, or 0 if it is
+    // currently empty; `busy_micros` accumulates the completed busy intervals.
+    std::atomic<uint64_t> busy_micros{0};
+    std::atomic<uint64_t> busy_since_micros{0};
   };
 
   static void ThreadProc(std::shared_ptr<SharedState> state);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "dml_bfc_allocator.h"
 #include "dml_buffer.h"
+#include "dml_metrics.h"
 #include "dml_tracing.h"
 #include "dml_util.h"
 #include "tensorflow/core/util/env_var.h"
@@ -31,6 +32,36 @@ static SetThreadDescriptionFn g_setThreadDescription = nullptr;
 
 namespace tensorflow {
 
+// Lock-free batching protocol
+// ---------------------------
+// Commands flow from recording threads to the execution thread through a
+// bounded MPSC ring (DmlCommandRing). Completion events are minted without a
+// lock by reading `next_flush_fence_value` — the fence value the *next* flush
+// will signal. Correctness of the returned values relies on a Dekker-style
+// handshake:
+//
+//   producer: enqueue command; seq_cst fence; read next_flush_fence_value
+//   consumer: fetch_add next_flush_fence_value; seq_cst fence; drain ring
+//
+// If a flush's drain misses a command (it was still in flight), the producer
+// is guaranteed to observe that flush's fetch_add, so the value it returns is
+// at least as large as whichever later flush actually executes the command.
+// The returned value can therefore only over-estimate, never under-estimate.
+//
+// Over-estimated values (and values returned by Flush/GetCurrentCompletionEvent
+// while work is pending) are recorded in `max_returned_fence_value`. Whenever
+// the ring runs dry with `max_returned_fence_value` not yet claimed by a flush,
+// the execution thread submits an empty command list — the queue still signals
+// its fence — so every event ever handed out is guaranteed to become signaled.
+
+// Atomically raises max_returned_fence_value to at least `value`.
+static void RaiseToAtLeast(std::atomic<uint64_t>& max_value, uint64_t value) {
+  uint64_t current = max_value.load(std::memory_order_relaxed);
+  while (current < value &&
+         !max_value.compare_exchange_weak(current, value)) {
+  }
+}
+
 DmlExecutionContext::DmlExecutionContext(ID3D12Device* d3d_device,
                                          IDMLDevice* dml_device,
                                          ID3D12CommandQueue* queue,
@@ -48,45 +79,95 @@ DmlExecutionContext::DmlExecutionContext(ID3D12Device* d3d_device,
 
   dml_command_queue_ = std::make_shared<DmlCommandQueue>(queue);
 
-  batch_state_ = std::make_shared<BatchState>();
-  batch_state_->next_flush_event =
+  DmlGpuEvent queue_completion_event =
       dml_command_queue_->GetCurrentCompletionEvent();
-  ++batch_state_->next_flush_event.fence_value;
 
-  uint32_t batch_flush_size = default_batch_flush_size;
+  batch_state_ = std::make_shared<BatchState>(queue_completion_event.fence);
+  batch_state_->next_flush_fence_value.store(
+      queue_completion_event.fence_value + 1, std::memory_order_relaxed);
+  batch_state_->max_returned_fence_value.store(
+      queue_completion_event.fence_value, std::memory_order_relaxed);
+
+  FlushHeuristics heuristics;
   {
+    // An explicitly configured threshold is treated as hand-tuned for the SKU
+    // and pins that parameter; the feedback controller only adjusts the rest.
     int64 batch_flush_size_int64 = 0;
     Status s = ReadInt64FromEnvVar("TF_DIRECTML_BATCH_FLUSH_SIZE", 0,
                                    &batch_flush_size_int64);
     if (s.ok() && batch_flush_size_int64 != 0) {
-      batch_flush_size = static_cast<uint32_t>(batch_flush_size_int64);
+      heuristics.flush_size = static_cast<uint32_t>(batch_flush_size_int64);
+      heuristics.adapt_size = false;
     }
   }
 
-  uint32_t batch_flush_time_us = default_batch_flush_time_us;
   {
     int64 batch_flush_time_us_int64 = 0;
     Status s = ReadInt64FromEnvVar("TF_DIRECTML_BATCH_FLUSH_TIME", 0,
                                    &batch_flush_time_us_int64);
     if (s.ok() && batch_flush_time_us_int64 != 0) {
-      batch_flush_time_us = static_cast<uint32_t>(batch_flush_time_us_int64);
+      heuristics.flush_time_us =
+          static_cast<uint32_t>(batch_flush_time_us_int64);
+      heuristics.adapt_time = false;
+    }
+  }
+
+  {
+    bool adaptive_flush = true;
+    Status s = ReadBoolFromEnvVar("TF_DIRECTML_ADAPTIVE_FLUSH",
+                                  /*default_val=*/true, &adaptive_flush);
+    if (s.ok() && !adaptive_flush) {
+      heuristics.adapt_size = false;
+      heuristics.adapt_time = false;
     }
   }
 
   dml_command_list_ = std::make_shared<DmlCommandList>(
-      d3d_device, dml_device, dml_command_queue_->GetType(), allocator);
+      d3d_device, dml_device, dml_command_queue_->GetType(), allocator,
+      DmlGpuProfiler::MaybeCreate(d3d_device, queue));
 
   execution_thread_ =
       std::thread(ExecutionThreadProc, batch_state_, dml_command_list_,
-                  dml_command_queue_, batch_flush_size, batch_flush_time_us);
+                  dml_command_queue_, heuristics);
+}
+
+void DmlExecutionContext::FlushHeuristics::OnFlushSample(
+    uint64_t flushes_in_flight) {
+  // Simple AIMD-style controller, clamped to sane bounds. A starved GPU (it
+  // completed everything before the next submission arrived) wants smaller,
+  // more frequent batches; a deep backlog means submissions are cheap
+  // relative to execution, so larger batches shave per-flush overhead.
+  constexpr uint32_t min_flush_size = 16;
+  constexpr uint32_t max_flush_size = 512;
+  constexpr uint32_t min_flush_time_us = 250;
+  constexpr uint32_t max_flush_time_us = 4000;
+  constexpr uint64_t backlog_watermark = 4;
+
+  if (flushes_in_flight == 0) {
+    if (adapt_size) {
+      flush_size = std::max(min_flush_size, flush_size / 2);
+    }
+    if (adapt_time) {
+      flush_time_us = std::max(min_flush_time_us, flush_time_us / 2);
+    }
+  } else if (flushes_in_flight > backlog_watermark) {
+    if (adapt_size) {
+      flush_size = std::min(max_flush_size, flush_size * 2);
+    }
+    if (adapt_time) {
+      flush_time_us = std::min(max_flush_time_us, flush_time_us + 250);
+    }
+  }
 }
 
 DmlExecutionContext::~DmlExecutionContext() {
-  // Request exit of the background thread
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-  batch_state_->exit_requested = true;
-  batch_state_->command_added.notify_all();  // wake the thread
-  lock.unlock();
+  // Request exit of the background thread. The wake_mutex is taken so the
+  // notify can't slip between the thread's final condition check and its wait.
+  batch_state_->exit_requested.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(batch_state_->wake_mutex);
+    batch_state_->command_added.notify_all();
+  }
 
   // detach() rather than join(), because we don't want (or need) to wait for
   // it to complete. This prevents blocking in a destructor, which would be
@@ -94,142 +175,225 @@ DmlExecutionContext::~DmlExecutionContext() {
   execution_thread_.detach();
 }
 
+/*static*/ void DmlExecutionContext::WakeExecutionThread(BatchState* state) {
+  // Only touch the mutex when the thread is (or is about to start) sleeping;
+  // under load this branch is never taken. A lost wakeup in the tiny window
+  // where the thread flags itself as sleeping is bounded by the timed wait in
+  // ExecutionThreadProc.
+  if (state->thread_sleeping.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(state->wake_mutex);
+    state->command_added.notify_all();
+  }
+}
+
+DmlGpuEvent DmlExecutionContext::AppendCommand(Command&& command) {
+  BatchState* state = batch_state_.get();
+
+  // The ring only fills up if recording threads outpace the execution thread
+  // by the full ring capacity; yield until it drains.
+  while (!state->command_ring.TryEnqueue(std::move(command))) {
+    WakeExecutionThread(state);
+    std::this_thread::yield();
+  }
+
+  state->enqueued_count.fetch_add(1, std::memory_order_release);
+
+  // Pairs with the fence in ExecutionThreadProc (see protocol comment above):
+  // guarantees the value read below is >= the fence value of whichever flush
+  // executes the command just enqueued.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  uint64_t fence_value =
+      state->next_flush_fence_value.load(std::memory_order_relaxed);
+
+  RaiseToAtLeast(state->max_returned_fence_value, fence_value);
+  WakeExecutionThread(state);
+
+  return DmlGpuEvent{fence_value, state->fence};
+}
+
+DmlGpuEvent DmlExecutionContext::AppendCommand(
+    std::function<void(DmlCommandList&)>&& record) {
+  Command command;
+  command.record = std::move(record);
+  return AppendCommand(std::move(command));
+}
+
 DmlGpuEvent DmlExecutionContext::CopyBufferRegion(
     ID3D12Resource* dst_buffer, uint64_t dst_offset,
     D3D12_RESOURCE_STATES dst_state, ID3D12Resource* src_buffer,
     uint64_t src_offset, D3D12_RESOURCE_STATES src_state, uint64_t byte_count) {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-
-  batch_state_->WriteBatch().emplace_back([=](DmlCommandList& command_list) {
+  return AppendCommand([=](DmlCommandList& command_list) {
     command_list.CopyBufferRegion(dst_buffer, dst_offset, dst_state, src_buffer,
                                   src_offset, src_state, byte_count);
   });
-
-  batch_state_->command_added.notify_all();
-
-  return batch_state_->next_flush_event;
 }
 
 DmlGpuEvent DmlExecutionContext::FillBufferWithPattern(
     ID3D12Resource* dst, uint64_t dst_offset, uint64_t dst_size_in_bytes,
     absl::Span<const uint8_t> value) {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-
   absl::InlinedVector<uint8_t, 16> value_copy(value.begin(), value.end());
-  batch_state_->WriteBatch().emplace_back(
+  return AppendCommand(
       [=, value = std::move(value_copy)](DmlCommandList& command_list) {
         command_list.FillBufferWithPattern(dst, dst_offset, dst_size_in_bytes,
                                            value);
       });
-
-  batch_state_->command_added.notify_all();
-
-  return batch_state_->next_flush_event;
 }
 
 DmlGpuEvent DmlExecutionContext::InitializeOperator(
     IDMLOperatorInitializer* initializer,
     Microsoft::WRL::ComPtr<IDMLBindingTable>&& binding_table,
     ID3D12DescriptorHeap* descriptor_heap) {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-
-  batch_state_->WriteBatch().emplace_back(
+  return AppendCommand(
       [=,
        binding_table = std::move(binding_table)](DmlCommandList& command_list) {
         command_list.InitializeOperator(initializer, binding_table.Get(),
                                         descriptor_heap);
       });
-
-  batch_state_->command_added.notify_all();
-
-  return batch_state_->next_flush_event;
 }
 
 DmlGpuEvent DmlExecutionContext::ExecuteOperator(
     IDMLCompiledOperator* op,
     Microsoft::WRL::ComPtr<IDMLBindingTable>&& binding_table,
-    ID3D12DescriptorHeap* descriptor_heap) {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-
-  batch_state_->WriteBatch().emplace_back(
-      [=,
-       binding_table = std::move(binding_table)](DmlCommandList& command_list) {
-        command_list.ExecuteOperator(op, binding_table.Get(), descriptor_heap);
+    ID3D12DescriptorHeap* descriptor_heap, std::string op_name) {
+  return AppendCommand(
+      [=, binding_table = std::move(binding_table),
+       op_name = std::move(op_name)](DmlCommandList& command_list) {
+        command_list.ExecuteOperator(op, binding_table.Get(), descriptor_heap,
+                                     op_name);
       });
+}
 
-  batch_state_->command_added.notify_all();
+bool DmlExecutionContext::IsGpuProfilingActive() const {
+  DmlGpuProfiler* profiler = dml_command_list_->GetProfiler();
+  return profiler != nullptr && profiler->IsStepCaptureActive();
+}
 
-  return batch_state_->next_flush_event;
+DmlGpuProfiler* DmlExecutionContext::GetGpuProfiler() const {
+  return dml_command_list_->GetProfiler();
 }
 
 DmlGpuEvent DmlExecutionContext::ResourceBarrier(
     absl::Span<const D3D12_RESOURCE_BARRIER> barriers) {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-
   // The caller may not keep the barriers referenced by the span alive for
   // longer than this function call, so make a copy and transfer ownership to
   // the lambda.
   absl::InlinedVector<D3D12_RESOURCE_BARRIER, 4> barriers_copy(barriers.begin(),
                                                                barriers.end());
-  batch_state_->WriteBatch().emplace_back(
+  return AppendCommand(
       [=, barriers = std::move(barriers_copy)](DmlCommandList& command_list) {
         command_list.ResourceBarrier(barriers);
       });
-
-  batch_state_->command_added.notify_all();
-
-  return batch_state_->next_flush_event;
 }
 
 DmlGpuEvent DmlExecutionContext::UavBarrier() {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-
-  batch_state_->WriteBatch().emplace_back(
-      [=](DmlCommandList& command_list) { command_list.UavBarrier(); });
+  return AppendCommand(
+      [](DmlCommandList& command_list) { command_list.UavBarrier(); });
+}
 
-  batch_state_->command_added.notify_all();
+DmlGpuEvent DmlExecutionContext::ExecutePrerecordedCommandList(
+    Microsoft::WRL::ComPtr<ID3D12CommandList> command_list) {
+  Command command;
+  command.prerecorded = std::move(command_list);
+  return AppendCommand(std::move(command));
+}
 
-  return batch_state_->next_flush_event;
+void DmlExecutionContext::QueueDependency(DmlGpuEvent gpu_event) {
+  std::lock_guard<std::mutex> lock(batch_state_->aux_mutex);
+  batch_state_->pending_waits.push_back(std::move(gpu_event));
 }
 
 StatusOr<DmlGpuEvent> DmlExecutionContext::Flush() {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-  auto event = batch_state_->next_flush_event;
-  if (batch_state_->WriteBatch().empty()) {
-    --event.fence_value;
+  BatchState* state = batch_state_.get();
+
+  // The read order matters: reading executed_count first means a concurrent
+  // flush can only make work look pending that has already executed — never
+  // the reverse.
+  uint64_t executed = state->executed_count.load(std::memory_order_acquire);
+  uint64_t enqueued = state->enqueued_count.load(std::memory_order_relaxed);
+  uint64_t next_fence_value =
+      state->next_flush_fence_value.load(std::memory_order_relaxed);
+
+  if (enqueued == executed) {
+    // Nothing is batched; everything handed out so far is covered by the
+    // previous flush, so this is a no-op.
+    return DmlGpuEvent{next_fence_value - 1, state->fence};
   }
 
-  batch_state_->flush_requested = true;
-  batch_state_->command_added.notify_all();
+  DmlGpuEvent event{next_fence_value, state->fence};
+  RaiseToAtLeast(state->max_returned_fence_value, event.fence_value);
+  state->flush_requested.store(true, std::memory_order_release);
+  WakeExecutionThread(state);
   return event;
 }
 
+void DmlExecutionContext::BeginOpRun() {
+  batch_state_->open_op_runs.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void DmlExecutionContext::EndOpRun() {
+  BatchState* state = batch_state_.get();
+  if (state->open_op_runs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // The last open run just ended, which is the structural point to submit:
+    // no thread is mid-chain, and nothing else will extend the batch until
+    // the next run begins. Request a flush only if there's batched work so an
+    // empty run doesn't burn a fence value.
+    uint64_t executed = state->executed_count.load(std::memory_order_acquire);
+    uint64_t enqueued = state->enqueued_count.load(std::memory_order_relaxed);
+    if (enqueued != executed) {
+      state->flush_requested.store(true, std::memory_order_release);
+      WakeExecutionThread(state);
+    }
+  }
+}
+
 Status DmlExecutionContext::GetCommandRecorderStatus() const {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
+  std::lock_guard<std::mutex> lock(batch_state_->aux_mutex);
   return batch_state_->status;
 }
 
 DmlGpuEvent DmlExecutionContext::GetCurrentCompletionEvent() {
-  std::unique_lock<std::mutex> lock(batch_state_->mutex);
-  auto event = batch_state_->next_flush_event;
-  if (batch_state_->WriteBatch().empty()) {
-    --event.fence_value;
+  BatchState* state = batch_state_.get();
+
+  // Same read order as Flush(), and for the same reason.
+  uint64_t executed = state->executed_count.load(std::memory_order_acquire);
+  uint64_t enqueued = state->enqueued_count.load(std::memory_order_relaxed);
+  uint64_t next_fence_value =
+      state->next_flush_fence_value.load(std::memory_order_relaxed);
+
+  if (enqueued == executed) {
+    return DmlGpuEvent{next_fence_value - 1, state->fence};
   }
+
+  // Work is pending, so return the value the next flush will signal. Record it
+  // as handed-out so the execution thread guarantees it eventually fires, but
+  // don't request a flush — batching proceeds as usual.
+  DmlGpuEvent event{next_fence_value, state->fence};
+  RaiseToAtLeast(state->max_returned_fence_value, event.fence_value);
+  WakeExecutionThread(state);
   return event;
 }
 
+DmlGpuEvent DmlExecutionContext::GetLastFlushedCompletionEvent() {
+  BatchState* state = batch_state_.get();
+
+  // Every value below next_flush_fence_value has been claimed by a flush whose
+  // Signal is already (or is unconditionally about to be) enqueued on the
+  // queue, so this event can never refer to work still waiting in the ring.
+  uint64_t next_fence_value =
+      state->next_flush_fence_value.load(std::memory_order_acquire);
+  return DmlGpuEvent{next_fence_value - 1, state->fence};
+}
+
 D3D12_COMMAND_LIST_TYPE DmlExecutionContext::GetCommandListTypeForQueue()
     const {
-  // No need to acquire the lock since the queue type is immutable once the
-  // queue is constructed.
   return dml_command_queue_->GetType();
 }
 
 /*static*/ void DmlExecutionContext::ExecutionThreadProc(
     std::shared_ptr<BatchState> state,
     std::shared_ptr<DmlCommandList> command_list,
-    std::shared_ptr<DmlCommandQueue> command_queue, uint32_t batch_flush_size,
-    uint32_t batch_flush_time_us) {
+    std::shared_ptr<DmlCommandQueue> command_queue,
+    FlushHeuristics heuristics) {
 #if _WIN32
   if (g_setThreadDescription) {
     g_setThreadDescription(GetCurrentThread(), L"TFDML Execution Thread");
@@ -237,67 +401,197 @@ D3D12_COMMAND_LIST_TYPE DmlExecutionContext::GetCommandListTypeForQueue()
 #endif
 
   auto last_flush_time = std::chrono::steady_clock::now();
+  Batch batch;
 
-  while (true) {
+  while (!state->exit_requested.load(std::memory_order_acquire)) {
     std::chrono::duration<double> elapsed =
         std::chrono::steady_clock::now() - last_flush_time;
     auto elapsed_us = elapsed.count() * 1e6;
 
-    std::unique_lock<std::mutex> lock(state->mutex);
-    if (state->exit_requested) {
-      break;
+    size_t queued = state->command_ring.ApproxSize();
+
+    // This thread is the only writer of next_flush_fence_value, so this read
+    // is exact.
+    uint64_t next_fence_value =
+        state->next_flush_fence_value.load(std::memory_order_relaxed);
+
+    // If a handed-out event isn't covered by any claimed flush and no queued
+    // work will trigger a natural one, an empty flush is needed so the fence
+    // still reaches it.
+    bool catch_up_needed =
+        queued == 0 &&
+        state->max_returned_fence_value.load(std::memory_order_acquire) >=
+            next_fence_value;
+
+    // While executor threads have op runs open, hold the size/time flushes so
+    // a run's command chain isn't split across submissions; the run's end
+    // requests an explicit flush (see EndOpRun). The hold is capped so a run
+    // stalled on the CPU can't starve the GPU indefinitely.
+    bool hold_active =
+        state->open_op_runs.load(std::memory_order_acquire) > 0 &&
+        elapsed_us <
+            static_cast<double>(flush_hold_limit_multiplier) *
+                heuristics.flush_time_us;
+
+    // Check if it's time to flush batched work to the GPU: this occurs if a
+    // flush is explicitly requested, the batch has reached a certain size, or
+    // enough time has elapsed since the last flush. The goal here is to
+    // balance feeding the GPU work while the CPU is processing more commands
+    // and avoiding many small packets.
+    bool flush =
+        (queued > 0 &&
+         (state->flush_requested.load(std::memory_order_acquire) ||
+          (!hold_active && (queued >= heuristics.flush_size ||
+                            elapsed_us >= heuristics.flush_time_us)))) ||
+        catch_up_needed;
+
+    if (!flush) {
+      std::unique_lock<std::mutex> lock(state->wake_mutex);
+      state->thread_sleeping.store(true, std::memory_order_release);
+
+      // The flush conditions are all atomics, so a producer may update one
+      // just before thread_sleeping is visible to it and skip the notify; the
+      // timed wait bounds the latency of that race to one flush interval.
+      auto timeout = queued > 0
+                         ? std::chrono::microseconds(heuristics.flush_time_us)
+                         : std::chrono::milliseconds(1);
+      state->command_added.wait_for(lock, timeout);
+      state->thread_sleeping.store(false, std::memory_order_release);
+      continue;
+    }
+
+    // Attribute the flush to the condition that triggered it, in the same
+    // priority order as the check above, before the request flag is cleared.
+    const char* flush_reason;
+    if (queued == 0) {
+      flush_reason = "catch_up";
+    } else if (state->flush_requested.load(std::memory_order_relaxed)) {
+      flush_reason = "requested";
+    } else if (queued >= heuristics.flush_size) {
+      flush_reason = "size";
+    } else {
+      flush_reason = "time";
     }
 
-    auto& batch = state->WriteBatch();
+    state->flush_requested.store(false, std::memory_order_relaxed);
 
-    if (batch.empty()) {
-      // Wait for new work to be batched.
-      state->command_added.wait(lock);
+    // Claim the fence value this flush will signal *before* draining the
+    // ring; together with the fence in AppendCommand this guarantees that any
+    // command missed by the drain below returns a fence value no smaller than
+    // the flush that eventually executes it.
+    state->next_flush_fence_value.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
-      // Return to the top in case of spurious wakeup.
-      continue;
+    Command command;
+    while (state->command_ring.TryDequeue(&command)) {
+      batch.push_back(std::move(command));
     }
 
-    // Check if it's time to swap the write/execute batches and flush work to
-    // the GPU: this occurs if a flush is explicitly requested, the batch has
-    // reached a certain size, or enough time has elapsed since the last flush.
-    // The goal here is to balance feeding the GPU work while the CPU is
-    // processing more commands and avoiding many small packets.
-    bool flush = false;
-    DmlGpuEvent batch_completion_event = state->next_flush_event;
-    if (state->flush_requested || batch.size() >= batch_flush_size ||
-        elapsed_us >= batch_flush_time_us) {
-      state->write_batch_index = (state->write_batch_index + 1) % 2;
-      flush = true;
-      ++state->next_flush_event.fence_value;
+    DmlTracing::Instance().LogExecutionContextFlush();
+
+    // Sample GPU progress at submission time: if the fence already reached
+    // the previous flush, the GPU went idle waiting on the CPU.
+    uint64_t completed = state->fence->GetCompletedValue();
+    uint64_t last_signaled = next_fence_value - 1;
+    uint64_t flushes_in_flight =
+        last_signaled > completed ? last_signaled - completed : 0;
+
+    dml_metrics::RecordExecutionContextFlush(flush_reason, batch.size(),
+                                             flushes_in_flight);
+
+    // The command queue signals its fence once per ExecuteCommandLists, so
+    // this event's fence value matches the value claimed above.
+    DmlGpuEvent batch_completion_event = command_queue->GetNextCompletionEvent();
+    assert(batch_completion_event.fence_value == next_fence_value);
+
+    // Take ownership of any cross-queue dependencies; they are satisfied on
+    // the GPU timeline immediately before this batch executes. This must
+    // happen before any part of the batch is submitted below.
+    absl::InlinedVector<DmlGpuEvent, 4> waits;
+    {
+      std::lock_guard<std::mutex> lock(state->aux_mutex);
+      waits.swap(state->pending_waits);
+    }
+    for (const DmlGpuEvent& wait : waits) {
+      command_queue->Wait(wait.fence.Get(), wait.fence_value);
     }
-    state->flush_requested = false;
 
-    // Unlock to allow kernels to resume writing to the new write batch.
-    lock.unlock();
+    if (!batch.empty()) {
+      // Feed the progress sample into the adaptive thresholds. Empty catch-up
+      // flushes are excluded since they carry no real work.
+      heuristics.OnFlushSample(flushes_in_flight);
+
+      auto submit_start = std::chrono::steady_clock::now();
+
+      // Record and submit the batch. Pre-recorded command lists (replayed
+      // kernel dispatches) are spliced into the submission sequence in order;
+      // whenever one follows freshly recorded commands, the recording list is
+      // closed and submitted early, because the same underlying list object
+      // is reset and reused for the remainder of the batch. Only the final
+      // submission signals the fence, so the whole batch still completes on
+      // the single fence value claimed above.
+      Status status;
+      bool list_open = false;
+      absl::InlinedVector<ID3D12CommandList*, 8> pending_lists;
+
+      auto submit_without_signal = [&] {
+        if (!pending_lists.empty()) {
+          command_queue->ExecuteCommandListsWithoutSignal(
+              absl::MakeSpan(pending_lists));
+          pending_lists.clear();
+        }
+      };
 
-    if (flush) {
-      DmlTracing::Instance().LogExecutionContextFlush();
-      // Record the commands into the command list.
-      command_list->Open(batch_completion_event);
       for (auto& command : batch) {
-        command(*command_list);
+        if (command.prerecorded) {
+          if (list_open) {
+            status = command_list->Close();
+            if (!status.ok()) {
+              break;
+            }
+            list_open = false;
+            pending_lists.push_back(command_list->Get());
+            submit_without_signal();
+          }
+          pending_lists.push_back(command.prerecorded.Get());
+        } else {
+          if (!list_open) {
+            submit_without_signal();
+            command_list->Open(batch_completion_event);
+            list_open = true;
+          }
+          command.record(*command_list);
+        }
+      }
+
+      if (status.ok() && list_open) {
+        status = command_list->Close();
+        if (status.ok()) {
+          pending_lists.push_back(command_list->Get());
+        }
       }
-      auto status = command_list->Close();
 
       if (!status.ok()) {
-        lock.lock();
+        std::lock_guard<std::mutex> lock(state->aux_mutex);
         state->status = status;
-        lock.unlock();
         break;
       }
 
-      ID3D12CommandList* command_lists[] = {command_list->Get()};
-      command_queue->ExecuteCommandLists(command_lists);
+      command_queue->ExecuteCommandLists(absl::MakeSpan(pending_lists));
 
-      batch.clear();
-      last_flush_time = std::chrono::steady_clock::now();
+      dml_metrics::RecordExecutionContextSubmit(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - submit_start)
+              .count());
+    } else {
+      // Catch-up flush: executing zero command lists still signals the fence,
+      // which is all that's needed to cover handed-out events.
+      command_queue->ExecuteCommandLists({});
     }
+
+    state->executed_count.fetch_add(batch.size(), std::memory_order_release);
+    batch.clear();
+    last_flush_time = std::chrono::steady_clock::now();
   }
 }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "dml_command_allocator_ring.h"
 #include "dml_command_list.h"
 #include "dml_command_queue.h"
+#include "dml_command_ring.h"
 #include "dml_common.h"
 #include "dml_descriptor_pool.h"
 #include "dml_status.h"
@@ -72,11 +73,22 @@ class DmlExecutionContext {
 
   // NOTE: the caller is responsible for keeping the op and descriptor_heap
   // alive until the returned GPU event has completed. This class takes
-  // ownership of the binding table.
+  // ownership of the binding table. op_name is only used to attribute GPU
+  // profiler timings; callers should leave it empty unless
+  // IsGpuProfilingActive() returns true.
   DmlGpuEvent ExecuteOperator(
       IDMLCompiledOperator* op,
       Microsoft::WRL::ComPtr<IDMLBindingTable>&& binding_table,
-      ID3D12DescriptorHeap* descriptor_heap);
+      ID3D12DescriptorHeap* descriptor_heap, std::string op_name = {});
+
+  // Returns true while a profiler session is capturing per-op GPU timings
+  // (see DmlGpuProfiler::StartStepCapture), in which case callers should
+  // supply node names to ExecuteOperator.
+  bool IsGpuProfilingActive() const;
+
+  // Returns the GPU timestamp profiler owned by the command list, or null if
+  // the queue doesn't support timestamp queries.
+  DmlGpuProfiler* GetGpuProfiler() const;
 
   // NOTE: A copy of the barriers span will be made, so the pointed-to value is
   // safe to release immediately after calling this method.
@@ -87,44 +99,151 @@ class DmlExecutionContext {
   // only includes a UAV barrier (elides an extra copy).
   DmlGpuEvent UavBarrier();
 
+  // Splices a pre-recorded command list into the command sequence, in order
+  // with respect to commands recorded through the methods above. This is used
+  // to replay once-recorded dispatches without paying per-step recording cost.
+  // NOTE: the caller is responsible for keeping the command list alive (and
+  // not resetting it) until the returned GPU event has completed.
+  DmlGpuEvent ExecutePrerecordedCommandList(
+      Microsoft::WRL::ComPtr<ID3D12CommandList> command_list);
+
+  // Makes the next batch of commands submitted to the GPU wait for the given
+  // event before executing. This is used to order work on this queue after
+  // work submitted to other queues (e.g. the dedicated copy queue).
+  void QueueDependency(DmlGpuEvent gpu_event);
+
   // Indicates that any batched commands should be recorded and executed as soon
   // as possible, even if the batch is small. This is a no-op if nothing is
   // batched.
   StatusOr<DmlGpuEvent> Flush();
 
+  // Brackets a run of ops being issued back-to-back by an executor thread
+  // (see Device::BeginOpRun). While any run is open, the execution thread
+  // defers its size- and time-based flushes so a run's commands aren't split
+  // across submissions mid-chain; the flush happens when the last open run
+  // ends. Explicit Flush() calls (e.g. from readbacks) are always honored,
+  // and a held flush is forced after flush_hold_limit_multiplier flush
+  // intervals as a backstop against a stalled run.
+  void BeginOpRun();
+  void EndOpRun();
+
   Status GetCommandRecorderStatus() const;
 
   DmlGpuEvent GetCurrentCompletionEvent();
 
+  // Returns an event which is signaled when the most recently flushed batch
+  // completes. Unlike GetCurrentCompletionEvent, this never refers to the
+  // still-open write batch, so it is always safe for other queues to wait on
+  // this event without risk of a cross-queue fence cycle.
+  DmlGpuEvent GetLastFlushedCompletionEvent();
+
   D3D12_COMMAND_LIST_TYPE GetCommandListTypeForQueue() const;
 
  private:
   static constexpr uint32_t default_batch_flush_size = 100;
   static constexpr uint32_t default_batch_flush_time_us = 1000;
+  static constexpr size_t command_ring_capacity = 2048;
+
+  // Upper bound on how long open op runs may defer a heuristic flush,
+  // expressed as a multiple of the flush time threshold.
+  static constexpr uint32_t flush_hold_limit_multiplier = 10;
+
+  // Controls when the execution thread flushes batched work. The thresholds
+  // start at their defaults and, unless pinned by an environment variable,
+  // adapt at runtime based on how many submissions the GPU has in flight:
+  // shrink when the GPU drains everything between flushes (starved), grow
+  // when submissions pile up (oversized batches add nothing but latency).
+  struct FlushHeuristics {
+    uint32_t flush_size = default_batch_flush_size;
+    uint32_t flush_time_us = default_batch_flush_time_us;
+
+    // When false, the corresponding threshold was set explicitly via
+    // TF_DIRECTML_BATCH_FLUSH_SIZE/TIME and is never adjusted.
+    bool adapt_size = true;
+    bool adapt_time = true;
+
+    // Feeds one post-flush sample of GPU progress (the number of submitted
+    // but not yet completed flushes) back into the thresholds.
+    void OnFlushSample(uint64_t flushes_in_flight);
+  };
 
-  using Command = std::function<void(DmlCommandList&)>;
+  // A batched command is either a function that records into the shared
+  // command list (the common case), or a pre-recorded command list that is
+  // spliced into the submission sequence as-is.
+  struct Command {
+    std::function<void(DmlCommandList&)> record;
+    Microsoft::WRL::ComPtr<ID3D12CommandList> prerecorded;
+  };
   using Batch = absl::InlinedVector<Command, default_batch_flush_size>;
 
-  // State related to the batching of commands, which may be accessed by
-  // both external threads (e.g. DML kernels) and the internal execution
-  // thread.
+  // State shared between external threads (e.g. DML kernels) recording
+  // commands and the internal execution thread. Commands flow through a
+  // lock-free MPSC ring, so recording threads never contend on a mutex; the
+  // wake_mutex below exists only to put the execution thread to sleep when
+  // the ring runs dry.
   struct BatchState {
-    std::mutex mutex;
-    DmlGpuEvent next_flush_event;
+    explicit BatchState(Microsoft::WRL::ComPtr<ID3D12Fence> fence)
+        : fence(std::move(fence)), command_ring(command_ring_capacity) {}
+
+    // The fence signaled by the command queue; used together with
+    // next_flush_fence_value to mint DmlGpuEvents without locking.
+    const Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+
+    DmlCommandRing<Command> command_ring;
+
+    // The fence value that the *next* flush will signal. Only the execution
+    // thread increments this (once per flush).
+    std::atomic<uint64_t> next_flush_fence_value{0};
+
+    // The largest fence value handed out to a caller as a completion event.
+    // The execution thread performs (possibly empty) catch-up flushes until
+    // this value is signaled, guaranteeing that every returned event
+    // eventually fires.
+    std::atomic<uint64_t> max_returned_fence_value{0};
+
+    // Monotonic counters used to tell whether any recorded work has not yet
+    // been submitted to the GPU. Producers bump enqueued_count; the execution
+    // thread publishes executed_count after each ExecuteCommandLists. Stale
+    // reads can only make work look *more* pending, never less, so callers
+    // always get a conservative answer.
+    std::atomic<uint64_t> enqueued_count{0};
+    std::atomic<uint64_t> executed_count{0};
+
+    std::atomic<bool> exit_requested{false};
+    std::atomic<bool> flush_requested{false};
+
+    // Number of op runs currently open (see BeginOpRun). While non-zero, the
+    // execution thread defers heuristic flushes.
+    std::atomic<int> open_op_runs{0};
+
+    // Wake/sleep handshake for the execution thread. `thread_sleeping` lets
+    // producers skip the mutex entirely while the execution thread is awake,
+    // which is the common case under load.
+    std::mutex wake_mutex;
     std::condition_variable command_added;
+    std::atomic<bool> thread_sleeping{false};
 
-    // Commands are double buffered: callers extend the "write batch" while the
-    // execution thread records and executes the "execute batch".
-    Batch batches[2];
-    uint32_t write_batch_index = 0;
-    Batch& WriteBatch() { return batches[write_batch_index]; }
+    // Rarely-accessed state, guarded by its own mutex so that it never
+    // contends with command recording.
+    std::mutex aux_mutex;
 
-    bool exit_requested = false;
-    bool flush_requested = false;
+    // GPU events which the next ExecuteCommandLists must wait on before
+    // executing. Drained by the execution thread at each flush. Guarded by
+    // aux_mutex.
+    absl::InlinedVector<DmlGpuEvent, 4> pending_waits;
 
-    Status status;
+    Status status;  // guarded by aux_mutex
   };
 
+  // Enqueues a command into the ring (yielding if it's momentarily full) and
+  // returns an event which is guaranteed to be signaled after the command
+  // completes on the GPU.
+  DmlGpuEvent AppendCommand(Command&& command);
+  DmlGpuEvent AppendCommand(std::function<void(DmlCommandList&)>&& record);
+
+  // Wakes the execution thread if it's sleeping.
+  static void WakeExecutionThread(BatchState* state);
+
   std::shared_ptr<BatchState> batch_state_;
   std::shared_ptr<DmlCommandQueue> dml_command_queue_;
   std::shared_ptr<DmlCommandList> dml_command_list_;
@@ -133,8 +252,7 @@ class DmlExecutionContext {
   static void ExecutionThreadProc(std::shared_ptr<BatchState> batch_state,
                                   std::shared_ptr<DmlCommandList> command_list,
                                   std::shared_ptr<DmlCommandQueue> command_queue,
-                                  uint32_t batch_flush_size,
-                                  uint32_t batch_flush_time_us);
+                                  FlushHeuristics heuristics);
 };
 
 }  // namespace tensorflow
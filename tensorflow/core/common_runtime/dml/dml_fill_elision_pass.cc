@@ -0,0 +1,171 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+// Ops that never read their inputs' element data: they only consume shape
+// and dtype metadata (or, for ZerosLike, overwrite the output wholesale
+// without looking at the input). A fill feeding only such consumers is dead
+// as far as its contents go.
+bool ConsumerIgnoresContents(const Node* n) {
+  const string& op = n->type_string();
+  return op == "Shape" || op == "ShapeN" || op == "Size" || op == "Rank" ||
+         op == "ZerosLike";
+}
+
+// Returns true if no consumer of `n` ever reads the bytes `n` produces.
+bool ContentsNeverRead(const Node* n) {
+  for (const Edge* e : n->out_edges()) {
+    if (!e->IsControlEdge() && !ConsumerIgnoresContents(e->dst())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Replaces a Fill whose contents are never read with an uninitialized Empty
+// of the same shape and dtype.
+Status ReplaceFillWithEmpty(Graph* g, Node* fill) {
+  DataType dtype;
+  TF_RETURN_IF_ERROR(GetNodeAttr(fill->attrs(), "T", &dtype));
+
+  const Edge* dims_edge;
+  TF_RETURN_IF_ERROR(fill->input_edge(0, &dims_edge));
+
+  NodeDebugInfo debug_info(*fill);
+  NodeBuilder builder(g->NewName(strings::StrCat(fill->name(), "/dml_empty")),
+                      "Empty", OpRegistry::Global(), &debug_info);
+
+  Node* empty = nullptr;
+  TF_RETURN_IF_ERROR(
+      builder.Device(fill->requested_device())
+          .Input(NodeBuilder::NodeOut(dims_edge->src(), dims_edge->src_output()))
+          .Attr("dtype", dtype)
+          .Attr("init", false)
+          .Finalize(g, &empty));
+  empty->set_assigned_device_name(fill->assigned_device_name());
+
+  for (const Edge* e : fill->in_edges()) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(e->src(), empty);
+    }
+  }
+  std::vector<const Edge*> out_edges(fill->out_edges().begin(),
+                                     fill->out_edges().end());
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(empty, e->dst());
+    } else {
+      g->AddEdge(empty, 0, e->dst(), e->dst_input());
+    }
+  }
+
+  g->RemoveNode(fill);
+  return Status::OK();
+}
+
+// Elides fill dispatches whose contents are provably never read. TF's
+// dataflow model means every data consumer reads its input, so the statically
+// provable cases are fills feeding only shape-metadata consumers (or nothing
+// but control edges): an Empty with init=true loses the init, and a Fill
+// becomes an uninitialized Empty. Clears that are redundant only because the
+// backing memory is freshly zeroed are elided at runtime instead, via
+// DmlAllocator::ConsumeZeroInitializedState.
+class DmlFillElisionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool elision_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_FILL_ELISION",
+                                          /*default_val=*/true,
+                                          &elision_enabled));
+    if (!elision_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather first, then rewrite, so iteration never walks deleted nodes.
+    std::vector<Node*> elidable_empties;
+    std::vector<Node*> elidable_fills;
+    for (Node* n : g->op_nodes()) {
+      if (!IsDmlDevice(n) || !ContentsNeverRead(n)) {
+        continue;
+      }
+
+      if (n->type_string() == "Empty") {
+        bool init;
+        if (TryGetNodeAttr(n->attrs(), "init", &init) && init) {
+          elidable_empties.push_back(n);
+        }
+      } else if (n->type_string() == "Fill") {
+        // The replacement Empty kernel takes an int32 shape and is only
+        // registered for a subset of Fill's types on DML.
+        DataType dtype, index_type;
+        if (TryGetNodeAttr(n->attrs(), "T", &dtype) &&
+            TryGetNodeAttr(n->attrs(), "index_type", &index_type) &&
+            index_type == DT_INT32 &&
+            (dtype == DT_FLOAT || dtype == DT_HALF || dtype == DT_INT64)) {
+          elidable_fills.push_back(n);
+        }
+      }
+    }
+
+    for (Node* n : elidable_empties) {
+      VLOG(1) << "DmlFillElisionPass: eliding init of Empty node '"
+              << n->name() << "'";
+      n->ClearAttr("init");
+      n->AddAttr("init", false);
+    }
+
+    for (Node* n : elidable_fills) {
+      VLOG(1) << "DmlFillElisionPass: replacing unread Fill node '"
+              << n->name() << "' with an uninitialized Empty";
+      TF_RETURN_IF_ERROR(ReplaceFillWithEmpty(g, n));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement so device assignments are known.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 28,
+                      DmlFillElisionPass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,111 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_fused_elementwise.h"
+
+#include <unordered_set>
+
+namespace tensorflow {
+
+int DmlFusedElementwiseArity(const string& op_name) {
+  static const auto* kBinaryOps = new std::unordered_set<string>({
+      "Add",
+      "AddV2",
+      "Sub",
+      "Mul",
+      "RealDiv",
+      "FloorDiv",
+      "Maximum",
+      "Minimum",
+      "Pow",
+      "SquaredDifference",
+  });
+
+  static const auto* kUnaryOps = new std::unordered_set<string>({
+      "Abs",
+      "Ceil",
+      "Cos",
+      "Elu",
+      "Erf",
+      "Exp",
+      "Floor",
+      "Log",
+      "Neg",
+      "Reciprocal",
+      "Relu",
+      "Relu6",
+      "Rsqrt",
+      "Sigmoid",
+      "Sign",
+      "Sin",
+      "Softplus",
+      "Sqrt",
+      "Square",
+      "Tanh",
+  });
+
+  if (kBinaryOps->count(op_name)) {
+    return 2;
+  }
+  if (kUnaryOps->count(op_name)) {
+    return 1;
+  }
+  return 0;
+}
+
+dml::Expression DmlComposeFusedElementwise(const string& op_name,
+                                           dml::Expression lhs,
+                                           const dml::Expression* rhs) {
+  assert((DmlFusedElementwiseArity(op_name) == 2) == (rhs != nullptr));
+
+  // Binary ops. The expressions match the standalone DML kernels registered
+  // in dml_cwise_ops.cc; the fused chain must compute exactly what the
+  // unfused graph would have.
+  if (op_name == "Add" || op_name == "AddV2") return lhs + *rhs;
+  if (op_name == "Sub") return lhs - *rhs;
+  if (op_name == "Mul") return lhs * *rhs;
+  if (op_name == "RealDiv") return lhs / *rhs;
+  if (op_name == "FloorDiv") return dml::Floor(lhs / *rhs);
+  if (op_name == "Maximum") return dml::Max(lhs, *rhs);
+  if (op_name == "Minimum") return dml::Min(lhs, *rhs);
+  if (op_name == "Pow") return dml::Pow(lhs, *rhs);
+  if (op_name == "SquaredDifference") return dml::DifferenceSquare(lhs, *rhs);
+
+  // Unary ops
+  if (op_name == "Abs") return dml::Abs(lhs);
+  if (op_name == "Ceil") return dml::Ceil(lhs);
+  if (op_name == "Cos") return dml::Cos(lhs);
+  if (op_name == "Elu") return dml::ActivationElu(lhs);
+  if (op_name == "Erf") return dml::Erf(lhs);
+  if (op_name == "Exp") return dml::Exp(lhs);
+  if (op_name == "Floor") return dml::Floor(lhs);
+  if (op_name == "Log") return dml::Log(lhs);
+  if (op_name == "Neg") return -lhs;
+  if (op_name == "Reciprocal") return dml::Recip(lhs);
+  if (op_name == "Relu") return dml::ActivationRelu(lhs);
+  if (op_name == "Relu6") return dml::Clip(lhs, 0, 6);
+  if (op_name == "Rsqrt") return 1.0f / dml::Sqrt(lhs);
+  if (op_name == "Sigmoid") return dml::ActivationSigmoid(lhs);
+  if (op_name == "Sign") return dml::Sign(lhs);
+  if (op_name == "Sin") return dml::Sin(lhs);
+  if (op_name == "Softplus") return dml::ActivationSoftplus(lhs);
+  if (op_name == "Sqrt") return dml::Sqrt(lhs);
+  if (op_name == "Square") return lhs * lhs;
+  if (op_name == "Tanh") return dml::ActivationTanh(lhs);
+
+  LOG(FATAL) << "Unsupported fused elementwise op '" << op_name << "'";
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,37 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include "tensorflow/core/common_runtime/dml/dml_common.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Shared definition of the elementwise ops which DmlElementwiseFusionPass may
+// fuse into a _DmlFusedElementwise node, used by both the fusion pass and the
+// kernel which executes the fused chain.
+
+// Returns the number of inputs the given TF op type consumes when fused (1 for
+// unary ops, 2 for binary ops), or 0 if the op type is not fusible.
+int DmlFusedElementwiseArity(const string& op_name);
+
+// Appends the DirectMLX expression for the given fused op to a graph being
+// built. `rhs` must be non-null iff the op is binary.
+dml::Expression DmlComposeFusedElementwise(const string& op_name,
+                                           dml::Expression lhs,
+                                           const dml::Expression* rhs);
+
+}  // namespace tensorflow
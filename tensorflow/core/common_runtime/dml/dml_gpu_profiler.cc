@@ -0,0 +1,327 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_gpu_profiler.h"
+
+#include <algorithm>
+
+#include "dml_tracing.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+/*static*/ std::unique_ptr<DmlGpuProfiler> DmlGpuProfiler::MaybeCreate(
+    ID3D12Device* device, ID3D12CommandQueue* queue) {
+  string trace_path;
+  Status s = ReadStringFromEnvVar("TF_DIRECTML_GPU_TRACE_PATH", "",
+                                  &trace_path);
+  if (!s.ok()) {
+    trace_path.clear();
+  }
+
+  uint64_t timestamp_frequency = 0;
+  if (FAILED(queue->GetTimestampFrequency(&timestamp_frequency)) ||
+      timestamp_frequency == 0) {
+    if (!trace_path.empty()) {
+      LOG(WARNING) << "DML GPU profiler disabled: the command queue does not "
+                      "support timestamp queries.";
+    }
+    return nullptr;
+  }
+
+  int64 sample_rate = 1;
+  s = ReadInt64FromEnvVar("TF_DIRECTML_GPU_TRACE_SAMPLE_RATE", 1, &sample_rate);
+  if (!s.ok() || sample_rate < 1) {
+    sample_rate = 1;
+  }
+
+  if (!trace_path.empty()) {
+    LOG(INFO) << "DML GPU profiler enabled; trace will be written to "
+              << trace_path << " (sampling 1 in " << sample_rate
+              << " flushes)";
+  }
+
+  return std::unique_ptr<DmlGpuProfiler>(
+      new DmlGpuProfiler(device, timestamp_frequency, std::move(trace_path),
+                         static_cast<uint32_t>(sample_rate)));
+}
+
+DmlGpuProfiler::DmlGpuProfiler(ID3D12Device* device,
+                               uint64_t timestamp_frequency,
+                               std::string trace_path, uint32_t sample_rate)
+    : device_(device),
+      timestamp_frequency_(timestamp_frequency),
+      trace_path_(std::move(trace_path)),
+      sample_rate_(sample_rate) {}
+
+DmlGpuProfiler::~DmlGpuProfiler() {
+  // Collect whatever has finished on the GPU; flushes still in flight at
+  // teardown are dropped rather than waited on.
+  std::lock_guard<std::mutex> lock(collect_mu_);
+  CollectCompletedFlushes();
+
+  if (trace_path_.empty() || trace_events_.empty()) {
+    return;
+  }
+
+  // Chrome trace event format, "complete" (ph:X) events. Durations are in
+  // microseconds on the GPU timeline, relative to the first sampled dispatch.
+  string json = "{\"traceEvents\":[\n";
+  for (size_t i = 0; i < trace_events_.size(); ++i) {
+    const TraceEvent& event = trace_events_[i];
+    strings::StrAppend(
+        &json, "{\"name\":\"", event.name,
+        "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":", event.start_us,
+        ",\"dur\":", event.duration_us, "}", i + 1 < trace_events_.size() ? ",\n" : "\n");
+  }
+  strings::StrAppend(&json, "]}\n");
+
+  Status s = WriteStringToFile(Env::Default(), trace_path_, json);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write DML GPU trace to " << trace_path_ << ": "
+                 << s;
+    return;
+  }
+
+  // Also log a per-op-type summary so the dominant kernels are visible
+  // without opening the trace.
+  std::vector<std::pair<string, std::pair<uint64_t, uint64_t>>> sorted(
+      aggregates_.begin(), aggregates_.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.second.first > b.second.first;
+  });
+
+  LOG(INFO) << "DML GPU trace written to " << trace_path_;
+  for (const auto& entry : sorted) {
+    LOG(INFO) << "  " << entry.first << ": "
+              << TicksToUs(entry.second.first) << "us over "
+              << entry.second.second << " dispatches";
+  }
+}
+
+bool DmlGpuProfiler::TryAcquireBlock(QueryBlock* block) {
+  if (!free_blocks_.empty()) {
+    *block = std::move(free_blocks_.back());
+    free_blocks_.pop_back();
+    return true;
+  }
+
+  if (blocks_created_ >= kMaxBlocks) {
+    return false;
+  }
+
+  D3D12_QUERY_HEAP_DESC heap_desc = {};
+  heap_desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+  heap_desc.Count = kQueriesPerBlock;
+
+  QueryBlock new_block;
+  DML_CHECK_SUCCEEDED(device_->CreateQueryHeap(
+      &heap_desc, IID_PPV_ARGS(&new_block.query_heap)));
+
+  D3D12_HEAP_PROPERTIES readback_props =
+      CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+  D3D12_RESOURCE_DESC buffer_desc =
+      CD3DX12_RESOURCE_DESC::Buffer(kQueriesPerBlock * sizeof(uint64_t));
+  DML_CHECK_SUCCEEDED(device_->CreateCommittedResource(
+      &readback_props, D3D12_HEAP_FLAG_NONE, &buffer_desc,
+      D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+      IID_PPV_ARGS(&new_block.readback_buffer)));
+
+  ++blocks_created_;
+  *block = std::move(new_block);
+  return true;
+}
+
+void DmlGpuProfiler::BeginFlush(DmlGpuEvent completion_event) {
+  std::lock_guard<std::mutex> lock(collect_mu_);
+  CollectCompletedFlushes();
+
+  ++flush_count_;
+  current_flush_sampled_ = false;
+  current_op_count_ = 0;
+  op_open_ = false;
+
+  // The environment traces (the GPU-only trace and the unified chrome trace)
+  // sample 1 in N flushes; an active step capture samples every flush so no
+  // node is missing from the step stats.
+  bool env_trace_sampled =
+      (!trace_path_.empty() || DmlTracing::Instance().IsChromeTraceEnabled()) &&
+      (flush_count_ % sample_rate_ == 0);
+  if (!env_trace_sampled && !IsStepCaptureActive()) {
+    return;
+  }
+
+  if (!TryAcquireBlock(&current_flush_.block)) {
+    // All blocks are tied up in flushes the GPU hasn't finished; skip this
+    // sample rather than grow without bound.
+    return;
+  }
+
+  current_flush_.completion_event = std::move(completion_event);
+  current_flush_.op_names.clear();
+  current_flush_sampled_ = true;
+}
+
+void DmlGpuProfiler::BeginOp(ID3D12GraphicsCommandList* command_list,
+                             IDMLCompiledOperator* op,
+                             const std::string& op_name) {
+  if (!current_flush_sampled_ || current_op_count_ >= kMaxOpsPerFlush) {
+    return;
+  }
+
+  if (!op_name.empty()) {
+    current_flush_.op_names.push_back(op_name);
+  } else {
+    // Fall back to the op type stored on the compiled operator as private
+    // data (the same mechanism the PIX events use). Compiled operators are
+    // shared across nodes, so this is a type, not a node name.
+    char name[100] = "DmlOperator";
+    UINT data_size = sizeof(name) - 1;
+    op->GetPrivateData(DmlTracing::kPixEventNameId, &data_size, name);
+    name[sizeof(name) - 1] = '\0';
+    current_flush_.op_names.emplace_back(name);
+  }
+
+  command_list->EndQuery(current_flush_.block.query_heap.Get(),
+                         D3D12_QUERY_TYPE_TIMESTAMP, current_op_count_ * 2);
+  op_open_ = true;
+}
+
+void DmlGpuProfiler::EndOp(ID3D12GraphicsCommandList* command_list) {
+  if (!op_open_) {
+    return;
+  }
+
+  command_list->EndQuery(current_flush_.block.query_heap.Get(),
+                         D3D12_QUERY_TYPE_TIMESTAMP,
+                         current_op_count_ * 2 + 1);
+  ++current_op_count_;
+  op_open_ = false;
+}
+
+void DmlGpuProfiler::EndFlush(ID3D12GraphicsCommandList* command_list) {
+  if (!current_flush_sampled_) {
+    return;
+  }
+
+  current_flush_sampled_ = false;
+
+  std::lock_guard<std::mutex> lock(collect_mu_);
+
+  if (current_op_count_ == 0) {
+    // Nothing was measured; return the block straight to the pool.
+    free_blocks_.push_back(std::move(current_flush_.block));
+    return;
+  }
+
+  command_list->ResolveQueryData(current_flush_.block.query_heap.Get(),
+                                 D3D12_QUERY_TYPE_TIMESTAMP, 0,
+                                 current_op_count_ * 2,
+                                 current_flush_.block.readback_buffer.Get(), 0);
+
+  current_flush_.submit_walltime_us =
+      static_cast<double>(Env::Default()->NowMicros());
+  pending_flushes_.push_back(std::move(current_flush_));
+  current_flush_ = PendingFlush{};
+}
+
+void DmlGpuProfiler::StartStepCapture() {
+  std::lock_guard<std::mutex> lock(collect_mu_);
+  // Drain flushes that completed before the capture so their events go to the
+  // environment trace only, not the new capture.
+  CollectCompletedFlushes();
+  capture_events_.clear();
+  capture_active_.store(true, std::memory_order_release);
+}
+
+std::vector<DmlGpuProfiler::CaptureEvent> DmlGpuProfiler::StopStepCapture() {
+  std::lock_guard<std::mutex> lock(collect_mu_);
+  // The caller has already synced the GPU, so every sampled flush's fence has
+  // signaled and this drains all of them.
+  CollectCompletedFlushes();
+  capture_active_.store(false, std::memory_order_release);
+  return std::move(capture_events_);
+}
+
+void DmlGpuProfiler::CollectCompletedFlushes() {
+  while (!pending_flushes_.empty() &&
+         pending_flushes_.front().completion_event.IsSignaled()) {
+    PendingFlush& flush = pending_flushes_.front();
+
+    void* mapped = nullptr;
+    D3D12_RANGE read_range = {0, flush.op_names.size() * 2 * sizeof(uint64_t)};
+    DML_CHECK_SUCCEEDED(
+        flush.block.readback_buffer->Map(0, &read_range, &mapped));
+    const uint64_t* timestamps = static_cast<const uint64_t*>(mapped);
+
+    // First valid timestamp of this flush; anchors the flush's spans at its
+    // submission walltime on the unified chrome trace (see DmlTracing).
+    uint64_t flush_first_ticks = 0;
+
+    for (size_t i = 0; i < flush.op_names.size(); ++i) {
+      uint64_t begin_ticks = timestamps[i * 2];
+      uint64_t end_ticks = timestamps[i * 2 + 1];
+      if (end_ticks < begin_ticks) {
+        continue;  // Timestamps can be unreliable across power state changes
+      }
+
+      if (epoch_ticks_ == 0) {
+        epoch_ticks_ = begin_ticks;
+      }
+      if (flush_first_ticks == 0) {
+        flush_first_ticks = begin_ticks;
+      }
+
+      auto& aggregate = aggregates_[flush.op_names[i]];
+      aggregate.first += end_ticks - begin_ticks;
+      ++aggregate.second;
+
+      if (!trace_path_.empty()) {
+        trace_events_.push_back(
+            TraceEvent{flush.op_names[i],
+                       TicksToUs(begin_ticks - epoch_ticks_),
+                       TicksToUs(end_ticks - begin_ticks)});
+      }
+
+      if (capture_active_.load(std::memory_order_relaxed)) {
+        capture_events_.push_back(CaptureEvent{
+            flush.op_names[i], begin_ticks, end_ticks - begin_ticks});
+      }
+
+      if (DmlTracing::Instance().IsChromeTraceEnabled()) {
+        DmlTracing::Instance().LogGpuOperator(
+            flush.op_names[i],
+            flush.submit_walltime_us +
+                TicksToUs(begin_ticks - flush_first_ticks),
+            TicksToUs(end_ticks - begin_ticks));
+      }
+    }
+
+    D3D12_RANGE empty_range = {0, 0};
+    flush.block.readback_buffer->Unmap(0, &empty_range);
+
+    free_blocks_.push_back(std::move(flush.block));
+    pending_flushes_.pop_front();
+  }
+}
+
+double DmlGpuProfiler::TicksToUs(uint64_t ticks) const {
+  return static_cast<double>(ticks) * 1e6 /
+         static_cast<double>(timestamp_frequency_);
+}
+
+}  // namespace tensorflow
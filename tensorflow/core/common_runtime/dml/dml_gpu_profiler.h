@@ -0,0 +1,177 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "absl/container/flat_hash_map.h"
+#include "dml_common.h"
+#include "dml_gpu_event.h"
+
+namespace tensorflow {
+
+// Measures actual GPU execution time of DML operators using timestamp
+// queries. Each sampled flush brackets every ExecuteOperator with a pair of
+// timestamps, resolved into a readback buffer and collected asynchronously
+// once the flush's fence is signaled, so profiling never stalls the GPU or
+// the execution thread. Durations are attributed per op type (via the name
+// stored on the compiled operator) and written out as a Chrome trace
+// (chrome://tracing / Perfetto) when the device is torn down.
+//
+// There are two consumers of the measured timings:
+//   1. The Chrome trace, enabled by setting TF_DIRECTML_GPU_TRACE_PATH to the
+//      output file path. TF_DIRECTML_GPU_TRACE_SAMPLE_RATE=N samples one in N
+//      flushes (default 1), which makes the overhead small enough to leave on
+//      in production.
+//   2. Step captures (Start/StopStepCapture), used by the profiler session to
+//      report per-node GPU timings in RunMetadata step stats when a session
+//      run requests a hardware trace. Every flush is sampled while a capture
+//      is active.
+//
+// The recording methods (BeginFlush/BeginOp/EndOp/EndFlush) and the
+// destructor must only be called from the execution thread that owns the
+// command list; the step capture methods may be called from any thread.
+class DmlGpuProfiler {
+ public:
+  // Returns null if the queue doesn't support timestamp queries. The profiler
+  // is otherwise always created so step captures can be requested at runtime;
+  // until a capture or the environment trace is active it records nothing and
+  // allocates no query heaps.
+  static std::unique_ptr<DmlGpuProfiler> MaybeCreate(ID3D12Device* device,
+                                                     ID3D12CommandQueue* queue);
+
+  ~DmlGpuProfiler();
+
+  // Called when a command list is opened for a new flush. Also opportunistically
+  // collects results from earlier flushes whose fences have signaled.
+  void BeginFlush(DmlGpuEvent completion_event);
+
+  // Brackets one operator dispatch with timestamp queries. No-ops if the
+  // current flush isn't sampled or the query block is exhausted. If op_name is
+  // non-empty it is used to attribute the timings; otherwise the op type
+  // stored on the compiled operator is used.
+  void BeginOp(ID3D12GraphicsCommandList* command_list,
+               IDMLCompiledOperator* op, const std::string& op_name);
+  void EndOp(ID3D12GraphicsCommandList* command_list);
+
+  // Called before the command list is closed; resolves the flush's queries
+  // into its readback buffer.
+  void EndFlush(ID3D12GraphicsCommandList* command_list);
+
+  // One measured dispatch, in raw GPU ticks (see timestamp_frequency()).
+  struct CaptureEvent {
+    std::string name;
+    uint64_t start_ticks;
+    uint64_t duration_ticks;
+  };
+
+  // Begins/ends collection of per-dispatch timings on behalf of a profiler
+  // session. The caller must flush the execution context and wait for the
+  // GPU to finish before calling StopStepCapture, else in-flight dispatches
+  // are dropped from the capture.
+  void StartStepCapture();
+  std::vector<CaptureEvent> StopStepCapture();
+
+  bool IsStepCaptureActive() const {
+    return capture_active_.load(std::memory_order_acquire);
+  }
+
+  uint64_t timestamp_frequency() const { return timestamp_frequency_; }
+
+ private:
+  // Two timestamps per op; 128 ops per sampled flush. Ops beyond that are
+  // simply not measured.
+  static constexpr uint32_t kMaxOpsPerFlush = 128;
+  static constexpr uint32_t kQueriesPerBlock = kMaxOpsPerFlush * 2;
+
+  // Upper bound on sampled flushes in flight; bounds profiler memory.
+  static constexpr uint32_t kMaxBlocks = 8;
+
+  // A query heap and matching readback buffer dedicated to one in-flight
+  // sampled flush.
+  struct QueryBlock {
+    Microsoft::WRL::ComPtr<ID3D12QueryHeap> query_heap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> readback_buffer;
+  };
+
+  struct PendingFlush {
+    QueryBlock block;
+    DmlGpuEvent completion_event;
+    std::vector<std::string> op_names;  // one per timestamp pair
+
+    // Walltime at which the flush's command list was submitted; anchors the
+    // flush's GPU spans on the chrome trace's walltime axis.
+    double submit_walltime_us = 0;
+  };
+
+  DmlGpuProfiler(ID3D12Device* device, uint64_t timestamp_frequency,
+                 std::string trace_path, uint32_t sample_rate);
+
+  // Acquires a query block from the pool, creating one if under the cap.
+  // collect_mu_ must be held.
+  bool TryAcquireBlock(QueryBlock* block);
+
+  // Reads back timestamps from flushes whose fences have signaled and feeds
+  // them into the aggregates, the trace, and the active step capture (if
+  // any). collect_mu_ must be held.
+  void CollectCompletedFlushes();
+
+  double TicksToUs(uint64_t ticks) const;
+
+  Microsoft::WRL::ComPtr<ID3D12Device> device_;
+  const uint64_t timestamp_frequency_;  // ticks per second
+  const std::string trace_path_;
+  const uint32_t sample_rate_;
+
+  // Guards the completed-flush state shared between the execution thread and
+  // step capture callers: the block pool, the pending flush queue, and the
+  // collected results below. The per-dispatch recording state is untouched
+  // by capture callers and needs no lock.
+  std::mutex collect_mu_;
+
+  std::vector<QueryBlock> free_blocks_;
+  uint32_t blocks_created_ = 0;
+
+  std::deque<PendingFlush> pending_flushes_;
+
+  uint64_t flush_count_ = 0;
+  bool current_flush_sampled_ = false;
+  PendingFlush current_flush_;
+  uint32_t current_op_count_ = 0;
+  bool op_open_ = false;
+
+  // First timestamp ever observed; used as the trace epoch.
+  uint64_t epoch_ticks_ = 0;
+
+  // Completed trace events, in Chrome trace "complete" event form.
+  struct TraceEvent {
+    std::string name;
+    double start_us;
+    double duration_us;
+  };
+  std::vector<TraceEvent> trace_events_;
+
+  // Aggregate GPU time per op type: {total ticks, dispatch count}.
+  absl::flat_hash_map<std::string, std::pair<uint64_t, uint64_t>> aggregates_;
+
+  // Step capture state (see StartStepCapture).
+  std::atomic<bool> capture_active_{false};
+  std::vector<CaptureEvent> capture_events_;
+};
+
+}  // namespace tensorflow
@@ -0,0 +1,256 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Largest number of MatMuls collapsed into one _DmlGroupedMatMul node. Each
+// member contributes three buffer bindings (a, b, product), so this bounds
+// the compiled graph's binding table.
+constexpr int kMaxGroupSize = 32;
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+bool IsGroupableMatMul(const Node* n) {
+  if (n->type_string() != "MatMul" || !IsDmlDevice(n)) {
+    return false;
+  }
+  DataType dtype;
+  return TryGetNodeAttr(n->attrs(), "T", &dtype) &&
+         (dtype == DT_FLOAT || dtype == DT_HALF);
+}
+
+// A group of MatMul nodes eligible to collapse into one grouped node: same
+// device and same dtype. Shapes may differ freely; each member keeps its own
+// GEMM inside the compiled graph.
+struct GroupKey {
+  string device;
+  DataType dtype;
+
+  bool operator<(const GroupKey& other) const {
+    return std::tie(device, dtype) < std::tie(other.device, other.dtype);
+  }
+};
+
+Status MakeGroupKey(const Node* n, GroupKey* key) {
+  key->device = n->assigned_device_name().empty() ? n->requested_device()
+                                                  : n->assigned_device_name();
+  TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "T", &key->dtype));
+  return Status::OK();
+}
+
+// Excludes every candidate that is reachable from another candidate. Two
+// matmuls with any path between them (the second consumes a function of the
+// first's product) would become a self-cycle once both collapse into the
+// same node. One forward traversal seeded at all candidates' out edges finds
+// exactly the candidates that depend on an earlier one; dropping those
+// leaves a pairwise-independent set.
+void ExcludeDependentCandidates(const Graph* g,
+                                std::unordered_set<Node*>* candidates) {
+  std::vector<bool> visited(g->num_node_ids(), false);
+  std::deque<const Node*> queue;
+
+  for (const Node* n : *candidates) {
+    for (const Edge* e : n->out_edges()) {
+      if (!visited[e->dst()->id()]) {
+        visited[e->dst()->id()] = true;
+        queue.push_back(e->dst());
+      }
+    }
+  }
+
+  std::vector<Node*> reached;
+  while (!queue.empty()) {
+    const Node* n = queue.front();
+    queue.pop_front();
+
+    auto it = candidates->find(const_cast<Node*>(n));
+    if (it != candidates->end()) {
+      reached.push_back(*it);
+    }
+
+    for (const Edge* e : n->out_edges()) {
+      if (!visited[e->dst()->id()]) {
+        visited[e->dst()->id()] = true;
+        queue.push_back(e->dst());
+      }
+    }
+  }
+
+  for (Node* n : reached) {
+    candidates->erase(n);
+  }
+}
+
+Status ReplaceGroup(Graph* g, const std::vector<Node*>& group) {
+  Node* first = group.front();
+
+  DataType dtype;
+  TF_RETURN_IF_ERROR(GetNodeAttr(first->attrs(), "T", &dtype));
+
+  std::vector<NodeBuilder::NodeOut> a_inputs, b_inputs;
+  std::vector<bool> transpose_a, transpose_b;
+  for (Node* n : group) {
+    const Edge* e;
+    TF_RETURN_IF_ERROR(n->input_edge(0, &e));
+    a_inputs.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+    TF_RETURN_IF_ERROR(n->input_edge(1, &e));
+    b_inputs.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+
+    bool transpose;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "transpose_a", &transpose));
+    transpose_a.push_back(transpose);
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "transpose_b", &transpose));
+    transpose_b.push_back(transpose);
+  }
+
+  NodeDebugInfo debug_info(*first);
+  NodeBuilder builder(
+      g->NewName(strings::StrCat(first->name(), "/dml_grouped_matmul")),
+      "_DmlGroupedMatMul", OpRegistry::Global(), &debug_info);
+
+  Node* fused = nullptr;
+  TF_RETURN_IF_ERROR(builder.Device(first->requested_device())
+                         .Input(a_inputs)
+                         .Input(b_inputs)
+                         .Attr("T", dtype)
+                         .Attr("N", static_cast<int64>(group.size()))
+                         .Attr("transpose_a", transpose_a)
+                         .Attr("transpose_b", transpose_b)
+                         .Finalize(g, &fused));
+  fused->set_assigned_device_name(first->assigned_device_name());
+
+  // Member i's product becomes the fused node's output i; its consumers and
+  // control relationships move over.
+  for (int i = 0; i < static_cast<int>(group.size()); ++i) {
+    Node* n = group[i];
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+    std::vector<const Edge*> out_edges(n->out_edges().begin(),
+                                       n->out_edges().end());
+    for (const Edge* e : out_edges) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(fused, e->dst());
+      } else {
+        g->AddEdge(fused, i, e->dst(), e->dst_input());
+      }
+      g->RemoveEdge(e);
+    }
+    g->RemoveNode(n);
+  }
+
+  return Status::OK();
+}
+
+// Collapses groups of independent MatMul nodes placed on DML devices into
+// _DmlGroupedMatMul nodes. Mixture-of-experts and per-head projection layers
+// issue dozens of small independent GEMMs, each paying full dispatch cost
+// for little math; grouped, each set runs as one compiled DML graph in a
+// single dispatch.
+class DmlGroupedMatMulPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool grouping_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_GROUPED_MATMUL",
+                                          /*default_val=*/true,
+                                          &grouping_enabled));
+    if (!grouping_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    std::unordered_set<Node*> candidates;
+    for (Node* n : g->op_nodes()) {
+      if (IsGroupableMatMul(n)) {
+        candidates.insert(n);
+      }
+    }
+    if (candidates.size() < 2) {
+      return Status::OK();
+    }
+
+    ExcludeDependentCandidates(g, &candidates);
+
+    std::map<GroupKey, std::vector<Node*>> groups;
+    for (Node* n : candidates) {
+      GroupKey key;
+      TF_RETURN_IF_ERROR(MakeGroupKey(n, &key));
+      groups[key].push_back(n);
+    }
+
+    for (auto& kvp : groups) {
+      std::vector<Node*>& members = kvp.second;
+      if (members.size() < 2) {
+        continue;
+      }
+
+      // Deterministic grouping regardless of hash-set iteration order.
+      std::sort(members.begin(), members.end(),
+                [](const Node* a, const Node* b) { return a->id() < b->id(); });
+
+      for (size_t start = 0; start < members.size(); start += kMaxGroupSize) {
+        size_t count = std::min<size_t>(kMaxGroupSize, members.size() - start);
+        if (count < 2) {
+          break;  // A trailing singleton stays as a plain MatMul.
+        }
+        std::vector<Node*> group(members.begin() + start,
+                                 members.begin() + start + count);
+        VLOG(1) << "DmlGroupedMatMulPass: grouping " << group.size()
+                << " MatMul nodes rooted at '" << group.front()->name() << "'";
+        TF_RETURN_IF_ERROR(ReplaceGroup(g, group));
+      }
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement (device assignments must be known), and after the
+// attention and cluster/elementwise fusion passes so grouping only sees the
+// matmuls those passes left behind.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 26,
+                      DmlGroupedMatMulPass);
+
+}  // namespace
+}  // namespace tensorflow
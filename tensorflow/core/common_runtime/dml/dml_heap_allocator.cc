@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "dml_util.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -29,13 +31,52 @@ D3D12HeapAllocator::D3D12HeapAllocator(ID3D12Device* device,
       heap_properties_(heap_props),
       heap_flags_(heap_flags),
       resource_flags_(resource_flags),
-      initial_state_(initial_state) {}
+      initial_state_(initial_state) {
+  Status s = ReadBoolFromEnvVar("TF_DIRECTML_HEAP_SUBALLOCATION",
+                                /*default_val=*/true, &suballocation_enabled_);
+  if (!s.ok()) {
+    suballocation_enabled_ = true;
+  }
+
+  // Custom heaps that name a CPU page property are mappable; the DEFAULT,
+  // UPLOAD and READBACK heap types leave it UNKNOWN.
+  cpu_visible_ =
+      heap_properties_.Type == D3D12_HEAP_TYPE_CUSTOM &&
+      heap_properties_.CPUPageProperty != D3D12_CPU_PAGE_PROPERTY_UNKNOWN &&
+      heap_properties_.CPUPageProperty != D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE;
+
+  // EnqueueMakeResident requires ID3D12Device3 (Windows 10 1709+); when it
+  // isn't available we fall back to blocking MakeResident on eviction reuse.
+  bool async_residency;
+  s = ReadBoolFromEnvVar("TF_DIRECTML_ASYNC_RESIDENCY",
+                         /*default_val=*/true, &async_residency);
+  if (!s.ok()) {
+    async_residency = true;
+  }
+
+  if (async_residency &&
+      SUCCEEDED(device_->QueryInterface(IID_PPV_ARGS(&device3_)))) {
+    if (FAILED(device_->CreateFence(0, D3D12_FENCE_FLAG_NONE,
+                                    IID_PPV_ARGS(&residency_fence_)))) {
+      device3_ = nullptr;
+    }
+  }
+}
 
 void* D3D12HeapAllocator::Alloc(uint64_t size_in_bytes) {
   if (size_in_bytes == 0) {
     return nullptr;
   }
 
+  if (suballocation_enabled_ && size_in_bytes <= kMaxSubAllocationSizeInBytes) {
+    void* ptr = SubAllocate(size_in_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+    // A block heap couldn't be created (e.g. not even 64MB of contiguous
+    // memory left); fall through and try a dedicated heap of the exact size.
+  }
+
   // The heap properties and flags are constant, and the D3D12 device is
   // thread-safe so we don't need to hold the lock over the call to CreateHeap
   D3D12_HEAP_DESC heap_desc =
@@ -69,24 +110,41 @@ void* D3D12HeapAllocator::Alloc(uint64_t size_in_bytes) {
 
   allocations_by_id_.emplace(*id, std::move(allocation));
 
-  lock.unlock();
-
   const uint64_t offset = 0;
-  return PackPointer(*id, offset);
+  void* ptr = PackPointer(*id, offset);
+
+  // A dedicated heap is freshly created for every allocation, so its memory
+  // is always in its D3D12 zero-initialized state.
+  zeroed_allocations_.insert(reinterpret_cast<uint64_t>(ptr));
+
+  return ptr;
 }
 
 void D3D12HeapAllocator::Free(void* ptr, uint64_t size_in_bytes) {
   CHECK(ptr != nullptr) << "Invalid pointer";
 
   TaggedPointer tagged_ptr = UnpackPointer(ptr);
-  CHECK(tagged_ptr.offset == 0) << "Invalid pointer";
 
   // We need to access (mutable) state after this point, so we need to lock
   std::unique_lock<std::mutex> lock(mutex_);
 
+  zeroed_allocations_.erase(reinterpret_cast<uint64_t>(ptr));
+
   auto it = allocations_by_id_.find(tagged_ptr.allocation_id);
 
   CHECK(it != allocations_by_id_.end()) << "Invalid pointer";
+
+  // Imported resources are released with ReleaseExternalResource, never
+  // through the BFC free path
+  CHECK(it->second.external_resource == nullptr) << "Invalid pointer";
+
+  if (it->second.is_block_heap) {
+    FreeSubAllocation(tagged_ptr.allocation_id, &it->second, tagged_ptr.offset,
+                      size_in_bytes);
+    return;
+  }
+
+  CHECK(tagged_ptr.offset == 0) << "Invalid pointer";
   DCHECK(it->second.heap->GetDesc().SizeInBytes == size_in_bytes);
 
   VLOG(3) << "D3D12HeapAllocator: freeing id=" << tagged_ptr.allocation_id
@@ -98,6 +156,375 @@ void D3D12HeapAllocator::Free(void* ptr, uint64_t size_in_bytes) {
   allocations_by_id_.erase(it);
 }
 
+void* D3D12HeapAllocator::ImportExternalResource(ID3D12Resource* resource,
+                                                 uint64_t size_in_bytes) {
+  CHECK(resource != nullptr);
+  CHECK(resource->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER);
+  CHECK(size_in_bytes <= resource->GetDesc().Width);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  absl::optional<uint32_t> id = TryReserveAllocationID();
+  if (!id) {
+    LOG(WARNING) << "DML allocator ran out of allocation IDs!";
+    return nullptr;
+  }
+
+  VLOG(3) << "D3D12HeapAllocator: importing external resource id=" << *id
+          << ", " << strings::HumanReadableNumBytes(size_in_bytes);
+
+  Allocation allocation = {};
+  allocation.external_resource = resource;
+
+  allocations_by_id_.emplace(*id, std::move(allocation));
+
+  const uint64_t offset = 0;
+  return PackPointer(*id, offset);
+}
+
+void D3D12HeapAllocator::ReleaseExternalResource(void* ptr) {
+  CHECK(ptr != nullptr) << "Invalid pointer";
+
+  TaggedPointer tagged_ptr = UnpackPointer(ptr);
+  CHECK(tagged_ptr.offset == 0) << "Invalid pointer";
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto it = allocations_by_id_.find(tagged_ptr.allocation_id);
+  CHECK(it != allocations_by_id_.end()) << "Invalid pointer";
+  CHECK(it->second.external_resource != nullptr)
+      << "Pointer does not refer to an imported resource";
+
+  VLOG(3) << "D3D12HeapAllocator: releasing external resource id="
+          << tagged_ptr.allocation_id;
+
+  ReleaseAllocationID(tagged_ptr.allocation_id);
+
+  // Drops this allocator's reference on the caller-owned resource
+  allocations_by_id_.erase(it);
+}
+
+void* D3D12HeapAllocator::SubAllocate(uint64_t size_in_bytes) {
+  const uint32_t tile_count = static_cast<uint32_t>(
+      (size_in_bytes + kTileSizeInBytes - 1) / kTileSizeInBytes);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // Search all block heaps for the smallest free range that fits (best-fit
+  // keeps large ranges intact, which resists fragmentation over long runs).
+  Allocation* best_allocation = nullptr;
+  uint32_t best_allocation_id = 0;
+  std::map<uint32_t, uint32_t>::iterator best_range;
+  uint32_t best_range_tiles = UINT32_MAX;
+
+  for (uint32_t block_id : block_heap_ids_) {
+    Allocation& allocation = allocations_by_id_[block_id];
+    for (auto range = allocation.free_ranges.begin();
+         range != allocation.free_ranges.end(); ++range) {
+      if (range->second >= tile_count && range->second < best_range_tiles) {
+        best_allocation = &allocation;
+        best_allocation_id = block_id;
+        best_range = range;
+        best_range_tiles = range->second;
+      }
+    }
+    if (best_range_tiles == tile_count) {
+      break;  // Exact fit; no point searching further
+    }
+  }
+
+  if (best_allocation == nullptr) {
+    // No block heap has room; grow by one block. The D3D12 device is
+    // thread-safe, so drop the lock over the call to CreateHeap.
+    lock.unlock();
+
+    D3D12_HEAP_DESC heap_desc = CD3DX12_HEAP_DESC(
+        kBlockHeapSizeInBytes, heap_properties_, 0, heap_flags_);
+
+    Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+    HRESULT hr = device_->CreateHeap(&heap_desc, IID_PPV_ARGS(&heap));
+    if (dml_util::HrIsOutOfMemory(hr)) {
+      return nullptr;
+    }
+    DML_CHECK_SUCCEEDED(hr);
+
+    lock.lock();
+
+    absl::optional<uint32_t> id = TryReserveAllocationID();
+    if (!id) {
+      LOG(WARNING) << "DML allocator ran out of allocation IDs!";
+      return nullptr;
+    }
+
+    VLOG(3) << "D3D12HeapAllocator: creating block heap id=" << *id << ", "
+            << strings::HumanReadableNumBytes(kBlockHeapSizeInBytes);
+
+    Allocation allocation = {};
+    allocation.heap = std::move(heap);
+    allocation.is_block_heap = true;
+    allocation.free_ranges.emplace(
+        0, static_cast<uint32_t>(kBlockHeapSizeInBytes / kTileSizeInBytes));
+
+    auto result = allocations_by_id_.emplace(*id, std::move(allocation));
+    block_heap_ids_.push_back(*id);
+
+    best_allocation = &result.first->second;
+    best_allocation_id = *id;
+    best_range = best_allocation->free_ranges.begin();
+  }
+
+  if (best_allocation->evicted) {
+    // This block was evicted under budget pressure; restore residency before
+    // handing out memory from it. If this fails the device is genuinely out
+    // of memory, so give up and let Alloc fall back to a dedicated heap.
+    ID3D12Pageable* pageable = best_allocation->heap.Get();
+    HRESULT hr;
+    if (device3_ != nullptr) {
+      // Queue the page-in asynchronously and record the fence value it will
+      // signal. Allocation happens several batched commands ahead of GPU
+      // execution, so by making the consuming batch *wait* on this fence
+      // (see CreateBufferRegion) instead of blocking here, the OS pages the
+      // heap in while the GPU is still busy with earlier work.
+      hr = device3_->EnqueueMakeResident(D3D12_RESIDENCY_FLAG_NONE, 1,
+                                         &pageable, residency_fence_.Get(),
+                                         next_residency_fence_value_);
+      if (SUCCEEDED(hr)) {
+        best_allocation->pending_residency_fence_value =
+            next_residency_fence_value_++;
+      }
+    } else {
+      hr = device_->MakeResident(1, &pageable);
+    }
+    if (dml_util::HrIsOutOfMemory(hr)) {
+      return nullptr;
+    }
+    DML_CHECK_SUCCEEDED(hr);
+    best_allocation->evicted = false;
+
+    VLOG(2) << "D3D12HeapAllocator: restored evicted block heap id="
+            << best_allocation_id
+            << (device3_ != nullptr ? " (asynchronously)" : "");
+  }
+
+  // Carve the sub-allocation from the front of the chosen range.
+  const uint32_t first_tile = best_range->first;
+  const uint32_t range_tiles = best_range->second;
+  best_allocation->free_ranges.erase(best_range);
+  if (range_tiles > tile_count) {
+    best_allocation->free_ranges.emplace(first_tile + tile_count,
+                                         range_tiles - tile_count);
+  }
+  best_allocation->tiles_in_use += tile_count;
+
+  VLOG(3) << "D3D12HeapAllocator: sub-allocating id=" << best_allocation_id
+          << ", tile=" << first_tile << ", "
+          << strings::HumanReadableNumBytes(size_in_bytes);
+
+  void* ptr = PackPointer(best_allocation_id, first_tile * kTileSizeInBytes);
+
+  // Tiles beyond the heap's high-water mark have never been handed out, so
+  // they still read as the zeros D3D12 wrote at heap creation.
+  if (first_tile >= best_allocation->high_water_tile) {
+    zeroed_allocations_.insert(reinterpret_cast<uint64_t>(ptr));
+  }
+  best_allocation->high_water_tile = std::max(
+      best_allocation->high_water_tile, first_tile + tile_count);
+
+  return ptr;
+}
+
+void D3D12HeapAllocator::FreeSubAllocation(uint32_t allocation_id,
+                                           Allocation* allocation,
+                                           uint64_t offset,
+                                           uint64_t size_in_bytes) {
+  // The mutex must already be held
+  assert(!mutex_.try_lock());
+  assert(offset % kTileSizeInBytes == 0);
+
+  const uint32_t first_tile = static_cast<uint32_t>(offset / kTileSizeInBytes);
+  const uint32_t tile_count = static_cast<uint32_t>(
+      (size_in_bytes + kTileSizeInBytes - 1) / kTileSizeInBytes);
+
+  VLOG(3) << "D3D12HeapAllocator: sub-freeing id=" << allocation_id
+          << ", tile=" << first_tile << ", "
+          << strings::HumanReadableNumBytes(size_in_bytes);
+
+  // Reinsert the range, coalescing with its successor and predecessor so that
+  // interleaved alloc/free patterns can't shatter the heap into slivers.
+  auto range =
+      allocation->free_ranges.emplace(first_tile, tile_count).first;
+
+  auto next = std::next(range);
+  if (next != allocation->free_ranges.end() &&
+      range->first + range->second == next->first) {
+    range->second += next->second;
+    allocation->free_ranges.erase(next);
+  }
+
+  if (range != allocation->free_ranges.begin()) {
+    auto prev = std::prev(range);
+    if (prev->first + prev->second == range->first) {
+      prev->second += range->second;
+      allocation->free_ranges.erase(range);
+    }
+  }
+
+  CHECK(allocation->tiles_in_use >= tile_count);
+  allocation->tiles_in_use -= tile_count;
+
+  if (allocation->tiles_in_use == 0) {
+    // Keep one empty block heap around to absorb churn, but release the rest
+    // so an idle process doesn't pin device memory.
+    bool another_empty_block_exists = false;
+    for (uint32_t block_id : block_heap_ids_) {
+      if (block_id != allocation_id &&
+          allocations_by_id_[block_id].tiles_in_use == 0) {
+        another_empty_block_exists = true;
+        break;
+      }
+    }
+
+    if (another_empty_block_exists) {
+      VLOG(3) << "D3D12HeapAllocator: releasing empty block heap id="
+              << allocation_id;
+
+      block_heap_ids_.erase(std::remove(block_heap_ids_.begin(),
+                                        block_heap_ids_.end(), allocation_id),
+                            block_heap_ids_.end());
+      ReleaseAllocationID(allocation_id);
+
+      // Frees the ID3D12Heap
+      allocations_by_id_.erase(allocation_id);
+    }
+  }
+}
+
+std::string D3D12HeapAllocator::DebugString() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  uint64_t dedicated_count = 0;
+  uint64_t dedicated_bytes = 0;
+  uint64_t external_count = 0;
+  uint64_t external_bytes = 0;
+  uint64_t live_block_heaps = 0;
+  uint64_t evicted_block_heaps = 0;
+  uint64_t tiles_in_use = 0;
+  uint64_t largest_free_tiles = 0;
+
+  // Histogram of free tile ranges by power-of-two size: bucket i counts
+  // ranges of [2^i, 2^(i+1)) tiles. A block heap has at most 1024 tiles, so
+  // 11 buckets suffice.
+  constexpr int kNumBuckets = 11;
+  uint64_t free_range_histogram[kNumBuckets] = {};
+
+  for (const auto& entry : allocations_by_id_) {
+    const Allocation& allocation = entry.second;
+
+    if (allocation.external_resource) {
+      ++external_count;
+      external_bytes += allocation.external_resource->GetDesc().Width;
+      continue;
+    }
+
+    if (!allocation.is_block_heap) {
+      ++dedicated_count;
+      dedicated_bytes += allocation.heap->GetDesc().SizeInBytes;
+      continue;
+    }
+
+    if (allocation.evicted) {
+      ++evicted_block_heaps;
+      continue;
+    }
+
+    ++live_block_heaps;
+    tiles_in_use += allocation.tiles_in_use;
+
+    for (const auto& range : allocation.free_ranges) {
+      const uint32_t range_tiles = range.second;
+      largest_free_tiles = std::max<uint64_t>(largest_free_tiles, range_tiles);
+
+      int bucket = 0;
+      while ((1u << (bucket + 1)) <= range_tiles && bucket + 1 < kNumBuckets) {
+        ++bucket;
+      }
+      ++free_range_histogram[bucket];
+    }
+  }
+
+  const uint64_t tiles_per_block = kBlockHeapSizeInBytes / kTileSizeInBytes;
+  const uint64_t total_tiles = live_block_heaps * tiles_per_block;
+
+  string result = "D3D12HeapAllocator report:\n";
+  strings::StrAppend(
+      &result, "  Dedicated heaps: ", dedicated_count, " (",
+      strings::HumanReadableNumBytes(dedicated_bytes), ")\n",
+      "  Imported external resources: ", external_count, " (",
+      strings::HumanReadableNumBytes(external_bytes), ")\n",
+      "  Block heaps: ", live_block_heaps, " resident, ", evicted_block_heaps,
+      " evicted (", strings::HumanReadableNumBytes(
+                        (live_block_heaps + evicted_block_heaps) *
+                        kBlockHeapSizeInBytes),
+      ")\n", "  Block heap tiles in use: ", tiles_in_use, "/", total_tiles,
+      " (", strings::HumanReadableNumBytes(tiles_in_use * kTileSizeInBytes),
+      " of ", strings::HumanReadableNumBytes(total_tiles * kTileSizeInBytes),
+      ")\n", "  Largest contiguous free block: ",
+      strings::HumanReadableNumBytes(largest_free_tiles * kTileSizeInBytes),
+      "\n");
+
+  strings::StrAppend(&result, "  Free ranges by size:");
+  bool any_free_ranges = false;
+  for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+    if (free_range_histogram[bucket] == 0) {
+      continue;
+    }
+    any_free_ranges = true;
+    strings::StrAppend(
+        &result, " ",
+        strings::HumanReadableNumBytes((1ull << bucket) * kTileSizeInBytes),
+        ":", free_range_histogram[bucket]);
+  }
+  strings::StrAppend(&result, any_free_ranges ? "\n" : " (none)\n");
+
+  return result;
+}
+
+bool D3D12HeapAllocator::IsAllocationZeroed(const void* ptr) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return zeroed_allocations_.count(reinterpret_cast<uint64_t>(ptr)) != 0;
+}
+
+void D3D12HeapAllocator::SetResidencyWaitHandler(
+    std::function<void(DmlGpuEvent)> handler) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  residency_wait_handler_ = std::move(handler);
+}
+
+uint64_t D3D12HeapAllocator::EvictUnusedBlockHeaps() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  uint64_t bytes_evicted = 0;
+
+  for (uint32_t block_id : block_heap_ids_) {
+    Allocation& allocation = allocations_by_id_[block_id];
+    if (allocation.tiles_in_use != 0 || allocation.evicted) {
+      continue;
+    }
+
+    // Evict demotes the heap's pages without destroying the heap or its
+    // pooled placed resources, so reusing the block later costs a
+    // MakeResident instead of a full CreateHeap.
+    ID3D12Pageable* pageable = allocation.heap.Get();
+    DML_CHECK_SUCCEEDED(device_->Evict(1, &pageable));
+    allocation.evicted = true;
+    bytes_evicted += kBlockHeapSizeInBytes;
+
+    VLOG(2) << "D3D12HeapAllocator: evicted empty block heap id=" << block_id;
+  }
+
+  return bytes_evicted;
+}
+
 D3D12BufferRegion D3D12HeapAllocator::CreateBufferRegion(
     const void* ptr, uint64_t size_in_bytes) {
   CHECK(ptr != nullptr) << "Invalid pointer";
@@ -113,6 +540,29 @@ D3D12BufferRegion D3D12HeapAllocator::CreateBufferRegion(
 
   Allocation* allocation = &it->second;
 
+  if (allocation->external_resource) {
+    // Imported allocations hand out the caller's resource directly; COM
+    // ref-counting makes it safe for multiple regions to share it.
+    return D3D12BufferRegion(this, tagged_ptr.allocation_id,
+                             allocation->external_resource, tagged_ptr.offset,
+                             size_in_bytes);
+  }
+
+  // If this heap's asynchronous page-in hasn't completed yet, any GPU work
+  // that binds the region must wait for it. Report the fence event through
+  // the registered handler (which queues a wait on the execution context's
+  // next batch) once the lock is dropped below.
+  absl::optional<DmlGpuEvent> residency_event;
+  if (allocation->pending_residency_fence_value != 0) {
+    if (residency_fence_->GetCompletedValue() >=
+        allocation->pending_residency_fence_value) {
+      allocation->pending_residency_fence_value = 0;
+    } else if (residency_wait_handler_) {
+      residency_event = DmlGpuEvent{allocation->pending_residency_fence_value,
+                                    residency_fence_};
+    }
+  }
+
   // Retrieve a placed resource that spans the allocation's heap
   Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
   if (!allocation->placed_resource_pool.empty()) {
@@ -131,8 +581,18 @@ D3D12BufferRegion D3D12HeapAllocator::CreateBufferRegion(
         IID_PPV_ARGS(&buffer)));
   }
 
-  return D3D12BufferRegion(this, tagged_ptr.allocation_id, std::move(buffer),
+  D3D12BufferRegion region(this, tagged_ptr.allocation_id, std::move(buffer),
                            tagged_ptr.offset, size_in_bytes);
+
+  if (residency_event) {
+    // The handler takes the execution context's own lock, so call it outside
+    // ours to keep the lock order one-way.
+    auto handler = residency_wait_handler_;
+    lock.unlock();
+    handler(std::move(*residency_event));
+  }
+
+  return region;
 }
 
 void D3D12HeapAllocator::ReleasePlacedResource(
@@ -146,6 +606,12 @@ void D3D12HeapAllocator::ReleasePlacedResource(
 
   Allocation* allocation = &it->second;
 
+  if (allocation->external_resource) {
+    // Nothing to pool; just drop the reference taken by CreateBufferRegion
+    assert(allocation->external_resource.Get() == resource.Get());
+    return;
+  }
+
   // If the sizes don't match, then it means this resource didn't come from this
   // allocator...
   assert(allocation->heap->GetDesc().SizeInBytes == resource->GetDesc().Width);
@@ -183,6 +649,18 @@ void D3D12HeapAllocator::ReleaseAllocationID(uint32_t id) {
   free_allocation_ids_.push_back(id);
 }
 
+bool D3D12HeapAllocator::OwnsPointer(const void* ptr) {
+  if (ptr == nullptr) {
+    return false;
+  }
+
+  TaggedPointer tagged_ptr = UnpackPointer(ptr);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  return allocations_by_id_.find(tagged_ptr.allocation_id) !=
+         allocations_by_id_.end();
+}
+
 /*static*/ void* D3D12HeapAllocator::PackPointer(uint32_t allocation_id,
                                                  uint64_t offset) {
   DCHECK(allocation_id < (1ull << kAllocationIDBits));
@@ -15,9 +15,14 @@ limitations under the License.
 
 #pragma once
 
+#include <functional>
+#include <map>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "dml_buffer_region.h"
 #include "dml_common.h"
+#include "dml_gpu_event.h"
 
 namespace tensorflow {
 
@@ -30,6 +35,21 @@ class D3D12HeapAllocator {
   static constexpr uint64_t kDefaultMaxAllocationSizeInBytes =
       (1ull << 32) - (1ull << 20);
 
+  // Granularity of sub-allocations carved out of shared block heaps. This
+  // matches D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, so any tile-aligned
+  // offset is a valid placed-resource offset.
+  static constexpr uint64_t kTileSizeInBytes = 1ull << 16;
+
+  // Size of the shared heaps that back sub-allocations. All block heaps are
+  // identical, so freed blocks are perfectly reusable by the driver and
+  // long-running processes don't fragment device memory with odd-sized heaps.
+  static constexpr uint64_t kBlockHeapSizeInBytes = 1ull << 26;  // 64MB
+
+  // Requests above this size get a dedicated heap as before; carving them out
+  // of block heaps would defeat best-fit placement.
+  static constexpr uint64_t kMaxSubAllocationSizeInBytes =
+      kBlockHeapSizeInBytes / 4;
+
   D3D12HeapAllocator(ID3D12Device* device,
                      const D3D12_HEAP_PROPERTIES& heap_props,
                      D3D12_HEAP_FLAGS heap_flags,
@@ -44,9 +64,69 @@ class D3D12HeapAllocator {
   // ID3D12Device::CreatePlacedResource.
   D3D12BufferRegion CreateBufferRegion(const void* ptr, uint64_t size_in_bytes);
 
+  // Returns true if `ptr` was handed out by this allocator (or registered
+  // through ImportExternalResource) and is still live. Unlike
+  // CreateBufferRegion, this never fails on foreign pointers, so callers that
+  // receive pointers of unknown provenance (e.g. the interop API receiving an
+  // arbitrary tensor) can validate them first.
+  bool OwnsPointer(const void* ptr);
+
   void* Alloc(uint64_t size_in_bytes);
   void Free(void* ptr, uint64_t size_in_bytes);
 
+  // Registers a caller-owned buffer resource with this allocator and returns a
+  // tagged pointer for it, so that the resource can back a device-resident
+  // tensor without any copies. The allocator takes its own reference on the
+  // resource, which is dropped by ReleaseExternalResource; the caller retains
+  // ownership of the underlying memory. Returns nullptr if no allocation IDs
+  // are available.
+  void* ImportExternalResource(ID3D12Resource* resource,
+                               uint64_t size_in_bytes);
+
+  // Unregisters a resource previously registered with ImportExternalResource
+  // and releases the allocator's reference on it. `ptr` must not be used after
+  // this call. Must not be called while the GPU may still be accessing the
+  // resource through this allocator.
+  void ReleaseExternalResource(void* ptr);
+
+  // Calls ID3D12Device::Evict on every block heap with no live
+  // sub-allocations and returns the number of bytes demoted. Evicted heaps
+  // keep their ID3D12Heap and pooled placed resources; they are made resident
+  // again automatically if a later allocation reuses them. Called by
+  // DmlBudgetManager when the process nears its OS video memory budget.
+  uint64_t EvictUnusedBlockHeaps();
+
+  // Returns a human-readable report of this allocator's physical memory
+  // state: dedicated heap and imported resource counts and sizes, block heap
+  // occupancy, and a power-of-two histogram of the free tile ranges in the
+  // block heaps together with the largest contiguous free range. Intended for
+  // OOM diagnostics; see DmlAllocator::DebugString for the combined
+  // arena + heap report.
+  std::string DebugString();
+
+  // Returns true if the given allocation (as returned by Alloc) is backed by
+  // memory that D3D12 zeroed at heap creation and that this allocator has
+  // never handed out before. Such memory is guaranteed to read as zero until
+  // something writes to it, so a caller that was about to clear it can skip
+  // the clear. The flag clears when the allocation is freed; its tiles count
+  // as used from then on.
+  bool IsAllocationZeroed(const void* ptr);
+
+  // Returns true if this allocator's heaps are CPU-visible (i.e. placed
+  // resources created over them can be mapped). True only when the allocator
+  // was constructed with custom heap properties that name a CPU page
+  // property, as DmlDeviceState does on cache-coherent UMA adapters.
+  bool IsCpuVisible() const { return cpu_visible_; }
+
+  // Registers the callback through which this allocator reports that GPU
+  // work touching a just-created buffer region must wait for an asynchronous
+  // page-in to complete (see the EnqueueMakeResident path in SubAllocate).
+  // DmlDeviceState wires this to QueueDependency on both the execution
+  // context and the copy queue: the next submission on each queue — the
+  // earliest that can reference the region — waits on the residency fence on
+  // the GPU timeline instead of the CPU blocking at allocation time.
+  void SetResidencyWaitHandler(std::function<void(DmlGpuEvent)> handler);
+
  private:
   std::mutex mutex_;
 
@@ -77,10 +157,72 @@ class D3D12HeapAllocator {
     // vector (or if empty, a new one created) and returned. Once the caller is
     // done with the resource, it is added back to the pool for re-use.
     std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> placed_resource_pool;
+
+    // Non-null for allocations imported via ImportExternalResource. These
+    // have no heap of their own: the caller-owned resource itself is handed
+    // out (ref-counted) instead of placed resources from the pool.
+    Microsoft::WRL::ComPtr<ID3D12Resource> external_resource;
+
+    // True if this allocation is a shared block heap serving tile-granular
+    // sub-allocations; the bookkeeping below is only used in that case.
+    bool is_block_heap = false;
+
+    uint32_t tiles_in_use = 0;
+
+    // True if this block heap's pages have been demoted with Evict under
+    // budget pressure. Only empty block heaps are ever evicted, so no live
+    // pointer can refer to an evicted heap.
+    bool evicted = false;
+
+    // Non-zero while an asynchronous EnqueueMakeResident of this heap is (or
+    // may still be) in flight: the residency fence value it will signal.
+    // Cleared lazily once the fence passes it. GPU work touching the heap
+    // must not execute before the fence reaches this value.
+    uint64_t pending_residency_fence_value = 0;
+
+    // Free contiguous tile ranges within this block heap, keyed by tile
+    // offset. Kept ordered so adjacent ranges coalesce on free.
+    std::map<uint32_t, uint32_t> free_ranges;
+
+    // Tiles below this mark have been handed out at least once since the
+    // heap was created, so they may contain stale data; tiles at or above it
+    // are still in their D3D12 zero-initialized state.
+    uint32_t high_water_tile = 0;
   };
 
   absl::flat_hash_map<uint32_t, Allocation> allocations_by_id_;
 
+  // Live allocations (by tagged pointer value) whose memory is still in its
+  // D3D12 zero-initialized state. See IsAllocationZeroed.
+  absl::flat_hash_set<uint64_t> zeroed_allocations_;
+
+  // Allocation IDs of live block heaps, searched for best-fit placement.
+  std::vector<uint32_t> block_heap_ids_;
+
+  // Whether small allocations are served from shared block heaps (controlled
+  // by TF_DIRECTML_HEAP_SUBALLOCATION, default on).
+  bool suballocation_enabled_ = true;
+
+  // See IsCpuVisible. Derived from heap_properties_ at construction.
+  bool cpu_visible_ = false;
+
+  // Asynchronous residency state. device3_ is null when the runtime doesn't
+  // support EnqueueMakeResident (or TF_DIRECTML_ASYNC_RESIDENCY=0), in which
+  // case evicted heaps are restored with a blocking MakeResident as before.
+  Microsoft::WRL::ComPtr<ID3D12Device3> device3_;
+  Microsoft::WRL::ComPtr<ID3D12Fence> residency_fence_;
+  uint64_t next_residency_fence_value_ = 1;
+  std::function<void(DmlGpuEvent)> residency_wait_handler_;
+
+  // Serves a small request from the block heaps, growing them if needed.
+  // Returns nullptr if device memory is exhausted. The mutex must not be held.
+  void* SubAllocate(uint64_t size_in_bytes);
+
+  // Returns a sub-allocation's tiles to its block heap, coalescing with
+  // neighboring free ranges. The mutex must already be held.
+  void FreeSubAllocation(uint32_t allocation_id, Allocation* allocation,
+                         uint64_t offset, uint64_t size_in_bytes);
+
   // Releases a placed resource back to an allocation's pool. Called by
   // D3D12BufferRegion when it gets destructed.
   void ReleasePlacedResource(uint32_t allocation_id,
@@ -0,0 +1,596 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_interop_api.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "dml_adapter.h"
+#include "dml_bfc_allocator.h"
+#include "dml_device_cache.h"
+#include "dml_device_context.h"
+#include "dml_device_state.h"
+#include "dml_kernel_trace.h"
+#include "dml_lazy_constant_registry.h"
+#include "dml_tracing.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+using namespace tensorflow;  // NOLINT: C-linkage functions below
+
+uint32_t TFDML_GetAdapterCount() {
+  return DmlDeviceCache::Instance().GetAdapterCount();
+}
+
+int TFDML_ImportD3D12Buffer(uint32_t adapter_index, ID3D12Resource* buffer,
+                            ID3D12Fence* wait_fence, uint64_t wait_fence_value,
+                            int dtype, const int64_t* dims, int num_dims,
+                            void** out_tensor) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (out_tensor == nullptr || (num_dims > 0 && dims == nullptr)) {
+    LOG(WARNING) << "TFDML_ImportD3D12Buffer: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_ImportD3D12Buffer: adapter index " << adapter_index
+                 << " is out of range";
+    return 1;
+  }
+
+  if (!DataType_IsValid(dtype)) {
+    LOG(WARNING) << "TFDML_ImportD3D12Buffer: invalid dtype " << dtype;
+    return 1;
+  }
+
+  TensorShape shape;
+  for (int i = 0; i < num_dims; ++i) {
+    if (dims[i] < 0) {
+      LOG(WARNING) << "TFDML_ImportD3D12Buffer: invalid dimension " << dims[i];
+      return 1;
+    }
+    shape.AddDim(dims[i]);
+  }
+
+  // Typically the device state already exists because a session with DML
+  // devices has been created. If not, this creates it the same way the device
+  // factory would absent any session options: limited to the memory available
+  // on the adapter right now.
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  auto* device_context = new DMLDeviceContext(
+      state->execution_context.get(), state->event_queue.get(),
+      state->upload_heap.get(), state->readback_heap.get(),
+      state->dml_allocator.get(), state->copy_queue.get(),
+      state->copy_event_queue.get(), state->pinned_allocator.get(),
+      state->upload_cache.get());
+
+  auto tensor = absl::make_unique<Tensor>();
+  Status status = device_context->ImportExternalBuffer(
+      buffer, static_cast<DataType>(dtype), shape, wait_fence,
+      wait_fence_value, tensor.get());
+  device_context->Unref();
+
+  if (!status.ok()) {
+    LOG(WARNING) << "TFDML_ImportD3D12Buffer failed: " << status.ToString();
+    return 1;
+  }
+
+  *out_tensor = tensor.release();
+  return 0;
+}
+
+void TFDML_DeleteImportedTensor(void* tensor) {
+  delete static_cast<Tensor*>(tensor);
+}
+
+int TFDML_AllocateDeviceTensor(uint32_t adapter_index, int dtype,
+                               const int64_t* dims, int num_dims,
+                               void** out_tensor) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (out_tensor == nullptr || (num_dims > 0 && dims == nullptr)) {
+    LOG(WARNING) << "TFDML_AllocateDeviceTensor: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_AllocateDeviceTensor: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  if (!DataType_IsValid(dtype)) {
+    LOG(WARNING) << "TFDML_AllocateDeviceTensor: invalid dtype " << dtype;
+    return 1;
+  }
+
+  TensorShape shape;
+  for (int i = 0; i < num_dims; ++i) {
+    if (dims[i] < 0) {
+      LOG(WARNING) << "TFDML_AllocateDeviceTensor: invalid dimension "
+                   << dims[i];
+      return 1;
+    }
+    shape.AddDim(dims[i]);
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  auto tensor = absl::make_unique<Tensor>(state->dml_allocator.get(),
+                                          static_cast<DataType>(dtype), shape);
+  if (shape.num_elements() > 0 && !tensor->IsInitialized()) {
+    LOG(WARNING) << "TFDML_AllocateDeviceTensor: allocation of "
+                 << shape.DebugString() << " failed (out of device memory?)";
+    return 1;
+  }
+
+  *out_tensor = tensor.release();
+  return 0;
+}
+
+int TFDML_AllocateSharedDeviceTensor(uint32_t adapter_index, int dtype,
+                                     const int64_t* dims, int num_dims,
+                                     void** out_tensor, HANDLE* out_handle) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (out_tensor == nullptr || out_handle == nullptr ||
+      (num_dims > 0 && dims == nullptr)) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  if (!DataType_IsValid(dtype) ||
+      DataTypeSize(static_cast<DataType>(dtype)) == 0) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: invalid dtype "
+                 << dtype;
+    return 1;
+  }
+
+  TensorShape shape;
+  for (int i = 0; i < num_dims; ++i) {
+    if (dims[i] < 0) {
+      LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: invalid dimension "
+                   << dims[i];
+      return 1;
+    }
+    shape.AddDim(dims[i]);
+  }
+
+  if (shape.num_elements() == 0) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: tensor is empty";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  // Shared allocations get a dedicated committed resource: the allocator's
+  // pooled heaps aren't created with D3D12_HEAP_FLAG_SHARED (the flag
+  // pessimizes every allocation, not just shared ones), so sharable memory
+  // can't come from them. Buffers are implicitly simultaneous-access, which
+  // is what lets both processes hold views of the same memory.
+  const uint64_t size_in_bytes =
+      (shape.num_elements() * DataTypeSize(static_cast<DataType>(dtype)) + 3) &
+      ~3ull;
+
+  CD3DX12_HEAP_PROPERTIES heap_props(D3D12_HEAP_TYPE_DEFAULT);
+  D3D12_RESOURCE_DESC buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(
+      size_in_bytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+  Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+  HRESULT hr = state->d3d_device->CreateCommittedResource(
+      &heap_props, D3D12_HEAP_FLAG_SHARED, &buffer_desc,
+      D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&resource));
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: failed to create a "
+                    "sharable buffer (HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  HANDLE handle = nullptr;
+  hr = state->d3d_device->CreateSharedHandle(resource.Get(), nullptr,
+                                             GENERIC_ALL, nullptr, &handle);
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor: failed to create a "
+                    "shared handle (HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  auto* device_context = new DMLDeviceContext(
+      state->execution_context.get(), state->event_queue.get(),
+      state->upload_heap.get(), state->readback_heap.get(),
+      state->dml_allocator.get(), state->copy_queue.get(),
+      state->copy_event_queue.get(), state->pinned_allocator.get(),
+      state->upload_cache.get());
+
+  auto tensor = absl::make_unique<Tensor>();
+  Status status = device_context->ImportExternalBuffer(
+      resource.Get(), static_cast<DataType>(dtype), shape, nullptr, 0,
+      tensor.get());
+  device_context->Unref();
+
+  if (!status.ok()) {
+    LOG(WARNING) << "TFDML_AllocateSharedDeviceTensor failed: "
+                 << status.ToString();
+    CloseHandle(handle);
+    return 1;
+  }
+
+  *out_tensor = tensor.release();
+  *out_handle = handle;
+  return 0;
+}
+
+int TFDML_ImportSharedBufferHandle(uint32_t adapter_index,
+                                   HANDLE buffer_handle,
+                                   HANDLE wait_fence_handle,
+                                   uint64_t wait_fence_value, int dtype,
+                                   const int64_t* dims, int num_dims,
+                                   void** out_tensor) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (buffer_handle == nullptr || out_tensor == nullptr ||
+      (num_dims > 0 && dims == nullptr)) {
+    LOG(WARNING) << "TFDML_ImportSharedBufferHandle: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_ImportSharedBufferHandle: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+  HRESULT hr = state->d3d_device->OpenSharedHandle(buffer_handle,
+                                                   IID_PPV_ARGS(&resource));
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_ImportSharedBufferHandle: failed to open the "
+                    "buffer handle (HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  Microsoft::WRL::ComPtr<ID3D12Fence> wait_fence;
+  if (wait_fence_handle != nullptr) {
+    hr = state->d3d_device->OpenSharedHandle(wait_fence_handle,
+                                             IID_PPV_ARGS(&wait_fence));
+    if (FAILED(hr)) {
+      LOG(WARNING) << "TFDML_ImportSharedBufferHandle: failed to open the "
+                      "fence handle (HRESULT: "
+                   << hr << ")";
+      return 1;
+    }
+  }
+
+  // The opened resource and fence are ordinary local COM objects from here
+  // on; importing holds its own references, so delegate to the same-process
+  // import path.
+  return TFDML_ImportD3D12Buffer(adapter_index, resource.Get(),
+                                 wait_fence.Get(), wait_fence_value, dtype,
+                                 dims, num_dims, out_tensor);
+}
+
+int TFDML_CreateSharedFence(uint32_t adapter_index, uint64_t initial_value,
+                            ID3D12Fence** out_fence, HANDLE* out_handle) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (out_fence == nullptr || out_handle == nullptr) {
+    LOG(WARNING) << "TFDML_CreateSharedFence: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_CreateSharedFence: adapter index " << adapter_index
+                 << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+  HRESULT hr = state->d3d_device->CreateFence(
+      initial_value, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&fence));
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_CreateSharedFence: failed to create a sharable "
+                    "fence (HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  HANDLE handle = nullptr;
+  hr = state->d3d_device->CreateSharedHandle(fence.Get(), nullptr, GENERIC_ALL,
+                                             nullptr, &handle);
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_CreateSharedFence: failed to create a shared "
+                    "handle (HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  *out_fence = fence.Detach();
+  *out_handle = handle;
+  return 0;
+}
+
+int TFDML_OpenSharedFenceHandle(uint32_t adapter_index, HANDLE fence_handle,
+                                ID3D12Fence** out_fence) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (fence_handle == nullptr || out_fence == nullptr) {
+    LOG(WARNING) << "TFDML_OpenSharedFenceHandle: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_OpenSharedFenceHandle: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+  HRESULT hr =
+      state->d3d_device->OpenSharedHandle(fence_handle, IID_PPV_ARGS(&fence));
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_OpenSharedFenceHandle: failed to open the fence "
+                    "handle (HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  *out_fence = fence.Detach();
+  return 0;
+}
+
+int TFDML_FlushAndSignalFence(uint32_t adapter_index, ID3D12Fence* fence,
+                              uint64_t value) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (fence == nullptr) {
+    LOG(WARNING) << "TFDML_FlushAndSignalFence: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_FlushAndSignalFence: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  StatusOr<DmlGpuEvent> event_or = state->execution_context->Flush();
+  if (!event_or.ok()) {
+    LOG(WARNING) << "TFDML_FlushAndSignalFence failed: "
+                 << event_or.status().ToString();
+    return 1;
+  }
+
+  // The signal rides the compute queue's timeline behind the work that was
+  // just flushed, so it fires once that work has completed on the GPU
+  // without any CPU wait.
+  HRESULT hr = state->command_queue->Signal(fence, value);
+  if (FAILED(hr)) {
+    LOG(WARNING) << "TFDML_FlushAndSignalFence: failed to queue the signal "
+                    "(HRESULT: "
+                 << hr << ")";
+    return 1;
+  }
+
+  return 0;
+}
+
+int TFDML_GetTensorD3D12Buffer(uint32_t adapter_index, void* tensor,
+                               ID3D12Resource** out_resource,
+                               uint64_t* out_offset, uint64_t* out_size) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (tensor == nullptr || out_resource == nullptr || out_offset == nullptr ||
+      out_size == nullptr) {
+    LOG(WARNING) << "TFDML_GetTensorD3D12Buffer: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_GetTensorD3D12Buffer: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const Tensor* t = static_cast<const Tensor*>(tensor);
+  if (t->NumElements() == 0) {
+    LOG(WARNING) << "TFDML_GetTensorD3D12Buffer: tensor is empty";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  // Host tensors (and device tensors from other adapters) carry data pointers
+  // this allocator has never handed out; CreateBufferRegion would CHECK-fail
+  // on them, so validate the pointer first.
+  if (!state->dml_allocator->OwnsPointer(t->tensor_data().data())) {
+    LOG(WARNING) << "TFDML_GetTensorD3D12Buffer: tensor is not a "
+                    "device-resident tensor on this adapter";
+    return 1;
+  }
+
+  D3D12BufferRegion region = state->dml_allocator->CreateBufferRegion(
+      t->tensor_data().data(), t->tensor_data().size());
+
+  region.Resource()->AddRef();
+  *out_resource = region.Resource();
+  *out_offset = region.Offset();
+  *out_size = region.SizeInBytes();
+  return 0;
+}
+
+int TFDML_FlushAndGetCompletionFence(uint32_t adapter_index,
+                                     ID3D12Fence** out_fence,
+                                     uint64_t* out_fence_value) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (out_fence == nullptr || out_fence_value == nullptr) {
+    LOG(WARNING) << "TFDML_FlushAndGetCompletionFence: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_FlushAndGetCompletionFence: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  StatusOr<DmlGpuEvent> event_or = state->execution_context->Flush();
+  if (!event_or.ok()) {
+    LOG(WARNING) << "TFDML_FlushAndGetCompletionFence failed: "
+                 << event_or.status().ToString();
+    return 1;
+  }
+
+  DmlGpuEvent event = event_or.ConsumeValueOrDie();
+  event.fence.CopyTo(out_fence);
+  *out_fence_value = event.fence_value;
+  return 0;
+}
+
+size_t TFDML_GetMemoryReport(char* buffer, size_t buffer_size) {
+  string report;
+  DmlDeviceCache::Instance().ForEachDeviceState(
+      [&report](int adapter_index, const DmlDeviceState& state) {
+        strings::StrAppend(&report, "Adapter ", adapter_index, " (",
+                           state.adapter->Name(), "):\n",
+                           state.dml_allocator->DebugString(), "\n");
+      });
+
+  if (buffer != nullptr && buffer_size > 0) {
+    const size_t copy_size = std::min(buffer_size - 1, report.size());
+    std::memcpy(buffer, report.data(), copy_size);
+    buffer[copy_size] = '\0';
+  }
+
+  return report.size() + 1;
+}
+
+void TFDML_TriggerGpuCaptures(int num_runs) {
+  DmlTracing::Instance().TriggerGpuCaptures(num_runs);
+}
+
+int TFDML_ReplayKernelTrace(const char* trace_path, uint32_t adapter_index,
+                            int iterations) {
+  if (trace_path == nullptr) {
+    LOG(WARNING) << "TFDML_ReplayKernelTrace: trace_path must not be null";
+    return 1;
+  }
+  Status status =
+      DmlKernelTrace::Replay(trace_path, adapter_index, iterations);
+  if (!status.ok()) {
+    LOG(WARNING) << "TFDML_ReplayKernelTrace failed: " << status.ToString();
+    return 1;
+  }
+  return 0;
+}
+
+int TFDML_PrefetchConstants() {
+  Status status = DmlLazyConstantRegistry::Instance()->MaterializeAll();
+  if (!status.ok()) {
+    LOG(WARNING) << "TFDML_PrefetchConstants failed: " << status.ToString();
+    return 1;
+  }
+  return 0;
+}
+
+int TFDML_RegisterMemoryObserver(uint32_t adapter_index,
+                                 double threshold_fraction,
+                                 TFDML_MemoryEventCallback callback,
+                                 void* user_data, int64_t* out_observer_id) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (callback == nullptr || out_observer_id == nullptr) {
+    LOG(WARNING) << "TFDML_RegisterMemoryObserver: invalid arguments";
+    return 1;
+  }
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_RegisterMemoryObserver: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  *out_observer_id = state->dml_allocator->AddMemoryObserver(
+      threshold_fraction,
+      [callback, user_data](DmlAllocator::MemoryEvent event,
+                            uint64 bytes_in_use, uint64 limit) {
+        callback(static_cast<int>(event), bytes_in_use, limit, user_data);
+      });
+  return 0;
+}
+
+int TFDML_UnregisterMemoryObserver(uint32_t adapter_index,
+                                   int64_t observer_id) {
+  auto& device_cache = DmlDeviceCache::Instance();
+
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    LOG(WARNING) << "TFDML_UnregisterMemoryObserver: adapter index "
+                 << adapter_index << " is out of range";
+    return 1;
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  state->dml_allocator->RemoveMemoryObserver(observer_id);
+  return 0;
+}
@@ -0,0 +1,237 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include "dml_common.h"
+
+// C-linkage entry points for importing caller-owned D3D12 resources as
+// device-resident tensors (see DMLDeviceContext::ImportExternalBuffer). These
+// exist so same-process producers (e.g. renderers writing camera frames into
+// D3D12 buffers) can hand GPU data to inference with zero copies, even when
+// they can't link against TensorFlow's C++ ABI. Imported tensors are
+// heap-allocated tensorflow::Tensor objects passed around as opaque handles;
+// feed them through Session callables or other in-process APIs that accept
+// device-resident tensors. The reverse direction works too: device-resident
+// fetches can be resolved back to their D3D12 buffer and consumed on the
+// caller's own queue, ordered by an explicit completion fence, so a frame
+// never round-trips through host memory in either direction.
+//
+// The shared-handle entry points extend this to processes on the same host:
+// tensors allocated with TFDML_AllocateSharedDeviceTensor live in sharable
+// device memory and can be passed to another process as a (buffer handle,
+// fence handle, fence value) descriptor over any IPC channel, where
+// TFDML_ImportSharedBufferHandle maps them with zero copies. Handing a tensor
+// between two models in separate processes then costs two kernel handle
+// duplications and a fence wait instead of the serialize/copy/deserialize of
+// a loopback RPC transfer.
+
+extern "C" {
+
+// Returns the number of DirectML-capable adapters on the system.
+uint32_t TFDML_GetAdapterCount();
+
+// Imports `buffer` (a caller-owned ID3D12Resource of buffer dimension, in the
+// COMMON or UNORDERED_ACCESS state) as a device-resident tensor on the given
+// adapter. `dtype` is a tensorflow::DataType value, and `dims`/`num_dims`
+// describe the tensor shape. If `wait_fence` is non-null, GPU work submitted
+// after this call waits until the fence reaches `wait_fence_value` before
+// reading the buffer, so the producer's writes are ordered ahead of
+// inference.
+//
+// On success, returns 0 and stores an opaque tensorflow::Tensor* in
+// `out_tensor`, which must be released with TFDML_DeleteImportedTensor. On
+// failure, returns nonzero and logs the reason.
+int TFDML_ImportD3D12Buffer(uint32_t adapter_index, ID3D12Resource* buffer,
+                            ID3D12Fence* wait_fence, uint64_t wait_fence_value,
+                            int dtype, const int64_t* dims, int num_dims,
+                            void** out_tensor);
+
+// Deletes a tensor returned by TFDML_ImportD3D12Buffer or
+// TFDML_AllocateDeviceTensor. The reference held on the underlying resource
+// (or the allocation) is dropped only once all GPU work submitted before this
+// call has completed, so it is safe to call as soon as the caller is done
+// with the tensor.
+void TFDML_DeleteImportedTensor(void* tensor);
+
+// Allocates a device-resident tensor of the given dtype and shape from the
+// adapter's DML allocator, for use as a preallocated feed or fetch target.
+// On success, returns 0 and stores an opaque tensorflow::Tensor* in
+// `out_tensor`, which must be released with TFDML_DeleteImportedTensor. On
+// failure (including the device being out of memory), returns nonzero and
+// logs the reason.
+int TFDML_AllocateDeviceTensor(uint32_t adapter_index, int dtype,
+                               const int64_t* dims, int num_dims,
+                               void** out_tensor);
+
+// Like TFDML_AllocateDeviceTensor, but the tensor is backed by a dedicated
+// sharable device allocation, and an NT handle to it is stored in
+// `out_handle` (the caller must CloseHandle it). The handle can be duplicated
+// into another process on the same machine and opened there with
+// TFDML_ImportSharedBufferHandle, so both processes address the same device
+// memory. Sharable allocations bypass the DML allocator's heap pool, so
+// reserve them for long-lived transport buffers rather than per-step
+// scratch. Fails where the driver can't create shared heaps.
+int TFDML_AllocateSharedDeviceTensor(uint32_t adapter_index, int dtype,
+                                     const int64_t* dims, int num_dims,
+                                     void** out_tensor, HANDLE* out_handle);
+
+// Opens `buffer_handle` (an NT handle to a sharable D3D12 buffer, e.g. from
+// TFDML_AllocateSharedDeviceTensor in another process) on the given adapter
+// and imports it as a device-resident tensor, with the same dtype/shape and
+// fence semantics as TFDML_ImportD3D12Buffer. If `wait_fence_handle` is
+// non-null it is opened as a shared fence and GPU work reading the buffer
+// waits until it reaches `wait_fence_value`, ordering the producing process's
+// writes ahead of this process's reads entirely on the GPU timeline. The
+// handles are not consumed; the caller still owns and must close them.
+int TFDML_ImportSharedBufferHandle(uint32_t adapter_index,
+                                   HANDLE buffer_handle,
+                                   HANDLE wait_fence_handle,
+                                   uint64_t wait_fence_value, int dtype,
+                                   const int64_t* dims, int num_dims,
+                                   void** out_tensor);
+
+// Creates a sharable fence on the adapter, starting at `initial_value`, and
+// returns both the fence (AddRef'd; the caller must Release it) and an NT
+// handle to it (the caller must CloseHandle it). Duplicate the handle into a
+// peer process and open it with TFDML_OpenSharedFenceHandle to synchronize
+// the two processes' GPU timelines without either CPU blocking.
+int TFDML_CreateSharedFence(uint32_t adapter_index, uint64_t initial_value,
+                            ID3D12Fence** out_fence, HANDLE* out_handle);
+
+// Opens `fence_handle` (an NT handle to a sharable fence, e.g. from
+// TFDML_CreateSharedFence in another process) on the given adapter. On
+// success stores the fence in `out_fence` (AddRef'd; the caller must Release
+// it). The handle is not consumed. The fence can be passed to
+// TFDML_ImportD3D12Buffer / TFDML_FlushAndSignalFence or used directly on
+// the caller's own queues.
+int TFDML_OpenSharedFenceHandle(uint32_t adapter_index, HANDLE fence_handle,
+                                ID3D12Fence** out_fence);
+
+// Flushes all recorded GPU work on the adapter, then signals `fence` to
+// `value` from the adapter's compute queue once that work has completed.
+// With a shared fence this is how a producing process publishes a tensor to
+// a consumer: flush-and-signal after the step that wrote it, send the
+// descriptor, and let the consumer's import wait on the same fence value.
+// Returns nonzero on failure.
+int TFDML_FlushAndSignalFence(uint32_t adapter_index, ID3D12Fence* fence,
+                              uint64_t value);
+
+// Resolves a device-resident tensor (imported, allocated, or fetched from a
+// Session callable with a DML fetch device) to the D3D12 buffer backing it.
+// On success, returns 0 and stores the resource in `out_resource` (AddRef'd;
+// the caller must Release it), the tensor's byte offset within that resource
+// in `out_offset`, and the tensor's size in bytes in `out_size`. The bytes
+// are only valid while the tensor handle is alive. Returns nonzero for host
+// tensors, empty tensors, or tensors that don't belong to the given adapter.
+int TFDML_GetTensorD3D12Buffer(uint32_t adapter_index, void* tensor,
+                               ID3D12Resource** out_resource,
+                               uint64_t* out_offset, uint64_t* out_size);
+
+// Flushes all recorded GPU work on the adapter and returns a fence (AddRef'd;
+// the caller must Release it) and value that will be signaled once that work
+// has completed. After a Session::Run that produced device-resident fetches,
+// waiting on this fence (e.g. ID3D12CommandQueue::Wait on the consumer's own
+// queue) orders the caller's reads after inference without stalling the CPU.
+// This is the fetch-side counterpart of TFDML_ImportD3D12Buffer's
+// `wait_fence`. Returns nonzero on failure.
+int TFDML_FlushAndGetCompletionFence(uint32_t adapter_index,
+                                     ID3D12Fence** out_fence,
+                                     uint64_t* out_fence_value);
+
+// Writes a human-readable report of every DML device's memory state - BFC
+// arena statistics plus heap-level occupancy and fragmentation histograms
+// (see DmlAllocator::DebugString) - into `buffer` as a NUL-terminated string,
+// truncating if it doesn't fit. Returns the number of bytes required to hold
+// the full report including the NUL terminator; call with a null `buffer` (or
+// `buffer_size` of 0) to query the size. Devices that haven't been created
+// yet don't appear in the report.
+size_t TFDML_GetMemoryReport(char* buffer, size_t buffer_size);
+
+// Arms a programmatic PIX GPU capture of the next `num_runs` Session::Runs
+// (see DmlTracing::TriggerGpuCaptures). A same-process watchdog can call this
+// when it detects a stall or bad output, so the very next step is captured to
+// a .wpix file without a human attaching PIX at the right moment. No-op with
+// a logged warning if WinPixGpuCapturer.dll can't be loaded.
+void TFDML_TriggerGpuCaptures(int num_runs);
+
+// Uploads every constant whose device materialization has been deferred (see
+// TF_DIRECTML_LAZY_CONSTANTS). Lazy constants cost host memory until first
+// use, which suits standby models that may never run; call this to warm a
+// model that is about to take traffic so its first Run doesn't pay the
+// uploads. Returns nonzero if any upload failed (the failure is logged), and
+// is a harmless no-op when everything is already resident. Prefetches the
+// constants of every session instantiated so far.
+int TFDML_PrefetchConstants();
+
+// Event values delivered to TFDML_MemoryEventCallback. These mirror
+// DmlAllocator::MemoryEvent.
+enum TFDML_MemoryEvent {
+  // Device bytes-in-use rose above / fell back below the observer's threshold
+  // fraction of the allocator's memory limit.
+  TFDML_MEMORY_EVENT_THRESHOLD_EXCEEDED = 0,
+  TFDML_MEMORY_EVENT_THRESHOLD_CLEARED = 1,
+  // A retryable device allocation failed; the runtime will retry it after
+  // reclaiming memory, but an OOM error is likely if nothing is freed.
+  TFDML_MEMORY_EVENT_ALLOCATION_FAILED = 2,
+  // The OS changed the adapter's video memory budget (e.g. another process
+  // started using the GPU); `limit_in_bytes` carries the new budget.
+  TFDML_MEMORY_EVENT_BUDGET_CHANGED = 3,
+};
+
+// Callback invoked for memory events on an adapter. `event` is a
+// TFDML_MemoryEvent value; `bytes_in_use` is the allocator's device memory in
+// use at the time of the event, and `limit_in_bytes` is the allocator's
+// memory limit (or the new OS budget for BUDGET_CHANGED). The callback runs
+// on whichever thread triggered the event - often an allocation inside a
+// Session::Run - so it must be quick, must not block on GPU work, and must
+// not call back into TensorFlow synchronously; set a flag and react from the
+// application's own thread.
+typedef void (*TFDML_MemoryEventCallback)(int event, uint64_t bytes_in_use,
+                                          uint64_t limit_in_bytes,
+                                          void* user_data);
+
+// Registers `callback` as a memory observer on the adapter's DML allocator
+// and stores an id for TFDML_UnregisterMemoryObserver in `out_observer_id`.
+// Threshold events fire when bytes-in-use crosses `threshold_fraction` of the
+// allocator's memory limit in either direction (values outside (0, 1] are
+// clamped); failure and budget events fire regardless of the threshold. This
+// is the push counterpart to polling TFDML_GetMemoryReport: a serving layer
+// can shrink batch sizes when usage crosses its comfort line and re-grow them
+// when it clears, instead of reacting to the OOM after the fact. Returns
+// nonzero on failure.
+int TFDML_RegisterMemoryObserver(uint32_t adapter_index,
+                                 double threshold_fraction,
+                                 TFDML_MemoryEventCallback callback,
+                                 void* user_data, int64_t* out_observer_id);
+
+// Unregisters an observer returned by TFDML_RegisterMemoryObserver. No new
+// events are delivered after this returns, but an event already dispatching
+// on another thread may still complete, so free `user_data` from the
+// callback's own thread or after quiescing allocations. Returns nonzero on
+// failure.
+int TFDML_UnregisterMemoryObserver(uint32_t adapter_index,
+                                   int64_t observer_id);
+
+// Re-executes a kernel trace captured with TF_DIRECTML_KERNEL_TRACE (see
+// DmlKernelTrace) on the given adapter, `iterations` times, against synthetic
+// device buffers. This turns an unreproducible field report into a dispatch
+// sequence that can be profiled under PIX on a lab machine: arm a capture
+// with TFDML_TriggerGpuCaptures or attach PIX, then replay. Per-iteration
+// wall times are logged. Returns nonzero on failure (the reason is logged).
+int TFDML_ReplayKernelTrace(const char* trace_path, uint32_t adapter_index,
+                            int iterations);
+
+}  // extern "C"
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/dml/dml_kernel_context.h"
 
+#include "tensorflow/core/common_runtime/dml/dml_constant_pool.h"
 #include "tensorflow/core/common_runtime/dml/dml_device.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -23,6 +24,103 @@ using Microsoft::WRL::ComPtr;
 
 namespace tensorflow {
 
+//
+// DmlScratchBufferPool
+//
+
+namespace {
+
+// Scratch requests round up to the next power of two so that differently
+// sized operators land in a small number of shared buckets.
+constexpr uint64_t kMinScratchBucketSizeInBytes = 4096;
+
+// Total bytes the pool will retain. Released buffers past this cap free back
+// to the allocator instead of pooling.
+constexpr uint64_t kMaxPooledScratchBytes = 128 * 1024 * 1024;
+
+// Retention cap per bucket: the execution timeline is serialized, so beyond a
+// small number of concurrently checked-out buffers per size there's nothing
+// to reuse them for.
+constexpr size_t kMaxPooledBuffersPerBucket = 4;
+
+uint64_t GetScratchBucketSize(uint64_t size_in_bytes) {
+  uint64_t bucket_size = kMinScratchBucketSizeInBytes;
+  while (bucket_size < size_in_bytes) {
+    bucket_size *= 2;
+  }
+  return bucket_size;
+}
+
+}  // namespace
+
+DmlScratchBuffer::DmlScratchBuffer(DmlScratchBufferPool* pool,
+                                   DmlBuffer&& buffer)
+    : pool_(pool), buffer_(std::move(buffer)) {}
+
+DmlScratchBuffer::~DmlScratchBuffer() {
+  if (pool_ && buffer_) {
+    pool_->Release(std::move(buffer_));
+  }
+}
+
+DmlScratchBuffer::DmlScratchBuffer(DmlScratchBuffer&& other)
+    : pool_(other.pool_), buffer_(std::move(other.buffer_)) {
+  other.pool_ = nullptr;
+}
+
+DmlScratchBuffer& DmlScratchBuffer::operator=(DmlScratchBuffer&& other) {
+  if (this != &other) {
+    if (pool_ && buffer_) {
+      pool_->Release(std::move(buffer_));
+    }
+    pool_ = other.pool_;
+    buffer_ = std::move(other.buffer_);
+    other.pool_ = nullptr;
+  }
+  return *this;
+}
+
+DmlScratchBufferPool::DmlScratchBufferPool(DmlAllocator* allocator)
+    : allocator_(allocator) {}
+
+DmlScratchBuffer DmlScratchBufferPool::Acquire(uint64_t size_in_bytes) {
+  const uint64_t bucket_size = GetScratchBucketSize(size_in_bytes);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto bucket = buckets_.find(bucket_size);
+    if (bucket != buckets_.end() && !bucket->second.empty()) {
+      DmlBuffer buffer = std::move(bucket->second.back());
+      bucket->second.pop_back();
+      pooled_bytes_ -= bucket_size;
+      return DmlScratchBuffer(this, std::move(buffer));
+    }
+  }
+
+  // Allocate outside the lock; the allocator is itself thread-safe. A failed
+  // allocation produces an empty buffer, which callers test as before.
+  return DmlScratchBuffer(this, DmlBuffer(allocator_, bucket_size));
+}
+
+void DmlScratchBufferPool::Release(DmlBuffer&& buffer) {
+  const uint64_t bucket_size = buffer.SizeInBytes();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<DmlBuffer>& bucket = buckets_[bucket_size];
+    if (pooled_bytes_ + bucket_size <= kMaxPooledScratchBytes &&
+        bucket.size() < kMaxPooledBuffersPerBucket) {
+      bucket.push_back(std::move(buffer));
+      pooled_bytes_ += bucket_size;
+      return;
+    }
+  }
+
+  // Over the retention cap: let the buffer free back to the allocator. Reuse
+  // of that memory still only lands in later dispatches on the serialized
+  // timeline, so this is as safe as pooling.
+}
+
 //
 // DmlKernelConstruction
 //
@@ -60,11 +158,22 @@ DmlBuffer DmlKernelConstruction::AllocateDefaultBuffer(
   return DmlBuffer(device_->GetAllocator(), num_bytes);
 }
 
+DmlScratchBuffer DmlKernelConstruction::AllocateScratchBuffer(
+    uint64_t num_bytes) const {
+  return device_->GetScratchPool()->Acquire(num_bytes);
+}
+
 D3D12BufferRegion DmlKernelConstruction::CreateBufferForTensor(
     const Tensor& tensor) const {
   return dml_util::CreateBufferForTensor(device_, tensor);
 }
 
+StatusOr<std::shared_ptr<const DmlBuffer>>
+DmlKernelConstruction::AcquireConstantBuffer(
+    absl::Span<const uint8_t> data) const {
+  return device_->GetConstantPool()->AcquireBuffer(data);
+}
+
 DescriptorAllocation DmlKernelConstruction::AllocateDescriptors(
     size_t size_in_descriptors) const {
   return device_->GetDescriptorAllocator()->Alloc(size_in_descriptors);
@@ -160,11 +269,31 @@ DmlKernelContext::DmlKernelContext(
       // Ref types have already been allocated beforehand
       CHECK(i < output_refs_forwarding.size());
       CHECK(output_refs_forwarding[i].has_value());
+
+      // A forwarded ref output means the kernel is about to mutate the ref
+      // input's buffer in place. If snapshots of the variable still alias the
+      // buffer, redirect the variable to fresh storage first so they keep
+      // the pre-update value (the writer side of copy-on-write snapshots).
+      OP_REQUIRES_OK(op_ctx_, dml_util::EnsureRefTensorCopyOnWrite(
+                                  op_ctx_, *output_refs_forwarding[i]));
+
       op_ctx->forward_ref_input_to_ref_output(*output_refs_forwarding[i], i);
       output_tensor = op_ctx_->mutable_output(i);
     } else {
-      OP_REQUIRES_OK(op_ctx_, op_ctx_->allocate_output(i, output_shapes[i],
-                                                       &output_tensor));
+      // Element-wise kernels may nominate inputs whose buffers can back the
+      // output directly, in which case the kernel executes in place when one
+      // of them isn't referenced elsewhere
+      absl::InlinedVector<int, 4> in_place_inputs =
+          init_helper->GetInPlaceForwardableInputIndices(op_ctx_, i);
+
+      if (!in_place_inputs.empty()) {
+        OP_REQUIRES_OK(op_ctx_, op_ctx_->forward_input_or_allocate_output(
+                                    in_place_inputs, i, output_shapes[i],
+                                    &output_tensor));
+      } else {
+        OP_REQUIRES_OK(op_ctx_, op_ctx_->allocate_output(i, output_shapes[i],
+                                                         &output_tensor));
+      }
     }
 
     output_tensors_.push_back(output_tensor);
@@ -186,6 +315,11 @@ DmlBuffer DmlKernelContext::AllocateDefaultBuffer(uint64_t num_bytes) const {
   return DmlBuffer(device_->GetAllocator(), num_bytes);
 }
 
+DmlScratchBuffer DmlKernelContext::AllocateScratchBuffer(
+    uint64_t num_bytes) const {
+  return device_->GetScratchPool()->Acquire(num_bytes);
+}
+
 D3D12BufferRegion DmlKernelContext::CreateBufferForTensor(
     const Tensor& tensor) const {
   return dml_util::CreateBufferForTensor(device_, tensor);
@@ -201,10 +335,8 @@ void DmlKernelContext::EnqueueCallbackForGpuEvent(
   device_->GetEventQueue()->Enqueue(std::move(gpu_event), std::move(callback));
 }
 
-DmlGpuEvent DmlKernelContext::BindAndExecuteOperator(
-    IDMLCompiledOperator* op,
-    Microsoft::WRL::ComPtr<IDMLBindingTable>&& binding_table,
-    ID3D12DescriptorHeap* heap_for_binding_table,
+/*static*/ void DmlKernelContext::UpdateBindings(
+    IDMLBindingTable* binding_table,
     _In_opt_ const DML_BUFFER_BINDING* temporary_resource_binding,
     _In_opt_ const DML_BUFFER_BINDING* persistent_resource_binding,
     absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
@@ -250,9 +382,42 @@ DmlGpuEvent DmlKernelContext::BindAndExecuteOperator(
   }
   binding_table->BindOutputs(static_cast<UINT>(output_binding_descs.size()),
                              output_binding_descs.data());
+}
+
+DmlGpuEvent DmlKernelContext::BindAndExecuteOperator(
+    IDMLCompiledOperator* op,
+    Microsoft::WRL::ComPtr<IDMLBindingTable>&& binding_table,
+    ID3D12DescriptorHeap* heap_for_binding_table,
+    _In_opt_ const DML_BUFFER_BINDING* temporary_resource_binding,
+    _In_opt_ const DML_BUFFER_BINDING* persistent_resource_binding,
+    absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
+    absl::Span<const absl::optional<DML_BUFFER_BINDING>> output_bindings) {
+  UpdateBindings(binding_table.Get(), temporary_resource_binding,
+                 persistent_resource_binding, input_bindings, output_bindings);
+
+  DmlExecutionContext* execution_context = device_->GetExecutionContext();
+
+  // Only pay for the name copy while a profiler session is capturing GPU
+  // timings; the node name lets the profiler attribute the dispatch to this
+  // node rather than the (shared) compiled operator's type.
+  std::string op_name;
+  if (execution_context->IsGpuProfilingActive()) {
+    op_name = op_ctx_->op_kernel().name();
+  }
+
+  return execution_context->ExecuteOperator(op, std::move(binding_table),
+                                            heap_for_binding_table,
+                                            std::move(op_name));
+}
+
+DmlGpuEvent DmlKernelContext::ExecutePrerecordedCommandList(
+    Microsoft::WRL::ComPtr<ID3D12CommandList> command_list) const {
+  return device_->GetExecutionContext()->ExecutePrerecordedCommandList(
+      std::move(command_list));
+}
 
-  return device_->GetExecutionContext()->ExecuteOperator(
-      op, std::move(binding_table), heap_for_binding_table);
+D3D12_COMMAND_LIST_TYPE DmlKernelContext::GetCommandListTypeForQueue() const {
+  return device_->GetExecutionContext()->GetCommandListTypeForQueue();
 }
 
 DmlGpuEvent DmlKernelContext::GetCurrentCompletionEvent() const {
@@ -15,6 +15,10 @@ limitations under the License.
 
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "dml_status.h"
 #include "tensorflow/core/common_runtime/dml/dml_buffer.h"
 #include "tensorflow/core/common_runtime/dml/dml_buffer_region.h"
@@ -28,6 +32,73 @@ namespace tensorflow {
 class DmlDevice;
 class ShapeHelper;
 class InitializationHelper;
+class DmlAllocator;
+class DmlScratchBufferPool;
+
+// A scratch buffer checked out of the device's DmlScratchBufferPool. Returns
+// itself to the pool on destruction; see DmlScratchBufferPool for when that is
+// safe.
+class DmlScratchBuffer {
+ public:
+  DmlScratchBuffer() = default;
+  DmlScratchBuffer(DmlScratchBufferPool* pool, DmlBuffer&& buffer);
+  ~DmlScratchBuffer();
+
+  // Move-only
+  DmlScratchBuffer(const DmlScratchBuffer&) = delete;
+  DmlScratchBuffer& operator=(const DmlScratchBuffer&) = delete;
+  DmlScratchBuffer(DmlScratchBuffer&& other);
+  DmlScratchBuffer& operator=(DmlScratchBuffer&& other);
+
+  ID3D12Resource* Resource() const { return buffer_.Resource(); }
+  uint64_t Offset() const { return buffer_.Offset(); }
+  uint64_t SizeInBytes() const { return buffer_.SizeInBytes(); }
+  DML_BUFFER_BINDING GetBufferBinding() const {
+    return buffer_.GetBufferBinding();
+  }
+
+  explicit operator bool() const { return !!buffer_; }
+
+ private:
+  DmlScratchBufferPool* pool_ = nullptr;  // weak; owned by the device state
+  DmlBuffer buffer_;
+};
+
+// Size-bucketed pool of device buffers for DML operators' temporary
+// resources. Temporary resources are only live while their dispatch executes,
+// and the execution context serializes all dispatches on one timeline, so a
+// buffer released after its dispatch is recorded can be handed to the very
+// next dispatch without waiting for the GPU: the second dispatch can't begin
+// until the first has retired. Allocating temporaries straight from the
+// allocator instead keeps one buffer alive per in-flight dispatch (each is
+// only freed when its completion event fires), so under deep pipelining the
+// same scratch demand costs many times the memory.
+//
+// A checked-out buffer must therefore only be released (destroyed) after the
+// dispatch binding it has been queued on the execution context. Released
+// buffers above the pool's retention cap fall back to the allocator, which is
+// safe for the same ordering reason.
+class DmlScratchBufferPool {
+ public:
+  explicit DmlScratchBufferPool(DmlAllocator* allocator);
+
+  // Returns a buffer at least size_in_bytes large, reusing a pooled buffer
+  // when one is available. The returned object evaluates to false if the
+  // allocator is out of memory.
+  DmlScratchBuffer Acquire(uint64_t size_in_bytes);
+
+ private:
+  friend class DmlScratchBuffer;
+  void Release(DmlBuffer&& buffer);
+
+  DmlAllocator* allocator_;  // weak; owned by the device state
+
+  std::mutex mutex_;
+  uint64_t pooled_bytes_ = 0;
+
+  // Pooled buffers keyed by their power-of-two bucket size.
+  std::map<uint64_t, std::vector<DmlBuffer>> buckets_;
+};
 
 // Context supplied to a DML kernel during construction.
 class DmlKernelConstruction {
@@ -48,9 +119,23 @@ class DmlKernelConstruction {
   // pool.
   DmlBuffer AllocateDefaultBuffer(uint64_t num_bytes) const;
 
+  // Acquires a buffer at least num_bytes large from the device's scratch
+  // pool, for use as an operator's temporary resource. The returned object
+  // must be destroyed only after the dispatch binding it has been queued on
+  // the execution context; see DmlScratchBufferPool.
+  DmlScratchBuffer AllocateScratchBuffer(uint64_t num_bytes) const;
+
   // Retrives the D3D12 default heap buffer backing the specified tensor.
   D3D12BufferRegion CreateBufferForTensor(const Tensor& tensor) const;
 
+  // Returns an immutable GPU buffer containing the given bytes, shared with
+  // any other kernel that requested identical contents from the device's
+  // constant pool. The returned buffer must never be written to; kernels
+  // should hold the shared_ptr for their lifetime and may bind the buffer as
+  // an input on every Compute.
+  StatusOr<std::shared_ptr<const DmlBuffer>> AcquireConstantBuffer(
+      absl::Span<const uint8_t> data) const;
+
   // Allocates a range of D3D12 descriptors at least size_in_descriptors large.
   // When the returned object is destructed, the descriptors are freed back to
   // the pool.
@@ -148,6 +233,12 @@ class DmlKernelContext {
   // pool.
   DmlBuffer AllocateDefaultBuffer(uint64_t num_bytes) const;
 
+  // Acquires a buffer at least num_bytes large from the device's scratch
+  // pool, for use as an operator's temporary resource. The returned object
+  // must be destroyed only after the dispatch binding it has been queued on
+  // the execution context; see DmlScratchBufferPool.
+  DmlScratchBuffer AllocateScratchBuffer(uint64_t num_bytes) const;
+
   // Retrives the D3D12 default heap buffer backing the specified tensor.
   D3D12BufferRegion CreateBufferForTensor(const Tensor& tensor) const;
 
@@ -162,6 +253,17 @@ class DmlKernelContext {
   void EnqueueCallbackForGpuEvent(DmlGpuEvent gpu_event,
                                   std::function<void()> callback) const;
 
+  // Writes the given buffer bindings into a binding table. This is all of the
+  // binding work performed by BindAndExecuteOperator, split out so that
+  // kernels replaying a pre-recorded dispatch can rewrite the bindings of an
+  // existing table without re-recording the dispatch itself.
+  static void UpdateBindings(
+      IDMLBindingTable* binding_table,
+      _In_opt_ const DML_BUFFER_BINDING* temporary_resource_binding,
+      _In_opt_ const DML_BUFFER_BINDING* persistent_resource_binding,
+      absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
+      absl::Span<const absl::optional<DML_BUFFER_BINDING>> output_bindings);
+
   // Executes a DML operator. Note that this merely queues the execution; the
   // returned event will enter the signaled state when it completes.
   DmlGpuEvent BindAndExecuteOperator(
@@ -173,6 +275,17 @@ class DmlKernelContext {
       absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
       absl::Span<const absl::optional<DML_BUFFER_BINDING>> output_bindings);
 
+  // Splices a pre-recorded command list into the device's command sequence.
+  // Note that this merely queues the execution; the returned event will enter
+  // the signaled state when it completes. The caller is responsible for
+  // keeping the command list alive (and not resetting it) until then.
+  DmlGpuEvent ExecutePrerecordedCommandList(
+      Microsoft::WRL::ComPtr<ID3D12CommandList> command_list) const;
+
+  // Returns the type of command list that can be submitted to the device's
+  // compute queue.
+  D3D12_COMMAND_LIST_TYPE GetCommandListTypeForQueue() const;
+
   // Copies src to dst (dst needs to be at at least as big as src)
   DmlGpuEvent CopyBufferToBuffer(ID3D12Resource* dst, uint64_t dst_offset,
                                  ID3D12Resource* src, uint64_t src_offset,
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/dml/dml_kernel_manager.h"
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
@@ -30,7 +31,84 @@ static size_t GetMaxCacheSize() {
   return DmlKernelManager::kDefaultMaxCacheSize;
 }
 
-DmlKernelManager::DmlKernelManager() : max_cache_size_(GetMaxCacheSize()) {}
+// Returns the thread pool used for async kernel compilation, or null if async
+// compilation is disabled (the default). When enabled, DmlKernel construction
+// is handed off to this pool so that concurrent cache misses on the same key
+// are deduplicated and the number of simultaneous DML operator compilations is
+// bounded, instead of shape churn saturating the inter-op thread pool with
+// redundant compiles.
+static std::unique_ptr<thread::ThreadPool> CreateCompilationPool() {
+  bool async_compilation = false;
+  Status s = ReadBoolFromEnvVar("TF_DIRECTML_ASYNC_KERNEL_COMPILATION", false,
+                                &async_compilation);
+
+  if (!s.ok() || !async_compilation) {
+    return nullptr;
+  }
+
+  int64 num_threads = 0;
+  s = ReadInt64FromEnvVar("TF_DIRECTML_KERNEL_COMPILE_THREADS", 2,
+                          &num_threads);
+
+  if (!s.ok() || num_threads <= 0) {
+    num_threads = 2;
+  }
+
+  return absl::make_unique<thread::ThreadPool>(
+      Env::Default(), "dml_kernel_compile", static_cast<int>(num_threads));
+}
+
+DmlKernelManager::DmlKernelManager()
+    : max_cache_size_(GetMaxCacheSize()),
+      compilation_pool_(CreateCompilationPool()) {}
+
+DmlKernelManager::DmlKernelManager(
+    std::unique_ptr<DmlPersistentKernelCache> persistent_cache)
+    : max_cache_size_(GetMaxCacheSize()),
+      persistent_cache_(std::move(persistent_cache)),
+      compilation_pool_(CreateCompilationPool()) {}
+
+std::shared_ptr<DmlKernel> DmlKernelManager::CompileDeduplicated(
+    const DmlKernelKey& key,
+    const std::function<std::shared_ptr<DmlKernel>()>& compile_fn) const {
+  assert(compilation_pool_ != nullptr);
+
+  auto inflight = std::make_shared<InflightCompilation>();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // If another thread is already compiling a kernel for this key, wait for
+    // its result instead of compiling a duplicate that kernel_cache_ would
+    // discard on insertion anyway.
+    auto result = inflight_compilations_.emplace(key.Clone(), inflight);
+    if (!result.second) {
+      inflight = result.first->second;
+      lock.unlock();
+
+      inflight->done.WaitForNotification();
+      return inflight->kernel;
+    }
+  }
+
+  // This thread owns the compilation. `compile_fn` captures state on this
+  // thread's stack, which remains valid because we block on `done` below.
+  // `inflight` is captured by value so the closure stays safe even after the
+  // notification releases this thread.
+  compilation_pool_->Schedule([inflight, &compile_fn]() {
+    inflight->kernel = compile_fn();
+    inflight->done.Notify();
+  });
+
+  inflight->done.WaitForNotification();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    inflight_compilations_.erase(key);
+  }
+
+  return inflight->kernel;
+}
 
 void DmlKernelManager::TrimCache() const {
   assert(lru_list_.size() == kernel_cache_.size());
@@ -40,17 +118,95 @@ void DmlKernelManager::TrimCache() const {
     return;
   }
 
-  // Find the least-recently used element
+  // Pick a victim from a window of the least-recently-used entries rather
+  // than blindly taking the back of the list: a cheap elementwise kernel that
+  // takes microseconds to rebuild is a better eviction than a Conv2D whose
+  // compiled operator took tens of milliseconds, even if the Conv2D is
+  // slightly colder. Within the window, entries recorded in the persistent
+  // manifest (known-hot across process restarts) are preferred as survivors,
+  // and ties are broken by recompile cost.
+  constexpr size_t kEvictionWindow = 16;
+
   const DmlKernelKey* lru_key = lru_list_.back();
+  bool victim_in_manifest = true;
+  uint64 victim_cost_us = UINT64_MAX;
+
+  size_t scanned = 0;
+  for (auto it = lru_list_.rbegin();
+       it != lru_list_.rend() && scanned < kEvictionWindow; ++it, ++scanned) {
+    auto cache_it = kernel_cache_.find(**it);
+    assert(cache_it != kernel_cache_.end());
+
+    bool in_manifest = persistent_cache_ &&
+                       persistent_cache_->Contains(cache_it->second.key_hash);
+    uint64 cost_us = cache_it->second.compile_cost_us;
+
+    if ((!in_manifest && victim_in_manifest) ||
+        (in_manifest == victim_in_manifest && cost_us < victim_cost_us)) {
+      lru_key = *it;
+      victim_in_manifest = in_manifest;
+      victim_cost_us = cost_us;
+    }
+  }
 
-  VLOG(3) << "DmlKernelManager: evicting '" << lru_key->op_type_name
-          << "' from cache, key=0x" << lru_key;
+  auto victim_it = kernel_cache_.find(*lru_key);
+  assert(victim_it != kernel_cache_.end());
+  EvictEntryLocked(victim_it);
+}
+
+void DmlKernelManager::EvictEntryLocked(
+    std::unordered_map<DmlKernelKey, CacheEntry,
+                       hash<DmlKernelKey>>::iterator victim_it) const {
+  ++evictions_;
+  dml_metrics::RecordKernelCacheEviction();
+
+  VLOG(3) << "DmlKernelManager: evicting '" << victim_it->first.op_type_name
+          << "' from cache, key=0x" << &victim_it->first
+          << ", compile_cost_us=" << victim_it->second.compile_cost_us
+          << ", resident_bytes=" << victim_it->second.resident_bytes
+          << " (hits=" << hits_ << ", misses=" << misses_
+          << ", evictions=" << evictions_ << ")";
+
+  assert(resident_bytes_ >= victim_it->second.resident_bytes);
+  resident_bytes_ -= victim_it->second.resident_bytes;
 
   // Erase it from the LRU list and the cache
-  lru_list_.pop_back();
-  size_t elements_removed = kernel_cache_.erase(*lru_key);
+  lru_list_.erase(victim_it->second.lru_iter);
+  kernel_cache_.erase(victim_it);
+}
+
+void DmlKernelManager::TrimCacheToBytes(uint64 target_bytes) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (resident_bytes_ <= target_bytes) {
+    return;
+  }
+
+  // Walk from the least-recently-used end, collecting victims until the
+  // remaining entries fit. Entries which pin no persistent resource are left
+  // alone: evicting them frees nothing and only forces recompiles. Unlike the
+  // count-based path, recompile cost doesn't weigh in here - under memory
+  // pressure, resident bytes are what hurt.
+  std::vector<const DmlKernelKey*> victims;
+  uint64 remaining_bytes = resident_bytes_;
+  for (auto it = lru_list_.rbegin();
+       it != lru_list_.rend() && remaining_bytes > target_bytes; ++it) {
+    auto cache_it = kernel_cache_.find(**it);
+    assert(cache_it != kernel_cache_.end());
+
+    if (cache_it->second.resident_bytes == 0) {
+      continue;
+    }
+
+    remaining_bytes -= cache_it->second.resident_bytes;
+    victims.push_back(*it);
+  }
 
-  assert(elements_removed == 1);
+  for (const DmlKernelKey* victim : victims) {
+    auto victim_it = kernel_cache_.find(*victim);
+    assert(victim_it != kernel_cache_.end());
+    EvictEntryLocked(victim_it);
+  }
 }
 
 void DmlKernelManager::OnRecentlyUsed(const DmlKernelKey* key,
@@ -67,9 +223,14 @@ void DmlKernelManager::OnRecentlyUsed(const DmlKernelKey* key,
 }
 
 void DmlKernelManager::OnKernelCreation(const DmlKernelKey* key,
+                                        uint64 key_hash,
                                         DmlKernel* kernel) const {
   VLOG(3) << "DmlKernelManager: instantating '" << key->op_type_name
           << "' kernel, key=0x" << key << ", kernel=0x" << kernel;
+
+  if (persistent_cache_) {
+    persistent_cache_->Add(key_hash);
+  }
 }
 
 void DmlKernelManager::QueueReference(std::shared_ptr<DmlKernel> kernel,
@@ -123,10 +284,27 @@ size_t DmlKernelManager::GetCacheSize() const {
   return kernel_cache_.size();
 }
 
-void DmlKernelManager::ClearCache() {
+uint64 DmlKernelManager::GetResidentBytes() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return resident_bytes_;
+}
+
+DmlKernelManager::CacheStats DmlKernelManager::GetCacheStats() const {
   std::unique_lock<std::mutex> lock(mutex_);
-  lru_list_.clear();
-  kernel_cache_.clear();
+  return CacheStats{hits_, misses_, evictions_};
+}
+
+void DmlKernelManager::ClearCache() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    lru_list_.clear();
+    kernel_cache_.clear();
+    resident_bytes_ = 0;
+  }
+
+  if (persistent_cache_) {
+    persistent_cache_->Save();
+  }
 }
 
 }  // namespace tensorflow
\ No newline at end of file
@@ -15,12 +15,18 @@ limitations under the License.
 
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "tensorflow/core/common_runtime/dml/dml_common.h"
 #include "tensorflow/core/common_runtime/dml/dml_gpu_event.h"
 #include "tensorflow/core/common_runtime/dml/dml_kernel_context.h"
 #include "tensorflow/core/common_runtime/dml/dml_kernel_key.h"
+#include "tensorflow/core/common_runtime/dml/dml_metrics.h"
+#include "tensorflow/core/common_runtime/dml/dml_persistent_kernel_cache.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
@@ -53,6 +59,12 @@ class DmlKernelManager {
 
   DmlKernelManager();
 
+  // The persistent cache records the key hash of every kernel compiled during
+  // this run and protects kernels seen in previous runs from LRU eviction. May
+  // be null, in which case on-disk persistence is disabled.
+  explicit DmlKernelManager(
+      std::unique_ptr<DmlPersistentKernelCache> persistent_cache);
+
   template <typename TKernel>
   std::shared_ptr<TKernel> CreateCachedKernel(
       DmlKernelConstruction* ctx, const DmlKernelKey& key,
@@ -61,9 +73,31 @@ class DmlKernelManager {
                   "Kernel type does not inherit from DmlKernel");
 
     // Create a new kernel. Because this can potentially be
-    // slow, we don't hold the lock over the kernel creation.
-    auto kernel = std::make_shared<TKernel>(ctx, init_helper);
-    OnKernelCreation(&key, kernel.get());
+    // slow, we don't hold the lock over the kernel creation. The wall-clock
+    // cost of construction (which includes DML operator compilation) is
+    // recorded so that eviction can weigh recency against recompile cost.
+    uint64 start_us = Env::Default()->NowMicros();
+
+    std::shared_ptr<DmlKernel> kernel;
+    if (compilation_pool_) {
+      // Route construction through the compilation pool. Concurrent cache
+      // misses on the same key collapse into one compilation (the losers wait
+      // for the winner's kernel instead of compiling duplicates that would be
+      // discarded on insertion), and the number of simultaneous DML operator
+      // compilations is bounded by the pool size rather than by the inter-op
+      // thread pool.
+      kernel = CompileDeduplicated(key, [&]() -> std::shared_ptr<DmlKernel> {
+        return std::make_shared<TKernel>(ctx, init_helper);
+      });
+    } else {
+      kernel = std::make_shared<TKernel>(ctx, init_helper);
+    }
+
+    uint64 compile_cost_us = Env::Default()->NowMicros() - start_us;
+    dml_metrics::RecordKernelCompile(compile_cost_us);
+
+    uint64 key_hash = DmlKernelKeyHash(key);
+    OnKernelCreation(&key, key_hash, kernel.get());
 
     // Make a deep copy of the key so that we own the memory
     auto key_copy = key.Clone();
@@ -72,6 +106,9 @@ class DmlKernelManager {
 
     CacheEntry entry = {};
     entry.kernel = kernel;
+    entry.key_hash = key_hash;
+    entry.compile_cost_us = compile_cost_us;
+    entry.resident_bytes = kernel->GetPersistentResourceSize();
 
     // Another thread may have already inserted an instance of this kernel
     // into the cache while we weren't holding the lock. That's okay; in this
@@ -87,6 +124,7 @@ class DmlKernelManager {
       // If this was a newly-inserted cache entry, also add an LRU entry
       lru_list_.push_front(&it->first);
       it->second.lru_iter = lru_list_.begin();
+      resident_bytes_ += it->second.resident_bytes;
     }
 
     // Update the LRU cache
@@ -96,7 +134,7 @@ class DmlKernelManager {
       TrimCache();
     }
 
-    return kernel;
+    return std::static_pointer_cast<TKernel>(kernel);
   }
 
   template <typename TKernel>
@@ -109,8 +147,12 @@ class DmlKernelManager {
     auto it = kernel_cache_.find(key);
 
     if (it == kernel_cache_.end()) {
+      ++misses_;
+      dml_metrics::RecordKernelCacheMiss();
       return nullptr;
     }
+    ++hits_;
+    dml_metrics::RecordKernelCacheHit();
 
     // Update the LRU cache
     OnRecentlyUsed(&it->first, &it->second);
@@ -131,6 +173,25 @@ class DmlKernelManager {
   // Returns the number of cached kernels.
   size_t GetCacheSize() const;
 
+  // Returns the total persistent GPU resources pinned by cached kernels, in
+  // bytes.
+  uint64 GetResidentBytes() const;
+
+  // Evicts cached kernels, least-recently-used first, until their pinned
+  // persistent resources total at most `target_bytes`. Entries which pin no
+  // persistent resource are skipped - evicting them frees no video memory.
+  // Called by the budget manager under video memory pressure; the entry-count
+  // cap still applies independently.
+  void TrimCacheToBytes(uint64 target_bytes) const;
+
+  // Cache effectiveness counters, cumulative since process start.
+  struct CacheStats {
+    uint64 hits;
+    uint64 misses;
+    uint64 evictions;
+  };
+  CacheStats GetCacheStats() const;
+
   // Frees all cached kernels which have completed execution on the GPU.
   void ClearCache();
 
@@ -144,6 +205,18 @@ class DmlKernelManager {
   struct CacheEntry {
     std::shared_ptr<DmlKernel> kernel;
 
+    // The DmlKernelKeyHash of the key for this entry, stored so that eviction
+    // doesn't need to recompute it.
+    uint64 key_hash;
+
+    // How long this kernel took to construct (and compile), in microseconds.
+    // Eviction prefers victims that are cheap to recompile.
+    uint64 compile_cost_us;
+
+    // Size in bytes of the persistent GPU resource this entry keeps resident
+    // for as long as it stays cached.
+    uint64 resident_bytes;
+
     // An iterator into the lru_list_. The position of this iterator in the list
     // indicates how recently used this cache entry is.
     std::list<LruEntry>::iterator lru_iter;
@@ -154,18 +227,46 @@ class DmlKernelManager {
     DmlGpuEvent gpu_event;
   };
 
+  // Tracks a kernel construction in progress on the compilation pool, so that
+  // concurrent requests for the same key can wait for the first result instead
+  // of compiling duplicates.
+  struct InflightCompilation {
+    Notification done;
+    std::shared_ptr<DmlKernel> kernel;  // Valid once `done` is notified
+  };
+
+  // Runs `compile_fn` on the compilation pool, deduplicating concurrent
+  // compilations of the same key. Blocks the calling thread until the kernel
+  // is available. Only called when compilation_pool_ is non-null.
+  std::shared_ptr<DmlKernel> CompileDeduplicated(
+      const DmlKernelKey& key,
+      const std::function<std::shared_ptr<DmlKernel>()>& compile_fn) const;
+
   // Trims the cache by least recently used until it's below the max cache size.
   void TrimCache() const;
 
+  // Removes a single cache entry, updating the LRU list, resident-byte total
+  // and eviction counters. `victim_it` must be a valid kernel_cache_ iterator.
+  void EvictEntryLocked(
+      std::unordered_map<DmlKernelKey, CacheEntry,
+                         hash<DmlKernelKey>>::iterator victim_it) const;
+
   // Marks the cache entry as being recently used, for the purposes of the LRU
   // cache. `key` and `entry` must be pointers into elements of the
   // kernel_cache_ map.
   void OnRecentlyUsed(const DmlKernelKey* key, CacheEntry* entry) const;
 
-  void OnKernelCreation(const DmlKernelKey* key, DmlKernel* kernel) const;
+  void OnKernelCreation(const DmlKernelKey* key, uint64 key_hash,
+                        DmlKernel* kernel) const;
 
   mutable std::mutex mutex_;
   const size_t max_cache_size_;
+  const std::unique_ptr<DmlPersistentKernelCache> persistent_cache_;
+
+  // Non-null only when async compilation is enabled via the
+  // TF_DIRECTML_ASYNC_KERNEL_COMPILATION environment variable. Not guarded by
+  // mutex_; the pool itself is thread-safe.
+  const std::unique_ptr<thread::ThreadPool> compilation_pool_;
 
   // All of these members are protected by mutex_
 
@@ -176,6 +277,19 @@ class DmlKernelManager {
   mutable std::list<LruEntry> lru_list_;
 
   mutable std::vector<QueuedReference> queued_references_;
+
+  // Kernel constructions currently running on the compilation pool.
+  mutable std::unordered_map<DmlKernelKey, std::shared_ptr<InflightCompilation>,
+                             hash<DmlKernelKey>>
+      inflight_compilations_;
+
+  // Cache effectiveness counters (see GetCacheStats).
+  mutable uint64 hits_ = 0;
+  mutable uint64 misses_ = 0;
+  mutable uint64 evictions_ = 0;
+
+  // Sum of resident_bytes over all cache entries (see GetResidentBytes).
+  mutable uint64 resident_bytes_ = 0;
 };
 
 }  // namespace tensorflow
\ No newline at end of file
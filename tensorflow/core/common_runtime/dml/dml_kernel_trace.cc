@@ -0,0 +1,289 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_kernel_trace.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "dml_bfc_allocator.h"
+#include "dml_device.h"
+#include "dml_device_cache.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Reserved attr names carrying the execution record. Leading underscores keep
+// NodeDef validation happy when the record is fed back through CreateOpKernel.
+constexpr char kInputDtypesAttr[] = "_trace_input_dtypes";
+constexpr char kInputShapesAttr[] = "_trace_input_shapes";
+constexpr char kHostInputIndicesAttr[] = "_trace_host_input_indices";
+constexpr char kHostInputValuesAttr[] = "_trace_host_input_values";
+constexpr char kDurationAttr[] = "_trace_duration_us";
+
+}  // namespace
+
+/*static*/ DmlKernelTrace* DmlKernelTrace::Instance() {
+  static DmlKernelTrace* instance = new DmlKernelTrace();
+  return instance;
+}
+
+DmlKernelTrace::DmlKernelTrace() {
+  string path;
+  Status s = ReadStringFromEnvVar("TF_DIRECTML_KERNEL_TRACE", "", &path);
+  if (!s.ok() || path.empty()) {
+    return;
+  }
+
+  s = Env::Default()->NewWritableFile(path, &file_);
+  if (!s.ok()) {
+    LOG(WARNING) << "TF_DIRECTML_KERNEL_TRACE: cannot open '" << path
+                 << "' for writing: " << s.ToString();
+    return;
+  }
+
+  writer_ = absl::make_unique<io::RecordWriter>(file_.get());
+  LOG(INFO) << "DirectML: recording kernel execution trace to " << path;
+}
+
+void DmlKernelTrace::RecordExecution(const NodeDef& node_def,
+                                     OpKernelContext* ctx,
+                                     uint64 duration_us) {
+  NodeDef record = node_def;
+
+  AttrValue dtypes, shapes, host_indices, host_values, duration;
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    // Refs alias live variables and resources/variants hold host-side
+    // objects; none of them can be reconstructed from a log.
+    const DataType dtype = BaseType(ctx->input_dtype(i));
+    if (ctx->input_is_ref(i) || dtype == DT_RESOURCE || dtype == DT_VARIANT) {
+      VLOG(1) << "DmlKernelTrace: skipping '" << node_def.name()
+              << "' (input " << i << " is not replayable)";
+      return;
+    }
+
+    const Tensor& tensor = ctx->input(i);
+    dtypes.mutable_list()->add_type(tensor.dtype());
+    tensor.shape().AsProto(shapes.mutable_list()->add_shape());
+
+    if (ctx->input_memory_type(i) == HOST_MEMORY &&
+        DataTypeCanUseMemcpy(tensor.dtype())) {
+      host_indices.mutable_list()->add_i(i);
+      tensor.AsProtoTensorContent(host_values.mutable_list()->add_tensor());
+    }
+  }
+  duration.set_i(static_cast<int64>(duration_us));
+
+  (*record.mutable_attr())[kInputDtypesAttr] = dtypes;
+  (*record.mutable_attr())[kInputShapesAttr] = shapes;
+  (*record.mutable_attr())[kHostInputIndicesAttr] = host_indices;
+  (*record.mutable_attr())[kHostInputValuesAttr] = host_values;
+  (*record.mutable_attr())[kDurationAttr] = duration;
+
+  mutex_lock lock(mu_);
+  if (writer_ == nullptr) {
+    return;
+  }
+  Status s = writer_->WriteRecord(record.SerializeAsString());
+  // Flush per record: field traces usually end with the process dying, and a
+  // truncated tail record is recoverable while a buffered one is lost.
+  s.Update(writer_->Flush());
+  if (!s.ok()) {
+    LOG(WARNING) << "DmlKernelTrace: write failed, disabling capture: "
+                 << s.ToString();
+    writer_.reset();
+  }
+}
+
+/*static*/ Status DmlKernelTrace::Replay(const string& trace_path,
+                                         uint32_t adapter_index,
+                                         int iterations) {
+  DmlDeviceCache& device_cache = DmlDeviceCache::Instance();
+  if (adapter_index >= device_cache.GetAdapterCount()) {
+    return errors::InvalidArgument("Adapter index ", adapter_index,
+                                   " is out of range; ",
+                                   device_cache.GetAdapterCount(),
+                                   " adapters are present");
+  }
+
+  // Read the whole trace up front so file I/O doesn't perturb the replayed
+  // dispatch timing.
+  std::vector<NodeDef> records;
+  {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(trace_path, &file));
+    io::SequentialRecordReader reader(file.get());
+
+    tstring serialized;
+    Status s;
+    while ((s = reader.ReadRecord(&serialized)).ok()) {
+      NodeDef record;
+      if (!record.ParseFromArray(serialized.data(), serialized.size())) {
+        return errors::DataLoss("Cannot parse trace record ", records.size(),
+                                " in ", trace_path);
+      }
+      records.push_back(std::move(record));
+    }
+    if (!errors::IsOutOfRange(s)) {
+      // A truncated tail record (the process died mid-write) ends the trace;
+      // anything else is a real error.
+      if (!errors::IsDataLoss(s)) {
+        return s;
+      }
+      LOG(WARNING) << "DmlKernelTrace: trace ends with a truncated record; "
+                      "replaying the "
+                   << records.size() << " complete records before it";
+    }
+  }
+  if (records.empty()) {
+    return errors::InvalidArgument("Trace '", trace_path, "' holds no records");
+  }
+
+  const DmlAdapter& adapter = device_cache.GetAdapter(adapter_index);
+  const DmlDeviceState* state = device_cache.GetOrCreateDeviceState(
+      adapter_index, GPUOptions(), adapter.QueryAvailableLocalMemory());
+
+  SessionOptions options;
+  const DeviceAttributes attributes = Device::BuildDeviceAttributes(
+      strings::StrCat("/job:localhost/replica:0/task:0/device:", DEVICE_DML,
+                      ":", adapter_index),
+      DeviceType(DEVICE_DML), Bytes(adapter.QueryAvailableLocalMemory()),
+      DeviceLocality());
+  DmlDevice device(state, options, attributes);
+  Allocator* device_allocator = device.GetAllocator(AllocatorAttributes());
+
+  // Build every kernel and its synthetic inputs once; the iteration loop then
+  // measures dispatch and execution, not construction.
+  struct ReplayStep {
+    std::unique_ptr<OpKernel> kernel;
+    // Owns the input tensors; `inputs` points into it.
+    std::vector<Tensor> input_storage;
+    std::vector<TensorValue> inputs;
+    std::vector<AllocatorAttributes> output_attrs;
+  };
+
+  std::vector<ReplayStep> steps;
+  steps.reserve(records.size());
+  uint64 recorded_total_us = 0;
+
+  for (const NodeDef& record : records) {
+    std::vector<DataType> dtypes;
+    std::vector<TensorShape> input_shapes;
+    std::vector<int32> host_indices;
+    std::vector<Tensor> host_values;
+    int64 duration_us = 0;
+    TF_RETURN_IF_ERROR(GetNodeAttr(record, kInputDtypesAttr, &dtypes));
+    TF_RETURN_IF_ERROR(GetNodeAttr(record, kInputShapesAttr, &input_shapes));
+    TF_RETURN_IF_ERROR(GetNodeAttr(record, kHostInputIndicesAttr,
+                                   &host_indices));
+    TF_RETURN_IF_ERROR(GetNodeAttr(record, kHostInputValuesAttr,
+                                   &host_values));
+    TF_RETURN_IF_ERROR(GetNodeAttr(record, kDurationAttr, &duration_us));
+    recorded_total_us += duration_us;
+
+    if (dtypes.size() != input_shapes.size() ||
+        host_indices.size() != host_values.size()) {
+      return errors::DataLoss("Malformed trace record for node '",
+                              record.name(), "'");
+    }
+
+    ReplayStep step;
+    OpKernel* kernel = nullptr;
+    TF_RETURN_IF_ERROR(CreateOpKernel(DeviceType(DEVICE_DML), &device,
+                                      device_allocator, record,
+                                      TF_GRAPH_DEF_VERSION, &kernel));
+    step.kernel.reset(kernel);
+
+    step.input_storage.reserve(dtypes.size());
+    for (size_t i = 0; i < dtypes.size(); ++i) {
+      auto host_it =
+          std::find(host_indices.begin(), host_indices.end(), int32(i));
+      if (host_it != host_indices.end()) {
+        step.input_storage.push_back(
+            host_values[host_it - host_indices.begin()]);
+      } else {
+        // Synthetic device input. Fresh heap memory arrives zeroed from
+        // D3D12, which every DML kernel accepts as valid input data.
+        Tensor device_tensor(device_allocator, dtypes[i], input_shapes[i]);
+        if (!device_tensor.IsInitialized()) {
+          return errors::ResourceExhausted(
+              "OOM allocating replay input of shape ",
+              input_shapes[i].DebugString(), " for node '", record.name(),
+              "'");
+        }
+        step.input_storage.push_back(std::move(device_tensor));
+      }
+    }
+    for (Tensor& tensor : step.input_storage) {
+      step.inputs.emplace_back(&tensor);
+    }
+
+    step.output_attrs.resize(step.kernel->num_outputs());
+    for (int i = 0; i < step.kernel->num_outputs(); ++i) {
+      if (step.kernel->output_memory_types()[i] == HOST_MEMORY) {
+        step.output_attrs[i].set_on_host(true);
+      }
+    }
+
+    steps.push_back(std::move(step));
+  }
+
+  LOG(INFO) << "DmlKernelTrace: replaying " << steps.size() << " kernels x "
+            << iterations << " iterations (recorded dispatch time "
+            << recorded_total_us << "us)";
+
+  for (int iteration = 0; iteration < std::max(iterations, 1); ++iteration) {
+    const uint64 start_us = Env::Default()->NowMicros();
+
+    for (ReplayStep& step : steps) {
+      OpKernelContext::Params params;
+      params.device = &device;
+      params.op_kernel = step.kernel.get();
+      params.inputs = &step.inputs;
+      params.output_attr_array = step.output_attrs.data();
+      params.op_device_context = device.dml_device_context();
+      params.resource_manager = device.resource_manager();
+      params.frame_iter = FrameAndIter(0, 0);
+
+      OpKernelContext ctx(&params);
+      device.BeginOpRun();
+      step.kernel->Compute(&ctx);
+      device.EndOpRun();
+      if (!ctx.status().ok()) {
+        return Status(ctx.status().code(),
+                      strings::StrCat("Replaying node '", step.kernel->name(),
+                                      "': ", ctx.status().error_message()));
+      }
+    }
+
+    TF_RETURN_IF_ERROR(device.Sync());
+    LOG(INFO) << "DmlKernelTrace: iteration " << iteration << " took "
+              << (Env::Default()->NowMicros() - start_us) << "us";
+  }
+
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <memory>
+
+#include "dml_common.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Records the sequence of DML kernel executions into a replayable trace, so a
+// dispatch sequence observed in production can be re-executed deterministically
+// on a lab machine and profiled under PIX. Capture is enabled by pointing
+// TF_DIRECTML_KERNEL_TRACE at a file path; every kernel the wrapper executes
+// appends one record.
+//
+// Each record is the kernel's own NodeDef in a TFRecord file, annotated with
+// reserved ("_trace_*") attrs holding the input dtypes and shapes, the values
+// of constant CPU inputs (replay needs their real contents - they select
+// shapes, axes, seeds - while device inputs only need their geometry), and the
+// measured CPU-side execution time. That is exactly enough to rebuild the
+// kernel through the normal registration path and re-execute it against
+// synthetic device buffers; kernels with ref, resource, or variant inputs
+// can't be reconstructed from a log and are skipped with a log message.
+class DmlKernelTrace {
+ public:
+  // Singleton; one trace file serves all devices, preserving the interleaved
+  // execution order across them.
+  static DmlKernelTrace* Instance();
+
+  // True when TF_DIRECTML_KERNEL_TRACE named a writable file.
+  bool IsEnabled() const { return writer_ != nullptr; }
+
+  // Appends one execution record. `node_def` is the executing kernel's
+  // stripped NodeDef and `duration_us` the measured wall time of recording
+  // its dispatch. Must only be called when IsEnabled().
+  void RecordExecution(const NodeDef& node_def, OpKernelContext* ctx,
+                       uint64 duration_us);
+
+  // Re-executes the sequence recorded at `trace_path` on the given adapter,
+  // `iterations` times, against freshly allocated (zeroed) device buffers,
+  // then waits for the GPU to drain. Wall time per iteration and the trace's
+  // recorded total are logged for comparison.
+  static Status Replay(const string& trace_path, uint32_t adapter_index,
+                       int iterations);
+
+ private:
+  DmlKernelTrace();
+
+  mutex mu_;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> writer_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
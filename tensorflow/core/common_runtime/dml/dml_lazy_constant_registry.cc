@@ -0,0 +1,46 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_lazy_constant_registry.h"
+
+namespace tensorflow {
+
+/*static*/ DmlLazyConstantRegistry* DmlLazyConstantRegistry::Instance() {
+  static DmlLazyConstantRegistry* instance = new DmlLazyConstantRegistry();
+  return instance;
+}
+
+int64 DmlLazyConstantRegistry::Register(std::function<Status()> materialize) {
+  mutex_lock lock(mu_);
+  int64 id = next_id_++;
+  callbacks_[id] = std::move(materialize);
+  return id;
+}
+
+void DmlLazyConstantRegistry::Deregister(int64 id) {
+  mutex_lock lock(mu_);
+  callbacks_.erase(id);
+}
+
+Status DmlLazyConstantRegistry::MaterializeAll() {
+  mutex_lock lock(mu_);
+  Status status;
+  for (const auto& kvp : callbacks_) {
+    status.Update(kvp.second());
+  }
+  return status;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,60 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <functional>
+#include <map>
+
+#include "dml_common.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Tracks Const kernels on DML devices whose device upload has been deferred
+// to first use (see DmlConstantOp). The registry exists so a caller who wants
+// eager behavior back — e.g. to warm a model that is about to take traffic —
+// can force every deferred upload at once through TFDML_PrefetchConstants
+// instead of paying them one by one on the first Run.
+class DmlLazyConstantRegistry {
+ public:
+  // Singleton; one registry serves all devices.
+  static DmlLazyConstantRegistry* Instance();
+
+  // Registers a callback that uploads one deferred constant. The callback
+  // must be idempotent (a no-op once its constant is materialized) and must
+  // outlive its registration. Returns an id to pass to Deregister.
+  int64 Register(std::function<Status()> materialize);
+
+  // Forgets a registration. Blocks while MaterializeAll is invoking
+  // callbacks, so once this returns the callback will never run again and
+  // the kernel owning it may be destroyed.
+  void Deregister(int64 id);
+
+  // Invokes every registered callback, returning the first error. Callbacks
+  // run under the registry lock; they only upload and never re-enter the
+  // registry.
+  Status MaterializeAll();
+
+ private:
+  DmlLazyConstantRegistry() = default;
+
+  mutex mu_;
+  int64 next_id_ GUARDED_BY(mu_) = 0;
+  std::map<int64, std::function<Status()>> callbacks_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
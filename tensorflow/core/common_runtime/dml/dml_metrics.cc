@@ -0,0 +1,124 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_metrics.h"
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+
+namespace tensorflow {
+namespace dml_metrics {
+namespace {
+
+auto* kernel_cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/directml/kernel_cache/hits",
+    "The number of DML kernel cache lookups that found a compiled kernel.");
+
+auto* kernel_cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/directml/kernel_cache/misses",
+    "The number of DML kernel cache lookups that did not find a compiled "
+    "kernel. A sustained miss rate indicates shape diversity exceeding the "
+    "cache size (see TF_DIRECTML_KERNEL_CACHE_SIZE).");
+
+auto* kernel_cache_evictions = monitoring::Counter<0>::New(
+    "/tensorflow/directml/kernel_cache/evictions",
+    "The number of compiled DML kernels evicted from the cache by the LRU "
+    "policy.");
+
+auto* kernel_compiles = monitoring::Counter<0>::New(
+    "/tensorflow/directml/kernel_cache/compilations",
+    "The number of DML kernels constructed (including DML operator "
+    "compilation).");
+
+auto* kernel_compile_time_usecs = monitoring::Counter<0>::New(
+    "/tensorflow/directml/kernel_cache/compile_time_usecs",
+    "The total wall-clock time spent constructing DML kernels in "
+    "microseconds.");
+
+auto* kernel_compile_time_usecs_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/directml/kernel_cache/compile_time_usecs_histogram",
+     "The wall-clock time spent constructing one DML kernel in microseconds."},
+    // Power of 2 with bucket count 20 (~ half a second)
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+auto* execution_context_flushes = monitoring::Counter<1>::New(
+    "/tensorflow/directml/execution_context/flushes",
+    "The number of command batches submitted to the GPU, by the condition "
+    "that triggered the submission.",
+    "reason");
+
+auto* execution_context_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/directml/execution_context/batch_size",
+     "The number of commands submitted per execution context flush."},
+    // Power of 2 with bucket count 12 (2048 = command ring capacity)
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+auto* execution_context_queue_depth = monitoring::Sampler<0>::New(
+    {"/tensorflow/directml/execution_context/queue_depth",
+     "The number of earlier flushes the GPU had not yet completed when a "
+     "flush was submitted. Persistently zero means the GPU is starved; "
+     "persistently deep means submissions add latency without throughput."},
+    {monitoring::Buckets::Exponential(1, 2, 8)});
+
+auto* host_to_device_copies = monitoring::Counter<1>::New(
+    "/tensorflow/directml/copies/host_to_device",
+    "The number of host-to-device tensor copies, by the path taken: "
+    "'zero_copy' writes through CPU-mapped UMA device memory, 'staged' goes "
+    "through the upload heap.",
+    "path");
+
+auto* execution_context_submit_time_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/directml/execution_context/submit_time_usecs",
+     "The CPU wall time spent recording and submitting one non-empty command "
+     "batch to the GPU, in microseconds."},
+    // Power of 2 with bucket count 16 (~ 32 milliseconds)
+    {monitoring::Buckets::Exponential(1, 2, 16)});
+
+}  // namespace
+
+void RecordKernelCacheHit() { kernel_cache_hits->GetCell()->IncrementBy(1); }
+
+void RecordKernelCacheMiss() {
+  kernel_cache_misses->GetCell()->IncrementBy(1);
+}
+
+void RecordKernelCacheEviction() {
+  kernel_cache_evictions->GetCell()->IncrementBy(1);
+}
+
+void RecordKernelCompile(uint64 compile_time_usecs) {
+  kernel_compiles->GetCell()->IncrementBy(1);
+  kernel_compile_time_usecs->GetCell()->IncrementBy(compile_time_usecs);
+  kernel_compile_time_usecs_histogram->GetCell()->Add(compile_time_usecs);
+}
+
+void RecordExecutionContextFlush(const char* reason, uint64 batch_size,
+                                 uint64 flushes_in_flight) {
+  execution_context_flushes->GetCell(reason)->IncrementBy(1);
+  execution_context_batch_size->GetCell()->Add(batch_size);
+  execution_context_queue_depth->GetCell()->Add(flushes_in_flight);
+}
+
+void RecordExecutionContextSubmit(uint64 submit_time_usecs) {
+  execution_context_submit_time_usecs->GetCell()->Add(
+      static_cast<double>(submit_time_usecs));
+}
+
+void RecordHostToDeviceCopy(const char* path) {
+  host_to_device_copies->GetCell(path)->IncrementBy(1);
+}
+
+}  // namespace dml_metrics
+}  // namespace tensorflow
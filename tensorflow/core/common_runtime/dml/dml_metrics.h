@@ -0,0 +1,62 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace dml_metrics {
+
+// Exports DML runtime health metrics through tensorflow/core/lib/monitoring
+// (under /tensorflow/directml/...), so they are visible to any exporter that
+// scrapes the monitoring collection registry. These complement the in-process
+// counters (DmlKernelManager::GetCacheStats, allocator DebugStrings), which
+// aren't reachable from a metrics endpoint.
+
+// Records a DmlKernelManager cache lookup that found (hit) or didn't find
+// (miss) a compiled kernel.
+void RecordKernelCacheHit();
+void RecordKernelCacheMiss();
+
+// Records the LRU eviction of a compiled kernel from the cache.
+void RecordKernelCacheEviction();
+
+// Records one kernel construction, including DML operator compilation, and
+// how long it took.
+void RecordKernelCompile(uint64 compile_time_usecs);
+
+// Records one DmlExecutionContext flush. `reason` is one of "requested"
+// (explicit Flush or end of an op run), "size" (batch reached the size
+// threshold), "time" (flush interval elapsed), or "catch_up" (empty flush to
+// signal a handed-out fence value). `batch_size` is the number of commands
+// submitted, and `flushes_in_flight` the number of earlier flushes the GPU
+// hadn't completed at submission time (the queue depth).
+void RecordExecutionContextFlush(const char* reason, uint64 batch_size,
+                                 uint64 flushes_in_flight);
+
+// Records the CPU-side cost of one non-empty flush: the wall time spent
+// recording the batch into command lists and submitting them to the queue.
+// Unlike per-op dispatch (sampled by common_runtime/sampling_profiler),
+// flushes are infrequent enough that every one is recorded.
+void RecordExecutionContextSubmit(uint64 submit_time_usecs);
+
+// Records one host-to-device tensor copy. `path` is "zero_copy" when the
+// bytes were written directly through CPU-mapped UMA device memory, or
+// "staged" when they went through the upload heap.
+void RecordHostToDeviceCopy(const char* path);
+
+}  // namespace dml_metrics
+}  // namespace tensorflow
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 
+#include "tensorflow/core/common_runtime/dml/dml_tensor_desc.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -163,4 +167,88 @@ TensorShape ComputeFlatOuterDims(const TensorShape& orig, int64 num_out_dims) {
   return out_dims;
 }
 
+bool IsShapeBucketingEnabled() {
+  static bool is_enabled = [] {
+    bool value = false;
+    Status s = ReadBoolFromEnvVar("TF_DIRECTML_SHAPE_BUCKETING",
+                                  /*default_val=*/false, &value);
+    if (!s.ok()) {
+      value = false;
+    }
+    return value;
+  }();
+  return is_enabled;
+}
+
+bool ShouldApplyShapeBucketing(OpKernelContext* ctx) {
+  if (!IsShapeBucketingEnabled()) {
+    return false;
+  }
+
+  // 64-bit integer tensors are emulated with strided 32-bit descs and can't be
+  // staged through a contiguous desc-sized buffer.
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    if (Is64BitIntegerType(ctx->input_dtype(i))) {
+      return false;
+    }
+  }
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    if (Is64BitIntegerType(ctx->expected_output_dtype(i))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void PadShapesForShapeBucketing(absl::Span<TensorShape> shapes) {
+  // Find the outermost dimension eligible for padding: the largest dim 0 among
+  // the shapes of maximal rank. Padding any other dimension - or a
+  // lower-ranked shape - could turn a numpy-broadcastable combination into an
+  // invalid one.
+  int max_rank = 0;
+  for (const TensorShape& shape : shapes) {
+    max_rank = std::max(max_rank, shape.dims());
+  }
+  if (max_rank == 0) {
+    return;
+  }
+
+  int64 max_dim0 = 0;
+  for (const TensorShape& shape : shapes) {
+    if (shape.dims() == max_rank) {
+      max_dim0 = std::max(max_dim0, shape.dim_size(0));
+    }
+  }
+
+  // Dimensions of 0 or 1 are left alone: empty tensors take the no-op path,
+  // and padding a broadcast dimension would change the operator's meaning.
+  if (max_dim0 <= 1) {
+    return;
+  }
+
+  const int64 bucketed_dim0 = int64{1} << Log2Ceiling64(max_dim0);
+
+  // Skip padding entirely if it would push any shape past what a single DML
+  // dispatch can address. This keeps the rule consistent between the cache key
+  // and the kernel's descs (both call this function), and such shapes instead
+  // go through chunked execution, which requires the true element count.
+  for (const TensorShape& shape : shapes) {
+    if (shape.dims() == max_rank && shape.dim_size(0) == max_dim0) {
+      const uint64_t padded_num_elements =
+          static_cast<uint64_t>(shape.num_elements() / max_dim0) *
+          bucketed_dim0;
+      if (padded_num_elements > kMaxDmlElementsPerDispatch) {
+        return;
+      }
+    }
+  }
+
+  for (TensorShape& shape : shapes) {
+    if (shape.dims() == max_rank && shape.dim_size(0) == max_dim0) {
+      shape.set_dim(0, bucketed_dim0);
+    }
+  }
+}
+
 }  // namespace tensorflow
\ No newline at end of file
@@ -58,6 +58,47 @@ class InitializationHelper {
     return false;
   }
 
+  // Kernels which are logically an identity over one of their inputs (e.g. a
+  // reduction over an empty set of axes) may return the index of that input
+  // here. When the input's buffer isn't referenced elsewhere, the kernel
+  // wrapper forwards it directly to the given output instead of executing the
+  // kernel, which avoids dispatching a GPU copy. Forwarding is best-effort;
+  // kernels which implement this must still handle the identity case
+  // themselves in case the buffer cannot be forwarded.
+  virtual absl::optional<int> GetForwardableInputIndex(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const {
+    return absl::nullopt;
+  }
+
+  // Kernels whose output is a contiguous window of one of their inputs (e.g.
+  // a slice along the outermost non-trivial dimension) may return a tensor
+  // here which aliases the input's buffer at an offset; the kernel wrapper
+  // then emits it as the output instead of executing the kernel. The view
+  // shares the input's reference-counted buffer, so the parent allocation
+  // outlives every consumer of the view and is recycled through the usual
+  // deferred deletion once all references drop. Implementations must only
+  // return a view whose offset and size in bytes are 4-byte aligned, since
+  // DML buffer regions require it.
+  virtual absl::optional<Tensor> GetContiguousInputView(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const {
+    return absl::nullopt;
+  }
+
+  // Element-wise kernels whose output element i depends only on element i of
+  // their inputs (e.g. AddN) may nominate same-shaped device inputs whose
+  // buffers can be reused for the given output. When one of the candidates
+  // isn't referenced elsewhere, its buffer is forwarded to the output and the
+  // kernel executes in place, which avoids allocating a fresh output buffer.
+  // DML permits identical input and output bindings for element-wise
+  // operators, so this must only be implemented by kernels whose final write
+  // is element-wise over the nominated input.
+  virtual absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const {
+    return {};
+  }
+
   virtual ~InitializationHelper() = default;
 };
 
@@ -198,4 +239,31 @@ absl::InlinedVector<T, 5> IntTensorToVec(const tensorflow::Tensor& tensor) {
 TensorShape BroadcastTensorShapes(absl::Span<const TensorShape> shapes);
 TensorShape ComputeFlatOuterDims(const TensorShape& orig, int64 num_out_dims);
 
+// Shape bucketing rounds the outermost dimension of input shapes up to the
+// next power of two before kernels are keyed and compiled, so that workloads
+// with churning dynamic shapes (e.g. a varying batch or sequence dimension)
+// share one cached operator per bucket instead of compiling one per shape.
+// Kernels opt in per init helper (see BucketedElementWiseInitHelper); the
+// kernel wrapper pads the cache key with the same rule, and DmlKernel::Compute
+// stages tensors through desc-sized buffers when a compiled operator describes
+// more elements than the bound tensors hold. Controlled by the
+// TF_DIRECTML_SHAPE_BUCKETING environment variable and disabled by default.
+bool IsShapeBucketingEnabled();
+
+// Returns true if shape bucketing is enabled and applicable to the given
+// kernel context. 64-bit integer tensors are excluded: they are emulated with
+// strided 32-bit descs whose zero-padding targets the true output buffer, so a
+// staged copy-back would re-import garbage into the stride gaps.
+bool ShouldApplyShapeBucketing(OpKernelContext* ctx);
+
+// Pads `shapes` in place with the bucketing rule. Only the outermost dimension
+// is ever padded, so a tensor's true data always remains a contiguous prefix
+// of its padded extent. To stay broadcast-compatible, the rule is joint over
+// all shapes: only shapes of maximal rank whose outermost dimension equals the
+// largest such dimension are padded (e.g. for {6,5} op {5}, only {6,5} grows
+// to {8,5}; the {5} continues to broadcast). Shapes large enough that padding
+// would exceed kMaxDmlElementsPerDispatch are left unpadded; they take the
+// chunked execution path instead.
+void PadShapesForShapeBucketing(absl::Span<TensorShape> shapes);
+
 }  // namespace tensorflow
\ No newline at end of file
@@ -0,0 +1,301 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Largest number of variables collapsed into one _DmlFusedApplyAdam node.
+// This bounds the compiled graph's size and binding table; a model with 700
+// variables becomes ~11 fused dispatches rather than 700.
+constexpr int kMaxGroupSize = 64;
+
+// Input indices of ResourceApplyAdam.
+enum AdamInput {
+  kVar,
+  kM,
+  kV,
+  kBeta1Power,
+  kBeta2Power,
+  kLr,
+  kBeta1,
+  kBeta2,
+  kEpsilon,
+  kGrad,
+};
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+bool IsFusableApplyAdam(const Node* n) {
+  if (n->type_string() != "ResourceApplyAdam" || !IsDmlDevice(n)) {
+    return false;
+  }
+
+  // The fused kernel only implements the float types the DML Adam kernels
+  // are registered for, and (like them) doesn't implement Nesterov momentum.
+  DataType dtype;
+  if (!TryGetNodeAttr(n->attrs(), "T", &dtype) ||
+      (dtype != DT_FLOAT && dtype != DT_HALF)) {
+    return false;
+  }
+
+  bool use_nesterov;
+  if (TryGetNodeAttr(n->attrs(), "use_nesterov", &use_nesterov) &&
+      use_nesterov) {
+    return false;
+  }
+
+  return true;
+}
+
+// A group of ApplyAdam nodes eligible to collapse into one fused node:
+// same device, same dtype, and the same six scalar input tensors.
+struct GroupKey {
+  string device;
+  DataType dtype;
+  // (node id, output index) of beta1_power/beta2_power/lr/beta1/beta2/epsilon.
+  std::array<std::pair<int, int>, 6> scalar_sources;
+
+  bool operator<(const GroupKey& other) const {
+    return std::tie(device, dtype, scalar_sources) <
+           std::tie(other.device, other.dtype, other.scalar_sources);
+  }
+};
+
+Status MakeGroupKey(const Node* n, GroupKey* key) {
+  key->device = n->assigned_device_name().empty() ? n->requested_device()
+                                                  : n->assigned_device_name();
+  TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "T", &key->dtype));
+
+  for (int i = 0; i < 6; ++i) {
+    const Edge* e;
+    TF_RETURN_IF_ERROR(n->input_edge(kBeta1Power + i, &e));
+    key->scalar_sources[i] = {e->src()->id(), e->src_output()};
+  }
+  return Status::OK();
+}
+
+// Excludes every candidate that is reachable from another candidate.
+// ResourceApplyAdam nodes have no data outputs, but a control path from one
+// to another (however indirect) would become a self-cycle once both collapse
+// into the same node. One forward traversal seeded at all candidates' out
+// edges finds exactly the candidates that depend on an earlier one; dropping
+// those leaves a pairwise-unordered set.
+void ExcludeDependentCandidates(const Graph* g,
+                                std::unordered_set<Node*>* candidates) {
+  std::vector<bool> visited(g->num_node_ids(), false);
+  std::deque<const Node*> queue;
+
+  for (const Node* n : *candidates) {
+    for (const Edge* e : n->out_edges()) {
+      if (!visited[e->dst()->id()]) {
+        visited[e->dst()->id()] = true;
+        queue.push_back(e->dst());
+      }
+    }
+  }
+
+  std::vector<Node*> reached;
+  while (!queue.empty()) {
+    const Node* n = queue.front();
+    queue.pop_front();
+
+    auto it = candidates->find(const_cast<Node*>(n));
+    if (it != candidates->end()) {
+      reached.push_back(*it);
+    }
+
+    for (const Edge* e : n->out_edges()) {
+      if (!visited[e->dst()->id()]) {
+        visited[e->dst()->id()] = true;
+        queue.push_back(e->dst());
+      }
+    }
+  }
+
+  for (Node* n : reached) {
+    candidates->erase(n);
+  }
+}
+
+Status ReplaceGroup(Graph* g, const std::vector<Node*>& group) {
+  Node* first = group.front();
+
+  DataType dtype;
+  TF_RETURN_IF_ERROR(GetNodeAttr(first->attrs(), "T", &dtype));
+
+  // Gather the blocked input lists: all vars, all ms, all vs, the shared
+  // scalars (from the first member; the group key guarantees they're
+  // identical), then all grads.
+  std::vector<NodeBuilder::NodeOut> vars, ms, vs, grads;
+  for (Node* n : group) {
+    const Edge* e;
+    TF_RETURN_IF_ERROR(n->input_edge(kVar, &e));
+    vars.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+    TF_RETURN_IF_ERROR(n->input_edge(kM, &e));
+    ms.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+    TF_RETURN_IF_ERROR(n->input_edge(kV, &e));
+    vs.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+    TF_RETURN_IF_ERROR(n->input_edge(kGrad, &e));
+    grads.push_back(NodeBuilder::NodeOut(e->src(), e->src_output()));
+  }
+
+  std::array<NodeBuilder::NodeOut, 6> scalars;
+  for (int i = 0; i < 6; ++i) {
+    const Edge* e;
+    TF_RETURN_IF_ERROR(first->input_edge(kBeta1Power + i, &e));
+    scalars[i] = NodeBuilder::NodeOut(e->src(), e->src_output());
+  }
+
+  NodeDebugInfo debug_info(*first);
+  NodeBuilder builder(
+      g->NewName(strings::StrCat(first->name(), "/dml_fused_adam")),
+      "_DmlFusedApplyAdam", OpRegistry::Global(), &debug_info);
+
+  Node* fused = nullptr;
+  TF_RETURN_IF_ERROR(builder.Device(first->requested_device())
+                         .Input(vars)
+                         .Input(ms)
+                         .Input(vs)
+                         .Input(scalars[0])
+                         .Input(scalars[1])
+                         .Input(scalars[2])
+                         .Input(scalars[3])
+                         .Input(scalars[4])
+                         .Input(scalars[5])
+                         .Input(grads)
+                         .Attr("T", dtype)
+                         .Attr("N", static_cast<int64>(group.size()))
+                         .Attr("use_locking", true)
+                         .Finalize(g, &fused));
+  fused->set_assigned_device_name(first->assigned_device_name());
+
+  // The members have no data outputs; move every control edge (in and out)
+  // onto the fused node.
+  for (Node* n : group) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+    std::vector<const Edge*> out_edges(n->out_edges().begin(),
+                                       n->out_edges().end());
+    for (const Edge* e : out_edges) {
+      g->AddControlEdge(fused, e->dst());
+    }
+    g->RemoveNode(n);
+  }
+
+  return Status::OK();
+}
+
+// Collapses groups of independent ResourceApplyAdam nodes placed on DML
+// devices into _DmlFusedApplyAdam nodes. The optimizer phase of a large model
+// is otherwise one tiny dispatch per variable, dominated by per-dispatch
+// scheduling rather than math; the fused kernel runs each group as a single
+// compiled DML graph.
+class DmlOptimizerFusionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool fusion_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_OPTIMIZER_FUSION",
+                                          /*default_val=*/true,
+                                          &fusion_enabled));
+    if (!fusion_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    std::unordered_set<Node*> candidates;
+    for (Node* n : g->op_nodes()) {
+      if (IsFusableApplyAdam(n)) {
+        candidates.insert(n);
+      }
+    }
+    if (candidates.size() < 2) {
+      return Status::OK();
+    }
+
+    ExcludeDependentCandidates(g, &candidates);
+
+    std::map<GroupKey, std::vector<Node*>> groups;
+    for (Node* n : candidates) {
+      GroupKey key;
+      TF_RETURN_IF_ERROR(MakeGroupKey(n, &key));
+      groups[key].push_back(n);
+    }
+
+    for (auto& kvp : groups) {
+      std::vector<Node*>& members = kvp.second;
+      if (members.size() < 2) {
+        continue;
+      }
+
+      // Deterministic grouping regardless of hash-set iteration order.
+      std::sort(members.begin(), members.end(),
+                [](const Node* a, const Node* b) { return a->id() < b->id(); });
+
+      for (size_t start = 0; start < members.size(); start += kMaxGroupSize) {
+        size_t count = std::min<size_t>(kMaxGroupSize, members.size() - start);
+        if (count < 2) {
+          break;  // A trailing singleton stays as a plain ResourceApplyAdam.
+        }
+        std::vector<Node*> group(members.begin() + start,
+                                 members.begin() + start + count);
+        VLOG(1) << "DmlOptimizerFusionPass: fusing " << group.size()
+                << " ResourceApplyAdam nodes rooted at '"
+                << group.front()->name() << "'";
+        TF_RETURN_IF_ERROR(ReplaceGroup(g, group));
+      }
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement (device assignments must be known), and after the
+// elementwise fusion pass at phase 25 so chain fusion sees the original
+// graph.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 26,
+                      DmlOptimizerFusionPass);
+
+}  // namespace
+}  // namespace tensorflow
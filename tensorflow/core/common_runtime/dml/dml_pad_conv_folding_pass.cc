@@ -0,0 +1,220 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/tensor_format.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+// Extracts the paddings from a Pad node whose paddings input is a 4x2 Const,
+// flattened to the 8-element explicit_paddings layout (per-dimension
+// before/after pairs in input dimension order, which is the same order
+// explicit_paddings uses). Returns false if the paddings aren't statically
+// known or don't describe a foldable 4-D zero pad.
+bool GetFoldablePaddings(const Node* pad, const string& data_format_str,
+                         std::vector<int32>* explicit_paddings) {
+  const Edge* paddings_edge;
+  if (!pad->input_edge(1, &paddings_edge).ok() ||
+      !paddings_edge->src()->IsConstant()) {
+    return false;
+  }
+  Tensor paddings;
+  if (!GetNodeAttr(paddings_edge->src()->attrs(), "value", &paddings).ok()) {
+    return false;
+  }
+  if (paddings.dims() != 2 || paddings.dim_size(0) != 4 ||
+      paddings.dim_size(1) != 2) {
+    return false;
+  }
+
+  explicit_paddings->resize(8);
+  for (int i = 0; i < 8; ++i) {
+    int64 value;
+    if (paddings.dtype() == DT_INT32) {
+      value = paddings.flat<int32>()(i);
+    } else if (paddings.dtype() == DT_INT64) {
+      value = paddings.flat<int64>()(i);
+    } else {
+      return false;
+    }
+    if (value < 0 || value > std::numeric_limits<int32>::max()) {
+      return false;
+    }
+    (*explicit_paddings)[i] = static_cast<int32>(value);
+  }
+
+  // Explicit padding on Conv2D only covers the spatial dimensions; the batch
+  // and channel rows must be zero.
+  TensorFormat data_format;
+  if (!FormatFromString(data_format_str, &data_format)) {
+    return false;
+  }
+  const int n_dim = GetTensorDimIndex(data_format, 'N');
+  const int c_dim = GetTensorDimIndex(data_format, 'C');
+  return (*explicit_paddings)[2 * n_dim] == 0 &&
+         (*explicit_paddings)[2 * n_dim + 1] == 0 &&
+         (*explicit_paddings)[2 * c_dim] == 0 &&
+         (*explicit_paddings)[2 * c_dim + 1] == 0;
+}
+
+// Absorbs `pad` into `conv` by switching the conv to EXPLICIT padding and
+// rewiring its input to the pad's input, then removes the pad.
+Status FoldPadIntoConv(Graph* g, Node* pad, Node* conv,
+                       const std::vector<int32>& explicit_paddings) {
+  const Edge* pad_input_edge;
+  TF_RETURN_IF_ERROR(pad->input_edge(0, &pad_input_edge));
+  Node* pad_input = pad_input_edge->src();
+  const int pad_input_index = pad_input_edge->src_output();
+
+  const Edge* conv_input_edge;
+  TF_RETURN_IF_ERROR(conv->input_edge(0, &conv_input_edge));
+
+  conv->ClearAttr("padding");
+  conv->AddAttr("padding", "EXPLICIT");
+  conv->ClearAttr("explicit_paddings");
+  conv->AddAttr("explicit_paddings", explicit_paddings);
+
+  g->RemoveEdge(conv_input_edge);
+  g->AddEdge(pad_input, pad_input_index, conv, 0);
+
+  // The pad's control relationships transfer to the conv.
+  for (const Edge* e : pad->in_edges()) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(e->src(), conv);
+    }
+  }
+  std::vector<const Edge*> out_edges(pad->out_edges().begin(),
+                                     pad->out_edges().end());
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(conv, e->dst());
+    }
+  }
+
+  g->RemoveNode(pad);
+  return Status::OK();
+}
+
+// Folds explicit Pad ops into the downstream convolution. DML convolution
+// descriptors express arbitrary start/end padding natively, so a zero Pad
+// feeding a VALID Conv2D is exactly a Conv2D with EXPLICIT padding — without
+// materializing the padded copy of the activations or the intermediate
+// tensor. Graphs exported from frameworks that lower SAME padding to an
+// explicit Pad hit this pattern on every convolution.
+class DmlPadConvFoldingPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool folding_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_PAD_CONV_FOLDING",
+                                          /*default_val=*/true,
+                                          &folding_enabled));
+    if (!folding_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather first, then rewrite, so iteration never walks deleted nodes.
+    struct Candidate {
+      Node* pad;
+      Node* conv;
+      std::vector<int32> explicit_paddings;
+    };
+    std::vector<Candidate> candidates;
+    for (Node* conv : g->op_nodes()) {
+      // Only Conv2D takes the EXPLICIT padding attribute on DML; depthwise
+      // and 3-D convolutions don't, so their pads stay.
+      if (conv->type_string() != "Conv2D" || !IsDmlDevice(conv)) {
+        continue;
+      }
+      string padding;
+      if (!TryGetNodeAttr(conv->attrs(), "padding", &padding) ||
+          padding != "VALID") {
+        // Folding into VALID is exact; merging with SAME or an existing
+        // EXPLICIT padding would change the conv's own implied padding.
+        continue;
+      }
+      const Edge* input_edge;
+      if (!conv->input_edge(0, &input_edge).ok()) {
+        continue;
+      }
+      Node* pad = input_edge->src();
+      if (pad->type_string() != "Pad") {
+        continue;
+      }
+      // The pad must feed only this conv, otherwise it still has to
+      // materialize for its other consumers.
+      bool sole_consumer = true;
+      for (const Edge* e : pad->out_edges()) {
+        if (!e->IsControlEdge() && e != input_edge) {
+          sole_consumer = false;
+          break;
+        }
+      }
+      if (!sole_consumer) {
+        continue;
+      }
+      string data_format;
+      if (!TryGetNodeAttr(conv->attrs(), "data_format", &data_format)) {
+        data_format = "NHWC";
+      }
+      std::vector<int32> explicit_paddings;
+      if (!GetFoldablePaddings(pad, data_format, &explicit_paddings)) {
+        continue;
+      }
+      candidates.push_back({pad, conv, std::move(explicit_paddings)});
+    }
+
+    for (Candidate& candidate : candidates) {
+      VLOG(1) << "DmlPadConvFoldingPass: folding Pad node '"
+              << candidate.pad->name() << "' into Conv2D node '"
+              << candidate.conv->name() << "'";
+      TF_RETURN_IF_ERROR(FoldPadIntoConv(g, candidate.pad, candidate.conv,
+                                         candidate.explicit_paddings));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement so device assignments are known, and before the fill
+// elision pass in case the pad's input becomes dead.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 27,
+                      DmlPadConvFoldingPass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,356 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+// A matched ExtractImagePatches -> Reshape -> MatMul chain, plus the
+// convolution geometry recovered from it.
+struct PatchGemmMatch {
+  Node* patches;
+  Node* reshape;
+  Node* matmul;
+
+  NodeBuilder::NodeOut input;   // The patches node's image input.
+  NodeBuilder::NodeOut weight;  // The matmul's [kh*kw*c, f] weight.
+
+  DataType dtype;
+  std::vector<int32> strides;    // [1, sh, sw, 1]
+  std::vector<int32> dilations;  // [1, rh, rw, 1] (the patches' rates)
+  string padding;
+  int64 kh, kw, c, f;
+};
+
+// Returns true if every non-control output of `n` is the given edge.
+bool IsSoleConsumerEdge(const Node* n, const Edge* edge) {
+  for (const Edge* e : n->out_edges()) {
+    if (!e->IsControlEdge() && e != edge) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads a [1, x, y, 1] attribute list, storing it in `values` and rejecting
+// anything that touches the batch or depth dimension.
+bool GetSpatialOnlyAttr(const Node* n, const char* name,
+                        std::vector<int32>* values) {
+  if (!TryGetNodeAttr(n->attrs(), name, values) || values->size() != 4 ||
+      (*values)[0] != 1 || (*values)[3] != 1 || (*values)[1] < 1 ||
+      (*values)[2] < 1) {
+    return false;
+  }
+  return true;
+}
+
+bool MatchPatchGemm(Node* matmul, PatchGemmMatch* match) {
+  if (matmul->type_string() != "MatMul" || !IsDmlDevice(matmul)) {
+    return false;
+  }
+  bool transpose_a, transpose_b;
+  if (!TryGetNodeAttr(matmul->attrs(), "transpose_a", &transpose_a) ||
+      !TryGetNodeAttr(matmul->attrs(), "transpose_b", &transpose_b) ||
+      transpose_a || transpose_b) {
+    return false;
+  }
+
+  const Edge* reshape_edge;
+  if (!matmul->input_edge(0, &reshape_edge).ok()) {
+    return false;
+  }
+  Node* reshape = reshape_edge->src();
+  if (reshape->type_string() != "Reshape" ||
+      !IsSoleConsumerEdge(reshape, reshape_edge)) {
+    return false;
+  }
+
+  const Edge* patches_edge;
+  if (!reshape->input_edge(0, &patches_edge).ok()) {
+    return false;
+  }
+  Node* patches = patches_edge->src();
+  if (patches->type_string() != "ExtractImagePatches" ||
+      !IsSoleConsumerEdge(patches, patches_edge)) {
+    return false;
+  }
+
+  DataType dtype;
+  if (!TryGetNodeAttr(patches->attrs(), "T", &dtype) ||
+      (dtype != DT_FLOAT && dtype != DT_HALF)) {
+    return false;
+  }
+
+  std::vector<int32> ksizes, strides, rates;
+  if (!GetSpatialOnlyAttr(patches, "ksizes", &ksizes) ||
+      !GetSpatialOnlyAttr(patches, "strides", &strides) ||
+      !GetSpatialOnlyAttr(patches, "rates", &rates)) {
+    return false;
+  }
+  string padding;
+  if (!TryGetNodeAttr(patches->attrs(), "padding", &padding) ||
+      (padding != "SAME" && padding != "VALID")) {
+    return false;
+  }
+  const int64 kh = ksizes[1];
+  const int64 kw = ksizes[2];
+
+  // The weight must be a constant so the patch depth (kh*kw*c) and output
+  // width (f) are statically known; that covers the frozen inference graphs
+  // where patch materialization hurts. Variables would need runtime shapes.
+  const Edge* weight_edge;
+  if (!matmul->input_edge(1, &weight_edge).ok() ||
+      !weight_edge->src()->IsConstant()) {
+    return false;
+  }
+  Tensor weight_value;
+  if (!GetNodeAttr(weight_edge->src()->attrs(), "value", &weight_value).ok() ||
+      weight_value.dims() != 2) {
+    return false;
+  }
+  const int64 patch_depth = weight_value.dim_size(0);
+  const int64 f = weight_value.dim_size(1);
+  if (f < 1 || patch_depth < 1 || patch_depth % (kh * kw) != 0) {
+    return false;
+  }
+  const int64 c = patch_depth / (kh * kw);
+
+  // The interior reshape must be a plain 2-D flatten whose inner dimension is
+  // exactly the patch depth; anything else reorders elements and isn't a
+  // GEMM over patches.
+  const Edge* shape_edge;
+  if (!reshape->input_edge(1, &shape_edge).ok() ||
+      !shape_edge->src()->IsConstant()) {
+    return false;
+  }
+  Tensor shape_value;
+  if (!GetNodeAttr(shape_edge->src()->attrs(), "value", &shape_value).ok() ||
+      shape_value.dims() != 1 || shape_value.NumElements() != 2) {
+    return false;
+  }
+  const int64 inner_dim = shape_value.dtype() == DT_INT32
+                              ? shape_value.flat<int32>()(1)
+                              : shape_value.flat<int64>()(1);
+  if (inner_dim != patch_depth) {
+    return false;
+  }
+
+  const Edge* input_edge;
+  if (!patches->input_edge(0, &input_edge).ok()) {
+    return false;
+  }
+
+  match->patches = patches;
+  match->reshape = reshape;
+  match->matmul = matmul;
+  match->input =
+      NodeBuilder::NodeOut(input_edge->src(), input_edge->src_output());
+  match->weight =
+      NodeBuilder::NodeOut(weight_edge->src(), weight_edge->src_output());
+  match->dtype = dtype;
+  match->strides = std::move(strides);
+  match->dilations = std::move(rates);
+  match->padding = std::move(padding);
+  match->kh = kh;
+  match->kw = kw;
+  match->c = c;
+  match->f = f;
+  return true;
+}
+
+// Adds an int32 vector Const on the matmul's device.
+Status AddShapeConst(Graph* g, const Node* placement_ref, const string& name,
+                     absl::Span<const int32> values, Node** out) {
+  Tensor shape_tensor(DT_INT32, TensorShape({static_cast<int64>(values.size())}));
+  for (size_t i = 0; i < values.size(); ++i) {
+    shape_tensor.flat<int32>()(i) = values[i];
+  }
+
+  TF_RETURN_IF_ERROR(NodeBuilder(g->NewName(name), "Const")
+                         .Device(placement_ref->requested_device())
+                         .Attr("dtype", DT_INT32)
+                         .Attr("value", shape_tensor)
+                         .Finalize(g, out));
+  (*out)->set_assigned_device_name(placement_ref->assigned_device_name());
+  return Status::OK();
+}
+
+// Replaces the matched chain with
+//   Conv2D(input, Reshape(weight, [kh, kw, c, f])) -> Reshape([-1, f])
+// reusing the patches' strides/rates/padding as the conv's strides/dilations/
+// padding.
+Status ReplaceMatch(Graph* g, const PatchGemmMatch& match) {
+  const string& base_name = match.matmul->name();
+
+  Node* filter_shape = nullptr;
+  TF_RETURN_IF_ERROR(AddShapeConst(
+      g, match.matmul, strings::StrCat(base_name, "/dml_patch_gemm/filter_shape"),
+      {static_cast<int32>(match.kh), static_cast<int32>(match.kw),
+       static_cast<int32>(match.c), static_cast<int32>(match.f)},
+      &filter_shape));
+
+  NodeDebugInfo debug_info(*match.matmul);
+
+  Node* filter = nullptr;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(g->NewName(strings::StrCat(base_name, "/dml_patch_gemm/filter")),
+                  "Reshape", OpRegistry::Global(), &debug_info)
+          .Device(match.matmul->requested_device())
+          .Input(match.weight)
+          .Input(filter_shape)
+          .Attr("T", match.dtype)
+          .Attr("Tshape", DT_INT32)
+          .Finalize(g, &filter));
+  filter->set_assigned_device_name(match.matmul->assigned_device_name());
+
+  Node* conv = nullptr;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(g->NewName(strings::StrCat(base_name, "/dml_patch_gemm/conv")),
+                  "Conv2D", OpRegistry::Global(), &debug_info)
+          .Device(match.matmul->requested_device())
+          .Input(match.input)
+          .Input(NodeBuilder::NodeOut(filter, 0))
+          .Attr("T", match.dtype)
+          .Attr("strides", match.strides)
+          .Attr("dilations", match.dilations)
+          .Attr("padding", match.padding)
+          .Attr("data_format", "NHWC")
+          .Finalize(g, &conv));
+  conv->set_assigned_device_name(match.matmul->assigned_device_name());
+
+  Node* out_shape = nullptr;
+  TF_RETURN_IF_ERROR(AddShapeConst(
+      g, match.matmul, strings::StrCat(base_name, "/dml_patch_gemm/out_shape"),
+      {-1, static_cast<int32>(match.f)}, &out_shape));
+
+  Node* flatten = nullptr;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(g->NewName(strings::StrCat(base_name, "/dml_patch_gemm/flatten")),
+                  "Reshape", OpRegistry::Global(), &debug_info)
+          .Device(match.matmul->requested_device())
+          .Input(NodeBuilder::NodeOut(conv, 0))
+          .Input(out_shape)
+          .Attr("T", match.dtype)
+          .Attr("Tshape", DT_INT32)
+          .Finalize(g, &flatten));
+  flatten->set_assigned_device_name(match.matmul->assigned_device_name());
+
+  // The matmul's data consumers move to the flatten; control edges anywhere
+  // in the chain transfer to the new chain's ends.
+  std::vector<const Edge*> out_edges(match.matmul->out_edges().begin(),
+                                     match.matmul->out_edges().end());
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(flatten, e->dst());
+    } else {
+      g->AddEdge(flatten, 0, e->dst(), e->dst_input());
+    }
+    g->RemoveEdge(e);
+  }
+
+  for (Node* n : {match.patches, match.reshape, match.matmul}) {
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), conv);
+      }
+    }
+    if (n != match.matmul) {
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge()) {
+          g->AddControlEdge(flatten, e->dst());
+        }
+      }
+    }
+    g->RemoveNode(n);
+  }
+
+  return Status::OK();
+}
+
+// Rewrites ExtractImagePatches -> Reshape -> MatMul chains on DML devices
+// into an equivalent Conv2D. Extracting patches materializes a tensor
+// ksize_h*ksize_w times larger than the input purely to feed a GEMM over the
+// patch axis, which is exactly the im2col formulation of convolution; DML's
+// convolution operator computes the same contraction as an implicit GEMM,
+// gathering the strided patch windows inside a single dispatch without ever
+// materializing them. The patches' strides become the conv's strides, its
+// rates become dilations, and its padding carries over unchanged, since both
+// ops size their output with the same windowed-output rules.
+class DmlPatchGemmPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_PATCH_GEMM",
+                                          /*default_val=*/true, &enabled));
+    if (!enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather first, then rewrite, so iteration never walks deleted nodes.
+    std::vector<PatchGemmMatch> matches;
+    for (Node* matmul : g->op_nodes()) {
+      PatchGemmMatch match;
+      if (MatchPatchGemm(matmul, &match)) {
+        matches.push_back(std::move(match));
+      }
+    }
+
+    for (const PatchGemmMatch& match : matches) {
+      VLOG(1) << "DmlPatchGemmPass: rewriting patches node '"
+              << match.patches->name() << "' + MatMul node '"
+              << match.matmul->name() << "' as Conv2D (filter "
+              << match.kh << "x" << match.kw << "x" << match.c << "x"
+              << match.f << ")";
+      TF_RETURN_IF_ERROR(ReplaceMatch(g, match));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement so device assignments are known, and before the
+// pad-conv folding pass so a Pad feeding the patches can be absorbed into
+// the synthesized Conv2D.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 26,
+                      DmlPatchGemmPass);
+
+}  // namespace
+}  // namespace tensorflow
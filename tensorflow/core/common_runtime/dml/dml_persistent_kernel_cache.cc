@@ -0,0 +1,151 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_persistent_kernel_cache.h"
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+// The manifest is a line-oriented text file. The first line is a header which
+// identifies the format version; the remaining lines each contain one kernel
+// key hash in hexadecimal.
+static constexpr const char* kManifestHeader = "tfdml-kernel-manifest-v1";
+
+// The adapter/driver identity is baked into the manifest filename so that
+// manifests for different adapters or driver versions never collide.
+static string MakeManifestFileName(const DmlAdapter& adapter) {
+  DriverVersion driver = adapter.DriverVersion();
+  return strings::StrCat(
+      "dml_kernels_", strings::Hex(static_cast<uint32>(adapter.VendorID())),
+      "_", strings::Hex(adapter.DeviceID()), "_", driver.parts.a, ".",
+      driver.parts.b, ".", driver.parts.c, ".", driver.parts.d, ".manifest");
+}
+
+/*static*/ std::unique_ptr<DmlPersistentKernelCache>
+DmlPersistentKernelCache::MaybeCreate(const DmlAdapter& adapter) {
+  const char* cache_dir = getenv("TF_DIRECTML_KERNEL_CACHE_PATH");
+  if (!cache_dir || !*cache_dir) {
+    return nullptr;
+  }
+
+  Status s = Env::Default()->RecursivelyCreateDir(cache_dir);
+  if (!s.ok()) {
+    LOG(WARNING) << "DML persistent kernel cache disabled: could not create "
+                 << "cache directory '" << cache_dir << "': " << s;
+    return nullptr;
+  }
+
+  string manifest_path =
+      io::JoinPath(cache_dir, MakeManifestFileName(adapter));
+
+  // Not using make_unique because the constructor is private
+  auto cache = std::unique_ptr<DmlPersistentKernelCache>(
+      new DmlPersistentKernelCache(std::move(manifest_path)));
+
+  s = cache->LoadManifest();
+  if (!s.ok() && !errors::IsNotFound(s)) {
+    LOG(WARNING) << "DML persistent kernel cache: failed to load manifest '"
+                 << cache->manifest_path_ << "': " << s;
+  }
+
+  return cache;
+}
+
+DmlPersistentKernelCache::DmlPersistentKernelCache(std::string manifest_path)
+    : manifest_path_(std::move(manifest_path)) {}
+
+DmlPersistentKernelCache::~DmlPersistentKernelCache() { Save(); }
+
+bool DmlPersistentKernelCache::Contains(uint64 key_hash) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return key_hashes_.count(key_hash) != 0;
+}
+
+void DmlPersistentKernelCache::Add(uint64 key_hash) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (key_hashes_.insert(key_hash).second) {
+    dirty_ = true;
+  }
+}
+
+void DmlPersistentKernelCache::Save() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!dirty_) {
+      return;
+    }
+    dirty_ = false;
+  }
+
+  Status s = SaveManifest();
+  if (!s.ok()) {
+    LOG(WARNING) << "DML persistent kernel cache: failed to save manifest '"
+                 << manifest_path_ << "': " << s;
+  }
+}
+
+Status DmlPersistentKernelCache::LoadManifest() {
+  string contents;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), manifest_path_, &contents));
+
+  std::vector<absl::string_view> lines =
+      str_util::Split(contents, '\n', str_util::SkipWhitespace());
+
+  if (lines.empty() || lines[0] != kManifestHeader) {
+    // An unrecognized or older manifest format is simply ignored; it will be
+    // overwritten on the next save.
+    return errors::InvalidArgument("Unrecognized manifest header");
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (size_t i = 1; i < lines.size(); ++i) {
+    uint64 key_hash;
+    if (strings::HexStringToUint64(lines[i], &key_hash)) {
+      key_hashes_.insert(key_hash);
+    }
+  }
+  loaded_entry_count_ = key_hashes_.size();
+
+  VLOG(1) << "DML persistent kernel cache: loaded " << loaded_entry_count_
+          << " kernel key hashes from '" << manifest_path_ << "'";
+
+  return Status::OK();
+}
+
+Status DmlPersistentKernelCache::SaveManifest() const {
+  string contents;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    contents.reserve(key_hashes_.size() * 17 + 32);
+    strings::StrAppend(&contents, kManifestHeader, "\n");
+    for (uint64 key_hash : key_hashes_) {
+      strings::StrAppend(&contents, strings::Hex(key_hash), "\n");
+    }
+  }
+
+  // Write to a temporary file first and rename it into place, so that a crash
+  // mid-save never leaves a truncated manifest behind.
+  string tmp_path = strings::StrCat(manifest_path_, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(Env::Default(), tmp_path, contents));
+  return Env::Default()->RenameFile(tmp_path, manifest_path_);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,84 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <mutex>
+#include <unordered_set>
+
+#include "tensorflow/core/common_runtime/dml/dml_adapter.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Persists the set of DML kernel key hashes observed during a process'
+// lifetime to disk, so that a restarted worker knows up front which kernels it
+// compiled in previous runs. DirectML does not expose a way to serialize
+// IDMLCompiledOperator state, so this cache does not store compiled operators
+// themselves; instead, the manifest of previously-seen key hashes is used to
+// protect known-hot kernels from LRU eviction and to drive ahead-of-time
+// warmup of the kernel cache.
+//
+// The manifest is keyed by adapter and driver identity (vendor ID, device ID
+// and driver version), so a driver upgrade or a different adapter naturally
+// invalidates it.
+//
+// This class is thread-safe.
+class DmlPersistentKernelCache {
+ public:
+  // Creates a persistent cache rooted at the directory named by the
+  // TF_DIRECTML_KERNEL_CACHE_PATH environment variable. Returns nullptr if the
+  // environment variable is not set, which disables on-disk persistence
+  // entirely.
+  static std::unique_ptr<DmlPersistentKernelCache> MaybeCreate(
+      const DmlAdapter& adapter);
+
+  // Flushes any unsaved additions to disk.
+  ~DmlPersistentKernelCache();
+
+  // Returns true if the given kernel key hash was seen in a previous run (or
+  // was added earlier in this run).
+  bool Contains(uint64 key_hash) const;
+
+  // Records that a kernel with the given key hash was compiled during this
+  // run.
+  void Add(uint64 key_hash);
+
+  // Returns the number of key hashes loaded from disk at startup, before any
+  // additions made during this run.
+  size_t LoadedEntryCount() const { return loaded_entry_count_; }
+
+  // Writes the manifest back to disk if any hashes have been added since the
+  // last save. Saving is best-effort; failures are logged but not fatal.
+  void Save();
+
+ private:
+  explicit DmlPersistentKernelCache(std::string manifest_path);
+
+  Status LoadManifest();
+  Status SaveManifest() const;
+
+  const std::string manifest_path_;
+  size_t loaded_entry_count_ = 0;
+
+  mutable std::mutex mutex_;
+
+  // Protected by mutex_
+  std::unordered_set<uint64> key_hashes_;
+  bool dirty_ = false;
+};
+
+}  // namespace tensorflow
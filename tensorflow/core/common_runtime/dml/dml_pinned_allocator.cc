@@ -0,0 +1,108 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_pinned_allocator.h"
+
+#include "dml_util.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+
+namespace tensorflow {
+
+// Pinned memory is backed by the host's system memory budget, not the
+// adapter's, so the BFC limit only needs to be "large enough"; the arena
+// grows on demand and only maps what it uses.
+static constexpr uint64_t kPinnedMemoryLimitInBytes = 1ull << 36;  // 64GB
+
+static GPUOptions PinnedArenaOptions() {
+  GPUOptions options;
+  options.set_allow_growth(true);
+  return options;
+}
+
+DmlPinnedAllocator::DmlPinnedAllocator(ID3D12Device* device, const string& name)
+    : GPUBFCAllocator(new PinnedSubAllocator(this), kPinnedMemoryLimitInBytes,
+                      PinnedArenaOptions(), name),
+      device_(device) {}
+
+void* DmlPinnedAllocator::AllocRegion(uint64_t size_in_bytes) {
+  D3D12_HEAP_PROPERTIES heap_props =
+      CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+  D3D12_RESOURCE_DESC resource_desc =
+      CD3DX12_RESOURCE_DESC::Buffer(size_in_bytes);
+
+  Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+  HRESULT hr = device_->CreateCommittedResource(
+      &heap_props, D3D12_HEAP_FLAG_NONE, &resource_desc,
+      D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&resource));
+  if (dml_util::HrIsOutOfMemory(hr)) {
+    LOG(WARNING) << "DmlPinnedAllocator out of memory!";
+    return nullptr;
+  }
+  DML_CHECK_SUCCEEDED(hr);
+
+  // Map with a full read range so the occasional CPU read through the arena
+  // (e.g. a kernel inspecting a host-side shape tensor) stays valid, slow as
+  // write-combined reads are.
+  void* mapped = nullptr;
+  hr = resource->Map(0, nullptr, &mapped);
+  if (FAILED(hr)) {
+    LOG(WARNING) << "DmlPinnedAllocator failed to map an upload buffer: hr="
+                 << hr;
+    return nullptr;
+  }
+
+  VLOG(2) << "DmlPinnedAllocator: mapped "
+          << strings::HumanReadableNumBytes(size_in_bytes)
+          << " of pinned host memory";
+
+  std::unique_lock<std::mutex> lock(regions_mutex_);
+  regions_.emplace(reinterpret_cast<uintptr_t>(mapped),
+                   Region{std::move(resource), size_in_bytes});
+  return mapped;
+}
+
+void DmlPinnedAllocator::FreeRegion(void* ptr) {
+  std::unique_lock<std::mutex> lock(regions_mutex_);
+
+  auto it = regions_.find(reinterpret_cast<uintptr_t>(ptr));
+  CHECK(it != regions_.end()) << "Invalid pinned region pointer";
+
+  it->second.resource->Unmap(0, nullptr);
+  regions_.erase(it);  // releases the resource
+}
+
+bool DmlPinnedAllocator::GetBufferForPointer(const void* ptr,
+                                             ID3D12Resource** buffer,
+                                             uint64_t* offset) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+
+  std::unique_lock<std::mutex> lock(regions_mutex_);
+
+  auto it = regions_.upper_bound(address);
+  if (it == regions_.begin()) {
+    return false;
+  }
+  --it;
+
+  if (address >= it->first + it->second.size_in_bytes) {
+    return false;
+  }
+
+  *buffer = it->second.resource.Get();
+  *offset = address - it->first;
+  return true;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+
+#include "dml_common.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+
+namespace tensorflow {
+
+// Host allocator backed by persistently mapped D3D12 UPLOAD-heap buffers.
+// DmlDevice returns it for host-memory allocations marked gpu_compatible, so
+// tensors produced by tf.data's final stage and feed-dict paths land directly
+// in memory the GPU can read. The device context then enqueues a single GPU
+// copy from the backing buffer (see BeginUploadFromPinnedBuffer) instead of
+// memcpy'ing the bytes through the upload heap's staging reservation first.
+//
+// The mapped pointers are ordinary CPU addresses carved out of a BFC arena,
+// so tensors allocated here behave exactly like cpu_allocator() tensors from
+// the framework's point of view. UPLOAD-heap pages are write-combined:
+// sequential writes (the overwhelmingly common producer pattern) run at full
+// speed, while reads are slow but correct.
+class DmlPinnedAllocator : public GPUBFCAllocator {
+  // A SubAllocator whose regions are committed UPLOAD-heap buffers, mapped
+  // once at creation and unmapped at destruction.
+  class PinnedSubAllocator final : public tensorflow::SubAllocator {
+   public:
+    explicit PinnedSubAllocator(DmlPinnedAllocator* owner)
+        : SubAllocator({}, {}), owner_(owner) {}
+
+   public:  // SubAllocator overrides
+    void* Alloc(size_t alignment, size_t num_bytes) override {
+      void* p = owner_->AllocRegion(num_bytes);
+      VisitAlloc(p, 0, num_bytes);
+      return p;
+    }
+
+    void Free(void* ptr, size_t num_bytes) override {
+      VisitFree(ptr, 0, num_bytes);
+      owner_->FreeRegion(ptr);
+    }
+
+   private:
+    DmlPinnedAllocator* owner_;  // not owned
+  };
+
+ public:
+  DmlPinnedAllocator(ID3D12Device* device, const string& name);
+
+  // If `ptr` was allocated from this allocator, returns true and sets
+  // `buffer`/`offset` to the UPLOAD-heap resource and the offset within it
+  // that back the pointer. The resource stays alive and mapped for as long as
+  // the BFC region containing the pointer does, which the caller guarantees
+  // by holding a reference on the tensor being uploaded.
+  bool GetBufferForPointer(const void* ptr, ID3D12Resource** buffer,
+                           uint64_t* offset);
+
+ private:
+  // Creates a committed UPLOAD-heap buffer of the given size, maps it, and
+  // registers its mapped address range. Returns the mapped address, or
+  // nullptr if the resource couldn't be created. Called by the SubAllocator
+  // when the BFC arena grows.
+  void* AllocRegion(uint64_t size_in_bytes);
+
+  // Unmaps and releases the region previously returned by AllocRegion.
+  void FreeRegion(void* ptr);
+
+  struct Region {
+    Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+    uint64_t size_in_bytes;
+  };
+
+  Microsoft::WRL::ComPtr<ID3D12Device> device_;
+
+  std::mutex regions_mutex_;
+  // Mapped base address -> backing resource, ordered so GetBufferForPointer
+  // can find the containing region with one upper_bound.
+  std::map<uintptr_t, Region> regions_;
+};
+
+}  // namespace tensorflow
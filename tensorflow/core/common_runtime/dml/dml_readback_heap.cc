@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "dml_readback_heap.h"
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
@@ -25,15 +26,119 @@ static D3D12_HEAP_PROPERTIES ReadbackHeapProps() {
 
 DmlReadbackHeap::DmlReadbackHeap(ID3D12Device* device,
                                  DmlExecutionContext* execution_context,
-                                 DmlEventQueue* event_queue)
+                                 DmlEventQueue* event_queue,
+                                 DmlCopyQueue* copy_queue,
+                                 DmlEventQueue* copy_event_queue)
     : DmlPooledHeap(device, ReadbackHeapProps(),
                     D3D12_RESOURCE_STATE_COPY_DEST),
       execution_context_(execution_context),
-      event_queue_(event_queue) {
+      event_queue_(event_queue),
+      copy_queue_(copy_queue),
+      copy_event_queue_(copy_event_queue) {
+  assert((copy_queue_ == nullptr) == (copy_event_queue_ == nullptr));
   current_completion_event_.fence_value = 0;
   DML_CHECK_SUCCEEDED(
       device->CreateFence(0, D3D12_FENCE_FLAG_NONE,
                           IID_PPV_ARGS(&current_completion_event_.fence)));
+  completion_queue_ =
+      absl::make_unique<DmlEventQueue>(current_completion_event_.fence.Get());
+
+  // Create the small-readback ring and map it for the lifetime of the heap.
+  // Persistent mapping is legal for readback buffers; the mapped contents are
+  // simply undefined until the GPU copy's fence has signaled.
+  auto heap_props = ReadbackHeapProps();
+  D3D12_RESOURCE_DESC ring_desc = CD3DX12_RESOURCE_DESC::Buffer(
+      kSmallReadbackSlotSize * kSmallReadbackSlotCount);
+
+  DML_CHECK_SUCCEEDED(device->CreateCommittedResource(
+      &heap_props, D3D12_HEAP_FLAG_NONE, &ring_desc,
+      D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+      IID_PPV_ARGS(&small_ring_.buffer)));
+
+  void* mapped_data = nullptr;
+  DML_CHECK_SUCCEEDED(small_ring_.buffer->Map(0, nullptr, &mapped_data));
+  small_ring_.mapped_data = static_cast<byte*>(mapped_data);
+}
+
+StatusOr<DmlGpuEvent> DmlReadbackHeap::BeginReadbackCopy(
+    ID3D12Resource* readback_buffer, uint64_t readback_offset,
+    ID3D12Resource* src, uint64_t src_offset, D3D12_RESOURCE_STATES src_state,
+    uint64_t byte_count) {
+  assert(!mutex_.try_lock());
+
+  if (copy_queue_) {
+    // Execute the copy on the dedicated COPY queue so it overlaps with
+    // compute. The copy must be ordered after the compute that produces `src`,
+    // which may still be sitting in the execution context's open batch, so
+    // request a flush and wait for the resulting event. (This is safe because
+    // readbacks add no reverse dependency on the main queue, so no fence cycle
+    // can form.)
+    StatusOr<DmlGpuEvent> status_or_flush = execution_context_->Flush();
+    TF_RETURN_IF_ERROR(status_or_flush.status());
+    DmlGpuEvent compute_done = status_or_flush.ConsumeValueOrDie();
+
+    return copy_queue_->EnqueueCopy(
+        readback_buffer, readback_offset, src, src_offset, byte_count,
+        absl::Span<const DmlGpuEvent>(&compute_done, 1));
+  }
+
+  return StatusOr<DmlGpuEvent>(execution_context_->CopyBufferRegion(
+      readback_buffer, readback_offset, D3D12_RESOURCE_STATE_COPY_DEST, src,
+      src_offset, src_state, byte_count));
+}
+
+absl::optional<uint32_t> DmlReadbackHeap::TryAcquireSmallSlot() {
+  assert(!mutex_.try_lock());
+
+  for (uint32_t i = 0; i < kSmallReadbackSlotCount; ++i) {
+    uint32_t slot = (small_ring_.next_slot + i) % kSmallReadbackSlotCount;
+    const DmlGpuEvent& event = small_ring_.slot_events[slot];
+
+    if (event.fence == nullptr || event.IsSignaled()) {
+      small_ring_.next_slot = (slot + 1) % kSmallReadbackSlotCount;
+      return slot;
+    }
+  }
+
+  return absl::nullopt;
+}
+
+StatusOr<DmlGpuEvent> DmlReadbackHeap::SmallReadbackFromGpu(
+    uint32_t slot, absl::Span<uint8_t> dst, ID3D12Resource* src,
+    uint64_t src_offset, D3D12_RESOURCE_STATES src_state) {
+  assert(!mutex_.try_lock());
+  assert(dst.size() <= kSmallReadbackSlotSize);
+
+  const uint64_t offset_in_ring = slot * kSmallReadbackSlotSize;
+
+  StatusOr<DmlGpuEvent> status_or_event =
+      BeginReadbackCopy(small_ring_.buffer.Get(), offset_in_ring, src,
+                        src_offset, src_state, dst.size());
+  TF_RETURN_IF_ERROR(status_or_event.status());
+  DmlGpuEvent gpu_done_event = status_or_event.ConsumeValueOrDie();
+
+  ++current_completion_event_.fence_value;
+  DmlGpuEvent done_event = current_completion_event_;
+
+  // The slot is occupied until the CPU-side copy below has completed.
+  small_ring_.slot_events[slot] = done_event;
+
+  // The ring is persistently mapped, so the callback is just a memcpy; no
+  // staging allocation or map/unmap is involved.
+  const byte* mapped_data = small_ring_.mapped_data + offset_in_ring;
+  auto done_callback = [this, dst, mapped_data, done_event] {
+    // The device could have been removed before the callback is called
+    if (!execution_context_->GetCommandRecorderStatus().ok()) return;
+
+    memcpy(dst.data(), mapped_data, dst.size());
+
+    // We're done - signal the event with its fence value.
+    DML_CHECK_SUCCEEDED(done_event.fence->Signal(done_event.fence_value));
+  };
+
+  DmlEventQueue* event_queue = copy_queue_ ? copy_event_queue_ : event_queue_;
+  event_queue->Enqueue(gpu_done_event, done_callback);
+  return done_event;
 }
 
 StatusOr<DmlGpuEvent> DmlReadbackHeap::ReadbackFromGpu(
@@ -44,6 +149,18 @@ StatusOr<DmlGpuEvent> DmlReadbackHeap::ReadbackFromGpu(
   assert(!dst.empty());
   assert(src->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER);
 
+  // Per-step scalar fetches (losses, gradient norms) dominate readback counts
+  // during training; serve them from the persistently mapped ring when a slot
+  // is free.
+  if (dst.size() <= kSmallReadbackSlotSize) {
+    absl::optional<uint32_t> slot = TryAcquireSmallSlot();
+    if (slot.has_value()) {
+      return SmallReadbackFromGpu(*slot, dst, src, src_offset, src_state);
+    }
+    // All slots are occupied by in-flight readbacks; fall through to the
+    // pooled path.
+  }
+
   InvariantChecker checker(this);
 
   ReclaimAllocations();
@@ -61,9 +178,10 @@ StatusOr<DmlGpuEvent> DmlReadbackHeap::ReadbackFromGpu(
   // Copy from the source resource into the readback heap. `gpu_done_event` is
   // the event that will be signaled when the copy to the readback heap
   // completes on the GPU.
-  DmlGpuEvent gpu_done_event = execution_context_->CopyBufferRegion(
-      readback_heap, offset_in_chunk, D3D12_RESOURCE_STATE_COPY_DEST, src,
-      src_offset, src_state, dst.size());
+  StatusOr<DmlGpuEvent> status_or_event = BeginReadbackCopy(
+      readback_heap, offset_in_chunk, src, src_offset, src_state, dst.size());
+  TF_RETURN_IF_ERROR(status_or_event.status());
+  DmlGpuEvent gpu_done_event = status_or_event.ConsumeValueOrDie();
 
   // Get the event which will become signaled once the readback into `dst` has
   // fully completed on the CPU.
@@ -93,9 +211,18 @@ StatusOr<DmlGpuEvent> DmlReadbackHeap::ReadbackFromGpu(
 
   // Enqueue the done_callback to fire once the copy from src -> readback_heap
   // completes on the GPU. The callback will then perform the copy
-  // readback_heap -> dst.
-  event_queue_->Enqueue(gpu_done_event, done_callback);
+  // readback_heap -> dst. Each event queue is tied to a single fence, so the
+  // callback goes on the queue matching whichever fence `gpu_done_event` came
+  // from.
+  DmlEventQueue* event_queue = copy_queue_ ? copy_event_queue_ : event_queue_;
+  event_queue->Enqueue(gpu_done_event, done_callback);
   return done_event;
 }
 
+void DmlReadbackHeap::EnqueueCompletionCallback(
+    DmlGpuEvent readback_event, DmlEventQueue::DoneCallback callback) {
+  assert(readback_event.fence.Get() == current_completion_event_.fence.Get());
+  completion_queue_->Enqueue(std::move(readback_event), std::move(callback));
+}
+
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #pragma once
 
 #include "dml_common.h"
+#include "dml_copy_queue.h"
 #include "dml_event_queue.h"
 #include "dml_execution_context.h"
 #include "dml_pooled_heap.h"
@@ -26,8 +27,13 @@ class DmlExecutionContext;
 // Performs non-blocking readback from GPU resources. This class is thread-safe.
 class DmlReadbackHeap : public DmlPooledHeap {
  public:
+  // If `copy_queue` is non-null, readbacks execute on the dedicated COPY queue
+  // (overlapping with compute on the main queue); `copy_event_queue` must then
+  // be an event queue associated with the copy queue's fence.
   DmlReadbackHeap(ID3D12Device* device, DmlExecutionContext* execution_context,
-                  DmlEventQueue* event_queue);
+                  DmlEventQueue* event_queue,
+                  DmlCopyQueue* copy_queue = nullptr,
+                  DmlEventQueue* copy_event_queue = nullptr);
 
   // Copies data from the specified GPU resource into CPU memory pointed-to by
   // the span. This is non-blocking; the copy is not complete until the returned
@@ -38,16 +44,77 @@ class DmlReadbackHeap : public DmlPooledHeap {
                                         uint64_t src_offset,
                                         D3D12_RESOURCE_STATES src_state);
 
+  // Enqueues a callback to fire once `readback_event` - an event previously
+  // returned by ReadbackFromGpu - becomes signaled, i.e. once the destination
+  // CPU buffer has been fully populated. Completion events belong to the
+  // heap's own fence rather than the compute or copy queue fences, so they
+  // cannot be waited on through the device's other event queues. The callback
+  // may be invoked directly on the calling thread if the readback has already
+  // completed.
+  void EnqueueCompletionCallback(DmlGpuEvent readback_event,
+                                 DmlEventQueue::DoneCallback callback);
+
  private:
+  // Small readbacks (per-step scalar losses, gradient norms, etc.) are served
+  // from a persistently mapped ring of fixed-size slots instead of the pooled
+  // chunks, so each one costs a mapped read rather than an
+  // allocate/map/copy/unmap cycle. Slots recycle as their completion events
+  // signal; if every slot is busy, readbacks fall back to the pooled path.
+  static constexpr uint64_t kSmallReadbackSlotSize = 4096;
+  static constexpr uint32_t kSmallReadbackSlotCount = 64;
+
+  struct SmallReadbackRing {
+    Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+    byte* mapped_data = nullptr;
+
+    // Completion event of the readback occupying each slot. A slot is free
+    // once its event is null or signaled.
+    DmlGpuEvent slot_events[kSmallReadbackSlotCount];
+
+    uint32_t next_slot = 0;  // where the round-robin slot search starts
+  };
+
+  // Records the GPU -> readback-buffer copy shared by both readback paths.
+  // The mutex must already be held.
+  StatusOr<DmlGpuEvent> BeginReadbackCopy(ID3D12Resource* readback_buffer,
+                                          uint64_t readback_offset,
+                                          ID3D12Resource* src,
+                                          uint64_t src_offset,
+                                          D3D12_RESOURCE_STATES src_state,
+                                          uint64_t byte_count);
+
+  // Returns a free slot in the small-readback ring, or nullopt if all slots
+  // are occupied by in-flight readbacks. The mutex must already be held.
+  absl::optional<uint32_t> TryAcquireSmallSlot();
+
+  // Performs ReadbackFromGpu through the small-readback ring. The mutex must
+  // already be held.
+  StatusOr<DmlGpuEvent> SmallReadbackFromGpu(uint32_t slot,
+                                             absl::Span<uint8_t> dst,
+                                             ID3D12Resource* src,
+                                             uint64_t src_offset,
+                                             D3D12_RESOURCE_STATES src_state);
+
   std::mutex mutex_;
   DmlExecutionContext* execution_context_;  // weak; owned by DmlDeviceState
   DmlEventQueue* event_queue_;              // weak; owned by DmlDeviceState
 
+  // Weak; owned by DmlDeviceState. Both may be null.
+  DmlCopyQueue* copy_queue_;
+  DmlEventQueue* copy_event_queue_;
+
+  SmallReadbackRing small_ring_;
+
   // We maintain a completion event independent of the execution context,
   // because the execution context's completion event only tells you when the
   // copy to the readback heap has completed, whereas what the caller cares
   // about is whether the copy to the `dst` buffer is complete.
   DmlGpuEvent current_completion_event_;
+
+  // Fires callbacks enqueued against completion events. Waits on the
+  // completion fence above, which is signaled from the CPU once a readback's
+  // final memcpy has finished.
+  std::unique_ptr<DmlEventQueue> completion_queue_;
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,238 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_shared_budget_ledger.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+#if _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tensorflow {
+
+static int64 NowMicros() { return Env::Default()->NowMicros(); }
+
+static uint64 CurrentProcessId() {
+#if _WIN32
+  return static_cast<uint64>(GetCurrentProcessId());
+#else
+  return static_cast<uint64>(getpid());
+#endif
+}
+
+// One region per adapter identity, shared by every process using it. Two
+// identical adapters collapse onto one ledger; see the class comment.
+static std::string LedgerName(const DmlAdapter& adapter) {
+  return strings::StrCat(
+#if _WIN32
+      "Local\\",
+#else
+      "/",
+#endif
+      "tfdml_budget_", strings::Hex(static_cast<uint32>(adapter.VendorID())),
+      "_", strings::Hex(adapter.DeviceID()));
+}
+
+/*static*/ std::unique_ptr<DmlSharedBudgetLedger> DmlSharedBudgetLedger::Create(
+    const DmlAdapter& adapter) {
+  const std::string name = LedgerName(adapter);
+
+  void* base = nullptr;
+  void* platform_handle = nullptr;
+
+#if _WIN32
+  // Pagefile-backed named mapping; the OS zero-initializes fresh pages and
+  // destroys the object once the last process closes its handle.
+  HANDLE mapping = CreateFileMappingA(
+      INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+      static_cast<DWORD>(sizeof(SharedRegion)), name.c_str());
+  if (mapping == nullptr) {
+    LOG(WARNING) << "DmlSharedBudgetLedger: CreateFileMapping failed: "
+                 << GetLastError();
+    return nullptr;
+  }
+
+  base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0,
+                       sizeof(SharedRegion));
+  if (base == nullptr) {
+    CloseHandle(mapping);
+    LOG(WARNING) << "DmlSharedBudgetLedger: MapViewOfFile failed: "
+                 << GetLastError();
+    return nullptr;
+  }
+  platform_handle = mapping;
+#else
+  // POSIX shared memory. The name persists in /dev/shm after the last
+  // process exits (a stale heartbeat-only page), which is deliberate:
+  // unlinking would detach concurrently starting processes onto different
+  // objects.
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd < 0) {
+    LOG(WARNING) << "DmlSharedBudgetLedger: shm_open failed: " << errno;
+    return nullptr;
+  }
+
+  // Idempotent: growing an already-sized object is a no-op, and fresh pages
+  // read as zero.
+  if (ftruncate(fd, sizeof(SharedRegion)) != 0) {
+    close(fd);
+    LOG(WARNING) << "DmlSharedBudgetLedger: ftruncate failed: " << errno;
+    return nullptr;
+  }
+
+  base = mmap(nullptr, sizeof(SharedRegion), PROT_READ | PROT_WRITE,
+              MAP_SHARED, fd, 0);
+  close(fd);  // the mapping keeps the object alive
+  if (base == MAP_FAILED) {
+    LOG(WARNING) << "DmlSharedBudgetLedger: mmap failed: " << errno;
+    return nullptr;
+  }
+  platform_handle = base;
+#endif
+
+  auto* region = static_cast<SharedRegion*>(base);
+
+  // First process to get here stamps the region; everyone else validates it.
+  uint32 expected_magic = 0;
+  if (region->magic.compare_exchange_strong(expected_magic, kMagic)) {
+    region->version = kVersion;
+  } else if (expected_magic != kMagic || region->version != kVersion) {
+    LOG(WARNING) << "DmlSharedBudgetLedger: shared region " << name
+                 << " has an unexpected layout; cross-process budget "
+                    "coordination is disabled for this process.";
+#if _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(platform_handle);
+#else
+    munmap(base, sizeof(SharedRegion));
+#endif
+    return nullptr;
+  }
+
+  int slot_index = ClaimSlot(region);
+  if (slot_index < 0) {
+    LOG(WARNING) << "DmlSharedBudgetLedger: all " << kMaxProcesses
+                 << " ledger slots are held by live processes; cross-process "
+                    "budget coordination is disabled for this process.";
+#if _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(platform_handle);
+#else
+    munmap(base, sizeof(SharedRegion));
+#endif
+    return nullptr;
+  }
+
+  VLOG(1) << "DmlSharedBudgetLedger: joined ledger " << name << " in slot "
+          << slot_index;
+
+  return absl::WrapUnique(
+      new DmlSharedBudgetLedger(region, slot_index, platform_handle));
+}
+
+DmlSharedBudgetLedger::DmlSharedBudgetLedger(SharedRegion* region,
+                                             int slot_index,
+                                             void* platform_handle)
+    : region_(region),
+      slot_index_(slot_index),
+      platform_handle_(platform_handle) {}
+
+DmlSharedBudgetLedger::~DmlSharedBudgetLedger() {
+  Slot& slot = region_->slots[slot_index_];
+  if (slot.owner_pid.load(std::memory_order_relaxed) == CurrentProcessId()) {
+    slot.usage_in_bytes.store(0, std::memory_order_relaxed);
+    slot.heartbeat_us.store(0, std::memory_order_release);
+  }
+
+#if _WIN32
+  UnmapViewOfFile(region_);
+  CloseHandle(platform_handle_);
+#else
+  munmap(platform_handle_, sizeof(SharedRegion));
+#endif
+}
+
+/*static*/ int DmlSharedBudgetLedger::ClaimSlot(SharedRegion* region) {
+  const int64 now = NowMicros();
+
+  for (int i = 0; i < kMaxProcesses; ++i) {
+    Slot& slot = region->slots[i];
+    int64 heartbeat = slot.heartbeat_us.load(std::memory_order_acquire);
+    if (heartbeat != 0 && now - heartbeat < kHeartbeatTimeoutUs) {
+      continue;  // held by a live process
+    }
+
+    // The compare-exchange arbitrates concurrent claimers of the same dead
+    // slot; the loser moves on to the next one.
+    if (slot.heartbeat_us.compare_exchange_strong(heartbeat, now,
+                                                  std::memory_order_acq_rel)) {
+      slot.owner_pid.store(CurrentProcessId(), std::memory_order_relaxed);
+      slot.usage_in_bytes.store(0, std::memory_order_relaxed);
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+void DmlSharedBudgetLedger::PublishUsage(uint64 usage_in_bytes) {
+  Slot& slot = region_->slots[slot_index_];
+
+  // If this process stalled long enough for its heartbeat to go stale,
+  // another process may have claimed the slot; find a new one rather than
+  // corrupting theirs.
+  if (slot.owner_pid.load(std::memory_order_relaxed) != CurrentProcessId()) {
+    int new_slot = ClaimSlot(region_);
+    if (new_slot < 0) {
+      return;  // fully occupied; try again next poll
+    }
+    slot_index_ = new_slot;
+  }
+
+  Slot& owned_slot = region_->slots[slot_index_];
+  owned_slot.usage_in_bytes.store(usage_in_bytes, std::memory_order_relaxed);
+  owned_slot.heartbeat_us.store(NowMicros(), std::memory_order_release);
+}
+
+uint64 DmlSharedBudgetLedger::QueryGroupUsage(uint32* process_count) const {
+  const int64 now = NowMicros();
+
+  uint64 total_usage = 0;
+  uint32 live_processes = 0;
+
+  for (int i = 0; i < kMaxProcesses; ++i) {
+    const Slot& slot = region_->slots[i];
+    int64 heartbeat = slot.heartbeat_us.load(std::memory_order_acquire);
+    if (heartbeat == 0 || now - heartbeat >= kHeartbeatTimeoutUs) {
+      continue;
+    }
+    total_usage += slot.usage_in_bytes.load(std::memory_order_relaxed);
+    ++live_processes;
+  }
+
+  *process_count = std::max(live_processes, 1u);
+  return total_usage;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,104 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "dml_adapter.h"
+#include "dml_common.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A small cross-process ledger through which TF-DirectML processes sharing an
+// adapter publish their video memory usage to each other. Each process claims
+// a slot in a named shared memory region (one region per adapter identity)
+// and periodically writes its current usage together with a heartbeat
+// timestamp; readers sum the usage of every slot with a fresh heartbeat, so a
+// crashed process drops out of the ledger once its heartbeat goes stale
+// rather than pinning phantom usage forever.
+//
+// The ledger is purely advisory — it carries no locks and enforces nothing.
+// DmlBudgetManager combines it with the OS-reported budget to decide whether
+// *this* process is using more than its fair share of the adapter and should
+// shed reclaimable memory, instead of every process trimming (or none)
+// regardless of who is actually over.
+//
+// The region is keyed by vendor and device ID, so two identical adapters in
+// one machine share a ledger and are treated as one pool; that errs toward
+// trimming too early, never too late.
+class DmlSharedBudgetLedger {
+ public:
+  // Creates (or opens) the adapter's shared region and claims a slot in it.
+  // Returns null if the platform shared memory object can't be created or
+  // every slot is held by a live process.
+  static std::unique_ptr<DmlSharedBudgetLedger> Create(
+      const DmlAdapter& adapter);
+
+  ~DmlSharedBudgetLedger();
+
+  // Publishes this process's current video memory usage and refreshes its
+  // heartbeat. Called once per budget manager poll.
+  void PublishUsage(uint64 usage_in_bytes);
+
+  // Sums the published usage of every process with a fresh heartbeat
+  // (including this one) and reports how many there are. `process_count` is
+  // always at least 1.
+  uint64 QueryGroupUsage(uint32* process_count) const;
+
+ private:
+  static constexpr uint32 kMagic = 0x544c4244;  // "DBLT"
+  static constexpr uint32 kVersion = 1;
+  static constexpr int kMaxProcesses = 32;
+
+  // A heartbeat older than this marks its slot dead. Budget polls default to
+  // one second, so this tolerates several missed polls under load before a
+  // live process is miscounted as dead (it re-registers on its next publish).
+  static constexpr int64 kHeartbeatTimeoutUs = 10 * 1000 * 1000;
+
+  struct Slot {
+    std::atomic<int64> heartbeat_us;
+    std::atomic<uint64> usage_in_bytes;
+    // Lets a process detect that its slot was reclaimed while it stalled
+    // (heartbeat went stale), so it re-claims instead of clobbering the new
+    // owner's numbers.
+    std::atomic<uint64> owner_pid;
+  };
+
+  struct SharedRegion {
+    std::atomic<uint32> magic;
+    uint32 version;
+    Slot slots[kMaxProcesses];
+  };
+
+  DmlSharedBudgetLedger(SharedRegion* region, int slot_index,
+                        void* platform_handle);
+
+  // Claims a slot whose heartbeat is stale (or never used). Returns -1 if
+  // all slots are held by live processes.
+  static int ClaimSlot(SharedRegion* region);
+
+  SharedRegion* region_;  // points into the shared mapping
+  int slot_index_;
+
+  // OS handle backing the mapping: the HANDLE from CreateFileMapping on
+  // Windows, or the mmap base (the fd is closed after mapping) on other
+  // platforms. Released by the destructor after the slot is vacated.
+  void* platform_handle_;
+};
+
+}  // namespace tensorflow
@@ -22,6 +22,16 @@ namespace tensorflow {
 
 class TensorShape;
 
+// The largest flattened element count a single DML dispatch can address. DML
+// tensor sizes and strides are UINT32, and the emulated-int64 tensor policy
+// addresses pairs of 32-bit elements through strides, so the last addressable
+// strided index (2 * count) must also fit in a UINT32. The value is a multiple
+// of 16 so that a chunk's byte offset into a buffer stays 16-byte aligned
+// (DML's minimum buffer tensor alignment) for every element size. Kernels that
+// flatten their tensors split anything larger into multiple dispatches; see
+// DmlKernel::SetChunkedExecution.
+constexpr uint64_t kMaxDmlElementsPerDispatch = (1ull << 31) - 16;
+
 class DmlTensorDesc {
  public:
   // Constructs an invalid / optional tensor desc.
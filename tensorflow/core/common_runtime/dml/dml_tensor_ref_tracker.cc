@@ -0,0 +1,73 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_tensor_ref_tracker.h"
+
+namespace tensorflow {
+
+/*static*/ DmlTensorRefTracker* DmlTensorRefTracker::Instance() {
+  static DmlTensorRefTracker* instance = new DmlTensorRefTracker();
+  return instance;
+}
+
+int64 DmlTensorRefTracker::Track(const TensorReference& ref,
+                                 DmlGpuEvent done_event) {
+  mutex_lock lock(mu_);
+  int64 id = next_id_++;
+  entries_.insert({id, Entry{ref, std::move(done_event)}});
+  return id;
+}
+
+void DmlTensorRefTracker::Untrack(int64 id) {
+  mutex_lock lock(mu_);
+  entries_.erase(id);
+}
+
+bool DmlTensorRefTracker::OnlyTrackedReferencesRemain(
+    const Tensor& tensor, ID3D12Fence* compute_fence,
+    int allowed_untracked_refs) {
+  // Read the refcount before scanning the entries. A completion callback
+  // untracks its entry and then drops its reference; with this read order a
+  // racing callback can only make the count look too high (its reference is
+  // still included but its entry is gone), which fails towards taking the
+  // copy.
+  TensorReference tensor_ref(tensor);
+  const int_fast32_t ref_count = tensor_ref.BufferRefCount();
+  tensor_ref.Unref();
+
+  mutex_lock lock(mu_);
+  int_fast32_t ordered = 0;
+  for (const auto& kvp : entries_) {
+    const Entry& entry = kvp.second;
+    if (!entry.ref.SharesBufferWith(tensor)) continue;
+
+    // A read recorded on the caller's compute queue is ordered before any
+    // write enqueued there afterwards; a read on another queue (e.g. the
+    // dedicated COPY queue, or another device) is only safe once it has
+    // actually signaled.
+    if (entry.done_event.fence.Get() != compute_fence &&
+        !entry.done_event.IsSignaled()) {
+      return false;
+    }
+    ++ordered;
+  }
+
+  // `ref_count` included the temporary reference above; beyond that and the
+  // tracked runtime references, only the references the caller accounted for
+  // may remain.
+  return ref_count - 1 - ordered <= allowed_untracked_refs;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,84 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include "absl/container/flat_hash_map.h"
+#include "dml_common.h"
+#include "dml_gpu_event.h"
+#include "tensorflow/core/framework/tensor_reference.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Tracks TensorReferences that the DML runtime itself holds on behalf of GPU
+// work which has already been recorded (e.g. readbacks and cross-device
+// copies). These references exist only to stop TF from recycling a buffer
+// before a recorded GPU read has executed; they do not represent a
+// program-level alias of the tensor's contents.
+//
+// Resource variable update kernels use this distinction to avoid defensive
+// copies: a reference whose GPU read was recorded on the device's compute
+// queue is ordered before any write the kernel enqueues afterwards (the queue
+// executes in submission order), and a reference whose read has already
+// signaled can no longer observe anything. In either case mutating the buffer
+// in place is safe. References this tracker doesn't know about — executor
+// entries, ReadVariableOp snapshots still flowing through the graph — keep
+// forcing the copy, so untracked references always err towards correctness.
+class DmlTensorRefTracker {
+ public:
+  // Singleton; buffers have unique addresses process-wide, so one tracker
+  // serves all devices.
+  static DmlTensorRefTracker* Instance();
+
+  // Records that the runtime holds `ref` only until the GPU work completing
+  // with `done_event` has executed. Returns an id to pass to Untrack.
+  int64 Track(const TensorReference& ref, DmlGpuEvent done_event);
+
+  // Forgets a tracked reference. Call this immediately *before* Unref'ing the
+  // reference: the tracker must never be behind the true refcount, or
+  // OnlyTrackedReferencesRemain could mistake a live program-level reference
+  // for runtime bookkeeping.
+  void Untrack(int64 id);
+
+  // Returns true if every reference on `tensor`'s buffer, other than
+  // `allowed_untracked_refs` references the caller can account for, is a
+  // tracked runtime reference whose GPU read either has already signaled or
+  // was recorded on the queue owning `compute_fence` (and is therefore
+  // ordered before work subsequently enqueued there). The default of 1 covers
+  // the common case where `tensor` is the variable's own tensor; callers
+  // holding additional copies of it (e.g. a ref tensor retrieved through
+  // OpKernelContext::mutable_input) must count them too.
+  //
+  // The caller must hold the owning variable's mutex exclusively so that no
+  // new snapshot of the tensor can be taken concurrently.
+  bool OnlyTrackedReferencesRemain(const Tensor& tensor,
+                                   ID3D12Fence* compute_fence,
+                                   int allowed_untracked_refs = 1);
+
+ private:
+  DmlTensorRefTracker() = default;
+
+  struct Entry {
+    TensorReference ref;
+    DmlGpuEvent done_event;
+  };
+
+  mutex mu_;
+  int64 next_id_ GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<int64, Entry> entries_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
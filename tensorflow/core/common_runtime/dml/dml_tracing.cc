@@ -16,11 +16,28 @@ typedef HRESULT(WINAPI* PIXEndEventOnCommandListFn)(
 typedef HRESULT(WINAPI* PIXSetMarkerOnCommandListFn)(
     ID3D12GraphicsCommandList* commandList, UINT64 color, PCSTR formatString);
 
+// Programmatic capture entry points, exported by WinPixGpuCapturer.dll (which
+// ships with the PIX application, not the event runtime redistributable).
+// Only the FileName field of the capture parameters is read for GPU captures,
+// so a minimal struct stands in for the full PIXCaptureParameters union.
+struct PixGpuCaptureParameters {
+  PCWSTR FileName;
+};
+typedef HRESULT(WINAPI* PIXBeginCapture2Fn)(DWORD captureFlags,
+                                            const void* captureParameters);
+typedef HRESULT(WINAPI* PIXEndCaptureFn)(BOOL discard);
+
+#ifndef PIX_CAPTURE_GPU
+#define PIX_CAPTURE_GPU (1 << 1)
+#endif
+
 static decltype(PIXGetThreadInfo)* g_pixGetThreadInfo = nullptr;
 static decltype(PIXEventsReplaceBlock)* g_pixEventsReplaceBlock = nullptr;
 static PIXBeginEventOnCommandListFn g_pixBeginEventOnCommandList = nullptr;
 static PIXEndEventOnCommandListFn g_pixEndEventOnCommandList = nullptr;
 static PIXSetMarkerOnCommandListFn g_pixSetMarkerOnCommandList = nullptr;
+static PIXBeginCapture2Fn g_pixBeginCapture = nullptr;
+static PIXEndCaptureFn g_pixEndCapture = nullptr;
 
 void BeginEventOnCommandList(ID3D12GraphicsCommandList* command_list,
                              UINT64 color, PCSTR format_string) {
@@ -80,11 +97,45 @@ extern "C" UINT64 WINAPI PIXEventsReplaceBlock(PIXEventsThreadInfo* threadInfo,
 #endif
 
 #include "dml_tracing.h"
+
+#include <thread>
+
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/stream_executor/platform/default/dso_loader.h"
 
+namespace {
+
+// Open spans are tracked per thread so concurrent executor threads don't need
+// the chrome trace lock on the begin side.
+struct OpenSpan {
+  std::string name;
+  double start_us;
+};
+thread_local std::vector<OpenSpan> t_open_kernel_spans;
+thread_local std::vector<double> t_open_session_runs;
+
+// True on the thread whose Session::Run started the active PIX GPU capture;
+// that thread's run end closes it.
+thread_local bool t_owns_gpu_capture = false;
+
+// Run start times for the latency capture trigger, tracked separately from
+// the chrome trace spans because either feature can be on without the other.
+thread_local std::vector<double> t_latency_run_starts;
+
+int64_t CurrentThreadIdHash() {
+  return static_cast<int64_t>(
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+double NowUs() {
+  return static_cast<double>(tensorflow::Env::Default()->NowMicros());
+}
+
+}  // namespace
+
 TRACELOGGING_DECLARE_PROVIDER(g_providerHandle);
 
 // {0E57B9AE-5CE1-4BEF-86BC-24152F6A9560}
@@ -103,6 +154,31 @@ DmlTracing::DmlTracing() {
     trace_level_ = static_cast<TraceLevel>(trace_level);
   }
 
+  s = tensorflow::ReadStringFromEnvVar("TF_DIRECTML_CHROME_TRACE_PATH", "",
+                                       &chrome_trace_path_);
+  chrome_trace_enabled_ = s.ok() && !chrome_trace_path_.empty();
+
+  s = tensorflow::ReadStringFromEnvVar("TF_DIRECTML_PIX_CAPTURE_PATH", "tfdml",
+                                       &gpu_capture_path_prefix_);
+  if (!s.ok() || gpu_capture_path_prefix_.empty()) {
+    gpu_capture_path_prefix_ = "tfdml";
+  }
+
+  tensorflow::int64 capture_runs = 1;
+  s = tensorflow::ReadInt64FromEnvVar("TF_DIRECTML_PIX_CAPTURE_RUNS", 1,
+                                      &capture_runs);
+  if (s.ok() && capture_runs > 0) {
+    gpu_capture_runs_per_trigger_ = static_cast<int>(capture_runs);
+  }
+
+  tensorflow::int64 latency_threshold_ms = 0;
+  s = tensorflow::ReadInt64FromEnvVar(
+      "TF_DIRECTML_PIX_CAPTURE_LATENCY_THRESHOLD_MS", 0, &latency_threshold_ms);
+  if (s.ok() && latency_threshold_ms > 0) {
+    gpu_capture_latency_threshold_us_ =
+        static_cast<double>(latency_threshold_ms) * 1000.0;
+  }
+
 #if _WIN32
   if (trace_level_ > None) {
     auto pix_handle_or =
@@ -128,7 +204,50 @@ DmlTracing::DmlTracing() {
 #endif // _WIN32
 }
 
-DmlTracing::~DmlTracing() { TraceLoggingUnregister(g_providerHandle); }
+DmlTracing::~DmlTracing() {
+  if (chrome_trace_enabled_) {
+    std::lock_guard<std::mutex> lock(chrome_mu_);
+    if (!chrome_events_.empty()) {
+      // Chrome trace event format. Metadata events name the two "processes"
+      // so the viewer shows clearly labeled CPU and GPU lanes.
+      std::string json =
+          "{\"traceEvents\":[\n"
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+          "\"args\":{\"name\":\"CPU (executor)\"}},\n"
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,"
+          "\"args\":{\"name\":\"GPU\"}},\n";
+      for (size_t i = 0; i < chrome_events_.size(); ++i) {
+        const ChromeTraceEvent& event = chrome_events_[i];
+        tensorflow::strings::StrAppend(
+            &json, "{\"name\":\"", event.name, "\",\"ph\":\"", event.ph,
+            event.ph == 'i' ? "\",\"s\":\"t" : "", "\",\"pid\":", event.pid,
+            ",\"tid\":", event.tid, ",\"ts\":", event.ts_us);
+        if (event.ph == 'X') {
+          tensorflow::strings::StrAppend(&json, ",\"dur\":", event.dur_us);
+        }
+        tensorflow::strings::StrAppend(
+            &json, "}", i + 1 < chrome_events_.size() ? ",\n" : "\n");
+      }
+      tensorflow::strings::StrAppend(&json, "]}\n");
+
+      tensorflow::Status s = tensorflow::WriteStringToFile(
+          tensorflow::Env::Default(), chrome_trace_path_, json);
+      if (s.ok()) {
+        LOG(INFO) << "DML chrome trace written to " << chrome_trace_path_;
+      } else {
+        LOG(WARNING) << "Failed to write DML chrome trace to "
+                     << chrome_trace_path_ << ": " << s;
+      }
+    }
+  }
+
+  TraceLoggingUnregister(g_providerHandle);
+}
+
+void DmlTracing::AppendChromeEvent(ChromeTraceEvent event) {
+  std::lock_guard<std::mutex> lock(chrome_mu_);
+  chrome_events_.push_back(std::move(event));
+}
 
 /*static*/ DmlTracing& DmlTracing::Instance() {
   static DmlTracing traceLogger;
@@ -141,6 +260,15 @@ void DmlTracing::LogSessionRunStart() {
                       TraceLoggingOpcode(EVENT_TRACE_TYPE_START));
     PIXBeginEvent(PIX_COLOR(255, 0, 0), "SessionRun");
   }
+  if (chrome_trace_enabled_) {
+    active_session_runs_.fetch_add(1, std::memory_order_relaxed);
+    t_open_session_runs.push_back(NowUs());
+  }
+
+  MaybeBeginArmedGpuCapture();
+  if (gpu_capture_latency_threshold_us_ > 0) {
+    t_latency_run_starts.push_back(NowUs());
+  }
 }
 
 void DmlTracing::LogSessionRunEnd() {
@@ -149,6 +277,29 @@ void DmlTracing::LogSessionRunEnd() {
                       TraceLoggingOpcode(EVENT_TRACE_TYPE_STOP));
     PIXEndEvent();
   }
+  if (chrome_trace_enabled_ && !t_open_session_runs.empty()) {
+    double start_us = t_open_session_runs.back();
+    t_open_session_runs.pop_back();
+    AppendChromeEvent(ChromeTraceEvent{"SessionRun", start_us,
+                                       NowUs() - start_us,
+                                       CurrentThreadIdHash(), 1, 'X'});
+    active_session_runs_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  MaybeEndOwnedGpuCapture();
+  if (gpu_capture_latency_threshold_us_ > 0 && !t_latency_run_starts.empty()) {
+    double duration_us = NowUs() - t_latency_run_starts.back();
+    t_latency_run_starts.pop_back();
+    if (duration_us > gpu_capture_latency_threshold_us_ &&
+        gpu_captures_armed_.load(std::memory_order_relaxed) == 0) {
+      LOG(WARNING) << "DML session run took " << duration_us / 1000.0
+                   << "ms (threshold "
+                   << gpu_capture_latency_threshold_us_ / 1000.0
+                   << "ms); arming PIX GPU capture of the next "
+                   << gpu_capture_runs_per_trigger_ << " run(s)";
+      TriggerGpuCaptures(gpu_capture_runs_per_trigger_);
+    }
+  }
 }
 
 void DmlTracing::LogExecutionContextCopyBufferRegion() {
@@ -169,6 +320,17 @@ void DmlTracing::LogExecutionContextFlush() {
     TraceLoggingWrite(g_providerHandle, "ExecutionContextFlush");
     PIXSetMarker(0, "EC Flush");
   }
+  if (chrome_trace_enabled_ &&
+      active_session_runs_.load(std::memory_order_relaxed) > 0) {
+    AppendChromeEvent(ChromeTraceEvent{"Flush", NowUs(), 0,
+                                       CurrentThreadIdHash(), 1, 'i'});
+  }
+}
+
+void DmlTracing::LogCommandAllocatorRingGrowth() {
+  if (trace_level_ >= All) {
+    TraceLoggingWrite(g_providerHandle, "CommandAllocatorRingGrowth");
+  }
 }
 
 void DmlTracing::LogKernelCompute(const std::string& op_type,
@@ -178,6 +340,135 @@ void DmlTracing::LogKernelCompute(const std::string& op_type,
                       TraceLoggingString(op_type.c_str(), "Type"),
                       TraceLoggingString(op_name.c_str(), "Name"));
   }
+  if (chrome_trace_enabled_ &&
+      active_session_runs_.load(std::memory_order_relaxed) > 0) {
+    t_open_kernel_spans.push_back(
+        OpenSpan{op_name + " (" + op_type + ")", NowUs()});
+  }
+}
+
+void DmlTracing::LogKernelComputeEnd() {
+  if (chrome_trace_enabled_ && !t_open_kernel_spans.empty()) {
+    OpenSpan span = std::move(t_open_kernel_spans.back());
+    t_open_kernel_spans.pop_back();
+    AppendChromeEvent(ChromeTraceEvent{std::move(span.name), span.start_us,
+                                       NowUs() - span.start_us,
+                                       CurrentThreadIdHash(), 1, 'X'});
+  }
+}
+
+void DmlTracing::LogGpuOperator(const std::string& name, double start_us,
+                                double duration_us) {
+  AppendChromeEvent(ChromeTraceEvent{name, start_us, duration_us, 1, 2, 'X'});
+}
+
+bool DmlTracing::EnsurePixCaptureLoaded() {
+#if _WIN32
+  static bool available = [] {
+    auto capturer_handle_or = stream_executor::internal::CachedDsoLoader::
+        GetPixGpuCapturerDsoHandle();
+    if (!capturer_handle_or.ok()) {
+      LOG(WARNING)
+          << "PIX GPU captures are unavailable: WinPixGpuCapturer could not "
+             "be loaded. Place WinPixGpuCapturer.dll next to the binary or "
+             "attach PIX to the process.";
+      return false;
+    }
+
+    tensorflow::Env::Default()->GetSymbolFromLibrary(
+        capturer_handle_or.ValueOrDie(), "PIXBeginCapture2",
+        reinterpret_cast<void**>(&g_pixBeginCapture));
+    tensorflow::Env::Default()->GetSymbolFromLibrary(
+        capturer_handle_or.ValueOrDie(), "PIXEndCapture",
+        reinterpret_cast<void**>(&g_pixEndCapture));
+
+    if (!g_pixBeginCapture || !g_pixEndCapture) {
+      LOG(WARNING) << "PIX GPU captures are unavailable: WinPixGpuCapturer "
+                      "is missing the capture entry points.";
+      return false;
+    }
+    return true;
+  }();
+  return available;
+#else
+  static bool warned = [] {
+    LOG(WARNING) << "PIX GPU captures are not supported in WSL";
+    return true;
+  }();
+  (void)warned;
+  return false;
+#endif
+}
+
+void DmlTracing::TriggerGpuCaptures(int num_runs) {
+  if (num_runs <= 0 || !EnsurePixCaptureLoaded()) {
+    return;
+  }
+
+  // Raise the armed count to at least num_runs; concurrent triggers extend
+  // rather than stack, so a misfiring condition can't queue up captures
+  // without bound.
+  int current = gpu_captures_armed_.load(std::memory_order_relaxed);
+  while (current < num_runs &&
+         !gpu_captures_armed_.compare_exchange_weak(current, num_runs)) {
+  }
+}
+
+void DmlTracing::MaybeBeginArmedGpuCapture() {
+#if _WIN32
+  if (gpu_captures_armed_.load(std::memory_order_relaxed) <= 0) {
+    return;
+  }
+
+  // One capture at a time; a run that starts while another run's capture is
+  // active leaves the armed count untouched, so a later run picks it up.
+  if (gpu_capture_active_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  if (gpu_captures_armed_.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+    // Raced with another run taking the last armed capture.
+    gpu_captures_armed_.fetch_add(1, std::memory_order_relaxed);
+    gpu_capture_active_.store(false, std::memory_order_release);
+    return;
+  }
+
+  // Only one thread can reach this point at a time (the exchange above is the
+  // gate), so the index needs no further synchronization.
+  std::string path = tensorflow::strings::StrCat(gpu_capture_path_prefix_, "_",
+                                                 gpu_capture_index_++, ".wpix");
+  std::wstring wide_path(path.begin(), path.end());
+
+  PixGpuCaptureParameters params = {};
+  params.FileName = wide_path.c_str();
+
+  HRESULT hr = g_pixBeginCapture(PIX_CAPTURE_GPU, &params);
+  if (FAILED(hr)) {
+    LOG(WARNING) << "PIXBeginCapture failed with HRESULT 0x" << std::hex << hr;
+    gpu_capture_active_.store(false, std::memory_order_release);
+    return;
+  }
+
+  t_owns_gpu_capture = true;
+  LOG(INFO) << "PIX GPU capture started: " << path;
+#endif
+}
+
+void DmlTracing::MaybeEndOwnedGpuCapture() {
+#if _WIN32
+  if (!t_owns_gpu_capture) {
+    return;
+  }
+  t_owns_gpu_capture = false;
+
+  HRESULT hr = g_pixEndCapture(/*discard*/ FALSE);
+  if (FAILED(hr)) {
+    LOG(WARNING) << "PIXEndCapture failed with HRESULT 0x" << std::hex << hr;
+  } else {
+    LOG(INFO) << "PIX GPU capture completed";
+  }
+
+  gpu_capture_active_.store(false, std::memory_order_release);
+#endif
 }
 
 void DmlTracing::LogExecuteOperatorStart(
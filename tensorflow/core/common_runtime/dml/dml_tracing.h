@@ -1,5 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "dml_common.h"
 
 // Helper for adding tracing events useful in ETW-based perf analysis
@@ -28,10 +34,102 @@ class DmlTracing {
   void LogExecutionContextCopyBufferRegion();
   void LogExecutionContextFillBufferWithPattern();
   void LogExecutionContextFlush();
+  void LogCommandAllocatorRingGrowth();
   void LogKernelCompute(const std::string& op_type, const std::string& op_name);
 
   // GPU timeline
   void LogExecuteOperatorStart(IDMLCompiledOperator* op,
                                ID3D12GraphicsCommandList* command_list);
   void LogExecuteOperatorEnd(ID3D12GraphicsCommandList* command_list);
-};
\ No newline at end of file
+
+  // --- Chrome trace export ---
+  //
+  // When TF_DIRECTML_CHROME_TRACE_PATH names a file, DmlTracing records
+  // executor-thread kernel spans, session-run spans, and flush markers with
+  // walltime timestamps, merges in the GPU execution spans fed to it by
+  // DmlGpuProfiler, and writes a chrome://tracing JSON at process exit - a
+  // zero-install artifact that opens in any browser. CPU events are only
+  // recorded while a Session::Run is in flight, so leaving the variable set
+  // on a production host costs nothing between requests.
+  //
+  // CPU and GPU events share the walltime axis: each flush's first GPU
+  // dispatch is anchored at the walltime its command list was submitted.
+  // Spacing and durations within a flush are exact (they come from GPU
+  // timestamp queries); across flushes, dispatches never appear earlier than
+  // their submission.
+  bool IsChromeTraceEnabled() const { return chrome_trace_enabled_; }
+
+  // Closes the span opened by LogKernelCompute. Use DmlKernelComputeScope to
+  // keep the pair balanced across early returns.
+  void LogKernelComputeEnd();
+
+  // Adds one GPU execution span to the unified timeline; called by
+  // DmlGpuProfiler as sampled flushes complete. Thread-safe.
+  void LogGpuOperator(const std::string& name, double start_us,
+                      double duration_us);
+
+  // --- Programmatic PIX GPU captures ---
+  //
+  // Arms a PIX GPU capture of the next `num_runs` Session::Runs, each written
+  // to <TF_DIRECTML_PIX_CAPTURE_PATH>_<n>.wpix (default prefix "tfdml").
+  // Requires WinPixGpuCapturer.dll to be loadable (next to the binary, on the
+  // DLL search path, or injected by an attached PIX); logs a warning and does
+  // nothing otherwise. Callable from any thread, including condition
+  // detectors like a NaN check. Also reachable without the C++ ABI through
+  // TFDML_TriggerGpuCaptures.
+  //
+  // Setting TF_DIRECTML_PIX_CAPTURE_LATENCY_THRESHOLD_MS arms this
+  // automatically whenever a Session::Run exceeds the threshold, capturing
+  // the next TF_DIRECTML_PIX_CAPTURE_RUNS runs (default 1) - the capture
+  // can't include the slow run itself, but intermittent stalls recur, and
+  // arming is the only per-run cost until one does.
+  void TriggerGpuCaptures(int num_runs);
+
+ private:
+  // Begins a capture for this run if one is armed and none is active; ends
+  // the capture owned by the calling thread. Both no-op in the common case at
+  // the cost of one relaxed atomic load.
+  void MaybeBeginArmedGpuCapture();
+  void MaybeEndOwnedGpuCapture();
+
+  // Loads the PIX GPU capturer library on first use. Returns false (and
+  // warns, once) if it isn't available.
+  bool EnsurePixCaptureLoaded();
+
+  std::atomic<int> gpu_captures_armed_{0};
+  std::atomic<bool> gpu_capture_active_{false};
+  int gpu_capture_index_ = 0;  // suffix of the next .wpix file
+  std::string gpu_capture_path_prefix_;
+  int gpu_capture_runs_per_trigger_ = 1;
+  double gpu_capture_latency_threshold_us_ = 0;  // 0 = trigger disabled
+
+ private:
+  struct ChromeTraceEvent {
+    std::string name;
+    double ts_us;
+    double dur_us;
+    int64_t tid;
+    int pid;  // 1 = CPU (executor threads), 2 = GPU
+    char ph;  // 'X' (complete) or 'i' (instant)
+  };
+
+  void AppendChromeEvent(ChromeTraceEvent event);
+
+  bool chrome_trace_enabled_ = false;
+  std::string chrome_trace_path_;
+  std::mutex chrome_mu_;
+  std::vector<ChromeTraceEvent> chrome_events_;
+  std::atomic<int> active_session_runs_{0};
+};
+
+// Marks the span of one kernel's Compute on the executor thread. A scope
+// rather than explicit begin/end calls because the kernel wrapper returns
+// early through OP_REQUIRES on errors.
+class DmlKernelComputeScope {
+ public:
+  DmlKernelComputeScope(const std::string& op_type,
+                        const std::string& op_name) {
+    DmlTracing::Instance().LogKernelCompute(op_type, op_name);
+  }
+  ~DmlKernelComputeScope() { DmlTracing::Instance().LogKernelComputeEnd(); }
+};
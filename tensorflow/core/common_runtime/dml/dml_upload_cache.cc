@@ -0,0 +1,152 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_upload_cache.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "dml_bfc_allocator.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Uploads below this size are cheaper to just re-send than to fingerprint,
+// track, and copy out of cache.
+constexpr uint64_t kMinCacheableSizeInBytes = 4096;
+
+}  // namespace
+
+/*static*/ std::unique_ptr<DmlUploadCache> DmlUploadCache::MaybeCreate(
+    DmlAllocator* allocator) {
+  int64 budget_in_bytes;
+  Status s = ReadInt64FromEnvVar("TF_DIRECTML_UPLOAD_CACHE_BYTES",
+                                 /*default_val=*/64 * 1024 * 1024,
+                                 &budget_in_bytes);
+  if (!s.ok() || budget_in_bytes <= 0) {
+    return nullptr;
+  }
+
+  // Cap individual entries well below the budget so one large recurring feed
+  // cannot monopolize the cache.
+  uint64_t max_entry_size_in_bytes =
+      std::min<uint64_t>(budget_in_bytes / 4, 16 * 1024 * 1024);
+
+  return absl::make_unique<DmlUploadCache>(
+      allocator, static_cast<uint64_t>(budget_in_bytes),
+      max_entry_size_in_bytes);
+}
+
+DmlUploadCache::DmlUploadCache(DmlAllocator* allocator,
+                               uint64_t budget_in_bytes,
+                               uint64_t max_entry_size_in_bytes)
+    : allocator_(allocator),
+      budget_in_bytes_(budget_in_bytes),
+      max_entry_size_in_bytes_(max_entry_size_in_bytes) {}
+
+/*static*/ uint64_t DmlUploadCache::FingerprintBytes(const void* data,
+                                                     uint64_t size_in_bytes) {
+  uint64_t fp = Fingerprint64(
+      StringPiece(static_cast<const char*>(data), size_in_bytes));
+  return FingerprintCat64(fp, size_in_bytes);
+}
+
+bool DmlUploadCache::IsCacheableSize(uint64_t size_in_bytes) const {
+  return size_in_bytes >= kMinCacheableSizeInBytes &&
+         size_in_bytes <= max_entry_size_in_bytes_;
+}
+
+bool DmlUploadCache::Lookup(uint64_t fingerprint, uint64_t size_in_bytes,
+                            ID3D12Resource** resource, uint64_t* offset) {
+  mutex_lock lock(mu_);
+
+  auto it = entries_.find(fingerprint);
+  if (it == entries_.end() || !it->second->committed ||
+      it->second->size_in_bytes != size_in_bytes) {
+    return false;
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second);
+  *resource = lru_.front().buffer.Resource();
+  *offset = lru_.front().buffer.Offset();
+  return true;
+}
+
+bool DmlUploadCache::Reserve(uint64_t fingerprint, uint64_t size_in_bytes,
+                             ID3D12Resource** resource, uint64_t* offset) {
+  mutex_lock lock(mu_);
+
+  if (entries_.count(fingerprint) != 0) {
+    // Either already cached or an upload of the same bytes is in flight.
+    return false;
+  }
+
+  // Evict committed entries from the LRU end until the new entry fits.
+  // Uncommitted entries are skipped: a recorded copy still targets their
+  // memory. If only uncommitted entries remain and the budget is still
+  // exceeded, give up rather than overcommit.
+  auto it = lru_.end();
+  while (used_bytes_ + size_in_bytes > budget_in_bytes_ && it != lru_.begin()) {
+    --it;
+    if (!it->committed) {
+      continue;
+    }
+    used_bytes_ -= it->size_in_bytes;
+    entries_.erase(it->fingerprint);
+    it = lru_.erase(it);
+  }
+  if (used_bytes_ + size_in_bytes > budget_in_bytes_) {
+    return false;
+  }
+
+  DmlBuffer buffer(allocator_, size_in_bytes);
+  if (!buffer) {
+    return false;
+  }
+
+  *resource = buffer.Resource();
+  *offset = buffer.Offset();
+
+  lru_.push_front(
+      Entry{fingerprint, size_in_bytes, /*committed=*/false, std::move(buffer)});
+  entries_[fingerprint] = lru_.begin();
+  used_bytes_ += size_in_bytes;
+  return true;
+}
+
+void DmlUploadCache::Commit(uint64_t fingerprint) {
+  mutex_lock lock(mu_);
+
+  auto it = entries_.find(fingerprint);
+  if (it != entries_.end()) {
+    it->second->committed = true;
+  }
+}
+
+void DmlUploadCache::Abandon(uint64_t fingerprint) {
+  mutex_lock lock(mu_);
+
+  auto it = entries_.find(fingerprint);
+  if (it != entries_.end() && !it->second->committed) {
+    used_bytes_ -= it->second->size_in_bytes;
+    lru_.erase(it->second);
+    entries_.erase(it);
+  }
+}
+
+}  // namespace tensorflow
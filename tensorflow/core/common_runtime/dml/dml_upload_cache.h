@@ -0,0 +1,103 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "dml_buffer.h"
+#include "dml_common.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+class DmlAllocator;
+
+// A budgeted LRU cache of device buffer regions keyed by the fingerprint of
+// the host bytes they were uploaded from. Serving workloads feed the same
+// preprocessing constants and lookup results across requests; when an upload's
+// source bytes fingerprint to a cached entry, the PCIe transfer is replaced by
+// a device-to-device copy from the cached region (see
+// DMLDeviceContext::CopyCPUTensorToDevice).
+//
+// Entries are inserted in two steps because uploads are asynchronous: Reserve
+// claims budget and a device buffer for a fingerprint before the upload is
+// enqueued, and Commit publishes it once the populating copy has been recorded
+// on the GPU timeline. A reserved-but-uncommitted entry is never returned by
+// Lookup and never evicted, so a concurrent upload of the same bytes can
+// neither read garbage nor free a region a recorded copy still targets.
+//
+// All methods are thread-safe.
+class DmlUploadCache {
+ public:
+  // Returns null if the cache is disabled (TF_DIRECTML_UPLOAD_CACHE_BYTES=0).
+  static std::unique_ptr<DmlUploadCache> MaybeCreate(DmlAllocator* allocator);
+
+  DmlUploadCache(DmlAllocator* allocator, uint64_t budget_in_bytes,
+                 uint64_t max_entry_size_in_bytes);
+
+  // Fingerprints the source bytes of an upload. The length participates in
+  // the fingerprint so a prefix of a previously seen buffer never aliases it.
+  static uint64_t FingerprintBytes(const void* data, uint64_t size_in_bytes);
+
+  // Whether a region of this size is worth caching. Tiny uploads are cheaper
+  // than the bookkeeping, and entries near the budget would evict everything
+  // else for one tenant.
+  bool IsCacheableSize(uint64_t size_in_bytes) const;
+
+  // If a committed entry exists for this fingerprint and size, returns its
+  // device region, marks it most recently used, and returns true.
+  bool Lookup(uint64_t fingerprint, uint64_t size_in_bytes,
+              ID3D12Resource** resource, uint64_t* offset);
+
+  // Claims budget and a device buffer for a new entry, evicting committed
+  // entries in LRU order as needed. Returns false (without evicting) if an
+  // entry for this fingerprint already exists, or if the budget cannot be
+  // freed because too much of it is held by uncommitted entries. On success
+  // the entry is uncommitted and the caller must eventually call Commit or
+  // Abandon on it.
+  bool Reserve(uint64_t fingerprint, uint64_t size_in_bytes,
+               ID3D12Resource** resource, uint64_t* offset);
+
+  // Publishes a reserved entry once the copy populating it has been recorded
+  // on the GPU timeline; subsequent Lookups may hit it.
+  void Commit(uint64_t fingerprint);
+
+  // Releases a reserved entry whose populating upload failed.
+  void Abandon(uint64_t fingerprint);
+
+ private:
+  struct Entry {
+    uint64_t fingerprint;
+    uint64_t size_in_bytes;
+    bool committed;
+    DmlBuffer buffer;
+  };
+
+  DmlAllocator* allocator_;  // weak; owned by the DML device factory
+  const uint64_t budget_in_bytes_;
+  const uint64_t max_entry_size_in_bytes_;
+
+  mutex mu_;
+
+  // Most recently used at the front; entries_ indexes into it by fingerprint.
+  std::list<Entry> lru_ GUARDED_BY(mu_);
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> entries_
+      GUARDED_BY(mu_);
+  uint64_t used_bytes_ GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
@@ -24,10 +24,12 @@ static D3D12_HEAP_PROPERTIES UploadHeapProps() {
 }
 
 DmlUploadHeap::DmlUploadHeap(ID3D12Device* device,
-                             DmlExecutionContext* execution_context)
+                             DmlExecutionContext* execution_context,
+                             DmlCopyQueue* copy_queue)
     : DmlPooledHeap(device, UploadHeapProps(),
                     D3D12_RESOURCE_STATE_GENERIC_READ),
-      execution_context_(execution_context) {}
+      execution_context_(execution_context),
+      copy_queue_(copy_queue) {}
 
 StatusOr<DmlGpuEvent> DmlUploadHeap::BeginUploadToGpu(
     ID3D12Resource* dst, uint64_t dst_offset, D3D12_RESOURCE_STATES dst_state,
@@ -59,9 +61,32 @@ StatusOr<DmlGpuEvent> DmlUploadHeap::BeginUploadToGpu(
   chunk->resource->Unmap(0, nullptr);
 
   // Copy from the upload heap into the destination resource
-  DmlGpuEvent done_event = execution_context_->CopyBufferRegion(
-      dst, dst_offset, dst_state, chunk->resource.Get(), offset_in_chunk,
-      D3D12_RESOURCE_STATE_GENERIC_READ, src.size());
+  DmlGpuEvent done_event;
+  if (copy_queue_) {
+    // Submit the copy to the dedicated COPY queue so it overlaps with compute
+    // instead of serializing behind it on the main queue. Two fences order it
+    // with the main queue:
+    //   1. The copy waits for the most recently *flushed* main-queue batch,
+    //      since the destination memory may have been recycled from a buffer
+    //      that submitted work still references. (Waiting on the open,
+    //      unflushed batch would deadlock with the dependency added below.)
+    //   2. Batches flushed after this point wait for the copy, so compute
+    //      never consumes the destination before the upload lands.
+    DmlGpuEvent compute_done =
+        execution_context_->GetLastFlushedCompletionEvent();
+
+    StatusOr<DmlGpuEvent> status_or_event = copy_queue_->EnqueueCopy(
+        dst, dst_offset, chunk->resource.Get(), offset_in_chunk, src.size(),
+        absl::Span<const DmlGpuEvent>(&compute_done, 1));
+    TF_RETURN_IF_ERROR(status_or_event.status());
+
+    done_event = status_or_event.ConsumeValueOrDie();
+    execution_context_->QueueDependency(done_event);
+  } else {
+    done_event = execution_context_->CopyBufferRegion(
+        dst, dst_offset, dst_state, chunk->resource.Get(), offset_in_chunk,
+        D3D12_RESOURCE_STATE_GENERIC_READ, src.size());
+  }
 
   // Add an allocation entry to the chunk
   chunk->allocations.push_back(Allocation{static_cast<uint64_t>(src.size()),
@@ -70,4 +95,161 @@ StatusOr<DmlGpuEvent> DmlUploadHeap::BeginUploadToGpu(
   return done_event;
 }
 
+StatusOr<DmlGpuEvent> DmlUploadHeap::BeginUploadFromPinnedBuffer(
+    ID3D12Resource* dst, uint64_t dst_offset, D3D12_RESOURCE_STATES dst_state,
+    ID3D12Resource* src, uint64_t src_offset, uint64_t byte_count) {
+  TF_RETURN_IF_ERROR(execution_context_->GetCommandRecorderStatus());
+
+  assert(byte_count > 0);
+  assert(dst->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER);
+  assert(src->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER);
+
+  // No staging reservation: the source already lives in an UPLOAD-heap
+  // buffer the GPU can read, so this is a plain buffer-to-buffer copy with
+  // the same cross-queue fencing as the staged paths.
+  if (copy_queue_) {
+    DmlGpuEvent compute_done =
+        execution_context_->GetLastFlushedCompletionEvent();
+
+    StatusOr<DmlGpuEvent> status_or_event =
+        copy_queue_->EnqueueCopy(dst, dst_offset, src, src_offset, byte_count,
+                                 absl::Span<const DmlGpuEvent>(&compute_done, 1));
+    TF_RETURN_IF_ERROR(status_or_event.status());
+
+    DmlGpuEvent done_event = status_or_event.ConsumeValueOrDie();
+    execution_context_->QueueDependency(done_event);
+    return done_event;
+  }
+
+  return execution_context_->CopyBufferRegion(
+      dst, dst_offset, dst_state, src, src_offset,
+      D3D12_RESOURCE_STATE_GENERIC_READ, byte_count);
+}
+
+StatusOr<DmlGpuEvent> DmlUploadHeap::BeginGatheredUploadToGpu(
+    absl::Span<const UploadRequest> uploads) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  TF_RETURN_IF_ERROR(execution_context_->GetCommandRecorderStatus());
+
+  assert(!uploads.empty());
+
+  // Compute where each source span lands within the shared staging
+  // reservation. Buffer copies have no D3D12 alignment requirement, but
+  // keeping spans 16-byte aligned keeps the CPU memcpys naturally aligned.
+  constexpr uint64_t kSpanAlignment = 16;
+  absl::InlinedVector<uint64_t, 16> span_offsets;
+  span_offsets.reserve(uploads.size());
+
+  uint64_t total_size = 0;
+  for (const UploadRequest& upload : uploads) {
+    assert(!upload.src.empty());
+    assert(upload.dst->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER);
+
+    span_offsets.push_back(total_size);
+    total_size +=
+        (upload.src.size() + kSpanAlignment - 1) & ~(kSpanAlignment - 1);
+  }
+
+  InvariantChecker checker(this);
+
+  ReclaimAllocations();
+
+  // One reservation covers every span, so many small uploads cost a single
+  // allocation and (below) a single map/unmap and fence.
+  Chunk* chunk = nullptr;
+  uint64_t offset_in_chunk = 0;
+  TF_RETURN_IF_ERROR(Reserve(total_size, &chunk, &offset_in_chunk));
+
+  assert(chunk != nullptr);
+  assert(offset_in_chunk + total_size <= chunk->capacity_in_bytes);
+
+  void* upload_heap_data = nullptr;
+  DML_CHECK_SUCCEEDED(chunk->resource->Map(0, nullptr, &upload_heap_data));
+  for (size_t i = 0; i < uploads.size(); ++i) {
+    memcpy(static_cast<byte*>(upload_heap_data) + offset_in_chunk +
+               span_offsets[i],
+           uploads[i].src.data(), uploads[i].src.size());
+  }
+  chunk->resource->Unmap(0, nullptr);
+
+  DmlGpuEvent done_event;
+  if (copy_queue_) {
+    // Same fencing scheme as the single-upload path above, but all regions
+    // are recorded and submitted to the COPY queue as one batch.
+    DmlGpuEvent compute_done =
+        execution_context_->GetLastFlushedCompletionEvent();
+
+    absl::InlinedVector<DmlCopyQueue::CopyRegion, 16> regions;
+    regions.reserve(uploads.size());
+    for (size_t i = 0; i < uploads.size(); ++i) {
+      regions.push_back(DmlCopyQueue::CopyRegion{
+          uploads[i].dst, uploads[i].dst_offset, chunk->resource.Get(),
+          offset_in_chunk + span_offsets[i], uploads[i].src.size()});
+    }
+
+    StatusOr<DmlGpuEvent> status_or_event = copy_queue_->EnqueueCopies(
+        regions, absl::Span<const DmlGpuEvent>(&compute_done, 1));
+    TF_RETURN_IF_ERROR(status_or_event.status());
+
+    done_event = status_or_event.ConsumeValueOrDie();
+    execution_context_->QueueDependency(done_event);
+  } else {
+    // Batched onto the execution context; completion events are monotonic for
+    // a recording thread, so the last copy's event covers the whole gather.
+    for (size_t i = 0; i < uploads.size(); ++i) {
+      done_event = execution_context_->CopyBufferRegion(
+          uploads[i].dst, uploads[i].dst_offset, uploads[i].dst_state,
+          chunk->resource.Get(), offset_in_chunk + span_offsets[i],
+          D3D12_RESOURCE_STATE_GENERIC_READ, uploads[i].src.size());
+    }
+  }
+
+  // One allocation entry covers the entire gathered reservation.
+  chunk->allocations.push_back(
+      Allocation{total_size, offset_in_chunk, done_event});
+
+  return done_event;
+}
+
+void DmlUploadHeap::EnqueueUploadToGpu(
+    const UploadRequest& request, std::function<void(const Status&)> done) {
+  {
+    std::unique_lock<std::mutex> lock(batch_mutex_);
+    pending_uploads_.push_back(PendingUpload{request, std::move(done)});
+    if (batch_in_flight_) {
+      // The submitting thread re-checks the pending list before clearing the
+      // in-flight flag, so it is guaranteed to pick this entry up.
+      return;
+    }
+    batch_in_flight_ = true;
+  }
+
+  // This thread is now the submitter. Requests that arrive on other threads
+  // while a batch is being staged/recorded accumulate in pending_uploads_ and
+  // are drained by the next loop iteration, so a burst of concurrent small
+  // uploads collapses into a handful of gathered submissions.
+  while (true) {
+    std::vector<PendingUpload> batch;
+    {
+      std::unique_lock<std::mutex> lock(batch_mutex_);
+      if (pending_uploads_.empty()) {
+        batch_in_flight_ = false;
+        return;
+      }
+      batch.swap(pending_uploads_);
+    }
+
+    absl::InlinedVector<UploadRequest, 16> requests;
+    requests.reserve(batch.size());
+    for (const PendingUpload& pending : batch) {
+      requests.push_back(pending.request);
+    }
+
+    StatusOr<DmlGpuEvent> status_or_event = BeginGatheredUploadToGpu(requests);
+    for (PendingUpload& pending : batch) {
+      pending.done(status_or_event.status());
+    }
+  }
+}
+
 }  // namespace tensorflow
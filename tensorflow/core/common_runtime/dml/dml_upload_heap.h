@@ -15,7 +15,10 @@ limitations under the License.
 
 #pragma once
 
+#include <functional>
+
 #include "dml_common.h"
+#include "dml_copy_queue.h"
 #include "dml_execution_context.h"
 #include "dml_pooled_heap.h"
 
@@ -27,7 +30,11 @@ class DmlExecutionContext;
 // to GPU resources. This class is thread-safe.
 class DmlUploadHeap : public DmlPooledHeap {
  public:
-  DmlUploadHeap(ID3D12Device* device, DmlExecutionContext* execution_context);
+  // If `copy_queue` is non-null, uploads are submitted to the dedicated COPY
+  // queue (overlapping with compute on the main queue) instead of being
+  // batched onto the execution context.
+  DmlUploadHeap(ID3D12Device* device, DmlExecutionContext* execution_context,
+                DmlCopyQueue* copy_queue = nullptr);
 
   // Makes a copy of the source data and begins copying it into the destination
   // resource, and returns a DmlGpuEvent which will become signaled when the
@@ -38,9 +45,63 @@ class DmlUploadHeap : public DmlPooledHeap {
                                          D3D12_RESOURCE_STATES dst_state,
                                          absl::Span<const uint8_t> src);
 
+  // Begins copying from a GPU-readable host buffer (a pinned allocation from
+  // DmlPinnedAllocator) directly into the destination resource, skipping the
+  // staging reservation and its memcpy entirely — the only copy is the GPU's
+  // read across the bus. Ordering matches BeginUploadToGpu. The caller must
+  // keep the source buffer alive and unmodified until the returned event is
+  // signaled; unlike the staging paths, the source bytes are read by the GPU,
+  // not captured up front.
+  StatusOr<DmlGpuEvent> BeginUploadFromPinnedBuffer(
+      ID3D12Resource* dst, uint64_t dst_offset, D3D12_RESOURCE_STATES dst_state,
+      ID3D12Resource* src, uint64_t src_offset, uint64_t byte_count);
+
+  // One source span and its destination within a gathered upload.
+  struct UploadRequest {
+    ID3D12Resource* dst;
+    uint64_t dst_offset;
+    D3D12_RESOURCE_STATES dst_state;
+    absl::Span<const uint8_t> src;
+  };
+
+  // Gathered variant of BeginUploadToGpu: packs all source spans into a single
+  // staging reservation with one map/unmap, and submits the copies as one
+  // batched sequence (one command list and fence signal on the copy queue),
+  // amortizing allocation, fence, and command overhead across many small
+  // uploads. The returned event is signaled when every upload has completed.
+  StatusOr<DmlGpuEvent> BeginGatheredUploadToGpu(
+      absl::Span<const UploadRequest> uploads);
+
+  // Combining front end over BeginGatheredUploadToGpu. The request is appended
+  // to a pending list; the first thread to arrive becomes the submitter and
+  // drains the list in gathered batches, so copies issued concurrently from
+  // other threads (e.g. a step being fed many small inputs) coalesce into a
+  // single staging reservation and fence signal instead of one submission
+  // each. `done` is invoked — possibly on another thread — once the request's
+  // batch has been recorded and ordered on the GPU timeline (or has failed);
+  // the caller must keep both the source memory and the destination resource
+  // alive until then. With a single calling thread this degrades to one
+  // request per batch, which is equivalent to BeginUploadToGpu.
+  void EnqueueUploadToGpu(const UploadRequest& request,
+                          std::function<void(const Status&)> done);
+
  private:
+  // One queued request in the combining front end, paired with its completion
+  // callback.
+  struct PendingUpload {
+    UploadRequest request;
+    std::function<void(const Status&)> done;
+  };
+
   std::mutex mutex_;
   DmlExecutionContext* execution_context_;  // weak; owned by DmlDeviceState
+  DmlCopyQueue* copy_queue_;  // weak; owned by DmlDeviceState. May be null.
+
+  // Guards the combining front end. Distinct from mutex_ so that appending a
+  // request never blocks behind an in-progress staging copy/submission.
+  std::mutex batch_mutex_;
+  std::vector<PendingUpload> pending_uploads_;  // protected by batch_mutex_
+  bool batch_in_flight_ = false;                // protected by batch_mutex_
 };
 
 }  // namespace tensorflow
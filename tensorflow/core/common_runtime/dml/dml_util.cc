@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 
 #include "tensorflow/core/common_runtime/dml/dml_bfc_allocator.h"
+#include "tensorflow/core/common_runtime/dml/dml_tensor_ref_tracker.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/stream_executor/platform/default/dso_loader.h"
 
@@ -170,6 +172,23 @@ DML_TENSOR_DATA_TYPE GetDmlDataTypeFromTfDataType(DataType type) {
     case DT_INT8:
     case DT_INT8_REF:
       return DML_TENSOR_DATA_TYPE_INT8;
+    // The quantized types are plain integers as far as DML is concerned; the
+    // scale/zero-point bookkeeping lives in the kernels that use them.
+    case DT_QUINT8:
+    case DT_QUINT8_REF:
+      return DML_TENSOR_DATA_TYPE_UINT8;
+    case DT_QINT8:
+    case DT_QINT8_REF:
+      return DML_TENSOR_DATA_TYPE_INT8;
+    case DT_QUINT16:
+    case DT_QUINT16_REF:
+      return DML_TENSOR_DATA_TYPE_UINT16;
+    case DT_QINT16:
+    case DT_QINT16_REF:
+      return DML_TENSOR_DATA_TYPE_INT16;
+    case DT_QINT32:
+    case DT_QINT32_REF:
+      return DML_TENSOR_DATA_TYPE_INT32;
     default:
       LOG(FATAL) << "Invalid or unsupported data type.";
   }
@@ -309,6 +328,69 @@ void CopyTensorInSameDevice(OpKernelContext* op_ctx, Tensor* dst,
       [op_ctx](const Status& s) { OP_REQUIRES_OK(op_ctx, s); });
 }
 
+bool CanUpdateVariableInPlace(OpKernelContext* op_ctx, Var* variable) {
+  // Copy-on-read mode promises readers a stable snapshot, so writers must
+  // always copy.
+  if (variable->copy_on_read_mode.load()) {
+    return false;
+  }
+
+  Tensor* tensor = variable->tensor();
+  if (tensor->RefCountIsOne()) {
+    return true;
+  }
+
+  // The buffer holds extra references. In-place mutation is still safe if all
+  // of them are runtime references for GPU reads that are ordered before the
+  // write this kernel is about to enqueue on the compute queue.
+  auto* device = static_cast<DmlDevice*>(op_ctx->device());
+  ID3D12Fence* compute_fence =
+      device->GetExecutionContext()->GetCurrentCompletionEvent().fence.Get();
+
+  return DmlTensorRefTracker::Instance()->OnlyTrackedReferencesRemain(
+      *tensor, compute_fence);
+}
+
+bool CanUpdateRefTensorInPlace(OpKernelContext* op_ctx, const Tensor& tensor) {
+  auto* device = static_cast<DmlDevice*>(op_ctx->device());
+  ID3D12Fence* compute_fence =
+      device->GetExecutionContext()->GetCurrentCompletionEvent().fence.Get();
+
+  // Two untracked references are expected even when the variable is
+  // unaliased: the variable's own and the caller's copy.
+  return DmlTensorRefTracker::Instance()->OnlyTrackedReferencesRemain(
+      tensor, compute_fence, /*allowed_untracked_refs=*/2);
+}
+
+Status EnsureRefTensorCopyOnWrite(OpKernelContext* op_ctx,
+                                  int ref_input_index) {
+  mutex_lock lock(*op_ctx->input_ref_mutex(ref_input_index));
+  Tensor tensor = op_ctx->mutable_input(ref_input_index, /*lock_held=*/true);
+
+  if (!tensor.IsInitialized() || CanUpdateRefTensorInPlace(op_ctx, tensor)) {
+    return Status::OK();
+  }
+
+  // The buffer has program-level aliases: redirect the variable to fresh
+  // storage holding a copy of its current value, and leave the old buffer to
+  // the aliases. The copy executes on the compute queue, so it's ordered
+  // before any write the caller subsequently enqueues there.
+  PersistentTensor copy;
+  Tensor* copy_tensor = nullptr;
+  TF_RETURN_IF_ERROR(op_ctx->allocate_persistent(
+      tensor.dtype(), tensor.shape(), &copy, &copy_tensor));
+
+  // Variable memory is tracked by the variable ops, not by whichever writer
+  // happened to trigger the copy.
+  op_ctx->clear_recorded_memory();
+
+  CopyTensorInSameDevice(op_ctx, copy_tensor, tensor);
+  op_ctx->replace_ref_input(ref_input_index, *copy_tensor,
+                            /*lock_held=*/true);
+
+  return Status::OK();
+}
+
 D3D12BufferRegion CreateBufferForTensor(const DmlDevice* device,
                                         const Tensor& tensor) {
   DmlAllocator* allocator = device->GetAllocator();
@@ -80,6 +80,8 @@ dml::TensorPolicy GetDmlXTensorPolicy(TensorFormat format);
 // for int64 emulation.
 dml::TensorPolicy GetEmulatedInt64TensorPolicy();
 
+class Var;
+
 namespace dml_util {
 
 // Kicks off a copy from the `src` GPU tensor to `dst` without waiting for it to
@@ -87,6 +89,31 @@ namespace dml_util {
 void CopyTensorInSameDevice(OpKernelContext* op_ctx, Tensor* dst,
                             const Tensor& src);
 
+// Returns true if `variable`'s tensor may be mutated in place by work about to
+// be enqueued on this device's compute queue, even though its buffer holds
+// extra references. This is the case when every extra reference is a
+// DmlTensorRefTracker-tracked runtime reference for a GPU read that is either
+// complete or ordered before subsequently enqueued compute work. The caller
+// must hold the variable's mutex exclusively.
+bool CanUpdateVariableInPlace(OpKernelContext* op_ctx, Var* variable);
+
+// The legacy-ref-variable analogue of CanUpdateVariableInPlace. `tensor` must
+// be the caller's own copy of the ref slot's tensor (e.g. from
+// OpKernelContext::mutable_input), so the unaliased baseline is two
+// references: the variable's and the caller's. Returns true if mutating the
+// buffer in place is safe for the same reasons as the resource-variable case.
+bool CanUpdateRefTensorInPlace(OpKernelContext* op_ctx, const Tensor& tensor);
+
+// Makes the ref-typed input at `ref_input_index` safe to mutate in place: if
+// its buffer still has program-level aliases (e.g. a Snapshot of the variable
+// flowing through the graph), the variable is redirected to fresh storage
+// holding a GPU copy of its current contents, and the aliases keep the old
+// buffer. This is the writer side of copy-on-write snapshots; kernels which
+// update ref variables in place must call it before binding the buffer for
+// write. Takes the ref mutex internally; the caller must not hold it.
+Status EnsureRefTensorCopyOnWrite(OpKernelContext* op_ctx,
+                                  int ref_input_index);
+
 D3D12BufferRegion CreateBufferForTensor(const DmlDevice* device,
                                         const Tensor& tensor);
 
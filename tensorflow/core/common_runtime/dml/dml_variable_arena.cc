@@ -0,0 +1,177 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "dml_variable_arena.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "dml_bfc_allocator.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Granularity of slot offsets and sizes. 256 bytes comfortably exceeds both
+// the Allocator interface's alignment requests and DirectML's minimum buffer
+// binding alignment, and keeps fragmentation bookkeeping coarse.
+constexpr uint64 kSlotAlignment = 256;
+
+// Size of a freshly-carved slab. Big enough to pack hundreds of small
+// variables, small enough that a mostly-empty trailing slab wastes little.
+constexpr uint64 kSlabSizeInBytes = 1024 * 1024;
+
+uint64 AlignUp(uint64 value, uint64 alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+DmlVariableArena::DmlVariableArena(DmlAllocator* allocator)
+    : allocator_(allocator) {}
+
+DmlVariableArena::~DmlVariableArena() {
+  for (auto& slab : slabs_) {
+    allocator_->DeallocateRaw(slab->base);
+  }
+}
+
+void* DmlVariableArena::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0) {
+    return nullptr;
+  }
+  DCHECK_LE(alignment, kSlotAlignment);
+
+  uint64 size = AlignUp(num_bytes, kSlotAlignment);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // First fit over the existing slabs' free lists. Slots are long-lived and
+  // uniformly small, so a fancier policy buys little.
+  Slab* slab = nullptr;
+  uint64 offset = 0;
+  for (auto& candidate : slabs_) {
+    for (const auto& block : candidate->free_blocks) {
+      if (block.second >= size) {
+        slab = candidate.get();
+        offset = block.first;
+        break;
+      }
+    }
+    if (slab) {
+      break;
+    }
+  }
+
+  if (!slab) {
+    uint64 slab_size = std::max(kSlabSizeInBytes, size);
+    void* base = allocator_->AllocateRaw(kSlotAlignment, slab_size);
+    if (!base) {
+      return nullptr;
+    }
+
+    auto new_slab = absl::make_unique<Slab>();
+    new_slab->base = base;
+    new_slab->size = slab_size;
+    new_slab->bytes_in_use = 0;
+    new_slab->free_blocks[0] = slab_size;
+    slab = new_slab.get();
+    slabs_.push_back(std::move(new_slab));
+    offset = 0;
+
+    VLOG(2) << "DmlVariableArena: carved new slab of " << slab_size
+            << " bytes";
+  }
+
+  // Carve the slot from the front of the free block.
+  auto it = slab->free_blocks.find(offset);
+  uint64 block_size = it->second;
+  slab->free_blocks.erase(it);
+  if (block_size > size) {
+    slab->free_blocks[offset + size] = block_size - size;
+  }
+  slab->bytes_in_use += size;
+
+  void* ptr = static_cast<uint8_t*>(slab->base) + offset;
+  allocations_[ptr] = {slab, offset, num_bytes, size};
+  return ptr;
+}
+
+void DmlVariableArena::DeallocateRaw(void* ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end());
+  Slab* slab = it->second.slab;
+  uint64 offset = it->second.offset;
+  uint64 size = it->second.allocated_size;
+  allocations_.erase(it);
+
+  slab->bytes_in_use -= size;
+
+  // Insert the freed block, then coalesce with its neighbors so free space
+  // remains usable for slightly larger future variables.
+  auto inserted = slab->free_blocks.emplace(offset, size).first;
+  if (inserted != slab->free_blocks.begin()) {
+    auto prev = std::prev(inserted);
+    if (prev->first + prev->second == inserted->first) {
+      prev->second += inserted->second;
+      slab->free_blocks.erase(inserted);
+      inserted = prev;
+    }
+  }
+  auto next = std::next(inserted);
+  if (next != slab->free_blocks.end() &&
+      inserted->first + inserted->second == next->first) {
+    inserted->second += next->second;
+    slab->free_blocks.erase(next);
+  }
+
+  if (slab->bytes_in_use == 0) {
+    allocator_->DeallocateRaw(slab->base);
+    for (auto slab_it = slabs_.begin(); slab_it != slabs_.end(); ++slab_it) {
+      if (slab_it->get() == slab) {
+        slabs_.erase(slab_it);
+        break;
+      }
+    }
+  }
+}
+
+size_t DmlVariableArena::RequestedSize(const void* ptr) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end());
+  return it->second.requested_size;
+}
+
+size_t DmlVariableArena::AllocatedSize(const void* ptr) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end());
+  return it->second.allocated_size;
+}
+
+bool DmlVariableArena::Owns(const void* ptr) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return allocations_.count(ptr) != 0;
+}
+
+}  // namespace tensorflow
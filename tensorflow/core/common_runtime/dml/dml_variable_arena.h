@@ -0,0 +1,95 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "dml_common.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class DmlAllocator;
+
+// Packs small, long-lived allocations into large slabs carved from the
+// device's BFC allocator. Models typically contain hundreds of small resource
+// variables (biases, norm parameters, scales) which would otherwise each
+// occupy a separate BFC chunk with rounding and alignment overhead; packing
+// co-locates them at stable offsets within a few big backing allocations.
+//
+// Returned pointers are interior tagged pointers into a slab's allocation,
+// so DmlAllocator::CreateBufferRegion resolves them to views over the slab's
+// D3D12 buffer with no changes to the binding path (the same mechanism scoped
+// allocators rely on).
+//
+// Freed slots return to a per-slab free list and are coalesced with their
+// neighbors; a fully-free slab is returned to the BFC allocator. Reuse of a
+// freed slot is safe for the same reason BFC reuse is safe: work that reads
+// the old contents was enqueued before the work that overwrites them.
+//
+// This class is thread-safe.
+class DmlVariableArena : public Allocator {
+ public:
+  // Allocations above this size gain little from packing and are better
+  // served by the BFC allocator directly; callers use this to decide whether
+  // to route an allocation through the arena.
+  static constexpr uint64 kMaxPackedAllocationBytes = 64 * 1024;
+
+  explicit DmlVariableArena(DmlAllocator* allocator);
+  ~DmlVariableArena() override;
+
+  string Name() override { return "DmlVariableArena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+
+  // Returns true if `ptr` is a live allocation handed out by this arena.
+  bool Owns(const void* ptr) const;
+
+ private:
+  struct Slab {
+    void* base;     // Tagged pointer returned by the BFC allocator
+    uint64 size;
+    uint64 bytes_in_use;
+
+    // Offset -> size of each free block, coalesced so no two entries are
+    // adjacent.
+    std::map<uint64, uint64> free_blocks;
+  };
+
+  struct Allocation {
+    Slab* slab;
+    uint64 offset;
+    uint64 requested_size;
+    uint64 allocated_size;
+  };
+
+  DmlAllocator* allocator_;  // weak; owned by the DML device factory
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Slab>> slabs_;
+  std::unordered_map<const void*, Allocation> allocations_;
+};
+
+}  // namespace tensorflow
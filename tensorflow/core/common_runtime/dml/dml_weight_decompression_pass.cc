@@ -0,0 +1,316 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsDmlDevice(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name().empty()
+                                            ? n->requested_device()
+                                            : n->assigned_device_name(),
+                                        &parsed) &&
+         parsed.type == "DML";
+}
+
+// Returns the single data consumer of `n`'s output if `n` has exactly one out
+// edge and it's a data edge, or nullptr otherwise. An outgoing control edge
+// disqualifies `n`: absorbing it would silently drop the ordering constraint.
+const Edge* GetSingleConsumerEdge(const Node* n) {
+  const Edge* consumer = nullptr;
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge() || consumer != nullptr) {
+      return nullptr;
+    }
+    consumer = e;
+  }
+  return consumer;
+}
+
+// A Cast eligible for absorption: it widens a half/int8-stored weight into
+// the consumer's compute type, on a DML device, feeding only the chain.
+bool IsDecompressionCast(const Node* n, DataType compute_type) {
+  if (n->type_string() != "Cast" || !IsDmlDevice(n)) {
+    return false;
+  }
+
+  DataType src_type, dst_type;
+  if (!TryGetNodeAttr(n->attrs(), "SrcT", &src_type) ||
+      !TryGetNodeAttr(n->attrs(), "DstT", &dst_type)) {
+    return false;
+  }
+
+  return (src_type == DT_HALF || src_type == DT_INT8) &&
+         dst_type == compute_type && src_type != dst_type;
+}
+
+// Reads the shape of a Const node's value without materializing the tensor.
+bool GetConstShape(const Node* n, TensorShape* shape) {
+  if (n->type_string() != "Const") {
+    return false;
+  }
+  const AttrValue* value = n->attrs().Find("value");
+  if (value == nullptr || !value->has_tensor() ||
+      !TensorShape::IsValid(value->tensor().tensor_shape())) {
+    return false;
+  }
+  *shape = TensorShape(value->tensor().tensor_shape());
+  return true;
+}
+
+// One MatMul or Conv2D whose weight operand decompresses through a Cast
+// (optionally followed by a dequantization-scale Mul) that nothing else
+// consumes.
+struct WeightChain {
+  Node* target;
+  Node* cast;
+  Node* mul = nullptr;  // Null when there's no scale.
+  NodeBuilder::NodeOut scale;
+};
+
+// Matches the weight producer chain of `n` (input 1). The optional Mul's
+// scale operand must be a Const whose shape provably reproduces the Mul's
+// broadcast inside the fused kernel: a scalar always does; a vector requires
+// the stored weight to be a Const whose trailing dimension matches, since the
+// fused kernel broadcasts the scale along that dimension.
+bool MatchWeightChain(Node* n, DataType compute_type, WeightChain* chain) {
+  const Edge* weight_edge;
+  if (!n->input_edge(1, &weight_edge).ok()) {
+    return false;
+  }
+
+  Node* producer = weight_edge->src();
+
+  if (producer->type_string() == "Mul" && IsDmlDevice(producer) &&
+      GetSingleConsumerEdge(producer) == weight_edge) {
+    // Either operand order: Mul(cast, scale) or Mul(scale, cast).
+    for (int scale_index : {1, 0}) {
+      const Edge* cast_edge;
+      const Edge* scale_edge;
+      if (!producer->input_edge(1 - scale_index, &cast_edge).ok() ||
+          !producer->input_edge(scale_index, &scale_edge).ok()) {
+        continue;
+      }
+
+      Node* cast = cast_edge->src();
+      if (!IsDecompressionCast(cast, compute_type) ||
+          GetSingleConsumerEdge(cast) != cast_edge) {
+        continue;
+      }
+
+      TensorShape scale_shape;
+      if (!GetConstShape(scale_edge->src(), &scale_shape) ||
+          scale_shape.dims() > 1) {
+        continue;
+      }
+
+      if (scale_shape.dims() == 1) {
+        const Edge* stored_edge;
+        TensorShape stored_shape;
+        if (!cast->input_edge(0, &stored_edge).ok() ||
+            !GetConstShape(stored_edge->src(), &stored_shape) ||
+            stored_shape.dims() == 0 ||
+            stored_shape.dim_size(stored_shape.dims() - 1) !=
+                scale_shape.dim_size(0)) {
+          continue;
+        }
+      }
+
+      chain->target = n;
+      chain->cast = cast;
+      chain->mul = producer;
+      chain->scale =
+          NodeBuilder::NodeOut(scale_edge->src(), scale_edge->src_output());
+      return true;
+    }
+    return false;
+  }
+
+  if (IsDecompressionCast(producer, compute_type) &&
+      GetSingleConsumerEdge(producer) == weight_edge) {
+    chain->target = n;
+    chain->cast = producer;
+    return true;
+  }
+
+  return false;
+}
+
+Status ReplaceChain(Graph* g, const WeightChain& chain) {
+  Node* n = chain.target;
+
+  DataType compute_type, stored_type;
+  TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "T", &compute_type));
+  TF_RETURN_IF_ERROR(GetNodeAttr(chain.cast->attrs(), "SrcT", &stored_type));
+
+  const Edge* input_edge;
+  TF_RETURN_IF_ERROR(n->input_edge(0, &input_edge));
+  const Edge* stored_weight_edge;
+  TF_RETURN_IF_ERROR(chain.cast->input_edge(0, &stored_weight_edge));
+
+  std::vector<NodeBuilder::NodeOut> scales;
+  if (chain.mul != nullptr) {
+    scales.push_back(chain.scale);
+  }
+
+  const bool is_matmul = n->type_string() == "MatMul";
+  const char* op_name = is_matmul ? "_DmlMatMulDecompressWeight"
+                                  : "_DmlConv2DDecompressWeight";
+
+  NodeDebugInfo debug_info(*n);
+  NodeBuilder builder(
+      g->NewName(strings::StrCat(n->name(), "/dml_decompress")), op_name,
+      OpRegistry::Global(), &debug_info);
+  builder.Device(n->requested_device())
+      .Input(NodeBuilder::NodeOut(input_edge->src(), input_edge->src_output()))
+      .Input(NodeBuilder::NodeOut(stored_weight_edge->src(),
+                                  stored_weight_edge->src_output()))
+      .Input(scales)
+      .Attr("T", compute_type)
+      .Attr(is_matmul ? "Tb" : "Tfilter", stored_type)
+      .Attr("num_scales", static_cast<int64>(scales.size()));
+
+  if (is_matmul) {
+    bool transpose_a, transpose_b;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "transpose_a", &transpose_a));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "transpose_b", &transpose_b));
+    builder.Attr("transpose_a", transpose_a).Attr("transpose_b", transpose_b);
+  } else {
+    std::vector<int32> strides, dilations, explicit_paddings;
+    string padding, data_format;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "strides", &strides));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "dilations", &dilations));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "padding", &padding));
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(n->attrs(), "explicit_paddings", &explicit_paddings));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "data_format", &data_format));
+    builder.Attr("strides", strides)
+        .Attr("dilations", dilations)
+        .Attr("padding", padding)
+        .Attr("explicit_paddings", explicit_paddings)
+        .Attr("data_format", data_format);
+  }
+
+  Node* fused = nullptr;
+  TF_RETURN_IF_ERROR(builder.Finalize(g, &fused));
+  fused->set_assigned_device_name(n->assigned_device_name());
+
+  // Incoming control edges from the whole chain move onto the fused node;
+  // the target's out edges become the fused node's out edges.
+  for (Node* member : {chain.target, chain.cast, chain.mul}) {
+    if (member == nullptr) {
+      continue;
+    }
+    for (const Edge* e : member->in_edges()) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(e->src(), fused);
+      }
+    }
+  }
+
+  std::vector<const Edge*> out_edges(n->out_edges().begin(),
+                                     n->out_edges().end());
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge()) {
+      g->AddControlEdge(fused, e->dst());
+    } else {
+      g->AddEdge(fused, 0, e->dst(), e->dst_input());
+    }
+  }
+
+  g->RemoveNode(chain.target);
+  g->RemoveNode(chain.cast);
+  if (chain.mul != nullptr) {
+    g->RemoveNode(chain.mul);
+  }
+
+  return Status::OK();
+}
+
+// Folds the weight-decompression pattern — a half/int8-stored weight widened
+// by a Cast and optionally rescaled by a Mul before feeding a MatMul or
+// Conv2D on a DML device — into _DmlMatMulDecompressWeight /
+// _DmlConv2DDecompressWeight nodes. The fused kernels widen the weight
+// in-flight, so the fp32 copy never occupies video memory and the standalone
+// Cast/Mul dispatches (one full pass over the weight each) disappear.
+class DmlWeightDecompressionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+
+    bool decompression_enabled;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_DIRECTML_WEIGHT_DECOMPRESSION",
+                                          /*default_val=*/true,
+                                          &decompression_enabled));
+    if (!decompression_enabled) {
+      return Status::OK();
+    }
+
+    Graph* g = options.graph->get();
+
+    // Gather first, then rewrite, so iteration never walks deleted nodes.
+    // Chains can't overlap: every absorbed node has a single consumer inside
+    // its own chain.
+    std::vector<WeightChain> chains;
+    for (Node* n : g->op_nodes()) {
+      if ((n->type_string() != "MatMul" && n->type_string() != "Conv2D") ||
+          !IsDmlDevice(n)) {
+        continue;
+      }
+
+      // The fused kernels are only registered for the DML float types.
+      DataType dtype;
+      if (!TryGetNodeAttr(n->attrs(), "T", &dtype) ||
+          (dtype != DT_FLOAT && dtype != DT_HALF)) {
+        continue;
+      }
+
+      WeightChain chain;
+      if (MatchWeightChain(n, dtype, &chain)) {
+        chains.push_back(chain);
+      }
+    }
+
+    for (const WeightChain& chain : chains) {
+      VLOG(1) << "DmlWeightDecompressionPass: fusing weight decompression "
+                 "into '"
+              << chain.target->name() << "'";
+      TF_RETURN_IF_ERROR(ReplaceChain(g, chain));
+    }
+
+    return Status::OK();
+  }
+};
+
+// Run after placement (device assignments must be known), and before the
+// elementwise fusion pass at phase 25, which would otherwise claim the
+// decompression Cast/Mul as an elementwise chain and hide the pattern.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 24,
+                      DmlWeightDecompressionPass);
+
+}  // namespace
+}  // namespace tensorflow
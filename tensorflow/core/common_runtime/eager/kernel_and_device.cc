@@ -80,6 +80,31 @@ Status KernelAndDeviceOp::Init(const NodeDef& ndef,
   }
   TF_RETURN_IF_ERROR(flr_->CreateKernel(ndef, &k));
   kernel_.reset(k);
+
+  // The kernel's memory types and the device's default context are fixed for
+  // the lifetime of this object; resolve them once here instead of on every
+  // Run.
+  input_alloc_attrs_.resize(kernel_->num_inputs());
+  for (size_t i = 0; i < input_alloc_attrs_.size(); ++i) {
+    input_alloc_attrs_[i].set_on_host(kernel_->input_memory_types()[i] ==
+                                      tensorflow::HOST_MEMORY);
+  }
+  output_alloc_attrs_.resize(kernel_->num_outputs());
+  for (size_t i = 0; i < output_alloc_attrs_.size(); ++i) {
+    output_alloc_attrs_[i].set_on_host(kernel_->output_memory_types()[i] ==
+                                       tensorflow::HOST_MEMORY);
+  }
+
+  if (device_->tensorflow_gpu_device_info() != nullptr) {
+    default_device_context_ =
+        device_->tensorflow_gpu_device_info()->default_context;
+  }
+#ifdef TENSORFLOW_USE_DIRECTML
+  else if (device_->dml_device_context() != nullptr) {
+    default_device_context_ = device_->dml_device_context();
+  }
+#endif
+
   return Status::OK();
 }
 
@@ -238,30 +263,10 @@ Status KernelAndDeviceOp::Run(ScopedStepContainer* step_container,
                               NodeExecStats* stats, StepStats* step_stats,
                               GraphCollector* graph_collector,
                               CancellationManager* cancellation_manager) {
-  gtl::InlinedVector<AllocatorAttributes, 4> in_attrs(kernel_->num_inputs());
-  for (size_t i = 0; i < in_attrs.size(); ++i) {
-    in_attrs[i].set_on_host(kernel_->input_memory_types()[i] ==
-                            tensorflow::HOST_MEMORY);
-  }
-  std::vector<AllocatorAttributes> out_attrs(kernel_->num_outputs());
-  for (size_t i = 0; i < out_attrs.size(); ++i) {
-    out_attrs[i].set_on_host(kernel_->output_memory_types()[i] ==
-                             tensorflow::HOST_MEMORY);
-  }
-
-  gtl::InlinedVector<DeviceContext*, 4> input_device_contexts;
-  for (int i = 0; i < inputs.size(); i++) {
-    DeviceContext* device_context = nullptr;
-    if (device_->tensorflow_gpu_device_info() != nullptr) {
-      device_context = device_->tensorflow_gpu_device_info()->default_context;
-    }
-#ifdef TENSORFLOW_USE_DIRECTML
-    else if (device_->dml_device_context() != nullptr) {
-      device_context = device_->dml_device_context();
-    }
-#endif
-    input_device_contexts.push_back(device_context);
-  }
+  // Allocator attributes and the device context were resolved at Init; only
+  // the per-input device context vector needs (trivially) filling here.
+  gtl::InlinedVector<DeviceContext*, 4> input_device_contexts(
+      inputs.size(), default_device_context_);
 
   OpKernelContext::Params params;
   params.is_eager = true;
@@ -270,8 +275,8 @@ Status KernelAndDeviceOp::Run(ScopedStepContainer* step_container,
   params.inputs = &inputs;
   params.op_kernel = kernel_.get();
   params.resource_manager = device_->resource_manager();
-  params.input_alloc_attrs = &in_attrs;
-  params.output_attr_array = gtl::vector_as_array(&out_attrs);
+  params.input_alloc_attrs = &input_alloc_attrs_;
+  params.output_attr_array = output_alloc_attrs_.data();
   params.function_library = flr_;
   params.slice_reader_cache = &slice_reader_cache_;
   params.rendezvous = rendez_;
@@ -172,6 +172,15 @@ class KernelAndDeviceOp final : public KernelAndDevice {
   Rendezvous* const rendez_;
   checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
   const bool log_memory_;
+
+  // Precomputed at Init from the kernel's memory types and the device, so the
+  // per-invocation Run doesn't rebuild them. This matters most for devices
+  // whose kernels declare many host-memory inputs (e.g. DML, where shape-like
+  // inputs are constant CPU inputs), since eager dispatch cost is then
+  // dominated by argument packing rather than compute.
+  gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs_;
+  std::vector<AllocatorAttributes> output_alloc_attrs_;
+  DeviceContext* default_device_context_ = nullptr;
 };
 
 // Represents a multi-device function. Functions can also be run using
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/sampling_profiler.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -46,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/edgeset.h"
+#include "tensorflow/core/lib/core/arena.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -950,11 +952,18 @@ class ExecutorState {
   typedef gtl::InlinedVector<Entry, 4> EntryVector;
 
   struct IterationState {
+    // If `arena` is non-null the entry storage is bump-allocated from it and
+    // only reclaimed when the arena is destroyed at the end of the step, so
+    // an arena is only passed for iteration 0 of a frame - which exists for
+    // the whole step anyway - never for the unbounded stream of loop
+    // iterations.
     explicit IterationState(const PendingCounts* pending_counts,
-                            int total_input_tensors)
-        : input_tensors(new Entry[total_input_tensors]),
+                            int total_input_tensors, core::Arena* arena)
+        : input_tensors(NewInputTensors(arena, total_input_tensors)),
           outstanding_ops(0),
           outstanding_frame_count(0),
+          total_input_tensors_(total_input_tensors),
+          arena_backed_(arena != nullptr),
           counts_(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
@@ -1000,9 +1009,33 @@ class ExecutorState {
                                     dead_result);
     }
 
-    ~IterationState() { delete[] input_tensors; }
+    ~IterationState() {
+      if (arena_backed_) {
+        // The arena reclaims the storage; only the entry destructors run.
+        for (int i = 0; i < total_input_tensors_; ++i) {
+          input_tensors[i].~Entry();
+        }
+      } else {
+        delete[] input_tensors;
+      }
+    }
 
    private:
+    static Entry* NewInputTensors(core::Arena* arena,
+                                  int total_input_tensors) {
+      if (arena == nullptr || total_input_tensors == 0) {
+        return new Entry[total_input_tensors];
+      }
+      Entry* entries = reinterpret_cast<Entry*>(arena->AllocAligned(
+          sizeof(Entry) * total_input_tensors, alignof(Entry)));
+      for (int i = 0; i < total_input_tensors; ++i) {
+        new (&entries[i]) Entry();
+      }
+      return entries;
+    }
+
+    const int total_input_tensors_;
+    const bool arena_backed_;
     PendingCounts counts_;
   };
 
@@ -1095,6 +1128,9 @@ class ExecutorState {
     // Static information specific to this frame.
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
+    // Step-lifetime arena owned by the ExecutorState; used for iteration 0's
+    // entry storage. Not owned.
+    core::Arena* step_arena = nullptr;
     std::vector<const Node*>* nodes = nullptr;
 
     // Lock ordering: ExecutorState.mu_ < mu;
@@ -1282,6 +1318,11 @@ class ExecutorState {
   // The root frame in which the execution of this step is started.
   FrameState* root_frame_;
 
+  // Bump arena for allocations whose lifetime ends with the step (currently
+  // the per-frame iteration-0 entry arrays). Destroyed after the frames in
+  // ~ExecutorState, which is when the step's memory is reclaimed.
+  core::Arena step_arena_{16 << 10};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -1420,8 +1461,10 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
 
   // Initialize iteration 0.
   root_frame_->iterations.resize(root_frame_->max_parallel_iterations);
-  root_frame_->iterations[0] = new IterationState(
-      root_frame_->pending_counts, root_frame_->total_input_tensors);
+  root_frame_->step_arena = &step_arena_;
+  root_frame_->iterations[0] =
+      new IterationState(root_frame_->pending_counts,
+                         root_frame_->total_input_tensors, &step_arena_);
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
 }
@@ -1681,6 +1724,13 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
   EntryVector outputs;
   bool completed = false;
   inline_ready.push_back(tagged_node);
+
+  // The inline loop below issues a run of this device's ops back-to-back from
+  // this thread. Bracket it so devices which batch submitted work can align
+  // their flush boundaries with the end of the run rather than splitting it
+  // on a timer.
+  ScopedOpRun op_run_scope(device);
+
   while (!inline_ready.empty()) {
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
@@ -1842,7 +1892,12 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
           tracing::ScopedAnnotation annotation(kernel_label);
           device->Compute(op_kernel, &ctx);
         } else {
-          // In the common case, avoid creating any tracing objects.
+          // In the common case, avoid creating any tracing objects, but let
+          // the always-on sampling profiler time ~1/128 dispatches. (The
+          // traced branch above is already fully instrumented.)
+          const bool sample_dispatch = sampling_profiler::ShouldSample();
+          const uint64 dispatch_start_usecs =
+              sample_dispatch ? Env::Default()->NowMicros() : 0;
           if (op_kernel->IsExpensive()) {
             KernelTimer timer;
             device->Compute(op_kernel, &ctx);
@@ -1850,6 +1905,11 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
           } else {
             device->Compute(op_kernel, &ctx);
           }
+          if (sample_dispatch) {
+            sampling_profiler::RecordSampledDispatch(
+                op_kernel->type_string(),
+                Env::Default()->NowMicros() - dispatch_start_usecs);
+          }
         }
 
         nodestats::SetOpEnd(stats);
@@ -2581,8 +2641,9 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
   // 'iterations' is a fixed-length circular buffer.
   temp->iterations.resize(temp->max_parallel_iterations + 1);
   // Initialize iteration 0.
-  temp->iterations[0] =
-      new IterationState(temp->pending_counts, temp->total_input_tensors);
+  temp->step_arena = &step_arena_;
+  temp->iterations[0] = new IterationState(
+      temp->pending_counts, temp->total_input_tensors, &step_arena_);
 
   {
     mutex_lock executor_lock(mu_);
@@ -2838,8 +2899,11 @@ void ExecutorState::FrameState::IncrementIteration(const GraphView* gview,
   const int64 next_iter = iteration_count;
 
   // Initialize the next iteration.
+  // Loop iterations are created and destroyed an unbounded number of times
+  // per step, so their entry storage stays heap-backed rather than growing
+  // the step arena.
   IterationState* iter_state =
-      new IterationState(pending_counts, total_input_tensors);
+      new IterationState(pending_counts, total_input_tensors, nullptr);
   SetIteration(next_iter, iter_state);
   num_outstanding_iterations++;
   dead_exits.clear();
@@ -47,10 +47,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifndef IS_MOBILE_PLATFORM
@@ -170,7 +174,7 @@ GraphExecutionState::~GraphExecutionState() {
 }
 
 Status GraphExecutionState::Extend(
-    const GraphDef& extension_def,
+    GraphDef&& extension_def,
     std::unique_ptr<GraphExecutionState>* out) const {
   if (session_options_->config.experimental().optimize_for_static_graph()) {
     return errors::FailedPrecondition(
@@ -206,7 +210,11 @@ Status GraphExecutionState::Extend(
 
   // 4. Merge the versions field.
   int old_node_size = gdef.node_size();
-  gdef.mutable_node()->MergeFrom(extension_def.node());
+  // Move the extension nodes into the merged graph instead of copying them;
+  // `extension_def` is consumed by this call.
+  for (NodeDef& node : *extension_def.mutable_node()) {
+    *gdef.add_node() = std::move(node);
+  }
   TF_RETURN_IF_ERROR(
       AddDefaultAttrsToGraphDef(&gdef, *flib_def_, old_node_size));
   // Merge versions
@@ -394,7 +402,11 @@ bool IsFeedAndFetchSupported(DataType dtype, const string& device_type) {
   // TODO(ashankar): Instead of a whitelist here, perhaps we could query
   // the kernel registry for _Arg and _Retval kernels instead.
   if (device_type == DEVICE_CPU) return true;
-  if (device_type != DEVICE_GPU) return false;
+  // DML registers device-memory _Arg and _Retval kernels for the same types
+  // as GPU (see function_ops.cc), so device feeds/fetches - used to chain one
+  // callable's GPU outputs into another's inputs without a host round trip -
+  // are supported for the same whitelist.
+  if (device_type != DEVICE_GPU && device_type != DEVICE_DML) return false;
   switch (dtype) {
     case DT_BFLOAT16:
     case DT_BOOL:
@@ -631,6 +643,58 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
   return Status::OK();
 }
 
+namespace {
+
+// Returns the directory that persists grappler results across process
+// restarts, or the empty string if the optimized-graph cache is disabled.
+string OptimizedGraphCacheDir() {
+  string cache_dir;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPH_OPTIMIZATION_CACHE_PATH", "",
+                                   &cache_dir));
+  return cache_dir;
+}
+
+// Computes a fingerprint of everything the meta optimizer's output depends
+// on: the graph (including its function library), the session configuration
+// (which selects and tunes the optimizers), the feeds and fetches the
+// GrapplerItem was built with, and the identity of the devices the graph was
+// placed against. Device incarnations are deliberately left out since they
+// change on every process start.
+uint64 OptimizedGraphCacheKey(const grappler::GrapplerItem& item,
+                              const ConfigProto& config,
+                              const DeviceSet& device_set) {
+  uint64 key = DeterministicProtoHash64(item.graph);
+  key = Hash64Combine(key, DeterministicProtoHash64(config));
+  for (const string& fetch : item.fetch) {
+    key = Hash64Combine(key, Hash64(fetch));
+  }
+  for (const auto& feed : item.feed) {
+    key = Hash64Combine(key, Hash64(feed.first));
+    key = Hash64Combine(key, static_cast<uint64>(feed.second.dtype()));
+    for (int i = 0; i < feed.second.dims(); ++i) {
+      key = Hash64Combine(key, static_cast<uint64>(feed.second.dim_size(i)));
+    }
+  }
+  std::vector<string> device_fingerprints;
+  device_fingerprints.reserve(device_set.devices().size());
+  for (const Device* d : device_set.devices()) {
+    const DeviceAttributes& attributes = d->attributes();
+    // physical_device_desc identifies the hardware (for DML devices, the
+    // adapter name, vendor and driver version), so a driver upgrade or an
+    // adapter swap invalidates cached graphs.
+    device_fingerprints.push_back(strings::StrCat(
+        attributes.name(), "|", attributes.device_type(), "|",
+        attributes.memory_limit(), "|", attributes.physical_device_desc()));
+  }
+  std::sort(device_fingerprints.begin(), device_fingerprints.end());
+  for (const string& fingerprint : device_fingerprints) {
+    key = Hash64Combine(key, Hash64(fingerprint));
+  }
+  return key;
+}
+
+}  // namespace
+
 Status GraphExecutionState::OptimizeGraph(
     const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
     std::unique_ptr<FunctionLibraryDefinition>* optimized_flib) {
@@ -730,10 +794,55 @@ Status GraphExecutionState::OptimizeGraph(
         cpu_device = device;
       }
     }
+    // When TF_GRAPH_OPTIMIZATION_CACHE_PATH is set, persist the meta
+    // optimizer's output across process restarts, keyed by a fingerprint of
+    // the graph, session config, feeds/fetches and device set. Workers that
+    // restart with a byte-identical setup then skip the full grappler
+    // pipeline. Reads and writes are best-effort: a missing, stale or
+    // malformed entry just falls through to running the optimizers.
+    const string cache_dir = OptimizedGraphCacheDir();
+    string cache_file;
+    if (!cache_dir.empty()) {
+      const uint64 cache_key =
+          OptimizedGraphCacheKey(item, session_options_->config, *device_set_);
+      cache_file = io::JoinPath(
+          cache_dir, strings::StrCat("optimized_graph_",
+                                     strings::Hex(cache_key, strings::kZeroPad16),
+                                     ".pb"));
+    }
+
     grappler::VirtualCluster cluster(device_set_);
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
-        item, session_options_->config, cpu_device, &cluster, &new_graph));
+    bool loaded_from_cache = false;
+    if (!cache_file.empty()) {
+      Status load_status =
+          ReadBinaryProto(Env::Default(), cache_file, &new_graph);
+      if (load_status.ok()) {
+        VLOG(1) << "Loaded optimized graph from " << cache_file;
+        loaded_from_cache = true;
+      } else if (!errors::IsNotFound(load_status)) {
+        LOG(WARNING) << "Failed to load optimized graph cache entry "
+                     << cache_file << ": " << load_status.error_message();
+      }
+    }
+
+    if (!loaded_from_cache) {
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          item, session_options_->config, cpu_device, &cluster, &new_graph));
+
+      if (!cache_file.empty()) {
+        Status save_status = Env::Default()->RecursivelyCreateDir(cache_dir);
+        if (save_status.ok()) {
+          save_status = WriteBinaryProto(Env::Default(), cache_file, new_graph);
+        }
+        if (save_status.ok()) {
+          VLOG(1) << "Saved optimized graph to " << cache_file;
+        } else {
+          LOG(WARNING) << "Failed to save optimized graph cache entry "
+                       << cache_file << ": " << save_status.error_message();
+        }
+      }
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -0,0 +1,55 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_warmup_registry.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+static mutex kernel_warmup_registry_lock(LINKER_INITIALIZED);
+
+typedef std::unordered_map<string, KernelWarmupRegistry::WarmupFn>
+    KernelWarmupFns;
+KernelWarmupFns* kernel_warmup_fns() {
+  static KernelWarmupFns* fns = new KernelWarmupFns;
+  return fns;
+}
+
+}  // namespace
+
+void KernelWarmupRegistry::Register(const string& device_type, WarmupFn fn) {
+  mutex_lock l(kernel_warmup_registry_lock);
+  if (!kernel_warmup_fns()->emplace(device_type, std::move(fn)).second) {
+    LOG(FATAL) << "Two kernel warmup functions are being registered under "
+               << device_type;
+  }
+}
+
+const KernelWarmupRegistry::WarmupFn* KernelWarmupRegistry::Lookup(
+    const string& device_type) {
+  tf_shared_lock l(kernel_warmup_registry_lock);
+  auto iter = kernel_warmup_fns()->find(device_type);
+  if (iter == kernel_warmup_fns()->end()) {
+    return nullptr;
+  }
+  return &iter->second;
+}
+
+}  // namespace tensorflow
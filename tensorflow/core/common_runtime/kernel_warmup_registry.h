@@ -0,0 +1,61 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_WARMUP_REGISTRY_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_WARMUP_REGISTRY_H_
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Device;
+class Graph;
+
+// Registry of per-device-type functions that pre-build ("warm up") the device
+// kernels a graph partition will need, before the first Run executes it.
+// Devices whose kernels are compiled lazily on first use (such as DML) can
+// register a function here so that DirectSession::WarmupKernels reaches them
+// without the session layer depending on device-specific code.
+class KernelWarmupRegistry {
+ public:
+  // Warms up the kernels that `graph` (a single graph partition assigned to
+  // `device`) will execute. `feed_shapes` maps feed tensor names, exactly as
+  // they will later be passed to Session::Run, to the shapes of the tensors
+  // that will be fed. Nodes whose kernels cannot be built ahead of time (e.g.
+  // because their input shapes are not statically known) must be skipped, not
+  // failed.
+  typedef std::function<Status(
+      Device* device, const Graph& graph,
+      const std::map<string, TensorShape>& feed_shapes)>
+      WarmupFn;
+
+  // Registers `fn` as the warmup function for devices of the given type.
+  // Dies if a function is already registered for `device_type`.
+  static void Register(const string& device_type, WarmupFn fn);
+
+  // Returns the warmup function registered for `device_type`, or nullptr if
+  // there is none.
+  static const WarmupFn* Lookup(const string& device_type);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_WARMUP_REGISTRY_H_
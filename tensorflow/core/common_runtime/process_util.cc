@@ -22,10 +22,14 @@ limitations under the License.
 #endif  // INTEL_MKL
 #include <string.h>
 
+#include <atomic>
+
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -126,8 +130,26 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options) {
   const int32 num_threads = NumInterOpThreadsFromSessionOptions(options);
   VLOG(1) << "Direct session inter op parallelism threads: " << num_threads;
+  ThreadOptions thread_opts;
+  string name = "Compute";
+  if (options.config.experimental().use_numa_affinity() &&
+      port::NUMAEnabled()) {
+    // Pin each session's inter-op pool to a single NUMA node, round-robining
+    // nodes across sessions. Executor threads then stay on one socket, and
+    // the intra-op pools and CPU allocators (already NUMA-partitioned; see
+    // local_device.cc and threadpool_device_factory.cc) keep the tensors they
+    // touch local to it. With one session per socket this partitions the
+    // machine; a single session at least gets a stable home node instead of
+    // its threads bouncing between sockets. Work-stealing still happens
+    // within each pool, so this only fences stealing across nodes.
+    static std::atomic<int> next_numa_node{0};
+    const int numa_node = next_numa_node++ % port::NUMANumNodes();
+    VLOG(1) << "Pinning inter op thread pool to NUMA node " << numa_node;
+    thread_opts.numa_node = numa_node;
+    name = strings::StrCat("numa_", numa_node, "_Compute");
+  }
   return new thread::ThreadPool(
-      options.env, ThreadOptions(), "Compute", num_threads,
+      options.env, thread_opts, name, num_threads,
       !options.config.experimental().disable_thread_spinning(),
       /*allocator=*/nullptr);
 }
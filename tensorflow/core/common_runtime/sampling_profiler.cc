@@ -0,0 +1,72 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sampling_profiler.h"
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace sampling_profiler {
+namespace {
+
+// A power of two so the sampling decision is a mask instead of a modulo.
+constexpr uint32 kSamplePeriod = 128;
+
+auto* sampled_dispatch_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/executor/sampled_dispatch_time_usecs",
+     "Wall time of sampled (~1/128) node dispatches, by op type.", "op_type"},
+    // 1 us to ~1 s.
+    monitoring::Buckets::Exponential(1, 2, 20));
+
+bool SamplingEnabled() {
+  static const bool enabled = [] {
+    bool disabled = false;
+    Status s = ReadBoolFromEnvVar("TF_DISABLE_SAMPLING_PROFILER",
+                                  /*default_val=*/false, &disabled);
+    if (!s.ok()) {
+      disabled = false;
+    }
+    return !disabled;
+  }();
+  return enabled;
+}
+
+}  // namespace
+
+bool ShouldSample() {
+  if (!SamplingEnabled()) {
+    return false;
+  }
+
+  // Per-thread xorshift32. Statistical quality hardly matters here, only
+  // cost; seeding with the thread ID keeps threads from sampling in lockstep.
+  static thread_local uint32 state =
+      static_cast<uint32>(Env::Default()->GetCurrentThreadId()) * 2654435761u |
+      1u;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return (state & (kSamplePeriod - 1)) == 0;
+}
+
+void RecordSampledDispatch(const string& op_type, uint64 dispatch_time_usecs) {
+  sampled_dispatch_time_usecs->GetCell(op_type)->Add(
+      static_cast<double>(dispatch_time_usecs));
+}
+
+}  // namespace sampling_profiler
+}  // namespace tensorflow
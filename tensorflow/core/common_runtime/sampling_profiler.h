@@ -0,0 +1,47 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLING_PROFILER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLING_PROFILER_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace sampling_profiler {
+
+// Always-on, low-overhead sampling profiler for the executor's dispatch hot
+// path. FULL_TRACE gives complete per-op visibility but costs far too much to
+// leave enabled in production; this instead times roughly 1 in 128 node
+// dispatches and aggregates the samples into a per-op-type histogram
+// (/tensorflow/executor/sampled_dispatch_time_usecs) exported through the
+// lib/monitoring collection registry, so a steady-state breakdown of where
+// step time goes is retrievable from any running process.
+//
+// Set TF_DISABLE_SAMPLING_PROFILER=1 to turn sampling off entirely.
+
+// Returns true for ~1 in 128 calls. The decision is a thread-local xorshift
+// step and a mask; call this once per dispatch and collect timestamps only
+// when it returns true, which keeps the un-sampled path to a few
+// instructions.
+bool ShouldSample();
+
+// Records one sampled dispatch of an op of type `op_type` that took
+// `dispatch_time_usecs` of wall time.
+void RecordSampledDispatch(const string& op_type, uint64 dispatch_time_usecs);
+
+}  // namespace sampling_profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLING_PROFILER_H_
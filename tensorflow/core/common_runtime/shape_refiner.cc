@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
@@ -31,7 +34,10 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -61,6 +67,67 @@ namespace {
 constexpr char kArgOp[] = "_Arg";
 constexpr char kRetvalOp[] = "_Retval";
 
+// Process-wide memoization of shape function results, shared across
+// ShapeRefiner instances so repeated graph constructions (optimization
+// passes, Callable creation) and repeated subgraph patterns within one large
+// graph skip re-running identical inferences. Entries are keyed by op type,
+// graph def version, attrs and input shapes, and only created for inferences
+// that provably depend on nothing else: no constant input tensors were
+// requested, and no resource handle data flowed in or out. Disable with
+// TF_SHAPE_INFERENCE_CACHE=false.
+struct ShapeInferenceCache {
+  mutex mu;
+  std::unordered_map<string, std::vector<TensorShapeProto>> entries
+      GUARDED_BY(mu);
+};
+
+// Bound on cache entries; the cache is simply dropped when it fills up, like
+// other unbounded-key caches in this codebase.
+constexpr size_t kShapeInferenceCacheMaxEntries = 65536;
+
+ShapeInferenceCache* GlobalShapeInferenceCache() {
+  static ShapeInferenceCache* cache = new ShapeInferenceCache;
+  return cache;
+}
+
+bool ShapeInferenceCacheEnabled() {
+  static const bool enabled = [] {
+    bool value = true;
+    Status s =
+        ReadBoolFromEnvVar("TF_SHAPE_INFERENCE_CACHE", true, &value);
+    if (!s.ok()) {
+      LOG(WARNING) << s.error_message();
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+// Builds the memoization key for `node`'s inference, or returns false if the
+// inference is not cacheable (input handle data may influence the result but
+// is not part of the key).
+bool BuildShapeCacheKey(const Node* node, InferenceContext* c,
+                        int graph_def_version, string* key) {
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->input_handle_shapes_and_types(i) != nullptr) {
+      return false;
+    }
+  }
+  strings::StrAppend(key, node->type_string(), "|", graph_def_version);
+  std::vector<std::pair<string, string>> attrs;
+  for (const auto& attr : node->attrs()) {
+    attrs.emplace_back(attr.first, attr.second.SerializeAsString());
+  }
+  std::sort(attrs.begin(), attrs.end());
+  for (const auto& attr : attrs) {
+    strings::StrAppend(key, "|", attr.first, "=", attr.second);
+  }
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    strings::StrAppend(key, "|", c->DebugString(c->input(i)));
+  }
+  return true;
+}
+
 // Runs shape inference for the given node using the given ShapeRefiner.
 // The node must be a sub-node of a function node and the outer_context is
 // the inference context of that function node in the outer graph.
@@ -659,6 +726,42 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   c->set_input_tensors(input_tensors);
   c->set_input_tensors_as_shapes(input_tensors_as_shapes);
 
+  // Try to serve the inference from the memoization cache. Function calls are
+  // excluded: their results depend on the function library, not just the
+  // node signature.
+  string cache_key;
+  bool cache_eligible =
+      ShapeInferenceCacheEnabled() && op_reg_data->shape_inference_fn &&
+      !(function_library_ && IsFunctionCall(*function_library_, *node)) &&
+      BuildShapeCacheKey(node, c, graph_def_version_, &cache_key);
+  if (cache_eligible) {
+    ShapeInferenceCache* cache = GlobalShapeInferenceCache();
+    std::vector<TensorShapeProto> cached_outputs;
+    bool hit = false;
+    {
+      mutex_lock l(cache->mu);
+      auto it = cache->entries.find(cache_key);
+      if (it != cache->entries.end()) {
+        cached_outputs = it->second;
+        hit = true;
+      }
+    }
+    if (hit) {
+      if (static_cast<int>(cached_outputs.size()) != c->num_outputs()) {
+        return errors::Internal(
+            "Cached shape inference result for ", node->type_string(),
+            " has ", cached_outputs.size(), " outputs, expected ",
+            c->num_outputs());
+      }
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        ShapeHandle h;
+        TF_RETURN_IF_ERROR(c->MakeShapeFromShapeProto(cached_outputs[i], &h));
+        c->set_output(i, h);
+      }
+      return Status::OK();
+    }
+  }
+
   // Run the shape inference function, and return if there was an error.
   // Capture as lambda, because we might need to re-run inference later on.
   auto run_inference_lambda = [&]() {
@@ -761,6 +864,37 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
     }
   } while (rerun_shape_fn);
 
+  if (cache_eligible) {
+    // Only memoize results that are a pure function of the key: the shape
+    // function must not have consulted input tensor values, and no handle
+    // data may flow out (handle data is not captured in the cache entry).
+    bool pure = true;
+    for (int i = 0; i < c->num_inputs(); ++i) {
+      if (c->requested_input_tensor(i) ||
+          c->requested_input_tensor_as_partial_shape(i)) {
+        pure = false;
+        break;
+      }
+    }
+    for (int i = 0; pure && i < c->num_outputs(); ++i) {
+      if (c->output_handle_shapes_and_types(i) != nullptr) {
+        pure = false;
+      }
+    }
+    if (pure) {
+      std::vector<TensorShapeProto> outputs(c->num_outputs());
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->ShapeHandleToProto(c->output(i), &outputs[i]);
+      }
+      ShapeInferenceCache* cache = GlobalShapeInferenceCache();
+      mutex_lock l(cache->mu);
+      if (cache->entries.size() >= kShapeInferenceCacheMaxEntries) {
+        cache->entries.clear();
+      }
+      cache->entries.emplace(std::move(cache_key), std::move(outputs));
+    }
+  }
+
   return Status::OK();
 }
 
@@ -1441,8 +1441,10 @@ Status MasterSession::Extend(const ExtendSessionRequest* req,
     }
 
     CHECK(execution_state_);
-    TF_RETURN_IF_ERROR(
-        execution_state_->Extend(req->graph_def(), &extended_execution_state));
+    // The request proto is const, so a copy of the extension is unavoidable
+    // here; `Extend()` consumes it without further copies.
+    TF_RETURN_IF_ERROR(execution_state_->Extend(GraphDef(req->graph_def()),
+                                                &extended_execution_state));
 
     CHECK(extended_execution_state);
     // The old execution state will be released outside the lock.
@@ -136,6 +136,7 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 }
 
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              bool is_fp16_compressed,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   RecvTensorResponse response;
@@ -143,6 +144,9 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     response.set_is_dead(is_dead);
   }
   response.set_require_ack(require_ack);
+  if (is_fp16_compressed) {
+    response.set_is_fp16_compressed(true);
+  }
   response.set_send_start_micros(Env::Default()->NowMicros());
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
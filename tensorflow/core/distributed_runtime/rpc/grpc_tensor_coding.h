@@ -45,8 +45,14 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 //
 // "val" holds the tensor value to be encoded.
 //
+// "is_fp16_compressed" is the value to encode for
+// "RecvTensorResponse::is_fp16_compressed". When true, the caller has
+// already cast "val" to DT_HALF and the receiver is expected to widen it
+// back to DT_FLOAT; this function only records the flag.
+//
 // Discards original contents of *result.
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              bool is_fp16_compressed,
                               ::grpc::ByteBuffer* result);
 
 }  // namespace grpc
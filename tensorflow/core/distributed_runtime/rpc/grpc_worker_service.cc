@@ -55,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -434,6 +435,29 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = absl::make_unique<GrpcResponseCache>();
 }
 
+// Returns true if outgoing float tensors should be cast to half precision
+// on the wire (RecvTensorResponse::is_fp16_compressed). The cast is lossy,
+// so it is off by default; it mainly suits gradient exchange, where half
+// precision is usually tolerable and the bandwidth saving is 2x. Receivers
+// widen flagged tensors unconditionally, so only the sending worker needs
+// the variable set.
+static bool Fp16WireCompressionEnabled() {
+  static bool enabled = [] {
+    bool value = false;
+    Status s = ReadBoolFromEnvVar("TF_GRPC_FP16_TENSOR_COMPRESSION",
+                                  /*default_val=*/false, &value);
+    if (!s.ok()) {
+      LOG(WARNING) << s.error_message();
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+// Tensors smaller than this are sent uncompressed even when fp16 wire
+// compression is enabled; the cast overhead isn't worth the few saved bytes.
+static const size_t kMinFp16CompressedTensorBytes = 4096;
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -451,7 +475,18 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                                      bool is_dead,
                                                      const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      if (Fp16WireCompressionEnabled() && !is_dead &&
+          tensor.dtype() == DT_FLOAT &&
+          tensor.TotalBytes() >= kMinFp16CompressedTensorBytes) {
+        Tensor half_tensor(DT_HALF, tensor.shape());
+        half_tensor.flat<Eigen::half>() =
+            tensor.flat<float>().cast<Eigen::half>();
+        grpc::EncodeTensorToByteBuffer(is_dead, half_tensor, cache_enabled,
+                                       /*is_fp16_compressed=*/true, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       /*is_fp16_compressed=*/false, response);
+      }
     }
     done(status);
   };
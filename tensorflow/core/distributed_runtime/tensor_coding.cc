@@ -50,9 +50,48 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
 
+namespace {
+
+// Widens a tensor received with is_fp16_compressed set back to float. The
+// sender casts float tensors to DT_HALF before serialization to save wire
+// bandwidth; the receiver always undoes the cast, so the rendezvous only
+// ever sees the original dtype.
+Status WidenFp16Tensor(Allocator* allocator, Tensor* t) {
+  if (t->dtype() != DT_HALF) {
+    return errors::InvalidArgument(
+        "RecvTensorResponse is marked fp16-compressed but holds a tensor of "
+        "type ",
+        DataTypeString(t->dtype()));
+  }
+  Tensor widened(allocator, DT_FLOAT, t->shape());
+  widened.flat<float>() = t->flat<Eigen::half>().cast<float>();
+  *t = std::move(widened);
+  return Status::OK();
+}
+
+// As above, but for a TensorProto that is about to be handed to a device's
+// MakeTensorFromProto: the widening has to happen on the host, before the
+// contents are copied to the device.
+Status WidenFp16TensorProto(TensorProto* proto) {
+  Tensor half_tensor;
+  if (!half_tensor.FromProto(*proto)) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  Status s = WidenFp16Tensor(cpu_allocator(), &half_tensor);
+  if (!s.ok()) return s;
+  half_tensor.AsProtoTensorContent(proto);
+  return Status::OK();
+}
+
+}  // namespace
+
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
+  if (meta_.is_fp16_compressed()) {
+    s = WidenFp16TensorProto(meta_.mutable_tensor());
+    if (!s.ok()) return s;
+  }
   if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
@@ -88,6 +127,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (meta_.is_fp16_compressed()) {
+      Status widen_status = WidenFp16TensorProto(meta_.mutable_tensor());
+      if (!widen_status.ok()) return widen_status;
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -102,10 +145,18 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return Status::OK();
-  meta_.Clear();
-  if (ParseSlow(source)) return Status::OK();
-  return errors::InvalidArgument("Cannot parse tensor from response");
+  bool parsed = ParseFast(source);
+  if (!parsed) {
+    meta_.Clear();
+    parsed = ParseSlow(source);
+  }
+  if (!parsed) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  if (meta_.is_fp16_compressed()) {
+    return WidenFp16Tensor(allocator_, &tensor_);
+  }
+  return Status::OK();
 }
 
 // Define some helper routines for decoding protocol buffer wire format data
@@ -267,6 +318,12 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kIsFp16CompressedFieldNumber: {
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        meta_.set_is_fp16_compressed(v != 0);
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -156,6 +156,35 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, Fp16Compressed) {
+  // A float tensor sent as DT_HALF with is_fp16_compressed set must come
+  // back out of TensorResponse as DT_FLOAT.
+  Tensor src(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&src, {0.0, 1.0, 2.0, 3.0, 4.0, 5.0});
+  Tensor half_tensor(DT_HALF, src.shape());
+  half_tensor.flat<Eigen::half>() = src.flat<float>().cast<Eigen::half>();
+
+  RecvTensorResponse proto;
+  proto.set_is_fp16_compressed(true);
+  half_tensor.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  Status s = response.ParseFrom(&source);
+  EXPECT_TRUE(s.ok());
+  EXPECT_TRUE(response.metadata().is_fp16_compressed());
+
+  const Tensor& result = response.tensor();
+  EXPECT_EQ(result.dtype(), DT_FLOAT);
+  // All of src's values are exactly representable in half precision.
+  test::ExpectTensorEqual<float>(result, src);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -975,6 +975,28 @@ double Model::TotalProcessingTime(std::shared_ptr<Node> node) {
   return node->TotalProcessingTime(/*processing_times=*/nullptr);
 }
 
+/* static */ AcceleratorBusyTimeRegistry* AcceleratorBusyTimeRegistry::Global() {
+  static AcceleratorBusyTimeRegistry* registry =
+      new AcceleratorBusyTimeRegistry();
+  return registry;
+}
+
+void AcceleratorBusyTimeRegistry::Register(
+    std::function<uint64()> busy_micros_fn) {
+  mutex_lock l(mu_);
+  busy_micros_fns_.push_back(std::move(busy_micros_fn));
+}
+
+std::vector<uint64> AcceleratorBusyTimeRegistry::BusyMicros() const {
+  mutex_lock l(mu_);
+  std::vector<uint64> result;
+  result.reserve(busy_micros_fns_.size());
+  for (const auto& fn : busy_micros_fns_) {
+    result.push_back(fn());
+  }
+  return result;
+}
+
 }  // namespace model
 }  // namespace data
 }  // namespace tensorflow
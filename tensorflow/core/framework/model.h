@@ -675,6 +675,37 @@ class Model {
   const NodeHook remove_node_hook_;
 };
 
+// Process-wide registry of accelerator busy-time counters, used to make
+// autotuning aware of accelerator utilization.
+//
+// Accelerator runtimes (e.g. the DirectML device) register a callback that
+// reports the cumulative wall-clock time the device has spent executing work.
+// The `ModelDataset` optimization loop snapshots these counters between
+// optimization rounds to estimate per-device busy fractions; when a device is
+// starving, the input pipeline is the bottleneck and the autotuner is granted
+// additional CPU budget. With no registered devices the signal is absent and
+// autotuning behaves as before.
+class AcceleratorBusyTimeRegistry {
+ public:
+  // Returns the process-wide registry instance.
+  static AcceleratorBusyTimeRegistry* Global();
+
+  // Registers a callback that returns the cumulative number of wall-clock
+  // microseconds the device has spent executing work since its creation. The
+  // callback may be invoked from arbitrary threads for the lifetime of the
+  // process and must be thread-safe.
+  void Register(std::function<uint64()> busy_micros_fn);
+
+  // Returns the current value of every registered counter, in registration
+  // order. Devices are only ever added, so positions are stable across calls
+  // and callers can compute per-device deltas from successive snapshots.
+  std::vector<uint64> BusyMicros() const;
+
+ private:
+  mutable mutex mu_;
+  std::vector<std::function<uint64()>> busy_micros_fns_ GUARDED_BY(mu_);
+};
+
 }  // namespace model
 }  // namespace data
 }  // namespace tensorflow
@@ -727,6 +727,22 @@ TEST(UnknownGradientTest, Model) {
               (new_output_time - output_time) / kParameterStep,
               kComparisonPrecision);
 }
+
+TEST(AcceleratorBusyTimeRegistryTest, Basic) {
+  auto* registry = AcceleratorBusyTimeRegistry::Global();
+  size_t num_existing = registry->BusyMicros().size();
+  // The registry is process-global, so the callback must not reference test
+  // locals once this test returns.
+  auto counter = std::make_shared<uint64>(0);
+  registry->Register([counter]() { return *counter; });
+  *counter = 42;
+  std::vector<uint64> snapshot = registry->BusyMicros();
+  ASSERT_EQ(num_existing + 1, snapshot.size());
+  EXPECT_EQ(42, snapshot[num_existing]);
+  *counter = 100;
+  snapshot = registry->BusyMicros();
+  EXPECT_EQ(100, snapshot[num_existing]);
+}
 }  // namespace
 }  // namespace model
 }  // namespace data
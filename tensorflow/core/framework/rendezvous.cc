@@ -155,15 +155,16 @@ class LocalRendezvousImpl : public Rendezvous {
     uint64 key_hash = KeyHash(key.FullKey());
     VLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = ShardForHash(key_hash);
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       return s;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || queue->front()->IsSendValue()) {
       // There is no waiter for this message. Append the message
       // into the queue. The waiter will pick it up when arrives.
@@ -177,7 +178,7 @@ class LocalRendezvousImpl : public Rendezvous {
         item->send_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
       return Status::OK();
     }
 
@@ -188,11 +189,11 @@ class LocalRendezvousImpl : public Rendezvous {
     // Delete the queue when the last element has been consumed.
     if (queue->size() == 1) {
       VLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-      table_.erase(key_hash);
+      shard->table.erase(key_hash);
     } else {
       queue->pop_front();
     }
-    mu_.unlock();
+    shard->mu.unlock();
 
     // Notify the waiter by invoking its done closure, outside the
     // lock.
@@ -207,16 +208,17 @@ class LocalRendezvousImpl : public Rendezvous {
     uint64 key_hash = KeyHash(key.FullKey());
     VLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = ShardForHash(key_hash);
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       done(s, Args(), recv_args, Tensor(), false);
       return;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || !queue->front()->IsSendValue()) {
       // There is no message to pick up.
       // Only recv-related fields need to be filled.
@@ -229,14 +231,15 @@ class LocalRendezvousImpl : public Rendezvous {
                                                           key_hash] {
           Item* item = nullptr;
           {
-            mutex_lock l(mu_);
-            ItemQueue* queue = &table_[key_hash];
+            Shard* shard = ShardForHash(key_hash);
+            mutex_lock l(shard->mu);
+            ItemQueue* queue = &shard->table[key_hash];
             if (!queue->empty() && !queue->front()->IsSendValue()) {
               for (auto it = queue->begin(); it != queue->end(); it++) {
                 if ((*it)->cancellation_token == token) {
                   item = *it;
                   if (queue->size() == 1) {
-                    table_.erase(key_hash);
+                    shard->table.erase(key_hash);
                   } else {
                     queue->erase(it);
                   }
@@ -255,7 +258,7 @@ class LocalRendezvousImpl : public Rendezvous {
         });
       }
       if (already_cancelled) {
-        mu_.unlock();
+        shard->mu.unlock();
         done(StatusGroup::MakeDerived(
                  errors::Cancelled("RecvAsync is cancelled.")),
              Args(), recv_args, Tensor(), /*is_dead=*/false);
@@ -288,7 +291,7 @@ class LocalRendezvousImpl : public Rendezvous {
         item->recv_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
       return;
     }
 
@@ -300,11 +303,11 @@ class LocalRendezvousImpl : public Rendezvous {
     // Delete the queue when the last element has been consumed.
     if (queue->size() == 1) {
       VLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-      table_.erase(key_hash);
+      shard->table.erase(key_hash);
     } else {
       queue->pop_front();
     }
-    mu_.unlock();
+    shard->mu.unlock();
 
     // Invokes the done() by invoking its done closure, outside scope
     // of the table lock.
@@ -315,18 +318,24 @@ class LocalRendezvousImpl : public Rendezvous {
 
   void StartAbort(const Status& status) override {
     CHECK(!status.ok());
-    Table table;
-    {
-      mutex_lock l(mu_);
-      status_.Update(status);
-      table_.swap(table);
-    }
-    for (auto& p : table) {
-      for (Item* item : p.second) {
-        if (!item->IsSendValue()) {
-          item->waiter(status, Args(), Args(), Tensor(), false);
+    // Shards are aborted independently: each shard's status is set and its
+    // table swapped out under that shard's lock, so a concurrent Send/Recv
+    // either completes against the old table (and is drained below) or
+    // observes the aborted status.
+    for (Shard& shard : shards_) {
+      Table table;
+      {
+        mutex_lock l(shard.mu);
+        shard.status.Update(status);
+        shard.table.swap(table);
+      }
+      for (auto& p : table) {
+        for (Item* item : p.second) {
+          if (!item->IsSendValue()) {
+            item->waiter(status, Args(), Args(), Tensor(), false);
+          }
+          delete item;
         }
-        delete item;
       }
     }
   }
@@ -369,13 +378,30 @@ class LocalRendezvousImpl : public Rendezvous {
   typedef std::deque<Item*> ItemQueue;
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ GUARDED_BY(mu_);
-  Status status_ GUARDED_BY(mu_);
+  // The table is sharded by key hash so that concurrent Send/Recv pairs on
+  // different keys (e.g. the many device-boundary edges of a partitioned
+  // graph) contend on a shard's lock rather than on a single table-wide one.
+  // Each shard carries its own copy of the abort status so that the
+  // status-check-and-table-update in Send/Recv stays atomic under one lock.
+  struct Shard {
+    mutex mu;
+    Table table GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+  };
+
+  static const int kNumShards = 16;
+  Shard shards_[kNumShards];
+
+  Shard* ShardForHash(uint64 key_hash) {
+    return &shards_[key_hash % kNumShards];
+  }
 
   ~LocalRendezvousImpl() override {
-    if (!table_.empty()) {
+    bool empty = true;
+    for (Shard& shard : shards_) {
+      empty = empty && shard.table.empty();
+    }
+    if (!empty) {
       StartAbort(errors::Cancelled("LocalRendezvousImpl deleted"));
     }
   }
@@ -61,6 +61,10 @@ class TensorReference {
   // Convenience function for de-duplicating tensor references.
   size_t BufferHash() const { return std::hash<TensorBuffer*>()(buf_); }
 
+  // Return the current reference count on the underlying buffer, including
+  // this reference. Subject to the same caveats as RefCounted::RefCount().
+  int_fast32_t BufferRefCount() const { return buf_ ? buf_->RefCount() : 0; }
+
   // A constructor used only for tests
   explicit TensorReference(TensorBuffer* test_buffer) : buf_(test_buffer) {
     if (buf_) buf_->Ref();
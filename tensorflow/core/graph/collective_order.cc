@@ -14,13 +14,39 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/graph/collective_order.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace {
 
+// Computes the longest-path depth of every node from the graph's sources.
+// During backprop, gradients whose collectives sit shallower in the graph are
+// produced earlier in the step (the last layer's gradient is computed first),
+// so depth is a structural proxy for the order in which collective inputs
+// become available.
+absl::flat_hash_map<Node*, int> ComputeNodeDepths(const Graph* graph) {
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  absl::flat_hash_map<Node*, int> depths;
+  depths.reserve(order.size());
+  for (Node* node : order) {
+    int depth = 0;
+    for (const Edge* in_edge : node->in_edges()) {
+      auto it = depths.find(in_edge->src());
+      if (it != depths.end()) {
+        depth = std::max(depth, it->second + 1);
+      }
+    }
+    depths[node] = depth;
+  }
+  return depths;
+}
+
 // Find all CollectiveReduce nodes and the existing data dependencies between
 // them.
 Status DiscoverDataDependencies(
@@ -70,6 +96,7 @@ Status DiscoverDataDependencies(
 Status CreateControlDependencies(
     const std::vector<Node*>& collective_nodes,
     const std::vector<int32>& instance_keys,
+    const absl::flat_hash_map<Node*, int>& node_depths,
     absl::flat_hash_map<Node*, absl::flat_hash_set<int32>>* data_dependencies,
     absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>* dependency_edges) {
   // If there exists some path a -> ... -> b then `all_paths[a]` contains `b`
@@ -95,8 +122,22 @@ Status CreateControlDependencies(
       const auto& deps_j = (*data_dependencies)[collective_nodes[j]];
       if (deps_i.find(instance_keys[j]) == deps_i.end() &&
           deps_j.find(instance_keys[i]) == deps_j.end()) {
-        int src_idx = instance_keys[i] > instance_keys[j] ? i : j;
-        int dst_idx = instance_keys[i] > instance_keys[j] ? j : i;
+        // When depth ordering is enabled, launch the collective whose input
+        // lies shallower in the graph first: its gradient is produced earlier
+        // in backprop, so the chain matches input availability and each
+        // reduction overlaps with the backprop still computing later inputs.
+        // Ties (and the default) fall back to descending instance key, which
+        // is consistent across workers regardless of graph structure.
+        bool i_first = instance_keys[i] > instance_keys[j];
+        if (!node_depths.empty()) {
+          const int depth_i = node_depths.at(collective_nodes[i]);
+          const int depth_j = node_depths.at(collective_nodes[j]);
+          if (depth_i != depth_j) {
+            i_first = depth_i < depth_j;
+          }
+        }
+        int src_idx = i_first ? i : j;
+        int dst_idx = i_first ? j : i;
         Node* src_node = collective_nodes[src_idx];
         Node* dst_node = collective_nodes[dst_idx];
         VLOG(1) << "Adding control dependency from node " << src_node->name()
@@ -192,12 +233,28 @@ Status OrderCollectives(Graph* graph, GraphCollectiveOrder order_type) {
 
   if (collective_nodes.empty()) return Status::OK();
 
+  // With TF_COLLECTIVE_ORDER_BY_DEPTH=1, concurrent collectives are chained
+  // in order of their graph depth so launches follow the order in which
+  // backprop produces their inputs.  This requires every worker to build a
+  // structurally identical graph (as in typical synchronous replicated
+  // training); workers with divergent graph structure could otherwise
+  // disagree on the order and deadlock, hence the opt-in.
+  bool order_by_depth = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_COLLECTIVE_ORDER_BY_DEPTH",
+                                        /*default_val=*/false,
+                                        &order_by_depth));
+  absl::flat_hash_map<Node*, int> node_depths;
+  if (order_by_depth) {
+    node_depths = ComputeNodeDepths(graph);
+  }
+
   absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> dependency_edges;
   // For all pairs of collective nodes n1 and n2 on the same device, if n1 does
   // not depend on n2 and n2 does not depend on n1, then they are potentially
   // concurrent.  Create an arbitrary, deterministic ordering between them.
-  TF_RETURN_IF_ERROR(CreateControlDependencies(
-      collective_nodes, instance_keys, &data_dependencies, &dependency_edges));
+  TF_RETURN_IF_ERROR(CreateControlDependencies(collective_nodes, instance_keys,
+                                               node_depths, &data_dependencies,
+                                               &dependency_edges));
 
   return InsertControlDependencies(graph, order_type, dependency_edges);
 }
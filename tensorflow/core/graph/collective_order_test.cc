@@ -231,5 +231,58 @@ TEST(CollectiveOrderTest, Pruning) {
   VerifyAttrs(*graph, {{"c3", {4}}, {"c2", {3}}, {"c1", {2}}});
 }
 
+// Initialize the following graph:
+//
+//         a
+//        / \
+//       c1  id1
+//            |
+//           id2
+//            |
+//           c2
+//
+// c1's input is shallower than c2's even though c1 has the smaller instance
+// key.
+std::unique_ptr<Graph> InitGraphForDepthOrder() {
+  GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+  const string dev0 = "/job:localhost/replica:0/task:0/device:CPU:0";
+  Node* a = ops::SourceOp("TestParams",
+                          builder.opts().WithName("a").WithDevice(dev0));
+  CollectiveReduceNode(&builder, a, "c1", dev0, 1);
+  Node* id1 = ops::UnaryOp(
+      "Identity", a,
+      builder.opts().WithName("id1").WithDevice(dev0).WithAttr("T", DT_FLOAT));
+  Node* id2 = ops::UnaryOp(
+      "Identity", id1,
+      builder.opts().WithName("id2").WithDevice(dev0).WithAttr("T", DT_FLOAT));
+  CollectiveReduceNode(&builder, id2, "c2", dev0, 2);
+
+  std::unique_ptr<Graph> graph = absl::make_unique<Graph>(OpRegistry::Global());
+  Status s = GraphDefBuilderToGraph(builder, graph.get());
+  if (!s.ok()) {
+    LOG(FATAL) << "Error building graph " << s;
+  }
+  return graph;
+}
+
+// Tests that with TF_COLLECTIVE_ORDER_BY_DEPTH enabled, the collective whose
+// input is produced earlier (shallower in the graph) is ordered first, even
+// though key order would put c2 first.
+TEST(CollectiveOrderTest, DepthOrder) {
+  setenv("TF_COLLECTIVE_ORDER_BY_DEPTH", "1", 1 /* overwrite */);
+  std::unique_ptr<Graph> graph = InitGraphForDepthOrder();
+  TF_EXPECT_OK(OrderCollectives(graph.get(), GraphCollectiveOrder::kEdges));
+  VerifyGraph(*graph, {"c1", "c2"}, {{"c1", "c2"}});
+  unsetenv("TF_COLLECTIVE_ORDER_BY_DEPTH");
+}
+
+// Tests that without the environment variable, the same graph is ordered by
+// descending instance key.
+TEST(CollectiveOrderTest, DepthOrderDisabledByDefault) {
+  std::unique_ptr<Graph> graph = InitGraphForDepthOrder();
+  TF_EXPECT_OK(OrderCollectives(graph.get(), GraphCollectiveOrder::kEdges));
+  VerifyGraph(*graph, {"c1", "c2"}, {{"c2", "c1"}});
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -435,6 +435,14 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
   return node;
 }
 
+Node* Graph::AddNode(NodeDef node_def, const OpDef* op_def,
+                     DataTypeSlice inputs, DataTypeSlice outputs) {
+  DCHECK(op_def != nullptr);
+  return AllocateNode(std::make_shared<NodeProperties>(
+                          op_def, std::move(node_def), inputs, outputs),
+                      nullptr);
+}
+
 Node* Graph::CopyNode(const Node* node) {
   DCHECK(!node->IsSource());
   DCHECK(!node->IsSink());
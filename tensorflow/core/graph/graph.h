@@ -491,6 +491,14 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(NodeDef node_def, Status* status);
 
+  // Same as above, but takes the node's OpDef and input/output types as
+  // precomputed by the caller (via the op registry and InOutTypesForNode),
+  // skipping the per-node inference. This lets callers converting large
+  // graphs derive the type signatures for many nodes in parallel before
+  // adding them; see GraphConstructor. `op_def` must outlive this graph.
+  Node* AddNode(NodeDef node_def, const OpDef* op_def, DataTypeSlice inputs,
+                DataTypeSlice outputs);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
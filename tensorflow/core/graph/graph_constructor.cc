@@ -38,11 +38,14 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/public/version.h"
@@ -55,6 +58,10 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// Below this many nodes, the parallel type-signature pre-pass costs more in
+// thread pool overhead than the sequential inference it saves.
+static constexpr int kMinNodesForParallelTypePrecompute = 10000;
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge";
 }
@@ -165,6 +172,11 @@ class GraphConstructor {
     TF_RETURN_IF_ERROR(BuildNodeIndex());
     TF_RETURN_IF_ERROR(InitFromEdges());
 
+    // Derive per-node type signatures in parallel for large graphs; the
+    // sequential conversion loop below then adds nodes without re-inferring
+    // them.
+    PrecomputeNodeTypes();
+
     // NOTE: Convert() invokes `consume_node_def()` on each node in the input
     // graph, so `get_node_def()` is no longer usable once it is called.
     TF_RETURN_IF_ERROR(Convert());
@@ -201,7 +213,16 @@ class GraphConstructor {
            absl::flat_hash_set<int>* unvisited);
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(NodeDef&& node_def, Node** node);
+  // `gdef_index` is the node's index within node_defs_, used to look up its
+  // precomputed type signature (see PrecomputeNodeTypes).
+  Status MakeNode(NodeDef&& node_def, Node** node, int gdef_index);
+  // Looks up each node's OpDef and derives its input/output types on a thread
+  // pool, storing the results in precomputed_types_ for MakeNode. Runs only
+  // for large graphs on the non-importing path: importing may rewrite a
+  // NodeDef's name and attrs between here and MakeNode, which would
+  // invalidate the precomputed signature. Nodes which fail to resolve are
+  // left empty so MakeNode's fallback reports the error as usual.
+  void PrecomputeNodeTypes();
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -291,6 +312,16 @@ class GraphConstructor {
   // Intermediate datastructure used to track the destinations of back edges.
   absl::flat_hash_set<int> merge_node_indices_;
 
+  // Per-node type signatures filled in by PrecomputeNodeTypes. Empty when the
+  // pre-pass didn't run; entries with a null op_def failed to resolve and
+  // fall back to sequential inference in MakeNode.
+  struct PrecomputedType {
+    const OpDef* op_def = nullptr;
+    DataTypeVector input_types;
+    DataTypeVector output_types;
+  };
+  std::vector<PrecomputedType> precomputed_types_;
+
   // Mapping from node name to the index within node_defs_.
   struct NodeInfo {
     explicit NodeInfo(int i) : gdef_index(i), node(nullptr) {}
@@ -713,11 +744,54 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
-  // Add the node to the graph.
-  Status status;
-  *node = g_->AddNode(std::move(node_def), &status);
-  if (!status.ok()) return status;
+void GraphConstructor::PrecomputeNodeTypes() {
+  const int num_nodes = node_def_count();
+  if (opts_.importing || num_nodes < kMinNodesForParallelTypePrecompute) {
+    return;
+  }
+
+  precomputed_types_.resize(num_nodes);
+
+  // Cost per node is dominated by the attr processing in InOutTypesForNode.
+  const int64 kCostPerNodeCycles = 5000;
+  thread::ThreadPool pool(Env::Default(), "graph_node_types",
+                          port::MaxParallelism());
+  pool.ParallelFor(
+      num_nodes, kCostPerNodeCycles, [this](int64 start, int64 end) {
+        for (int64 i = start; i < end; ++i) {
+          const NodeDef& node_def = get_node_def(i);
+          PrecomputedType& types = precomputed_types_[i];
+          const OpDef* op_def = nullptr;
+          if (!g_->op_registry()->LookUpOpDef(node_def.op(), &op_def).ok()) {
+            continue;
+          }
+          if (!InOutTypesForNode(node_def, *op_def, &types.input_types,
+                                 &types.output_types)
+                   .ok()) {
+            types.input_types.clear();
+            types.output_types.clear();
+            continue;
+          }
+          types.op_def = op_def;
+        }
+      });
+}
+
+Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node,
+                                  int gdef_index) {
+  // Add the node to the graph, reusing the type signature from the parallel
+  // pre-pass when one was computed.
+  if (gdef_index >= 0 &&
+      gdef_index < static_cast<int>(precomputed_types_.size()) &&
+      precomputed_types_[gdef_index].op_def != nullptr) {
+    PrecomputedType& types = precomputed_types_[gdef_index];
+    *node = g_->AddNode(std::move(node_def), types.op_def, types.input_types,
+                        types.output_types);
+  } else {
+    Status status;
+    *node = g_->AddNode(std::move(node_def), &status);
+    if (!status.ok()) return status;
+  }
   if (opts_.expect_device_spec) {
     (*node)->set_assigned_device_name((*node)->def().device());
   }
@@ -1216,7 +1290,7 @@ Status GraphConstructor::Convert() {
       }
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
     }
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node, o));
 
     if (opts_.importing) {
       // Use interned original node name so StringPiece remains valid.
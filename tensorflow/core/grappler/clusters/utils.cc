@@ -174,7 +174,19 @@ DeviceProperties GetLocalDMLInfo(uint32_t adapter_index) {
   device.set_l3_cache_size(DmlAdapterArchetype::kL3CacheSize);
   device.set_shared_memory_size_per_multiprocessor(
       DmlAdapterArchetype::kSharedMemorySizePerMultiprocessor);
-  device.set_memory_size(DmlAdapterArchetype::kMemorySize);
+
+  // Report the memory budget this process can actually use, which is what the
+  // DmlBfcAllocator pool is sized from by default. The memory optimizer's
+  // swapping and recomputation heuristics compare the statically-inferred peak
+  // memory usage against this value, so reporting the archetype's fixed 8GB
+  // would make them blind to pressure on smaller adapters (and needlessly
+  // aggressive on larger ones).
+  uint64_t memory_size = adapter.QueryAvailableLocalMemory();
+  if (memory_size == 0) {
+    memory_size = DmlAdapterArchetype::kMemorySize;
+  }
+  device.set_memory_size(memory_size);
+
   device.set_bandwidth(DmlAdapterArchetype::kBandwidth * 1e-3);
 
   uint32_t vendor_id = (uint32_t)adapter.VendorID();
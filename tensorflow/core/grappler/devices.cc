@@ -24,6 +24,10 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #endif  // GOOGLE_CUDA
 
+#if TENSORFLOW_USE_DIRECTML
+#include "tensorflow/core/common_runtime/dml/dml_device_cache.h"
+#endif  // TENSORFLOW_USE_DIRECTML
+
 namespace tensorflow {
 namespace grappler {
 
@@ -81,6 +85,16 @@ int64 AvailableGPUMemory(int gpu_id) {
 #endif
 }
 
+int GetNumAvailableDMLDevices() {
+  int num_dml_devices = 0;
+#if TENSORFLOW_USE_DIRECTML
+  num_dml_devices =
+      static_cast<int>(DmlDeviceCache::Instance().GetAdapterCount());
+#endif  // TENSORFLOW_USE_DIRECTML
+  LOG(INFO) << "Number of DML devices: " << num_dml_devices;
+  return num_dml_devices;
+}
+
 int GetNumAvailableLogicalCPUCores() { return port::NumSchedulableCPUs(); }
 
 }  // end namespace grappler
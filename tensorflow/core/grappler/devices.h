@@ -36,6 +36,10 @@ int GetNumAvailableGPUs(
 // [0, num_available_gpu)
 int64 AvailableGPUMemory(int gpu_id);
 
+// Get the number of DirectML adapters available on the local machine. Returns
+// 0 when TensorFlow was not built with DirectML support.
+int GetNumAvailableDMLDevices();
+
 // Get the number of logical CPU cores (aka hyperthreads) available.
 int GetNumAvailableLogicalCPUCores();
 
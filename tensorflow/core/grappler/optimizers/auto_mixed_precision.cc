@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/dml/dml_adapter_heuristics.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
@@ -916,6 +917,28 @@ int GetCudaVersion(const Cluster& cluster) {
   return 0;
 }
 
+bool HasDmlDevice(const Cluster& cluster) {
+  for (const auto& device : cluster.GetDevices()) {
+    if (device.second.type() == "DML") {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if the device is a DML adapter from a vendor known to run fp16
+// math at full rate. DML devices report no "architecture" environment entry,
+// so this plays the role that compute capability plays for CUDA GPUs.
+bool DmlDevicePrefersFp16(const DeviceProperties& device_properties) {
+  if (device_properties.type() != "DML") return false;
+  const auto& device_env = device_properties.environment();
+  auto it = device_env.find("vendor_id");
+  if (it == device_env.end()) return false;
+  uint64 vendor_id;
+  if (!strings::HexStringToUint64(it->second, &vendor_id)) return false;
+  return DmlAdapterSupportsFastFp16(static_cast<uint32>(vendor_id));
+}
+
 class AutoMixedPrecisionImpl {
  public:
   AutoMixedPrecisionImpl(Cluster* cluster,
@@ -926,7 +949,8 @@ class AutoMixedPrecisionImpl {
         graph_(graph),
         id_(id),
         graph_view_(graph),
-        cuda_version_(GetCudaVersion(*cluster)) {}
+        cuda_version_(GetCudaVersion(*cluster)),
+        has_dml_(HasDmlDevice(*cluster)) {}
 
   Status Optimize();
 
@@ -943,6 +967,8 @@ class AutoMixedPrecisionImpl {
   bool MustPreserve(const NodeDef& node) const;
   bool IsOnGPU(const NodeDef& node) const;
   bool IsOnSuitableGPUArch(const NodeDef& node) const;
+  bool IsOnDml(const NodeDef& node) const;
+  bool IsOnFp16CapableDmlAdapter(const NodeDef& node) const;
   bool ShouldProcess(const NodeDef& node) const;
   bool NodeHasFP16KernelForTypeAttr(const NodeDef& node, TypeAttrId taid) const;
   bool NodeImplicitlyReadsNonResourceVariable(const NodeDef& node) const;
@@ -978,6 +1004,7 @@ class AutoMixedPrecisionImpl {
   string id_;
   MutableGraphView graph_view_;
   int cuda_version_;
+  bool has_dml_;
   NodeTypeAttrMap node_type_map_;
   GraphTypeTopologyView graph_type_view_;
   bool force_all_fp16_;
@@ -1032,7 +1059,7 @@ Status AutoMixedPrecisionImpl::PrintDebugLogs(bool preop, size_t timestamp) {
                          strings::StrCat("paintbuckets", suffix, ".txt"));
     f.open(fname.c_str(), std::fstream::out);
     f << "WhiteList:\n";
-    for (auto x : AutoMixedPrecisionLists::WhiteList(cuda_version_)) {
+    for (auto x : AutoMixedPrecisionLists::WhiteList(cuda_version_, has_dml_)) {
       f << x << "\n";
     }
     f << "\nBlackList:\n";
@@ -1117,6 +1144,25 @@ bool AutoMixedPrecisionImpl::IsOnSuitableGPUArch(const NodeDef& node) const {
   return GetDeviceGPUArch(virtual_placer_.get_device(node)) >= kMinGPUArch;
 }
 
+bool AutoMixedPrecisionImpl::IsOnDml(const NodeDef& node) const {
+  string device_name;
+  if (node.device().empty()) {
+    device_name = virtual_placer_.get_canonical_device_name(node);
+  } else {
+    device_name = node.device();
+  }
+  string device;
+  string not_used;
+  return DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
+         absl::StrContains(absl::AsciiStrToLower(device),
+                           absl::AsciiStrToLower(DEVICE_DML));
+}
+
+bool AutoMixedPrecisionImpl::IsOnFp16CapableDmlAdapter(
+    const NodeDef& node) const {
+  return DmlDevicePrefersFp16(virtual_placer_.get_device(node));
+}
+
 bool AutoMixedPrecisionImpl::ShouldProcess(const NodeDef& node) const {
   return should_process_nodes_.count(&node);
 }
@@ -1182,7 +1228,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
 
-  fp16_whitelist_ = AutoMixedPrecisionLists::WhiteList(cuda_version_);
+  fp16_whitelist_ = AutoMixedPrecisionLists::WhiteList(cuda_version_, has_dml_);
   fp16_blacklist_ = AutoMixedPrecisionLists::BlackList();
   fp16_graylist_ = AutoMixedPrecisionLists::GrayList();
   fp16_clearlist_ = AutoMixedPrecisionLists::ClearList();
@@ -1194,8 +1240,11 @@ Status AutoMixedPrecisionImpl::Optimize() {
 
   VLOG(2) << "Identifying nodes that should be processed";
   for (const NodeDef& node : graph_->node()) {
-    if (!MustPreserve(node) && IsOnGPU(node) &&
-        (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node))) {
+    if (!MustPreserve(node) &&
+        ((IsOnGPU(node) &&
+          (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node))) ||
+         (IsOnDml(node) &&
+          (ShouldIgnorePerformance() || IsOnFp16CapableDmlAdapter(node))))) {
       should_process_nodes_.insert(&node);
     } else {
       LogSkippedNode(node);
@@ -1798,6 +1847,20 @@ int GetNumGPUs(const Cluster& cluster,
   return num_gpus;
 }
 
+// Counts the DML devices in the cluster. When require_fast_fp16 is set, only
+// adapters from vendors known to ship full-rate fp16 hardware are counted.
+int GetNumDmlDevices(const Cluster& cluster, bool require_fast_fp16) {
+  int num_dml_devices = 0;
+  for (const auto& device : cluster.GetDevices()) {
+    const DeviceProperties& device_properties = device.second;
+    if (device_properties.type() != "DML") continue;
+    if (!require_fast_fp16 || DmlDevicePrefersFp16(device_properties)) {
+      num_dml_devices++;
+    }
+  }
+  return num_dml_devices;
+}
+
 }  // end namespace
 
 Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -1811,6 +1874,7 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   int num_gpus = ShouldIgnorePerformance() ? GetNumGPUs(*cluster)
                                            : GetNumGPUs(*cluster, kMinGPUArch);
+  num_gpus += GetNumDmlDevices(*cluster, !ShouldIgnorePerformance());
   if (num_gpus < 1) {
     // AutoMixedPrecision is currently only tuned for GPU.
     LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
@@ -47,7 +47,7 @@ class AutoMixedPrecisionLists {
  public:
   // Returns the set of ops that are considered numerically-safe (for execution
   // in fp16) and performance-critical. These ops are always converted to fp16.
-  static gtl::FlatSet<string> WhiteList(int cuda_version) {
+  static gtl::FlatSet<string> WhiteList(int cuda_version, bool has_dml) {
     string to_add, to_remove;
     TF_CHECK_OK(ReadStringFromEnvVar(
         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_ADD", "", &to_add));
@@ -75,8 +75,9 @@ class AutoMixedPrecisionLists {
           // "DepthwiseConv2dNativeBackpropInput",
           "MatMul",
     };
-    if (cuda_version >= 9010) {
-      // Fp16 BatchMatMul is slow before CUDA 9.1.
+    if (cuda_version >= 9010 || has_dml) {
+      // Fp16 BatchMatMul is slow before CUDA 9.1. DirectML lowers it to the
+      // same GEMM path as MatMul, so it is always worthwhile there.
       list.insert("BatchMatMul");
       list.insert("BatchMatMulV2");
     }
@@ -74,11 +74,9 @@ NodeDef* AutoParallel::AddNodeControl(const string& name,
 }
 
 Status AutoParallel::Initialize(const GrapplerItem& item) {
-  // TODO #26543729: Investigate whether to enable Autoparallel grappler
-  // optimization for DML
-  //TFDML #26543729
   num_gpus_ = GetNumAvailableGPUs();
   LOG(INFO) << "Number of GPUs: " << num_gpus_;
+  num_dml_devices_ = GetNumAvailableDMLDevices();
   item_ = &item;
   graph_ = item.graph;
   LOG(INFO) << "Original graph size: " << graph_.node_size();
@@ -225,11 +223,16 @@ void AutoParallel::AddOneReplica(GraphDef* graph, int number) {
     *new_node = *all_nodes_[node];
     if (NotSharedNode(new_node->name())) {
       new_node->set_name(AddPrefixToNodeName(new_node->name(), prefix));
-      // TODO #26543729: Investigate whether to enable Autoparallel grappler
-      // optimization for DML
-      // TFDML #26543729
       if (num_gpus_ > 0) {
         new_node->set_device(strings::StrCat("/gpu:", number % num_gpus_));
+      } else if (num_dml_devices_ > 0) {
+        // Round-robin the replicas across DML adapters. The shared nodes
+        // (variables and the gradient aggregation they feed) keep their
+        // original placement, so cross-adapter gradient traffic flows through
+        // the regular send/recv copy path between each replica's adapter and
+        // the variables' device.
+        new_node->set_device(
+            strings::StrCat("/device:DML:", number % num_dml_devices_));
       }
       for (int i = 0; i < new_node->input_size(); i++) {
         if (NotSharedNode(NodeName(new_node->input(i)))) {
@@ -50,6 +50,7 @@ class AutoParallel : public GraphOptimizer {
   const GrapplerItem* item_;
   int num_replicas_;
   int num_gpus_;
+  int num_dml_devices_;
   Status Initialize(const GrapplerItem& item);
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
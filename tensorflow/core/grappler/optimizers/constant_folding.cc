@@ -40,8 +40,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -1259,6 +1261,12 @@ Status ConstantFolding::CreateNodeDef(const string& name,
 Status ConstantFolding::EvaluateNode(const NodeDef& node,
                                      const TensorVector& inputs,
                                      TensorVector* output) const {
+  // Evaluation always runs on the CPU, even for nodes placed on DML devices:
+  // folded results have to be materialized as Const TensorProtos in the
+  // GraphDef, so there is nowhere to keep a device-side result, and
+  // dispatching single nodes to DirectML would pay an operator compilation
+  // plus upload/readback round trip per fold. Oversized materializations are
+  // instead kept out of the fold entirely by the kMaxConstantSize checks.
   return ::tensorflow::grappler::EvaluateNode(node, inputs, cpu_device_,
                                               resource_mgr_.get(), output);
 }
@@ -1419,15 +1427,20 @@ Status ConstantFolding::FoldMergeNode(NodeDef* node, GraphDef* output_graph) {
 }
 
 Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
-                                 bool* result_too_large) {
+                                 bool* result_too_large,
+                                 std::vector<NodeDef>* precomputed_const_nodes) {
   *result_too_large = false;
   if (IsMerge(*node)) {
     return FoldMergeNode(node, output_graph);
   }
 
   std::vector<NodeDef> const_nodes;
-  TF_RETURN_IF_ERROR(
-      EvaluateOneFoldable(*node, &const_nodes, result_too_large));
+  if (precomputed_const_nodes != nullptr) {
+    const_nodes = std::move(*precomputed_const_nodes);
+  } else {
+    TF_RETURN_IF_ERROR(
+        EvaluateOneFoldable(*node, &const_nodes, result_too_large));
+  }
   VLOG(2) << "Folded node: " << SummarizeNodeDef(*node);
 
   NodeDef* constant_output = nullptr;
@@ -1553,34 +1566,97 @@ Status ConstantFolding::FoldGraph(
       queue.push_back(graph_->mutable_node(i));
     }
   }
+  // Nodes that are foldable at the same time have exclusively constant
+  // inputs, so their evaluations are independent of one another; only the
+  // graph rewrite that follows each evaluation has to be serial. The queue
+  // is therefore drained in waves: all nodes currently in the queue are
+  // evaluated concurrently, then their results are applied to the graph in
+  // queue order, which enqueues the next wave. Applying in queue order keeps
+  // the output identical to a fully serial fold.
+  std::unique_ptr<thread::ThreadPool> eval_pool;
+  struct EvalResult {
+    Status status;
+    bool result_too_large = false;
+    std::vector<NodeDef> const_nodes;
+    // Merge nodes are folded without evaluation, directly in FoldNode().
+    bool evaluated = false;
+  };
   while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
+    std::vector<NodeDef*> wave;
+    std::unordered_set<string> wave_names;
+    while (!queue.empty()) {
+      NodeDef* node = queue.front();
+      queue.pop_front();
+      if (processed_nodes.count(node->name()) ||
+          !wave_names.insert(node->name()).second) {
+        continue;
+      }
+      wave.push_back(node);
     }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    // We also need to ensure that the fanout is sorted deterministically.
-    const std::set<NodeDef*>& outputs = node_map_->GetOutputs(node->name());
-    std::vector<NodeDef*> fanout(outputs.begin(), outputs.end());
-    std::sort(fanout.begin(), fanout.end(),
-              [](const NodeDef* n1, const NodeDef* n2) {
-                return n1->name() < n2->name();
-              });
 
-    bool result_too_large = false;
-    Status s = FoldNode(node, output, &result_too_large);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->DebugString()
-              << "\nError message: " << s;
-      if (result_too_large) {
-        nodes_to_not_simplify->emplace(node->name());
+    std::vector<EvalResult> results(wave.size());
+    auto evaluate_one = [this, &wave, &results](int i) {
+      if (IsMerge(*wave[i])) {
+        return;
       }
+      // Match the floating point environment Optimize() establishes on the
+      // calling thread, so results do not depend on which thread evaluates.
+      port::ScopedFlushDenormal flush;
+      port::ScopedSetRound round(FE_TONEAREST);
+      results[i].evaluated = true;
+      results[i].status = EvaluateOneFoldable(*wave[i], &results[i].const_nodes,
+                                              &results[i].result_too_large);
+    };
+    if (wave.size() > 1) {
+      if (!eval_pool) {
+        eval_pool = absl::make_unique<thread::ThreadPool>(
+            Env::Default(), "constant_folding_eval",
+            port::NumSchedulableCPUs());
+      }
+      BlockingCounter counter(wave.size());
+      for (int i = 0; i < wave.size(); ++i) {
+        eval_pool->Schedule([i, &evaluate_one, &counter]() {
+          evaluate_one(i);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
     } else {
-      for (auto& output : fanout) {
-        if (IsFoldable(*output, &properties)) {
-          queue.push_back(output);
+      for (int i = 0; i < wave.size(); ++i) {
+        evaluate_one(i);
+      }
+    }
+
+    for (int i = 0; i < wave.size(); ++i) {
+      NodeDef* node = wave[i];
+      // We need to record a copy of output nodes before FoldNode() modifies
+      // it. We also need to ensure that the fanout is sorted
+      // deterministically.
+      const std::set<NodeDef*>& outputs = node_map_->GetOutputs(node->name());
+      std::vector<NodeDef*> fanout(outputs.begin(), outputs.end());
+      std::sort(fanout.begin(), fanout.end(),
+                [](const NodeDef* n1, const NodeDef* n2) {
+                  return n1->name() < n2->name();
+                });
+
+      bool result_too_large = results[i].result_too_large;
+      Status s = results[i].status;
+      if (s.ok()) {
+        s = FoldNode(node, output, &result_too_large,
+                     results[i].evaluated ? &results[i].const_nodes : nullptr);
+      }
+      processed_nodes.insert(node->name());
+      if (!s.ok()) {
+        VLOG(1) << "Failed to fold node " << node->DebugString()
+                << "\nError message: " << s;
+        if (result_too_large) {
+          nodes_to_not_simplify->emplace(node->name());
+        }
+      } else {
+        for (auto& output : fanout) {
+          if (IsFoldable(*output, &properties)) {
+            queue.push_back(output);
+          }
         }
       }
     }
@@ -90,8 +90,12 @@ class ConstantFolding : public GraphOptimizer {
                              bool* result_too_large);
 
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
+  // Folds `node` into the graph. When `precomputed_const_nodes` is non-null
+  // it holds the result of a prior EvaluateOneFoldable() call for `node`
+  // (consumed by this function); otherwise the node is evaluated here.
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
-                  bool* result_too_large);
+                  bool* result_too_large,
+                  std::vector<NodeDef>* precomputed_const_nodes = nullptr);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
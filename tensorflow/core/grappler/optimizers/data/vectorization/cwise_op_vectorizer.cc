@@ -63,10 +63,16 @@ Status ExpandDimsForBroadcast(VectorizerInput* inputs, Graph* g) {
     return rank;
   };
 
-  Output rank_0 = get_stacked_rank(inputs->at(0));
-  Output rank_1 = get_stacked_rank(inputs->at(1));
+  std::vector<Output> ranks;
+  ranks.reserve(inputs->size());
+  for (const auto& input : *inputs) {
+    ranks.push_back(get_stacked_rank(input));
+  }
 
-  Output max_rank = ops::Maximum(scope, rank_0, rank_1);
+  Output max_rank = ranks[0];
+  for (size_t i = 1; i < ranks.size(); ++i) {
+    max_rank = ops::Maximum(scope, max_rank, ranks[i]);
+  }
 
   // For all inputs that are stacked, expand dimensions after dim 0.
   auto expand_dims_if_unstacked =
@@ -105,8 +111,13 @@ Status ExpandDimsForBroadcast(VectorizerInput* inputs, Graph* g) {
         return WrappedTensor(reshaped.node(), 0, true);
       };
 
-  *inputs = VectorizerInput({expand_dims_if_unstacked(inputs->at(0), rank_0),
-                             expand_dims_if_unstacked(inputs->at(1), rank_1)});
+  std::vector<WrappedTensor> expanded;
+  expanded.reserve(inputs->size());
+  for (size_t i = 0; i < inputs->size(); ++i) {
+    expanded.push_back(expand_dims_if_unstacked(inputs->at(i), ranks[i]));
+  }
+
+  *inputs = VectorizerInput(std::move(expanded));
   return Status::OK();
 }
 
@@ -164,6 +175,23 @@ class BinaryCwiseOpVectorizer : public Vectorizer {
   }
 };
 
+class TernaryCwiseOpVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const Node& node, Graph* outer_scope,
+                   VectorizerInput&& inputs,
+                   VectorizerOutput* outputs) override {
+    if (inputs.size() != 3) {
+      return errors::Internal("Failed to vectorize ", node.type_string(),
+                              ". The op should have 3 input, but has ",
+                              inputs.size());
+    }
+    // Ternary ops broadcast all three inputs against each other
+    TF_RETURN_IF_ERROR(ExpandDimsForBroadcast(&inputs, outer_scope));
+
+    return CwiseVectorizeHelper(node, outer_scope, std::move(inputs), outputs);
+  }
+};
+
 // Bitwise unary
 REGISTER_VECTORIZER("Invert", UnaryCwiseOpVectorizer);
 
@@ -267,6 +295,12 @@ REGISTER_VECTORIZER("Sub", BinaryCwiseOpVectorizer);
 REGISTER_VECTORIZER("TruncateDiv", BinaryCwiseOpVectorizer);
 REGISTER_VECTORIZER("TruncateMod", BinaryCwiseOpVectorizer);
 REGISTER_VECTORIZER("Zeta", BinaryCwiseOpVectorizer);
+
+// Ternary. Only SelectV2 is registered: the legacy Select op has special
+// semantics for vector conditions that don't survive the leading stack
+// dimension, and ClipByValue's kernel requires scalar or exactly-shaped
+// bounds rather than broadcasting them.
+REGISTER_VECTORIZER("SelectV2", TernaryCwiseOpVectorizer);
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
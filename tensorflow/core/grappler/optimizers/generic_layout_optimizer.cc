@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/common_runtime/dml/dml_adapter_heuristics.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -107,15 +109,45 @@ inline bool NumConv2DOnDeviceWithDataTypeOverThreshold(
           static_cast<float>(num_conv2d_gpu)) >= kConv2DGPUFP16Threshold;
 }
 
+// Like the Volta rule below, but keyed on the DML adapters' vendor: DirectML
+// is NCHW-native, so DML transposes toward NCHW unless every adapter in the
+// cluster prefers NHWC for the graph's dominant conv precision (see
+// DmlPreferredConvLayout).
+inline bool AllDmlAdaptersPreferNHWC(const TransposeContext& context,
+                                     const Cluster& cluster) {
+  bool mostly_fp16 =
+      NumConv2DOnDeviceWithDataTypeOverThreshold(context, kDML, DT_HALF);
+
+  bool found_dml_device = false;
+  for (const auto& device : cluster.GetDevices()) {
+    if (device.second.type() != kDML) {
+      continue;
+    }
+    found_dml_device = true;
+
+    uint64 vendor_id = 0;
+    auto it = device.second.environment().find("vendor_id");
+    if (it == device.second.environment().end() ||
+        !strings::HexStringToUint64(it->second, &vendor_id) ||
+        absl::string_view(DmlPreferredConvLayout(
+            static_cast<uint32>(vendor_id), mostly_fp16)) != kNHWC) {
+      return false;
+    }
+  }
+  return found_dml_device;
+}
+
 inline std::pair<string, string> GetSrcAndDstDataFormats(
-    const TransposeContext& context, int num_gpus, int num_voltas) {
+    const TransposeContext& context, const Cluster& cluster, int num_gpus,
+    int num_voltas) {
   string src_format = kNHWC;
   string dst_format = kNCHW;
   // TODO #26542950: Enable Tensorcore specific grappler optimizations
   // TFDML #26542950
-  if (((static_cast<float>(num_voltas) / static_cast<float>(num_gpus)) >=
-       kVoltaGPURatioThreshold) &&
-      NumConv2DOnDeviceWithDataTypeOverThreshold(context, kGPU, DT_HALF)) {
+  if ((((static_cast<float>(num_voltas) / static_cast<float>(num_gpus)) >=
+        kVoltaGPURatioThreshold) &&
+       NumConv2DOnDeviceWithDataTypeOverThreshold(context, kGPU, DT_HALF)) ||
+      AllDmlAdaptersPreferNHWC(context, cluster)) {
     std::swap(src_format, dst_format);
   }
   return {src_format, dst_format};
@@ -418,12 +450,11 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   TF_RETURN_IF_ERROR(
       TransposeContext::InitializeTransposeContext(item, cluster, &context));
 
-  const auto src_dst_formats =
-      GetSrcAndDstDataFormats(context, num_gpus, num_gpus_and_num_volta.second);
+  const auto src_dst_formats = GetSrcAndDstDataFormats(
+      context, *cluster, num_gpus, num_gpus_and_num_volta.second);
   context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
                                      src_dst_formats.second);
-  context.AssignDeviceAndDataFormats(kDML, src_dst_formats.first,
-                                     src_dst_formats.second);
+  context.AddTargetDevice(kDML);
 
   TransposerFactory transposer_factory;
   TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(&context, &transposer_factory));
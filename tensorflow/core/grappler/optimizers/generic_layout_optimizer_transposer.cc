@@ -187,7 +187,7 @@ Status TransposeContext::InitializeTransposeContext(const GrapplerItem& item,
 void TransposeContext::AssignDeviceAndDataFormats(
     absl::string_view target_device, absl::string_view src_format,
     absl::string_view dst_format) {
-  this->target_device = string(target_device);
+  this->target_devices = {string(target_device)};
   this->src_format = string(src_format);
   this->dst_format = string(dst_format);
   this->src_dim_indices = GetDimensionIndices(src_format);
@@ -196,6 +196,10 @@ void TransposeContext::AssignDeviceAndDataFormats(
   this->dst_to_src = GetPermutation(this->dst_dim_indices, src_format);
 }
 
+void TransposeContext::AddTargetDevice(absl::string_view target_device) {
+  this->target_devices.push_back(string(target_device));
+}
+
 // Transposer.
 
 bool Transposer::ShouldProcess(const TransposeContext& context,
@@ -205,10 +209,16 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
       GetDeviceName(context.virtual_placer.get(), *node_def);
   string device;
   string task;
-  bool is_on_target_device =
-      DeviceNameUtils::SplitDeviceName(device_name, &task, &device) &&
-      absl::StrContains(absl::AsciiStrToLower(device),
-                        absl::AsciiStrToLower(context.target_device));
+  bool is_on_target_device = false;
+  if (DeviceNameUtils::SplitDeviceName(device_name, &task, &device)) {
+    for (const string& target_device : context.target_devices) {
+      if (absl::StrContains(absl::AsciiStrToLower(device),
+                            absl::AsciiStrToLower(target_device))) {
+        is_on_target_device = true;
+        break;
+      }
+    }
+  }
 
   // Only checks data format for layout sensitive op.
   bool data_format_match = !IsLayoutSensitiveOp(*node_def) ||
@@ -55,11 +55,17 @@ struct TransposeContext {
                                            const Cluster* cluster,
                                            TransposeContext* context);
 
-  // Sets data formats to convert from and to for specified device type.
+  // Sets data formats to convert from and to for specified device type. This
+  // resets the target device set to just `target_device`.
   void AssignDeviceAndDataFormats(absl::string_view target_device,
                                   absl::string_view src_format,
                                   absl::string_view dst_format);
 
+  // Adds another device type whose nodes are converted between the same pair
+  // of data formats. Lets one pass cover both GPU and DML placements instead
+  // of the last assignment clobbering the previous one.
+  void AddTargetDevice(absl::string_view target_device);
+
   FrameView frames;
   GraphDef graph;
   // Number of nodes in the original graph. As new nodes are appended to the end
@@ -71,7 +77,7 @@ struct TransposeContext {
   std::unique_ptr<utils::MutableGraphView> graph_view;
   std::unique_ptr<const VirtualPlacer> virtual_placer;
 
-  string target_device;
+  std::vector<string> target_devices;
   string src_format;
   string dst_format;
   absl::flat_hash_map<char, int> src_dim_indices;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 
+#include "tensorflow/core/common_runtime/dml/dml_adapter_heuristics.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
@@ -36,6 +38,31 @@ namespace internal {
 // dynamically determined.
 constexpr int64 kTensorMaxSize = 64;
 
+// Returns the "small tensor" element threshold to use for the given cluster.
+// The baseline is kTensorMaxSize, tuned for CUDA launch latency; when DML
+// devices are present the crossover point is raised per adapter class, since
+// a DirectML dispatch costs several times a CUDA launch.
+int64 GetMaxTensorSize(const Cluster* cluster) {
+  int64 max_tensor_size = kTensorMaxSize;
+  if (cluster == nullptr) {
+    return max_tensor_size;
+  }
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& device_properties = device.second;
+    if (device_properties.type() != "DML") continue;
+    const auto& device_env = device_properties.environment();
+    uint64 vendor_id = 0;
+    auto it = device_env.find("vendor_id");
+    if (it != device_env.end()) {
+      strings::HexStringToUint64(it->second, &vendor_id);
+    }
+    max_tensor_size =
+        std::max(max_tensor_size,
+                 DmlPinToHostMaxTensorSize(static_cast<uint32>(vendor_id)));
+  }
+  return max_tensor_size;
+}
+
 // All the nodes that should be blacklisted and not swapped.
 bool IsBlacklisted(const NodeDef& node) {
   return
@@ -48,7 +75,8 @@ bool IsBlacklisted(const NodeDef& node) {
 }
 
 // Check if Tensor is either a string or is integer and small size
-bool IsTensorSmall(const OpInfo::TensorProperties& prop) {
+bool IsTensorSmall(const OpInfo::TensorProperties& prop,
+                   int64 max_tensor_size) {
   if (prop.dtype() == DataType::DT_STRING) {
     return true;
   }
@@ -61,7 +89,7 @@ bool IsTensorSmall(const OpInfo::TensorProperties& prop) {
 
   // Check size known and small.
   const int64 size = NumCoefficients(prop.shape());
-  if (size < 0 || size > kTensorMaxSize) {
+  if (size < 0 || size > max_tensor_size) {
     return false;
   }
 
@@ -90,6 +118,7 @@ Status TryFindKernelDef(const std::vector<DeviceType>& devices,
 Status IsNodeOutputPortHostFriendly(const GraphView& graph,
                                     GraphProperties* properties,
                                     const NodeDef& node, int port_id,
+                                    int64 max_tensor_size,
                                     bool* is_candidate) {
   *is_candidate = false;
 
@@ -113,7 +142,7 @@ Status IsNodeOutputPortHostFriendly(const GraphView& graph,
                  << node.DebugString();
     return Status::OK();
   }
-  if (!IsTensorSmall(output_properties[port_id])) {
+  if (!IsTensorSmall(output_properties[port_id], max_tensor_size)) {
     return Status::OK();
   }
 
@@ -122,8 +151,11 @@ Status IsNodeOutputPortHostFriendly(const GraphView& graph,
   if (IsIdentity(node) || IsIdentityNSingleInput(node)) {
     for (const auto& fanin : graph.GetFanins(node, false)) {
       bool fanin_candidate = false;
-      TF_RETURN_IF_ERROR(IsNodeOutputPortHostFriendly(
-          graph, properties, *fanin.node, fanin.port_id, &fanin_candidate));
+      TF_RETURN_IF_ERROR(IsNodeOutputPortHostFriendly(graph, properties,
+                                                      *fanin.node,
+                                                      fanin.port_id,
+                                                      max_tensor_size,
+                                                      &fanin_candidate));
       if (!fanin_candidate) {
         return Status::OK();
       }
@@ -220,7 +252,8 @@ bool IsNodeInputPortHostFriendly(const NodeDef& node, int port_id) {
 // 3] Check all input/outputs are Host "friendly" (atm, friendly means small,
 //    ints, and pinned to Host).
 Status IsNodeHostCandidate(const GraphView& graph, GraphProperties* properties,
-                           const NodeDef& node, bool* is_candidate) {
+                           const NodeDef& node, int64 max_tensor_size,
+                           bool* is_candidate) {
   *is_candidate = false;
 
   // Check if node already on CPU.
@@ -245,7 +278,8 @@ Status IsNodeHostCandidate(const GraphView& graph, GraphProperties* properties,
        graph.GetFanins(node, /*include_controlling_nodes=*/false)) {
     bool fanin_candidate = false;
     TF_RETURN_IF_ERROR(IsNodeOutputPortHostFriendly(
-        graph, properties, *fanin.node, fanin.port_id, &fanin_candidate));
+        graph, properties, *fanin.node, fanin.port_id, max_tensor_size,
+        &fanin_candidate));
     if (!fanin_candidate) {
       return Status::OK();
     }
@@ -259,7 +293,7 @@ Status IsNodeHostCandidate(const GraphView& graph, GraphProperties* properties,
         /*include_tensor_values=*/false));
   }
   for (const auto& prop : properties->GetOutputProperties(node.name())) {
-    if (!IsTensorSmall(prop)) {
+    if (!IsTensorSmall(prop, max_tensor_size)) {
       return Status::OK();
     }
   }
@@ -319,6 +353,7 @@ Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
 
   const bool has_device_cpu = devices.find("/device:CPU:0") != devices.end();
+  const int64 max_tensor_size = internal::GetMaxTensorSize(cluster);
 
   // Topologically sort the graph, so that we traverse the nodes in order. This
   // will help us discover producer->consumer chains of Host ops.
@@ -330,8 +365,8 @@ Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   for (auto& node : *optimized_graph->mutable_node()) {
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
     bool is_candidate = false;
-    TF_RETURN_IF_ERROR(
-        internal::IsNodeHostCandidate(graph, &properties, node, &is_candidate));
+    TF_RETURN_IF_ERROR(internal::IsNodeHostCandidate(
+        graph, &properties, node, max_tensor_size, &is_candidate));
     if (!is_candidate) {
       continue;
     }
@@ -51,6 +51,15 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// Mean + SquaredDifference + Mean + ... -> _DmlFusedLayerNorm (DML only)
+//   (1) decomposed layer normalization over the innermost dimension
+//
+// GatherV2 * N + ConcatV2 -> _DmlFusedGatherConcat (DML only)
+//   (1) embedding lookups on N tables concatenated along the last axis
+//
+// ResizeBilinear + <Cast> + Sub + Mul -> _DmlFusedResizeNormalize (DML only)
+//   (1) image preprocessing: resize, dtype conversion, affine normalization
+//
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
 // patterns are "ContractionWith...".
 namespace {
@@ -58,6 +67,9 @@ namespace {
 constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kDmlFusedLayerNorm[] = "_DmlFusedLayerNorm";
+constexpr char kDmlFusedGatherConcat[] = "_DmlFusedGatherConcat";
+constexpr char kDmlFusedResizeNormalize[] = "_DmlFusedResizeNormalize";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -174,6 +186,62 @@ struct ContractionWithBatchNormAndActivation {
   float epsilon = 0.0;
 };
 
+// Layer normalization decomposed into primitive ops, fused into a single
+// _DmlFusedLayerNorm node.
+struct LayerNorm {
+  LayerNorm() = default;
+
+  // The final Add producing the normalized result; replaced by the fused op.
+  int output = kMissingIndex;
+  float epsilon = 0.001f;
+
+  // Tensor ids of the fused op's inputs.
+  string x;
+  string scale;
+  string offset;
+
+  // Interior nodes of the subgraph, deleted after fusion.
+  std::vector<int> interior_nodes;
+};
+
+// Embedding lookups on N tables whose results feed a single last-axis
+// ConcatV2, fused into one _DmlFusedGatherConcat node.
+struct GatherConcat {
+  GatherConcat() = default;
+
+  // The ConcatV2 assembling the lookups; replaced by the fused op.
+  int output = kMissingIndex;
+
+  // The GatherV2 nodes, deleted after fusion.
+  std::vector<int> gather_nodes;
+
+  // Tensor ids of the fused op's inputs, one per table.
+  std::vector<string> params;
+  std::vector<string> indices;
+};
+
+// Bilinear resize followed by an optional Cast and an affine normalization,
+// fused into a single image preprocessing kernel.
+struct ResizeNormalize {
+  ResizeNormalize() = default;
+
+  // The final Mul producing the normalized image; replaced by the fused op.
+  int output = kMissingIndex;
+
+  // The ResizeBilinear at the head of the pattern; its resize attributes are
+  // copied onto the fused op.
+  int resize = kMissingIndex;
+
+  // Tensor ids of the fused op's inputs.
+  string images;
+  string size;
+  string shift;
+  string scale;
+
+  // Interior nodes of the subgraph, deleted after fusion.
+  std::vector<int> interior_nodes;
+};
+
 #ifdef INTEL_MKL
 // Contraction node followed by a BiasAdd and Add.
 struct ContractionWithBiasAddAndAdd {
@@ -254,7 +322,11 @@ bool IsGpuCompatibleDataType(const NodeDef* contraction,
 bool IsDmlCompatibleDataType(const NodeDef* contraction,
                              const string& type_attr = "T") {
   DataType dtype = GetDataTypeFromAttr(*contraction, type_attr);
-  if (IsConv2D(*contraction) || IsMatMul(*contraction)) {
+  if (IsConv2D(*contraction)) {
+    // DML's _FusedConv2D kernel supports fp16 as well, which matters for
+    // mixed-precision models that would otherwise lose fusion entirely.
+    return dtype == DT_FLOAT || dtype == DT_HALF;
+  } else if (IsMatMul(*contraction)) {
     return dtype == DT_FLOAT;
   } else {
     return false;
@@ -393,7 +465,11 @@ bool IsDmlCompatible(const RemapperContext& ctx,
 }
 bool IsDmlCompatible(const RemapperContext& ctx,
                      const ContractionWithSqueezeAndBiasAdd& matched) {
-  return false;
+  // The rewrite keeps the Squeeze as a standalone node after the fused
+  // convolution, so this only requires the regular _FusedConv2D(BiasAdd)
+  // kernel on the DML side.
+  const NodeDef& node = ctx.graph_view.graph()->node(matched.contraction);
+  return IsConv2D(node) && IsDmlCompatibleConv2D(&node);
 }
 
 // Returns true if the given pattern is supported on the assigned device.
@@ -577,10 +653,17 @@ bool FindConv2DWithBatchNorm(const RemapperContext& ctx, int node_index,
   const auto* conv2d_node_view = regular_fanin_0.node_view();
   const auto* conv2d_node_def = conv2d_node_view->node();
 
-  if (!IsConv2D(*conv2d_node_def) || !NodeIsOnCpu(conv2d_node_def) ||
+  if (!IsConv2D(*conv2d_node_def)) return false;
+
+  // On DML the batch norm arguments bind as extra _FusedConv2D inputs, which
+  // the op requires to match T; since they are always float, only float convs
+  // are eligible there.
+  bool cpu_eligible = IsCpuCompatibleConv2D(conv2d_node_def);
+  bool dml_eligible = IsDmlCompatibleConv2D(conv2d_node_def) &&
+                      HasDataType(conv2d_node_def, DT_FLOAT);
+
+  if (!(cpu_eligible || dml_eligible) ||
       !HaveSameDataType(node_def, conv2d_node_def) ||
-      !IsCpuCompatibleDataType(conv2d_node_def) ||
-      !IsCpuCompatibleDataFormat(conv2d_node_def) ||
       HasControlFaninOrFanout(*conv2d_node_view) ||
       !HasAtMostOneFanoutAtPort0(*conv2d_node_view) ||
       IsInPreserveSet(ctx, conv2d_node_def))
@@ -1033,7 +1116,10 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
     // In training mode we rely on cuDNN for computing FusedBatchNorm with side
     // inputs and activation, and it has its own limitations. In inference mode
     // we have a custom CUDA kernel that doesn't not have these constraints.
-    if (is_training) {
+    // The DML kernel computes the fused form directly in both modes, for
+    // either layout and data type, so these constraints only apply to GPU
+    // placements.
+    if (is_training && NodeIsOnGpu(fused_batch_norm_node_def)) {
       // cuDNN only supports NHWC data layout.
       string data_format;
       if (!GetNodeAttr(*fused_batch_norm_node_def, kDataFormat, &data_format)
@@ -1054,7 +1140,7 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
       if (!valid_channel_dim) return false;
 
       // cuDNN must support CUDNN_BATCHNORM_SPATIAL_PERSISTENT mode.
-      if (NodeIsOnGpu(fused_batch_norm_node_def) && !BatchnormSpatialPersistentEnabled()) return false;
+      if (!BatchnormSpatialPersistentEnabled()) return false;
     }
 
     // FusedBatchNormV2 and V3 have an extra type parameter.
@@ -1124,6 +1210,426 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
   return false;
 }
 
+// Reads the value of a scalar floating-point Const node.
+bool GetScalarFloatConstValue(const NodeDef& node, float* value) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor())) return false;
+  if (tensor.NumElements() != 1) return false;
+
+  if (tensor.dtype() == DT_FLOAT) {
+    *value = tensor.flat<float>()(0);
+  } else if (tensor.dtype() == DT_HALF) {
+    *value = static_cast<float>(tensor.flat<Eigen::half>()(0));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Reads the value of a single-element integer Const node, such as a reduction
+// axes tensor or a concat/gather axis.
+bool GetSingleIntConstValue(const NodeDef& node, int64* axis) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor())) return false;
+  if (tensor.NumElements() != 1) return false;
+
+  if (tensor.dtype() == DT_INT32) {
+    *axis = tensor.flat<int32>()(0);
+  } else if (tensor.dtype() == DT_INT64) {
+    *axis = tensor.flat<int64>()(0);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Matches layer normalization decomposed into primitive ops, as produced by
+// tf.contrib.layers.layer_norm and by Keras LayerNormalization:
+//
+//   mean = Mean(x, axes, keep_dims=true)
+//   variance = Mean(SquaredDifference(x, StopGradient(mean)), axes,
+//                   keep_dims=true)
+//   inv = Mul(Rsqrt(Add(variance, epsilon)), scale)
+//   y = Add(Mul(x, inv), Sub(offset, Mul(mean, inv)))
+//
+// The match is rooted at the final Add. Layer norm is only fused on DML,
+// where the replacement _DmlFusedLayerNorm kernel is registered.
+bool FindDmlLayerNorm(const RemapperContext& ctx, int node_index,
+                      LayerNorm* matched) {
+  const auto* output_node_view = ctx.graph_view.GetNode(node_index);
+  const auto* output_node_def = output_node_view->node();
+
+  if (!IsAdd(*output_node_def) || HasControlFaninOrFanout(*output_node_view))
+    return false;
+  if (!NodeIsOnDml(output_node_def)) return false;
+
+  DataType t_dtype = GetDataTypeFromAttr(*output_node_def, "T");
+  if (t_dtype != DT_FLOAT && t_dtype != DT_HALF) return false;
+
+  if (output_node_view->NumRegularFanins() != 2) return false;
+
+  // Accepts an interior node of the pattern: it must have the expected op, no
+  // control dependencies, and no consumers outside the pattern.
+  const auto valid_interior_node =
+      [&](const utils::MutableNodeView& node_view,
+          bool (*predicate)(const NodeDef&), int max_fanouts = 1) -> bool {
+    const auto* node_def = node_view.node();
+    if (!predicate(*node_def)) return false;
+    if (HasControlFaninOrFanout(node_view)) return false;
+    if (static_cast<int>(node_view.GetRegularFanout(0).size()) > max_fanouts)
+      return false;
+    if (IsInPreserveSet(ctx, node_def)) return false;
+    return true;
+  };
+
+  // Both Mean nodes must reduce over the innermost dimension only, with
+  // keep_dims=true so the result broadcasts against x.
+  const auto valid_reduction =
+      [&](const utils::MutableNodeView& mean) -> bool {
+    bool keep_dims = false;
+    if (!TryGetNodeAttr(*mean.node(), "keep_dims", &keep_dims) || !keep_dims)
+      return false;
+
+    if (mean.NumRegularFanins() != 2) return false;
+    int64 axis;
+    if (!GetSingleIntConstValue(*mean.GetRegularFanin(1).node_view()->node(),
+                                &axis))
+      return false;
+    if (axis == -1) return true;
+    if (axis < 0) return false;
+
+    // A positive axis must name the innermost dimension of the input.
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(mean.node()->name());
+    if (props.empty()) return false;
+    const auto& shape = props[0].shape();
+    if (shape.unknown_rank()) return false;
+    return axis == shape.dim_size() - 1;
+  };
+
+  // One fanin of the root is Mul(x, inv); the other is
+  // Sub(offset, Mul(mean, inv)).
+  const auto* mul_x_view = output_node_view->GetRegularFanin(0).node_view();
+  const auto* sub_view = output_node_view->GetRegularFanin(1).node_view();
+  if (IsSub(*mul_x_view->node())) std::swap(mul_x_view, sub_view);
+
+  if (!valid_interior_node(*mul_x_view, IsMul)) return false;
+  if (!valid_interior_node(*sub_view, IsSub)) return false;
+  if (mul_x_view->NumRegularFanins() != 2) return false;
+  if (sub_view->NumRegularFanins() != 2) return false;
+
+  const auto* mul_mean_view = sub_view->GetRegularFanin(1).node_view();
+  if (!valid_interior_node(*mul_mean_view, IsMul)) return false;
+  if (mul_mean_view->NumRegularFanins() != 2) return false;
+
+  // Mul(mean, inv), in either operand order. The mean feeds both the variance
+  // computation and this Mul; the scaled inverse stddev feeds both Muls.
+  const auto* mean_view = mul_mean_view->GetRegularFanin(0).node_view();
+  const auto* inv_view = mul_mean_view->GetRegularFanin(1).node_view();
+  if (!IsMean(*mean_view->node())) std::swap(mean_view, inv_view);
+  if (!valid_interior_node(*mean_view, IsMean, /*max_fanouts=*/2)) return false;
+  if (!valid_interior_node(*inv_view, IsMul, /*max_fanouts=*/2)) return false;
+  if (mean_view->NumRegularFanins() != 2) return false;
+  if (inv_view->NumRegularFanins() != 2) return false;
+
+  // Mul(x, inv): one operand must be the same scaled inverse stddev node; the
+  // other is the tensor being normalized.
+  string x;
+  if (mul_x_view->GetRegularFanin(1).node_view() == inv_view) {
+    x = mul_x_view->node()->input(0);
+  } else if (mul_x_view->GetRegularFanin(0).node_view() == inv_view) {
+    x = mul_x_view->node()->input(1);
+  } else {
+    return false;
+  }
+
+  // inv = Mul(Rsqrt(Add(variance, epsilon)), scale), in either operand order.
+  const auto* rsqrt_view = inv_view->GetRegularFanin(0).node_view();
+  int scale_port = 1;
+  if (!IsRsqrt(*rsqrt_view->node())) {
+    rsqrt_view = inv_view->GetRegularFanin(1).node_view();
+    scale_port = 0;
+  }
+  if (!valid_interior_node(*rsqrt_view, IsRsqrt)) return false;
+  if (rsqrt_view->NumRegularFanins() != 1) return false;
+
+  const auto* add_eps_view = rsqrt_view->GetRegularFanin(0).node_view();
+  if (!valid_interior_node(*add_eps_view, IsAdd)) return false;
+  if (add_eps_view->NumRegularFanins() != 2) return false;
+
+  const auto* variance_view = add_eps_view->GetRegularFanin(0).node_view();
+  const auto* eps_view = add_eps_view->GetRegularFanin(1).node_view();
+  if (IsConstant(*variance_view->node())) std::swap(variance_view, eps_view);
+  if (!valid_interior_node(*variance_view, IsMean)) return false;
+  if (variance_view->NumRegularFanins() != 2) return false;
+
+  float epsilon;
+  if (!GetScalarFloatConstValue(*eps_view->node(), &epsilon)) return false;
+
+  if (!valid_reduction(*mean_view) || !valid_reduction(*variance_view))
+    return false;
+
+  // variance = Mean(SquaredDifference(x, mean)), where the mean operand may
+  // pass through a StopGradient.
+  const auto* sqdiff_view = variance_view->GetRegularFanin(0).node_view();
+  if (!valid_interior_node(*sqdiff_view, IsSquaredDifference)) return false;
+  if (sqdiff_view->NumRegularFanins() != 2) return false;
+  if (sqdiff_view->node()->input(0) != x) return false;
+
+  const auto* centered_view = sqdiff_view->GetRegularFanin(1).node_view();
+  int stop_gradient_index = kMissingIndex;
+  if (IsStopGradient(*centered_view->node())) {
+    if (!valid_interior_node(*centered_view, IsStopGradient)) return false;
+    if (centered_view->NumRegularFanins() != 1) return false;
+    stop_gradient_index = centered_view->node_index();
+    centered_view = centered_view->GetRegularFanin(0).node_view();
+  }
+  if (centered_view != mean_view) return false;
+
+  // The mean must be computed from the same tensor we normalize.
+  if (mean_view->node()->input(0) != x) return false;
+
+  matched->output = node_index;
+  matched->epsilon = epsilon;
+  matched->x = x;
+  matched->scale = inv_view->node()->input(scale_port);
+  matched->offset = sub_view->node()->input(0);
+  matched->interior_nodes = {
+      mul_x_view->node_index(),    sub_view->node_index(),
+      mul_mean_view->node_index(), inv_view->node_index(),
+      rsqrt_view->node_index(),    add_eps_view->node_index(),
+      variance_view->node_index(), sqdiff_view->node_index(),
+      mean_view->node_index()};
+  if (stop_gradient_index != kMissingIndex) {
+    matched->interior_nodes.push_back(stop_gradient_index);
+  }
+
+  return true;
+}
+
+// Matches N embedding lookups assembled with a trailing-axis concat:
+//
+//   y = ConcatV2(GatherV2(params_0, indices_0, 0), ...,
+//                GatherV2(params_n-1, indices_n-1, 0), axis)
+//
+// where every table is 2-D, every gather runs over axis 0 with no batch
+// dimensions, and the concat runs over the last axis of the gathered results.
+// Lookups are only fused on DML, where the replacement _DmlFusedGatherConcat
+// kernel is registered.
+bool FindDmlGatherConcat(const RemapperContext& ctx, int node_index,
+                         GatherConcat* matched) {
+  const auto* concat_view = ctx.graph_view.GetNode(node_index);
+  const auto* concat_def = concat_view->node();
+
+  if (concat_def->op() != "ConcatV2" ||
+      HasControlFaninOrFanout(*concat_view)) {
+    return false;
+  }
+  if (!NodeIsOnDml(concat_def)) return false;
+
+  DataType t_dtype = GetDataTypeFromAttr(*concat_def, "T");
+  if (t_dtype != DT_FLOAT && t_dtype != DT_HALF) return false;
+
+  int64 num_tables = 0;
+  if (!TryGetNodeAttr(*concat_def, "N", &num_tables)) return false;
+  if (num_tables < 2) return false;
+  if (concat_view->NumRegularFanins() != num_tables + 1) return false;
+
+  // ConcatV2 takes the concatenation axis as its last input.
+  int64 concat_axis;
+  if (!GetSingleIntConstValue(
+          *concat_view->GetRegularFanin(num_tables).node_view()->node(),
+          &concat_axis)) {
+    return false;
+  }
+
+  DataType indices_dtype = DT_INVALID;
+  int64 output_rank = -1;
+  std::vector<int> gather_nodes;
+  std::vector<string> params;
+  std::vector<string> indices;
+
+  for (int i = 0; i < num_tables; ++i) {
+    const auto* gather_view = concat_view->GetRegularFanin(i).node_view();
+    const auto* gather_def = gather_view->node();
+
+    if (gather_def->op() != "GatherV2") return false;
+    if (HasControlFaninOrFanout(*gather_view)) return false;
+    if (gather_view->GetRegularFanout(0).size() > 1) return false;
+    if (IsInPreserveSet(ctx, gather_def)) return false;
+    if (!NodeIsOnDml(gather_def)) return false;
+    if (gather_view->NumRegularFanins() != 3) return false;
+
+    int32 batch_dims = 0;
+    if (TryGetNodeAttr(*gather_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+
+    // All lookups must index with the same integer type so the fused op can
+    // use a single Tindices attribute.
+    DataType tindices = GetDataTypeFromAttr(*gather_def, "Tindices");
+    if (tindices != DT_INT32 && tindices != DT_INT64) return false;
+    if (indices_dtype == DT_INVALID) {
+      indices_dtype = tindices;
+    } else if (tindices != indices_dtype) {
+      return false;
+    }
+
+    int64 gather_axis;
+    if (!GetSingleIntConstValue(
+            *gather_view->GetRegularFanin(2).node_view()->node(),
+            &gather_axis) ||
+        gather_axis != 0) {
+      return false;
+    }
+
+    // The table must be 2-D so the last axis of the gathered result is the
+    // embedding width, which is what the concat must run over.
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(gather_def->name());
+    if (props.size() < 2) return false;
+    const auto& params_shape = props[0].shape();
+    const auto& indices_shape = props[1].shape();
+    if (params_shape.unknown_rank() || params_shape.dim_size() != 2)
+      return false;
+    if (indices_shape.unknown_rank()) return false;
+
+    int64 rank = indices_shape.dim_size() + 1;
+    if (output_rank < 0) {
+      output_rank = rank;
+    } else if (rank != output_rank) {
+      return false;
+    }
+
+    gather_nodes.push_back(gather_view->node_index());
+    params.push_back(gather_def->input(0));
+    indices.push_back(gather_def->input(1));
+  }
+
+  if (concat_axis < 0) concat_axis += output_rank;
+  if (concat_axis != output_rank - 1) return false;
+
+  matched->output = node_index;
+  matched->gather_nodes = std::move(gather_nodes);
+  matched->params = std::move(params);
+  matched->indices = std::move(indices);
+  return true;
+}
+
+// Matches image preprocessing decomposed into primitive ops:
+//
+//   y = Mul(Sub(<Cast>(ResizeBilinear(images, size)), shift), scale)
+//
+// where the Cast is optional and shift/scale are Const nodes that broadcast
+// over the channel dimension. The match is rooted at the final Mul.
+// Preprocessing is only fused on DML, where the replacement
+// _DmlFusedResizeNormalize kernel is registered.
+bool FindDmlResizeNormalize(const RemapperContext& ctx, int node_index,
+                            ResizeNormalize* matched) {
+  const auto* mul_view = ctx.graph_view.GetNode(node_index);
+  const auto* mul_def = mul_view->node();
+
+  if (!IsMul(*mul_def) || HasControlFaninOrFanout(*mul_view)) return false;
+  if (!NodeIsOnDml(mul_def)) return false;
+
+  DataType t_dtype = GetDataTypeFromAttr(*mul_def, "T");
+  if (t_dtype != DT_FLOAT && t_dtype != DT_HALF) return false;
+
+  if (mul_view->NumRegularFanins() != 2) return false;
+
+  // Accepts an interior node of the pattern: it must have the expected op, no
+  // control dependencies, and no consumers outside the pattern.
+  const auto valid_interior_node =
+      [&](const utils::MutableNodeView& node_view,
+          bool (*predicate)(const NodeDef&)) -> bool {
+    const auto* node_def = node_view.node();
+    if (!predicate(*node_def)) return false;
+    if (HasControlFaninOrFanout(node_view)) return false;
+    if (node_view.GetRegularFanout(0).size() > 1) return false;
+    if (IsInPreserveSet(ctx, node_def)) return false;
+    return true;
+  };
+
+  // The normalization constants must be scalars or vectors; anything of
+  // higher rank does not broadcast over just the channel dimension.
+  const auto is_broadcastable_const = [](const NodeDef& node) -> bool {
+    if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+    Tensor tensor;
+    if (!tensor.FromProto(node.attr().at("value").tensor())) return false;
+    return tensor.dims() <= 1;
+  };
+
+  // Mul(normalized, scale), in either operand order.
+  const auto* sub_view = mul_view->GetRegularFanin(0).node_view();
+  int scale_port = 1;
+  if (!IsSub(*sub_view->node())) {
+    sub_view = mul_view->GetRegularFanin(1).node_view();
+    scale_port = 0;
+  }
+  if (!valid_interior_node(*sub_view, IsSub)) return false;
+  if (!NodeIsOnDml(sub_view->node())) return false;
+  if (sub_view->NumRegularFanins() != 2) return false;
+  if (!is_broadcastable_const(
+          *mul_view->GetRegularFanin(scale_port).node_view()->node())) {
+    return false;
+  }
+
+  // Sub(resized, shift): the resize chain must be the minuend.
+  if (!is_broadcastable_const(*sub_view->GetRegularFanin(1).node_view()->node()))
+    return false;
+
+  // An optional Cast converts the float resize output to the final dtype.
+  const auto* resize_view = sub_view->GetRegularFanin(0).node_view();
+  int cast_index = kMissingIndex;
+  if (IsCast(*resize_view->node())) {
+    if (!valid_interior_node(*resize_view, IsCast)) return false;
+    if (!NodeIsOnDml(resize_view->node())) return false;
+    if (resize_view->NumRegularFanins() != 1) return false;
+    if (GetDataTypeFromAttr(*resize_view->node(), "SrcT") != DT_FLOAT)
+      return false;
+    if (GetDataTypeFromAttr(*resize_view->node(), "DstT") != t_dtype)
+      return false;
+    cast_index = resize_view->node_index();
+    resize_view = resize_view->GetRegularFanin(0).node_view();
+  } else if (t_dtype != DT_FLOAT) {
+    // ResizeBilinear always produces floats, so without a Cast the rest of
+    // the pattern must be float as well.
+    return false;
+  }
+
+  const auto* resize_def = resize_view->node();
+  if (resize_def->op() != "ResizeBilinear") return false;
+  if (HasControlFaninOrFanout(*resize_view)) return false;
+  if (resize_view->GetRegularFanout(0).size() > 1) return false;
+  if (IsInPreserveSet(ctx, resize_def)) return false;
+  if (!NodeIsOnDml(resize_def)) return false;
+  if (resize_view->NumRegularFanins() != 2) return false;
+
+  // The fused kernel does not support the T types ResizeBilinear accepts but
+  // the DML kernel does not register (double, bfloat16).
+  DataType images_dtype = GetDataTypeFromAttr(*resize_def, "T");
+  if (images_dtype == DT_DOUBLE || images_dtype == DT_BFLOAT16) return false;
+
+  matched->output = node_index;
+  matched->resize = resize_view->node_index();
+  matched->images = resize_def->input(0);
+  matched->size = resize_def->input(1);
+  matched->shift = sub_view->node()->input(1);
+  matched->scale = mul_def->input(scale_port);
+  matched->interior_nodes = {sub_view->node_index(),
+                             resize_view->node_index()};
+  if (cast_index != kMissingIndex) {
+    matched->interior_nodes.push_back(cast_index);
+  }
+
+  return true;
+}
+
 void CopyConv2DAttributes(const NodeDef& conv2d, NodeDef* fused_conv2d) {
   DCHECK(IsConv2D(conv2d)) << "Input node must be a Conv2D";
 
@@ -1620,6 +2126,124 @@ Status AddFusedBatchNormExNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddDmlLayerNormNode(RemapperContext* ctx, const LayerNorm& matched,
+                           std::vector<bool>* invalidated_nodes,
+                           std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+
+  VLOG(2) << "Fuse decomposed layer normalization:"
+          << " output=" << output.name() << " x=" << matched.x
+          << " scale=" << matched.scale << " offset=" << matched.offset;
+
+  NodeDef fused_op;
+  fused_op.set_op(kDmlFusedLayerNorm);
+  fused_op.set_name(output.name());
+  fused_op.set_device(output.device());
+  fused_op.add_input(matched.x);       // 0: x
+  fused_op.add_input(matched.scale);   // 1: scale
+  fused_op.add_input(matched.offset);  // 2: offset
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = output.attr().at("T");
+  SetAttrValue(matched.epsilon, &(*attrs)["epsilon"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node_index : matched.interior_nodes) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddDmlGatherConcatNode(RemapperContext* ctx,
+                              const GatherConcat& matched,
+                              std::vector<bool>* invalidated_nodes,
+                              std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  const NodeDef& first_gather = graph->node(matched.gather_nodes[0]);
+
+  VLOG(2) << "Fuse " << matched.params.size()
+          << " embedding lookups with concat: output=" << output.name();
+
+  NodeDef fused_op;
+  fused_op.set_op(kDmlFusedGatherConcat);
+  fused_op.set_name(output.name());
+  fused_op.set_device(output.device());
+  for (const string& params : matched.params) {
+    fused_op.add_input(params);
+  }
+  for (const string& indices : matched.indices) {
+    fused_op.add_input(indices);
+  }
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = output.attr().at("T");
+  (*attrs)["Tindices"] = first_gather.attr().at("Tindices");
+  SetAttrValue(static_cast<int64>(matched.params.size()), &(*attrs)["N"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node_index : matched.gather_nodes) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddDmlResizeNormalizeNode(RemapperContext* ctx,
+                                 const ResizeNormalize& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  const NodeDef& resize = graph->node(matched.resize);
+
+  VLOG(2) << "Fuse image preprocessing: output=" << output.name()
+          << " images=" << matched.images << " shift=" << matched.shift
+          << " scale=" << matched.scale;
+
+  NodeDef fused_op;
+  fused_op.set_op(kDmlFusedResizeNormalize);
+  fused_op.set_name(output.name());
+  fused_op.set_device(output.device());
+  fused_op.add_input(matched.images);  // 0: images
+  fused_op.add_input(matched.size);    // 1: size
+  fused_op.add_input(matched.shift);   // 2: shift
+  fused_op.add_input(matched.scale);   // 3: scale
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = resize.attr().at("T");
+  (*attrs)["out_type"] = output.attr().at("T");
+  (*attrs)["align_corners"] = resize.attr().at("align_corners");
+  (*attrs)["half_pixel_centers"] = resize.attr().at("half_pixel_centers");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node_index : matched.interior_nodes) {
+    (*nodes_to_delete)[node_index] = true;
+  }
+
+  return Status::OK();
+}
+
 Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   const GraphDef* graph = ctx->graph_view.graph();
   const NodeDef& fused_node = graph->node(matched.fused_batch_norm);
@@ -1885,8 +2509,35 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for a decomposed layer normalization fusion: the final Add of
+  // the pattern combines a Mul and a Sub. The full structural match happens
+  // in FindDmlLayerNorm; shapes are needed to validate the reduction axes.
+  const auto is_layer_norm_fusion_candidate = [&]() -> bool {
+    if (!IsAdd(*node_def)) return false;
+    if (node_view->NumRegularFanins() != 2) return false;
+
+    const auto* fanin_0 = node_view->GetRegularFanin(0).node_view()->node();
+    const auto* fanin_1 = node_view->GetRegularFanin(1).node_view()->node();
+    return (IsMul(*fanin_0) && IsSub(*fanin_1)) ||
+           (IsSub(*fanin_0) && IsMul(*fanin_1));
+  };
+
+  // Candidate for an embedding lookup fusion: a ConcatV2 whose first value
+  // input is a GatherV2. The full structural match happens in
+  // FindDmlGatherConcat; shapes are needed to validate table ranks and the
+  // concat axis.
+  const auto is_gather_concat_fusion_candidate = [&]() -> bool {
+    if (node_def->op() != "ConcatV2") return false;
+    if (node_view->NumRegularFanins() < 3) return false;
+
+    const auto* fanin_0 = node_view->GetRegularFanin(0).node_view()->node();
+    return fanin_0->op() == "GatherV2";
+  };
+
   return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
-         is_pad_conv2d_fusion_candidate();
+         is_pad_conv2d_fusion_candidate() ||
+         is_layer_norm_fusion_candidate() ||
+         is_gather_concat_fusion_candidate();
 }
 
 }  // namespace
@@ -2033,6 +2684,36 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap decomposed layer normalization into the _DmlFusedLayerNorm.
+    LayerNorm layer_norm;
+    if (allow_non_differentiable_rewrites &&
+        FindDmlLayerNorm(ctx, i, &layer_norm)) {
+      TF_RETURN_IF_ERROR(AddDmlLayerNormNode(&ctx, layer_norm,
+                                             &invalidated_nodes,
+                                             &nodes_to_delete));
+      continue;
+    }
+
+    // Remap concatenated embedding lookups into the _DmlFusedGatherConcat.
+    GatherConcat gather_concat;
+    if (allow_non_differentiable_rewrites &&
+        FindDmlGatherConcat(ctx, i, &gather_concat)) {
+      TF_RETURN_IF_ERROR(AddDmlGatherConcatNode(&ctx, gather_concat,
+                                                &invalidated_nodes,
+                                                &nodes_to_delete));
+      continue;
+    }
+
+    // Remap decomposed image preprocessing into the _DmlFusedResizeNormalize.
+    ResizeNormalize resize_normalize;
+    if (allow_non_differentiable_rewrites &&
+        FindDmlResizeNormalize(ctx, i, &resize_normalize)) {
+      TF_RETURN_IF_ERROR(AddDmlResizeNormalizeNode(&ctx, resize_normalize,
+                                                   &invalidated_nodes,
+                                                   &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
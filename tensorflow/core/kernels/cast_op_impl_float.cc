@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cast_op_impl.h"
 
+#include "tensorflow/core/kernels/cast_op_simd.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -23,6 +24,9 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromFloat(DataType dst_dtype) {
+  if (CastFunctorType func = internal::MaybeGetSimdCastFromFloat(dst_dtype)) {
+    return func;
+  }
   CURRY_TYPES3(CAST_CASE, CPUDevice, float);
   return nullptr;
 }
@@ -0,0 +1,203 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/cast_op_simd.h"
+
+#include "tensorflow/core/kernels/cast_op_impl.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+// The specializations below are written with AVX/AVX-512 intrinsics but the
+// surrounding translation unit is compiled for the baseline ISA; dispatch
+// guards ensure they only run on capable hosts. MSVC permits intrinsics for
+// any ISA regardless of /arch, while GCC and Clang need per-function target
+// attributes.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CAST_OP_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TF_TARGET_AVX_F16C
+#define TF_TARGET_AVX512F
+#elif defined(__clang__) || defined(__GNUC__)
+#define TF_TARGET_AVX_F16C __attribute__((target("avx,f16c")))
+#define TF_TARGET_AVX512F __attribute__((target("avx512f")))
+#else
+#undef CAST_OP_SIMD_X86
+#endif
+#endif
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Converts n elements; src/dst may be unaligned. Implementations handle the
+// scalar tail themselves.
+typedef void (*FloatToHalfFn)(const float* src, uint16* dst, int64 n);
+typedef void (*HalfToFloatFn)(const uint16* src, float* dst, int64 n);
+
+// Conversions are a couple of cycles per element once vectorized.
+constexpr int64 kCastCostPerUnit = 2;
+
+#ifdef CAST_OP_SIMD_X86
+
+TF_TARGET_AVX_F16C void FloatToHalfAvxF16c(const float* src, uint16* dst,
+                                           int64 n) {
+  int64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 v = _mm256_loadu_ps(src + i);
+    const __m128i h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+  for (; i < n; ++i) {
+    dst[i] = Eigen::half(src[i]).x;
+  }
+}
+
+TF_TARGET_AVX_F16C void HalfToFloatAvxF16c(const uint16* src, float* dst,
+                                           int64 n) {
+  int64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+  for (; i < n; ++i) {
+    dst[i] = static_cast<float>(Eigen::half_impl::raw_uint16_to_half(src[i]));
+  }
+}
+
+TF_TARGET_AVX512F void FloatToHalfAvx512(const float* src, uint16* dst,
+                                         int64 n) {
+  int64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512 v = _mm512_loadu_ps(src + i);
+    const __m256i h = _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), h);
+  }
+  // AVX512F implies F16C; reuse the 8-wide loop for the tail.
+  FloatToHalfAvxF16c(src + i, dst + i, n - i);
+}
+
+TF_TARGET_AVX512F void HalfToFloatAvx512(const uint16* src, float* dst,
+                                         int64 n) {
+  int64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m256i h =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(h));
+  }
+  HalfToFloatAvxF16c(src + i, dst + i, n - i);
+}
+
+// Probed once at first use, as with the other process-wide CPU feature
+// checks (see cpu_feature_guard).
+FloatToHalfFn GetFloatToHalfFn() {
+  static const FloatToHalfFn fn = []() -> FloatToHalfFn {
+    if (port::TestCPUFeature(port::CPUFeature::AVX512F)) {
+      return &FloatToHalfAvx512;
+    }
+    if (port::TestCPUFeature(port::CPUFeature::AVX) &&
+        port::TestCPUFeature(port::CPUFeature::F16C)) {
+      return &FloatToHalfAvxF16c;
+    }
+    return nullptr;
+  }();
+  return fn;
+}
+
+HalfToFloatFn GetHalfToFloatFn() {
+  static const HalfToFloatFn fn = []() -> HalfToFloatFn {
+    if (port::TestCPUFeature(port::CPUFeature::AVX512F)) {
+      return &HalfToFloatAvx512;
+    }
+    if (port::TestCPUFeature(port::CPUFeature::AVX) &&
+        port::TestCPUFeature(port::CPUFeature::F16C)) {
+      return &HalfToFloatAvxF16c;
+    }
+    return nullptr;
+  }();
+  return fn;
+}
+
+#else  // !CAST_OP_SIMD_X86
+
+FloatToHalfFn GetFloatToHalfFn() { return nullptr; }
+HalfToFloatFn GetHalfToFloatFn() { return nullptr; }
+
+#endif  // CAST_OP_SIMD_X86
+
+}  // namespace
+
+CastFunctorType MaybeGetSimdCastFromFloat(DataType dst_dtype) {
+  if (dst_dtype != DT_HALF) {
+    return nullptr;
+  }
+  FloatToHalfFn fn = GetFloatToHalfFn();
+  if (fn == nullptr) {
+    return nullptr;
+  }
+  return [fn](OpKernelContext* ctx, const Tensor& inp, Tensor* out,
+              bool truncate) {
+    if (truncate) {
+      // Truncation clears low mantissa bits before the cast; keep the
+      // generic path so the semantics stay identical.
+      functor::CastFunctor<CPUDevice, Eigen::half, float> func;
+      func(ctx->eigen_device<CPUDevice>(), out->flat<Eigen::half>(),
+           inp.flat<float>(), truncate);
+      return;
+    }
+    const int64 n = inp.NumElements();
+    const float* src = inp.flat<float>().data();
+    uint16* dst = reinterpret_cast<uint16*>(out->flat<Eigen::half>().data());
+    auto workers = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(workers->num_threads, workers->workers, n, kCastCostPerUnit,
+          [fn, src, dst](int64 start, int64 limit) {
+            fn(src + start, dst + start, limit - start);
+          });
+  };
+}
+
+CastFunctorType MaybeGetSimdCastFromHalf(DataType dst_dtype) {
+  if (dst_dtype != DT_FLOAT) {
+    return nullptr;
+  }
+  HalfToFloatFn fn = GetHalfToFloatFn();
+  if (fn == nullptr) {
+    return nullptr;
+  }
+  return [fn](OpKernelContext* ctx, const Tensor& inp, Tensor* out,
+              bool truncate) {
+    if (truncate) {
+      functor::CastFunctor<CPUDevice, float, Eigen::half> func;
+      func(ctx->eigen_device<CPUDevice>(), out->flat<float>(),
+           inp.flat<Eigen::half>(), truncate);
+      return;
+    }
+    const int64 n = inp.NumElements();
+    const uint16* src =
+        reinterpret_cast<const uint16*>(inp.flat<Eigen::half>().data());
+    float* dst = out->flat<float>().data();
+    auto workers = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(workers->num_threads, workers->workers, n, kCastCostPerUnit,
+          [fn, src, dst](int64 start, int64 limit) {
+            fn(src + start, dst + start, limit - start);
+          });
+  };
+}
+
+}  // namespace internal
+}  // namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_CAST_OP_SIMD_H_
+#define TENSORFLOW_CORE_KERNELS_CAST_OP_SIMD_H_
+
+#include "tensorflow/core/kernels/cast_op.h"
+
+namespace tensorflow {
+namespace internal {
+
+// Runtime-dispatched SIMD fast paths for the hottest cast conversions.
+//
+// Prebuilt binaries compile Eigen for a conservative baseline ISA, so
+// float <-> half casts fall back to scalar soft-float conversion even on
+// hosts with F16C/AVX-512 hardware conversion instructions. These hooks
+// return a CastFunctorType backed by vcvtps2ph/vcvtph2ps (8-wide with
+// AVX+F16C, 16-wide with AVX-512F) when the host CPU supports it, and
+// nullptr otherwise so the caller falls through to the generic Eigen
+// path. The ISA is probed once at first use.
+//
+// Rounding matches the Eigen path (IEEE round-to-nearest-even), so the
+// fast path is bit-exact with the fallback.
+
+// Fast path for DT_FLOAT -> dst_dtype, or nullptr.
+CastFunctorType MaybeGetSimdCastFromFloat(DataType dst_dtype);
+
+// Fast path for DT_HALF -> dst_dtype, or nullptr.
+CastFunctorType MaybeGetSimdCastFromHalf(DataType dst_dtype);
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CAST_OP_SIMD_H_
@@ -143,32 +143,8 @@ REGISTER_SYCL_KERNEL(SYCL, bool);
 #undef REGISTER_SYCL_KERNEL
 #endif
 
-#ifdef TENSORFLOW_USE_DIRECTML
-#define REGISTER_DML_KERNEL(TYPE)                                     \
-  REGISTER_KERNEL_BUILDER(                                            \
-      Name("Const").Device(DEVICE_DML).TypeConstraint<TYPE>("dtype"), \
-      ConstantOp);
-REGISTER_DML_KERNEL(Eigen::half);
-REGISTER_DML_KERNEL(bfloat16);
-REGISTER_DML_KERNEL(float);
-REGISTER_DML_KERNEL(double);
-REGISTER_DML_KERNEL(uint8);
-REGISTER_DML_KERNEL(int8);
-REGISTER_DML_KERNEL(qint8);
-REGISTER_DML_KERNEL(uint16);
-REGISTER_DML_KERNEL(int16);
-REGISTER_DML_KERNEL(qint16);
-REGISTER_DML_KERNEL(quint16);
-REGISTER_DML_KERNEL(uint32);
-REGISTER_DML_KERNEL(qint32);
-REGISTER_DML_KERNEL(int64);
-REGISTER_DML_KERNEL(uint64);
-REGISTER_DML_KERNEL(complex64);
-REGISTER_DML_KERNEL(complex128);
-REGISTER_DML_KERNEL(bool);
-REGISTER_DML_KERNEL(Variant);
-#undef REGISTER_DML_KERNEL
-#endif
+// Const on DML devices is registered in dml_constant_op.cc, which defers the
+// device upload until the constant's first use.
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
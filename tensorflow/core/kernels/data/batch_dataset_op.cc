@@ -14,14 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/batch_dataset_op.h"
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -40,6 +43,112 @@ namespace data {
 constexpr char kInputImplEmpty[] = "input_impl_empty";
 constexpr char kBatchDataset[] = "BatchDataset";
 
+// When set, eligible batch iterators preallocate the batch components and
+// serve upstream element allocations directly out of the batch slices, so
+// elements that the immediate upstream produces synchronously are written in
+// place and never copied. See Dataset::slice_allocation_candidate_ for the
+// eligibility conditions.
+constexpr char kSliceAllocationEnvVar[] = "TF_DATA_BATCH_SLICE_ALLOCATION";
+
+// Serves upstream allocation requests out of the slices of preallocated
+// batch component tensors. For each input element, every component slice can
+// be claimed by at most one allocation whose size matches the slice exactly;
+// everything else is delegated to the wrapped allocator. The batch iterator
+// then compares each produced tensor's buffer against its intended slice and
+// skips the copy on a match, so a mismatch (e.g. a scratch allocation stole
+// the slice, or the upstream returned a buffered tensor) degrades to the
+// regular copy rather than an error.
+//
+// Component slice sizes must be pairwise distinct so that an allocation can
+// never be placed in another component's slice, which could otherwise be
+// overwritten before that component is copied out.
+class SliceArenaAllocator : public Allocator {
+ public:
+  string Name() override { return "batch_slice_arena"; }
+
+  // Registers the preallocated batch components whose slices may be handed
+  // out. `components` must outlive all allocations served from them.
+  void BeginBatch(Allocator* wrapped, const std::vector<Tensor>& components,
+                  const std::vector<int64>& slice_bytes) {
+    mutex_lock l(mu_);
+    wrapped_ = wrapped;
+    components_.clear();
+    components_.reserve(components.size());
+    for (size_t c = 0; c < components.size(); ++c) {
+      Component component;
+      component.base = const_cast<char*>(components[c].tensor_data().data());
+      component.total_bytes = components[c].tensor_data().size();
+      component.slice_bytes = slice_bytes[c];
+      components_.push_back(component);
+    }
+  }
+
+  // Positions the arena at element `index`; subsequent allocations may claim
+  // this element's slices.
+  void BeginElement(int64 index) {
+    mutex_lock l(mu_);
+    element_index_ = index;
+    for (auto& component : components_) {
+      component.claimed = false;
+    }
+  }
+
+  // Returns the address of element `index` of the given batch component.
+  char* SlicePointer(size_t component_index, int64 index) {
+    mutex_lock l(mu_);
+    const Component& component = components_[component_index];
+    return component.base + index * component.slice_bytes;
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    Allocator* wrapped;
+    {
+      mutex_lock l(mu_);
+      if (alignment <= kAllocatorAlignment) {
+        for (auto& component : components_) {
+          if (!component.claimed &&
+              component.slice_bytes == static_cast<int64>(num_bytes)) {
+            component.claimed = true;
+            return component.base + element_index_ * component.slice_bytes;
+          }
+        }
+      }
+      wrapped = wrapped_;
+    }
+    return wrapped->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    Allocator* wrapped;
+    {
+      mutex_lock l(mu_);
+      for (const auto& component : components_) {
+        if (ptr >= component.base &&
+            ptr < component.base + component.total_bytes) {
+          // The memory belongs to a batch component tensor and is freed when
+          // that tensor is.
+          return;
+        }
+      }
+      wrapped = wrapped_;
+    }
+    wrapped->DeallocateRaw(ptr);
+  }
+
+ private:
+  struct Component {
+    char* base = nullptr;
+    int64 total_bytes = 0;
+    int64 slice_bytes = 0;
+    bool claimed = false;
+  };
+
+  mutex mu_;
+  Allocator* wrapped_ GUARDED_BY(mu_) = nullptr;  // not owned
+  std::vector<Component> components_ GUARDED_BY(mu_);
+  int64 element_index_ GUARDED_BY(mu_) = 0;
+};
+
 class BatchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, int64 batch_size, bool drop_remainder,
@@ -66,6 +175,44 @@ class BatchDatasetOp::Dataset : public DatasetBase {
             PartialTensorShape({-1}).Concatenate(input_shape));
       }
     }
+
+    // Determine whether this dataset is eligible for slice allocation: the
+    // batch size must be static (`drop_remainder`), the element shapes fully
+    // defined, the component types memcpy-able (so an element buffer can
+    // double as a slice of the batch buffer), every slice must preserve the
+    // allocator alignment of the slices after it, and the per-component
+    // slice sizes must be pairwise distinct (see SliceArenaAllocator).
+    if (drop_remainder_ && !parallel_copy_) {
+      const DataTypeVector& dtypes = input_->output_dtypes();
+      slice_allocation_candidate_ = true;
+      for (size_t c = 0; c < input_shapes.size(); ++c) {
+        TensorShape element_shape;
+        if (!input_shapes[c].IsFullyDefined() ||
+            !input_shapes[c].AsTensorShape(&element_shape) ||
+            !DataTypeCanUseMemcpy(dtypes[c])) {
+          slice_allocation_candidate_ = false;
+          break;
+        }
+        int64 slice_bytes =
+            element_shape.num_elements() * DataTypeSize(dtypes[c]);
+        if (slice_bytes == 0 ||
+            slice_bytes % Allocator::kAllocatorAlignment != 0) {
+          slice_allocation_candidate_ = false;
+          break;
+        }
+        for (int64 other : slice_bytes_) {
+          if (other == slice_bytes) {
+            slice_allocation_candidate_ = false;
+            break;
+          }
+        }
+        if (!slice_allocation_candidate_) {
+          break;
+        }
+        element_shapes_.push_back(std::move(element_shape));
+        slice_bytes_.push_back(slice_bytes);
+      }
+    }
   }
 
   ~Dataset() override { input_->Unref(); }
@@ -130,12 +277,25 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params) {}
 
     Status Initialize(IteratorContext* ctx) override {
-      return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
+      if (dataset()->slice_allocation_candidate_) {
+        bool enabled = false;
+        TF_RETURN_IF_ERROR(ReadBoolFromEnvVar(kSliceAllocationEnvVar,
+                                              /*default_val=*/false, &enabled));
+        if (enabled) {
+          arena_ = absl::make_unique<SliceArenaAllocator>();
+        }
+      }
+      return Status::OK();
     }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (arena_) {
+        return GetNextWithSliceAllocation(ctx, out_tensors, end_of_sequence);
+      }
       // Each row of `batch_elements` is a tuple of tensors from the
       // input iterator.
       std::vector<std::vector<Tensor>> batch_elements;
@@ -242,6 +402,84 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+   private:
+    // Produces the next batch by preallocating the batch components and
+    // letting the upstream iterator allocate elements directly into their
+    // slices. Elements that do land in their slice are never copied; the
+    // rest (e.g. tensors served from an upstream buffer) fall back to
+    // CopyElementToSlice.
+    Status GetNextWithSliceAllocation(IteratorContext* ctx,
+                                      std::vector<Tensor>* out_tensors,
+                                      bool* end_of_sequence) {
+      mutex_lock l(mu_);
+      if (!input_impl_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+      const size_t num_components = dataset()->element_shapes_.size();
+      out_tensors->reserve(num_components);
+      for (size_t c = 0; c < num_components; ++c) {
+        TensorShape batch_component_shape({dataset()->batch_size_});
+        batch_component_shape.AppendShape(dataset()->element_shapes_[c]);
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  dataset()->input_->output_dtypes()[c],
+                                  batch_component_shape);
+        if (!out_tensors->back().IsInitialized()) {
+          return errors::ResourceExhausted(
+              "Failed to allocate memory for the batch of component ", c);
+        }
+      }
+      arena_->BeginBatch(ctx->allocator({}), *out_tensors,
+                         dataset()->slice_bytes_);
+
+      IteratorContext::Params params(ctx);
+      Allocator* arena = arena_.get();
+      params.allocator_getter = [arena](AllocatorAttributes) {
+        return arena;
+      };
+      IteratorContext arena_ctx(std::move(params));
+
+      *end_of_sequence = false;
+      int64 num_batch_elements = 0;
+      for (int64 i = 0; i < dataset()->batch_size_; ++i) {
+        arena_->BeginElement(i);
+        std::vector<Tensor> batch_element_tuple;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(
+            &arena_ctx, &batch_element_tuple, end_of_sequence));
+        if (*end_of_sequence) {
+          input_impl_.reset();
+          break;
+        }
+        for (size_t c = 0; c < num_components; ++c) {
+          if (batch_element_tuple[c].shape() != dataset()->element_shapes_[c]) {
+            return errors::InvalidArgument(
+                "Cannot batch tensors with different shapes in component ", c,
+                ". Expected shape ",
+                dataset()->element_shapes_[c].DebugString(), " and element ",
+                i, " had shape ", batch_element_tuple[c].shape().DebugString(),
+                ".");
+          }
+          if (batch_element_tuple[c].tensor_data().data() !=
+              arena_->SlicePointer(c, i)) {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+                std::move(batch_element_tuple[c]), &(*out_tensors)[c], i));
+          }
+        }
+        ++num_batch_elements;
+      }
+
+      if (num_batch_elements < dataset()->batch_size_) {
+        // Eligibility requires `drop_remainder`, so a short batch always
+        // signals the end of the sequence.
+        out_tensors->clear();
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -272,6 +510,10 @@ class BatchDatasetOp::Dataset : public DatasetBase {
    private:
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+    // Non-null iff slice allocation is enabled for this iterator. The arena
+    // must outlive any element tensors allocated through it, so it lives for
+    // the lifetime of the iterator.
+    std::unique_ptr<SliceArenaAllocator> arena_;
   };
 
   const int64 batch_size_;
@@ -280,6 +522,13 @@ class BatchDatasetOp::Dataset : public DatasetBase {
   const DatasetBase* const input_;
   const int op_version_;
   std::vector<PartialTensorShape> output_shapes_;
+
+  // Slice allocation eligibility, precomputed from static properties (see
+  // the constructor). When eligible, `element_shapes_` and `slice_bytes_`
+  // hold the per-component element shapes and slice sizes.
+  bool slice_allocation_candidate_ = false;
+  std::vector<TensorShape> element_shapes_;
+  std::vector<int64> slice_bytes_;
 };
 
 BatchDatasetOp::BatchDatasetOp(OpKernelConstruction* ctx)
@@ -14,14 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -57,6 +62,52 @@ constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
 
+// When set, file caches over memcpy-able element types are written in a
+// memory-mapped format instead of a tensor bundle: raw tensor bytes laid out
+// at 64-byte-aligned offsets, followed by an offset index and a fixed-size
+// footer. Readers map the file and return tensors that alias the mapping, so
+// epochs after the first deserialize nothing and copy nothing, and worker
+// processes pointed at the same cache file share its physical pages through
+// the OS page cache.
+constexpr char kMmapCacheEnvVar[] = "TF_DATA_CACHE_MMAP";
+constexpr char kMmapCacheSuffix[] = ".mmap";
+constexpr char kMmapCacheTmpSuffix[] = ".tmp";
+// Spells "tfdatamm" in little-endian ASCII.
+constexpr uint64 kMmapCacheMagic = 0x6d6d617461646674ULL;
+constexpr size_t kMmapCacheFooterBytes = 3 * sizeof(uint64);
+
+// A tensor buffer that aliases a slice of a memory-mapped cache file. The
+// buffer shares ownership of the mapping, so tensors remain valid after the
+// iterator that produced them is destroyed. The mapping is read-only;
+// consumers must not mutate these tensors in place. The cache reader hands
+// out each buffer with an extra reference held for the iterator's lifetime,
+// which keeps the reference count above one and thereby keeps kernels from
+// forwarding the buffer into an in-place computation.
+class MmapCacheTensorBuffer : public TensorBuffer {
+ public:
+  MmapCacheTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+    proto->set_allocator_name("mmap_cache");
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  size_t size_;
+};
+
 class CacheDatasetOp::FileDataset : public DatasetBase {
  public:
   explicit FileDataset(OpKernelContext* ctx, const DatasetBase* input,
@@ -73,6 +124,28 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
                                               tensor_index_padding_size_)) {
     input_->Ref();
     DCHECK_EQ(item_index_padding_size_, 7);
+
+    bool mmap_enabled = false;
+    Status s = ReadBoolFromEnvVar(kMmapCacheEnvVar, /*default_val=*/false,
+                                  &mmap_enabled);
+    if (s.ok() && mmap_enabled) {
+      // The memory-mapped format stores raw tensor bytes, so it only
+      // supports memcpy-able element types; anything else keeps using the
+      // tensor bundle format.
+      mmap_cache_ = true;
+      for (DataType dtype : input->output_dtypes()) {
+        if (!DataTypeCanUseMemcpy(dtype)) {
+          LOG(WARNING) << kMmapCacheEnvVar
+                       << " is set, but the cached elements contain component "
+                          "type "
+                       << DataTypeString(dtype)
+                       << " which cannot be memory-mapped; falling back to "
+                          "the tensor bundle cache format.";
+          mmap_cache_ = false;
+          break;
+        }
+      }
+    }
   }
 
   ~FileDataset() override { input_->Unref(); }
@@ -130,12 +203,22 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
                            tensor_index);
   }
 
+  string MmapCacheFilename() const {
+    return strings::StrCat(filename_, kMmapCacheSuffix);
+  }
+
+  // Returns the file whose existence indicates a completely written cache,
+  // for the format this dataset uses.
+  string CacheIndexFilename() const {
+    return mmap_cache_ ? MmapCacheFilename() : MetaFilename(filename_);
+  }
+
   class FileIterator : public DatasetIterator<FileDataset> {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDataset>(params) {
       if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
+              ->FileExists(params.dataset->CacheIndexFilename())
               .ok()) {
         mode_ = Mode::read;
       } else {
@@ -178,13 +261,13 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       }
       if (mode_ == Mode::write &&
           dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
+              ->env_->FileExists(dataset()->CacheIndexFilename())
               .ok()) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
             << "It looks like the cache was already completely written("
-            << MetaFilename(dataset()->filename_)
+            << dataset()->CacheIndexFilename()
             << ") after the last checkpoint was saved. Attempting to read "
             << "the cache instead of continuing to write. If this is a "
             << "mistake, please remove the above file and try running again.";
@@ -567,6 +650,348 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       bool iterator_restored_ GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // Writes the cache in the memory-mapped format: raw tensor bytes at
+    // 64-byte-aligned offsets, followed by the offset index and footer. The
+    // cache is streamed to a temporary file that is renamed into place only
+    // once the input has been exhausted, so readers never observe a partial
+    // cache. Unlike `FileWriterIterator`, a partially written cache cannot
+    // be checkpointed; saving fails until the cache is complete.
+    class MmapFileWriterIterator : public DatasetIterator<FileDataset> {
+     public:
+      explicit MmapFileWriterIterator(const Params& params)
+          : DatasetIterator<FileDataset>(params),
+            filename_(params.dataset->MmapCacheFilename()),
+            tmp_filename_(strings::StrCat(filename_, kMmapCacheTmpSuffix)),
+            lockfile_(strings::StrCat(filename_, kLockFileSuffix)) {}
+
+      ~MmapFileWriterIterator() override {
+        if (file_created_ && !iteration_completed_) {
+          file_.reset();
+          for (const string& path : {tmp_filename_, lockfile_}) {
+            Status s = dataset()->env_->DeleteFile(path);
+            if (!s.ok()) {
+              LOG(WARNING) << "Failed to delete " << path << " : "
+                           << s.ToString();
+            }
+          }
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (iteration_completed_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(EnsureFileCreated());
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          return Finish();
+        }
+        if (out_tensors->size() != dataset()->num_tensors_) {
+          return errors::Internal(
+              "Upstream iterator returned invalid number of tensors. "
+              "Expected ",
+              dataset()->num_tensors_, " got: ", out_tensors->size());
+        }
+        for (const Tensor& t : *out_tensors) {
+          StringPiece data = t.tensor_data();
+          // Align the tensor so that readers can alias it in place.
+          uint64 aligned_offset =
+              (offset_ + Allocator::kAllocatorAlignment - 1) /
+              Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+          if (aligned_offset > offset_) {
+            static const string* const kPadding =
+                new string(Allocator::kAllocatorAlignment, '\0');
+            TF_RETURN_IF_ERROR(file_->Append(
+                StringPiece(kPadding->data(), aligned_offset - offset_)));
+          }
+          TF_RETURN_IF_ERROR(file_->Append(data));
+          offset_ = aligned_offset + data.size();
+
+          core::PutFixed64(&index_, aligned_offset);
+          core::PutFixed64(&index_, data.size());
+          core::PutFixed32(&index_, static_cast<uint32>(t.dtype()));
+          core::PutFixed32(&index_, static_cast<uint32>(t.dims()));
+          for (int d = 0; d < t.dims(); ++d) {
+            core::PutFixed64(&index_, static_cast<uint64>(t.dim_size(d)));
+          }
+        }
+        num_elements_++;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        if (!iteration_completed_) {
+          return errors::Unimplemented(
+              "Checkpointing a partially written memory-mapped cache (",
+              kMmapCacheEnvVar,
+              ") is not supported. Run the cached input to completion before "
+              "saving, or unset the environment variable to use the tensor "
+              "bundle cache format.");
+        }
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kCurIndex), num_elements_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kIterationCompleted), ""));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        int64 temp;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurIndex), &temp));
+        num_elements_ = temp;
+        iteration_completed_ =
+            reader->Contains(full_name(kIterationCompleted));
+        return Status::OK();
+      }
+
+     private:
+      Status EnsureFileCreated() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (file_created_) {
+          return Status::OK();
+        }
+        if (dataset()->env_->FileExists(lockfile_).ok()) {
+          return errors::AlreadyExists(
+              "There appears to be a concurrent caching iterator running - "
+              "cache lockfile already exists ('",
+              lockfile_,
+              "'). If you are sure no other running TF computations are "
+              "using this cache prefix, delete the lockfile and "
+              "re-initialize the iterator.");
+        }
+        std::unique_ptr<WritableFile> lockfile;
+        TF_RETURN_IF_ERROR(
+            dataset()->env_->NewWritableFile(lockfile_, &lockfile));
+        TF_RETURN_IF_ERROR(lockfile->Append(
+            strings::StrCat(kCreatedAt, ": ", dataset()->env_->NowSeconds())));
+        TF_RETURN_IF_ERROR(
+            dataset()->env_->NewWritableFile(tmp_filename_, &file_));
+        file_created_ = true;
+        return Status::OK();
+      }
+
+      Status Finish() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        iteration_completed_ = true;
+        const uint64 index_offset = offset_;
+        TF_RETURN_IF_ERROR(file_->Append(index_));
+        string footer;
+        core::PutFixed64(&footer, index_offset);
+        core::PutFixed64(&footer, num_elements_);
+        core::PutFixed64(&footer, kMmapCacheMagic);
+        TF_RETURN_IF_ERROR(file_->Append(footer));
+        TF_RETURN_IF_ERROR(file_->Close());
+        file_.reset();
+        TF_RETURN_IF_ERROR(
+            dataset()->env_->RenameFile(tmp_filename_, filename_));
+        return dataset()->env_->DeleteFile(lockfile_);
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      const string filename_;
+      const string tmp_filename_;
+      const string lockfile_;
+      std::unique_ptr<WritableFile> file_ GUARDED_BY(mu_);
+      bool file_created_ GUARDED_BY(mu_) = false;
+      bool iteration_completed_ GUARDED_BY(mu_) = false;
+      uint64 offset_ GUARDED_BY(mu_) = 0;
+      uint64 num_elements_ GUARDED_BY(mu_) = 0;
+      // Index entries accumulated in memory and appended on `Finish`.
+      string index_ GUARDED_BY(mu_);
+    };  // MmapFileWriterIterator
+
+    // Reads a completely written memory-mapped cache. The file is mapped
+    // once and every returned tensor aliases the mapping, so reading an
+    // element deserializes and copies nothing.
+    class MmapFileReaderIterator : public DatasetIterator<FileDataset> {
+     public:
+      explicit MmapFileReaderIterator(const Params& params)
+          : DatasetIterator<FileDataset>(params) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        status_ = dataset()->env_->NewReadOnlyMemoryRegionFromFile(
+            dataset()->MmapCacheFilename(), &region);
+        if (status_.ok()) {
+          region_ = std::shared_ptr<ReadOnlyMemoryRegion>(std::move(region));
+          status_ = ParseIndex();
+        }
+      }
+
+      ~MmapFileReaderIterator() override {
+        for (auto& element_buffers : buffers_) {
+          for (TensorBuffer* buffer : element_buffers) {
+            if (buffer) {
+              buffer->Unref();
+            }
+          }
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(status_);
+        if (cur_index_ >= elements_.size()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        const std::vector<ComponentMeta>& components = elements_[cur_index_];
+        std::vector<TensorBuffer*>& element_buffers = buffers_[cur_index_];
+        element_buffers.resize(components.size());
+        out_tensors->clear();
+        out_tensors->reserve(components.size());
+        const char* base = static_cast<const char*>(region_->data());
+        for (size_t i = 0; i < components.size(); ++i) {
+          const ComponentMeta& meta = components[i];
+          if (meta.num_bytes == 0) {
+            out_tensors->emplace_back(meta.dtype, meta.shape);
+            continue;
+          }
+          if (!element_buffers[i]) {
+            // The buffer is created once and kept referenced for the
+            // lifetime of the iterator; later epochs reuse it, and the
+            // extra reference keeps consumers from mutating the read-only
+            // mapping through in-place buffer forwarding.
+            element_buffers[i] = new MmapCacheTensorBuffer(
+                region_, base + meta.offset, meta.num_bytes);
+          }
+          out_tensors->emplace_back(meta.dtype, meta.shape,
+                                    element_buffers[i]);
+        }
+        cur_index_++;
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        return writer->WriteScalar(full_name(kCurIndex), cur_index_);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(status_);
+        int64 temp;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurIndex), &temp));
+        if (temp < 0 || static_cast<size_t>(temp) > elements_.size()) {
+          return errors::Internal("Invalid value for cur_index ", temp);
+        }
+        cur_index_ = static_cast<size_t>(temp);
+        return Status::OK();
+      }
+
+     private:
+      struct ComponentMeta {
+        uint64 offset;
+        uint64 num_bytes;
+        DataType dtype;
+        TensorShape shape;
+      };
+
+      Status ParseIndex() {
+        const char* base = static_cast<const char*>(region_->data());
+        const uint64 file_size = region_->length();
+        if (file_size < kMmapCacheFooterBytes) {
+          return errors::DataLoss("Memory-mapped cache file is truncated: ",
+                                  dataset()->MmapCacheFilename());
+        }
+        const char* footer = base + file_size - kMmapCacheFooterBytes;
+        if (core::DecodeFixed64(footer + 2 * sizeof(uint64)) !=
+            kMmapCacheMagic) {
+          return errors::DataLoss(
+              "File is not a memory-mapped tf.data cache: ",
+              dataset()->MmapCacheFilename());
+        }
+        const uint64 index_offset = core::DecodeFixed64(footer);
+        const uint64 num_elements = core::DecodeFixed64(footer + sizeof(uint64));
+        if (index_offset > file_size - kMmapCacheFooterBytes) {
+          return errors::DataLoss("Memory-mapped cache index is corrupt: ",
+                                  dataset()->MmapCacheFilename());
+        }
+        const char* pos = base + index_offset;
+        const char* index_end = base + file_size - kMmapCacheFooterBytes;
+        elements_.reserve(num_elements);
+        for (uint64 i = 0; i < num_elements; ++i) {
+          std::vector<ComponentMeta> components;
+          components.reserve(dataset()->num_tensors_);
+          for (size_t t = 0; t < dataset()->num_tensors_; ++t) {
+            if (static_cast<size_t>(index_end - pos) <
+                2 * sizeof(uint64) + 2 * sizeof(uint32)) {
+              return errors::DataLoss(
+                  "Memory-mapped cache index is truncated: ",
+                  dataset()->MmapCacheFilename());
+            }
+            ComponentMeta meta;
+            meta.offset = core::DecodeFixed64(pos);
+            meta.num_bytes = core::DecodeFixed64(pos + sizeof(uint64));
+            meta.dtype = static_cast<DataType>(
+                core::DecodeFixed32(pos + 2 * sizeof(uint64)));
+            const uint32 rank = core::DecodeFixed32(pos + 2 * sizeof(uint64) +
+                                                    sizeof(uint32));
+            pos += 2 * sizeof(uint64) + 2 * sizeof(uint32);
+            if (static_cast<size_t>(index_end - pos) < rank * sizeof(uint64)) {
+              return errors::DataLoss(
+                  "Memory-mapped cache index is truncated: ",
+                  dataset()->MmapCacheFilename());
+            }
+            for (uint32 d = 0; d < rank; ++d) {
+              meta.shape.AddDim(static_cast<int64>(core::DecodeFixed64(pos)));
+              pos += sizeof(uint64);
+            }
+            if (!DataTypeCanUseMemcpy(meta.dtype) ||
+                meta.offset % Allocator::kAllocatorAlignment != 0 ||
+                meta.offset + meta.num_bytes > index_offset ||
+                meta.num_bytes != meta.shape.num_elements() *
+                                      DataTypeSize(meta.dtype)) {
+              return errors::DataLoss(
+                  "Memory-mapped cache entry is corrupt: ",
+                  dataset()->MmapCacheFilename());
+            }
+            components.push_back(std::move(meta));
+          }
+          elements_.push_back(std::move(components));
+        }
+        buffers_.resize(elements_.size());
+        return Status::OK();
+      }
+
+      mutex mu_;
+      Status status_ GUARDED_BY(mu_);
+      std::shared_ptr<ReadOnlyMemoryRegion> region_;
+      std::vector<std::vector<ComponentMeta>> elements_ GUARDED_BY(mu_);
+      // One buffer per cached tensor, created lazily and owned by the
+      // iterator (one reference each) so buffer reference counts stay above
+      // one while tensors aliasing them are live.
+      std::vector<std::vector<TensorBuffer*>> buffers_ GUARDED_BY(mu_);
+      size_t cur_index_ GUARDED_BY(mu_) = 0;
+    };  // MmapFileReaderIterator
+
     void InitializeIterator() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator`
       // and `FileWriterIterator`. Since at any time there will be at most
@@ -578,14 +1003,26 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       // `FileReaderIterator` and seek to the `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              absl::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()->mmap_cache_) {
+            iterator_ = absl::make_unique<MmapFileReaderIterator>(
+                MmapFileReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = absl::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
-          iterator_ =
-              absl::make_unique<FileWriterIterator>(FileWriterIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()->mmap_cache_) {
+            iterator_ = absl::make_unique<MmapFileWriterIterator>(
+                MmapFileWriterIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = absl::make_unique<FileWriterIterator>(
+                FileWriterIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          }
       }
     }
 
@@ -601,6 +1038,9 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
   static const size_t kMaxItems = 10000000;  // 10 million
   const size_t item_index_padding_size_;
   const string tensor_format_string_;
+  // Whether this dataset uses the memory-mapped cache format. See
+  // `kMmapCacheEnvVar`.
+  bool mmap_cache_ = false;
 };  // FileDataset
 
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDataset {
@@ -0,0 +1,681 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Reads the Arrow IPC file format (also called "Feather V2" / ".arrow"):
+// a magic-delimited file whose footer lists the offsets of self-contained
+// record batches, with all metadata encoded as flatbuffers
+// (https://arrow.apache.org/docs/format/Columnar.html#ipc-file-format).
+//
+// Only the small, stable subset of the format this dataset needs is parsed —
+// flat schemas of fixed-width primitive columns — so the reader is
+// self-contained rather than depending on the full Arrow C++ library. Column
+// data buffers are handed to TensorFlow zero-copy (backed by the memory
+// mapping) whenever the dtype layout matches; bit-packed booleans and
+// unaligned buffers are copied.
+
+// ---------------------------------------------------------------------------
+// Minimal flatbuffers accessors.
+//
+// Flatbuffers is a simple format: a table is an array of fields located
+// through a vtable of 16-bit offsets, vectors are a 32-bit length followed by
+// elements, and references are 32-bit relative offsets. The view below
+// implements just those rules with sticky bounds checking: any out-of-range
+// access zeroes the result and marks the whole parse as failed, which the
+// callers check at well-defined points.
+// ---------------------------------------------------------------------------
+class FlatBufferView {
+ public:
+  FlatBufferView(const uint8* data, size_t size) : data_(data), size_(size) {}
+
+  bool ok() const { return ok_; }
+
+  uint8 ReadU8(size_t pos) { return Read<uint8>(pos); }
+  uint16 ReadU16(size_t pos) { return Read<uint16>(pos); }
+  uint32 ReadU32(size_t pos) { return Read<uint32>(pos); }
+  int32 ReadI32(size_t pos) { return Read<int32>(pos); }
+  int64 ReadI64(size_t pos) { return Read<int64>(pos); }
+
+  // Follows a relative offset to a table, vector or string.
+  size_t Indirect(size_t pos) { return pos + ReadU32(pos); }
+
+  // Returns the position of field `field_id` of the table at `table_pos`, or
+  // 0 if the field is absent.
+  size_t TableField(size_t table_pos, int field_id) {
+    const size_t vtable_pos = table_pos - ReadI32(table_pos);
+    const uint16 vtable_size = ReadU16(vtable_pos);
+    const size_t entry = 4 + 2 * field_id;
+    if (entry + 2 > vtable_size) return 0;
+    const uint16 field_offset = ReadU16(vtable_pos + entry);
+    if (field_offset == 0) return 0;
+    return table_pos + field_offset;
+  }
+
+  // Scalar table fields with flatbuffers defaults when absent.
+  int64 TableFieldI64(size_t table_pos, int field_id, int64 default_value) {
+    const size_t pos = TableField(table_pos, field_id);
+    return pos == 0 ? default_value : ReadI64(pos);
+  }
+  int32 TableFieldI32(size_t table_pos, int field_id, int32 default_value) {
+    const size_t pos = TableField(table_pos, field_id);
+    return pos == 0 ? default_value : ReadI32(pos);
+  }
+  uint8 TableFieldU8(size_t table_pos, int field_id, uint8 default_value) {
+    const size_t pos = TableField(table_pos, field_id);
+    return pos == 0 ? default_value : ReadU8(pos);
+  }
+
+  // Reference table fields (tables, vectors, strings); 0 when absent.
+  size_t TableFieldRef(size_t table_pos, int field_id) {
+    const size_t pos = TableField(table_pos, field_id);
+    return pos == 0 ? 0 : Indirect(pos);
+  }
+
+  uint32 VectorLength(size_t vector_pos) { return ReadU32(vector_pos); }
+  size_t VectorData(size_t vector_pos) { return vector_pos + 4; }
+
+  string ReadString(size_t string_pos) {
+    const uint32 length = VectorLength(string_pos);
+    if (!InBounds(VectorData(string_pos), length)) {
+      ok_ = false;
+      return "";
+    }
+    return string(reinterpret_cast<const char*>(data_ + VectorData(string_pos)),
+                  length);
+  }
+
+ private:
+  bool InBounds(size_t pos, size_t len) const {
+    return pos <= size_ && len <= size_ - pos;
+  }
+
+  template <typename T>
+  T Read(size_t pos) {
+    if (!InBounds(pos, sizeof(T))) {
+      ok_ = false;
+      return T();
+    }
+    T value;
+    memcpy(&value, data_ + pos, sizeof(T));
+    return value;
+  }
+
+  const uint8* data_;
+  size_t size_;
+  bool ok_ = true;
+};
+
+// Field ids and enum values from the Arrow format flatbuffers schemas
+// (format/File.fbs, format/Schema.fbs, format/Message.fbs). These are part of
+// the stable wire format.
+constexpr int kFooterSchemaField = 1;
+constexpr int kFooterRecordBatchesField = 3;
+constexpr int kSchemaFieldsField = 1;
+constexpr int kFieldNameField = 0;
+constexpr int kFieldTypeTypeField = 2;
+constexpr int kFieldTypeField = 3;
+constexpr int kFieldChildrenField = 5;
+constexpr int kIntBitWidthField = 0;
+constexpr int kIntIsSignedField = 1;
+constexpr int kFloatingPointPrecisionField = 0;
+constexpr int kMessageHeaderTypeField = 1;
+constexpr int kMessageHeaderField = 2;
+constexpr int kRecordBatchLengthField = 0;
+constexpr int kRecordBatchNodesField = 1;
+constexpr int kRecordBatchBuffersField = 2;
+
+constexpr uint8 kTypeInt = 2;            // Type union: Int
+constexpr uint8 kTypeFloatingPoint = 3;  // Type union: FloatingPoint
+constexpr uint8 kTypeBool = 6;           // Type union: Bool
+constexpr uint8 kMessageRecordBatch = 3;  // MessageHeader union: RecordBatch
+
+// Block struct in File.fbs: int64 offset, int32 metaDataLength (+4 padding),
+// int64 bodyLength.
+constexpr size_t kBlockSize = 24;
+// FieldNode and Buffer structs are each two int64s.
+constexpr size_t kFieldNodeSize = 16;
+constexpr size_t kBufferSize = 16;
+
+constexpr char kArrowMagic[] = "ARROW1";
+constexpr size_t kArrowMagicSize = 6;
+
+struct ArrowColumn {
+  string name;
+  DataType dtype;
+  size_t width_bytes;  // 0 for bit-packed booleans
+};
+
+struct ArrowBlock {
+  int64 offset;
+  int32 metadata_length;
+  int64 body_length;
+};
+
+struct ArrowFile {
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  std::vector<ArrowColumn> columns;  // in schema order
+  std::vector<ArrowBlock> record_batches;
+
+  const uint8* data() const {
+    return static_cast<const uint8*>(region->data());
+  }
+  size_t size() const { return region->length(); }
+};
+
+Status ParseFieldType(FlatBufferView* view, size_t field_pos,
+                      const string& name, ArrowColumn* column) {
+  if (view->TableFieldRef(field_pos, kFieldChildrenField) != 0 &&
+      view->VectorLength(view->TableFieldRef(field_pos, kFieldChildrenField)) >
+          0) {
+    return errors::Unimplemented("Arrow column '", name,
+                                 "' is nested; only flat primitive columns "
+                                 "are supported");
+  }
+
+  const uint8 type_type = view->TableFieldU8(field_pos, kFieldTypeTypeField, 0);
+  const size_t type_pos = view->TableFieldRef(field_pos, kFieldTypeField);
+
+  switch (type_type) {
+    case kTypeInt: {
+      const int32 bit_width = view->TableFieldI32(type_pos, kIntBitWidthField, 0);
+      const bool is_signed =
+          view->TableFieldU8(type_pos, kIntIsSignedField, 0) != 0;
+      switch (bit_width) {
+        case 8:
+          column->dtype = is_signed ? DT_INT8 : DT_UINT8;
+          break;
+        case 16:
+          column->dtype = is_signed ? DT_INT16 : DT_UINT16;
+          break;
+        case 32:
+          column->dtype = is_signed ? DT_INT32 : DT_UINT32;
+          break;
+        case 64:
+          column->dtype = is_signed ? DT_INT64 : DT_UINT64;
+          break;
+        default:
+          return errors::Unimplemented("Arrow column '", name,
+                                       "' has unsupported integer width ",
+                                       bit_width);
+      }
+      column->width_bytes = bit_width / 8;
+      return Status::OK();
+    }
+    case kTypeFloatingPoint: {
+      const int32 precision =
+          view->TableFieldI32(type_pos, kFloatingPointPrecisionField, 0) &
+          0xFFFF;
+      switch (precision) {
+        case 0:  // HALF
+          column->dtype = DT_HALF;
+          column->width_bytes = 2;
+          return Status::OK();
+        case 1:  // SINGLE
+          column->dtype = DT_FLOAT;
+          column->width_bytes = 4;
+          return Status::OK();
+        case 2:  // DOUBLE
+          column->dtype = DT_DOUBLE;
+          column->width_bytes = 8;
+          return Status::OK();
+        default:
+          return errors::Unimplemented("Arrow column '", name,
+                                       "' has unsupported float precision");
+      }
+    }
+    case kTypeBool:
+      column->dtype = DT_BOOL;
+      column->width_bytes = 0;  // bit-packed
+      return Status::OK();
+    default:
+      return errors::Unimplemented(
+          "Arrow column '", name, "' has unsupported type (Type union value ",
+          static_cast<int>(type_type),
+          "); only fixed-width integers, floats and booleans are supported");
+  }
+}
+
+// Parses the footer and schema of a mapped Arrow IPC file.
+Status ParseArrowFile(const string& filename, ArrowFile* file) {
+  const uint8* data = file->data();
+  const size_t size = file->size();
+
+  if (size < 2 * kArrowMagicSize + sizeof(int32) + 2 ||
+      memcmp(data, kArrowMagic, kArrowMagicSize) != 0 ||
+      memcmp(data + size - kArrowMagicSize, kArrowMagic, kArrowMagicSize) !=
+          0) {
+    return errors::InvalidArgument("Not an Arrow IPC file: ", filename);
+  }
+
+  FlatBufferView view(data, size);
+  const size_t footer_length_pos = size - kArrowMagicSize - sizeof(int32);
+  const int32 footer_length = view.ReadI32(footer_length_pos);
+  if (footer_length <= 0 ||
+      static_cast<size_t>(footer_length) > footer_length_pos) {
+    return errors::DataLoss("Corrupt Arrow footer in ", filename);
+  }
+
+  const size_t footer_pos =
+      view.Indirect(footer_length_pos - footer_length);
+  const size_t schema_pos = view.TableFieldRef(footer_pos, kFooterSchemaField);
+  if (!view.ok() || schema_pos == 0) {
+    return errors::DataLoss("Corrupt Arrow footer in ", filename);
+  }
+
+  // Schema fields, in order. FieldNodes and Buffers of every record batch
+  // follow this order, which is why nested columns anywhere in the schema are
+  // rejected: they would change the buffer layout.
+  const size_t fields_pos = view.TableFieldRef(schema_pos, kSchemaFieldsField);
+  if (fields_pos == 0) {
+    return errors::DataLoss("Arrow schema without fields in ", filename);
+  }
+  const uint32 num_fields = view.VectorLength(fields_pos);
+  for (uint32 i = 0; i < num_fields; ++i) {
+    const size_t field_pos =
+        view.Indirect(view.VectorData(fields_pos) + 4 * i);
+    ArrowColumn column;
+    const size_t name_pos = view.TableFieldRef(field_pos, kFieldNameField);
+    column.name = name_pos == 0 ? "" : view.ReadString(name_pos);
+    if (!view.ok()) {
+      return errors::DataLoss("Corrupt Arrow schema in ", filename);
+    }
+    TF_RETURN_IF_ERROR(ParseFieldType(&view, field_pos, column.name, &column));
+    file->columns.push_back(std::move(column));
+  }
+
+  // Record batch blocks.
+  const size_t blocks_pos =
+      view.TableFieldRef(footer_pos, kFooterRecordBatchesField);
+  if (blocks_pos != 0) {
+    const uint32 num_blocks = view.VectorLength(blocks_pos);
+    for (uint32 i = 0; i < num_blocks; ++i) {
+      const size_t block_pos = view.VectorData(blocks_pos) + kBlockSize * i;
+      ArrowBlock block;
+      block.offset = view.ReadI64(block_pos);
+      block.metadata_length = view.ReadI32(block_pos + 8);
+      block.body_length = view.ReadI64(block_pos + 16);
+      file->record_batches.push_back(block);
+    }
+  }
+
+  if (!view.ok()) {
+    return errors::DataLoss("Corrupt Arrow footer in ", filename);
+  }
+  return Status::OK();
+}
+
+// A TensorBuffer aliasing a column's data buffer inside the file mapping.
+// Owns a reference on the mapping, not the bytes themselves.
+class MappedColumnBuffer : public TensorBuffer {
+ public:
+  MappedColumnBuffer(const void* data, size_t size,
+                     std::shared_ptr<ReadOnlyMemoryRegion> region)
+      : TensorBuffer(const_cast<void*>(data)),
+        size_(size),
+        region_(std::move(region)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+class ArrowFileDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ArrowFileDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("columns", &columns_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES(ctx, columns_.size() == output_types_.size(),
+                errors::InvalidArgument(
+                    "`columns` and `output_types` must have the same size."));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    }
+
+    *output = new Dataset(ctx, filenames, columns_, output_types_,
+                          output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            std::vector<string> columns, DataTypeVector output_types,
+            std::vector<PartialTensorShape> output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          columns_(std::move(columns)),
+          output_types_(std::move(output_types)),
+          output_shapes_(std::move(output_shapes)) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::ArrowFile")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ArrowFileDatasetOp::Dataset";
+    }
+
+    Status CheckExternalState() const override { return Status::OK(); }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames},
+          {{"columns", ColumnsAttr()},
+           {"output_types", TypesAttr()},
+           {"output_shapes", ShapesAttr()}},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    AttrValue ColumnsAttr() const {
+      AttrValue attr;
+      for (const string& column : columns_) {
+        attr.mutable_list()->add_s(column);
+      }
+      return attr;
+    }
+    AttrValue TypesAttr() const {
+      AttrValue attr;
+      for (DataType dtype : output_types_) {
+        attr.mutable_list()->add_type(dtype);
+      }
+      return attr;
+    }
+    AttrValue ShapesAttr() const {
+      AttrValue attr;
+      for (const PartialTensorShape& shape : output_shapes_) {
+        shape.AsProto(attr.mutable_list()->add_shape());
+      }
+      return attr;
+    }
+
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          if (file_ &&
+              batch_index_ < file_->record_batches.size()) {
+            TF_RETURN_IF_ERROR(EmitBatch(batch_index_, out_tensors));
+            ++batch_index_;
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          file_.reset();
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(SetupFileLocked(ctx->env()));
+        } while (true);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            "Checkpointing is currently not supported for ArrowFileDataset.");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            "Checkpointing is currently not supported for ArrowFileDataset.");
+      }
+
+     private:
+      Status SetupFileLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const string& filename =
+            dataset()->filenames_[current_file_index_++];
+
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        TF_RETURN_IF_ERROR(
+            env->NewReadOnlyMemoryRegionFromFile(filename, &region));
+
+        auto file = absl::make_unique<ArrowFile>();
+        file->region = std::shared_ptr<ReadOnlyMemoryRegion>(region.release());
+        TF_RETURN_IF_ERROR(ParseArrowFile(filename, file.get()));
+
+        // Resolve the requested columns against this file's schema and check
+        // the dtypes promised to the graph.
+        selected_columns_.clear();
+        for (size_t i = 0; i < dataset()->columns_.size(); ++i) {
+          const string& wanted = dataset()->columns_[i];
+          int found = -1;
+          for (size_t j = 0; j < file->columns.size(); ++j) {
+            if (file->columns[j].name == wanted) {
+              found = static_cast<int>(j);
+              break;
+            }
+          }
+          if (found < 0) {
+            return errors::InvalidArgument("Column '", wanted,
+                                           "' not found in Arrow file ",
+                                           filename);
+          }
+          if (file->columns[found].dtype != dataset()->output_types_[i]) {
+            return errors::InvalidArgument(
+                "Column '", wanted, "' in Arrow file ", filename, " has type ",
+                DataTypeString(file->columns[found].dtype),
+                " but the dataset expects ",
+                DataTypeString(dataset()->output_types_[i]));
+          }
+          selected_columns_.push_back(found);
+        }
+
+        file_ = std::move(file);
+        batch_index_ = 0;
+        return Status::OK();
+      }
+
+      Status EmitBatch(size_t batch_index, std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const ArrowFile& file = *file_;
+        const ArrowBlock& block = file.record_batches[batch_index];
+
+        FlatBufferView view(file.data(), file.size());
+
+        // The message envelope is an optional 0xFFFFFFFF continuation marker
+        // followed by the metadata length and the Message flatbuffer.
+        size_t pos = static_cast<size_t>(block.offset);
+        if (view.ReadU32(pos) == 0xFFFFFFFF) {
+          pos += 8;
+        } else {
+          pos += 4;
+        }
+        const size_t message_pos = view.Indirect(pos);
+        if (view.TableFieldU8(message_pos, kMessageHeaderTypeField, 0) !=
+            kMessageRecordBatch) {
+          return errors::DataLoss("Expected a record batch message");
+        }
+        const size_t batch_pos =
+            view.TableFieldRef(message_pos, kMessageHeaderField);
+        const int64 num_rows =
+            view.TableFieldI64(batch_pos, kRecordBatchLengthField, 0);
+        const size_t nodes_pos =
+            view.TableFieldRef(batch_pos, kRecordBatchNodesField);
+        const size_t buffers_pos =
+            view.TableFieldRef(batch_pos, kRecordBatchBuffersField);
+        if (!view.ok() || nodes_pos == 0 || buffers_pos == 0) {
+          return errors::DataLoss("Corrupt Arrow record batch metadata");
+        }
+        if (view.VectorLength(nodes_pos) != file.columns.size() ||
+            view.VectorLength(buffers_pos) != 2 * file.columns.size()) {
+          return errors::DataLoss(
+              "Arrow record batch does not match the file schema");
+        }
+
+        const size_t body_pos =
+            static_cast<size_t>(block.offset + block.metadata_length);
+
+        for (size_t i = 0; i < selected_columns_.size(); ++i) {
+          const int si = selected_columns_[i];
+          const ArrowColumn& column = file.columns[si];
+
+          // One FieldNode and two buffers (validity bitmap, data) per flat
+          // primitive column, in schema order.
+          const size_t node_pos =
+              view.VectorData(nodes_pos) + kFieldNodeSize * si;
+          const int64 null_count = view.ReadI64(node_pos + 8);
+          if (null_count != 0) {
+            return errors::InvalidArgument(
+                "Column '", column.name,
+                "' contains nulls, which have no tensor representation");
+          }
+
+          const size_t buffer_pos =
+              view.VectorData(buffers_pos) + kBufferSize * (2 * si + 1);
+          const int64 data_offset = view.ReadI64(buffer_pos);
+          const int64 data_length = view.ReadI64(buffer_pos + 8);
+          if (!view.ok()) {
+            return errors::DataLoss("Corrupt Arrow record batch metadata");
+          }
+
+          const uint8* data = file.data() + body_pos + data_offset;
+          if (body_pos + data_offset + data_length > file.size()) {
+            return errors::DataLoss("Arrow buffer extends past end of file");
+          }
+
+          if (column.dtype == DT_BOOL) {
+            // Bit-packed; unpack into a byte-per-value tensor.
+            Tensor tensor(DT_BOOL, TensorShape({num_rows}));
+            auto flat = tensor.flat<bool>();
+            for (int64 row = 0; row < num_rows; ++row) {
+              flat(row) = (data[row / 8] >> (row % 8)) & 1;
+            }
+            out_tensors->push_back(std::move(tensor));
+            continue;
+          }
+
+          const int64 needed_bytes = num_rows * column.width_bytes;
+          if (data_length < needed_bytes) {
+            return errors::DataLoss("Arrow buffer for column '", column.name,
+                                    "' is too small");
+          }
+
+          const bool aligned =
+              reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0;
+          if (aligned) {
+            // Zero-copy: alias the mapped pages. The pinned reference below
+            // keeps the buffer's refcount above one for the iterator's
+            // lifetime so no downstream kernel can claim the (read-only)
+            // pages for an in-place write through buffer forwarding.
+            auto* buffer =
+                new MappedColumnBuffer(data, needed_bytes, file.region);
+            Tensor tensor(column.dtype, TensorShape({num_rows}), buffer);
+            buffer->Unref();
+            pinned_.push_back(tensor);
+            out_tensors->push_back(std::move(tensor));
+          } else {
+            Tensor tensor(column.dtype, TensorShape({num_rows}));
+            memcpy(const_cast<char*>(tensor.tensor_data().data()), data,
+                   needed_bytes);
+            out_tensors->push_back(std::move(tensor));
+          }
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      std::unique_ptr<ArrowFile> file_ GUARDED_BY(mu_);
+      size_t batch_index_ GUARDED_BY(mu_) = 0;
+      std::vector<int> selected_columns_ GUARDED_BY(mu_);
+
+      // Holds a second reference on every zero-copy tensor handed out, so
+      // their buffers never reach a refcount of one while in flight (see
+      // EmitBatch). Tensor handles only — the data stays in the mapping.
+      std::vector<Tensor> pinned_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const std::vector<string> columns_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  std::vector<string> columns_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ArrowFileDataset").Device(DEVICE_CPU),
+                        ArrowFileDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("ExperimentalArrowFileDataset").Device(DEVICE_CPU),
+                        ArrowFileDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -32,9 +32,12 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
+#include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/base64.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cord.h"
@@ -42,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/data/experimental/snapshot.pb.h"
 #include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -56,6 +60,8 @@ const int64 kDefaultShardSizeBytes = 10LL * 1024 * 1024 * 1024;
 const size_t kHeaderSize = sizeof(uint64);
 
 constexpr char kSnapshotFilename[] = "snapshot.metadata";
+constexpr char kSnapshotIndexSuffix[] = ".index";
+constexpr char kShuffleOnReadEnvVar[] = "TF_DATA_SNAPSHOT_SHUFFLE_ON_READ";
 constexpr char kSnapshotReaderWorkerPool[] = "snapshot_reader_worker_pool";
 constexpr char kSnapshotWriterWorkerPool[] = "snapshot_writer_worker_pool";
 constexpr char kSeparator[] = "::";
@@ -70,6 +76,10 @@ class SnapshotWriter {
   explicit SnapshotWriter(WritableFile* dest, const string& compression_type =
                                                   io::compression::kNone)
       : dest_(dest), compression_type_(compression_type) {
+    // Record offsets are only meaningful for random access when they address
+    // the file directly, so the index is tracked for uncompressed snapshots
+    // only.
+    track_offsets_ = compression_type == io::compression::kNone;
     if (compression_type == io::compression::kGzip) {
 #if defined(IS_SLIM_BUILD)
       LOG(ERROR) << "Compression is unsupported on mobile platforms. Turning "
@@ -94,6 +104,10 @@ class SnapshotWriter {
         profiler::TraceMeLevel::kInfo);
     char header[kHeaderSize];
     core::EncodeFixed64(header, data.size());
+    if (track_offsets_) {
+      record_offsets_.push_back(cur_offset_);
+      cur_offset_ += kHeaderSize + data.size();
+    }
     TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
     return dest_->Append(data);
   }
@@ -104,6 +118,10 @@ class SnapshotWriter {
                                profiler::TraceMeLevel::kInfo);
     char header[kHeaderSize];
     core::EncodeFixed64(header, data.size());
+    if (track_offsets_) {
+      record_offsets_.push_back(cur_offset_);
+      cur_offset_ += kHeaderSize + data.size();
+    }
 
     TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
 
@@ -111,6 +129,27 @@ class SnapshotWriter {
   }
 #endif  // PLATFORM_GOOGLE
 
+  // Writes the byte offset of every record appended so far to a sidecar
+  // index file: a flat array of fixed64 offsets, one per record, in write
+  // order. The index enables O(1) random access reads by record id, e.g.
+  // for shuffled-order snapshot reads. A no-op for compressed snapshots,
+  // where byte offsets cannot be sought to.
+  Status WriteIndexFile(const string& index_filename) {
+    if (!track_offsets_) {
+      return Status::OK();
+    }
+    std::unique_ptr<WritableFile> index_file;
+    TF_RETURN_IF_ERROR(
+        Env::Default()->NewWritableFile(index_filename, &index_file));
+    string buf;
+    buf.resize(record_offsets_.size() * sizeof(uint64));
+    for (size_t i = 0; i < record_offsets_.size(); ++i) {
+      core::EncodeFixed64(&buf[i * sizeof(uint64)], record_offsets_[i]);
+    }
+    TF_RETURN_IF_ERROR(index_file->Append(buf));
+    return index_file->Close();
+  }
+
   Status Close() {
     if (dest_is_owned_) {
       Status s = dest_->Close();
@@ -134,6 +173,9 @@ class SnapshotWriter {
   WritableFile* dest_;
   bool dest_is_owned_ = false;
   const string compression_type_;
+  bool track_offsets_ = false;
+  uint64 cur_offset_ = 0;
+  std::vector<uint64> record_offsets_;
 };
 
 class SnapshotReader {
@@ -232,6 +274,31 @@ Status ReadMetadataFile(const string& hash_dir,
   return Status::OK();
 }
 
+// Reads the record offset table written by SnapshotWriter::WriteIndexFile.
+Status ReadSnapshotIndexFile(Env* env, const string& index_filename,
+                             std::vector<uint64>* offsets) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &file_size));
+  if (file_size % sizeof(uint64) != 0) {
+    return errors::DataLoss("Corrupt snapshot index file: ", index_filename);
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(index_filename, &file));
+
+  string buf;
+  buf.resize(file_size);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(0, file_size, &result, &buf[0]));
+
+  offsets->clear();
+  offsets->reserve(file_size / sizeof(uint64));
+  for (uint64 pos = 0; pos < file_size; pos += sizeof(uint64)) {
+    offsets->push_back(core::DecodeFixed64(result.data() + pos));
+  }
+  return Status::OK();
+}
+
 SnapshotMode DetermineOpState(
     const Status& file_status,
     const experimental::SnapshotMetadataRecord& metadata,
@@ -554,11 +621,34 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           // Get all the files in the run_dir.
           TF_RETURN_IF_ERROR(ctx->env()->GetMatchingPaths(
               absl::StrCat(run_dir_, "/*"), &filenames_));
+          // The run_dir also contains the offset index sidecars, which are
+          // not snapshot data.
+          filenames_.erase(
+              std::remove_if(filenames_.begin(), filenames_.end(),
+                             [](const string& filename) {
+                               return str_util::EndsWith(filename,
+                                                         kSnapshotIndexSuffix);
+                             }),
+              filenames_.end());
           if (filenames_.empty()) {
             return errors::InvalidArgument("Could not find any files in dir: ",
                                            run_dir_);
           }
           std::sort(filenames_.begin(), filenames_.end());
+
+          TF_RETURN_IF_ERROR(ReadBoolFromEnvVar(kShuffleOnReadEnvVar,
+                                                /*default_val=*/false,
+                                                &shuffle_on_read_));
+          if (shuffle_on_read_) {
+            // Randomize the file read order; within each file the offset
+            // index (when present) randomizes the record read order, giving
+            // a globally shuffled epoch without a shuffle buffer.
+            random::PhiloxRandom philox(random::New64(), random::New64());
+            random::SimplePhilox rand(&philox);
+            for (size_t i = filenames_.size() - 1; i > 0; --i) {
+              std::swap(filenames_[i], filenames_[rand.Uniform64(i + 1)]);
+            }
+          }
           return Status::OK();
         }
 
@@ -629,6 +719,20 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
        private:
         // Reads one file end to end.
         Status ReadFile(const string& filename) {
+          if (shuffle_on_read_ &&
+              dataset()->compression_ == io::compression::kNone) {
+            std::vector<uint64> offsets;
+            Status s = ReadSnapshotIndexFile(
+                Env::Default(),
+                absl::StrCat(filename, kSnapshotIndexSuffix), &offsets);
+            if (s.ok()) {
+              return ReadFileShuffled(filename, std::move(offsets));
+            }
+            // Shards written before indexing existed have no sidecar; fall
+            // back to reading them in sequential order.
+            VLOG(2) << "No usable index for " << filename
+                    << ", reading sequentially: " << s.ToString();
+          }
           std::unique_ptr<RandomAccessFile> file;
           TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
           std::unique_ptr<SnapshotReader> reader(
@@ -689,6 +793,77 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           return Status::OK();
         }
 
+        // Reads one file in a freshly drawn random record order, seeking to
+        // each record through the offset index. Memory cost is the offset
+        // table (8 bytes per record), independent of element size, so large
+        // snapshots shuffle without a shuffle buffer.
+        Status ReadFileShuffled(const string& filename,
+                                std::vector<uint64> offsets) {
+          std::unique_ptr<RandomAccessFile> file;
+          TF_RETURN_IF_ERROR(
+              Env::Default()->NewRandomAccessFile(filename, &file));
+
+          random::PhiloxRandom philox(random::New64(), random::New64());
+          random::SimplePhilox rand(&philox);
+          for (size_t i = offsets.size(); i > 1; --i) {
+            std::swap(offsets[i - 1], offsets[rand.Uniform64(i)]);
+          }
+
+          for (uint64 offset : offsets) {
+            // Wait for a slot in the buffer.
+            {
+              mutex_lock l(mu_);
+              while (!cancelled_ &&
+                     buffer_.size() >= dataset()->reader_buffer_size_) {
+                cond_var_.wait(l);
+              }
+
+              if (cancelled_) {
+                return errors::Cancelled(
+                    "SnapshotDatasetOp::Dataset::SnapshotReaderIterator::"
+                    "ReadFileShuffled");
+              }
+            }
+
+            char header[kHeaderSize];
+            StringPiece header_piece;
+            TF_RETURN_IF_ERROR(
+                file->Read(offset, kHeaderSize, &header_piece, header));
+            uint64 length = core::DecodeFixed64(header_piece.data());
+
+            string record_bytes;
+            record_bytes.resize(length);
+            StringPiece record_piece;
+            TF_RETURN_IF_ERROR(file->Read(offset + kHeaderSize, length,
+                                          &record_piece, &record_bytes[0]));
+
+            profiler::TraceMe activity(
+                absl::StrCat(prefix(), kSeparator, kParse),
+                profiler::TraceMeLevel::kInfo);
+            experimental::SnapshotRecord record;
+            if (!record.ParseFromArray(record_piece.data(),
+                                       record_piece.size())) {
+              return errors::DataLoss("Unable to parse record at offset ",
+                                      offset, " in file: ", filename);
+            }
+            std::vector<Tensor> out_tensors;
+            for (int i = 0; i < record.tensor_size(); ++i) {
+              Tensor t;
+              if (!t.FromProto(record.tensor(i))) {
+                return errors::DataLoss("Unable to parse tensor from proto.");
+              }
+              out_tensors.push_back(t);
+            }
+            BufferElement elem;
+            std::swap(elem.value, out_tensors);
+            elem.status = Status::OK();
+            mutex_lock l(mu_);
+            buffer_.push_back(std::move(elem));
+            cond_var_.notify_all();
+          }
+          return Status::OK();
+        }
+
         // Pulls one file off the filenames_ list and reads it through. When
         // all files are read, terminates.
         void ReadingFilesLoop() {
@@ -748,6 +923,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         string run_id_ GUARDED_BY(mu_);
         string run_dir_ GUARDED_BY(mu_);
         std::vector<string> filenames_;
+        // Set once in Initialize, before the reader threads start.
+        bool shuffle_on_read_ = false;
 
         uint64 elements_produced_ GUARDED_BY(mu_) = 0;
         int64 time_spent_micros_ GUARDED_BY(mu_) = 0;
@@ -976,6 +1153,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
             if (*bytes_written > dataset()->shard_size_bytes_) {
               // If we exceed the shard size, we get a new file and reset.
+              TF_RETURN_IF_ERROR((*writer)->WriteIndexFile(absl::StrCat(
+                  *snapshot_data_filename, kSnapshotIndexSuffix)));
               TF_RETURN_IF_ERROR((*writer)->Close());
               TF_RETURN_IF_ERROR((*file)->Close());
               *snapshot_data_filename = GetSnapshotFilename();
@@ -996,6 +1175,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           }
 
           if (*end_of_processing) {
+            TF_RETURN_IF_ERROR((*writer)->WriteIndexFile(absl::StrCat(
+                *snapshot_data_filename, kSnapshotIndexSuffix)));
             TF_RETURN_IF_ERROR((*writer)->Close());
             TF_RETURN_IF_ERROR((*file)->Close());
             mutex_lock l(mu_);
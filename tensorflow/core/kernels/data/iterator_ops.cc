@@ -919,6 +919,57 @@ void IteratorGetNextOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       std::move(done)));
 }
 
+void IteratorGetNextNOp::ComputeAsync(OpKernelContext* ctx,
+                                      DoneCallback done) {
+  IteratorResource* iterator;
+  OP_REQUIRES_OK_ASYNC(
+      ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &iterator), done);
+  // The calls to `iterator->GetNext()` may block and depend on an
+  // inter-op thread pool thread, so we issue them from the owned thread pool.
+  background_worker_.Schedule(std::bind(
+      [this, ctx, iterator](DoneCallback done) {
+        int64 num_components = ctx->num_outputs() / num_elements_;
+        Status s;
+        for (int64 i = 0; i < num_elements_; ++i) {
+          std::vector<Tensor> components;
+          bool end_of_sequence = false;
+          s = iterator->GetNext(ctx, &components, &end_of_sequence);
+          if (!s.ok()) {
+            break;
+          }
+          if (end_of_sequence) {
+            // NOTE: If the sequence ends mid-batch, the elements already
+            // consumed in this invocation are dropped, matching the batching
+            // semantics of `drop_remainder=True`. Callers for whom every
+            // element matters should use `IteratorGetNext` (or size their
+            // epochs as a multiple of N).
+            s = errors::OutOfRange("End of sequence");
+            break;
+          }
+          if (components.size() != num_components) {
+            s = errors::InvalidArgument(
+                "The iterator returned ", components.size(),
+                " components, but this op expects ", num_components,
+                " per element.");
+            break;
+          }
+          for (int64 j = 0; j < num_components; ++j) {
+            // TODO(mrry): Check that the shapes match the shape attrs.
+            ctx->set_output(i * num_components + j, components[j]);
+          }
+        }
+        // NOTE(mrry): We must unref the iterator before calling `done()`, to
+        // avoid destruction races.
+        iterator->Unref();
+
+        if (!s.ok()) {
+          ctx->SetStatus(s);
+        }
+        done();
+      },
+      std::move(done)));
+}
+
 void IteratorGetNextSyncOp::Compute(OpKernelContext* ctx) {
   IteratorResource* iterator;
   OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &iterator));
@@ -1148,6 +1199,10 @@ REGISTER_KERNEL_BUILDER(
 REGISTER_KERNEL_BUILDER(
     Name("IteratorGetNextSync").Device(DEVICE_GPU).Priority(1),
     IteratorGetNextSyncOp);
+REGISTER_KERNEL_BUILDER(Name("IteratorGetNextN").Device(DEVICE_CPU).Priority(2),
+                        IteratorGetNextNOp);
+REGISTER_KERNEL_BUILDER(Name("IteratorGetNextN").Device(DEVICE_GPU).Priority(1),
+                        IteratorGetNextNOp);
 REGISTER_KERNEL_BUILDER(
     Name("IteratorGetNextAsOptional").Device(DEVICE_CPU).Priority(2),
     IteratorGetNextAsOptionalOp);
@@ -183,6 +183,29 @@ class IteratorGetNextOp : public AsyncOpKernel {
   BackgroundWorker background_worker_;
 };
 
+class IteratorGetNextNOp : public AsyncOpKernel {
+ public:
+  explicit IteratorGetNextNOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_iterator_get_next_n") {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_elements_));
+    DataTypeVector output_types;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types));
+    OP_REQUIRES(
+        ctx, output_types.size() % num_elements_ == 0,
+        errors::InvalidArgument(
+            "The length of `output_types` (", output_types.size(),
+            ") must be a multiple of `N` (", num_elements_,
+            "): the output list holds the flattened components of N elements."));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override;
+
+ private:
+  BackgroundWorker background_worker_;
+  int64 num_elements_;
+};
+
 class DeleteIteratorOp : public OpKernel {
  public:
   explicit DeleteIteratorOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
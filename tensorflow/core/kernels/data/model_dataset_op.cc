@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
@@ -32,6 +33,26 @@ constexpr int64 kOptimizationPeriodThresholdMs = 60 * EnvTime::kSecondsToMillis;
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+// Accelerator busy fraction below which the input pipeline is considered the
+// bottleneck and the autotuner is granted extra CPU budget.
+constexpr double kAcceleratorBusyTarget = 0.95;
+
+// Returns whether the CPU budget may be scaled up when registered accelerators
+// (see `model::AcceleratorBusyTimeRegistry`) are underutilized. Opt-out;
+// pipelines without an accelerator device are unaffected either way.
+bool AcceleratorAwareAutotuningEnabled() {
+  static const bool enabled = [] {
+    bool value = true;
+    Status s = ReadBoolFromEnvVar("TF_DATA_ACCELERATOR_AWARE_AUTOTUNE",
+                                  /*default_val=*/true, &value);
+    if (!s.ok()) {
+      LOG(WARNING) << s.error_message();
+    }
+    return value;
+  }();
+  return enabled;
+}
+
 class ModelDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit ModelDatasetOp(OpKernelConstruction* ctx)
@@ -181,6 +202,10 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
         int64 optimization_period_ms = 10;
         int64 current_time_ms =
             ctx->env()->NowMicros() / EnvTime::kMillisToMicros;
+        // Accelerator busy-time snapshot from the previous optimization round,
+        // used to derive per-device busy fractions for the current round.
+        std::vector<uint64> last_busy_micros;
+        uint64 last_snapshot_micros = 0;
         while (true) {
           {
             mutex_lock l(mu_);
@@ -196,7 +221,41 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
             }
             if (cancelled_) return;
           }
-          model_->Optimize(dataset()->algorithm_, dataset()->cpu_budget_,
+          int64 cpu_budget = dataset()->cpu_budget_;
+          if (AcceleratorAwareAutotuningEnabled()) {
+            std::vector<uint64> busy_micros =
+                model::AcceleratorBusyTimeRegistry::Global()->BusyMicros();
+            uint64 snapshot_micros = ctx->env()->NowMicros();
+            if (!busy_micros.empty() &&
+                busy_micros.size() == last_busy_micros.size() &&
+                snapshot_micros > last_snapshot_micros &&
+                last_snapshot_micros != 0) {
+              // The least busy device dictates how starved the accelerators
+              // are; when it is below the target, the input pipeline is the
+              // bottleneck and extra host threads (up to 2x the nominal
+              // budget) are worth spending to feed it.
+              double wall_micros =
+                  static_cast<double>(snapshot_micros - last_snapshot_micros);
+              double min_busy_fraction = 1.0;
+              for (size_t i = 0; i < busy_micros.size(); ++i) {
+                double busy_fraction =
+                    static_cast<double>(busy_micros[i] - last_busy_micros[i]) /
+                    wall_micros;
+                min_busy_fraction = std::min(min_busy_fraction, busy_fraction);
+              }
+              min_busy_fraction = std::max(0.0, min_busy_fraction);
+              if (min_busy_fraction < kAcceleratorBusyTarget) {
+                cpu_budget += static_cast<int64>(
+                    cpu_budget * (kAcceleratorBusyTarget - min_busy_fraction) /
+                    kAcceleratorBusyTarget);
+                VLOG(2) << "Accelerator busy fraction " << min_busy_fraction
+                        << "; raising tf.data CPU budget to " << cpu_budget;
+              }
+            }
+            last_busy_micros = std::move(busy_micros);
+            last_snapshot_micros = snapshot_micros;
+          }
+          model_->Optimize(dataset()->algorithm_, cpu_budget,
                            dataset()->ram_budget_);
           // Exponentially increase the period of running the optimization
           // until a threshold is reached.
@@ -282,17 +282,21 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
                                   output_dtypes()[component_index],
                                   batch_component_shape);
         Tensor& batch_component = out_tensors->back();
-        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
-            &batch_component, dataset()->padding_values_[component_index]));
 
-        // Build the output tuple component by copying one slice
-        // from each input element in the batch.
+        // Build the output tuple component by copying one slice from each
+        // input element in the batch. Every slice is written by exactly one
+        // element, and the padding gap is filled as part of the same pass,
+        // so the output does not need to be pre-filled with the padding
+        // value.
         TensorShape component_shape({});
         for (int i = 1; i < batch_component_shape.dims(); ++i) {
           component_shape.AddDim(batch_component_shape.dim_size(i));
         }
+        const Tensor& padding_value =
+            dataset()->padding_values_[component_index];
         auto copy_element_fn = [component_index, &batch_elements,
-                                &batch_component, &component_shape](int index) {
+                                &batch_component, &component_shape,
+                                &padding_value](int index) {
           // Take the fast path if possible.
           if (batch_elements[index][component_index].shape() ==
               component_shape) {
@@ -300,9 +304,9 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
                 batch_elements[index][component_index], &batch_component,
                 index));
           } else {
-            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToPaddedSlice(
                 batch_elements[index][component_index], &batch_component,
-                index));
+                index, padding_value));
           }
           return Status::OK();
         };
@@ -21,12 +21,17 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -68,6 +73,234 @@ constexpr char kFixedSeedDatasetPrefix[] = "FixedSeed";
 constexpr char kReshufflingDatasetPrefix[] = "Reshuffling";
 constexpr char kShuffleDataset[] = "ShuffleDataset";
 
+constexpr char kSpillDirEnvVar[] = "TF_DATA_SHUFFLE_SPILL_DIR";
+constexpr char kSpillRamElementsEnvVar[] = "TF_DATA_SHUFFLE_SPILL_RAM_ELEMENTS";
+constexpr int64 kDefaultSpillRamElements = 1024;
+// Do not bother compacting spill files smaller than this.
+constexpr uint64 kSpillCompactionMinBytes = 64 << 20;
+
+// Backing store for the shuffle buffer with an optional on-disk spill tier.
+//
+// By default every buffered element lives on the host heap, exactly as
+// before. When TF_DATA_SHUFFLE_SPILL_DIR is set, only
+// TF_DATA_SHUFFLE_SPILL_RAM_ELEMENTS elements are kept live; the rest are
+// serialized into a spill file in that directory and read back when sampled.
+// The OS page cache -- rather than the process heap -- then decides how much
+// of the buffer stays resident, which keeps near-global shuffle buffers from
+// OOM-killing the host.
+//
+// Sampling consumes elements at random file positions, leaving dead bytes in
+// the append-only spill file, so the file is rewritten with only the live
+// elements once more than half of it is dead.
+class ShuffleSpillBuffer {
+ public:
+  ShuffleSpillBuffer(Env* env, int64 capacity, const string& spill_dir,
+                     int64 ram_budget)
+      : env_(env),
+        spill_dir_(spill_dir),
+        ram_budget_(ram_budget),
+        slots_(capacity) {}
+
+  ~ShuffleSpillBuffer() {
+    if (writer_) {
+      writer_->Close().IgnoreError();
+      env_->DeleteFile(filename_).IgnoreError();
+    }
+  }
+
+  bool spill_enabled() const { return !spill_dir_.empty(); }
+
+  // Stores `element` in `slot`, spilling it to disk when the in-RAM working
+  // set is full. The slot must be empty.
+  Status Put(size_t slot, std::vector<Tensor> element) {
+    if (!spill_enabled() || ram_elements_ < ram_budget_) {
+      slots_[slot].tensors = std::move(element);
+      ++ram_elements_;
+      return Status::OK();
+    }
+    string encoded;
+    EncodeElement(element, &encoded);
+    TF_RETURN_IF_ERROR(AppendToFile(encoded, &slots_[slot].offset));
+    slots_[slot].length = encoded.size();
+    slots_[slot].spilled = true;
+    return Status::OK();
+  }
+
+  // Moves the element in `slot` into `element`, leaving the slot empty.
+  Status Take(size_t slot, std::vector<Tensor>* element) {
+    if (!slots_[slot].spilled) {
+      *element = std::move(slots_[slot].tensors);
+      slots_[slot].tensors.clear();
+      --ram_elements_;
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(
+        ReadElement(slots_[slot].offset, slots_[slot].length, element));
+    dead_bytes_ += slots_[slot].length;
+    slots_[slot].spilled = false;
+    slots_[slot].length = 0;
+    return MaybeCompact();
+  }
+
+  // Copies the element in `slot` into `element` without consuming it. Used
+  // for checkpointing.
+  Status Peek(size_t slot, std::vector<Tensor>* element) {
+    if (!slots_[slot].spilled) {
+      *element = slots_[slot].tensors;
+      return Status::OK();
+    }
+    return ReadElement(slots_[slot].offset, slots_[slot].length, element);
+  }
+
+  void Swap(size_t a, size_t b) { std::swap(slots_[a], slots_[b]); }
+
+ private:
+  struct Slot {
+    std::vector<Tensor> tensors;
+    uint64 offset = 0;
+    uint64 length = 0;
+    bool spilled = false;
+  };
+
+  // Length-prefixed TensorProtos: fixed64 tensor count, then per tensor a
+  // fixed64 size followed by the serialized proto.
+  static void EncodeElement(const std::vector<Tensor>& element,
+                            string* encoded) {
+    core::PutFixed64(encoded, element.size());
+    for (const Tensor& t : element) {
+      TensorProto proto;
+      t.AsProtoTensorContent(&proto);
+      core::PutFixed64(encoded, proto.ByteSizeLong());
+      proto.AppendToString(encoded);
+    }
+  }
+
+  static Status DecodeElement(StringPiece encoded,
+                              std::vector<Tensor>* element) {
+    if (encoded.size() < sizeof(uint64)) {
+      return errors::DataLoss("Truncated shuffle spill record.");
+    }
+    uint64 num_tensors = core::DecodeFixed64(encoded.data());
+    encoded.remove_prefix(sizeof(uint64));
+    element->clear();
+    element->reserve(num_tensors);
+    for (uint64 i = 0; i < num_tensors; ++i) {
+      if (encoded.size() < sizeof(uint64)) {
+        return errors::DataLoss("Truncated shuffle spill record.");
+      }
+      uint64 proto_size = core::DecodeFixed64(encoded.data());
+      encoded.remove_prefix(sizeof(uint64));
+      if (encoded.size() < proto_size) {
+        return errors::DataLoss("Truncated shuffle spill record.");
+      }
+      TensorProto proto;
+      if (!proto.ParseFromArray(encoded.data(), proto_size)) {
+        return errors::DataLoss("Corrupt shuffle spill record.");
+      }
+      encoded.remove_prefix(proto_size);
+      Tensor t;
+      if (!t.FromProto(proto)) {
+        return errors::DataLoss("Unable to parse tensor from spilled proto.");
+      }
+      element->push_back(std::move(t));
+    }
+    return Status::OK();
+  }
+
+  string NewSpillFilename() {
+    return strings::StrCat(spill_dir_, "/.shuffle_spill_",
+                           strings::Hex(random::New64()), ".tmp");
+  }
+
+  Status AppendToFile(const string& encoded, uint64* offset) {
+    if (!writer_) {
+      TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(spill_dir_));
+      filename_ = NewSpillFilename();
+      TF_RETURN_IF_ERROR(env_->NewWritableFile(filename_, &writer_));
+    }
+    *offset = file_bytes_;
+    TF_RETURN_IF_ERROR(writer_->Append(encoded));
+    file_bytes_ += encoded.size();
+    needs_flush_ = true;
+    return Status::OK();
+  }
+
+  // Makes everything appended so far visible to the read handle.
+  Status FlushForRead() {
+    if (needs_flush_) {
+      TF_RETURN_IF_ERROR(writer_->Flush());
+      needs_flush_ = false;
+    }
+    if (!reader_) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &reader_));
+    }
+    return Status::OK();
+  }
+
+  Status ReadElement(uint64 offset, uint64 length,
+                     std::vector<Tensor>* element) {
+    TF_RETURN_IF_ERROR(FlushForRead());
+    string buf;
+    buf.resize(length);
+    StringPiece data;
+    TF_RETURN_IF_ERROR(reader_->Read(offset, length, &data, &buf[0]));
+    return DecodeElement(data, element);
+  }
+
+  // Rewrites the spill file with only the live elements once more than half
+  // of it is dead. Live bytes are bounded by the buffer's spilled working
+  // set, so the file size stays proportional to the buffer instead of
+  // growing with everything ever enqueued.
+  Status MaybeCompact() {
+    if (dead_bytes_ <= kSpillCompactionMinBytes ||
+        dead_bytes_ * 2 <= file_bytes_) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(FlushForRead());
+
+    string new_filename = NewSpillFilename();
+    std::unique_ptr<WritableFile> new_writer;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(new_filename, &new_writer));
+
+    uint64 new_bytes = 0;
+    string buf;
+    for (Slot& slot : slots_) {
+      if (!slot.spilled) continue;
+      buf.resize(slot.length);
+      StringPiece data;
+      TF_RETURN_IF_ERROR(
+          reader_->Read(slot.offset, slot.length, &data, &buf[0]));
+      TF_RETURN_IF_ERROR(new_writer->Append(data));
+      slot.offset = new_bytes;
+      new_bytes += slot.length;
+    }
+
+    writer_->Close().IgnoreError();
+    reader_.reset();
+    env_->DeleteFile(filename_).IgnoreError();
+    writer_ = std::move(new_writer);
+    filename_ = std::move(new_filename);
+    file_bytes_ = new_bytes;
+    dead_bytes_ = 0;
+    needs_flush_ = true;
+    return Status::OK();
+  }
+
+  Env* const env_;
+  const string spill_dir_;
+  const int64 ram_budget_;
+
+  std::vector<Slot> slots_;
+  int64 ram_elements_ = 0;
+
+  string filename_;
+  std::unique_ptr<WritableFile> writer_;
+  std::unique_ptr<RandomAccessFile> reader_;
+  bool needs_flush_ = false;
+  uint64 file_bytes_ = 0;
+  uint64 dead_bytes_ = 0;
+};
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -121,8 +354,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           num_elements_(0),
           parent_generator_(seed, seed2),
           generator_(&parent_generator_) {
-      buffer_ = absl::make_unique<std::vector<Tensor>[]>(
-          params.dataset->buffer_size_);
+      TF_CHECK_OK(ReadStringFromEnvVar(kSpillDirEnvVar, "", &spill_dir_));
+      TF_CHECK_OK(ReadInt64FromEnvVar(
+          kSpillRamElementsEnvVar, kDefaultSpillRamElements, &ram_budget_));
+      buffer_ = absl::make_unique<ShuffleSpillBuffer>(
+          Env::Default(), params.dataset->buffer_size_, spill_dir_,
+          ram_budget_);
       slices_.push_back(absl::make_unique<Slice>(0, 0));
     }
 
@@ -175,8 +412,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
                     << this->dataset()->buffer_size_;
           }
           this->RecordBufferEnqueue(ctx, input_element);
-          buffer_[slices_.back()->end % this->dataset()->buffer_size_] =
-              std::move(input_element);
+          TF_RETURN_IF_ERROR(
+              buffer_->Put(slices_.back()->end % this->dataset()->buffer_size_,
+                           std::move(input_element)));
           num_elements_++;
           slices_.back()->end++;
         } else {
@@ -209,11 +447,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             Random() % (slices_.front()->end - slices_.front()->start);
         int64 index =
             (slices_.front()->start + offset) % this->dataset()->buffer_size_;
-        *out_tensors = std::move(buffer_[index]);
+        TF_RETURN_IF_ERROR(buffer_->Take(index, out_tensors));
         this->RecordBufferDequeue(ctx, *out_tensors);
-        std::swap(
-            buffer_[index],
-            buffer_[slices_.front()->start % this->dataset()->buffer_size_]);
+        buffer_->Swap(index,
+                      slices_.front()->start % this->dataset()->buffer_size_);
         slices_.front()->start++;
         num_elements_--;
       } else {
@@ -271,15 +508,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             slices_[i]->end));
         for (size_t j = slices_[i]->start; j < slices_[i]->end; ++j) {
           size_t index = j % this->dataset()->buffer_size_;
+          std::vector<Tensor> element;
+          TF_RETURN_IF_ERROR(buffer_->Peek(index, &element));
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               this->full_name(
                   absl::StrJoin(std::make_tuple(kBuffer, index, kSize), "_")),
-              buffer_[index].size()));
-          for (size_t k = 0; k < buffer_[index].size(); ++k) {
+              element.size()));
+          for (size_t k = 0; k < element.size(); ++k) {
             TF_RETURN_IF_ERROR(writer->WriteTensor(
                 this->full_name(
                     absl::StrJoin(std::make_tuple(kBuffer, index, k), "_")),
-                buffer_[index][k]));
+                element[k]));
           }
         }
       }
@@ -317,8 +556,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             reader->ReadScalar(this->full_name(kSlicesSize), &temp));
         slices_size = static_cast<size_t>(temp);
       }
-      buffer_ = absl::make_unique<std::vector<Tensor>[]>(
-          this->dataset()->buffer_size_);
+      buffer_ = absl::make_unique<ShuffleSpillBuffer>(
+          Env::Default(), this->dataset()->buffer_size_, spill_dir_,
+          ram_budget_);
       for (size_t i = 0; i < slices_size; ++i) {
         int64 start;
         TF_RETURN_IF_ERROR(
@@ -337,13 +577,14 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
               this->full_name(
                   absl::StrJoin(std::make_tuple(kBuffer, index, kSize), "_")),
               &list_size));
-          buffer_[index] = std::vector<Tensor>(list_size);
+          std::vector<Tensor> element(list_size);
           for (int k = 0; k < list_size; ++k) {
             TF_RETURN_IF_ERROR(reader->ReadTensor(
                 this->full_name(
                     absl::StrJoin(std::make_tuple(kBuffer, index, k), "_")),
-                &buffer_[index][k]));
+                &element[k]));
           }
+          TF_RETURN_IF_ERROR(buffer_->Put(index, std::move(element)));
         }
       }
 
@@ -374,7 +615,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return out;
     }
 
-    std::unique_ptr<std::vector<Tensor>[]> buffer_ GUARDED_BY(mu_);
+    string spill_dir_;
+    int64 ram_budget_ = kDefaultSpillRamElements;
+    std::unique_ptr<ShuffleSpillBuffer> buffer_ GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
     int64 epoch_ GUARDED_BY(mu_);
     int64 num_elements_ GUARDED_BY(mu_);
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -39,6 +40,33 @@ namespace data {
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
 
+// When set, uncompressed TFRecord files are memory-mapped and parsed in
+// place instead of being copied through a buffered input stream, halving the
+// memory bandwidth spent on input parsing. Falls back to the stream path for
+// compressed files and for filesystems that cannot map files.
+bool TFRecordMmapEnabled() {
+  static bool result = [] {
+    bool enabled = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_DATA_TFRECORD_MMAP",
+                                   /*default_val=*/false, &enabled));
+    return enabled;
+  }();
+  return result;
+}
+
+// Number of decompressed bytes a background inflate thread keeps ready ahead
+// of the iterator when reading compressed TFRecord files. Zero keeps
+// decompression inline on the iterator's thread.
+int64 TFRecordDecompressionReadahead() {
+  static int64 result = [] {
+    int64 readahead = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_DATA_TFRECORD_DECOMPRESSION_READAHEAD",
+                                    /*default_val=*/0, &readahead));
+    return readahead > 0 ? readahead : 0;
+  }();
+  return result;
+}
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
@@ -51,6 +79,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    if (options_.compression_type != io::RecordReaderOptions::NONE) {
+      options_.decompression_readahead_bytes =
+          TFRecordDecompressionReadahead();
+    }
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -102,6 +134,32 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                            bool* end_of_sequence) override {
       mutex_lock l(mu_);
       do {
+        // We are currently processing a memory-mapped file, so try to read
+        // the next record in place.
+        if (mmap_reader_) {
+          StringPiece record;
+          Status s = mmap_reader_->ReadRecord(&record);
+          if (s.ok()) {
+            // DT_STRING tensors own their bytes, so the record is copied once
+            // here; the mapping itself is never copied through a stream
+            // buffer. The mapping outlives the slice: it is only released
+            // when the iterator moves to the next file or is restored from a
+            // checkpoint, after all reads into output tensors are done.
+            out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                      TensorShape({}));
+            out_tensors->back().scalar<string>()().assign(record.data(),
+                                                          record.size());
+            metrics::RecordTFDataBytesRead(kDatasetType, record.size());
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          ResetStreamsLocked();
+          ++current_file_index_;
+          if (!errors::IsOutOfRange(s)) {
+            return s;
+          }
+        }
+
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
@@ -151,7 +209,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (mmap_reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kOffset),
+                                               mmap_reader_->TellOffset()));
+      } else if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
       }
@@ -170,7 +231,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        if (mmap_reader_) {
+          TF_RETURN_IF_ERROR(mmap_reader_->SeekOffset(offset));
+        } else {
+          TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        }
       }
       return Status::OK();
     }
@@ -186,6 +251,25 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
+
+      // Memory-map uncompressed files if requested, parsing records in place
+      // instead of copying them through a buffered stream. Not all
+      // filesystems can map files, so failure falls through to the stream
+      // path.
+      if (TFRecordMmapEnabled() &&
+          dataset()->options_.compression_type ==
+              io::RecordReaderOptions::NONE) {
+        Status s =
+            env->NewReadOnlyMemoryRegionFromFile(next_filename, &mmap_region_);
+        if (s.ok()) {
+          mmap_reader_ = absl::make_unique<io::MemoryRegionRecordReader>(
+              mmap_region_.get());
+          return Status::OK();
+        }
+        VLOG(1) << "Falling back to stream reads for " << next_filename << ": "
+                << s;
+      }
+
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
@@ -196,6 +280,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mmap_reader_.reset();
+      mmap_region_.reset();
     }
 
     mutex mu_;
@@ -205,6 +291,12 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ GUARDED_BY(mu_);
+
+    // `mmap_reader_` borrows the object that `mmap_region_` points to, so we
+    // must destroy `mmap_reader_` before `mmap_region_`. At most one of
+    // `reader_` and `mmap_reader_` is set for any given file.
+    std::unique_ptr<ReadOnlyMemoryRegion> mmap_region_ GUARDED_BY(mu_);
+    std::unique_ptr<io::MemoryRegionRecordReader> mmap_reader_ GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
@@ -144,6 +144,21 @@ class DecodeImageOp : public OpKernel {
       } else if (dct_method == "INTEGER_ACCURATE") {
         flags_.dct_method = JDCT_ISLOW;
       }
+
+      // DecodeAndCropJpeg has no target size; it already limits decoding
+      // to the crop window.
+      if (type_string() == "DecodeJpeg") {
+        OP_REQUIRES_OK(context, context->GetAttr("target_height",
+                                                 &flags_.target_height));
+        OP_REQUIRES_OK(context,
+                       context->GetAttr("target_width", &flags_.target_width));
+        OP_REQUIRES(context,
+                    flags_.target_height >= 0 && flags_.target_width >= 0,
+                    errors::InvalidArgument(
+                        "target_height and target_width must be non-negative ",
+                        "got ", flags_.target_height, " and ",
+                        flags_.target_width));
+      }
     }
   }
 
@@ -22,9 +22,30 @@ limitations under the License.
 
 namespace tensorflow {
 
+class AddNInitHelper : public InitializationHelper {
+ public:
+  using Attributes = EmptyAttributes;
+
+  AddNInitHelper(OpKernelContext* ctx, std::shared_ptr<const Attributes> attr) {}
+
+  // AddN's output element i depends only on element i of each input, and
+  // every input has the output's shape, so any input whose buffer isn't
+  // referenced elsewhere can be accumulated into in place.
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    absl::InlinedVector<int, 4> candidates;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      if (ctx->input_memory_type(i) == DEVICE_MEMORY && !ctx->input_is_ref(i)) {
+        candidates.push_back(i);
+      }
+    }
+    return candidates;
+  }
+};
+
 class DmlAddNKernel : public DmlKernel {
  public:
-  using InitHelper = NoOpInitializationHelper;
+  using InitHelper = AddNInitHelper;
 
   explicit DmlAddNKernel(DmlKernelConstruction* ctx,
                          const InitHelper* init_helper) {
@@ -27,6 +27,79 @@ class DmlAssignOp : public AssignOp {
  public:
   explicit DmlAssignOp(OpKernelConstruction* context) : AssignOp(context) {}
 
+  // Mirrors AssignOp::Compute, with one difference: the existing buffer is
+  // only overwritten when no snapshot of the variable still aliases it. DML's
+  // Snapshot kernel aliases its input instead of copying, so the writer has to
+  // prove the buffer is private before mutating it; otherwise the variable is
+  // redirected to fresh storage and the aliases keep the old buffer.
+  void Compute(OpKernelContext* context) override {
+    const Tensor& rhs = context->input(1);
+
+    // We always return the input ref.
+    context->forward_ref_input_to_ref_output(0, 0);
+
+    AllocatorAttributes attr;
+    if (!relax_constraints_) {
+      attr.set_gpu_compatible(true);
+      attr.set_nic_compatible(true);
+    }
+
+    // Copy() only enqueues GPU work without waiting for it, so unlike the base
+    // class there is nothing to gain from releasing the lock before copying;
+    // everything happens under the ref mutex regardless of use_locking.
+    mutex_lock l(*context->input_ref_mutex(0));
+    const Tensor& old_lhs = context->mutable_input(0, /* lock_held */ true);
+    const bool same_shape = old_lhs.shape().IsSameSize(rhs.shape());
+    if (validate_shape_) {
+      OP_REQUIRES(context, same_shape,
+                  errors::InvalidArgument(
+                      "Assign requires shapes of both tensors to match. "
+                      "lhs shape= ",
+                      old_lhs.shape().DebugString(),
+                      " rhs shape= ", rhs.shape().DebugString()));
+    }
+
+    // 1. Copy into the existing buffer if it fits and nothing else can
+    //    observe it. `old_lhs` accounts for the one extra reference this
+    //    method holds on the buffer.
+    if (old_lhs.IsInitialized() &&
+        old_lhs.shape().num_elements() == rhs.shape().num_elements() &&
+        dml_util::CanUpdateRefTensorInPlace(context, old_lhs)) {
+      Tensor reshaped_old_lhs;
+      if (same_shape) {
+        reshaped_old_lhs = old_lhs;
+      } else {
+        CHECK(reshaped_old_lhs.CopyFrom(old_lhs, rhs.shape()));
+        context->replace_ref_input(0, reshaped_old_lhs, /* lock_held */ true);
+      }
+      Copy(context, &reshaped_old_lhs, rhs);
+      return;
+    }
+
+    // 2. Try to steal the rhs buffer outright, avoiding both an allocation
+    //    and a copy.
+    std::unique_ptr<Tensor> input_alias = context->forward_input(
+        1, OpKernelContext::Params::kNoReservation /*output_index*/,
+        rhs.dtype(), rhs.shape(), DEVICE_MEMORY, attr);
+    if (input_alias != nullptr) {
+      context->replace_ref_input(0, *input_alias, /* lock_held */ true);
+      return;
+    }
+
+    // 3. Redirect the variable to a new persistent tensor and copy the rhs
+    //    into it.
+    PersistentTensor copy;
+    Tensor* copy_tensor = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_persistent(old_lhs.dtype(), rhs.shape(),
+                                                &copy, &copy_tensor, attr));
+    // We track memory of variables in variable ops instead of in this
+    // assign op.
+    context->clear_recorded_memory();
+    context->replace_ref_input(0, *copy_tensor, /* lock_held */ true);
+    Copy(context, copy_tensor, rhs);
+  }
+
   void Copy(OpKernelContext* context, Tensor* lhs, const Tensor& rhs) override {
     DeviceContext* device_context = context->op_device_context();
     Device* device = static_cast<Device*>(context->device());
@@ -0,0 +1,334 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/kernels/dml_ops_common.h"
+
+namespace tensorflow {
+
+using Microsoft::WRL::ComPtr;
+
+// Internal op produced by DmlAttentionFusionPass. It evaluates
+// softmax(query * key^T * scale + mask) * value as one compiled DML graph,
+// tiled along the query sequence dimension so the sequence x sequence score
+// and probability matrices only ever exist one query block at a time. The
+// unfused chain materializes both matrices in full, which is what puts long
+// sequences out of reach on small adapters: at 2048x2048 per head they
+// dominate activation memory.
+//
+// Tiling along the query dimension keeps the math exact — every score row is
+// complete when its softmax runs, so no online renormalization is needed.
+REGISTER_OP("_DmlScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("mask: num_masks * T")
+    .Output("output: T")
+    .Attr("T: {half, float}")
+    .Attr("num_masks: int >= 0")
+    .Attr("scale: float = 1.0")
+    .Attr("query_block_size: int = 256")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle query = c->input(0);
+      shape_inference::ShapeHandle value = c->input(2);
+      if (!c->RankKnown(query) || !c->RankKnown(value)) {
+        c->set_output(0, c->UnknownShape());
+        return Status::OK();
+      }
+      shape_inference::ShapeHandle out;
+      TF_RETURN_IF_ERROR(
+          c->ReplaceDim(query, -1, c->Dim(value, -1), &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+attention fusion pass is expected to create this operator.
+)doc");
+
+class ScaledDotProductAttentionInitHelper : public InitializationHelper {
+ public:
+  struct Attributes {
+    explicit Attributes(OpKernelConstruction* ctx) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("scale", &scale));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("query_block_size", &query_block_size));
+      OP_REQUIRES(ctx, query_block_size >= 1,
+                  errors::InvalidArgument(
+                      "query_block_size must be positive, but was ",
+                      query_block_size));
+    }
+
+    float scale;
+    int64 query_block_size;
+  };
+
+  ScaledDotProductAttentionInitHelper(OpKernelContext* ctx,
+                                      std::shared_ptr<const Attributes> attr)
+      : attr_(std::move(attr)) {
+    const TensorShape& query_shape = ctx->input(0).shape();
+    const TensorShape& key_shape = ctx->input(1).shape();
+    const TensorShape& value_shape = ctx->input(2).shape();
+
+    OP_REQUIRES(
+        ctx, query_shape.dims() >= 2 && query_shape.dims() <= 4,
+        errors::InvalidArgument("query must have between 2 and 4 dimensions, "
+                                "but has shape ",
+                                query_shape.DebugString()));
+    OP_REQUIRES(ctx,
+                key_shape.dims() == query_shape.dims() &&
+                    value_shape.dims() == query_shape.dims(),
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank, but have "
+                    "shapes ",
+                    query_shape.DebugString(), ", ", key_shape.DebugString(),
+                    " and ", value_shape.DebugString()));
+
+    // The batch (and head) dimensions must match exactly, and the contraction
+    // dimensions must line up: query and key share the head size, key and
+    // value share the key/value sequence length.
+    for (int i = 0; i < query_shape.dims() - 2; ++i) {
+      OP_REQUIRES(ctx,
+                  key_shape.dim_size(i) == query_shape.dim_size(i) &&
+                      value_shape.dim_size(i) == query_shape.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have equal batch dimensions, "
+                      "but have shapes ",
+                      query_shape.DebugString(), ", ", key_shape.DebugString(),
+                      " and ", value_shape.DebugString()));
+    }
+    OP_REQUIRES(
+        ctx,
+        key_shape.dim_size(key_shape.dims() - 1) ==
+            query_shape.dim_size(query_shape.dims() - 1),
+        errors::InvalidArgument("query and key must have the same head size, "
+                                "but have shapes ",
+                                query_shape.DebugString(), " and ",
+                                key_shape.DebugString()));
+    OP_REQUIRES(
+        ctx,
+        value_shape.dim_size(value_shape.dims() - 2) ==
+            key_shape.dim_size(key_shape.dims() - 2),
+        errors::InvalidArgument("key and value must have the same sequence "
+                                "length, but have shapes ",
+                                key_shape.DebugString(), " and ",
+                                value_shape.DebugString()));
+
+    if (ctx->num_inputs() > 3) {
+      const TensorShape& mask_shape = ctx->input(3).shape();
+      OP_REQUIRES(
+          ctx, mask_shape.dims() <= query_shape.dims(),
+          errors::InvalidArgument("mask rank must not exceed query rank, but "
+                                  "mask has shape ",
+                                  mask_shape.DebugString()));
+
+      // Every mask dimension must be 1 (broadcast) or match the score matrix
+      // [batch..., seq_q, seq_kv], aligned from the trailing dimension.
+      const int64 seq_q = query_shape.dim_size(query_shape.dims() - 2);
+      const int64 seq_kv = key_shape.dim_size(key_shape.dims() - 2);
+      for (int i = 0; i < mask_shape.dims(); ++i) {
+        int score_axis = query_shape.dims() - mask_shape.dims() + i;
+        int64 score_dim = score_axis == query_shape.dims() - 1
+                              ? seq_kv
+                              : score_axis == query_shape.dims() - 2
+                                    ? seq_q
+                                    : query_shape.dim_size(score_axis);
+        OP_REQUIRES(ctx,
+                    mask_shape.dim_size(i) == 1 ||
+                        mask_shape.dim_size(i) == score_dim,
+                    errors::InvalidArgument(
+                        "mask with shape ", mask_shape.DebugString(),
+                        " doesn't broadcast against scores of shape [..., ",
+                        seq_q, ", ", seq_kv, "]"));
+      }
+    }
+  }
+
+  float GetScale() const { return attr_->scale; }
+  int64 GetQueryBlockSize() const { return attr_->query_block_size; }
+
+ private:
+  std::shared_ptr<const Attributes> attr_;
+};
+
+class ScaledDotProductAttentionShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    TensorShape output_shape = ctx->input(0).shape();
+    const TensorShape& value_shape = ctx->input(2).shape();
+    output_shape.set_dim(output_shape.dims() - 1,
+                         value_shape.dim_size(value_shape.dims() - 1));
+    return {output_shape};
+  }
+};
+
+class DmlScaledDotProductAttentionKernel : public DmlKernel {
+ public:
+  using InitHelper = ScaledDotProductAttentionInitHelper;
+
+  explicit DmlScaledDotProductAttentionKernel(DmlKernelConstruction* ctx,
+                                              const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 3 || ctx->GetInputCount() == 4);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    const bool has_mask = ctx->GetInputCount() == 4;
+
+    // Collapse the leading dimensions into DML's two batch dimensions so all
+    // inputs are rank 4: [batch, heads, sequence, head size].
+    auto to_4d = [](const TensorShape& shape) {
+      TensorShape padded;
+      for (int i = shape.dims(); i < 4; ++i) {
+        padded.AddDim(1);
+      }
+      for (int i = 0; i < shape.dims(); ++i) {
+        padded.AddDim(shape.dim_size(i));
+      }
+      return padded;
+    };
+
+    TensorShape query_shape = to_4d(ctx->GetInputTensorShape(0));
+    TensorShape key_shape = to_4d(ctx->GetInputTensorShape(1));
+    TensorShape value_shape = to_4d(ctx->GetInputTensorShape(2));
+
+    const uint32_t batch = static_cast<uint32_t>(query_shape.dim_size(0));
+    const uint32_t heads = static_cast<uint32_t>(query_shape.dim_size(1));
+    const uint32_t seq_q = static_cast<uint32_t>(query_shape.dim_size(2));
+    const uint32_t head_size = static_cast<uint32_t>(query_shape.dim_size(3));
+    const uint32_t seq_kv = static_cast<uint32_t>(key_shape.dim_size(2));
+    const uint32_t value_size = static_cast<uint32_t>(value_shape.dim_size(3));
+
+    TensorShape output_shape({batch, heads, seq_q, value_size});
+
+    DmlKernelTensors tensors;
+    for (uint32_t i = 0; i < ctx->GetInputCount(); ++i) {
+      TensorShape shape = to_4d(ctx->GetInputTensorShape(i));
+      DmlTensorInfo input;
+      input.kernel_index = i;
+      input.desc = DmlTensorDesc::Create(ctx->GetInputDataType(i), shape,
+                                         shape);
+      tensors.inputs.push_back(std::move(input));
+    }
+
+    DmlTensorInfo output;
+    output.kernel_index = 0;
+    output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                        output_shape, output_shape);
+    tensors.outputs = {output};
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto query = dml::InputTensor(scope, 0, input_descs[0]);
+    auto key = dml::InputTensor(scope, 1, input_descs[1]);
+    auto value = dml::InputTensor(scope, 2, input_descs[2]);
+
+    TensorShape mask_shape;
+    dml::Expression mask;
+    if (has_mask) {
+      mask_shape = to_4d(ctx->GetInputTensorShape(3));
+      mask = dml::InputTensor(scope, 3, input_descs[3]);
+    }
+
+    // Reinterprets `t` (contiguous, with dimensions `from`) as a broadcast
+    // view with dimensions `to` by zeroing the stride of every size-1 axis.
+    auto broadcast_to = [](dml::Expression t, const TensorShape& from,
+                           dml::TensorDesc::Dimensions to) {
+      dml::TensorDesc::Dimensions strides = {0, 0, 0, 0};
+      uint32_t stride = 1;
+      for (int i = 3; i >= 0; --i) {
+        strides[i] = from.dim_size(i) == 1 ? 0 : stride;
+        stride *= static_cast<uint32_t>(from.dim_size(i));
+      }
+      return dml::Reinterpret(t, std::move(to), strides);
+    };
+
+    const float scale = init_helper->GetScale();
+    const uint32_t block_size = static_cast<uint32_t>(std::min<int64>(
+        init_helper->GetQueryBlockSize(), static_cast<int64>(seq_q)));
+
+    dml::TensorDesc::Dimensions slice_strides = {1, 1, 1, 1};
+
+    std::vector<dml::Expression> blocks;
+    for (uint32_t start = 0; start < seq_q; start += block_size) {
+      const uint32_t count = std::min(block_size, seq_q - start);
+
+      dml::Expression query_block = query;
+      if (count < seq_q) {
+        query_block =
+            dml::Slice(query, {0, 0, start, 0}, {batch, heads, count, head_size},
+                       slice_strides);
+      }
+
+      // scores = query_block * key^T * scale: [batch, heads, count, seq_kv].
+      auto scores =
+          dml::Gemm(query_block, key, absl::nullopt, DML_MATRIX_TRANSFORM_NONE,
+                    DML_MATRIX_TRANSFORM_TRANSPOSE, scale);
+
+      if (has_mask) {
+        dml::Expression mask_block = mask;
+        TensorShape mask_block_shape = mask_shape;
+        if (mask_shape.dim_size(2) != 1 && count < seq_q) {
+          // The mask spans the full query dimension; take this block's rows.
+          mask_block = dml::Slice(
+              mask, {0, 0, start, 0},
+              {static_cast<uint32_t>(mask_shape.dim_size(0)),
+               static_cast<uint32_t>(mask_shape.dim_size(1)), count,
+               static_cast<uint32_t>(mask_shape.dim_size(3))},
+              slice_strides);
+          mask_block_shape.set_dim(2, count);
+        }
+        scores += broadcast_to(mask_block, mask_block_shape,
+                               {batch, heads, count, seq_kv});
+      }
+
+      // DML's softmax activation requires rank <= 2, so collapse the batch,
+      // head and query dimensions for the softmax and expand back afterwards.
+      dml::TensorDesc::Dimensions scores_2d = {1, 1, batch * heads * count,
+                                               seq_kv};
+      auto probs = dml::Reinterpret(
+          dml::ActivationSoftmax(
+              dml::Reinterpret(scores, scores_2d, dml::NullOpt)),
+          {batch, heads, count, seq_kv}, dml::NullOpt);
+
+      blocks.push_back(dml::Gemm(probs, value));
+    }
+
+    auto result = blocks.size() == 1 ? blocks.front() : dml::Join(blocks, 2);
+
+    ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                               \
+  REGISTER_KERNEL_BUILDER(                                      \
+      Name("_DmlScaledDotProductAttention")                     \
+          .Device(DEVICE_DML)                                   \
+          .TypeConstraint<type>("T"),                           \
+      DmlKernelWrapper<DmlScaledDotProductAttentionKernel,      \
+                       ScaledDotProductAttentionShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
+}  // namespace tensorflow
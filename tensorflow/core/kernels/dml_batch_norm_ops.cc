@@ -537,6 +537,144 @@ TF_CALL_float(DML_REGISTER_KERNEL);
 TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNELS);
 #undef DML_REGISTER_KERNELS
 
+class LayerNormInitHelper : public InitializationHelper {
+ public:
+  struct Attributes {
+    explicit Attributes(OpKernelConstruction* ctx) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("epsilon", &epsilon));
+    }
+    float epsilon;
+  };
+
+  LayerNormInitHelper(OpKernelContext* ctx,
+                      std::shared_ptr<const Attributes> attr)
+      : attr_(std::move(attr)) {
+    const Tensor& x = ctx->input(0);
+    const Tensor& scale = ctx->input(1);
+    const Tensor& offset = ctx->input(2);
+
+    OP_REQUIRES(ctx, x.dims() >= 1,
+                errors::InvalidArgument("input must be at least 1-dimensional",
+                                        x.shape().DebugString()));
+
+    int64 inner_dim_size = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(ctx, scale.NumElements() == inner_dim_size,
+                errors::InvalidArgument(
+                    "scale must have the same number of elements as the last "
+                    "dimension of the input: ",
+                    scale.shape().DebugString()));
+    OP_REQUIRES(ctx, offset.NumElements() == inner_dim_size,
+                errors::InvalidArgument(
+                    "offset must have the same number of elements as the last "
+                    "dimension of the input: ",
+                    offset.shape().DebugString()));
+  }
+
+  float GetEpsilon() const { return attr_->epsilon; }
+
+ private:
+  const std::shared_ptr<const Attributes> attr_;
+};
+
+// Implements the _DmlFusedLayerNorm op produced by the grappler remapper. The
+// entire normalization (moments, rescale, and shift) compiles into a single
+// DML operator, where the decomposed graph takes eight dispatches with
+// intermediate tensors round-tripping through memory in between.
+class DmlFusedLayerNormKernel : public DmlKernel {
+ public:
+  using InitHelper = LayerNormInitHelper;
+
+  explicit DmlFusedLayerNormKernel(DmlKernelConstruction* ctx,
+                                   const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 3);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    float epsilon = init_helper->GetEpsilon();
+
+    const TensorShape& input_shape = ctx->GetInputTensorShape(0);
+    uint32_t inner_size =
+        static_cast<uint32_t>(input_shape.dim_size(input_shape.dims() - 1));
+    uint32_t outer_size =
+        static_cast<uint32_t>(input_shape.num_elements() / inner_size);
+
+    // Collapse the input into {1, 1, outer, inner} so that normalizing over
+    // the last dimension is a reduction across a single axis.
+    TensorShape flattened_shape({1, 1, outer_size, inner_size});
+    TensorShape param_shape({1, 1, 1, inner_size});
+
+    DmlTensorInfo x_info;
+    x_info.kernel_index = 0;
+    x_info.desc = DmlTensorDesc::Create(ctx->GetInputDataType(0),
+                                        flattened_shape, flattened_shape);
+
+    DmlTensorInfo scale_info;
+    scale_info.kernel_index = 1;
+    scale_info.desc =
+        DmlTensorDesc::Create(ctx->GetInputDataType(1), param_shape,
+                              param_shape);
+
+    DmlTensorInfo offset_info;
+    offset_info.kernel_index = 2;
+    offset_info.desc =
+        DmlTensorDesc::Create(ctx->GetInputDataType(2), param_shape,
+                              param_shape);
+
+    DmlTensorInfo output_info;
+    output_info.kernel_index = 0;
+    output_info.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                             flattened_shape, flattened_shape);
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {x_info, scale_info, offset_info};
+    tensors.outputs = {output_info};
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto x = dml::InputTensor(scope, 0, input_descs[0]);
+    auto scale = dml::InputTensor(scope, 1, input_descs[1]);
+    auto offset = dml::InputTensor(scope, 2, input_descs[2]);
+
+    auto input_sizes = x.GetOutputDesc().sizes;
+
+    // The strides we need to set to broadcast the per-row moments across the
+    // inner dimension
+    dml::TensorDesc::Dimensions moment_strides = {0, 0, 1, 0};
+
+    // The strides we need to set to broadcast scale/offset across the outer
+    // dimension
+    dml::TensorDesc::Dimensions param_strides = {0, 0, 0, 1};
+
+    auto mean = dml::Reduce(x, DML_REDUCE_FUNCTION_AVERAGE, {3});
+    auto x_centered = x - dml::Reinterpret(mean, input_sizes, moment_strides);
+
+    // Layer norm uses the population variance, so no Bessel's correction
+    auto variance =
+        dml::Reduce(x_centered, DML_REDUCE_FUNCTION_SUM_SQUARE, {3});
+    variance /= inner_size;
+
+    // y = (x - mean) * rsqrt(variance + epsilon) * scale + offset
+    auto inv_stddev = 1.0f / dml::Sqrt(variance + epsilon);
+    auto normalized =
+        x_centered * dml::Reinterpret(inv_stddev, input_sizes, moment_strides);
+    auto result =
+        normalized * dml::Reinterpret(scale, input_sizes, param_strides) +
+        dml::Reinterpret(offset, input_sizes, param_strides);
+
+    auto compiled_op = scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                    \
+  REGISTER_KERNEL_BUILDER(Name("_DmlFusedLayerNorm")                 \
+                              .Device(DEVICE_DML)                    \
+                              .TypeConstraint<type>("T"),            \
+                          DmlKernelWrapper<DmlFusedLayerNormKernel,  \
+                                           GetOutputShapeAsInputShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
 class DmlBatchNormWithGlobalNormalizationKernel : public DmlKernel {
   enum InputIndex {
     kT,
@@ -82,6 +82,18 @@ class BiasAddInitHelper : public InitializationHelper {
   const TensorShape& GetBiasShape() const { return bias_shape_; }
   TensorFormat GetDataFormat() const { return attr_->data_format; }
 
+  // BiasAdd writes each output element as the sum of the corresponding value
+  // element and a broadcast bias element, so the value tensor's buffer may
+  // back the output in place. The bias broadcasts and is never a candidate.
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    if (ctx->input_memory_type(0) == DEVICE_MEMORY && !ctx->input_is_ref(0) &&
+        ctx->input_dtype(0) == ctx->expected_output_dtype(output_index)) {
+      return {0};
+    }
+    return {};
+  }
+
  private:
   TensorShape bias_shape_;
   const std::shared_ptr<const Attributes> attr_;
@@ -44,7 +44,29 @@ class DmlCastKernel : public DmlKernel {
 
     // Tensor shape doesn't matter for Cast, so don't bother with DML's 4D
     // restrictions
-    TensorShape tensor_shape({ctx->GetOutputTensorShape(0).num_elements()});
+    const uint64_t total_element_count =
+        static_cast<uint64_t>(ctx->GetOutputTensorShape(0).num_elements());
+
+    // When the flattened shape holds more elements than one DML dispatch can
+    // address, build the operator over a uniform chunk and execute it in
+    // chunks (see DmlKernel::SetChunkedExecution). The chunk size is rounded
+    // up to a multiple of 16 elements so chunk byte offsets stay DML-aligned
+    // for every element size.
+    uint32_t chunk_count = 1;
+    uint64_t chunk_element_count = total_element_count;
+    if (total_element_count > kMaxDmlElementsPerDispatch) {
+      chunk_count = static_cast<uint32_t>(
+          (total_element_count + kMaxDmlElementsPerDispatch - 1) /
+          kMaxDmlElementsPerDispatch);
+      chunk_element_count =
+          ((total_element_count + chunk_count - 1) / chunk_count + 15) / 16 *
+          16;
+      chunk_count = static_cast<uint32_t>(
+          (total_element_count + chunk_element_count - 1) /
+          chunk_element_count);
+    }
+
+    TensorShape tensor_shape({static_cast<int64>(chunk_element_count)});
 
     DmlTensorInfo input;
     input.kernel_index = 0;
@@ -82,6 +104,11 @@ class DmlCastKernel : public DmlKernel {
         scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
 
     Initialize(ctx, std::move(tensors), compiled_op.Get());
+
+    if (chunk_count > 1) {
+      SetChunkedExecution(chunk_count, chunk_element_count,
+                          total_element_count);
+    }
   }
 
   StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const {
@@ -19,8 +19,60 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/dml_kernel_wrapper.h"
 #include "tensorflow/core/kernels/dml_ops_common.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+// When TF_DIRECTML_ASYNC_CHECK_NUMERICS is set, verdicts are deferred: the
+// GPU reduction still runs every time, but the flag byte is read back
+// asynchronously and a failure raises from the next CheckNumerics that runs
+// instead of stalling this one on a GPU sync. This makes always-on numerical
+// monitoring nearly free, at the cost of stopping one check late.
+bool AsyncCheckNumericsEnabled() {
+  static const bool enabled = [] {
+    bool value = false;
+    Status s =
+        ReadBoolFromEnvVar("TF_DIRECTML_ASYNC_CHECK_NUMERICS", false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+// Failures observed by async readbacks, raised by the next CheckNumerics that
+// runs. Process-wide on purpose: a deferred verdict should stop the step
+// regardless of which tensor's check happens to run next.
+struct DeferredNumericsError {
+  mutex mu;
+  Status status GUARDED_BY(mu);
+};
+
+DeferredNumericsError* GetDeferredNumericsError() {
+  static auto* deferred = new DeferredNumericsError;
+  return deferred;
+}
+
+// The NaN bit is 2^1 and the Inf bit is 2^0.
+Status NanInfError(const std::string& message, uint8_t nan_inf_bits) {
+  bool is_nan = nan_inf_bits & 2;
+  bool is_inf = nan_inf_bits & 1;
+  std::string status;
+
+  if (is_nan && is_inf) {
+    status = "Inf and NaN";
+  } else if (is_nan) {
+    status = "NaN";
+  } else {
+    status = "Inf";
+  }
+
+  return errors::InvalidArgument(message, " : Tensor had ", status, " values");
+}
+
+}  // namespace
 
 class CheckNumericsInitHelper : public InitializationHelper {
  public:
@@ -99,6 +151,67 @@ class DmlCheckNumericsKernel : public DmlKernel {
     DmlKernel::Compute(ctx);
 
     OpKernelContext* op_ctx = ctx->GetOpKernelContext();
+    auto device = static_cast<DmlDevice*>(op_ctx->device());
+    Tensor* output_tensor = ctx->GetOutputTensor(0);
+
+    if (AsyncCheckNumericsEnabled()) {
+      // Raise any verdict deferred by an earlier check before queueing a new
+      // one. The stored status already names the offending tensor.
+      auto* deferred = GetDeferredNumericsError();
+      {
+        mutex_lock lock(deferred->mu);
+        if (!deferred->status.ok()) {
+          Status failed = deferred->status;
+          deferred->status = Status::OK();
+          return failed;
+        }
+      }
+
+      // Read the Inf and NaN bits back without blocking; the callback runs on
+      // the event queue thread once the GPU work completes.
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      auto is_error_tensor = std::make_shared<Tensor>();
+      TF_RETURN_IF_ERROR(op_ctx->allocate_temp(op_ctx->input(0).dtype(),
+                                               TensorShape({}),
+                                               is_error_tensor.get(), attr));
+
+      std::string message = message_;
+      op_ctx->op_device_context()->CopyDeviceTensorToCPU(
+          output_tensor, "", device, is_error_tensor.get(),
+          [is_error_tensor, message](const Status& copy_status) {
+            Status status = copy_status;
+            if (status.ok()) {
+              uint8_t nan_inf_bits = is_error_tensor->scalar<uint8_t>()();
+              if (nan_inf_bits) {
+                status = NanInfError(message, nan_inf_bits);
+              }
+            }
+
+            if (!status.ok()) {
+              auto* deferred = GetDeferredNumericsError();
+              mutex_lock lock(deferred->mu);
+              if (deferred->status.ok()) {
+                deferred->status = status;
+              }
+            }
+          });
+
+      // Overwrite the flag byte with the pass-through copy of the input. The
+      // readback above was recorded against the queue first, so it still sees
+      // the flags.
+      D3D12BufferRegion input_buffer =
+          dml_util::CreateBufferForTensor(device, ctx->GetInputTensor(0));
+
+      D3D12BufferRegion output_buffer =
+          dml_util::CreateBufferForTensor(device, *output_tensor);
+
+      ctx->CopyBufferToBuffer(output_buffer.Resource(), output_buffer.Offset(),
+                              input_buffer.Resource(), input_buffer.Offset(),
+                              output_tensor->TotalBytes());
+
+      return ctx->GetCurrentCompletionEvent();
+    }
 
     // Copy the result to the CPU
     AllocatorAttributes attr;
@@ -107,9 +220,6 @@ class DmlCheckNumericsKernel : public DmlKernel {
     TF_RETURN_IF_ERROR(op_ctx->allocate_temp(
         op_ctx->input(0).dtype(), TensorShape({}), &is_error_tensor, attr));
 
-    auto device = static_cast<DmlDevice*>(op_ctx->device());
-    Tensor* output_tensor = ctx->GetOutputTensor(0);
-
     // Copy the Inf and NaN bits from the GPU to the CPU
     Notification note;
     Status status;
@@ -125,22 +235,8 @@ class DmlCheckNumericsKernel : public DmlKernel {
 
     uint8_t nan_inf_bits = is_error_tensor.scalar<uint8_t>()();
 
-    // The NaN bit is 2^1 and the Inf bit is 2^0
     if (nan_inf_bits) {
-      bool is_nan = nan_inf_bits & 2;
-      bool is_inf = nan_inf_bits & 1;
-      std::string status;
-
-      if (is_nan && is_inf) {
-        status = "Inf and NaN";
-      } else if (is_nan) {
-        status = "NaN";
-      } else if (is_inf) {
-        status = "Inf";
-      }
-
-      return errors::InvalidArgument(message_, " : Tensor had ", status,
-                                     " values");
+      return NanInfError(message_, nan_inf_bits);
     } else {
       // If everything is fine, we simply copy the input to the output
       D3D12BufferRegion input_buffer =
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -113,6 +114,97 @@ class ConcatInitHelper : public InitializationHelper {
     return true;
   }
 
+  // Two kinds of concatenation don't require any data movement at all. If
+  // only one value input is non-empty, the output is just that input
+  // reshaped. And if the value inputs are consecutive views over a single
+  // allocation (e.g. the zero-copy Slice/StridedSlice paths carve them out of
+  // one parent buffer), concatenating them back in their original order
+  // reproduces the parent buffer, so the output can alias it directly.
+  absl::optional<Tensor> GetContiguousInputView(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const override {
+    int concat_dim_tensor_index =
+        AxisArgName == NAME_IS_CONCAT_DIM ? 0 : ctx->num_inputs() - 1;
+
+    absl::InlinedVector<int, 8> nonempty_inputs;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      if (i == concat_dim_tensor_index) {
+        continue;
+      }
+
+      if (ctx->input_memory_type(i) != DEVICE_MEMORY || ctx->input_is_ref(i)) {
+        return absl::nullopt;
+      }
+
+      if (ctx->input(i).NumElements() != 0) {
+        nonempty_inputs.push_back(i);
+      }
+    }
+
+    // All-empty concats are no-op'd before this is called
+    if (nonempty_inputs.empty()) {
+      return absl::nullopt;
+    }
+
+    // A single non-empty input aliases its whole buffer at offset zero, so no
+    // alignment or desc padding concerns arise.
+    if (nonempty_inputs.size() == 1) {
+      Tensor view;
+      if (view.CopyFrom(ctx->input(nonempty_inputs[0]),
+                        output_shapes[output_index])) {
+        return view;
+      }
+      return absl::nullopt;
+    }
+
+    const Tensor& first_input = ctx->input(nonempty_inputs[0]);
+
+    // 64-bit integer kernels pad their tensor descs past the logical end of
+    // the data, which a tightly-sized view can't satisfy.
+    if (Is64BitIntegerType(first_input.dtype())) {
+      return absl::nullopt;
+    }
+
+    // Buffer juxtaposition only matches the concatenation when every
+    // dimension before the concat axis has size 1; otherwise the inputs'
+    // elements interleave in the output.
+    for (int i = 0; i < concat_axis_; ++i) {
+      if (first_input_shape_.dim_size(i) != 1) {
+        return absl::nullopt;
+      }
+    }
+
+    // The inputs must all be views over the same allocation, starting at its
+    // beginning and laid out back-to-back in concatenation order.
+    Tensor first_copy = first_input;
+    TensorBuffer* root_buffer = DMAHelper::buffer(&first_copy)->root_buffer();
+    if (!root_buffer || root_buffer->data() != first_input.tensor_data().data()) {
+      return absl::nullopt;
+    }
+
+    const char* expected_data = static_cast<const char*>(root_buffer->data());
+    for (int i : nonempty_inputs) {
+      Tensor input = ctx->input(i);
+      TensorBuffer* buffer = DMAHelper::buffer(&input);
+      if (!buffer || buffer->root_buffer() != root_buffer ||
+          input.tensor_data().data() != expected_data) {
+        return absl::nullopt;
+      }
+      expected_data += input.TotalBytes();
+    }
+
+    // DML buffer regions require the view's size in bytes to be 4-byte
+    // aligned.
+    const int64 total_bytes = output_shapes[output_index].num_elements() *
+                              DataTypeSize(first_input.dtype());
+    if (total_bytes % 4 != 0) {
+      return absl::nullopt;
+    }
+
+    return Tensor(first_input.dtype(), output_shapes[output_index],
+                  root_buffer);
+  }
+
   int64 GetConcatAxis() const { return concat_axis_; }
   int64 GetOutputConcatDimSize() const { return output_concat_dim_size_; }
   const TensorShape& GetFirstInputShape() const { return first_input_shape_; }
@@ -0,0 +1,196 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_device.h"
+#include "tensorflow/core/common_runtime/dml/dml_lazy_constant_registry.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Same trick as ConstantOp in constant_op.cc: the kernel keeps the parsed
+// tensor, so the (potentially large) value attr doesn't need to stay resident
+// in the kernel's NodeDef too.
+std::unique_ptr<const NodeDef> StripTensorDataFromNodeDef(
+    OpKernelConstruction* ctx) {
+  const NodeDef& original = ctx->def();
+  NodeDef* ret = new NodeDef;
+  ret->set_name(original.name());
+  ret->set_op(original.op());
+  ret->set_device(original.device());
+  AddNodeAttr("dtype", ctx->output_type(0), ret);
+  MergeDebugInfo(original, ret);
+  return std::unique_ptr<const NodeDef>(ret);
+}
+
+bool LazyConstantsEnabled() {
+  static bool enabled = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_DIRECTML_LAZY_CONSTANTS",
+                                  /*default_val=*/true, &value);
+    return s.ok() ? value : true;
+  }();
+  return enabled;
+}
+
+}  // namespace
+
+// Const on DML devices. Unlike the stock ConstantOp, which uploads its value
+// to the device when the kernel is constructed, this kernel keeps the parsed
+// value in pageable host memory and defers the device allocation and upload
+// until the constant's first use. Kernels whose graphs are instantiated but
+// never run — standby models held by an A/B harness, the untaken arms of
+// conditionals — then cost host memory that the OS can page instead of
+// device memory that it can't. TFDML_PrefetchConstants (or
+// TF_DIRECTML_LAZY_CONSTANTS=0) restores eager upload for models that are
+// about to take traffic and shouldn't pay the uploads on their first Run.
+class DmlConstantOp : public OpKernel {
+ public:
+  explicit DmlConstantOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx, StripTensorDataFromNodeDef(ctx)) {
+    const TensorProto* proto = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("value", &proto));
+    OP_REQUIRES(
+        ctx, ctx->output_type(0) == proto->dtype(),
+        errors::InvalidArgument("Type mismatch between value (",
+                                DataTypeString(proto->dtype()), ") and dtype (",
+                                DataTypeString(ctx->output_type(0)), ")"));
+
+    // Variants hold host-side objects that need MakeTensorFromProto's
+    // per-element copier, so they always take the eager path.
+    const bool lazy =
+        LazyConstantsEnabled() && proto->dtype() != DT_VARIANT &&
+        DataTypeCanUseMemcpy(proto->dtype());
+
+    if (!lazy) {
+      OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
+                              *proto, AllocatorAttributes(), &tensor_));
+      materialized_ = true;
+    } else {
+      Tensor parsed(proto->dtype());
+      OP_REQUIRES(ctx, parsed.FromProto(cpu_allocator(), *proto),
+                  errors::InvalidArgument("Cannot parse tensor from proto: ",
+                                          proto->DebugString()));
+      host_tensor_ = std::move(parsed);
+      device_ = static_cast<DmlDevice*>(ctx->device());
+      registry_id_ = DmlLazyConstantRegistry::Instance()->Register([this] {
+        mutex_lock lock(mu_);
+        return materialized_ ? Status::OK() : MaterializeLocked();
+      });
+    }
+  }
+
+  ~DmlConstantOp() override {
+    if (registry_id_ >= 0) {
+      // Blocks until any in-flight prefetch is done with this kernel.
+      DmlLazyConstantRegistry::Instance()->Deregister(registry_id_);
+    }
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    {
+      mutex_lock lock(mu_);
+      if (!materialized_) {
+        OP_REQUIRES_OK(ctx, MaterializeLocked());
+      }
+    }
+    ctx->set_output(0, tensor_);
+    if (TF_PREDICT_FALSE(ctx->track_allocations())) {
+      ctx->record_persistent_memory_allocation(tensor_.AllocatedBytes());
+    }
+  }
+
+  bool IsExpensive() override { return false; }
+
+ private:
+  Status MaterializeLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+    Tensor device_tensor(allocator, host_tensor_.dtype(),
+                         host_tensor_.shape());
+    if (!device_tensor.IsInitialized()) {
+      return errors::ResourceExhausted(
+          "OOM when allocating tensor of shape ",
+          host_tensor_.shape().DebugString(), " and type ",
+          DataTypeString(host_tensor_.dtype()));
+    }
+
+    Notification note;
+    Status copy_status;
+    device_->dml_device_context()->CopyCPUTensorToDevice(
+        &host_tensor_, device_, &device_tensor,
+        [&note, &copy_status](const Status& status) {
+          copy_status = status;
+          note.Notify();
+        },
+        /*sync_dst_compute=*/false);
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(copy_status);
+
+    tensor_ = std::move(device_tensor);
+    // The host copy has been consumed (the upload is at least recorded), so
+    // drop it; from here on the constant costs device memory only.
+    host_tensor_ = Tensor();
+    materialized_ = true;
+    return Status::OK();
+  }
+
+  mutex mu_;
+  bool materialized_ GUARDED_BY(mu_) = false;
+  Tensor host_tensor_ GUARDED_BY(mu_);
+
+  // Written once under mu_ before materialized_ becomes true; Compute only
+  // reads it after observing materialized_ under mu_.
+  Tensor tensor_;
+
+  DmlDevice* device_ = nullptr;  // weak; device states outlive their kernels
+  int64 registry_id_ = -1;
+};
+
+#define REGISTER_DML_KERNEL(TYPE)                                     \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("Const").Device(DEVICE_DML).TypeConstraint<TYPE>("dtype"), \
+      DmlConstantOp);
+REGISTER_DML_KERNEL(Eigen::half);
+REGISTER_DML_KERNEL(bfloat16);
+REGISTER_DML_KERNEL(float);
+REGISTER_DML_KERNEL(double);
+REGISTER_DML_KERNEL(uint8);
+REGISTER_DML_KERNEL(int8);
+REGISTER_DML_KERNEL(qint8);
+REGISTER_DML_KERNEL(uint16);
+REGISTER_DML_KERNEL(int16);
+REGISTER_DML_KERNEL(qint16);
+REGISTER_DML_KERNEL(quint16);
+REGISTER_DML_KERNEL(uint32);
+REGISTER_DML_KERNEL(qint32);
+REGISTER_DML_KERNEL(int64);
+REGISTER_DML_KERNEL(uint64);
+REGISTER_DML_KERNEL(complex64);
+REGISTER_DML_KERNEL(complex128);
+REGISTER_DML_KERNEL(bool);
+REGISTER_DML_KERNEL(Variant);
+#undef REGISTER_DML_KERNEL
+
+}  // namespace tensorflow
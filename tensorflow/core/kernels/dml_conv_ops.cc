@@ -17,7 +17,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 #include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/kernels/conv_grad_ops.h"
 #include "tensorflow/core/kernels/conv_ops.h"
 #include "tensorflow/core/kernels/dml_kernel_wrapper.h"
@@ -661,8 +664,165 @@ class DmlFusedConv2DKernel : public DmlKernel {
   REGISTER_KERNEL_BUILDER(                                               \
       Name("_FusedConv2D").Device(DEVICE_DML).TypeConstraint<type>("T"), \
       DmlKernelWrapper<DmlFusedConv2DKernel<type>, ConvShapeHelper>);
-// FusedConv2D only supports float32
-TF_CALL_float(DML_REGISTER_KERNEL);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
+// Internal op produced by DmlWeightDecompressionPass. It's a Conv2D whose
+// filter stays in the narrower storage type it was written out in (half or
+// int8) and is widened to the compute type inside the compiled kernel,
+// optionally multiplied by a per-output-channel (or scalar) dequantization
+// scale. The fp32 filter never materializes in video memory and the
+// standalone Cast/Mul dispatches disappear.
+REGISTER_OP("_DmlConv2DDecompressWeight")
+    .Input("input: T")
+    .Input("filter: Tfilter")
+    .Input("scale: num_scales * T")
+    .Output("output: T")
+    .Attr("T: {half, float}")
+    .Attr("Tfilter: {half, int8}")
+    .Attr("num_scales: int >= 0")
+    .Attr("strides: list(int)")
+    .Attr(GetPaddingAttrStringWithExplicit())
+    .Attr(GetExplicitPaddingsAttrString())
+    .Attr(GetConvnetDataFormatAttrString())
+    .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .SetShapeFn(shape_inference::Conv2DShapeWithExplicitPadding)
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+weight decompression pass is expected to create this operator.
+)doc");
+
+class ConvDecompressWeightInitHelper : public ConvInitHelper {
+ public:
+  ConvDecompressWeightInitHelper(OpKernelContext* ctx,
+                                 std::shared_ptr<const Attributes> attr)
+      : ConvInitHelper(ctx, attr) {
+    if (ctx->num_inputs() > 2) {
+      // Per-output-channel means one scale per output feature, which is the
+      // last dimension of the HWIO filter.
+      const TensorShape& filter_shape = ctx->input(1).shape();
+      const TensorShape& scale_shape = ctx->input(2).shape();
+      int64 out_depth = filter_shape.dim_size(3);
+      OP_REQUIRES(ctx,
+                  TensorShapeUtils::IsScalar(scale_shape) ||
+                      (TensorShapeUtils::IsVector(scale_shape) &&
+                       scale_shape.dim_size(0) == out_depth),
+                  errors::InvalidArgument(
+                      "scale must be a scalar or a vector of size ", out_depth,
+                      ", but has shape ", scale_shape.DebugString()));
+    }
+  }
+};
+
+class DmlConv2DDecompressWeightKernel : public DmlKernel {
+ public:
+  using InitHelper = ConvDecompressWeightInitHelper;
+
+  explicit DmlConv2DDecompressWeightKernel(DmlKernelConstruction* ctx,
+                                           const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 2 || ctx->GetInputCount() == 3);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    // 2D conv requires 4D tensors
+    static const uint32_t kDimensionCount = 4;
+
+    CHECK(ctx->GetInputTensorShape(0).dims() == kDimensionCount);
+    CHECK(ctx->GetInputTensorShape(1).dims() == kDimensionCount);
+    CHECK(ctx->GetOutputTensorShape(0).dims() == kDimensionCount);
+
+    const bool has_scale = ctx->GetInputCount() == 3;
+    const Conv2DParameters& conv_params = init_helper->GetParams();
+
+    Conv2DDimensions conv_dims;
+    TF_CHECK_OK(ComputeConv2DDimension(conv_params, ctx->GetInputTensorShape(0),
+                                       ctx->GetInputTensorShape(1),
+                                       &conv_dims));
+
+    uint32_t strides[] = {static_cast<uint32_t>(conv_dims.stride_rows),
+                          static_cast<uint32_t>(conv_dims.stride_cols)};
+    uint32_t dilations[] = {static_cast<uint32_t>(conv_dims.dilation_rows),
+                            static_cast<uint32_t>(conv_dims.dilation_cols)};
+    uint32_t start_padding[] = {
+        static_cast<uint32_t>(conv_dims.pad_rows_before),
+        static_cast<uint32_t>(conv_dims.pad_cols_before)};
+    uint32_t end_padding[] = {static_cast<uint32_t>(conv_dims.pad_rows_after),
+                              static_cast<uint32_t>(conv_dims.pad_cols_after)};
+    uint32_t output_padding[] = {0, 0};
+    uint32_t group_count =
+        static_cast<uint32_t>(conv_dims.in_depth / conv_dims.patch_depth);
+
+    DmlKernelParams params;
+
+    using namespace DmlTensorAxes;
+
+    // The dimensions of the filter tensor are laid out a little differently
+    // than what DML expects
+    auto filter_layout = {H, W, C, N};
+
+    // The layout of the input/output tensors is determined by the "data_format"
+    // attribute
+    auto input_output_layout =
+        GetDmlTensorLayout(conv_params.data_format, kDimensionCount);
+
+    DmlKernelTensors tensors = GetTensorInfos(ctx, params);
+    tensors.inputs[0]->desc =
+        CreateTensorDescFromInput(ctx, 0, input_output_layout);
+    tensors.inputs[1]->desc = CreateTensorDescFromInput(ctx, 1, filter_layout);
+    tensors.outputs[0]->desc =
+        CreateTensorDescFromOutput(ctx, 0, input_output_layout);
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice(),
+                            GetDmlXTensorPolicy(conv_params.data_format));
+    auto input = dml::InputTensor(scope, 0, input_descs[0]);
+    auto stored_filter = dml::InputTensor(scope, 1, input_descs[1]);
+
+    DML_TENSOR_DATA_TYPE compute_type =
+        GetDmlDataTypeFromTfDataType(ctx->GetOutputDataType(0));
+
+    // Widen the stored filter to the compute type in-flight; this is the
+    // only place the decompressed filter ever exists.
+    auto filter = dml::Cast(stored_filter, compute_type);
+
+    if (has_scale) {
+      // The filter desc above is in DML order {N, C, H, W}. A vector scale
+      // follows the output-feature (N) dimension; a scalar scale broadcasts
+      // everywhere.
+      dml::TensorDesc::Dimensions filter_sizes{
+          static_cast<uint32_t>(conv_dims.out_depth),
+          static_cast<uint32_t>(conv_dims.patch_depth),
+          static_cast<uint32_t>(conv_dims.filter_rows),
+          static_cast<uint32_t>(conv_dims.filter_cols)};
+      dml::TensorDesc::Dimensions scale_strides =
+          ctx->GetInputTensorShape(2).dims() == 1
+              ? dml::TensorDesc::Dimensions{1, 0, 0, 0}
+              : dml::TensorDesc::Dimensions{0, 0, 0, 0};
+
+      auto scale = dml::Reinterpret(dml::InputTensor(scope, 2, input_descs[2]),
+                                    filter_sizes, scale_strides);
+      filter = filter * scale;
+    }
+
+    auto conv2d = dml::Convolution(
+        input, filter, absl::nullopt, DML_CONVOLUTION_MODE_CROSS_CORRELATION,
+        DML_CONVOLUTION_DIRECTION_FORWARD, strides, dilations, start_padding,
+        end_padding, output_padding, group_count);
+
+    ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {conv2d});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                           \
+  REGISTER_KERNEL_BUILDER(Name("_DmlConv2DDecompressWeight")                \
+                              .Device(DEVICE_DML)                           \
+                              .TypeConstraint<type>("T"),                   \
+                          DmlKernelWrapper<DmlConv2DDecompressWeightKernel, \
+                                           ConvShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
 
 class DmlConv2DBackpropInputKernel : public DmlKernel {
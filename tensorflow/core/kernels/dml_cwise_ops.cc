@@ -26,24 +26,20 @@ namespace tensorflow {
 using Microsoft::WRL::ComPtr;
 
 static absl::InlinedVector<TensorShape, 2> GetCollapsedShapes(
-    OpKernelContext* ctx) {
-  if (ctx->num_inputs() == 1) {
-    return {TensorShape({ctx->input(0).NumElements()})};
+    absl::Span<const TensorShape> input_shapes) {
+  if (input_shapes.size() == 1) {
+    return {TensorShape({input_shapes[0].num_elements()})};
   }
 
   absl::InlinedVector<TensorShape, 2> shapes;
 
   // Shape collapsing for more than 2 inputs is not implemented
-  if (ctx->num_inputs() > 2) {
-    for (uint32_t i = 0; i < ctx->num_inputs(); ++i) {
-      shapes.push_back(ctx->input(i).shape());
-    }
-
+  if (input_shapes.size() > 2) {
+    shapes.assign(input_shapes.begin(), input_shapes.end());
     return shapes;
   }
 
-  BCast bcast_helper(ctx->input(0).shape().dim_sizes(),
-                     ctx->input(1).shape().dim_sizes());
+  BCast bcast_helper(input_shapes[0].dim_sizes(), input_shapes[1].dim_sizes());
 
   shapes.emplace_back(bcast_helper.x_reshape());
   shapes.emplace_back(bcast_helper.y_reshape());
@@ -62,9 +58,24 @@ class ElementWiseInitHelper
   };
 
   ElementWiseInitHelper(OpKernelContext* ctx,
-                        std::shared_ptr<const Attributes> attr)
+                        std::shared_ptr<const Attributes> attr,
+                        bool apply_shape_bucketing = false)
       : GetBroadcastedOutputShapeHelper::InitHelper(ctx, attr) {
-    collapsed_input_shapes_ = GetCollapsedShapes(ctx);
+    absl::InlinedVector<TensorShape, 2> input_shapes;
+    input_shapes.reserve(ctx->num_inputs());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      input_shapes.push_back(ctx->input(i).shape());
+    }
+
+    // Bucketing pads before collapsing, so the collapsed shapes - and with
+    // them the compiled operator - are identical for every shape in a bucket.
+    // The kernel wrapper pads the cache key with the same rule; see
+    // ApplyShapeBucketingToKernelKey.
+    if (apply_shape_bucketing && ShouldApplyShapeBucketing(ctx)) {
+      PadShapesForShapeBucketing(absl::MakeSpan(input_shapes));
+    }
+
+    collapsed_input_shapes_ = GetCollapsedShapes(input_shapes);
     collapsed_output_shape_ = BroadcastTensorShapes(collapsed_input_shapes_);
 
     OP_REQUIRES(ctx, collapsed_output_shape_.dims() <= max_dim_count,
@@ -72,6 +83,50 @@ class ElementWiseInitHelper
                     "DML doesn't support more than ", max_dim_count,
                     " dimensions for this operator, but ",
                     collapsed_output_shape_.dims(), " were provided."));
+
+    // When the flattened shape holds more elements than one DML dispatch can
+    // address, collapse to a uniform chunk shape instead and record the split;
+    // kernels consuming these shapes then opt into chunked execution over the
+    // full buffers (see DmlKernel::SetChunkedExecution). Only the fully
+    // collapsed case is eligible: every operand must cover either the whole
+    // output or a single broadcast element, so that each chunk pairs
+    // corresponding elements without reaching across chunk boundaries.
+    total_element_count_ = collapsed_output_shape_.num_elements();
+    if (total_element_count_ > kMaxDmlElementsPerDispatch &&
+        collapsed_output_shape_.dims() == 1) {
+      bool chunkable = true;
+      for (const TensorShape& shape : collapsed_input_shapes_) {
+        chunkable =
+            chunkable &&
+            (shape.num_elements() == 1 ||
+             static_cast<uint64_t>(shape.num_elements()) ==
+                 total_element_count_);
+      }
+
+      if (chunkable) {
+        // Split into uniform chunks, rounding the chunk size up to a multiple
+        // of 16 elements so that chunk byte offsets stay DML-aligned for
+        // every element size. kMaxDmlElementsPerDispatch is itself a multiple
+        // of 16, so the rounding never exceeds it.
+        chunk_count_ = static_cast<uint32_t>(
+            (total_element_count_ + kMaxDmlElementsPerDispatch - 1) /
+            kMaxDmlElementsPerDispatch);
+        chunk_element_count_ =
+            ((total_element_count_ + chunk_count_ - 1) / chunk_count_ + 15) /
+            16 * 16;
+        chunk_count_ = static_cast<uint32_t>(
+            (total_element_count_ + chunk_element_count_ - 1) /
+            chunk_element_count_);
+
+        for (TensorShape& shape : collapsed_input_shapes_) {
+          if (shape.num_elements() != 1) {
+            shape = TensorShape({static_cast<int64>(chunk_element_count_)});
+          }
+        }
+        collapsed_output_shape_ =
+            TensorShape({static_cast<int64>(chunk_element_count_)});
+      }
+    }
   }
 
   absl::Span<const TensorShape> GetCollapsedInputShapes() const {
@@ -82,9 +137,80 @@ class ElementWiseInitHelper
     return collapsed_output_shape_;
   }
 
+  // Chunked execution split; a chunk count of 1 means the collapsed shapes
+  // describe the whole tensors and no chunking is needed.
+  uint32_t GetChunkCount() const { return chunk_count_; }
+  uint64_t GetChunkElementCount() const { return chunk_element_count_; }
+  uint64_t GetTotalElementCount() const { return total_element_count_; }
+
  private:
   absl::InlinedVector<TensorShape, 2> collapsed_input_shapes_;
   TensorShape collapsed_output_shape_;
+  uint32_t chunk_count_ = 1;
+  uint64_t chunk_element_count_ = 0;
+  uint64_t total_element_count_ = 0;
+};
+
+// Nominates same-shaped device inputs whose buffers can back the output in
+// place. Every kernel which opts into this helper computes each output
+// element purely from the corresponding element of its inputs, and DML
+// supports identical input and output bindings for such operators, so reusing
+// an otherwise-unreferenced input's buffer is safe and avoids allocating a
+// fresh output buffer every step. Kernels with cross-element dependencies
+// (e.g. the softmax family) must stay on the plain ElementWiseInitHelper.
+template <uint32_t max_dim_count>
+class InPlaceElementWiseInitHelper
+    : public ElementWiseInitHelper<max_dim_count> {
+ public:
+  using ElementWiseInitHelper<max_dim_count>::ElementWiseInitHelper;
+
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    // 64-bit integers are emulated with strided 32-bit tensors, and those
+    // paths zero the output buffer before dispatch, which would destroy an
+    // aliased input.
+    if (Is64BitIntegerType(ctx->expected_output_dtype(output_index))) {
+      return {};
+    }
+
+    absl::InlinedVector<int, 4> candidates;
+    auto input_shapes = this->GetCollapsedInputShapes();
+    const TensorShape& output_shape = this->GetCollapsedOutputShape();
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      // Inputs which broadcast are excluded: their buffers are smaller than
+      // the output's. Mismatched dtypes (e.g. comparison ops producing bool)
+      // would fail to forward anyway, so don't nominate them.
+      if (ctx->input_memory_type(i) == DEVICE_MEMORY && !ctx->input_is_ref(i) &&
+          ctx->input_dtype(i) == ctx->expected_output_dtype(output_index) &&
+          input_shapes[i] == output_shape) {
+        candidates.push_back(i);
+      }
+    }
+    return candidates;
+  }
+};
+
+// Opts the owning kernel into shape bucketing (TF_DIRECTML_SHAPE_BUCKETING):
+// collapsed shapes have their outermost dimension rounded up to the next
+// power of two, so nearby dynamic shapes share one compiled operator, and
+// DmlKernel::Compute stages tensors through desc-sized buffers when the descs
+// outgrow the bound tensors. Only kernels whose tensor descs derive entirely
+// from this helper's collapsed shapes may use it: the kernel cache key is
+// padded with the same rule, so a desc built from the context's true shapes
+// would be undersized for other shapes in the same bucket.
+template <uint32_t max_dim_count>
+class BucketedElementWiseInitHelper
+    : public InPlaceElementWiseInitHelper<max_dim_count> {
+ public:
+  static constexpr bool kSupportsShapeBucketing = true;
+
+  using Attributes =
+      typename InPlaceElementWiseInitHelper<max_dim_count>::Attributes;
+
+  BucketedElementWiseInitHelper(OpKernelContext* ctx,
+                                std::shared_ptr<const Attributes> attr)
+      : InPlaceElementWiseInitHelper<max_dim_count>(
+            ctx, attr, /*apply_shape_bucketing=*/true) {}
 };
 
 static DmlKernelTensors CreateKernelTensors(
@@ -114,7 +240,7 @@ static DmlKernelTensors CreateKernelTensors(
 template <typename ExpressionFunctor, uint32_t max_dim_count>
 class DmlCompositeBinaryKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<max_dim_count>;
+  using InitHelper = BucketedElementWiseInitHelper<max_dim_count>;
 
   explicit DmlCompositeBinaryKernel(DmlKernelConstruction* ctx,
                                     const InitHelper* init_helper) {
@@ -150,6 +276,12 @@ class DmlCompositeBinaryKernel : public DmlKernel {
         scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
 
     Initialize(ctx, std::move(tensors), compiled_op.Get());
+
+    if (init_helper->GetChunkCount() > 1) {
+      SetChunkedExecution(init_helper->GetChunkCount(),
+                          init_helper->GetChunkElementCount(),
+                          init_helper->GetTotalElementCount());
+    }
   }
 
   StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
@@ -222,16 +354,19 @@ class DmlMaxActivationKernel : public DmlKernel {
 template <typename ExpressionFunctor>
 class DmlCompositeUnaryKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<UINT32_MAX>;
+  using InitHelper = BucketedElementWiseInitHelper<UINT32_MAX>;
 
   explicit DmlCompositeUnaryKernel(DmlKernelConstruction* ctx,
                                    const InitHelper* init_helper) {
     CHECK(ctx->GetInputCount() == 1);
     CHECK(ctx->GetOutputCount() == 1);
 
-    TensorShape tensor_shape({ctx->GetOutputTensorShape(0).num_elements()});
+    // For a single input the collapsed shape is the flattened element count,
+    // optionally bucket-padded; it always equals the collapsed output shape.
+    auto input_shapes = init_helper->GetCollapsedInputShapes();
+    const TensorShape& tensor_shape = init_helper->GetCollapsedOutputShape();
     DmlKernelTensors tensors =
-        CreateKernelTensors(ctx, {tensor_shape}, tensor_shape);
+        CreateKernelTensors(ctx, input_shapes, tensor_shape);
 
     auto inputs = GetDmlTensorDescs(tensors.inputs);
 
@@ -256,6 +391,12 @@ class DmlCompositeUnaryKernel : public DmlKernel {
         scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
 
     Initialize(ctx, std::move(tensors), compiled_op.Get());
+
+    if (init_helper->GetChunkCount() > 1) {
+      SetChunkedExecution(init_helper->GetChunkCount(),
+                          init_helper->GetChunkElementCount(),
+                          init_helper->GetTotalElementCount());
+    }
   }
 
   StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
@@ -530,7 +671,7 @@ REGISTER_DML_COMPOSITE_BINARY_FLOAT_KERNEL(SoftsignGrad,
 
 class DmlClipByValueKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<UINT32_MAX>;
+  using InitHelper = InPlaceElementWiseInitHelper<UINT32_MAX>;
 
   explicit DmlClipByValueKernel(DmlKernelConstruction* ctx,
                                 const InitHelper* init_helper) {
@@ -608,7 +749,7 @@ TF_CALL_DML_ALL_TYPES_EXCEPT_INT32(DML_REGISTER_KERNEL);
 template <typename Functor, uint32_t max_dim_count>
 class DmlBinaryWithZeroKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<max_dim_count>;
+  using InitHelper = BucketedElementWiseInitHelper<max_dim_count>;
 
   explicit DmlBinaryWithZeroKernel(DmlKernelConstruction* ctx,
                                    const InitHelper* init_helper) {
@@ -646,6 +787,12 @@ class DmlBinaryWithZeroKernel : public DmlKernel {
         scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
 
     Initialize(ctx, std::move(tensors), compiled_op.Get());
+
+    if (init_helper->GetChunkCount() > 1) {
+      SetChunkedExecution(init_helper->GetChunkCount(),
+                          init_helper->GetChunkElementCount(),
+                          init_helper->GetTotalElementCount());
+    }
   }
 
   StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
@@ -730,7 +877,7 @@ TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
 
 class DmlSeluKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<UINT32_MAX>;
+  using InitHelper = InPlaceElementWiseInitHelper<UINT32_MAX>;
 
   explicit DmlSeluKernel(DmlKernelConstruction* ctx,
                          const InitHelper* init_helper) {
@@ -767,7 +914,7 @@ TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
 
 class DmlLeakyReluKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<UINT32_MAX>;
+  using InitHelper = InPlaceElementWiseInitHelper<UINT32_MAX>;
 
   explicit DmlLeakyReluKernel(DmlKernelConstruction* ctx,
                               const InitHelper* init_helper) {
@@ -836,6 +983,12 @@ class DmlApproximateEqualKernel : public DmlKernel {
         scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
 
     Initialize(ctx, std::move(tensors), compiled_op.Get());
+
+    if (init_helper->GetChunkCount() > 1) {
+      SetChunkedExecution(init_helper->GetChunkCount(),
+                          init_helper->GetChunkElementCount(),
+                          init_helper->GetTotalElementCount());
+    }
   }
 };
 
@@ -903,7 +1056,7 @@ class DmlBitwiseNotKernel : public DmlKernel {
 template <DML_OPERATOR_TYPE op_type, typename DML_OPERATOR_SPECIFIC_DESC>
 class DmlBinaryBitwiseKernel : public DmlKernel {
  public:
-  using InitHelper = ElementWiseInitHelper<8>;
+  using InitHelper = BucketedElementWiseInitHelper<8>;
 
   explicit DmlBinaryBitwiseKernel(DmlKernelConstruction* ctx,
                                   const InitHelper* init_helper) {
@@ -933,6 +1086,12 @@ class DmlBinaryBitwiseKernel : public DmlKernel {
     DML_OPERATOR_DESC op_desc = {op_type, &desc};
 
     Initialize(ctx, std::move(tensors), op_desc);
+
+    if (init_helper->GetChunkCount() > 1) {
+      SetChunkedExecution(init_helper->GetChunkCount(),
+                          init_helper->GetChunkElementCount(),
+                          init_helper->GetTotalElementCount());
+    }
   }
 };
 
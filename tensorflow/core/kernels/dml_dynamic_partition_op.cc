@@ -0,0 +1,158 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/kernels/dml_ops_common.h"
+
+namespace tensorflow {
+
+// The output shapes of DynamicPartition depend on the *values* of the
+// partitions tensor, so the partitions tensor has to be read on the host
+// before the outputs can be allocated. The data tensor, however, never needs
+// to leave the device: each output is assembled with buffer copies, and runs
+// of rows that land in the same partition are moved with a single copy.
+class DmlDynamicPartitionKernel : public OpKernel {
+ public:
+  explicit DmlDynamicPartitionKernel(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_partitions", &num_partitions_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& data = ctx->input(0);
+    const Tensor& partitions = ctx->input(1);
+
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::StartsWith(data.shape(), partitions.shape()),
+        errors::InvalidArgument(
+            "data.shape must start with partitions.shape, ",
+            "got data.shape = ", data.shape().DebugString(),
+            ", partitions.shape = ", partitions.shape().DebugString()));
+
+    auto partition_values = partitions.flat<int32>();
+    const int64 num_rows = partitions.NumElements();
+
+    // Count the rows in each partition to compute the output shapes
+    absl::InlinedVector<int64, 8> partition_sizes(num_partitions_, 0);
+    for (int64 i = 0; i < num_rows; ++i) {
+      const int32 p = partition_values(i);
+      OP_REQUIRES(ctx, FastBoundsCheck(p, num_partitions_),
+                  errors::InvalidArgument(
+                      "partitions", "[", i, "] = ", p,
+                      " is not in [0, ", num_partitions_, ")"));
+      partition_sizes[p]++;
+    }
+
+    TensorShape suffix_shape;
+    for (int d = partitions.dims(); d < data.dims(); ++d) {
+      suffix_shape.AddDim(data.dim_size(d));
+    }
+
+    std::vector<Tensor*> outputs(num_partitions_);
+    for (int p = 0; p < num_partitions_; ++p) {
+      TensorShape output_shape({partition_sizes[p]});
+      output_shape.AppendShape(suffix_shape);
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(p, output_shape, &outputs[p]));
+    }
+
+    const uint64_t byte_stride =
+        suffix_shape.num_elements() * DataTypeSize(data.dtype());
+
+    if (num_rows == 0 || byte_stride == 0) {
+      return;
+    }
+
+    DmlDevice* device = static_cast<DmlDevice*>(ctx->device());
+
+    D3D12BufferRegion input_buffer =
+        dml_util::CreateBufferForTensor(device, data);
+
+    std::vector<D3D12BufferRegion> output_buffers(num_partitions_);
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    barriers.reserve(num_partitions_ + 1);
+
+    barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+        input_buffer.Resource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+    for (int p = 0; p < num_partitions_; ++p) {
+      if (partition_sizes[p] == 0) {
+        continue;
+      }
+
+      output_buffers[p] = dml_util::CreateBufferForTensor(device, *outputs[p]);
+
+      barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+          output_buffers[p].Resource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+          D3D12_RESOURCE_STATE_COPY_DEST));
+    }
+
+    device->GetExecutionContext()->ResourceBarrier(barriers);
+
+    // The destination rows within a partition are always contiguous, so runs
+    // of consecutive rows assigned to the same partition can be moved with a
+    // single copy.
+    absl::InlinedVector<int64, 8> rows_written(num_partitions_, 0);
+    for (int64 i = 0; i < num_rows;) {
+      const int32 p = partition_values(i);
+
+      int64 run_length = 1;
+      while (i + run_length < num_rows &&
+             partition_values(i + run_length) == p) {
+        ++run_length;
+      }
+
+      const D3D12BufferRegion& output_buffer = output_buffers[p];
+
+      const uint64_t src_offset = input_buffer.Offset() + byte_stride * i;
+      const uint64_t dst_offset =
+          output_buffer.Offset() + byte_stride * rows_written[p];
+
+      device->GetExecutionContext()->CopyBufferRegion(
+          output_buffer.Resource(), dst_offset, D3D12_RESOURCE_STATE_COPY_DEST,
+          input_buffer.Resource(), src_offset,
+          D3D12_RESOURCE_STATE_COPY_SOURCE, byte_stride * run_length);
+
+      rows_written[p] += run_length;
+      i += run_length;
+    }
+
+    for (auto& barrier : barriers) {
+      std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+    }
+
+    device->GetExecutionContext()->ResourceBarrier(barriers);
+  }
+
+ private:
+  int num_partitions_;
+};
+
+#define DML_REGISTER_KERNELS(type)                        \
+  REGISTER_KERNEL_BUILDER(Name("DynamicPartition")        \
+                              .Device(DEVICE_DML)         \
+                              .HostMemory("partitions")   \
+                              .TypeConstraint<type>("T"), \
+                          DmlDynamicPartitionKernel)
+
+TF_CALL_DML_ALL_TYPES(DML_REGISTER_KERNELS);
+#undef DML_REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -145,10 +145,19 @@ class DmlDynamicStitchKernel : public OpKernel {
         continue;
       }
 
+      // The source rows are always contiguous, so runs of consecutive output
+      // indices (which DynamicPartition/DynamicStitch round trips produce in
+      // abundance) can be moved with a single copy.
       const auto& indices = indices_tensor.flat<int32>();
-      for (int i = 0; i < indices_tensor.NumElements(); ++i) {
+      for (int i = 0; i < indices_tensor.NumElements();) {
         int32 output_idx = indices(i);
 
+        int run_length = 1;
+        while (i + run_length < indices_tensor.NumElements() &&
+               indices(i + run_length) == output_idx + run_length) {
+          ++run_length;
+        }
+
         const uint64_t src_offset = input_buffer.Offset() + byte_stride * i;
         const uint64_t dst_offset =
             output_buffer.Offset() + byte_stride * output_idx;
@@ -156,7 +165,9 @@ class DmlDynamicStitchKernel : public OpKernel {
         device->GetExecutionContext()->CopyBufferRegion(
             output_buffer.Resource(), dst_offset,
             D3D12_RESOURCE_STATE_COPY_DEST, input_buffer.Resource(), src_offset,
-            D3D12_RESOURCE_STATE_COPY_SOURCE, byte_stride);
+            D3D12_RESOURCE_STATE_COPY_SOURCE, byte_stride * run_length);
+
+        i += run_length;
       }
     }
 
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/common_runtime/dml/dml_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -44,6 +45,13 @@ class DmlEmptyKernel : public OpKernel {
     if (init_ && out_shape.num_elements() > 0) {
       DmlDevice* device = static_cast<DmlDevice*>(ctx->device());
 
+      // Freshly allocated heap memory is already zeroed by D3D12; only
+      // dispatch the clear when the buffer has held data before.
+      if (device->GetAllocator()->ConsumeZeroInitializedState(
+              output_tensor->tensor_data().data())) {
+        return;
+      }
+
       D3D12BufferRegion output_buffer =
           dml_util::CreateBufferForTensor(device, *output_tensor);
 
@@ -0,0 +1,210 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_fused_elementwise.h"
+#include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/kernels/dml_ops_common.h"
+
+namespace tensorflow {
+
+using Microsoft::WRL::ComPtr;
+
+// Internal op produced by DmlElementwiseFusionPass. It evaluates a
+// producer/consumer chain of elementwise ops as a single compiled DML graph,
+// replacing one dispatch per op with a single dispatch for the whole chain.
+//
+// `op_names` lists the original TF op types in execution order. The first op
+// consumes inputs[0] (and inputs[1] if it's binary); each subsequent binary op
+// consumes the previous op's result as its left operand and the next unused
+// input as its right operand. Unary ops consume only the previous result.
+//
+// The chain evaluates in the compute type `T`, but inputs may arrive as either
+// half or float and the output may likewise differ from `T`: mismatched
+// operands are converted in-flight inside the compiled graph. The fusion pass
+// uses this to absorb fp16/fp32 bridging Casts at chain boundaries instead of
+// leaving them as standalone read-write passes over the tensor.
+REGISTER_OP("_DmlFusedElementwise")
+    .Input("inputs: input_types")
+    .Output("output: out_type")
+    .Attr("T: {half, float}")
+    .Attr("input_types: list({half, float}) >= 1")
+    .Attr("out_type: {half, float}")
+    .Attr("op_names: list(string)")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle out = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(BroadcastBinaryOpOutputShapeFnHelper(
+            c, out, c->input(i), /*incompatible_shape_error=*/true, &out));
+      }
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+elementwise fusion pass is expected to create this operator.
+)doc");
+
+class FusedElementwiseInitHelper
+    : public GetBroadcastedOutputShapeHelper::InitHelper {
+ public:
+  struct Attributes
+      : public GetBroadcastedOutputShapeHelper::InitHelper::Attributes {
+    explicit Attributes(OpKernelConstruction* ctx)
+        : GetBroadcastedOutputShapeHelper::InitHelper::Attributes(ctx) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("T", &compute_type));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("op_names", &op_names));
+      OP_REQUIRES(ctx, !op_names.empty(),
+                  errors::InvalidArgument(
+                      "_DmlFusedElementwise requires a non-empty op_names"));
+
+      for (const string& op_name : op_names) {
+        OP_REQUIRES(ctx, DmlFusedElementwiseArity(op_name) != 0,
+                    errors::InvalidArgument(
+                        "_DmlFusedElementwise doesn't support fusing '",
+                        op_name, "'"));
+      }
+    }
+
+    DataType compute_type;
+    std::vector<string> op_names;
+  };
+
+  FusedElementwiseInitHelper(OpKernelContext* ctx,
+                             std::shared_ptr<const Attributes> attr)
+      : GetBroadcastedOutputShapeHelper::InitHelper(ctx, attr),
+        attr_(std::move(attr)) {}
+
+  absl::Span<const string> GetOpNames() const { return attr_->op_names; }
+  DataType GetComputeType() const { return attr_->compute_type; }
+
+  // The fused chain is element-wise end to end (the fusion pass only admits
+  // ops from the DmlFusedElementwiseArity vocabulary), so any same-shaped
+  // device input whose buffer isn't referenced elsewhere can back the output
+  // in place, saving a fresh output allocation every step.
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    absl::InlinedVector<TensorShape, 4> input_shapes;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      input_shapes.push_back(ctx->input(i).shape());
+    }
+    const TensorShape output_shape = BroadcastTensorShapes(input_shapes);
+
+    absl::InlinedVector<int, 4> candidates;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      // Inputs which broadcast are excluded; their buffers are smaller than
+      // the output's.
+      if (ctx->input_memory_type(i) == DEVICE_MEMORY && !ctx->input_is_ref(i) &&
+          ctx->input_dtype(i) == ctx->expected_output_dtype(output_index) &&
+          input_shapes[i] == output_shape) {
+        candidates.push_back(i);
+      }
+    }
+    return candidates;
+  }
+
+ private:
+  std::shared_ptr<const Attributes> attr_;
+};
+
+class DmlFusedElementwiseKernel : public DmlKernel {
+ public:
+  using InitHelper = FusedElementwiseInitHelper;
+
+  explicit DmlFusedElementwiseKernel(DmlKernelConstruction* ctx,
+                                     const InitHelper* init_helper) {
+    CHECK(ctx->GetOutputCount() == 1);
+
+    const TensorShape& output_shape = ctx->GetOutputTensorShape(0);
+
+    DmlKernelTensors tensors;
+    for (uint32_t i = 0; i < ctx->GetInputCount(); ++i) {
+      DmlTensorInfo input;
+      input.kernel_index = i;
+
+      // Broadcast every input up to the output shape; elementwise chains are
+      // insensitive to whether broadcasting happens at each step or up front.
+      input.desc = DmlTensorDesc::Create(ctx->GetInputDataType(i),
+                                         output_shape,
+                                         ctx->GetInputTensorShape(i));
+      tensors.inputs.push_back(std::move(input));
+    }
+
+    DmlTensorInfo output;
+    output.kernel_index = 0;
+    output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                        output_shape, output_shape);
+    tensors.outputs = {output};
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+
+    // Inputs whose type differs from the compute type carry an absorbed Cast;
+    // convert them in-flight before they enter the chain.
+    const DataType compute_type = init_helper->GetComputeType();
+    const DML_TENSOR_DATA_TYPE dml_compute_type =
+        GetDmlDataTypeFromTfDataType(compute_type);
+
+    auto result = dml::InputTensor(scope, 0, inputs[0]);
+    if (ctx->GetInputDataType(0) != compute_type) {
+      result = dml::Cast(result, dml_compute_type);
+    }
+    uint32_t next_input = 1;
+
+    for (const string& op_name : init_helper->GetOpNames()) {
+      if (DmlFusedElementwiseArity(op_name) == 2) {
+        CHECK(next_input < ctx->GetInputCount());
+        auto rhs = dml::InputTensor(scope, next_input, inputs[next_input]);
+        if (ctx->GetInputDataType(next_input) != compute_type) {
+          rhs = dml::Cast(rhs, dml_compute_type);
+        }
+        ++next_input;
+        result = DmlComposeFusedElementwise(op_name, result, &rhs);
+      } else {
+        result = DmlComposeFusedElementwise(op_name, result, nullptr);
+      }
+    }
+
+    CHECK(next_input == ctx->GetInputCount());
+
+    if (ctx->GetOutputDataType(0) != compute_type) {
+      result = dml::Cast(
+          result, GetDmlDataTypeFromTfDataType(ctx->GetOutputDataType(0)));
+    }
+
+    ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                     \
+  REGISTER_KERNEL_BUILDER(Name("_DmlFusedElementwise")                \
+                              .Device(DEVICE_DML)                     \
+                              .TypeConstraint<type>("T"),             \
+                          DmlKernelWrapper<DmlFusedElementwiseKernel, \
+                                           GetBroadcastedOutputShapeHelper>);
+TF_CALL_half(DML_REGISTER_KERNEL);
+TF_CALL_float(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
+}  // namespace tensorflow
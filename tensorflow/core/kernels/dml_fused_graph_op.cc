@@ -0,0 +1,280 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_fused_elementwise.h"
+#include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/kernels/dml_ops_common.h"
+
+namespace tensorflow {
+
+using Microsoft::WRL::ComPtr;
+
+// Internal op produced by DmlClusterFusionPass. It evaluates a DAG of
+// elementwise ops as a single compiled DML graph, replacing one dispatch per
+// op with a single dispatch for the whole cluster. Where _DmlFusedElementwise
+// encodes a linear chain implicitly, this op carries an explicit operand
+// encoding so results can fan out to several cluster ops and the cluster can
+// surface several outputs.
+//
+// `op_names` lists the original TF op types in topological order. `node_args`
+// is the concatenation of each op's operand references, in op order: a value
+// below the input count names one of this node's inputs, and a value of
+// (input count + i) names the result of op i, which always precedes the
+// referencing op. `output_nodes` lists the ops whose results this node
+// outputs, in output order.
+//
+// The cluster evaluates in the compute type `T`, but inputs may arrive as
+// either half or float: mismatched operands are converted in-flight inside
+// the compiled graph, which lets the fusion pass absorb fp16/fp32 bridging
+// Casts feeding the cluster instead of leaving them as standalone read-write
+// passes over the tensor.
+REGISTER_OP("_DmlFusedGraph")
+    .Input("inputs: input_types")
+    .Output("outputs: out_types")
+    .Attr("T: {half, float}")
+    .Attr("input_types: list({half, float}) >= 1")
+    .Attr("out_types: list({half, float}) >= 1")
+    .Attr("op_names: list(string)")
+    .Attr("node_args: list(int)")
+    .Attr("output_nodes: list(int)")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle out = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(BroadcastBinaryOpOutputShapeFnHelper(
+            c, out, c->input(i), /*incompatible_shape_error=*/true, &out));
+      }
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->set_output(i, out);
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+cluster fusion pass is expected to create this operator.
+)doc");
+
+class FusedGraphInitHelper : public BroadcastedOutputShapeInitHelper {
+ public:
+  struct Attributes : public BroadcastedOutputShapeInitHelper::Attributes {
+    explicit Attributes(OpKernelConstruction* ctx)
+        : BroadcastedOutputShapeInitHelper::Attributes(ctx) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("T", &compute_type));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("op_names", &op_names));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("node_args", &node_args));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("output_nodes", &output_nodes));
+      OP_REQUIRES(ctx, !op_names.empty(),
+                  errors::InvalidArgument(
+                      "_DmlFusedGraph requires a non-empty op_names"));
+
+      // Validate the operand encoding up front so the kernel's graph builder
+      // can index without checks: the arities must account for every operand,
+      // and each reference must name an input or an earlier op's result.
+      size_t expected_args = 0;
+      for (const string& op_name : op_names) {
+        int arity = DmlFusedElementwiseArity(op_name);
+        OP_REQUIRES(ctx, arity != 0,
+                    errors::InvalidArgument(
+                        "_DmlFusedGraph doesn't support fusing '", op_name,
+                        "'"));
+        expected_args += arity;
+      }
+      OP_REQUIRES(ctx, node_args.size() == expected_args,
+                  errors::InvalidArgument(
+                      "_DmlFusedGraph expected ", expected_args,
+                      " operand references but got ", node_args.size()));
+
+      const int num_inputs = ctx->num_inputs();
+      size_t arg_index = 0;
+      for (size_t i = 0; i < op_names.size(); ++i) {
+        int arity = DmlFusedElementwiseArity(op_names[i]);
+        for (int j = 0; j < arity; ++j, ++arg_index) {
+          int32 ref = node_args[arg_index];
+          OP_REQUIRES(ctx,
+                      ref >= 0 && ref < num_inputs + static_cast<int32>(i),
+                      errors::InvalidArgument(
+                          "_DmlFusedGraph operand reference ", ref,
+                          " for op ", i, " is out of range"));
+        }
+      }
+
+      OP_REQUIRES(ctx,
+                  static_cast<int>(output_nodes.size()) == ctx->num_outputs(),
+                  errors::InvalidArgument(
+                      "_DmlFusedGraph expected ", ctx->num_outputs(),
+                      " output references but got ", output_nodes.size()));
+      for (int32 output_node : output_nodes) {
+        OP_REQUIRES(ctx,
+                    output_node >= 0 &&
+                        output_node < static_cast<int32>(op_names.size()),
+                    errors::InvalidArgument(
+                        "_DmlFusedGraph output reference ", output_node,
+                        " is out of range"));
+      }
+    }
+
+    DataType compute_type;
+    std::vector<string> op_names;
+    std::vector<int32> node_args;
+    std::vector<int32> output_nodes;
+  };
+
+  FusedGraphInitHelper(OpKernelContext* ctx,
+                       std::shared_ptr<const Attributes> attr)
+      : BroadcastedOutputShapeInitHelper(ctx, attr), attr_(std::move(attr)) {}
+
+  DataType GetComputeType() const { return attr_->compute_type; }
+  absl::Span<const string> GetOpNames() const { return attr_->op_names; }
+  absl::Span<const int32> GetNodeArgs() const { return attr_->node_args; }
+  absl::Span<const int32> GetOutputNodes() const {
+    return attr_->output_nodes;
+  }
+
+  // The fused cluster is element-wise end to end (the fusion pass only admits
+  // ops from the DmlFusedElementwiseArity vocabulary), so any same-shaped
+  // device input whose buffer isn't referenced elsewhere can back an output
+  // in place, saving a fresh output allocation every step.
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    absl::InlinedVector<int, 4> candidates;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      // Inputs which broadcast are excluded; their buffers are smaller than
+      // the output's.
+      if (ctx->input_memory_type(i) == DEVICE_MEMORY && !ctx->input_is_ref(i) &&
+          ctx->input_dtype(i) == ctx->expected_output_dtype(output_index) &&
+          ctx->input(i).shape() == GetBroadcastedShape()) {
+        candidates.push_back(i);
+      }
+    }
+    return candidates;
+  }
+
+ private:
+  std::shared_ptr<const Attributes> attr_;
+};
+
+// Every cluster output has the fully broadcasted shape of the inputs; the
+// fusion pass only admits elementwise ops, so no op in the cluster can change
+// rank or reduce.
+class FusedGraphShapeHelper : public ShapeHelper {
+ public:
+  using InitHelper = FusedGraphInitHelper;
+
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    auto init_helper = static_cast<const InitHelper*>(initialization_helper);
+    return std::vector<TensorShape>(ctx->num_outputs(),
+                                    init_helper->GetBroadcastedShape());
+  }
+};
+
+class DmlFusedGraphKernel : public DmlKernel {
+ public:
+  using InitHelper = FusedGraphInitHelper;
+
+  explicit DmlFusedGraphKernel(DmlKernelConstruction* ctx,
+                               const InitHelper* init_helper) {
+    const TensorShape& output_shape = ctx->GetOutputTensorShape(0);
+
+    DmlKernelTensors tensors;
+    for (uint32_t i = 0; i < ctx->GetInputCount(); ++i) {
+      DmlTensorInfo input;
+      input.kernel_index = i;
+
+      // Broadcast every input up to the output shape; elementwise clusters
+      // are insensitive to whether broadcasting happens at each step or up
+      // front.
+      input.desc = DmlTensorDesc::Create(ctx->GetInputDataType(i),
+                                         output_shape,
+                                         ctx->GetInputTensorShape(i));
+      tensors.inputs.push_back(std::move(input));
+    }
+
+    for (uint32_t o = 0; o < ctx->GetOutputCount(); ++o) {
+      DmlTensorInfo output;
+      output.kernel_index = o;
+      output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(o),
+                                          output_shape, output_shape);
+      tensors.outputs.push_back(std::move(output));
+    }
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+
+    const DataType compute_type = init_helper->GetComputeType();
+    const DML_TENSOR_DATA_TYPE dml_compute_type =
+        GetDmlDataTypeFromTfDataType(compute_type);
+
+    // Values an operand reference can name: the fused node's inputs first
+    // (converted in-flight if they carry an absorbed Cast), then each op's
+    // result as it's composed.
+    std::vector<dml::Expression> values;
+    for (uint32_t i = 0; i < ctx->GetInputCount(); ++i) {
+      auto value = dml::InputTensor(scope, i, inputs[i]);
+      if (ctx->GetInputDataType(i) != compute_type) {
+        value = dml::Cast(value, dml_compute_type);
+      }
+      values.push_back(value);
+    }
+
+    absl::Span<const int32> node_args = init_helper->GetNodeArgs();
+    size_t arg_index = 0;
+    for (const string& op_name : init_helper->GetOpNames()) {
+      auto lhs = values[node_args[arg_index++]];
+      if (DmlFusedElementwiseArity(op_name) == 2) {
+        auto rhs = values[node_args[arg_index++]];
+        values.push_back(DmlComposeFusedElementwise(op_name, lhs, &rhs));
+      } else {
+        values.push_back(DmlComposeFusedElementwise(op_name, lhs, nullptr));
+      }
+    }
+    CHECK(arg_index == node_args.size());
+
+    std::vector<dml::Expression> outputs;
+    for (uint32_t o = 0; o < ctx->GetOutputCount(); ++o) {
+      auto result =
+          values[ctx->GetInputCount() + init_helper->GetOutputNodes()[o]];
+      if (ctx->GetOutputDataType(o) != compute_type) {
+        result = dml::Cast(
+            result, GetDmlDataTypeFromTfDataType(ctx->GetOutputDataType(o)));
+      }
+      outputs.push_back(result);
+    }
+
+    ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, outputs);
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                    \
+  REGISTER_KERNEL_BUILDER(                           \
+      Name("_DmlFusedGraph")                         \
+          .Device(DEVICE_DML)                        \
+          .TypeConstraint<type>("T"),                \
+      DmlKernelWrapper<DmlFusedGraphKernel, FusedGraphShapeHelper>);
+TF_CALL_half(DML_REGISTER_KERNEL);
+TF_CALL_float(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
+}  // namespace tensorflow
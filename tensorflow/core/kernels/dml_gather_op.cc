@@ -372,4 +372,184 @@ TF_CALL_float(DML_REGISTER_KERNELS);
 TF_CALL_half(DML_REGISTER_KERNELS);
 #undef DML_REGISTER_KERNELS
 
+template <typename TIndex>
+class FusedGatherConcatInitHelper : public InitializationHelper {
+ public:
+  using Attributes = EmptyAttributes;
+
+  FusedGatherConcatInitHelper(OpKernelContext* ctx,
+                              std::shared_ptr<const Attributes> attr) {
+    // Inputs are laid out as N tables followed by N indices tensors.
+    num_tables_ = ctx->num_inputs() / 2;
+
+    const TensorShape& indices_shape = ctx->input(num_tables_).shape();
+
+    for (int i = 0; i < num_tables_; ++i) {
+      const Tensor& params = ctx->input(i);
+      const Tensor& indices = ctx->input(num_tables_ + i);
+
+      OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(params.shape()),
+                  errors::InvalidArgument("params[", i,
+                                          "] must be 2 dimensional, got ",
+                                          params.shape().DebugString()));
+
+      OP_REQUIRES(ctx, indices.shape() == indices_shape,
+                  errors::InvalidArgument(
+                      "all indices tensors must have the same shape, got ",
+                      indices.shape().DebugString(), " and ",
+                      indices_shape.DebugString()));
+
+      // Check that we have enough index space
+      OP_REQUIRES(
+          ctx, params.dim_size(0) <= std::numeric_limits<TIndex>::max(),
+          errors::InvalidArgument("params[", i, "].shape[0] too large for ",
+                                  DataTypeString(DataTypeToEnum<TIndex>::v()),
+                                  " indexing: ", params.dim_size(0), " > ",
+                                  std::numeric_limits<TIndex>::max()));
+    }
+  }
+
+  int GetTableCount() const { return num_tables_; }
+
+ private:
+  int num_tables_;
+};
+
+template <typename TIndex>
+class FusedGatherConcatShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    auto init_helper =
+        static_cast<const FusedGatherConcatInitHelper<TIndex>*>(
+            initialization_helper);
+    int num_tables = init_helper->GetTableCount();
+
+    // The result shape is indices.shape + [sum of the embedding widths].
+    TensorShape output_shape = ctx->input(num_tables).shape();
+
+    int64 total_width = 0;
+    for (int i = 0; i < num_tables; ++i) {
+      total_width += ctx->input(i).dim_size(1);
+    }
+    output_shape.AddDim(total_width);
+
+    return {std::move(output_shape)};
+  }
+};
+
+// Implements the _DmlFusedGatherConcat op produced by the grappler remapper.
+// Each table's lookup gathers rows along axis 0, and the gathered rows are
+// joined along the last axis; the whole assembly compiles into a single DML
+// operator instead of N gather dispatches plus a concat.
+template <typename TIndex>
+class DmlFusedGatherConcatKernel : public DmlKernel {
+ public:
+  using InitHelper = FusedGatherConcatInitHelper<TIndex>;
+
+  explicit DmlFusedGatherConcatKernel(DmlKernelConstruction* ctx,
+                                      const InitHelper* init_helper) {
+    int num_tables = init_helper->GetTableCount();
+    CHECK(ctx->GetInputCount() == num_tables * 2);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    uint32_t num_indices = static_cast<uint32_t>(
+        ctx->GetInputTensorShape(num_tables).num_elements());
+
+    DmlKernelTensors tensors;
+
+    uint32_t total_width = 0;
+    for (int i = 0; i < num_tables; ++i) {
+      const TensorShape& params_shape = ctx->GetInputTensorShape(i);
+
+      SimpleGather simple_gather =
+          SimplifyGather(params_shape, ctx->GetInputTensorShape(num_tables + i),
+                         /*axis=*/0, /*batch_dims=*/0);
+
+      DmlTensorInfo params_input;
+      params_input.kernel_index = i;
+      params_input.desc =
+          DmlTensorDesc::Create(ctx->GetInputDataType(i),
+                                simple_gather.params_shape,
+                                simple_gather.params_shape);
+      tensors.inputs.push_back(std::move(params_input));
+
+      total_width += static_cast<uint32_t>(params_shape.dim_size(1));
+    }
+
+    for (int i = 0; i < num_tables; ++i) {
+      SimpleGather simple_gather =
+          SimplifyGather(ctx->GetInputTensorShape(i),
+                         ctx->GetInputTensorShape(num_tables + i),
+                         /*axis=*/0, /*batch_dims=*/0);
+
+      DmlTensorInfo indices_input;
+      indices_input.kernel_index = num_tables + i;
+      indices_input.desc =
+          DmlTensorDesc::Create(ctx->GetInputDataType(num_tables + i),
+                                simple_gather.indices_shape,
+                                simple_gather.indices_shape);
+      tensors.inputs.push_back(std::move(indices_input));
+    }
+
+    dml::TensorDesc::Dimensions output_sizes = {1, 1, num_indices,
+                                                total_width};
+
+    DmlTensorInfo output;
+    output.kernel_index = 0;
+    output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                        output_sizes, output_sizes);
+    tensors.outputs = {output};
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+
+    absl::InlinedVector<dml::Expression, 8> gathered;
+    gathered.reserve(num_tables);
+
+    for (int i = 0; i < num_tables; ++i) {
+      SimpleGather simple_gather =
+          SimplifyGather(ctx->GetInputTensorShape(i),
+                         ctx->GetInputTensorShape(num_tables + i),
+                         /*axis=*/0, /*batch_dims=*/0);
+
+      auto params_tensor = dml::InputTensor(scope, i, inputs[i]);
+      auto indices_tensor =
+          dml::InputTensor(scope, num_tables + i, inputs[num_tables + i]);
+
+      gathered.push_back(dml::Gather(params_tensor, indices_tensor,
+                                     simple_gather.gather_axis,
+                                     simple_gather.index_dimensions));
+    }
+
+    auto result = dml::Join(gathered, kNchwDimensionCount - 1);
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+template <typename TIndex>
+using DmlFusedGatherConcatWrapper =
+    DmlKernelWrapper<DmlFusedGatherConcatKernel<TIndex>,
+                     FusedGatherConcatShapeHelper<TIndex>>;
+
+#define DML_REGISTER_KERNELS(type)                                \
+  REGISTER_KERNEL_BUILDER(Name("_DmlFusedGatherConcat")           \
+                              .Device(DEVICE_DML)                 \
+                              .TypeConstraint<type>("T")          \
+                              .TypeConstraint<int32>("Tindices"), \
+                          DmlFusedGatherConcatWrapper<int32>)     \
+  REGISTER_KERNEL_BUILDER(Name("_DmlFusedGatherConcat")           \
+                              .Device(DEVICE_DML)                 \
+                              .TypeConstraint<type>("T")          \
+                              .TypeConstraint<int64>("Tindices"), \
+                          DmlFusedGatherConcatWrapper<int64>)
+
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNELS);
+#undef DML_REGISTER_KERNELS
+
 }  // namespace tensorflow
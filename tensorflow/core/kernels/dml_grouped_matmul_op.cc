@@ -0,0 +1,203 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/kernels/dml_ops_common.h"
+
+namespace tensorflow {
+
+using Microsoft::WRL::ComPtr;
+
+// Internal op produced by DmlGroupedMatMulPass. It evaluates N independent
+// matrix products — possibly all differently shaped — as a single compiled
+// DML graph, replacing one dispatch per MatMul with one dispatch for the
+// whole group. Mixture-of-experts layers and per-head projections produce
+// dozens of small independent matmuls whose per-dispatch scheduling cost
+// exceeds the math; grouped, the work is one submission and the GPU is free
+// to overlap the products.
+//
+// `transpose_a[i]`/`transpose_b[i]` carry the original MatMul attributes of
+// group member i.
+REGISTER_OP("_DmlGroupedMatMul")
+    .Input("a: N * T")
+    .Input("b: N * T")
+    .Output("product: N * T")
+    .Attr("T: {half, float}")
+    .Attr("N: int >= 2")
+    .Attr("transpose_a: list(bool)")
+    .Attr("transpose_b: list(bool)")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      std::vector<bool> transpose_a;
+      std::vector<bool> transpose_b;
+      TF_RETURN_IF_ERROR(c->GetAttr("transpose_a", &transpose_a));
+      TF_RETURN_IF_ERROR(c->GetAttr("transpose_b", &transpose_b));
+      const int n = c->num_inputs() / 2;
+      for (int i = 0; i < n; ++i) {
+        shape_inference::ShapeHandle a;
+        shape_inference::ShapeHandle b;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, &a));
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(n + i), 2, &b));
+        c->set_output(i, c->Matrix(c->Dim(a, transpose_a[i] ? 1 : 0),
+                                   c->Dim(b, transpose_b[i] ? 0 : 1)));
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+grouped matmul pass is expected to create this operator.
+)doc");
+
+class GroupedMatMulInitHelper : public InitializationHelper {
+ public:
+  struct Attributes {
+    explicit Attributes(OpKernelConstruction* ctx) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &group_size));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("transpose_a", &transpose_a));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("transpose_b", &transpose_b));
+      OP_REQUIRES(ctx,
+                  transpose_a.size() == static_cast<size_t>(group_size) &&
+                      transpose_b.size() == static_cast<size_t>(group_size),
+                  errors::InvalidArgument(
+                      "transpose_a and transpose_b must each have N (",
+                      group_size, ") entries, but have ", transpose_a.size(),
+                      " and ", transpose_b.size()));
+    }
+
+    int64 group_size;
+    std::vector<bool> transpose_a;
+    std::vector<bool> transpose_b;
+  };
+
+  GroupedMatMulInitHelper(OpKernelContext* ctx,
+                          std::shared_ptr<const Attributes> attr)
+      : attr_(std::move(attr)) {
+    const int64 n = attr_->group_size;
+    for (int64 i = 0; i < n; ++i) {
+      const TensorShape& a_shape = ctx->input(i).shape();
+      const TensorShape& b_shape = ctx->input(n + i).shape();
+      OP_REQUIRES(ctx,
+                  TensorShapeUtils::IsMatrix(a_shape) &&
+                      TensorShapeUtils::IsMatrix(b_shape),
+                  errors::InvalidArgument(
+                      "Group member ", i, " is not a matrix product: ",
+                      a_shape.DebugString(), " vs. ", b_shape.DebugString()));
+
+      int in0_k_index = attr_->transpose_a[i] ? 0 : 1;
+      int in1_k_index = attr_->transpose_b[i] ? 1 : 0;
+      OP_REQUIRES(
+          ctx, a_shape.dim_size(in0_k_index) == b_shape.dim_size(in1_k_index),
+          errors::InvalidArgument("Group member ", i,
+                                  " is size-incompatible: In[0]: ",
+                                  a_shape.DebugString(),
+                                  ", In[1]: ", b_shape.DebugString()));
+    }
+  }
+
+  int64 GroupSize() const { return attr_->group_size; }
+  bool TransposeA(int64 i) const { return attr_->transpose_a[i]; }
+  bool TransposeB(int64 i) const { return attr_->transpose_b[i]; }
+
+ private:
+  const std::shared_ptr<const Attributes> attr_;
+};
+
+class GroupedMatMulShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    auto init_helper =
+        static_cast<const GroupedMatMulInitHelper*>(initialization_helper);
+    const int64 n = init_helper->GroupSize();
+
+    std::vector<TensorShape> output_shapes;
+    output_shapes.reserve(n);
+    for (int64 i = 0; i < n; ++i) {
+      const TensorShape& a_shape = ctx->input(i).shape();
+      const TensorShape& b_shape = ctx->input(n + i).shape();
+      output_shapes.emplace_back(TensorShape(
+          {a_shape.dim_size(init_helper->TransposeA(i) ? 1 : 0),
+           b_shape.dim_size(init_helper->TransposeB(i) ? 0 : 1)}));
+    }
+    return output_shapes;
+  }
+};
+
+class DmlGroupedMatMulKernel : public DmlKernel {
+ public:
+  using InitHelper = GroupedMatMulInitHelper;
+
+  explicit DmlGroupedMatMulKernel(DmlKernelConstruction* ctx,
+                                  const InitHelper* init_helper) {
+    const int64 n = init_helper->GroupSize();
+    CHECK(ctx->GetInputCount() == static_cast<uint32_t>(2 * n));
+    CHECK(ctx->GetOutputCount() == static_cast<uint32_t>(n));
+
+    DmlKernelTensors tensors;
+    for (uint32_t i = 0; i < ctx->GetInputCount(); ++i) {
+      DmlTensorInfo input;
+      input.kernel_index = i;
+      input.desc = DmlTensorDesc::Create(ctx->GetInputDataType(i),
+                                         ctx->GetInputTensorShape(i),
+                                         ctx->GetInputTensorShape(i));
+      tensors.inputs.push_back(std::move(input));
+    }
+    for (uint32_t i = 0; i < ctx->GetOutputCount(); ++i) {
+      DmlTensorInfo output;
+      output.kernel_index = i;
+      output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(i),
+                                          ctx->GetOutputTensorShape(i),
+                                          ctx->GetOutputTensorShape(i));
+      tensors.outputs.push_back(std::move(output));
+    }
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+
+    std::vector<dml::Expression> products;
+    products.reserve(n);
+    for (int64 i = 0; i < n; ++i) {
+      auto a = dml::InputTensor(scope, i, input_descs[i]);
+      auto b = dml::InputTensor(scope, n + i, input_descs[n + i]);
+      products.push_back(
+          dml::Gemm(a, b, absl::nullopt,
+                    init_helper->TransposeA(i) ? DML_MATRIX_TRANSFORM_TRANSPOSE
+                                               : DML_MATRIX_TRANSFORM_NONE,
+                    init_helper->TransposeB(i) ? DML_MATRIX_TRANSFORM_TRANSPOSE
+                                               : DML_MATRIX_TRANSFORM_NONE));
+    }
+
+    ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, products);
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                      \
+  REGISTER_KERNEL_BUILDER(                                             \
+      Name("_DmlGroupedMatMul").Device(DEVICE_DML).TypeConstraint<type>("T"), \
+      DmlKernelWrapper<DmlGroupedMatMulKernel, GroupedMatMulShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,233 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Ahead-of-time DML kernel warmup. DML kernels are normally compiled lazily
+// inside DmlKernelWrapperBase::Compute, which makes the first Session::Run
+// after process start pay for every operator compilation in sequence. The
+// warmup function registered here walks a graph partition before it executes,
+// propagates statically-known shapes forward from Const nodes and promised
+// feed shapes, and pre-builds the kernel cache entry for every node whose
+// shapes (and constant CPU input values) are fully determined. Nodes whose
+// shapes can't be determined ahead of time are skipped and compile lazily as
+// before.
+
+#include <map>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/dml/dml_device.h"
+#include "tensorflow/core/common_runtime/kernel_warmup_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+
+namespace tensorflow {
+namespace {
+
+// Statically-determined metadata for one output of a node: its shape, and
+// (for Const nodes) its value, which downstream kernels may consume as a
+// constant CPU input.
+struct KnownOutput {
+  TensorShape shape;
+  absl::optional<Tensor> value;
+};
+
+typedef absl::flat_hash_map<const Node*, absl::InlinedVector<KnownOutput, 2>>
+    KnownOutputsMap;
+
+// Builds the DML kernel for `node` without executing it, returning the
+// statically-computed output shapes on success or nullopt if the node can't
+// be warmed up.
+absl::optional<std::vector<TensorShape>> WarmupNode(
+    DmlDevice* device, const Graph& graph, const Node* node,
+    const KnownOutputsMap& known) {
+  // Ref inputs can't be faithfully stood in for without the producer's actual
+  // buffer and mutex, so leave these kernels to compile lazily.
+  for (int i = 0; i < node->num_inputs(); ++i) {
+    if (IsRefType(node->input_type(i))) {
+      return absl::nullopt;
+    }
+  }
+
+  Status status;
+  std::unique_ptr<OpKernel> op_kernel(
+      CreateOpKernel(DEVICE_DML, device, device->GetAllocator({}), node->def(),
+                     graph.versions().producer(), &status));
+  if (!status.ok()) {
+    return absl::nullopt;
+  }
+
+  auto* wrapper = dynamic_cast<DmlKernelWrapperBase*>(op_kernel.get());
+  if (wrapper == nullptr) {
+    // Not a DmlKernel-backed op (e.g. a host-side kernel registered for DML);
+    // there is nothing to pre-build.
+    return absl::nullopt;
+  }
+
+  // Assemble the input tensors. Device-memory inputs only contribute their
+  // shape and type to the kernel key and to kernel construction, so stand-ins
+  // suffice; host-memory inputs become part of the key and must carry the
+  // real values, which are only available when the producer is a Const.
+  const MemoryTypeVector& input_memory_types = op_kernel->input_memory_types();
+  gtl::InlinedVector<Tensor, 4> input_storage(node->num_inputs());
+  gtl::InlinedVector<TensorValue, 4> inputs(node->num_inputs());
+  for (const Edge* e : node->in_edges()) {
+    if (e->IsControlEdge()) continue;
+
+    auto it = known.find(e->src());
+    if (it == known.end() ||
+        e->src_output() >= static_cast<int>(it->second.size())) {
+      return absl::nullopt;
+    }
+    const KnownOutput& src_output = it->second[e->src_output()];
+
+    if (input_memory_types[e->dst_input()] == HOST_MEMORY) {
+      if (!src_output.value) {
+        return absl::nullopt;
+      }
+      input_storage[e->dst_input()] = *src_output.value;
+    } else {
+      input_storage[e->dst_input()] =
+          Tensor(node->input_type(e->dst_input()), src_output.shape);
+    }
+    inputs[e->dst_input()] = TensorValue(&input_storage[e->dst_input()]);
+  }
+
+  OpKernelContext::Params params;
+  params.device = device;
+  params.frame_iter = FrameAndIter(0, 0);
+  params.inputs = &inputs;
+  params.op_kernel = op_kernel.get();
+  params.resource_manager = device->resource_manager();
+
+  OpKernelContext op_ctx(&params);
+  std::vector<TensorShape> output_shapes;
+  Status warmup_status = wrapper->WarmupKernel(&op_ctx, &output_shapes);
+  if (!warmup_status.ok()) {
+    VLOG(2) << "DML kernel warmup skipped " << node->name() << " ("
+            << node->type_string() << "): " << warmup_status.ToString();
+    return absl::nullopt;
+  }
+  return output_shapes;
+}
+
+Status WarmupDmlKernels(Device* device, const Graph& graph,
+                        const std::map<string, TensorShape>& feed_shapes) {
+  DmlDevice* dml_device = static_cast<DmlDevice*>(device);
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+
+  // Seed the known shapes from Const values and from the shapes the caller
+  // promises to feed. Feed nodes in a partition are _Recv ops whose
+  // tensor_name attribute is the feed name exactly as passed to Run.
+  KnownOutputsMap known;
+  known.reserve(order.size());
+  for (const Node* node : order) {
+    if (node->IsConstant()) {
+      const TensorProto* proto = nullptr;
+      Tensor value;
+      if (GetNodeAttr(node->attrs(), "value", &proto).ok() &&
+          value.FromProto(*proto)) {
+        known[node].push_back(KnownOutput{value.shape(), value});
+      }
+    } else if (node->type_string() == "_Recv") {
+      string tensor_name;
+      if (GetNodeAttr(node->attrs(), "tensor_name", &tensor_name).ok()) {
+        auto it = feed_shapes.find(tensor_name);
+        if (it != feed_shapes.end()) {
+          known[node].push_back(KnownOutput{it->second, absl::nullopt});
+        }
+      }
+    }
+  }
+
+  std::vector<const Node*> remaining;
+  for (const Node* node : order) {
+    if (!node->IsOp() || known.count(node) > 0) continue;
+    remaining.push_back(node);
+  }
+
+  thread::ThreadPool pool(Env::Default(), "dml_kernel_warmup",
+                          port::MaxParallelism());
+
+  // Process the graph in waves: each wave pre-builds, in parallel, every
+  // not-yet-attempted node whose input shapes are all known, then feeds the
+  // resulting output shapes into the next wave. Nodes that can't be warmed
+  // stay out of the known set, which stops propagation into their consumers.
+  while (!remaining.empty()) {
+    std::vector<const Node*> ready;
+    std::vector<const Node*> blocked;
+    for (const Node* node : remaining) {
+      bool inputs_known = true;
+      for (const Edge* e : node->in_edges()) {
+        if (e->IsControlEdge()) continue;
+        auto it = known.find(e->src());
+        if (it == known.end() ||
+            e->src_output() >= static_cast<int>(it->second.size())) {
+          inputs_known = false;
+          break;
+        }
+      }
+      (inputs_known ? ready : blocked).push_back(node);
+    }
+    if (ready.empty()) break;
+
+    // The nodes in a wave are independent of each other, and the kernel
+    // manager deduplicates any that collide on the same kernel key.
+    std::vector<absl::optional<std::vector<TensorShape>>> results(ready.size());
+    BlockingCounter counter(ready.size());
+    for (size_t i = 0; i < ready.size(); ++i) {
+      pool.Schedule([&, i] {
+        results[i] = WarmupNode(dml_device, graph, ready[i], known);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+
+    for (size_t i = 0; i < ready.size(); ++i) {
+      if (results[i]) {
+        auto& outputs = known[ready[i]];
+        for (const TensorShape& shape : *results[i]) {
+          outputs.push_back(KnownOutput{shape, absl::nullopt});
+        }
+      }
+    }
+
+    remaining.swap(blocked);
+  }
+
+  return Status::OK();
+}
+
+// Registered at load time so that DirectSession::WarmupKernels reaches DML
+// without the session layer linking against DML code.
+class DmlKernelWarmupRegistrar {
+ public:
+  DmlKernelWarmupRegistrar() {
+    KernelWarmupRegistry::Register(DEVICE_DML, WarmupDmlKernels);
+  }
+};
+static DmlKernelWarmupRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
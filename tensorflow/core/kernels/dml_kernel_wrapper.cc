@@ -16,9 +16,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/dml_kernel_wrapper.h"
 
+#include "tensorflow/core/common_runtime/dml/dml_bfc_allocator.h"
+#include "tensorflow/core/common_runtime/dml/dml_kernel_trace.h"
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_tracing.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
@@ -29,8 +33,8 @@ DmlKernelWrapperBase::DmlKernelWrapperBase(OpKernelConstruction* ctx,
       node_def_(std::make_shared<NodeDef>(ctx->def())) {}
 
 void DmlKernelWrapperBase::Compute(OpKernelContext* ctx) {
-  DmlTracing::Instance().LogKernelCompute(ctx->op_kernel().type_string(),
-                                          ctx->op_kernel().name());
+  DmlKernelComputeScope compute_scope(ctx->op_kernel().type_string(),
+                                      ctx->op_kernel().name());
 
   const DmlDevice* dml_device = static_cast<const DmlDevice*>(ctx->device());
   const DmlKernelManager& kernel_manager = *dml_device->GetKernelManager();
@@ -44,13 +48,27 @@ void DmlKernelWrapperBase::Compute(OpKernelContext* ctx) {
   DmlKernelKey key;
 
   if (cache_policy_ != DmlKernelCachePolicy::Never) {
-    // Construct a kernel key which uniquely identifies the kernel instance we
-    // need
-    key = CreateKernelKey(ctx);
-
-    // Retrieve an appropriate DmlKernel from the cache. If the kernel hasn't
-    // been cached yet, it will be null
-    kernel = TryGetCachedKernel(kernel_manager, key);
+    // Check this instance's own cached kernel first: when the input signature
+    // hasn't changed since the last invocation, this avoids constructing a
+    // kernel key and hashing the node's attributes entirely. Fast-path hits
+    // don't touch the kernel manager, so they don't show up in its hit
+    // counters or refresh its LRU position; the shared_ptr held by this
+    // instance keeps the kernel valid even if the manager evicts it.
+    kernel = TryGetInstanceCachedKernel(ctx);
+
+    if (!kernel) {
+      // Construct a kernel key which uniquely identifies the kernel instance
+      // we need
+      key = CreateKernelKey(ctx);
+
+      // Retrieve an appropriate DmlKernel from the cache. If the kernel hasn't
+      // been cached yet, it will be null
+      kernel = TryGetCachedKernel(kernel_manager, key);
+
+      if (kernel) {
+        SetInstanceCachedKernel(ctx, kernel);
+      }
+    }
   }
 
   // If we found a cached kernel, simply retrieve its initialization helper
@@ -89,8 +107,12 @@ void DmlKernelWrapperBase::Compute(OpKernelContext* ctx) {
         OP_REQUIRES_OK(
             ctx, ctx->allocate_output(i, output_shapes[i], &output_tensor));
 
-        // If the tensor is nonempty, fill it with zero's
-        if (output_tensor->NumElements() != 0) {
+        // If the tensor is nonempty, fill it with zero's. Freshly allocated
+        // heap memory is already zeroed by D3D12, in which case the clear
+        // can be skipped entirely.
+        if (output_tensor->NumElements() != 0 &&
+            !dml_device->GetAllocator()->ConsumeZeroInitializedState(
+                output_tensor->tensor_data().data())) {
           D3D12BufferRegion buffer =
               dml_util::CreateBufferForTensor(dml_device, *output_tensor);
 
@@ -120,10 +142,52 @@ void DmlKernelWrapperBase::Compute(OpKernelContext* ctx) {
     if (!ctx->status().ok()) {
       return;
     }
+
+    if (cache_policy_ != DmlKernelCachePolicy::Never) {
+      SetInstanceCachedKernel(ctx, kernel);
+    }
   }
 
   assert(kernel != nullptr);
 
+  // If the kernel is logically an identity over one of its inputs, try to
+  // forward the input's buffer straight to the output. When this succeeds, no
+  // GPU work needs to be dispatched at all.
+  if (ctx->num_outputs() == 1) {
+    absl::optional<int> forwardable_input =
+        init_helper->GetForwardableInputIndex(ctx, output_shapes, 0);
+
+    if (forwardable_input &&
+        ctx->input_memory_type(*forwardable_input) == DEVICE_MEMORY &&
+        !ctx->input_is_ref(*forwardable_input)) {
+      std::unique_ptr<Tensor> forwarded = ctx->forward_input(
+          *forwardable_input, 0, ctx->expected_output_dtype(0),
+          output_shapes[0], DEVICE_MEMORY, ctx->output_alloc_attr(0));
+
+      if (forwarded) {
+        ctx->set_output(0, *forwarded);
+        return;
+      }
+
+      // The input's buffer is referenced elsewhere, so fall through and let
+      // the kernel execute (and copy) as usual.
+    }
+  }
+
+  // If the output is a contiguous window of an input, emit a tensor that
+  // aliases the input's buffer at an offset instead of dispatching a copy.
+  // Unlike forwarding, this is safe even when the input is referenced
+  // elsewhere, because non-ref tensors are immutable once produced.
+  if (ctx->num_outputs() == 1) {
+    absl::optional<Tensor> view =
+        init_helper->GetContiguousInputView(ctx, output_shapes, 0);
+
+    if (view) {
+      ctx->set_output(0, *view);
+      return;
+    }
+  }
+
   // Execute the kernel
   DmlKernelContext dml_ctx(dml_device, ctx, init_helper, output_shapes,
                            kernel->GetOutputRefsForwarding());
@@ -134,13 +198,64 @@ void DmlKernelWrapperBase::Compute(OpKernelContext* ctx) {
     return;
   }
 
+  DmlKernelTrace* trace = DmlKernelTrace::Instance();
+  const uint64 trace_start_us =
+      trace->IsEnabled() ? Env::Default()->NowMicros() : 0;
+
   auto status_or_event = ComputeKernel(kernel.get(), &dml_ctx);
   OP_REQUIRES_OK(ctx, status_or_event.status());
 
+  if (trace->IsEnabled()) {
+    trace->RecordExecution(*node_def_, ctx,
+                           Env::Default()->NowMicros() - trace_start_us);
+  }
+
   // Keep this kernel alive at least until it's completed execution on the GPU
   kernel_manager.QueueReference(kernel, status_or_event.ConsumeValueOrDie());
 }
 
+Status DmlKernelWrapperBase::WarmupKernel(
+    OpKernelContext* ctx, std::vector<TensorShape>* output_shapes) {
+  const DmlDevice* dml_device = static_cast<const DmlDevice*>(ctx->device());
+  const DmlKernelManager& kernel_manager = *dml_device->GetKernelManager();
+  const ShapeHelper* shape_helper = GetShapeHelper();
+
+  std::shared_ptr<const InitializationHelper> init_helper =
+      CreateInitializationHelper(ctx);
+  TF_RETURN_IF_ERROR(ctx->status());
+
+  *output_shapes = shape_helper->GetOutputShapes(ctx, init_helper.get());
+
+  if (ctx->num_outputs() != output_shapes->size()) {
+    return errors::InvalidArgument(
+        "The shape helper supplied an incorrect number of output shapes. ",
+        ctx->num_outputs(), " were expected, but ", output_shapes->size(),
+        " were provided.");
+  }
+
+  if (cache_policy_ == DmlKernelCachePolicy::Never) {
+    // Nothing to warm; this kernel is rebuilt on every Compute anyway.
+    return Status::OK();
+  }
+
+  if (init_helper->IsNoOpKernel(ctx, *output_shapes)) {
+    // No-op'd kernels never construct a DmlKernel.
+    return Status::OK();
+  }
+
+  DmlKernelKey key = CreateKernelKey(ctx);
+  if (TryGetCachedKernel(kernel_manager, key)) {
+    return Status::OK();
+  }
+
+  DmlKernelConstruction dml_construction(dml_device, ctx, node_def_.get(),
+                                         shape_helper, *output_shapes,
+                                         init_helper);
+  CreateCachedKernel(&dml_construction, kernel_manager, key,
+                     init_helper.get());
+  return ctx->status();
+}
+
 DmlKernelKey DmlKernelWrapperBase::CreateKernelKey(OpKernelContext* ctx) const {
   DmlKernelKey key = {};
   key.op_type_name = this->type_string();
@@ -176,4 +291,110 @@ DmlKernelKey DmlKernelWrapperBase::CreateKernelKey(OpKernelContext* ctx) const {
   return key;
 }
 
+std::shared_ptr<DmlKernel> DmlKernelWrapperBase::TryGetInstanceCachedKernel(
+    OpKernelContext* ctx) const {
+  std::unique_lock<std::mutex> lock(instance_cache_mutex_);
+
+  if (!instance_cache_kernel_ ||
+      instance_cache_signature_.size() !=
+          static_cast<size_t>(ctx->num_inputs())) {
+    return nullptr;
+  }
+
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    const DmlInputTensorKey& cached = instance_cache_signature_[i];
+
+    const Tensor& tensor =
+        ctx->input_is_ref(i) ? ctx->mutable_input(i, false) : ctx->input(i);
+
+    if (cached.is_constant_cpu_input) {
+      const Tensor& cached_tensor = absl::get<Tensor>(cached.tensor);
+
+      if (cached_tensor.dtype() != tensor.dtype() ||
+          cached_tensor.shape() != tensor.shape()) {
+        return nullptr;
+      }
+
+      auto cached_data = cached_tensor.tensor_data();
+      auto data = tensor.tensor_data();
+      if (cached_data.size() != data.size() ||
+          memcmp(cached_data.data(), data.data(), data.size()) != 0) {
+        return nullptr;
+      }
+    } else {
+      const auto& cached_tensor = absl::get<TensorShapeAndType>(cached.tensor);
+
+      if (cached_tensor.dtype != tensor.dtype() ||
+          cached_tensor.shape != tensor.shape()) {
+        return nullptr;
+      }
+    }
+  }
+
+  return instance_cache_kernel_;
+}
+
+void DmlKernelWrapperBase::SetInstanceCachedKernel(
+    OpKernelContext* ctx, std::shared_ptr<DmlKernel> kernel) const {
+  // Record the signature exactly as CreateKernelKey reads the inputs, but with
+  // the raw (unbucketed) shapes, since the fast path compares against raw
+  // shapes straight out of the context.
+  absl::InlinedVector<DmlInputTensorKey, 6> signature;
+  signature.reserve(ctx->num_inputs());
+
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    MemoryType memory_type = ctx->input_memory_type(i);
+    const bool is_resource_type =
+        (BaseType(ctx->input_dtype(i)) == DT_RESOURCE);
+
+    const Tensor& tensor =
+        ctx->input_is_ref(i) ? ctx->mutable_input(i, false) : ctx->input(i);
+
+    DmlInputTensorKey tensor_key = {};
+    tensor_key.is_constant_cpu_input =
+        (memory_type == HOST_MEMORY && !is_resource_type);
+
+    if (tensor_key.is_constant_cpu_input) {
+      tensor_key.tensor = tensor::DeepCopy(tensor);
+    } else {
+      tensor_key.tensor = TensorShapeAndType{tensor.shape(), tensor.dtype()};
+    }
+
+    signature.push_back(std::move(tensor_key));
+  }
+
+  std::unique_lock<std::mutex> lock(instance_cache_mutex_);
+  instance_cache_signature_ = std::move(signature);
+  instance_cache_kernel_ = std::move(kernel);
+}
+
+void ApplyShapeBucketingToKernelKey(OpKernelContext* ctx, DmlKernelKey* key) {
+  if (!ShouldApplyShapeBucketing(ctx)) {
+    return;
+  }
+
+  // Pad all input shapes jointly - the bucketing rule needs to see every shape
+  // to preserve broadcast compatibility - but only write the padded shapes
+  // back into the device-memory entries. Constant CPU inputs are keyed by
+  // value and must keep their true shapes.
+  absl::InlinedVector<TensorShape, 6> shapes;
+  shapes.reserve(key->input_tensors.size());
+  for (const DmlInputTensorKey& input : key->input_tensors) {
+    if (input.is_constant_cpu_input) {
+      shapes.push_back(absl::get<Tensor>(input.tensor).shape());
+    } else {
+      shapes.push_back(absl::get<TensorShapeAndType>(input.tensor).shape);
+    }
+  }
+
+  PadShapesForShapeBucketing(absl::MakeSpan(shapes));
+
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    DmlInputTensorKey& input = key->input_tensors[i];
+    if (!input.is_constant_cpu_input) {
+      absl::get<TensorShapeAndType>(input.tensor).shape = shapes[i];
+    }
+  }
+}
+
 }  // namespace tensorflow
\ No newline at end of file
@@ -44,6 +44,17 @@ class DmlKernelWrapperBase : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override;
 
+  // Builds (and caches) the DmlKernel this op would execute with the input
+  // shapes and constant input values carried by `ctx`, without dispatching any
+  // GPU work. `ctx` only needs valid input metadata: device-memory input
+  // tensors may be shape/type stand-ins, since only their shapes form the
+  // kernel key, but host-memory inputs must carry their real values. On
+  // success, `output_shapes` receives the shapes computed by the shape helper
+  // so that callers propagating static shapes through a graph can continue to
+  // downstream nodes.
+  Status WarmupKernel(OpKernelContext* ctx,
+                      std::vector<TensorShape>* output_shapes);
+
  protected:
   virtual const ShapeHelper* GetShapeHelper() const = 0;
   virtual std::shared_ptr<const InitializationHelper>
@@ -73,8 +84,58 @@ class DmlKernelWrapperBase : public OpKernel {
 
   DmlKernelCachePolicy cache_policy_;
   std::shared_ptr<const NodeDef> node_def_;
+
+ private:
+  // Fast path for the (overwhelmingly common) case where an op instance is
+  // invoked repeatedly with the same input signature: the wrapper remembers
+  // the kernel it last resolved together with the raw input shapes, dtypes,
+  // and constant CPU input values it was resolved for. When they all match,
+  // the kernel can be reused without building a DmlKernelKey, hashing the
+  // node's attributes, or taking the kernel manager's lock. The op type and
+  // attributes never change for a given instance, so only the inputs need
+  // comparing. Returns nullptr on mismatch (e.g. after a dynamic shape
+  // change), in which case the caller falls back to the kernel manager.
+  //
+  // The signature deliberately records the unbucketed shapes: two shapes that
+  // pad to the same bucket resolve through the manager cache (and then both
+  // hit this fast path on their next repetition, whichever came last).
+  std::shared_ptr<DmlKernel> TryGetInstanceCachedKernel(
+      OpKernelContext* ctx) const;
+
+  // Records `kernel` and the input signature of `ctx` for the fast path
+  // above. Constant CPU inputs are deep-copied so the cached signature doesn't
+  // pin feed buffers beyond the step.
+  void SetInstanceCachedKernel(OpKernelContext* ctx,
+                               std::shared_ptr<DmlKernel> kernel) const;
+
+  // Guards the two members below; the same op instance may be invoked
+  // concurrently from parallel steps.
+  mutable std::mutex instance_cache_mutex_;
+  mutable absl::InlinedVector<DmlInputTensorKey, 6> instance_cache_signature_;
+  mutable std::shared_ptr<DmlKernel> instance_cache_kernel_;
 };
 
+// Detects kernels whose init helper declares
+// `static constexpr bool kSupportsShapeBucketing = true` (e.g. through
+// BucketedElementWiseInitHelper). Only such kernels may have their cache keys
+// bucketed, because the kernel's tensor descs must be built from the same
+// padded shapes the key carries.
+template <typename TKernel, typename = void>
+struct DmlKernelSupportsShapeBucketing : std::false_type {};
+
+template <typename TKernel>
+struct DmlKernelSupportsShapeBucketing<
+    TKernel, typename std::enable_if<
+                 TKernel::InitHelper::kSupportsShapeBucketing>::type>
+    : std::true_type {};
+
+// Rounds the shapes of the device-memory inputs recorded in `key` up to their
+// shape buckets. No-op unless TF_DIRECTML_SHAPE_BUCKETING is enabled and the
+// kernel's tensors are bucketable. This must apply exactly the same padding
+// rule as the kernel's init helper (both call PadShapesForShapeBucketing), or
+// a cache hit could return a kernel whose descs don't cover the tensors.
+void ApplyShapeBucketingToKernelKey(OpKernelContext* ctx, DmlKernelKey* key);
+
 // Implements a (templated) GetOrCreateKernel and output shape computation for
 // the kernel wrapper.
 //
@@ -148,6 +209,14 @@ class DmlKernelWrapper : public DmlKernelWrapperBase {
     return kernel->Compute(context);
   }
 
+  DmlKernelKey CreateKernelKey(OpKernelContext* ctx) const override {
+    DmlKernelKey key = DmlKernelWrapperBase::CreateKernelKey(ctx);
+    if (DmlKernelSupportsShapeBucketing<TKernel>::value) {
+      ApplyShapeBucketingToKernelKey(ctx, &key);
+    }
+    return key;
+  }
+
  private:
   const std::shared_ptr<const Attributes> attr_;
   const TShapeHelper shape_helper_;
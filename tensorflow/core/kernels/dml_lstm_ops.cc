@@ -1020,9 +1020,27 @@ class DmlBlockLstmOp : public DmlKernel {
     }
 
     dml::TensorDesc::Dimensions output_dims{1, timelen, batch_size, cell_size};
-    dml::TensorDesc::Dimensions x_extent{1, 1, batch_size, input_size};
     dml::TensorDesc::Dimensions output_extent{1, 1, batch_size, cell_size};
 
+    // Hoist the input projection out of the recurrence. The weights are laid
+    // out as [w_x; w_h] stacked along the rows, so x_t * w_x for every
+    // timestep can be computed with one large GEMM up front; the loop below
+    // then only runs the small h_prev * w_h GEMM per step. This is the same
+    // treatment of the input weights as the fused cuDNN-style RNN paths and
+    // substantially shrinks the sequential part of the graph.
+    dml::TensorDesc::Dimensions w_x_extent{1, 1, input_size, cell_size * 4};
+    dml::TensorDesc::Dimensions w_h_offset{0, 0, input_size, 0};
+    dml::TensorDesc::Dimensions w_h_extent{1, 1, cell_size, cell_size * 4};
+    auto w_x = dml::Slice(w, {0, 0, 0, 0}, w_x_extent, slice_stride);
+    auto w_h = dml::Slice(w, w_h_offset, w_h_extent, slice_stride);
+
+    auto x_flat =
+        dml::Reinterpret(x, {1, 1, timelen * batch_size, input_size}, {});
+    auto x_proj = dml::Reinterpret(
+        dml::Gemm(x_flat, w_x),
+        {1, timelen, batch_size, cell_size * 4}, {});
+    dml::TensorDesc::Dimensions gates_extent{1, 1, batch_size, cell_size * 4};
+
     std::vector<dml::Expression> i_tensors;
     std::vector<dml::Expression> cs_tensors;
     std::vector<dml::Expression> f_tensors;
@@ -1041,19 +1059,16 @@ class DmlBlockLstmOp : public DmlKernel {
 
     for (uint32_t t = 0; t < seq_len_max_int; ++t) {
       dml::TensorDesc::Dimensions tensor_offset{0, t, 0, 0};
-      dml::TensorDesc::Dimensions prev_offset{0, t - 1, 0, 0};
-
-      auto x_tensor = dml::Slice(x, tensor_offset, x_extent, slice_stride);
 
       auto cs_prev_tensor = t == 0 ? cs_prev : cs_tensors.at(t - 1);
       auto h_prev_tensor = t == 0 ? h_prev : h_tensors.at(t - 1);
 
-      // Concat xh = [x, h].
-      auto xh = dml::Join({x_tensor, h_prev_tensor}, 3);
-
-      // states1 = xh * w + b
-      auto gates_gemm = dml::Gemm(xh, w);
-      dml::Expression gates = gates_gemm;
+      // states1 = x * w_x + h_prev * w_h + b, with the x * w_x term already
+      // computed for all timesteps above.
+      auto x_proj_tensor =
+          dml::Slice(x_proj, tensor_offset, gates_extent, slice_stride);
+      auto gates_gemm = dml::Gemm(h_prev_tensor, w_h);
+      dml::Expression gates = x_proj_tensor + gates_gemm;
       gates += b;
 
       // Input gate.
@@ -16,7 +16,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/kernels/dml_kernel_wrapper.h"
 #include "tensorflow/core/kernels/dml_ops_common.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
@@ -506,4 +509,145 @@ class DmlFusedMatMulKernel : public DmlKernel {
 TF_CALL_float(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
 
+// Internal op produced by DmlWeightDecompressionPass. It's a MatMul whose
+// weight operand stays in the narrower storage type it was written out in
+// (half or int8) and is widened to the compute type inside the compiled
+// kernel, optionally multiplied by a per-output-channel (or scalar)
+// dequantization scale. The fp32 weight never materializes in video memory
+// and the standalone Cast/Mul dispatches disappear.
+REGISTER_OP("_DmlMatMulDecompressWeight")
+    .Input("a: T")
+    .Input("b: Tb")
+    .Input("scale: num_scales * T")
+    .Output("product: T")
+    .Attr("T: {half, float}")
+    .Attr("Tb: {half, int8}")
+    .Attr("num_scales: int >= 0")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .SetShapeFn(shape_inference::MatMulShape)
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+weight decompression pass is expected to create this operator.
+)doc");
+
+class MatMulDecompressWeightInitHelper : public MatMulInitHelper {
+ public:
+  MatMulDecompressWeightInitHelper(OpKernelContext* ctx,
+                                   std::shared_ptr<const Attributes> attr)
+      : MatMulInitHelper(ctx, attr) {
+    if (ctx->num_inputs() > 2) {
+      // A vector scale broadcasts along B's trailing dimension, exactly like
+      // the Mul it replaces; for a non-transposed B that's one scale per
+      // output channel.
+      const TensorShape& b_shape = ctx->input(1).shape();
+      const TensorShape& scale_shape = ctx->input(2).shape();
+      int64 b_cols = b_shape.dim_size(1);
+      OP_REQUIRES(ctx,
+                  TensorShapeUtils::IsScalar(scale_shape) ||
+                      (TensorShapeUtils::IsVector(scale_shape) &&
+                       scale_shape.dim_size(0) == b_cols),
+                  errors::InvalidArgument(
+                      "scale must be a scalar or a vector of size ", b_cols,
+                      ", but has shape ", scale_shape.DebugString()));
+    }
+  }
+};
+
+class DmlMatMulDecompressWeightKernel : public DmlKernel {
+ public:
+  using InitHelper = MatMulDecompressWeightInitHelper;
+
+  explicit DmlMatMulDecompressWeightKernel(DmlKernelConstruction* ctx,
+                                           const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 2 || ctx->GetInputCount() == 3);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    const bool has_scale = ctx->GetInputCount() == 3;
+
+    DmlTensorInfo a;
+    a.kernel_index = 0;
+    a.desc = DmlTensorDesc::Create(ctx->GetInputDataType(0),
+                                   ctx->GetInputTensorShape(0),
+                                   ctx->GetInputTensorShape(0));
+
+    DmlTensorInfo b;
+    b.kernel_index = 1;
+    b.desc = DmlTensorDesc::Create(ctx->GetInputDataType(1),
+                                   ctx->GetInputTensorShape(1),
+                                   ctx->GetInputTensorShape(1));
+
+    DmlTensorInfo output;
+    output.kernel_index = 0;
+    output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                        ctx->GetOutputTensorShape(0),
+                                        ctx->GetOutputTensorShape(0));
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {a, b};
+    if (has_scale) {
+      DmlTensorInfo scale;
+      scale.kernel_index = 2;
+      scale.desc = DmlTensorDesc::Create(ctx->GetInputDataType(2),
+                                         ctx->GetInputTensorShape(2),
+                                         ctx->GetInputTensorShape(2));
+      tensors.inputs.push_back(scale);
+    }
+    tensors.outputs = {output};
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto a_tensor = dml::InputTensor(scope, 0, input_descs[0]);
+    auto b_tensor = dml::InputTensor(scope, 1, input_descs[1]);
+
+    DML_TENSOR_DATA_TYPE compute_type =
+        GetDmlDataTypeFromTfDataType(ctx->GetOutputDataType(0));
+
+    // Widen the stored weight to the compute type in-flight; this is the
+    // only place the decompressed weight ever exists.
+    auto weight = dml::Cast(b_tensor, compute_type);
+
+    if (has_scale) {
+      const TensorShape& b_shape = ctx->GetInputTensorShape(1);
+      uint32_t b_rows = static_cast<uint32_t>(b_shape.dim_size(0));
+      uint32_t b_cols = static_cast<uint32_t>(b_shape.dim_size(1));
+      dml::TensorDesc::Dimensions b_sizes{1, 1, b_rows, b_cols};
+
+      // Broadcast the scale across the weight: a vector scale follows B's
+      // trailing dimension (matching the Mul it replaces); a scalar scale
+      // broadcasts everywhere.
+      dml::TensorDesc::Dimensions scale_strides =
+          ctx->GetInputTensorShape(2).dims() == 1
+              ? dml::TensorDesc::Dimensions{0, 0, 0, 1}
+              : dml::TensorDesc::Dimensions{0, 0, 0, 0};
+
+      auto scale = dml::Reinterpret(dml::InputTensor(scope, 2, input_descs[2]),
+                                    b_sizes, scale_strides);
+      weight = weight * scale;
+    }
+
+    auto product =
+        dml::Gemm(a_tensor, weight, absl::nullopt,
+                  init_helper->TransposeA() ? DML_MATRIX_TRANSFORM_TRANSPOSE
+                                            : DML_MATRIX_TRANSFORM_NONE,
+                  init_helper->TransposeB() ? DML_MATRIX_TRANSFORM_TRANSPOSE
+                                            : DML_MATRIX_TRANSFORM_NONE);
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {product});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                 \
+  REGISTER_KERNEL_BUILDER(Name("_DmlMatMulDecompressWeight")      \
+                              .Device(DEVICE_DML)                 \
+                              .TypeConstraint<type>("T"),         \
+                          DmlKernelWrapper<DmlMatMulDecompressWeightKernel, \
+                                           MatMulShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
 }  // namespace tensorflow
@@ -0,0 +1,285 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// GPU-time microbenchmarks for DML kernels. Each case drives one op through a
+// set of representative shapes on /device:DML:0 and measures true GPU
+// execution time using the device's timestamp-query profiler (see
+// DmlGpuProfiler), so the numbers exclude session, executor, and transfer
+// overhead and are directly comparable across driver versions.
+//
+// Results are logged as one JSON object per line prefixed with
+// "DML_BENCHMARK", and appended to the file named by the
+// TF_DIRECTML_BENCHMARK_OUTPUT environment variable when it is set, so a
+// driver qualification pass can diff two runs mechanically.
+
+#include <fstream>
+
+#include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/dml/dml_device_cache.h"
+#include "tensorflow/core/common_runtime/dml/dml_device_state.h"
+#include "tensorflow/core/common_runtime/dml/dml_execution_context.h"
+#include "tensorflow/core/common_runtime/dml/dml_gpu_profiler.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/env_var.h"
+
+#ifdef WIN32
+// This is necessary for the linker to find htonl and friends
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+
+namespace tensorflow {
+namespace {
+
+constexpr int kWarmupIterations = 5;
+constexpr int kTimedIterations = 50;
+
+// Starts a step capture on every DML device's GPU profiler. Returns false if
+// no device supports timestamp queries (e.g. some software adapters), in
+// which case benchmarks log a warning and skip instead of failing.
+bool StartGpuCapture() {
+  bool any = false;
+  DmlDeviceCache::Instance().ForEachDeviceState(
+      [&](int adapter_index, const DmlDeviceState& state) {
+        DmlGpuProfiler* profiler = state.execution_context->GetGpuProfiler();
+        if (profiler) {
+          profiler->StartStepCapture();
+          any = true;
+        }
+      });
+  return any;
+}
+
+// Flushes and drains every DML device, stops the captures, and returns the
+// total GPU time across all captured dispatches in microseconds.
+double StopGpuCapture(uint64* dispatches) {
+  double total_us = 0;
+  *dispatches = 0;
+  DmlDeviceCache::Instance().ForEachDeviceState(
+      [&](int adapter_index, const DmlDeviceState& state) {
+        DmlGpuProfiler* profiler = state.execution_context->GetGpuProfiler();
+        if (!profiler) {
+          return;
+        }
+
+        // Wait for the GPU to finish so every timestamp pair has resolved
+        // into its readback buffer before the capture is collected.
+        auto status_or_event = state.execution_context->Flush();
+        if (status_or_event.ok()) {
+          status_or_event.ConsumeValueOrDie().WaitForSignal();
+        }
+
+        const double frequency =
+            static_cast<double>(profiler->timestamp_frequency());
+        for (const auto& event : profiler->StopStepCapture()) {
+          total_us += event.duration_ticks * 1e6 / frequency;
+          ++*dispatches;
+        }
+      });
+  return total_us;
+}
+
+void ReportResult(const string& op, const string& shape,
+                  double gpu_us_per_iteration, uint64 dispatches) {
+  string line = strings::StrCat(
+      "{\"op\":\"", op, "\",\"shape\":\"", shape,
+      "\",\"iterations\":", kTimedIterations, ",\"dispatches\":", dispatches,
+      ",\"gpu_us_per_iteration\":", gpu_us_per_iteration, "}");
+  LOG(INFO) << "DML_BENCHMARK " << line;
+
+  string output_path;
+  TF_CHECK_OK(
+      ReadStringFromEnvVar("TF_DIRECTML_BENCHMARK_OUTPUT", "", &output_path));
+  if (!output_path.empty()) {
+    std::ofstream file(output_path, std::ios::app);
+    file << line << "\n";
+  }
+}
+
+// Runs `fetch` for kWarmupIterations untimed iterations (letting kernel
+// compilation, caching, and pool growth settle), then kTimedIterations timed
+// ones, and reports the captured GPU time per iteration.
+void RunBenchmark(const string& op, const string& shape,
+                  ClientSession* session, const ClientSession::FeedType& inputs,
+                  const Output& fetch) {
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kWarmupIterations; ++i) {
+    TF_CHECK_OK(session->Run(inputs, {fetch}, &outputs));
+  }
+
+  if (!StartGpuCapture()) {
+    LOG(WARNING) << "DML_BENCHMARK skipped " << op
+                 << ": no DML device supports timestamp queries";
+    return;
+  }
+
+  for (int i = 0; i < kTimedIterations; ++i) {
+    TF_CHECK_OK(session->Run(inputs, {fetch}, &outputs));
+  }
+
+  uint64 dispatches = 0;
+  double total_us = StopGpuCapture(&dispatches);
+  ReportResult(op, shape, total_us / kTimedIterations, dispatches);
+}
+
+Tensor RandomTensor(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+string ShapeString(const TensorShape& shape) {
+  string result;
+  for (int i = 0; i < shape.dims(); ++i) {
+    strings::StrAppend(&result, i > 0 ? "x" : "", shape.dim_size(i));
+  }
+  return result;
+}
+
+template <typename TOperator>
+void BenchmarkBinaryCwise(const string& op, const TensorShape& shape) {
+  Scope scope = Scope::NewRootScope().WithDevice("/device:DML:0");
+  auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+  auto b = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+  auto result = TOperator(scope, a, b);
+
+  ClientSession::FeedType inputs;
+  inputs.emplace(a, RandomTensor(shape));
+  inputs.emplace(b, RandomTensor(shape));
+
+  ClientSession session(scope);
+  RunBenchmark(op, ShapeString(shape), &session, inputs, result);
+}
+
+template <typename TOperator>
+void BenchmarkUnaryCwise(const string& op, const TensorShape& shape) {
+  Scope scope = Scope::NewRootScope().WithDevice("/device:DML:0");
+  auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+  auto result = TOperator(scope, a);
+
+  ClientSession::FeedType inputs;
+  inputs.emplace(a, RandomTensor(shape));
+
+  ClientSession session(scope);
+  RunBenchmark(op, ShapeString(shape), &session, inputs, result);
+}
+
+// The shape sets below bracket what our model zoo feeds these kernels: small
+// shapes are dominated by dispatch overhead, large ones by memory bandwidth
+// or ALU throughput, and a driver regression usually shows in only one of the
+// two regimes.
+const std::initializer_list<int64> kCwiseSizes = {1 << 12, 1 << 18, 1 << 24};
+
+TEST(DmlKernelBenchmarks, BinaryCwise) {
+  for (int64 size : kCwiseSizes) {
+    BenchmarkBinaryCwise<ops::AddV2>("AddV2", TensorShape({size}));
+    BenchmarkBinaryCwise<ops::Mul>("Mul", TensorShape({size}));
+    BenchmarkBinaryCwise<ops::RealDiv>("RealDiv", TensorShape({size}));
+  }
+}
+
+TEST(DmlKernelBenchmarks, UnaryCwise) {
+  for (int64 size : kCwiseSizes) {
+    BenchmarkUnaryCwise<ops::Tanh>("Tanh", TensorShape({size}));
+    BenchmarkUnaryCwise<ops::Sigmoid>("Sigmoid", TensorShape({size}));
+    BenchmarkUnaryCwise<ops::Sqrt>("Sqrt", TensorShape({size}));
+    BenchmarkUnaryCwise<ops::Relu>("Relu", TensorShape({size}));
+  }
+}
+
+TEST(DmlKernelBenchmarks, MatMul) {
+  for (int64 n : {256, 1024, 2048}) {
+    TensorShape shape({n, n});
+    Scope scope = Scope::NewRootScope().WithDevice("/device:DML:0");
+    auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    auto b = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    auto result = ops::MatMul(scope, a, b);
+
+    ClientSession::FeedType inputs;
+    inputs.emplace(a, RandomTensor(shape));
+    inputs.emplace(b, RandomTensor(shape));
+
+    ClientSession session(scope);
+    RunBenchmark("MatMul", ShapeString(shape), &session, inputs, result);
+  }
+}
+
+TEST(DmlKernelBenchmarks, Conv2D) {
+  struct Case {
+    TensorShape input;   // NHWC
+    TensorShape filter;  // HWIO
+  };
+  // A stem convolution, a mid-network 3x3, and a 1x1 bottleneck.
+  const Case cases[] = {
+      {TensorShape({1, 224, 224, 3}), TensorShape({7, 7, 3, 64})},
+      {TensorShape({1, 56, 56, 64}), TensorShape({3, 3, 64, 64})},
+      {TensorShape({1, 28, 28, 256}), TensorShape({1, 1, 256, 64})},
+  };
+
+  for (const Case& c : cases) {
+    Scope scope = Scope::NewRootScope().WithDevice("/device:DML:0");
+    auto input =
+        ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(c.input));
+    auto filter =
+        ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(c.filter));
+    auto result =
+        ops::Conv2D(scope, input, filter, {1, 1, 1, 1}, "SAME");
+
+    ClientSession::FeedType inputs;
+    inputs.emplace(input, RandomTensor(c.input));
+    inputs.emplace(filter, RandomTensor(c.filter));
+
+    ClientSession session(scope);
+    RunBenchmark(
+        "Conv2D",
+        strings::StrCat(ShapeString(c.input), "*", ShapeString(c.filter)),
+        &session, inputs, result);
+  }
+}
+
+TEST(DmlKernelBenchmarks, Reduction) {
+  for (int64 rows : {128, 4096}) {
+    TensorShape shape({rows, 1024});
+    Scope scope = Scope::NewRootScope().WithDevice("/device:DML:0");
+    auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    auto result = ops::Sum(scope, a, 1);
+
+    ClientSession::FeedType inputs;
+    inputs.emplace(a, RandomTensor(shape));
+
+    ClientSession session(scope);
+    RunBenchmark("Sum", ShapeString(shape), &session, inputs, result);
+  }
+}
+
+TEST(DmlKernelBenchmarks, Softmax) {
+  for (int64 classes : {1000, 32768}) {
+    TensorShape shape({64, classes});
+    Scope scope = Scope::NewRootScope().WithDevice("/device:DML:0");
+    auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    auto result = ops::Softmax(scope, a);
+
+    ClientSession::FeedType inputs;
+    inputs.emplace(a, RandomTensor(shape));
+
+    ClientSession session(scope);
+    RunBenchmark("Softmax", ShapeString(shape), &session, inputs, result);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dml/dml_tracing.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/util/env_var.h"
 
 #if _WIN32
 #include "tensorflow/core/platform/windows/wide_char.h"
@@ -214,6 +215,9 @@ void DmlKernel::Initialize(DmlKernelConstruction* ctx,
   DML_BINDING_PROPERTIES exec_binding_props =
       compiled_op_->GetBindingProperties();
 
+  // The persistent resource can't come from the scratch pool: DML owns its
+  // contents between dispatches (initialization writes operator state that
+  // every execute reads), so it has to stay live for the kernel's lifetime.
   if (exec_binding_props.PersistentResourceSize != 0) {
     VLOG(2) << "Allocating"
             << strings::HumanReadableNumBytes(
@@ -264,11 +268,13 @@ void DmlKernel::Initialize(DmlKernelConstruction* ctx,
       &binding_table_desc, IID_PPV_ARGS(&binding_table)));
 
   // Create a temporary resource for initializing the op, if it's required.
+  // Temporaries come from the device's scratch pool; they're only live while
+  // the dispatch executes, so cached kernels share them.
   UINT64 temporary_resource_size = init_binding_props.TemporaryResourceSize;
-  DmlBuffer temp_resource;
+  DmlScratchBuffer temp_resource;
   absl::optional<DML_BUFFER_BINDING> temp_resource_binding;
   if (temporary_resource_size > 0) {
-    temp_resource = ctx->AllocateDefaultBuffer(temporary_resource_size);
+    temp_resource = ctx->AllocateScratchBuffer(temporary_resource_size);
 
     OP_REQUIRES(ctx->GetOpKernelContext(), temp_resource,
                 errors::ResourceExhausted("OOM when allocating a buffer of ",
@@ -293,7 +299,24 @@ void DmlKernel::Initialize(DmlKernelConstruction* ctx,
   ctx->EnqueueCallbackForGpuEvent(init_gpu_event, on_initialize_completed);
 }
 
+void DmlKernel::SetChunkedExecution(uint32_t chunk_count,
+                                    uint64_t chunk_element_count,
+                                    uint64_t total_element_count) {
+  assert(compiled_op_);  // Initialize must be called first
+  assert(chunk_count > 1);
+  assert(chunk_element_count * (chunk_count - 1) < total_element_count);
+  assert(chunk_element_count * chunk_count >= total_element_count);
+
+  chunk_count_ = chunk_count;
+  chunk_element_count_ = chunk_element_count;
+  total_element_count_ = total_element_count;
+}
+
 StatusOr<DmlGpuEvent> DmlKernel::Compute(DmlKernelContext* ctx) const {
+  if (chunk_count_ > 1) {
+    return ComputeChunked(ctx);
+  }
+
   auto input_buffers = CreateInputBuffers(ctx);
   auto output_buffers = CreateOutputBuffers(ctx);
 
@@ -301,7 +324,359 @@ StatusOr<DmlGpuEvent> DmlKernel::Compute(DmlKernelContext* ctx) const {
   auto input_bindings = dml_util::GetBufferBindings(input_buffers);
   auto output_bindings = dml_util::GetBufferBindings(output_buffers);
 
-  return Compute(ctx, input_bindings, output_bindings);
+  // Under shape bucketing, a cached operator's tensor descs may describe more
+  // elements than the bound TF tensors hold, because the descs were built from
+  // bucket-padded shapes. Such tensors are staged through desc-sized pool
+  // buffers: inputs are copied in and their tails zeroed, and outputs are
+  // computed into staging with the true-size prefix copied back afterwards.
+  // Only the outermost dimension is ever padded, so a tensor's true data is
+  // always a contiguous prefix of its staging buffer. For unbucketed kernels,
+  // desc sizes never exceed tensor sizes and none of this triggers.
+  struct StagedOutputCopy {
+    ID3D12Resource* staging_resource;
+    uint64_t staging_offset;
+    D3D12BufferRegion dst;
+  };
+  absl::InlinedVector<DmlBuffer, 2> staging_buffers;
+  absl::InlinedVector<StagedOutputCopy, 2> output_copies;
+
+  for (size_t i = 0; i < input_descs_.size(); ++i) {
+    if (!input_descs_[i] || !input_bindings[i]) {
+      continue;
+    }
+
+    const uint64_t desc_size = input_descs_[i]->desc.GetBufferSizeInBytes();
+    const uint64_t tensor_size = input_buffers[i].SizeInBytes();
+    if (desc_size <= tensor_size) {
+      continue;
+    }
+
+    DmlBuffer staging = ctx->AllocateDefaultBuffer(desc_size);
+    if (!staging) {
+      return errors::ResourceExhausted(
+          "OOM when allocating a staging buffer of ", desc_size, " bytes");
+    }
+
+    ctx->CopyBufferToBuffer(staging.Resource(), staging.Offset(),
+                            input_buffers[i].Resource(),
+                            input_buffers[i].Offset(), tensor_size);
+    ctx->ZeroBuffer(staging.Resource(), staging.Offset() + tensor_size,
+                    desc_size - tensor_size);
+
+    input_bindings[i] = staging.GetBufferBinding();
+    staging_buffers.push_back(std::move(staging));
+  }
+
+  for (size_t i = 0; i < output_descs_.size(); ++i) {
+    if (!output_descs_[i] || !output_bindings[i]) {
+      continue;
+    }
+
+    const uint64_t desc_size = output_descs_[i]->desc.GetBufferSizeInBytes();
+    const uint64_t tensor_size = output_buffers[i].SizeInBytes();
+    if (desc_size <= tensor_size) {
+      continue;
+    }
+
+    DmlBuffer staging = ctx->AllocateDefaultBuffer(desc_size);
+    if (!staging) {
+      return errors::ResourceExhausted(
+          "OOM when allocating a staging buffer of ", desc_size, " bytes");
+    }
+
+    output_copies.push_back(
+        {staging.Resource(), staging.Offset(), output_buffers[i]});
+    output_bindings[i] = staging.GetBufferBinding();
+    staging_buffers.push_back(std::move(staging));
+  }
+
+  StatusOr<DmlGpuEvent> status_or_event =
+      Compute(ctx, input_bindings, output_bindings);
+
+  if (!status_or_event.ok() || output_copies.empty()) {
+    // The staging buffers return to the pool when this method exits; the pool
+    // keeps their memory alive until all recorded GPU work has completed.
+    return status_or_event;
+  }
+
+  // The compute queue executes in order, so these copies are correctly
+  // sequenced after the dispatch above - even when an output buffer aliases a
+  // forwarded input.
+  DmlGpuEvent gpu_event = status_or_event.ConsumeValueOrDie();
+  for (const StagedOutputCopy& copy : output_copies) {
+    gpu_event = ctx->CopyBufferToBuffer(copy.dst.Resource(), copy.dst.Offset(),
+                                        copy.staging_resource,
+                                        copy.staging_offset,
+                                        copy.dst.SizeInBytes());
+  }
+
+  return gpu_event;
+}
+
+StatusOr<DmlGpuEvent> DmlKernel::ComputeChunked(DmlKernelContext* ctx) const {
+  auto input_buffers = CreateInputBuffers(ctx);
+  auto output_buffers = CreateOutputBuffers(ctx);
+
+  DmlGpuEvent gpu_event = ctx->GetCurrentCompletionEvent();
+
+  for (uint64_t chunk = 0; chunk < chunk_count_; ++chunk) {
+    const uint64_t first_element = chunk * chunk_element_count_;
+    const uint64_t element_count =
+        std::min(chunk_element_count_, total_element_count_ - first_element);
+    const bool partial_chunk = element_count < chunk_element_count_;
+
+    // The compiled operator always describes a full chunk, so a partial final
+    // chunk is staged through chunk-sized scratch buffers, mirroring the
+    // bucket-padding staging in Compute: inputs are copied in with their tails
+    // zeroed, and outputs have the true-size prefix copied back afterwards.
+    struct StagedOutputCopy {
+      ID3D12Resource* staging_resource;
+      uint64_t staging_offset;
+      ID3D12Resource* dst_resource;
+      uint64_t dst_offset;
+      uint64_t size_in_bytes;
+    };
+    absl::InlinedVector<DmlBuffer, 2> staging_buffers;
+    absl::InlinedVector<StagedOutputCopy, 2> output_copies;
+
+    absl::InlinedVector<absl::optional<DML_BUFFER_BINDING>, 8> input_bindings(
+        input_descs_.size());
+    absl::InlinedVector<absl::optional<DML_BUFFER_BINDING>, 4> output_bindings(
+        output_descs_.size());
+
+    for (size_t i = 0; i < input_descs_.size(); ++i) {
+      if (!input_descs_[i] || !input_buffers[i]) {
+        continue;
+      }
+
+      const uint64_t desc_size = input_descs_[i]->desc.GetBufferSizeInBytes();
+
+      // Broadcast operands (e.g. a scalar) have descs far smaller than a
+      // chunk's element count; every chunk rebinds them unchanged.
+      if (desc_size < chunk_element_count_) {
+        input_bindings[i] = DML_BUFFER_BINDING{
+            input_buffers[i].Resource(), input_buffers[i].Offset(), desc_size};
+        continue;
+      }
+
+      const uint64_t element_size = desc_size / chunk_element_count_;
+      const uint64_t chunk_offset =
+          input_buffers[i].Offset() + first_element * element_size;
+
+      if (!partial_chunk) {
+        input_bindings[i] = DML_BUFFER_BINDING{input_buffers[i].Resource(),
+                                               chunk_offset, desc_size};
+        continue;
+      }
+
+      const uint64_t chunk_bytes = element_count * element_size;
+      DmlBuffer staging = ctx->AllocateDefaultBuffer(desc_size);
+      if (!staging) {
+        return errors::ResourceExhausted(
+            "OOM when allocating a staging buffer of ", desc_size, " bytes");
+      }
+
+      ctx->CopyBufferToBuffer(staging.Resource(), staging.Offset(),
+                              input_buffers[i].Resource(), chunk_offset,
+                              chunk_bytes);
+      ctx->ZeroBuffer(staging.Resource(), staging.Offset() + chunk_bytes,
+                      desc_size - chunk_bytes);
+
+      input_bindings[i] = staging.GetBufferBinding();
+      staging_buffers.push_back(std::move(staging));
+    }
+
+    for (size_t i = 0; i < output_descs_.size(); ++i) {
+      if (!output_descs_[i] || !output_buffers[i]) {
+        continue;
+      }
+
+      const uint64_t desc_size = output_descs_[i]->desc.GetBufferSizeInBytes();
+      const uint64_t element_size = desc_size / chunk_element_count_;
+      const uint64_t chunk_offset =
+          output_buffers[i].Offset() + first_element * element_size;
+
+      if (!partial_chunk) {
+        output_bindings[i] = DML_BUFFER_BINDING{output_buffers[i].Resource(),
+                                                chunk_offset, desc_size};
+        continue;
+      }
+
+      const uint64_t chunk_bytes = element_count * element_size;
+      DmlBuffer staging = ctx->AllocateDefaultBuffer(desc_size);
+      if (!staging) {
+        return errors::ResourceExhausted(
+            "OOM when allocating a staging buffer of ", desc_size, " bytes");
+      }
+
+      // Emulated 64-bit integer outputs write only one dword of each 8-byte
+      // element, relying on the kernel having pre-zeroed its output buffer;
+      // zero the staging buffer so the copy-back doesn't reintroduce garbage
+      // into the stride gaps.
+      ctx->ZeroBuffer(staging.Resource(), staging.Offset(), desc_size);
+
+      output_copies.push_back({staging.Resource(), staging.Offset(),
+                               output_buffers[i].Resource(), chunk_offset,
+                               chunk_bytes});
+      output_bindings[i] = staging.GetBufferBinding();
+      staging_buffers.push_back(std::move(staging));
+    }
+
+    StatusOr<DmlGpuEvent> status_or_event =
+        Compute(ctx, input_bindings, output_bindings);
+    if (!status_or_event.ok()) {
+      return status_or_event;
+    }
+    gpu_event = status_or_event.ConsumeValueOrDie();
+
+    // The compute queue executes in order, so these copies are correctly
+    // sequenced after the dispatch above, and the staging buffers return to
+    // the pool which keeps their memory alive until the GPU is done with them.
+    for (const StagedOutputCopy& copy : output_copies) {
+      gpu_event = ctx->CopyBufferToBuffer(copy.dst_resource, copy.dst_offset,
+                                          copy.staging_resource,
+                                          copy.staging_offset,
+                                          copy.size_in_bytes);
+    }
+  }
+
+  return gpu_event;
+}
+
+// When enabled, each kernel records its dispatch into a private command list
+// once and replays it on subsequent steps, rewriting only the buffer bindings.
+// This trades descriptor and temporary-buffer pooling (the replay state pins
+// both for the lifetime of the kernel) for eliminating per-step command list
+// recording, which dominates CPU time for small, repeatedly executed models.
+static bool ReusableCommandListsEnabled() {
+  static bool enabled = [] {
+    bool value = false;
+    Status s = ReadBoolFromEnvVar("TF_DIRECTML_REUSABLE_COMMAND_LISTS", false,
+                                  &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+absl::optional<DmlGpuEvent> DmlKernel::TryReplayCompute(
+    DmlKernelContext* ctx,
+    absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
+    absl::Span<const absl::optional<DML_BUFFER_BINDING>> output_bindings)
+    const {
+  // If another thread is concurrently replaying this kernel (kernels can be
+  // shared across nodes), fall back to the regular path rather than blocking.
+  std::unique_lock<std::mutex> lock(replay_.mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return absl::nullopt;
+  }
+
+  // Rewriting the binding table updates the pinned descriptors in place, so
+  // it's only safe once the previous replay has finished executing on the
+  // GPU. When the kernel is executed faster than the GPU can retire it (e.g.
+  // twice in one batch), fall back to the regular path, which allocates fresh
+  // descriptors per dispatch.
+  if (replay_.recorded && replay_.last_replay_event.fence &&
+      !replay_.last_replay_event.IsSignaled()) {
+    return absl::nullopt;
+  }
+
+  DML_BINDING_PROPERTIES exec_binding_props =
+      compiled_op_->GetBindingProperties();
+
+  if (!replay_.recorded) {
+    // Pin a descriptor range for the lifetime of the kernel.
+    replay_.descriptors = ctx->AllocateDescriptors(
+        exec_binding_props.RequiredDescriptorCount);
+  }
+
+  // The temporary resource comes from the device's scratch pool per replay
+  // rather than being pinned alongside the descriptors: the binding table is
+  // rewritten each replay anyway, so nothing in the recorded command list
+  // depends on the buffer's address, and pooling keeps cached-but-idle
+  // kernels from each sitting on their own scratch. On OOM, fall back so the
+  // regular path can report the error.
+  DmlScratchBuffer temp_resource;
+  if (exec_binding_props.TemporaryResourceSize > 0) {
+    temp_resource =
+        ctx->AllocateScratchBuffer(exec_binding_props.TemporaryResourceSize);
+    if (!temp_resource) {
+      return absl::nullopt;
+    }
+  }
+
+  D3D12DescriptorHandles descriptor_handles =
+      replay_.descriptors.GetDescriptorHandles();
+
+  DML_BINDING_TABLE_DESC binding_table_desc = {};
+  binding_table_desc.Dispatchable = compiled_op_.Get();
+  binding_table_desc.CPUDescriptorHandle = descriptor_handles.cpu;
+  binding_table_desc.GPUDescriptorHandle = descriptor_handles.gpu;
+  binding_table_desc.SizeInDescriptors =
+      exec_binding_props.RequiredDescriptorCount;
+
+  if (!replay_.binding_table) {
+    DML_CHECK_SUCCEEDED(ctx->GetDmlDevice()->CreateBindingTable(
+        &binding_table_desc, IID_PPV_ARGS(&replay_.binding_table)));
+  } else {
+    DML_CHECK_SUCCEEDED(replay_.binding_table->Reset(&binding_table_desc));
+  }
+
+  absl::optional<DML_BUFFER_BINDING> temp_resource_binding;
+  if (temp_resource) {
+    temp_resource_binding = temp_resource.GetBufferBinding();
+  }
+
+  // Rewrite the bindings for this step. Because the command list references
+  // the descriptors (not the binding table), the recorded dispatch picks up
+  // the new buffer addresses without being re-recorded.
+  DmlKernelContext::UpdateBindings(
+      replay_.binding_table.Get(),
+      temp_resource_binding ? &*temp_resource_binding : nullptr,
+      GetPersistentResourceBinding(), input_bindings, output_bindings);
+
+  if (!replay_.recorded) {
+    D3D12_COMMAND_LIST_TYPE list_type = ctx->GetCommandListTypeForQueue();
+    ID3D12Device* d3d_device = ctx->GetD3D12Device();
+
+    DML_CHECK_SUCCEEDED(d3d_device->CreateCommandAllocator(
+        list_type, IID_PPV_ARGS(&replay_.command_allocator)));
+    DML_CHECK_SUCCEEDED(d3d_device->CreateCommandList(
+        0, list_type, replay_.command_allocator.Get(), nullptr,
+        IID_PPV_ARGS(&replay_.command_list)));
+
+    ComPtr<IDMLCommandRecorder> recorder;
+    DML_CHECK_SUCCEEDED(
+        ctx->GetDmlDevice()->CreateCommandRecorder(IID_PPV_ARGS(&recorder)));
+
+    ID3D12DescriptorHeap* descriptor_heaps[] = {descriptor_handles.heap};
+    replay_.command_list->SetDescriptorHeaps(ABSL_ARRAYSIZE(descriptor_heaps),
+                                             descriptor_heaps);
+
+    recorder->RecordDispatch(replay_.command_list.Get(), compiled_op_.Get(),
+                             replay_.binding_table.Get());
+
+    // Barrier all outputs, matching what DmlCommandList::ExecuteOperator
+    // records on the regular path.
+    D3D12_RESOURCE_BARRIER barriers[] = {
+        CD3DX12_RESOURCE_BARRIER::UAV(nullptr),
+        CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, nullptr)};
+    replay_.command_list->ResourceBarrier(ABSL_ARRAYSIZE(barriers), barriers);
+
+    DML_CHECK_SUCCEEDED(replay_.command_list->Close());
+    replay_.recorded = true;
+  }
+
+  // The kernel's ComPtr keeps the command list alive until the kernel is
+  // destroyed, which the kernel manager defers until all of the kernel's GPU
+  // work has completed.
+  DmlGpuEvent gpu_event =
+      ctx->ExecutePrerecordedCommandList(replay_.command_list);
+  replay_.last_replay_event = gpu_event;
+
+  return gpu_event;
 }
 
 StatusOr<DmlGpuEvent> DmlKernel::Compute(
@@ -309,6 +684,14 @@ StatusOr<DmlGpuEvent> DmlKernel::Compute(
     absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
     absl::Span<const absl::optional<DML_BUFFER_BINDING>> output_bindings)
     const {
+  if (ReusableCommandListsEnabled()) {
+    absl::optional<DmlGpuEvent> replayed =
+        TryReplayCompute(ctx, input_bindings, output_bindings);
+    if (replayed) {
+      return *replayed;
+    }
+  }
+
   DML_BINDING_PROPERTIES exec_binding_props =
       compiled_op_->GetBindingProperties();
 
@@ -333,15 +716,15 @@ StatusOr<DmlGpuEvent> DmlKernel::Compute(
 
   // Create a temporary resource for executing the op, if it's required.
   UINT64 temporary_resource_size = exec_binding_props.TemporaryResourceSize;
-  DmlBuffer temp_resource;
+  DmlScratchBuffer temp_resource;
   absl::optional<DML_BUFFER_BINDING> temp_resource_binding;
   if (temporary_resource_size > 0) {
-    // Allocate a temporary buffer and keep a use on it until the end of this
-    // method. The buffer resource will still be alive (managed by the pool);
-    // freeing allows the resource to be shared with other operators, but
-    // because the allocator is multi-threaded we need to at least keep a use on
-    // it until we're done with it locally to prevent the buffer being reused.
-    temp_resource = ctx->AllocateDefaultBuffer(temporary_resource_size);
+    // Acquire a scratch buffer and keep a use on it until the end of this
+    // method, i.e. until the dispatch binding it has been queued. Returning
+    // it to the pool then lets the very next dispatch reuse it: the execution
+    // context serializes dispatches, so the two uses can never overlap on the
+    // GPU.
+    temp_resource = ctx->AllocateScratchBuffer(temporary_resource_size);
     if (!temp_resource) {
       return errors::ResourceExhausted("OOM when allocating a buffer of ",
                                        temporary_resource_size, " bytes");
@@ -405,6 +788,11 @@ const DML_BUFFER_BINDING* DmlKernel::GetPersistentResourceBinding() const {
                                       : nullptr;
 }
 
+uint64_t DmlKernel::GetPersistentResourceSize() const {
+  return persistent_resource_binding_ ? persistent_resource_binding_->SizeInBytes
+                                      : 0;
+}
+
 /*static*/ absl::InlinedVector<DML_TENSOR_DESC, 8> DmlKernel::GetDmlTensorDescs(
     absl::Span<absl::optional<DmlTensorInfo>> tensor_infos) {
   absl::InlinedVector<DML_TENSOR_DESC, 8> descs;
@@ -16,6 +16,8 @@ limitations under the License.
 
 #pragma once
 
+#include <mutex>
+
 #include "tensorflow/core/common_runtime/dml/dml_common.h"
 #include "tensorflow/core/common_runtime/dml/dml_device.h"
 #include "tensorflow/core/common_runtime/dml/dml_kernel_context.h"
@@ -150,6 +152,20 @@ class DmlKernel {
   void Initialize(DmlKernelConstruction* ctx, DmlKernelTensors&& tensor_descs,
                   IDMLCompiledOperator* compiled_op);
 
+  // Opts this kernel into chunked execution, for tensors too large for a
+  // single DML dispatch (more than kMaxDmlElementsPerDispatch elements).
+  // Callers must have built their tensor descs over a flattened chunk-sized
+  // shape of `chunk_element_count` elements (broadcast operands keep their
+  // descs); Compute then dispatches the compiled operator `chunk_count` times,
+  // advancing every non-broadcast binding by one chunk's worth of bytes each
+  // time. The final chunk, if partial, is staged through chunk-sized scratch
+  // buffers. Only kernels that compute each output element purely from the
+  // corresponding element of their (possibly broadcast) inputs may use this;
+  // any cross-element dependency would be severed at chunk boundaries. Must be
+  // called after Initialize.
+  void SetChunkedExecution(uint32_t chunk_count, uint64_t chunk_element_count,
+                           uint64_t total_element_count);
+
   // For ops that skip the DML graph (e.g. BlockLSTM in seq_len_max==0 case)
   void InitializeAsNoOp(DmlKernelConstruction* ctx) {
     init_helper_ = ctx->GetInitializationHelper();
@@ -176,15 +192,60 @@ class DmlKernel {
 
   const DML_BUFFER_BINDING* GetPersistentResourceBinding() const;
 
+  // Size in bytes of the persistent resource this kernel pins on the device,
+  // or zero if the compiled operator doesn't require one.
+  uint64_t GetPersistentResourceSize() const;
+
   IDMLCompiledOperator* GetCompiledOp() const { return compiled_op_.Get(); }
 
  private:
+  // The chunked analogue of Compute: dispatches the compiled operator once per
+  // chunk over successive sub-regions of the bound buffers.
+  StatusOr<DmlGpuEvent> ComputeChunked(DmlKernelContext* ctx) const;
+
+  // State for the record-once/replay-many execution path (enabled with
+  // TF_DIRECTML_REUSABLE_COMMAND_LISTS). The dispatch of compiled_op_ is
+  // recorded into a private command list exactly once, referencing a pinned
+  // descriptor range; on each subsequent Compute, only the binding table is
+  // rewritten (which updates the pinned descriptors in place) and the closed
+  // command list is re-submitted as-is.
+  struct ReplayableDispatch {
+    std::mutex mutex;
+    bool recorded = false;
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> command_allocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> command_list;
+    Microsoft::WRL::ComPtr<IDMLBindingTable> binding_table;
+    DescriptorAllocation descriptors;
+    DmlGpuEvent last_replay_event;
+  };
+
+  // Attempts to execute this kernel by replaying its pre-recorded command
+  // list, recording it first if this is the first call. Returns nullopt when
+  // replaying isn't currently possible (e.g. the previous replay hasn't
+  // completed on the GPU yet), in which case the caller must fall back to
+  // recording the dispatch normally.
+  absl::optional<DmlGpuEvent> TryReplayCompute(
+      DmlKernelContext* ctx,
+      absl::Span<const absl::optional<DML_BUFFER_BINDING>> input_bindings,
+      absl::Span<const absl::optional<DML_BUFFER_BINDING>> output_bindings)
+      const;
+
   Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op_;
 
+  // Compute is const and thread-safe, but the replay state is inherently
+  // mutable; it synchronizes via its own mutex.
+  mutable ReplayableDispatch replay_;
+
   DmlBuffer persistent_resource_;
   absl::optional<DML_BUFFER_BINDING> persistent_resource_binding_;
   std::shared_ptr<const InitializationHelper> init_helper_;
 
+  // Chunked execution state; see SetChunkedExecution. A chunk count of 1
+  // means the kernel executes in a single dispatch as usual.
+  uint32_t chunk_count_ = 1;
+  uint64_t chunk_element_count_ = 0;
+  uint64_t total_element_count_ = 0;
+
   // The order and count of these descs match the DML operator, which might be
   // different to the order/number of inputs TF supplies to the kernel. Each
   // DmlTensorInfo contains an index which maps the DML input to the correct
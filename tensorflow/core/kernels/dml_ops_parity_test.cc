@@ -0,0 +1,308 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// DML-vs-CPU per-op performance parity report. Each case builds the same
+// small graph twice - once pinned to /device:CPU:0 and once to /device:DML:0
+// - and compares wall time per Session::Run across a shape sweep. Wall time
+// (rather than the GPU-only time dml_ops_benchmark_test.cc measures) is
+// deliberate: it is the quantity placement actually trades off, including
+// dispatch and transfer overhead. A coverage pass additionally walks the
+// kernel registry and reports every op with a CPU kernel but no DML
+// registration, since those silently fall back to the CPU no matter where the
+// graph is placed.
+//
+// Results are logged as one JSON object per line prefixed with "DML_PARITY",
+// and appended to the file named by the TF_DIRECTML_PARITY_OUTPUT environment
+// variable when it is set, so the placement override list can be regenerated
+// mechanically from a run on the target hardware.
+
+#include <fstream>
+#include <set>
+
+#include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/kernel_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/env_var.h"
+
+#ifdef WIN32
+// This is necessary for the linker to find htonl and friends
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+
+namespace tensorflow {
+namespace {
+
+constexpr int kWarmupIterations = 5;
+constexpr int kTimedIterations = 50;
+
+// DML within 20% of CPU still counts as parity; wall times at these
+// iteration counts are noisy enough that a tighter bar flags ties.
+constexpr double kSlowdownTolerance = 1.2;
+
+// Builds a graph on a scope and returns the output to fetch, filling `inputs`
+// with feed tensors for any placeholders it created.
+using GraphBuilder =
+    std::function<Output(const Scope& scope, ClientSession::FeedType* inputs)>;
+
+void WriteReportLine(const string& line) {
+  LOG(INFO) << "DML_PARITY " << line;
+
+  string output_path;
+  TF_CHECK_OK(
+      ReadStringFromEnvVar("TF_DIRECTML_PARITY_OUTPUT", "", &output_path));
+  if (!output_path.empty()) {
+    std::ofstream file(output_path, std::ios::app);
+    file << line << "\n";
+  }
+}
+
+// Builds the case's graph pinned to `device` and measures average wall time
+// per Run in microseconds. Returns non-OK if the graph can't run there at all
+// (e.g. no kernel for that device), which the caller reports as a fallback.
+Status TimeOnDevice(const string& device, const GraphBuilder& builder,
+                    double* avg_us) {
+  Scope scope = Scope::NewRootScope().WithDevice(device);
+  ClientSession::FeedType inputs;
+  Output fetch = builder(scope, &inputs);
+  TF_RETURN_IF_ERROR(scope.status());
+
+  ClientSession session(scope);
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kWarmupIterations; ++i) {
+    TF_RETURN_IF_ERROR(session.Run(inputs, {fetch}, &outputs));
+  }
+
+  const uint64 start_us = Env::Default()->NowMicros();
+  for (int i = 0; i < kTimedIterations; ++i) {
+    TF_RETURN_IF_ERROR(session.Run(inputs, {fetch}, &outputs));
+  }
+  *avg_us = (Env::Default()->NowMicros() - start_us) /
+            static_cast<double>(kTimedIterations);
+  return Status::OK();
+}
+
+// Times one op/shape case on the CPU and on DML and reports the outcome:
+// "ok" (parity or better), "underperforms" (DML slower than CPU beyond the
+// tolerance), or "no_dml_kernel" (the case wouldn't run on DML at all).
+void RunParityCase(const string& op, const string& shape,
+                   const GraphBuilder& builder) {
+  double cpu_us = 0;
+  TF_CHECK_OK(TimeOnDevice("/device:CPU:0", builder, &cpu_us));
+
+  double dml_us = 0;
+  Status dml_status = TimeOnDevice("/device:DML:0", builder, &dml_us);
+  if (!dml_status.ok()) {
+    WriteReportLine(strings::StrCat("{\"op\":\"", op, "\",\"shape\":\"", shape,
+                                    "\",\"cpu_us\":", cpu_us,
+                                    ",\"verdict\":\"no_dml_kernel\"}"));
+    return;
+  }
+
+  const double ratio = cpu_us > 0 ? dml_us / cpu_us : 0;
+  const char* verdict = ratio > kSlowdownTolerance ? "underperforms" : "ok";
+  WriteReportLine(strings::StrCat(
+      "{\"op\":\"", op, "\",\"shape\":\"", shape, "\",\"cpu_us\":", cpu_us,
+      ",\"dml_us\":", dml_us, ",\"dml_vs_cpu\":", ratio, ",\"verdict\":\"",
+      verdict, "\"}"));
+}
+
+Tensor RandomTensor(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+string ShapeString(const TensorShape& shape) {
+  string result;
+  for (int i = 0; i < shape.dims(); ++i) {
+    strings::StrAppend(&result, i > 0 ? "x" : "", shape.dim_size(i));
+  }
+  return result;
+}
+
+template <typename TOperator>
+GraphBuilder BinaryCwiseBuilder(const TensorShape& shape) {
+  return [shape](const Scope& scope, ClientSession::FeedType* inputs) {
+    auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    auto b = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    inputs->emplace(a, RandomTensor(shape));
+    inputs->emplace(b, RandomTensor(shape));
+    return Output(TOperator(scope, a, b));
+  };
+}
+
+template <typename TOperator>
+GraphBuilder UnaryCwiseBuilder(const TensorShape& shape) {
+  return [shape](const Scope& scope, ClientSession::FeedType* inputs) {
+    auto a = ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+    inputs->emplace(a, RandomTensor(shape));
+    return Output(TOperator(scope, a));
+  };
+}
+
+// The sweep brackets dispatch-bound (small) and bandwidth/ALU-bound (large)
+// regimes; DML commonly loses only the small end, where per-dispatch
+// overhead dominates.
+const std::initializer_list<int64> kCwiseSizes = {1 << 10, 1 << 16, 1 << 22};
+
+TEST(DmlParity, BinaryCwise) {
+  for (int64 size : kCwiseSizes) {
+    TensorShape shape({size});
+    RunParityCase("AddV2", ShapeString(shape),
+                  BinaryCwiseBuilder<ops::AddV2>(shape));
+    RunParityCase("Mul", ShapeString(shape),
+                  BinaryCwiseBuilder<ops::Mul>(shape));
+    RunParityCase("RealDiv", ShapeString(shape),
+                  BinaryCwiseBuilder<ops::RealDiv>(shape));
+  }
+}
+
+TEST(DmlParity, UnaryCwise) {
+  for (int64 size : kCwiseSizes) {
+    TensorShape shape({size});
+    RunParityCase("Tanh", ShapeString(shape),
+                  UnaryCwiseBuilder<ops::Tanh>(shape));
+    RunParityCase("Sigmoid", ShapeString(shape),
+                  UnaryCwiseBuilder<ops::Sigmoid>(shape));
+    RunParityCase("Relu", ShapeString(shape),
+                  UnaryCwiseBuilder<ops::Relu>(shape));
+    RunParityCase("Exp", ShapeString(shape),
+                  UnaryCwiseBuilder<ops::Exp>(shape));
+  }
+}
+
+TEST(DmlParity, MatMul) {
+  for (int64 n : {64, 512, 2048}) {
+    TensorShape shape({n, n});
+    RunParityCase(
+        "MatMul", ShapeString(shape),
+        [shape](const Scope& scope, ClientSession::FeedType* inputs) {
+          auto a =
+              ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+          auto b =
+              ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+          inputs->emplace(a, RandomTensor(shape));
+          inputs->emplace(b, RandomTensor(shape));
+          return Output(ops::MatMul(scope, a, b));
+        });
+  }
+}
+
+TEST(DmlParity, Conv2D) {
+  struct Case {
+    TensorShape input;   // NHWC
+    TensorShape filter;  // HWIO
+  };
+  // A stem convolution, a mid-network 3x3, and a 1x1 bottleneck.
+  const Case cases[] = {
+      {TensorShape({1, 224, 224, 3}), TensorShape({7, 7, 3, 64})},
+      {TensorShape({1, 56, 56, 64}), TensorShape({3, 3, 64, 64})},
+      {TensorShape({1, 28, 28, 256}), TensorShape({1, 1, 256, 64})},
+  };
+
+  for (const Case& c : cases) {
+    RunParityCase(
+        "Conv2D", strings::StrCat(ShapeString(c.input), "*",
+                                  ShapeString(c.filter)),
+        [c](const Scope& scope, ClientSession::FeedType* inputs) {
+          auto input = ops::Placeholder(scope, DT_FLOAT,
+                                        ops::Placeholder::Shape(c.input));
+          auto filter = ops::Placeholder(scope, DT_FLOAT,
+                                         ops::Placeholder::Shape(c.filter));
+          inputs->emplace(input, RandomTensor(c.input));
+          inputs->emplace(filter, RandomTensor(c.filter));
+          return Output(
+              ops::Conv2D(scope, input, filter, {1, 1, 1, 1}, "SAME"));
+        });
+  }
+}
+
+TEST(DmlParity, Reduction) {
+  for (int64 rows : {32, 4096}) {
+    TensorShape shape({rows, 1024});
+    RunParityCase(
+        "Sum", ShapeString(shape),
+        [shape](const Scope& scope, ClientSession::FeedType* inputs) {
+          auto a =
+              ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+          inputs->emplace(a, RandomTensor(shape));
+          return Output(ops::Sum(scope, a, 1));
+        });
+  }
+}
+
+TEST(DmlParity, Softmax) {
+  for (int64 classes : {1000, 32768}) {
+    TensorShape shape({64, classes});
+    RunParityCase(
+        "Softmax", ShapeString(shape),
+        [shape](const Scope& scope, ClientSession::FeedType* inputs) {
+          auto a =
+              ops::Placeholder(scope, DT_FLOAT, ops::Placeholder::Shape(shape));
+          inputs->emplace(a, RandomTensor(shape));
+          return Output(ops::Softmax(scope, a));
+        });
+  }
+}
+
+// Walks the kernel registry (the REGISTER_KERNEL_BUILDER set, which for DML
+// comes from the dml_*.cc kernels) and reports every op that has a CPU kernel
+// but no DML one. Those ops run on the CPU via fallback regardless of
+// placement; the full per-op list goes only to the report file since it runs
+// to hundreds of entries.
+TEST(DmlParity, KernelCoverage) {
+  std::set<string> dml_ops;
+  std::set<string> cpu_ops;
+  for (const KernelDef& kernel : GetAllRegisteredKernels().kernel()) {
+    if (kernel.device_type() == DEVICE_DML) {
+      dml_ops.insert(kernel.op());
+    } else if (kernel.device_type() == DEVICE_CPU) {
+      cpu_ops.insert(kernel.op());
+    }
+  }
+  ASSERT_FALSE(dml_ops.empty()) << "No DML kernels are registered; this test "
+                                   "must be built with --config=dml.";
+
+  string output_path;
+  TF_CHECK_OK(
+      ReadStringFromEnvVar("TF_DIRECTML_PARITY_OUTPUT", "", &output_path));
+  std::ofstream file;
+  if (!output_path.empty()) {
+    file.open(output_path, std::ios::app);
+  }
+
+  int fallback_count = 0;
+  for (const string& op : cpu_ops) {
+    if (dml_ops.count(op) == 0) {
+      ++fallback_count;
+      if (file.is_open()) {
+        file << "{\"op\":\"" << op << "\",\"verdict\":\"cpu_only\"}\n";
+      }
+    }
+  }
+
+  LOG(INFO) << "DML_PARITY coverage: " << dml_ops.size()
+            << " ops with DML kernels, " << fallback_count
+            << " CPU-registered ops without a DML kernel.";
+}
+
+}  // namespace
+}  // namespace tensorflow
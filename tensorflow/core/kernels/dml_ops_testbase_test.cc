@@ -0,0 +1,124 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Targeted single-kernel tests on the DML device through OpsTestBase. Unlike
+// the session-level suites (dml_ops_simple_test.cc, dml_ops_benchmark_test.cc)
+// these run one OpKernel directly - no graph, executor, or placer - so a slow
+// or wrong kernel reported against a model can be reproduced in isolation.
+// RunOpKernelBenchmark reports wall and GPU time side by side, which is the
+// measurement we attach to kernel performance tickets.
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+#ifdef WIN32
+// This is necessary for the linker to find htonl and friends
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+
+namespace tensorflow {
+namespace {
+
+class DmlOpsTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    std::unique_ptr<Device> device = DeviceFactory::NewDevice(
+        DEVICE_DML, {}, "/job:localhost/replica:0/task:0");
+    if (!device) {
+      LOG(WARNING) << "No DML device is available; skipping.";
+      return;
+    }
+    SetDevice(DeviceType(DEVICE_DML), std::move(device));
+    has_device_ = true;
+  }
+
+  bool has_device_ = false;
+};
+
+TEST_F(DmlOpsTest, AddV2) {
+  if (!has_device_) return;
+
+  TF_ASSERT_OK(NodeDefBuilder("add", "AddV2")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  AddInputFromArray<float>(TensorShape({2, 2}), {1.0f, 2.0f, 3.0f, 4.0f});
+  AddInputFromArray<float>(TensorShape({2, 2}), {5.0f, 6.0f, 7.0f, 8.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {6.0f, 8.0f, 10.0f, 12.0f});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+// ClipByValue takes its min and max as host-memory tensors, exercising the
+// harness's handling of mixed host/device kernel inputs.
+TEST_F(DmlOpsTest, ClipByValue) {
+  if (!has_device_) return;
+
+  TF_ASSERT_OK(NodeDefBuilder("clip", "ClipByValue")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  AddInputFromArray<float>(TensorShape({2, 2}), {-1.0f, 0.25f, 0.75f, 2.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0.0f, 0.25f, 0.75f, 1.0f});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+// Example of the measurement we expect on a kernel performance ticket. The
+// DML_BENCHMARK line matches the format used by dml_ops_benchmark_test.cc so
+// the same tooling can collect both.
+TEST_F(DmlOpsTest, BenchmarkRelu) {
+  if (!has_device_) return;
+
+  TF_ASSERT_OK(NodeDefBuilder("relu", "Relu")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int64 size = 1 << 20;
+  AddInput<float>(TensorShape({size}),
+                  [](int i) { return static_cast<float>(i % 7) - 3.0f; });
+
+  double wall_us = 0;
+  double gpu_us = 0;
+  TF_ASSERT_OK(RunOpKernelBenchmark(/*warmup_iters=*/5, /*timed_iters=*/20,
+                                    &wall_us, &gpu_us));
+  EXPECT_GT(wall_us, 0.0);
+
+  LOG(INFO) << "DML_BENCHMARK "
+            << strings::StrCat("{\"op\":\"Relu\",\"shape\":\"", size,
+                               "\",\"iterations\":20,\"wall_us_per_iteration\":",
+                               wall_us, ",\"gpu_us_per_iteration\":", gpu_us,
+                               "}");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,769 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
+#include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/dml_kernel_wrapper.h"
+#include "tensorflow/core/kernels/dml_ops_common.h"
+#include "tensorflow/core/util/tensor_format.h"
+
+namespace tensorflow {
+
+// The DML quantized kernels run the integer math on the GPU and keep TF's
+// min/max range bookkeeping on the host: the range inputs are declared as
+// constant CPU inputs (so their values are available at kernel construction
+// and form part of the kernel cache key) and the range outputs are computed
+// on the host exactly as the CPU reference kernels do.
+
+// The quantized value that represents 0.0f in a MIN_COMBINED quint8 range.
+// Mirrors FloatToQuantizedUnclamped<quint8> in quantization_utils.h, which
+// the CPU quantized kernels use to derive their input offsets.
+static int64 QuantizedZeroPointForRange(float range_min, float range_max) {
+  if (range_min == range_max) {
+    return 0;
+  }
+  const int64 number_of_steps = static_cast<int64>(1) << 8;
+  const double range_adjust = number_of_steps / (number_of_steps - 1.0);
+  const double range = (range_max - range_min) * range_adjust;
+  const double range_scale = number_of_steps / range;
+  return -static_cast<int64>(std::round(range_min * range_scale));
+}
+
+// DML zero-point tensors are uint8, so unlike the CPU kernels (which carry
+// the offset in int32 arithmetic) the quantization range must contain zero.
+// Ranges produced by TF's quantization tooling always do.
+static Status QuantizedZeroPoint(float range_min, float range_max,
+                                 const char* tensor_name, uint8* zero_point) {
+  int64 zp = QuantizedZeroPointForRange(range_min, range_max);
+  if (zp < 0 || zp > 255) {
+    return errors::InvalidArgument(
+        "DML quantized kernels require the ", tensor_name, " range [",
+        range_min, ", ", range_max,
+        "] to contain zero so its zero point fits in uint8.");
+  }
+  *zero_point = static_cast<uint8>(zp);
+  return Status::OK();
+}
+
+// Mirrors QuantizationRangeForMultiplication<quint8, quint8, qint32> in
+// quantization_utils.h: the qint32 product range is chosen so one quantized
+// level equals the product of one input level and one filter level.
+static void QuantizedMultiplicationRange(float min_a, float max_a, float min_b,
+                                         float max_b, float* min_out,
+                                         float* max_out) {
+  const float a_level = (max_a - min_a) / 255.0f;
+  const float b_level = (max_b - min_b) / 255.0f;
+  const float out_level = a_level * b_level;
+  *min_out = out_level * std::numeric_limits<int32>::lowest();
+  *max_out = out_level * std::numeric_limits<int32>::max();
+}
+
+static Status ValidateScalarRange(OpKernelContext* ctx, int min_index,
+                                  int max_index, const char* tensor_name) {
+  if (!TensorShapeUtils::IsScalar(ctx->input(min_index).shape()) ||
+      !TensorShapeUtils::IsScalar(ctx->input(max_index).shape())) {
+    return errors::InvalidArgument("The min and max of the ", tensor_name,
+                                   " range must be scalars.");
+  }
+  return Status::OK();
+}
+
+class QuantizedConv2DInitHelper : public InitializationHelper {
+ public:
+  struct Attributes {
+    explicit Attributes(OpKernelConstruction* ctx) {
+      std::vector<int32> strides;
+      std::vector<int32> dilations;
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("strides", &strides));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("dilations", &dilations));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("padding", &padding));
+
+      OP_REQUIRES(ctx, strides.size() == 4,
+                  errors::InvalidArgument("Sliding window strides field must "
+                                          "specify 4 dimensions"));
+      OP_REQUIRES(ctx, dilations.size() == 4,
+                  errors::InvalidArgument("Sliding window dilations field must "
+                                          "specify 4 dimensions"));
+
+      // QuantizedConv2D is NHWC-only.
+      OP_REQUIRES(ctx, strides[0] == 1 && strides[3] == 1,
+                  errors::InvalidArgument(
+                      "Current implementation does not yet support "
+                      "strides in the batch and depth dimensions."));
+      OP_REQUIRES(ctx, dilations[0] == 1 && dilations[3] == 1,
+                  errors::InvalidArgument(
+                      "Current implementation does not yet support "
+                      "dilations in the batch and depth dimensions."));
+
+      stride_h = strides[1];
+      stride_w = strides[2];
+      dilation_h = dilations[1];
+      dilation_w = dilations[2];
+    }
+
+    Padding padding;
+    int32 stride_h;
+    int32 stride_w;
+    int32 dilation_h;
+    int32 dilation_w;
+  };
+
+  QuantizedConv2DInitHelper(OpKernelContext* ctx,
+                            std::shared_ptr<const Attributes> attr)
+      : attr_(attr) {
+    const Tensor& input = ctx->input(0);
+    const Tensor& filter = ctx->input(1);
+
+    OP_REQUIRES(ctx, input.dims() == 4,
+                errors::InvalidArgument("input must be 4-dimensional",
+                                        input.shape().DebugString()));
+    OP_REQUIRES(ctx, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+    OP_REQUIRES(ctx, input.dim_size(3) == filter.dim_size(2),
+                errors::InvalidArgument(
+                    "input and filter must have the same depth: ",
+                    input.dim_size(3), " vs ", filter.dim_size(2)));
+
+    // An empty conv would otherwise take the no-op'd kernel path, which
+    // can't produce the host-side range outputs.
+    OP_REQUIRES(ctx, input.NumElements() > 0 && filter.NumElements() > 0,
+                errors::InvalidArgument(
+                    "DML doesn't support empty tensors for QuantizedConv2D"));
+
+    batch_ = input.dim_size(0);
+    out_depth_ = filter.dim_size(3);
+
+    OP_REQUIRES_OK(ctx, GetWindowedOutputSizeVerboseV2(
+                            input.dim_size(1), filter.dim_size(0),
+                            attr->dilation_h, attr->stride_h, attr->padding,
+                            &out_rows_, &pad_rows_before_, &pad_rows_after_));
+    OP_REQUIRES_OK(ctx, GetWindowedOutputSizeVerboseV2(
+                            input.dim_size(2), filter.dim_size(1),
+                            attr->dilation_w, attr->stride_w, attr->padding,
+                            &out_cols_, &pad_cols_before_, &pad_cols_after_));
+
+    OP_REQUIRES_OK(ctx, ValidateScalarRange(ctx, 2, 3, "input"));
+    OP_REQUIRES_OK(ctx, ValidateScalarRange(ctx, 4, 5, "filter"));
+
+    const float min_input = ctx->input(2).scalar<float>()();
+    const float max_input = ctx->input(3).scalar<float>()();
+    const float min_filter = ctx->input(4).scalar<float>()();
+    const float max_filter = ctx->input(5).scalar<float>()();
+
+    OP_REQUIRES_OK(ctx, QuantizedZeroPoint(min_input, max_input, "input",
+                                           &input_zero_point_));
+    OP_REQUIRES_OK(ctx, QuantizedZeroPoint(min_filter, max_filter, "filter",
+                                           &filter_zero_point_));
+
+    QuantizedMultiplicationRange(min_input, max_input, min_filter, max_filter,
+                                 &min_output_, &max_output_);
+  }
+
+  // The default no-op path zero-fills every output as if it were device
+  // memory, which doesn't work for the host-side range outputs; empty inputs
+  // are rejected above instead.
+  bool IsNoOpKernel(
+      OpKernelContext* ctx,
+      absl::Span<const TensorShape> output_shapes) const override {
+    return false;
+  }
+
+  int64 GetBatch() const { return batch_; }
+  int64 GetOutRows() const { return out_rows_; }
+  int64 GetOutCols() const { return out_cols_; }
+  int64 GetOutDepth() const { return out_depth_; }
+  int32 GetStrideH() const { return attr_->stride_h; }
+  int32 GetStrideW() const { return attr_->stride_w; }
+  int32 GetDilationH() const { return attr_->dilation_h; }
+  int32 GetDilationW() const { return attr_->dilation_w; }
+  int64 GetPadRowsBefore() const { return pad_rows_before_; }
+  int64 GetPadRowsAfter() const { return pad_rows_after_; }
+  int64 GetPadColsBefore() const { return pad_cols_before_; }
+  int64 GetPadColsAfter() const { return pad_cols_after_; }
+  uint8 GetInputZeroPoint() const { return input_zero_point_; }
+  uint8 GetFilterZeroPoint() const { return filter_zero_point_; }
+  float GetMinOutput() const { return min_output_; }
+  float GetMaxOutput() const { return max_output_; }
+
+ private:
+  const std::shared_ptr<const Attributes> attr_;
+  int64 batch_;
+  int64 out_rows_;
+  int64 out_cols_;
+  int64 out_depth_;
+  int64 pad_rows_before_;
+  int64 pad_rows_after_;
+  int64 pad_cols_before_;
+  int64 pad_cols_after_;
+  uint8 input_zero_point_;
+  uint8 filter_zero_point_;
+  float min_output_;
+  float max_output_;
+};
+
+class QuantizedConv2DShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    auto init_helper =
+        static_cast<const QuantizedConv2DInitHelper*>(initialization_helper);
+
+    TensorShape output_shape(
+        {init_helper->GetBatch(), init_helper->GetOutRows(),
+         init_helper->GetOutCols(), init_helper->GetOutDepth()});
+
+    return {std::move(output_shape), TensorShape(), TensorShape()};
+  }
+};
+
+class DmlQuantizedConv2DKernel : public DmlKernel {
+ public:
+  using InitHelper = QuantizedConv2DInitHelper;
+
+  explicit DmlQuantizedConv2DKernel(DmlKernelConstruction* ctx,
+                                    const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 6);
+    CHECK(ctx->GetOutputCount() == 3);
+
+    uint32_t strides[] = {static_cast<uint32_t>(init_helper->GetStrideH()),
+                          static_cast<uint32_t>(init_helper->GetStrideW())};
+    uint32_t dilations[] = {static_cast<uint32_t>(init_helper->GetDilationH()),
+                            static_cast<uint32_t>(init_helper->GetDilationW())};
+    uint32_t start_padding[] = {
+        static_cast<uint32_t>(init_helper->GetPadRowsBefore()),
+        static_cast<uint32_t>(init_helper->GetPadColsBefore())};
+    uint32_t end_padding[] = {
+        static_cast<uint32_t>(init_helper->GetPadRowsAfter()),
+        static_cast<uint32_t>(init_helper->GetPadColsAfter())};
+
+    using namespace DmlTensorAxes;
+
+    // QuantizedConv2D is NHWC-only, and the filter is laid out as HWIO.
+    auto input_output_layout = GetDmlTensorLayout(FORMAT_NHWC, 4);
+    auto filter_layout = {H, W, C, N};
+
+    const TensorShape zero_point_shape({1, 1, 1, 1});
+
+    DmlTensorInfo input_info = {};
+    input_info.kernel_index = 0;
+    input_info.desc = CreateTensorDescFromInput(ctx, 0, input_output_layout);
+
+    // The zero points aren't TF inputs; they're tiny constant buffers bound
+    // directly in Compute.
+    DmlTensorInfo input_zero_point_info = {};
+    input_zero_point_info.kernel_index = 0;
+    input_zero_point_info.desc =
+        DmlTensorDesc::Create(DT_UINT8, zero_point_shape, zero_point_shape);
+
+    DmlTensorInfo filter_info = {};
+    filter_info.kernel_index = 1;
+    filter_info.desc = CreateTensorDescFromInput(ctx, 1, filter_layout);
+
+    DmlTensorInfo filter_zero_point_info = {};
+    filter_zero_point_info.kernel_index = 1;
+    filter_zero_point_info.desc =
+        DmlTensorDesc::Create(DT_UINT8, zero_point_shape, zero_point_shape);
+
+    DmlTensorInfo output_info = {};
+    output_info.kernel_index = 0;
+    output_info.desc = CreateTensorDescFromOutput(ctx, 0, input_output_layout);
+
+    DmlKernelTensors tensors = {};
+    tensors.inputs = {input_info, input_zero_point_info, filter_info,
+                      filter_zero_point_info};
+    tensors.outputs = {output_info};
+
+    uint8 input_zero_point = init_helper->GetInputZeroPoint();
+    uint8 filter_zero_point = init_helper->GetFilterZeroPoint();
+
+    auto input_zp_buffer = ctx->AcquireConstantBuffer(
+        absl::Span<const uint8_t>(&input_zero_point, 1));
+    OP_REQUIRES_OK(ctx->GetOpKernelContext(), input_zp_buffer.status());
+    input_zero_point_buffer_ = input_zp_buffer.ConsumeValueOrDie();
+
+    auto filter_zp_buffer = ctx->AcquireConstantBuffer(
+        absl::Span<const uint8_t>(&filter_zero_point, 1));
+    OP_REQUIRES_OK(ctx->GetOpKernelContext(), filter_zp_buffer.status());
+    filter_zero_point_buffer_ = filter_zp_buffer.ConsumeValueOrDie();
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+    auto output_descs = GetDmlTensorDescs(tensors.outputs);
+
+    DML_CONVOLUTION_INTEGER_OPERATOR_DESC conv_desc = {};
+    conv_desc.InputTensor = &input_descs[0];
+    conv_desc.InputZeroPointTensor = &input_descs[1];
+    conv_desc.FilterTensor = &input_descs[2];
+    conv_desc.FilterZeroPointTensor = &input_descs[3];
+    conv_desc.OutputTensor = &output_descs[0];
+    conv_desc.DimensionCount = kNchwSpatialDimensionCount;
+    conv_desc.Strides = strides;
+    conv_desc.Dilations = dilations;
+    conv_desc.StartPadding = start_padding;
+    conv_desc.EndPadding = end_padding;
+    conv_desc.GroupCount = 1;
+
+    DML_OPERATOR_DESC op_desc = {DML_OPERATOR_CONVOLUTION_INTEGER, &conv_desc};
+    Initialize(ctx, std::move(tensors), op_desc);
+  }
+
+  StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
+    auto init_helper = ctx->GetInitializationHelper<InitHelper>();
+
+    // The range outputs live in host memory.
+    ctx->GetOutputTensor(1)->scalar<float>()() = init_helper->GetMinOutput();
+    ctx->GetOutputTensor(2)->scalar<float>()() = init_helper->GetMaxOutput();
+
+    D3D12BufferRegion input_buffer =
+        ctx->CreateBufferForTensor(ctx->GetInputTensor(0));
+    D3D12BufferRegion filter_buffer =
+        ctx->CreateBufferForTensor(ctx->GetInputTensor(1));
+    D3D12BufferRegion output_buffer =
+        ctx->CreateBufferForTensor(*ctx->GetOutputTensor(0));
+
+    absl::optional<DML_BUFFER_BINDING> input_bindings[] = {
+        input_buffer.GetBufferBinding(),
+        input_zero_point_buffer_->GetBufferBinding(),
+        filter_buffer.GetBufferBinding(),
+        filter_zero_point_buffer_->GetBufferBinding(),
+    };
+
+    absl::optional<DML_BUFFER_BINDING> output_bindings[] = {
+        output_buffer.GetBufferBinding(),
+    };
+
+    return DmlKernel::Compute(ctx, input_bindings, output_bindings);
+  }
+
+ private:
+  std::shared_ptr<const DmlBuffer> input_zero_point_buffer_;
+  std::shared_ptr<const DmlBuffer> filter_zero_point_buffer_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("QuantizedConv2D")
+                            .Device(DEVICE_DML)
+                            .TypeConstraint<quint8>("Tinput")
+                            .TypeConstraint<quint8>("Tfilter")
+                            .TypeConstraint<qint32>("out_type")
+                            .HostMemory("min_input")
+                            .HostMemory("max_input")
+                            .HostMemory("min_filter")
+                            .HostMemory("max_filter")
+                            .HostMemory("min_output")
+                            .HostMemory("max_output"),
+                        DmlKernelWrapper<DmlQuantizedConv2DKernel,
+                                         QuantizedConv2DShapeHelper>);
+
+class QuantizedMatMulInitHelper : public InitializationHelper {
+ public:
+  struct Attributes {
+    explicit Attributes(OpKernelConstruction* ctx) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("transpose_a", &transpose_a));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("transpose_b", &transpose_b));
+    }
+
+    bool transpose_a;
+    bool transpose_b;
+  };
+
+  QuantizedMatMulInitHelper(OpKernelContext* ctx,
+                            std::shared_ptr<const Attributes> attr) {
+    // TF's quantization tooling only emits non-transposed QuantizedMatMul.
+    OP_REQUIRES(ctx, !attr->transpose_a && !attr->transpose_b,
+                errors::Unimplemented(
+                    "The DML QuantizedMatMul kernel doesn't support "
+                    "transpose_a or transpose_b."));
+
+    const TensorShape& a_shape = ctx->input(0).shape();
+    const TensorShape& b_shape = ctx->input(1).shape();
+
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsMatrix(a_shape),
+        errors::InvalidArgument("In[0] is not a matrix. Instead it has shape ",
+                                a_shape.DebugString()));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsMatrix(b_shape),
+        errors::InvalidArgument("In[1] is not a matrix. Instead it has shape ",
+                                b_shape.DebugString()));
+    OP_REQUIRES(ctx, a_shape.dim_size(1) == b_shape.dim_size(0),
+                errors::InvalidArgument(
+                    "Matrix size-incompatible: In[0]: ", a_shape.DebugString(),
+                    ", In[1]: ", b_shape.DebugString()));
+    OP_REQUIRES(
+        ctx, a_shape.num_elements() > 0 && b_shape.num_elements() > 0,
+        errors::InvalidArgument(
+            "DML doesn't support empty tensors for QuantizedMatMul"));
+
+    OP_REQUIRES_OK(ctx, ValidateScalarRange(ctx, 2, 3, "a"));
+    OP_REQUIRES_OK(ctx, ValidateScalarRange(ctx, 4, 5, "b"));
+
+    const float min_a = ctx->input(2).scalar<float>()();
+    const float max_a = ctx->input(3).scalar<float>()();
+    const float min_b = ctx->input(4).scalar<float>()();
+    const float max_b = ctx->input(5).scalar<float>()();
+
+    OP_REQUIRES_OK(ctx, QuantizedZeroPoint(min_a, max_a, "a", &a_zero_point_));
+    OP_REQUIRES_OK(ctx, QuantizedZeroPoint(min_b, max_b, "b", &b_zero_point_));
+
+    QuantizedMultiplicationRange(min_a, max_a, min_b, max_b, &min_output_,
+                                 &max_output_);
+  }
+
+  // See QuantizedConv2DInitHelper::IsNoOpKernel.
+  bool IsNoOpKernel(
+      OpKernelContext* ctx,
+      absl::Span<const TensorShape> output_shapes) const override {
+    return false;
+  }
+
+  uint8 GetAZeroPoint() const { return a_zero_point_; }
+  uint8 GetBZeroPoint() const { return b_zero_point_; }
+  float GetMinOutput() const { return min_output_; }
+  float GetMaxOutput() const { return max_output_; }
+
+ private:
+  uint8 a_zero_point_;
+  uint8 b_zero_point_;
+  float min_output_;
+  float max_output_;
+};
+
+class QuantizedMatMulShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    TensorShape output_shape(
+        {ctx->input(0).dim_size(0), ctx->input(1).dim_size(1)});
+
+    return {std::move(output_shape), TensorShape(), TensorShape()};
+  }
+};
+
+class DmlQuantizedMatMulKernel : public DmlKernel {
+ public:
+  using InitHelper = QuantizedMatMulInitHelper;
+
+  explicit DmlQuantizedMatMulKernel(DmlKernelConstruction* ctx,
+                                    const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 6);
+    CHECK(ctx->GetOutputCount() == 3);
+
+    const TensorShape zero_point_shape({1, 1, 1, 1});
+
+    DmlTensorInfo a_info = {};
+    a_info.kernel_index = 0;
+    a_info.desc = CreateTensorDescFromInput(ctx, 0);
+
+    DmlTensorInfo a_zero_point_info = {};
+    a_zero_point_info.kernel_index = 0;
+    a_zero_point_info.desc =
+        DmlTensorDesc::Create(DT_UINT8, zero_point_shape, zero_point_shape);
+
+    DmlTensorInfo b_info = {};
+    b_info.kernel_index = 1;
+    b_info.desc = CreateTensorDescFromInput(ctx, 1);
+
+    DmlTensorInfo b_zero_point_info = {};
+    b_zero_point_info.kernel_index = 1;
+    b_zero_point_info.desc =
+        DmlTensorDesc::Create(DT_UINT8, zero_point_shape, zero_point_shape);
+
+    DmlTensorInfo output_info = {};
+    output_info.kernel_index = 0;
+    output_info.desc = CreateTensorDescFromOutput(ctx, 0);
+
+    DmlKernelTensors tensors = {};
+    tensors.inputs = {a_info, a_zero_point_info, b_info, b_zero_point_info};
+    tensors.outputs = {output_info};
+
+    uint8 a_zero_point = init_helper->GetAZeroPoint();
+    uint8 b_zero_point = init_helper->GetBZeroPoint();
+
+    auto a_zp_buffer =
+        ctx->AcquireConstantBuffer(absl::Span<const uint8_t>(&a_zero_point, 1));
+    OP_REQUIRES_OK(ctx->GetOpKernelContext(), a_zp_buffer.status());
+    a_zero_point_buffer_ = a_zp_buffer.ConsumeValueOrDie();
+
+    auto b_zp_buffer =
+        ctx->AcquireConstantBuffer(absl::Span<const uint8_t>(&b_zero_point, 1));
+    OP_REQUIRES_OK(ctx->GetOpKernelContext(), b_zp_buffer.status());
+    b_zero_point_buffer_ = b_zp_buffer.ConsumeValueOrDie();
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+    auto output_descs = GetDmlTensorDescs(tensors.outputs);
+
+    DML_MATRIX_MULTIPLY_INTEGER_OPERATOR_DESC matmul_desc = {};
+    matmul_desc.ATensor = &input_descs[0];
+    matmul_desc.AZeroPointTensor = &input_descs[1];
+    matmul_desc.BTensor = &input_descs[2];
+    matmul_desc.BZeroPointTensor = &input_descs[3];
+    matmul_desc.OutputTensor = &output_descs[0];
+
+    DML_OPERATOR_DESC op_desc = {DML_OPERATOR_MATRIX_MULTIPLY_INTEGER,
+                                 &matmul_desc};
+    Initialize(ctx, std::move(tensors), op_desc);
+  }
+
+  StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
+    auto init_helper = ctx->GetInitializationHelper<InitHelper>();
+
+    ctx->GetOutputTensor(1)->scalar<float>()() = init_helper->GetMinOutput();
+    ctx->GetOutputTensor(2)->scalar<float>()() = init_helper->GetMaxOutput();
+
+    D3D12BufferRegion a_buffer =
+        ctx->CreateBufferForTensor(ctx->GetInputTensor(0));
+    D3D12BufferRegion b_buffer =
+        ctx->CreateBufferForTensor(ctx->GetInputTensor(1));
+    D3D12BufferRegion output_buffer =
+        ctx->CreateBufferForTensor(*ctx->GetOutputTensor(0));
+
+    absl::optional<DML_BUFFER_BINDING> input_bindings[] = {
+        a_buffer.GetBufferBinding(),
+        a_zero_point_buffer_->GetBufferBinding(),
+        b_buffer.GetBufferBinding(),
+        b_zero_point_buffer_->GetBufferBinding(),
+    };
+
+    absl::optional<DML_BUFFER_BINDING> output_bindings[] = {
+        output_buffer.GetBufferBinding(),
+    };
+
+    return DmlKernel::Compute(ctx, input_bindings, output_bindings);
+  }
+
+ private:
+  std::shared_ptr<const DmlBuffer> a_zero_point_buffer_;
+  std::shared_ptr<const DmlBuffer> b_zero_point_buffer_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
+                            .Device(DEVICE_DML)
+                            .TypeConstraint<quint8>("T1")
+                            .TypeConstraint<quint8>("T2")
+                            .TypeConstraint<qint32>("Toutput")
+                            .HostMemory("min_a")
+                            .HostMemory("max_a")
+                            .HostMemory("min_b")
+                            .HostMemory("max_b")
+                            .HostMemory("min_out")
+                            .HostMemory("max_out"),
+                        DmlKernelWrapper<DmlQuantizedMatMulKernel,
+                                         QuantizedMatMulShapeHelper>);
+
+class QuantizedReluInitHelper : public InitializationHelper {
+ public:
+  using Attributes = EmptyAttributes;
+
+  QuantizedReluInitHelper(OpKernelContext* ctx,
+                          std::shared_ptr<const Attributes> attr) {
+    OP_REQUIRES(ctx, ctx->input(0).NumElements() > 0,
+                errors::InvalidArgument(
+                    "DML doesn't support empty tensors for QuantizedRelu"));
+
+    OP_REQUIRES_OK(ctx, ValidateScalarRange(ctx, 1, 2, "features"));
+
+    min_features_ = ctx->input(1).scalar<float>()();
+    max_features_ = ctx->input(2).scalar<float>()();
+
+    // Relu in quantized space clamps to the quantized representation of zero,
+    // like the CPU kernel. Unlike the integer matmul/conv the zero point
+    // never leaves the host, so an out-of-range value just clamps.
+    int64 zp = QuantizedZeroPointForRange(min_features_, max_features_);
+    zero_point_ = static_cast<float>(std::min<int64>(std::max<int64>(zp, 0),
+                                                     255));
+  }
+
+  // See QuantizedConv2DInitHelper::IsNoOpKernel.
+  bool IsNoOpKernel(
+      OpKernelContext* ctx,
+      absl::Span<const TensorShape> output_shapes) const override {
+    return false;
+  }
+
+  float GetZeroPoint() const { return zero_point_; }
+  float GetMinFeatures() const { return min_features_; }
+  float GetMaxFeatures() const { return max_features_; }
+
+ private:
+  float zero_point_;
+  float min_features_;
+  float max_features_;
+};
+
+class QuantizedReluShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    return {ctx->input(0).shape(), TensorShape(), TensorShape()};
+  }
+};
+
+class DmlQuantizedReluKernel : public DmlKernel {
+ public:
+  using InitHelper = QuantizedReluInitHelper;
+
+  explicit DmlQuantizedReluKernel(DmlKernelConstruction* ctx,
+                                  const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 3);
+    CHECK(ctx->GetOutputCount() == 3);
+
+    DmlKernelParams params;
+    params.kernel_input_indices = {0};
+    params.kernel_output_indices = {0};
+
+    DmlKernelTensors tensors = GetTensorInfos(ctx, params);
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto outputs = GetDmlTensorDescs(tensors.outputs);
+
+    DML_ELEMENT_WISE_CLIP_OPERATOR_DESC clip_desc = {};
+    clip_desc.InputTensor = &inputs[0];
+    clip_desc.OutputTensor = &outputs[0];
+    clip_desc.ScaleBias = nullptr;
+    clip_desc.Min = init_helper->GetZeroPoint();
+    clip_desc.Max = 255.0f;
+
+    DML_OPERATOR_DESC op_desc = {DML_OPERATOR_ELEMENT_WISE_CLIP, &clip_desc};
+    Initialize(ctx, std::move(tensors), op_desc);
+  }
+
+  StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
+    auto init_helper = ctx->GetInitializationHelper<InitHelper>();
+
+    // The range passes through unchanged, like the CPU kernel.
+    ctx->GetOutputTensor(1)->scalar<float>()() = init_helper->GetMinFeatures();
+    ctx->GetOutputTensor(2)->scalar<float>()() = init_helper->GetMaxFeatures();
+
+    return DmlKernel::Compute(ctx);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("QuantizedRelu")
+                            .Device(DEVICE_DML)
+                            .TypeConstraint<quint8>("Tinput")
+                            .TypeConstraint<quint8>("out_type")
+                            .HostMemory("min_features")
+                            .HostMemory("max_features")
+                            .HostMemory("min_activations")
+                            .HostMemory("max_activations"),
+                        DmlKernelWrapper<DmlQuantizedReluKernel,
+                                         QuantizedReluShapeHelper>);
+
+class DequantizeInitHelper : public InitializationHelper {
+ public:
+  struct Attributes {
+    explicit Attributes(OpKernelConstruction* ctx) {
+      string mode;
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("mode", &mode));
+      OP_REQUIRES(ctx, mode == "MIN_COMBINED",
+                  errors::Unimplemented("The DML Dequantize kernel only "
+                                        "supports the MIN_COMBINED mode."));
+    }
+  };
+
+  DequantizeInitHelper(OpKernelContext* ctx,
+                       std::shared_ptr<const Attributes> attr) {
+    OP_REQUIRES_OK(ctx, ValidateScalarRange(ctx, 1, 2, "input"));
+
+    const float min_range = ctx->input(1).scalar<float>()();
+    const float max_range = ctx->input(2).scalar<float>()();
+
+    // Mirrors the MIN_COMBINED path of the CPU Dequantize kernel:
+    //   output = (input - lowest_quantized) * scale + min_range
+    double lowest_quantized;
+    double num_levels;
+    if (ctx->input(0).dtype() == DT_QINT32) {
+      lowest_quantized = std::numeric_limits<int32>::lowest();
+      num_levels = static_cast<double>(std::numeric_limits<uint32>::max());
+    } else {
+      lowest_quantized = 0.0;
+      num_levels = 255.0;
+    }
+
+    const double scale = (max_range - min_range) / num_levels;
+    scale_ = static_cast<float>(scale);
+    offset_ = static_cast<float>(min_range - lowest_quantized * scale);
+  }
+
+  float GetScale() const { return scale_; }
+  float GetOffset() const { return offset_; }
+
+ private:
+  float scale_;
+  float offset_;
+};
+
+class DequantizeShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    return {ctx->input(0).shape()};
+  }
+};
+
+class DmlDequantizeKernel : public DmlKernel {
+ public:
+  using InitHelper = DequantizeInitHelper;
+
+  explicit DmlDequantizeKernel(DmlKernelConstruction* ctx,
+                               const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 3);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    DmlKernelParams params;
+    params.kernel_input_indices = {0};
+
+    DmlKernelTensors tensors = GetTensorInfos(ctx, params);
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto input = dml::InputTensor(scope, 0, inputs[0]);
+
+    DML_SCALE_BIAS scale_bias = {init_helper->GetScale(),
+                                 init_helper->GetOffset()};
+    auto result = dml::Identity(
+        dml::Cast(input, DML_TENSOR_DATA_TYPE_FLOAT32), scale_bias);
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                            \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("Dequantize")                                                     \
+          .Device(DEVICE_DML)                                                \
+          .TypeConstraint<type>("T")                                         \
+          .HostMemory("min_range")                                           \
+          .HostMemory("max_range"),                                          \
+      DmlKernelWrapper<DmlDequantizeKernel, DequantizeShapeHelper>)
+
+DML_REGISTER_KERNEL(quint8);
+DML_REGISTER_KERNEL(qint32);
+#undef DML_REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -77,6 +77,66 @@ dml::Expression UniformHalf(dml::Graph& scope, dml::Expression input_state,
   return dml::Reinterpret(result, DML_TENSOR_DATA_TYPE_FLOAT16) - 1.0f;
 }
 
+// Converts uniform random bits into a standard normal distribution using the
+// Box-Muller transform. Each pair of 32-bit generator values yields two
+// normally distributed outputs, so the generator produces one extra value
+// when the requested element count is odd.
+dml::Expression NormalFloat(dml::Graph& scope, dml::Expression input_state,
+                            uint32_t element_count) {
+  const uint32_t pair_count = (element_count + 1) / 2;
+
+  // FP32 has 1 sign bit, 8 exponent bits, and 23 mantissa bits.
+  constexpr uint32_t sign_and_exponent_value = ((1 << (8 - 1)) - 1) << 23;
+  constexpr uint32_t mantissa_mask_value = (1 << 23) - 1;
+
+  auto generator_outputs =
+      dml::RandomGenerator(input_state, {1, 1, 2, pair_count}, false);
+  auto random_bits = generator_outputs.values;
+
+  auto sign_and_exponent = dml::ScalarTensor(scope, sign_and_exponent_value,
+                                             random_bits.GetOutputDesc().sizes);
+
+  auto mantissa_mask = dml::ScalarTensor(scope, mantissa_mask_value,
+                                         random_bits.GetOutputDesc().sizes);
+
+  auto uniform = dml::Reinterpret(sign_and_exponent |
+                                      (random_bits & mantissa_mask),
+                                  DML_TENSOR_DATA_TYPE_FLOAT32) -
+                 1.0f;
+
+  dml::TensorDesc::Dimensions pair_sizes = {1, 1, 1, pair_count};
+  dml::TensorDesc::Dimensions slice_strides = {1, 1, 1, 1};
+  auto u1 = dml::Slice(uniform, {0, 0, 0, 0}, pair_sizes, slice_strides);
+  auto u2 = dml::Slice(uniform, {0, 0, 1, 0}, pair_sizes, slice_strides);
+
+  // u1 is in [0, 1); mirror it to (0, 1] so the logarithm stays finite.
+  auto radius = dml::Sqrt(dml::Log(1.0f - u1) * -2.0f);
+  auto theta = u2 * (2.0f * 3.14159265358979f);
+
+  auto z0 = radius * dml::Cos(theta);
+  auto z1 = radius * dml::Sin(theta);
+
+  absl::InlinedVector<dml::Expression, 2> pairs = {z0, z1};
+  auto joined = dml::Join(pairs, 2);
+
+  // Flatten the pairs and trim the extra element produced for odd counts.
+  auto result = dml::Reinterpret(joined, {1, 1, 1, pair_count * 2}, {});
+  if (pair_count * 2 != element_count) {
+    result = dml::Slice(result, {0, 0, 0, 0}, {1, 1, 1, element_count},
+                        slice_strides);
+  }
+
+  return result;
+}
+
+dml::Expression NormalHalf(dml::Graph& scope, dml::Expression input_state,
+                           uint32_t element_count) {
+  // The transform is computed in FP32 for precision; only the result is
+  // narrowed.
+  auto result = NormalFloat(scope, input_state, element_count);
+  return dml::Cast(result, DML_TENSOR_DATA_TYPE_FLOAT16);
+}
+
 // Compute a + b where a is a signed type and b is unsigned. Requires the result
 // is representable in the range of a's data type. See SignedAdd from
 // random_distributions.h.
@@ -481,6 +541,105 @@ TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
 TF_CALL_int32(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
 
+class DmlRandomStandardNormalKernel : public DmlKernel {
+  absl::optional<DmlBuffer> state_buffer_;
+  uint32_t num_output_elements_;
+
+ public:
+  using InitHelper = tensorflow::RandomUniformInitHelper;
+
+  explicit DmlRandomStandardNormalKernel(
+      DmlKernelConstruction* ctx, const RandomUniformInitHelper* init_helper) {
+    num_output_elements_ =
+        static_cast<uint32_t>(init_helper->GetOutputShape().num_elements());
+
+    state_buffer_ = ctx->AllocateDefaultBuffer(6 * sizeof(uint32_t));
+
+    OP_REQUIRES(ctx->GetOpKernelContext(), state_buffer_,
+                errors::ResourceExhausted("OOM when allocating a buffer of ",
+                                          6 * sizeof(uint32_t), " bytes"));
+
+    // Reserve input state binding. This will point at state_buffer_.
+    DmlTensorInfo state_info;
+    state_info.kernel_index = 0;
+    std::array<uint32_t, 4> state_sizes = {1, 1, 1, 6};
+    state_info.desc =
+        DmlTensorDesc::Create(DT_UINT32, state_sizes, state_sizes);
+
+    // Flatten output shape for DirectML.
+    DmlTensorInfo output_info;
+    output_info.kernel_index = 0;
+    std::array<uint32_t, 4> output_sizes = {1, 1, 1, num_output_elements_};
+    output_info.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                             output_sizes, output_sizes);
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {state_info};
+    tensors.outputs = {output_info};
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto input_state = dml::InputTensor(scope, 0, inputs[0]);
+
+    dml::Expression result;
+    if (ctx->GetOutputDataType(0) == DT_FLOAT) {
+      result = NormalFloat(scope, input_state, num_output_elements_);
+    } else {
+      DCHECK(ctx->GetOutputDataType(0) == DT_HALF);
+      result = NormalHalf(scope, input_state, num_output_elements_);
+    }
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+
+  StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx,
+                                GuardedPhiloxRandom& generator) const {
+    D3D12BufferRegion output_buffer =
+        ctx->CreateBufferForTensor(*ctx->GetOutputTensor(0));
+
+    absl::InlinedVector<absl::optional<DML_BUFFER_BINDING>, 1> input_bindings;
+    input_bindings.push_back(state_buffer_->GetBufferBinding());
+
+    absl::InlinedVector<absl::optional<DML_BUFFER_BINDING>, 1> output_bindings;
+    output_bindings.push_back(output_buffer.GetBufferBinding());
+
+    // Upload generator state. Note that generator_.ReserveRandomOutputs() is
+    // thread safe and doesn't actually invoke the Philox generator; it simply
+    // returns the current counter and then advances its internal counter.
+    std::array<uint32_t, 6> state_buf;
+    auto philox_state =
+        generator.ReserveRandomOutputs(num_output_elements_, 256);
+    state_buf[0] = philox_state.counter()[0];
+    state_buf[1] = philox_state.counter()[1];
+    state_buf[2] = philox_state.counter()[2];
+    state_buf[3] = philox_state.counter()[3];
+    state_buf[4] = philox_state.key()[0];
+    state_buf[5] = philox_state.key()[1];
+
+    auto byte_ptr = reinterpret_cast<const uint8_t*>(state_buf.data());
+    auto byte_span =
+        absl::MakeSpan(byte_ptr, state_buf.size() * sizeof(state_buf[0]));
+
+    ctx->CopyHostToBuffer(state_buffer_->Resource(), state_buffer_->Offset(),
+                          byte_span);
+
+    return DmlKernel::Compute(ctx, input_bindings, output_bindings);
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)         \
+  REGISTER_KERNEL_BUILDER(                \
+      Name("RandomStandardNormal")        \
+          .Device(DEVICE_DML)             \
+          .HostMemory("shape")            \
+          .TypeConstraint<type>("dtype"), \
+      DmlPhiloxWrapper<DmlRandomStandardNormalKernel, RandomUniformShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
 // ----------------------------------------------------------------------------
 
 // Emulates a DML philox PRNG+distribution by executing it on the CPU and
@@ -528,14 +687,10 @@ class DmlEmulatedPhiloxRandomKernel : public OpKernel {
   GuardedPhiloxRandom generator_;
 };
 
+// TruncatedNormal relies on rejection sampling, which has no fixed number of
+// generator passes and therefore can't be expressed as a precompiled DML
+// graph; it stays on the emulated path.
 #define DML_REGISTER_KERNEL(type)                                        \
-  REGISTER_KERNEL_BUILDER(                                               \
-      Name("RandomStandardNormal")                                       \
-          .Device(DEVICE_DML)                                            \
-          .HostMemory("shape")                                           \
-          .TypeConstraint<type>("dtype"),                                \
-      DmlEmulatedPhiloxRandomKernel<                                     \
-          random::NormalDistribution<random::PhiloxRandom, type>>);      \
   REGISTER_KERNEL_BUILDER(                                               \
       Name("TruncatedNormal")                                            \
           .Device(DEVICE_DML)                                            \
@@ -547,4 +702,298 @@ class DmlEmulatedPhiloxRandomKernel : public OpKernel {
 TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
 
+// ----------------------------------------------------------------------------
+
+// Draws `num_samples` categorical samples per batch row using the Gumbel-max
+// trick: argmax over classes of logits + g, where g = -log(-log(u)) and u is
+// uniform in [0, 1). A generator value of exactly zero makes its lane's noise
+// -inf, which simply never wins the argmax. Everything — noise generation,
+// perturbation and the argmax — runs in one compiled DML graph, so sampling
+// decoders never hop to the host inside their decode loop.
+dml::Expression MultinomialSamples(dml::Graph& scope,
+                                   dml::Expression input_state,
+                                   dml::Expression logits,
+                                   DataType logits_dtype, uint32_t batch_size,
+                                   uint32_t num_classes,
+                                   uint32_t num_samples) {
+  const uint32_t element_count = batch_size * num_samples * num_classes;
+
+  auto uniform = UniformFloat(scope, input_state, element_count);
+  auto noise = dml::Reinterpret(
+      uniform, {1, batch_size, num_samples, num_classes}, {});
+  auto gumbel = dml::Log(dml::Log(noise) * -1.0f) * -1.0f;
+
+  // Every sample of a row perturbs the same logits, so the row broadcasts
+  // across the sample dimension. Half logits are widened for the comparison;
+  // the noise is generated in FP32 anyway.
+  auto row_logits = dml::Reinterpret(
+      logits, {1, batch_size, num_samples, num_classes},
+      dml::TensorDesc::Dimensions({0, num_classes, 0, 1}));
+  auto scores = (logits_dtype == DT_HALF
+                     ? dml::Cast(row_logits, DML_TENSOR_DATA_TYPE_FLOAT32)
+                     : dml::Expression(row_logits)) +
+                gumbel;
+
+  // ARGMAX over classes outputs uint32; indices are never negative.
+  auto samples = dml::Reduce(scores, DML_REDUCE_FUNCTION_ARGMAX, {3});
+  return dml::Reinterpret(samples, {1, 1, batch_size, num_samples}, {});
+}
+
+class MultinomialInitHelper : public InitializationHelper {
+ public:
+  using Attributes = EmptyAttributes;
+
+  MultinomialInitHelper(OpKernelContext* ctx,
+                        std::shared_ptr<const Attributes> attr) {
+    const Tensor& logits = ctx->input(0);
+    const Tensor& num_samples_t = ctx->input(1);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(logits.shape()),
+                errors::InvalidArgument("logits should be a matrix, got shape ",
+                                        logits.shape().DebugString()));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(num_samples_t.shape()),
+        errors::InvalidArgument("num_samples should be a scalar, got shape ",
+                                num_samples_t.shape().DebugString()));
+
+    const int32 num_samples = num_samples_t.scalar<int32>()();
+    OP_REQUIRES(ctx, num_samples >= 0,
+                errors::InvalidArgument(
+                    "num_samples should be nonnegative, got ", num_samples));
+    if (num_samples > 0) {
+      OP_REQUIRES(ctx, logits.dim_size(1) > 0,
+                  errors::InvalidArgument(
+                      "logits should have at least 1 class, got shape ",
+                      logits.shape().DebugString()));
+    }
+
+    output_shape_ = TensorShape({logits.dim_size(0), num_samples});
+  }
+
+  const TensorShape& GetOutputShape() const { return output_shape_; }
+
+ private:
+  TensorShape output_shape_;
+};
+
+class StatelessMultinomialInitHelper : public MultinomialInitHelper {
+ public:
+  StatelessMultinomialInitHelper(OpKernelContext* ctx,
+                                 std::shared_ptr<const Attributes> attr)
+      : MultinomialInitHelper(ctx, attr) {
+    const Tensor& seed_t = ctx->input(2);
+    OP_REQUIRES(ctx, seed_t.dims() == 1 && seed_t.dim_size(0) == 2,
+                errors::InvalidArgument("seed must have shape [2], not ",
+                                        seed_t.shape().DebugString()));
+    if (GetOutputShape().num_elements() == 0) return;
+    OP_REQUIRES_OK(ctx, GenerateKey(seed_t, &key_, &counter_));
+  }
+
+  const random::PhiloxRandom::Key GetKey() const { return key_; }
+  const random::PhiloxRandom::ResultType GetCounter() const { return counter_; }
+
+ private:
+  random::PhiloxRandom::Key key_;
+  random::PhiloxRandom::ResultType counter_;
+};
+
+class MultinomialShapeHelper : public ShapeHelper {
+ public:
+  std::vector<TensorShape> GetOutputShapes(
+      OpKernelContext* ctx,
+      const InitializationHelper* initialization_helper) const override {
+    auto init_helper =
+        static_cast<const MultinomialInitHelper*>(initialization_helper);
+    return {init_helper->GetOutputShape()};
+  }
+};
+
+// Shared graph construction for the stateful and stateless variants; only
+// where the Philox state comes from differs.
+template <typename TInitHelper>
+class DmlBaseMultinomialKernel : public DmlKernel {
+ public:
+  using InitHelper = TInitHelper;
+
+  explicit DmlBaseMultinomialKernel(DmlKernelConstruction* ctx,
+                                    const InitHelper* init_helper) {
+    const TensorShape& logits_shape = ctx->GetInputTensorShape(0);
+    const uint32_t batch_size = static_cast<uint32_t>(logits_shape.dim_size(0));
+    const uint32_t num_classes =
+        static_cast<uint32_t>(logits_shape.dim_size(1));
+    const uint32_t num_samples = static_cast<uint32_t>(
+        ctx->GetConstantInputTensor(1).scalar<int32>()());
+
+    num_random_elements_ = batch_size * num_samples * num_classes;
+
+    // Reserve an input binding for the generator state; a temporary buffer is
+    // swapped in and uploaded at compute time, like the other random kernels.
+    DmlTensorInfo state_info;
+    state_info.kernel_index = 0;
+    std::array<uint32_t, 4> state_sizes = {1, 1, 1, 6};
+    state_info.desc =
+        DmlTensorDesc::Create(DT_UINT32, state_sizes, state_sizes);
+
+    DmlTensorInfo logits_info;
+    logits_info.kernel_index = 0;
+    std::array<uint32_t, 4> logits_sizes = {1, 1, batch_size, num_classes};
+    logits_info.desc = DmlTensorDesc::Create(ctx->GetInputDataType(0),
+                                             logits_sizes, logits_sizes);
+
+    DmlTensorInfo output_info;
+    output_info.kernel_index = 0;
+    output_info.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
+                                             ctx->GetOutputTensorShape(0),
+                                             ctx->GetOutputTensorShape(0));
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {state_info, logits_info};
+    tensors.outputs = {output_info};
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto input_state = dml::InputTensor(scope, 0, inputs[0]);
+    auto logits = dml::InputTensor(scope, 1, inputs[1]);
+
+    auto result =
+        MultinomialSamples(scope, input_state, logits, ctx->GetInputDataType(0),
+                           batch_size, num_classes, num_samples);
+
+    // TFDML #24881131
+    if (Is64BitSignedIntegerType(ctx->GetOutputDataType(0))) {
+      result = dml::ConvertInt32ToInt64(
+          scope, dml::Reinterpret(result, DML_TENSOR_DATA_TYPE_INT32));
+    } else {
+      result = dml::Reinterpret(result, DML_TENSOR_DATA_TYPE_INT32);
+    }
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+
+ protected:
+  StatusOr<DmlGpuEvent> ComputeWithState(
+      DmlKernelContext* ctx, const std::array<uint32_t, 6>& state_buf) const {
+    DmlBuffer input_state_buffer =
+        ctx->AllocateDefaultBuffer(6 * sizeof(uint32_t));
+    if (!input_state_buffer) {
+      return errors::ResourceExhausted("OOM when allocating a buffer of ",
+                                       6 * sizeof(uint32_t), " bytes");
+    }
+
+    D3D12BufferRegion logits_buffer =
+        ctx->CreateBufferForTensor(ctx->GetInputTensor(0));
+    D3D12BufferRegion output_buffer =
+        ctx->CreateBufferForTensor(*ctx->GetOutputTensor(0));
+
+    absl::InlinedVector<absl::optional<DML_BUFFER_BINDING>, 2> input_bindings;
+    input_bindings.push_back(input_state_buffer.GetBufferBinding());
+    input_bindings.push_back(logits_buffer.GetBufferBinding());
+
+    absl::InlinedVector<absl::optional<DML_BUFFER_BINDING>, 1> output_bindings;
+    output_bindings.push_back(output_buffer.GetBufferBinding());
+
+    auto byte_ptr = reinterpret_cast<const uint8_t*>(state_buf.data());
+    auto byte_span =
+        absl::MakeSpan(byte_ptr, state_buf.size() * sizeof(state_buf[0]));
+    ctx->CopyHostToBuffer(input_state_buffer.Resource(),
+                          input_state_buffer.Offset(), byte_span);
+
+    return DmlKernel::Compute(ctx, input_bindings, output_bindings);
+  }
+
+  uint32_t num_random_elements_;
+};
+
+class DmlStatelessMultinomialKernel
+    : public DmlBaseMultinomialKernel<StatelessMultinomialInitHelper> {
+ public:
+  explicit DmlStatelessMultinomialKernel(DmlKernelConstruction* ctx,
+                                         const InitHelper* init_helper)
+      : DmlBaseMultinomialKernel(ctx, init_helper) {
+    auto counter = init_helper->GetCounter();
+    auto key = init_helper->GetKey();
+    state_buf_[0] = counter[0];
+    state_buf_[1] = counter[1];
+    state_buf_[2] = counter[2];
+    state_buf_[3] = counter[3];
+    state_buf_[4] = key[0];
+    state_buf_[5] = key[1];
+  }
+
+  StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
+    return ComputeWithState(ctx, state_buf_);
+  }
+
+ private:
+  std::array<uint32_t, 6> state_buf_;
+};
+
+class DmlMultinomialKernel
+    : public DmlBaseMultinomialKernel<MultinomialInitHelper> {
+ public:
+  using DmlBaseMultinomialKernel::DmlBaseMultinomialKernel;
+
+  StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx,
+                                GuardedPhiloxRandom& generator) const {
+    // Note that generator.ReserveRandomOutputs() is thread safe and doesn't
+    // actually invoke the Philox generator; it simply returns the current
+    // counter and then advances its internal counter.
+    auto philox_state =
+        generator.ReserveRandomOutputs(num_random_elements_, 256);
+
+    std::array<uint32_t, 6> state_buf;
+    state_buf[0] = philox_state.counter()[0];
+    state_buf[1] = philox_state.counter()[1];
+    state_buf[2] = philox_state.counter()[2];
+    state_buf[3] = philox_state.counter()[3];
+    state_buf[4] = philox_state.key()[0];
+    state_buf[5] = philox_state.key()[1];
+
+    return ComputeWithState(ctx, state_buf);
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                       \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("Multinomial")                                               \
+          .Device(DEVICE_DML)                                           \
+          .HostMemory("num_samples")                                    \
+          .TypeConstraint<type>("T")                                    \
+          .TypeConstraint<int32>("output_dtype"),                       \
+      DmlPhiloxWrapper<DmlMultinomialKernel, MultinomialShapeHelper>);  \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("Multinomial")                                               \
+          .Device(DEVICE_DML)                                           \
+          .HostMemory("num_samples")                                    \
+          .TypeConstraint<type>("T")                                    \
+          .TypeConstraint<int64>("output_dtype"),                       \
+      DmlPhiloxWrapper<DmlMultinomialKernel, MultinomialShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
+#define DML_REGISTER_KERNEL(type)                                     \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("StatelessMultinomial")                                    \
+          .Device(DEVICE_DML)                                         \
+          .HostMemory("num_samples")                                  \
+          .HostMemory("seed")                                         \
+          .TypeConstraint<type>("T")                                  \
+          .TypeConstraint<int32>("output_dtype"),                     \
+      DmlKernelWrapper<DmlStatelessMultinomialKernel,                 \
+                       MultinomialShapeHelper>);                      \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("StatelessMultinomial")                                    \
+          .Device(DEVICE_DML)                                         \
+          .HostMemory("num_samples")                                  \
+          .HostMemory("seed")                                         \
+          .TypeConstraint<type>("T")                                  \
+          .TypeConstraint<int64>("output_dtype"),                     \
+      DmlKernelWrapper<DmlStatelessMultinomialKernel,                 \
+                       MultinomialShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
 }  // namespace tensorflow
\ No newline at end of file
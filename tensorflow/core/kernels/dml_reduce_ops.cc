@@ -66,6 +66,32 @@ class ReduceInitializationHelper : public InitializationHelper {
     return false;
   }
 
+  absl::optional<int> GetForwardableInputIndex(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const override {
+    // Arg functions are never an identity; they output indices, not values.
+    constexpr bool is_arg_function =
+        reduce_function == DML_REDUCE_FUNCTION_ARGMIN ||
+        reduce_function == DML_REDUCE_FUNCTION_ARGMAX;
+
+    if (is_arg_function) {
+      return absl::nullopt;
+    }
+
+    // A reduction over an empty set of axes (or only over axes of size 1) is
+    // an identity, so the input buffer can be handed straight to the output
+    // instead of dispatching a GPU copy.
+    const bool is_identity = reduction_helper_.ndims() == 0 ||
+                             (reduction_helper_.ndims() == 1 &&
+                              !reduction_helper_.reduce_first_axis());
+
+    if (!is_identity) {
+      return absl::nullopt;
+    }
+
+    return 0;
+  }
+
   ReduceInitializationHelper(OpKernelContext* ctx,
                              std::shared_ptr<const Attributes> attr) {
     // We delegate most of the work to TF's existing ReductionHelper
@@ -154,16 +180,22 @@ class DmlReduceKernel : public DmlKernel {
     // 'D'), you can collapse the NC dimensions together and the HW dimensions
     // together, then perform a 3D reduction along the 1st axis. This allows us
     // to perform reductions across higher-dimensional tensors than we would
-    // usually support, since DML only supports 4D reductions.
+    // usually support, since DML tensors are limited to 8 dimensions.
+    //
+    // Second, because DML's reduce operator accepts an arbitrary set of axes,
+    // the canonicalized alternating keep/reduce pattern always executes as a
+    // single reduction dispatch regardless of whether the original axes were
+    // adjacent. This includes Mean, which maps to DML_REDUCE_FUNCTION_AVERAGE
+    // and therefore folds the final scale by the element count into the same
+    // dispatch.
     //
-    // Second, if the number of axes that need reduction exceed what's
+    // Lastly, if the number of axes that need reduction exceed what's
     // supported, the ReductionHelper also provides shapes for transposing the
     // dimensions of the input tensor such that all the reduction axes are
     // shuffled to the end. This allows an N-dimensional reduction to be
     // performed as a 2D reduction, albeit at the cost of a tensor copy. We
-    // don't use this facility in DML, though. If the dimensionality of the
-    // reduction (after collapsing adjacent axes) exceeds what DML supports,
-    // this kernel returns an error.
+    // don't use this facility in DML, though; since a tensor desc cannot
+    // exceed 8 dimensions anyway, this kernel returns an error instead.
     const ReductionHelper& reduce_helper = init_helper->GetReductionHelper();
 
     constexpr bool is_special_empty_kernel =
@@ -53,15 +53,53 @@ class LuGradInitHelper : public InitializationHelper {
     return input_gradient_shape_;
   }
 
+  // Every grad kernel built on this helper computes each output element from
+  // the corresponding elements of the incoming gradient and the features, so
+  // a non-broadcasting input's buffer may back the output gradient in place.
+  // On training steps the incoming gradient typically dies here, which lets
+  // the executor forward its buffer instead of allocating a fresh one.
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    const TensorShape* input_shapes[] = {&input_gradient_shape_,
+                                         &feature_shape_};
+
+    absl::InlinedVector<int, 4> candidates;
+    for (int i = 0; i < 2; ++i) {
+      if (ctx->input_memory_type(i) == DEVICE_MEMORY && !ctx->input_is_ref(i) &&
+          ctx->input_dtype(i) == ctx->expected_output_dtype(output_index) &&
+          *input_shapes[i] == broadcasted_output_shape_) {
+        candidates.push_back(i);
+      }
+    }
+    return candidates;
+  }
+
  private:
   TensorShape feature_shape_;
   TensorShape input_gradient_shape_;
   TensorShape broadcasted_output_shape_;
 };
 
+// Relu needs no validation, but it is element-wise, so its input's buffer may
+// back the output in place when the executor holds the only reference. This
+// covers the activation that follows nearly every convolution in a CNN.
+class ReluInitHelper : public NoOpInitializationHelper {
+ public:
+  using NoOpInitializationHelper::NoOpInitializationHelper;
+
+  absl::InlinedVector<int, 4> GetInPlaceForwardableInputIndices(
+      OpKernelContext* ctx, int output_index) const override {
+    if (ctx->input_memory_type(0) == DEVICE_MEMORY && !ctx->input_is_ref(0) &&
+        ctx->input_dtype(0) == ctx->expected_output_dtype(output_index)) {
+      return {0};
+    }
+    return {};
+  }
+};
+
 class DmlReluKernel : public DmlKernel {
  public:
-  using InitHelper = NoOpInitializationHelper;
+  using InitHelper = ReluInitHelper;
 
   explicit DmlReluKernel(DmlKernelConstruction* ctx,
                          const InitHelper* init_helper) {
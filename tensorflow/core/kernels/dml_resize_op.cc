@@ -227,4 +227,144 @@ TF_CALL_int16(DML_REGISTER_KERNEL);
 TF_CALL_int32(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
 
+class FusedResizeNormalizeInitHelper : public ResizeInitHelper {
+ public:
+  FusedResizeNormalizeInitHelper(OpKernelContext* ctx,
+                                 std::shared_ptr<const Attributes> attr)
+      : ResizeInitHelper(ctx, attr) {
+    if (!ctx->status().ok()) {
+      return;
+    }
+
+    // The normalization constants apply per channel (or uniformly when
+    // they're scalars), mirroring how Sub/Mul would broadcast them against
+    // the NHWC resize output.
+    int64 channels = GetImageResizerState().channels;
+    for (int i : {2, 3}) {
+      const Tensor& tensor = ctx->input(i);
+      OP_REQUIRES(ctx,
+                  tensor.dims() <= 1 && (tensor.NumElements() == 1 ||
+                                         tensor.NumElements() == channels),
+                  errors::InvalidArgument(
+                      "shift and scale must be scalars or vectors of length ",
+                      channels, ", got shape ", tensor.shape().DebugString()));
+    }
+  }
+};
+
+// Resizes with bilinear interpolation, converts to the output dtype, and
+// applies an affine normalization, all in a single fused graph. Created by
+// the grappler remapper from ResizeBilinear + <Cast> + Sub + Mul.
+class DmlFusedResizeNormalizeKernel : public DmlKernel {
+ public:
+  using InitHelper = FusedResizeNormalizeInitHelper;
+
+  explicit DmlFusedResizeNormalizeKernel(DmlKernelConstruction* ctx,
+                                         const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 4);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    TensorShape input_tensor_shape = ctx->GetInputTensorShape(0);
+    TensorShape output_tensor_shape = ctx->GetOutputTensorShape(0);
+
+    DmlTensorInfo images;
+    images.kernel_index = 0;
+    images.desc = DmlTensorDesc::Create(ctx->GetInputDataType(0),
+                                        input_tensor_shape, input_tensor_shape);
+
+    // The normalization constants broadcast against the NHWC resize output.
+    DmlTensorInfo shift;
+    shift.kernel_index = 2;
+    shift.desc =
+        DmlTensorDesc::Create(ctx->GetInputDataType(2), output_tensor_shape,
+                              ctx->GetInputTensorShape(2));
+
+    DmlTensorInfo scale;
+    scale.kernel_index = 3;
+    scale.desc =
+        DmlTensorDesc::Create(ctx->GetInputDataType(3), output_tensor_shape,
+                              ctx->GetInputTensorShape(3));
+
+    DmlTensorInfo output;
+    output.kernel_index = 0;
+    output.desc = DmlTensorDesc::Create(
+        ctx->GetOutputDataType(0), output_tensor_shape, output_tensor_shape);
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {images, shift, scale};
+    tensors.outputs = {output};
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto result = dml::InputTensor(scope, 0, inputs[0]);
+    auto shift_tensor = dml::InputTensor(scope, 1, inputs[1]);
+    auto scale_tensor = dml::InputTensor(scope, 2, inputs[2]);
+
+    bool is_identity = input_tensor_shape == output_tensor_shape;
+
+    // Resample in floats like the standalone ResizeBilinear kernel does; the
+    // conversion to the final dtype happens after the resample, in the same
+    // graph.
+    if (result.GetOutputDesc().dataType != DML_TENSOR_DATA_TYPE_FLOAT32) {
+      result = dml::Cast(result, DML_TENSOR_DATA_TYPE_FLOAT32);
+    }
+
+    if (!is_identity) {
+      bool half_pixel_centers = init_helper->HalfPixelCenters();
+      float input_offset = half_pixel_centers ? 0.5f : 0.0f;
+      float output_offset = half_pixel_centers ? -0.5f : 0.0f;
+
+      const ImageResizerState& image_resizer_state =
+          init_helper->GetImageResizerState();
+
+      float height_scale = 1.0f / image_resizer_state.height_scale;
+      float width_scale = 1.0f / image_resizer_state.width_scale;
+      float scales[] = {1.0f, height_scale, width_scale, 1.0f};
+
+      float input_pixel_offsets[] = {0.5f, input_offset, input_offset, 0.5f};
+      float output_pixel_offsets[] = {-0.5f, output_offset, output_offset,
+                                      -0.5f};
+
+      auto output_sizes = NarrowTensorShape(output_tensor_shape);
+
+      result = dml::Resample(
+          result,
+          dml::TensorDesc::Dimensions(output_sizes.begin(), output_sizes.end()),
+          DML_INTERPOLATION_MODE_LINEAR, scales, input_pixel_offsets,
+          output_pixel_offsets);
+    }
+
+    DML_TENSOR_DATA_TYPE out_dml_type = shift_tensor.GetOutputDesc().dataType;
+    if (result.GetOutputDesc().dataType != out_dml_type) {
+      result = dml::Cast(result, out_dml_type);
+    }
+
+    result = (result - shift_tensor) * scale_tensor;
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                                         \
+  REGISTER_KERNEL_BUILDER(Name("_DmlFusedResizeNormalize")                \
+                              .Device(DEVICE_DML)                         \
+                              .TypeConstraint<type>("T")                  \
+                              .HostMemory("size"),                        \
+                          DmlKernelWrapper<DmlFusedResizeNormalizeKernel, \
+                                           GetResizeShapeHelper>);
+
+// Same input types as the DML ResizeBilinear kernel; the output type is
+// constrained to half/float by the op definition.
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+TF_CALL_uint8(DML_REGISTER_KERNEL);
+TF_CALL_int8(DML_REGISTER_KERNEL);
+TF_CALL_uint16(DML_REGISTER_KERNEL);
+TF_CALL_int16(DML_REGISTER_KERNEL);
+TF_CALL_int32(DML_REGISTER_KERNEL);
+TF_CALL_int64(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
+
 }  // namespace tensorflow
\ No newline at end of file
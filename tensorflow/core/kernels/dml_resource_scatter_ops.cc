@@ -340,7 +340,9 @@ struct ScatterNdBinaryOperation {
 
 template <typename Index, typename BinaryOp>
 class DmlResourceScatterNDBinaryKernel : public DmlKernel {
-  absl::optional<DmlBuffer> strides_buffer_;
+  // Shared with other kernels that need an identical strides array; see
+  // DmlConstantPool.
+  std::shared_ptr<const DmlBuffer> strides_buffer_;
 
  public:
   using InitHelper = ResourceScatterNDInitHelper<Index>;
@@ -428,12 +430,26 @@ class DmlResourceScatterNDBinaryKernel : public DmlKernel {
     auto result = BinaryOp()(graph, input, indices, updates, strides,
                              Is64BitIntegerType(indices_dtype));
 
-    const uint32_t buffer_size = indices_last_dim * DataTypeSize(indices_dtype);
-    strides_buffer_ = ctx->AllocateDefaultBuffer(buffer_size);
+    // The strides are a pure function of the construction-time shapes (which
+    // the compiled op is also specialized on), so upload them once through
+    // the device's constant pool; kernels whose params/indices shapes produce
+    // identical strides share a single GPU buffer.
+    absl::InlinedVector<Index, 8> stride_values(indices_last_dim);
+    Index stride = 1;
+
+    for (int i = indices_last_dim - 1; i >= 0; --i) {
+      stride_values[i] = stride;
+      stride *= in_out_shape.dim_size(i);
+    }
 
-    OP_REQUIRES(ctx->GetOpKernelContext(), strides_buffer_,
-                errors::ResourceExhausted("OOM when allocating a buffer of ",
-                                          buffer_size, " bytes"));
+    auto strides_bytes = absl::MakeSpan(
+        reinterpret_cast<const uint8_t*>(stride_values.data()),
+        stride_values.size() * sizeof(Index));
+
+    auto status_or_strides_buffer = ctx->AcquireConstantBuffer(strides_bytes);
+    OP_REQUIRES_OK(ctx->GetOpKernelContext(),
+                   status_or_strides_buffer.status());
+    strides_buffer_ = status_or_strides_buffer.ConsumeValueOrDie();
 
     Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
         graph.Compile(DML_EXECUTION_FLAG_NONE, {result});
@@ -450,27 +466,6 @@ class DmlResourceScatterNDBinaryKernel : public DmlKernel {
     const Tensor params_tensor =
         init_helper->GetParamsTensor(ctx->GetOpKernelContext());
 
-    const Tensor indices_tensor = ctx->GetInputTensor(1);
-
-    const int64 indices_last_dim =
-        indices_tensor.dim_size(indices_tensor.dims() - 1);
-
-    absl::InlinedVector<Index, 8> strides(indices_last_dim);
-    Index stride = 1;
-
-    for (int i = indices_last_dim - 1; i >= 0; --i) {
-      strides[i] = stride;
-      stride *= params_tensor.dim_size(i);
-    }
-
-    auto byte_ptr = reinterpret_cast<const uint8_t*>(strides.data());
-    auto byte_span = absl::MakeSpan(byte_ptr, strides.size() * sizeof(Index));
-
-    const auto status_or_event = ctx->CopyHostToBuffer(
-        strides_buffer_->Resource(), strides_buffer_->Offset(), byte_span);
-
-    TF_RETURN_IF_ERROR(status_or_event.status());
-
     // Create input buffers
     D3D12BufferRegion input_buffers[] = {
         ctx->CreateBufferForTensor(params_tensor),
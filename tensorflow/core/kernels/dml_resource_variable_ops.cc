@@ -87,9 +87,14 @@ class DmlUpdateVariableOp : public DmlKernel {
           ", shapes must be equal.");
     }
 
-    TF_RETURN_IF_ERROR(PrepareToUpdateVariable(
-        op_ctx, var_tensor, variable->copy_on_read_mode.load(),
-        &dml_util::CopyTensorInSameDevice));
+    // Skip the defensive copy when the buffer's extra references (if any) all
+    // belong to GPU reads that are ordered before this kernel's execution on
+    // the compute queue, e.g. a checkpoint readback that is still in flight.
+    if (!dml_util::CanUpdateVariableInPlace(op_ctx, variable.get())) {
+      TF_RETURN_IF_ERROR(PrepareToUpdateVariable(
+          op_ctx, var_tensor, variable->copy_on_read_mode.load(),
+          &dml_util::CopyTensorInSameDevice));
+    }
 
     D3D12BufferRegion var_resource = ctx->CreateBufferForTensor(*var_tensor);
     D3D12BufferRegion value_resource = ctx->CreateBufferForTensor(value);
@@ -23,6 +23,15 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Axis lengths below this threshold use DirectML's cumulative operators
+// directly; longer axes take the tiled two-level scan, whose extra dispatches
+// only pay off once the single-dispatch scan's dependent chain dominates.
+constexpr int64 kTiledScanThreshold = 4096;
+
+// Block length of the tiled scan's first level. Chosen so that both levels'
+// dependent chains stay short: a 10k axis splits into ~20 blocks of 512.
+constexpr uint32_t kScanBlockSize = 512;
+
 template <typename Tidx>
 class ScanInitHelper : public InitializationHelper {
  public:
@@ -116,8 +125,65 @@ class DmlScanKernel : public DmlKernel {
     auto inputs = GetDmlTensorDescs(tensors.inputs);
     auto scope = dml::Graph(ctx->GetDmlDevice());
     const auto input_tensor = dml::InputTensor(scope, 0, inputs[0]);
-    auto result = ScanFunctor()(input_tensor, dml_axis, axis_direction,
-                                init_helper->IsExclusive());
+
+    const bool exclusive = init_helper->IsExclusive();
+    dml::Expression result;
+
+    // DirectML's cumulative operators walk the scanned axis as one dependent
+    // chain per row, so long axes run at chain latency instead of memory
+    // bandwidth. Long axes therefore take a work-efficient two-level scan:
+    // fixed-size blocks are scanned independently, an exclusive scan over the
+    // per-block totals yields each block's carried-in offset, and the two are
+    // combined - three bandwidth-bound dispatches whose chains are only
+    // kScanBlockSize and block_count long. 64-bit integer tensors stay on the
+    // direct path: their descs view the low dwords with doubled strides,
+    // which the packed reshapes below would misread.
+    if (axis_dim_size < kTiledScanThreshold ||
+        Is64BitSignedIntegerType(ctx->GetOutputDataType(0))) {
+      result = ScanFunctor()(input_tensor, dml_axis, axis_direction, exclusive);
+    } else {
+      const uint32_t left = static_cast<uint32_t>(left_dim_size);
+      const uint32_t right = static_cast<uint32_t>(right_dim_size);
+      const uint32_t axis_size = static_cast<uint32_t>(axis_dim_size);
+      const uint32_t block_count =
+          (axis_size + kScanBlockSize - 1) / kScanBlockSize;
+      const uint32_t padded_size = block_count * kScanBlockSize;
+
+      // Pad the tail with the scan's identity so the extra lanes influence
+      // nothing. For reverse scans the padding sits at the accumulation
+      // start, where the identity is equally harmless.
+      auto padded = input_tensor;
+      if (padded_size != axis_size) {
+        padded = dml::Padding(padded, DML_PADDING_MODE_CONSTANT,
+                              ScanFunctor::kPadIdentity, {0, 0, 0, 0},
+                              {0, 0, padded_size - axis_size, 0});
+      }
+
+      auto blocks = dml::Reinterpret(
+          padded, {left, block_count, kScanBlockSize, right}, dml::NullOpt);
+
+      auto intra = ScanFunctor()(blocks, 2, axis_direction, exclusive);
+
+      // Block totals are full reductions regardless of exclusivity; only the
+      // scan over them honors the flags.
+      auto totals = dml::Reduce(blocks, ScanFunctor::kBlockReduceFunction, {2});
+      auto offsets = ScanFunctor()(totals, 1, axis_direction,
+                                   /*exclusive=*/true);
+
+      // Broadcast each block's offset across the block by zeroing its stride.
+      dml::TensorDesc::Dimensions offset_strides = {block_count * right, right,
+                                                    0, 1};
+      auto offsets_bcast = dml::Reinterpret(
+          offsets, {left, block_count, kScanBlockSize, right}, offset_strides);
+
+      auto combined = ScanFunctor::Combine(intra, offsets_bcast);
+      auto flat = dml::Reinterpret(combined, {1, left, padded_size, right},
+                                   dml::NullOpt);
+      result = padded_size == axis_size
+                   ? flat
+                   : dml::Slice(flat, {0, 0, 0, 0}, {1, left, axis_size, right},
+                                {1, 1, 1, 1});
+    }
 
     // TFDML #24881131
     if (Is64BitSignedIntegerType(ctx->GetOutputDataType(0))) {
@@ -132,6 +198,14 @@ class DmlScanKernel : public DmlKernel {
 };
 
 struct CumsumFunctor {
+  static constexpr DML_REDUCE_FUNCTION kBlockReduceFunction =
+      DML_REDUCE_FUNCTION_SUM;
+  static constexpr float kPadIdentity = 0.0f;
+
+  static dml::Expression Combine(dml::Expression a, dml::Expression b) {
+    return a + b;
+  }
+
   dml::Expression operator()(dml::Expression input, uint32_t axis,
                              DML_AXIS_DIRECTION axis_direction,
                              bool has_exclusive_sum) {
@@ -141,6 +215,14 @@ struct CumsumFunctor {
 };
 
 struct CumprodFunctor {
+  static constexpr DML_REDUCE_FUNCTION kBlockReduceFunction =
+      DML_REDUCE_FUNCTION_MULTIPLY;
+  static constexpr float kPadIdentity = 1.0f;
+
+  static dml::Expression Combine(dml::Expression a, dml::Expression b) {
+    return a * b;
+  }
+
   dml::Expression operator()(dml::Expression input, uint32_t axis,
                              DML_AXIS_DIRECTION axis_direction,
                              bool has_exclusive_product) {
@@ -212,6 +212,11 @@ class ScatterNdInitHelper : public InitializationHelper {
   }
 };
 
+// The duplicate-summing path compares linearized indices as floats, which is
+// only exact for values below 2^24. Valid linearized indices are bounded by
+// the number of slices in the output.
+constexpr uint64 kMaxSortableScatterRows = 1ull << 24;
+
 template <typename Index>
 class DmlScatterNdKernel : public DmlKernel {
  public:
@@ -223,6 +228,35 @@ class DmlScatterNdKernel : public DmlKernel {
     const TensorShape& updates_shape = ctx->GetInputTensorShape(1);
     const TensorShape& in_out_shape = ctx->GetOutputTensorShape(0);
 
+    const int64 slice_dim =
+        indices_shape.dims() > 1
+            ? indices_shape.dim_size(indices_shape.dims() - 1)
+            : 1;
+    const int64 update_count = indices_shape.num_elements() / slice_dim;
+
+    int64 table_rows = 1;
+    for (int64 i = 0; i < slice_dim; ++i) {
+      table_rows *= in_out_shape.dim_size(i);
+    }
+    const int64 slice_size = in_out_shape.num_elements() / table_rows;
+
+    // TF requires duplicate indices to be summed, but DML_OPERATOR_SCATTER_ND
+    // leaves an unspecified writer as the winner. Duplicates are summed
+    // deterministically by sorting the linearized indices instead, which
+    // turns each slice's sum into a difference of two cumulative sums (the
+    // same strategy the segment reduction kernels use). The raw scatter
+    // remains as a fallback for output tables too large for exact float sort
+    // keys and for single-update scatters, which can't have duplicates.
+    use_duplicate_summing_path_ = update_count >= 2 &&
+                                  static_cast<uint64>(table_rows) <
+                                      kMaxSortableScatterRows;
+
+    if (use_duplicate_summing_path_) {
+      InitializeDuplicateSummingPath(ctx, slice_dim, update_count, table_rows,
+                                     slice_size);
+      return;
+    }
+
     DmlTensorInfo params_tensor;
     params_tensor.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(0),
                                                in_out_shape, TensorShape({1}));
@@ -266,6 +300,10 @@ class DmlScatterNdKernel : public DmlKernel {
   }
 
   StatusOr<DmlGpuEvent> Compute(DmlKernelContext* ctx) const override {
+    if (use_duplicate_summing_path_) {
+      return DmlKernel::Compute(ctx);
+    }
+
     DmlBuffer params_buffer = ctx->AllocateDefaultBuffer(input_buffer_size_);
 
     D3D12BufferRegion indices_buffer =
@@ -292,6 +330,178 @@ class DmlScatterNdKernel : public DmlKernel {
   }
 
  private:
+  void InitializeDuplicateSummingPath(DmlKernelConstruction* ctx,
+                                      int64 slice_dim, int64 update_count,
+                                      int64 table_rows, int64 slice_size) {
+    const TensorShape& in_out_shape = ctx->GetOutputTensorShape(0);
+
+    const TensorShape flat_indices_shape({update_count, slice_dim});
+    const TensorShape flat_updates_shape({update_count, slice_size});
+    const TensorShape flat_output_shape({table_rows, slice_size});
+
+    DmlTensorInfo indices_tensor;
+    indices_tensor.kernel_index = 0;
+    indices_tensor.desc = DmlTensorDesc::Create(
+        ctx->GetInputDataType(0), flat_indices_shape, flat_indices_shape);
+
+    DmlTensorInfo updates_tensor;
+    updates_tensor.kernel_index = 1;
+    updates_tensor.desc = DmlTensorDesc::Create(
+        ctx->GetInputDataType(1), flat_updates_shape, flat_updates_shape);
+
+    DmlTensorInfo output_tensor;
+    output_tensor.kernel_index = 0;
+    output_tensor.desc = DmlTensorDesc::Create(
+        ctx->GetOutputDataType(0), flat_output_shape, flat_output_shape);
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {indices_tensor, updates_tensor};
+    tensors.outputs = {output_tensor};
+
+    const uint32_t n = static_cast<uint32_t>(update_count);
+    const uint32_t cols = static_cast<uint32_t>(slice_dim);
+    const uint32_t rows = static_cast<uint32_t>(table_rows);
+    const uint32_t inner = static_cast<uint32_t>(slice_size);
+
+    // TODO: Remove the Is64BitIntegerType hack when DML has a more solid
+    // solution for 64 bit datatypes
+    // TFDML #24881131
+    const uint32_t indices_stride_multiplier =
+        Is64BitIntegerType(ctx->GetInputDataType(0)) ? 2 : 1;
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto indices = dml::InputTensor(scope, 0, inputs[0]);
+    auto updates = dml::InputTensor(scope, 1, inputs[1]);
+
+    auto index_components = dml::Reinterpret(
+        indices, dml::TensorDesc::Dimensions({1, 1, n, cols}),
+        dml::TensorDesc::Dimensions({0, 0, cols * indices_stride_multiplier,
+                                     indices_stride_multiplier}));
+
+    // Linearize each multi-dimensional index into a single row number of the
+    // flattened output table. Any update with an out-of-range component is
+    // diverted to the dummy row past the end of the table, mirroring the GPU
+    // behavior of dropping invalid updates.
+    dml::TensorDesc::Dimensions component_sizes({1, 1, n, 1});
+    auto zero = dml::ScalarTensor<int32_t>(scope, 0, component_sizes);
+    auto dummy_key = dml::ScalarTensor<int32_t>(
+        scope, static_cast<int32_t>(rows), component_sizes);
+
+    absl::InlinedVector<dml::Expression, 8> components;
+    dml::Expression keys;
+
+    int64 row_stride = 1;
+    absl::InlinedVector<int32_t, 8> row_strides(slice_dim);
+    for (int64 j = slice_dim - 1; j >= 0; --j) {
+      row_strides[j] = static_cast<int32_t>(row_stride);
+      row_stride *= in_out_shape.dim_size(j);
+    }
+
+    for (uint32_t j = 0; j < cols; ++j) {
+      auto component =
+          dml::Slice(index_components, {0, 0, 0, j}, {1, 1, n, 1},
+                     {1, 1, 1, 1});
+      components.push_back(component);
+
+      auto term = component * dml::ScalarTensor<int32_t>(
+                                  scope, row_strides[j], component_sizes);
+      keys = j == 0 ? term : keys + term;
+    }
+
+    for (uint32_t j = 0; j < cols; ++j) {
+      auto dim_size = dml::ScalarTensor<int32_t>(
+          scope, static_cast<int32_t>(in_out_shape.dim_size(j)),
+          component_sizes);
+      keys = dml::If(components[j] < zero, dummy_key, keys);
+      keys = dml::If(components[j] >= dim_size, dummy_key, keys);
+    }
+
+    // Sorting the keys groups duplicate indices into contiguous runs, so each
+    // output slice becomes the difference between two values of a cumulative
+    // sum over the reordered updates: the one at the run's last row and the
+    // one at the last row before the run starts. Both are picked out by
+    // scattering the cumulative sum at the run boundaries, where each valid
+    // output row has exactly one writer. Float keys are exact here because
+    // valid keys are bounded by the table size < 2^24.
+    auto keys_flat =
+        dml::Reinterpret(keys, dml::TensorDesc::Dimensions({1, 1, 1, n}), {});
+    auto sort_keys = dml::Cast(keys_flat, DML_TENSOR_DATA_TYPE_FLOAT32);
+    auto sorted = dml::TopK(sort_keys, 3, n, DML_AXIS_DIRECTION_INCREASING);
+
+    dml::TensorDesc::Dimensions key_sizes({1, 1, n, 1});
+    auto sorted_keys = dml::Reinterpret(
+        dml::Cast(sorted.value, DML_TENSOR_DATA_TYPE_INT32), key_sizes, {});
+
+    auto sorted_updates = dml::Gather(updates, sorted.index, 2, 1);
+
+    // Accumulate halfs in floats; the cumulative sum runs over the entire
+    // updates tensor and would lose too much precision otherwise.
+    if (sorted_updates.GetOutputDesc().dataType ==
+        DML_TENSOR_DATA_TYPE_FLOAT16) {
+      sorted_updates = dml::Cast(sorted_updates, DML_TENSOR_DATA_TYPE_FLOAT32);
+    }
+
+    auto updates_cumsum = dml::CumulativeSummation(
+        sorted_updates, 2, DML_AXIS_DIRECTION_INCREASING, false);
+
+    // A row ends its run when the next row has a different key; the sentinel
+    // makes the last row a boundary.
+    auto next_keys = dml::Join(
+        {dml::Slice(sorted_keys, {0, 0, 1, 0}, {1, 1, n - 1, 1}, {1, 1, 1, 1}),
+         dml::ScalarTensor<int32_t>(scope, static_cast<int32_t>(rows),
+                                    {1, 1, 1, 1})},
+        2);
+
+    auto is_boundary = sorted_keys != next_keys;
+
+    auto zero_key = dml::ScalarTensor<int32_t>(scope, 0, key_sizes);
+    auto dummy_row = dml::ScalarTensor<int32_t>(
+        scope, static_cast<int32_t>(rows), key_sizes);
+
+    auto end_keys = dml::If(is_boundary, sorted_keys, dummy_row);
+    end_keys = dml::If(end_keys < zero_key, dummy_row, end_keys);
+    end_keys = dml::If(end_keys > dummy_row, dummy_row, end_keys);
+
+    auto start_keys = dml::If(is_boundary, next_keys, dummy_row);
+    start_keys = dml::If(start_keys < zero_key, dummy_row, start_keys);
+    start_keys = dml::If(start_keys > dummy_row, dummy_row, start_keys);
+
+    dml::TensorDesc::Dimensions scatter_sizes({1, 1, rows + 1, inner});
+    dml::TensorDesc::Dimensions update_sizes({1, 1, n, inner});
+    dml::TensorDesc::Dimensions key_broadcast_strides({0, 0, 1, 0});
+
+    auto accumulator_type = updates_cumsum.GetOutputDesc().dataType;
+    auto zeros = dml::ZeroTensor(scope, accumulator_type, scatter_sizes);
+
+    auto run_ends = dml::ScatterElements(
+        zeros, dml::Reinterpret(end_keys, update_sizes, key_broadcast_strides),
+        updates_cumsum, 2);
+    auto run_starts = dml::ScatterElements(
+        zeros,
+        dml::Reinterpret(start_keys, update_sizes, key_broadcast_strides),
+        updates_cumsum, 2);
+
+    // Rows no update targets stay at zero, which is exactly ScatterNd's
+    // background value.
+    dml::TensorDesc::Dimensions result_extent({1, 1, rows, inner});
+    auto result =
+        dml::Slice(run_ends, {0, 0, 0, 0}, result_extent, {1, 1, 1, 1}) -
+        dml::Slice(run_starts, {0, 0, 0, 0}, result_extent, {1, 1, 1, 1});
+
+    auto output_type =
+        GetDmlDataTypeFromTfDataType(ctx->GetOutputDataType(0));
+    if (result.GetOutputDesc().dataType != output_type) {
+      result = dml::Cast(result, output_type);
+    }
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+
+  bool use_duplicate_summing_path_ = false;
   uint64_t input_buffer_size_ = 0;
 };
 
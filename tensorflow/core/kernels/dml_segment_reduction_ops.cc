@@ -145,6 +145,143 @@ struct SegmentReductionFunctor {
   }
 };
 
+// The masked-reduce functor above materializes intermediates of
+// num_segments * row_count * inner_size elements, which is only acceptable
+// for small segment counts. Past this budget, sums switch to a sort-based
+// strategy whose transient memory is linear in the data size.
+constexpr uint64 kDenseSegmentReductionElementLimit = 1ull << 22;
+
+// The sort-based strategy compares segment ids as floats, which is only exact
+// for values below 2^24. Valid segment ids are bounded by the segment count.
+constexpr uint64 kMaxSortableSegments = 1ull << 24;
+
+// Sums segments by sorting the segment ids. Sorting groups each segment into
+// a contiguous run of rows, so every segment sum becomes the difference
+// between two values of a single cumulative sum over the reordered data: the
+// one at the segment's last row and the one at the last row before the
+// segment starts. Both are picked out by scattering the cumulative sum at the
+// segment boundaries, where each valid output row is written by exactly one
+// boundary. Rows with out-of-range ids sort to the ends and are diverted to
+// an extra output row that is sliced away, which also leaves empty segments
+// at zero. Everything compiles into a single DML operator, and the heavy
+// steps (sort, gather, cumulative sum) are all linear-ish in the data size
+// regardless of the segment count.
+template <typename TData>
+struct SortedSegmentSumFunctor {
+  dml::Expression operator()(dml::Graph& scope, dml::Expression data,
+                             dml::Expression segment_ids, uint32_t num_segments,
+                             bool int64_indices) {
+    auto data_sizes = data.GetOutputDesc().sizes;
+    const uint32_t row_count = data_sizes[data_sizes.size() - 2];
+    const uint32_t inner_size = data_sizes[data_sizes.size() - 1];
+
+    uint32_t indices_stride_multiplier = int64_indices ? 2 : 1;
+
+    auto flat_segment_ids = dml::Reinterpret(
+        segment_ids, dml::TensorDesc::Dimensions({1, 1, 1, row_count}),
+        dml::TensorDesc::Dimensions({0, 0, 0, indices_stride_multiplier}));
+
+    // TOP_K over the whole row does the sort. Float keys are exact here
+    // because valid ids are bounded by num_segments < 2^24.
+    auto sort_keys = dml::Cast(flat_segment_ids, DML_TENSOR_DATA_TYPE_FLOAT32);
+    auto sorted =
+        dml::TopK(sort_keys, 3, row_count, DML_AXIS_DIRECTION_INCREASING);
+
+    dml::TensorDesc::Dimensions id_sizes({1, 1, row_count, 1});
+    auto sorted_ids = dml::Reinterpret(
+        dml::Cast(sorted.value, DML_TENSOR_DATA_TYPE_INT32), id_sizes, {});
+
+    auto sorted_data = dml::Gather(data, sorted.index, 2, 1);
+
+    // Accumulate halfs in floats; the cumulative sum runs over the entire
+    // data tensor and would lose too much precision otherwise.
+    if (sorted_data.GetOutputDesc().dataType == DML_TENSOR_DATA_TYPE_FLOAT16) {
+      sorted_data = dml::Cast(sorted_data, DML_TENSOR_DATA_TYPE_FLOAT32);
+    }
+
+    auto data_cumsum = dml::CumulativeSummation(
+        sorted_data, 2, DML_AXIS_DIRECTION_INCREASING, false);
+
+    // A row ends its segment when the next row has a different id; the
+    // sentinel makes the last row a boundary.
+    auto next_ids = dml::Join(
+        {dml::Slice(sorted_ids, {0, 0, 1, 0}, {1, 1, row_count - 1, 1},
+                    {1, 1, 1, 1}),
+         dml::ScalarTensor<int32_t>(scope, static_cast<int32_t>(num_segments),
+                                    {1, 1, 1, 1})},
+        2);
+
+    auto is_boundary = sorted_ids != next_ids;
+
+    auto zero_id = dml::ScalarTensor<int32_t>(scope, 0, id_sizes);
+    auto dummy_id = dml::ScalarTensor<int32_t>(
+        scope, static_cast<int32_t>(num_segments), id_sizes);
+
+    // A boundary row carries its segment's inclusive prefix sum; the same row
+    // is also where the next segment's rows start. Non-boundary rows and
+    // out-of-range ids go to the dummy row.
+    auto end_ids = dml::If(is_boundary, sorted_ids, dummy_id);
+    end_ids = dml::If(end_ids < zero_id, dummy_id, end_ids);
+    end_ids = dml::If(end_ids > dummy_id, dummy_id, end_ids);
+
+    auto start_ids = dml::If(is_boundary, next_ids, dummy_id);
+    start_ids = dml::If(start_ids < zero_id, dummy_id, start_ids);
+    start_ids = dml::If(start_ids > dummy_id, dummy_id, start_ids);
+
+    dml::TensorDesc::Dimensions scatter_sizes(
+        {1, 1, num_segments + 1, inner_size});
+    dml::TensorDesc::Dimensions update_sizes({1, 1, row_count, inner_size});
+    dml::TensorDesc::Dimensions id_broadcast_strides({0, 0, 1, 0});
+
+    auto accumulator_type = data_cumsum.GetOutputDesc().dataType;
+    auto zeros = dml::ZeroTensor(scope, accumulator_type, scatter_sizes);
+
+    auto segment_ends = dml::ScatterElements(
+        zeros, dml::Reinterpret(end_ids, update_sizes, id_broadcast_strides),
+        data_cumsum, 2);
+    auto segment_starts = dml::ScatterElements(
+        zeros, dml::Reinterpret(start_ids, update_sizes, id_broadcast_strides),
+        data_cumsum, 2);
+
+    dml::TensorDesc::Dimensions result_extent(
+        {1, 1, num_segments, inner_size});
+    auto result =
+        dml::Slice(segment_ends, {0, 0, 0, 0}, result_extent, {1, 1, 1, 1}) -
+        dml::Slice(segment_starts, {0, 0, 0, 0}, result_extent, {1, 1, 1, 1});
+
+    if (result.GetOutputDesc().dataType != data.GetOutputDesc().dataType) {
+      result = dml::Cast(result, data.GetOutputDesc().dataType);
+    }
+
+    return result;
+  }
+};
+
+// Picks a segment sum strategy from the segment count: the masked reduce is
+// the fastest for a handful of segments, but its intermediates (and its
+// work) grow with num_segments * row_count, so large segment counts use the
+// sort-based path instead.
+template <typename TData>
+struct AdaptiveSegmentSumFunctor {
+  dml::Expression operator()(dml::Graph& scope, dml::Expression data,
+                             dml::Expression segment_ids, uint32_t num_segments,
+                             bool int64_indices) {
+    auto data_sizes = data.GetOutputDesc().sizes;
+    const uint64 row_count = data_sizes[data_sizes.size() - 2];
+    const uint64 inner_size = data_sizes[data_sizes.size() - 1];
+    const uint64 dense_elements = num_segments * row_count * inner_size;
+
+    if (row_count >= 2 && num_segments < kMaxSortableSegments &&
+        dense_elements > kDenseSegmentReductionElementLimit) {
+      return SortedSegmentSumFunctor<TData>()(scope, data, segment_ids,
+                                              num_segments, int64_indices);
+    }
+
+    return SegmentReductionFunctor<DML_REDUCE_FUNCTION_SUM, TData>()(
+        scope, data, segment_ids, num_segments, int64_indices);
+  }
+};
+
 template <typename SegmentReductionOp>
 class DmlSegmentReductionKernel : public DmlKernel {
  public:
@@ -209,55 +346,31 @@ class DmlSegmentReductionKernel : public DmlKernel {
   }
 };
 
-// The memory of this implementation is too big at the moment, so we should
-// revisit this operator later if we want to support it with a new DML API
-/*
-#define REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL_INDEX(type, name, op,  \
-                                                         index_type)      \
-  REGISTER_KERNEL_BUILDER(Name(name)                                      \
-                              .Device(DEVICE_DML)                         \
-                              .HostMemory("num_segments")                 \
-                              .TypeConstraint<type>("T")                  \
-                              .TypeConstraint<index_type>("Tindices"),    \
-                          DmlKernelWrapper<DmlSegmentReductionKernel<op>, \
-                                           SegmentReductionShapeHelper>)
-
-#define REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL(type, name, op)         \
-  REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL_INDEX(type, name, op, int32); \
-  REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL_INDEX(type, name, op, int64);
-
-template <typename type>
-using SegmentReductionSumOp =
-    SegmentReductionFunctor<DML_REDUCE_FUNCTION_SUM, type>;
-
-template <typename type>
-using SegmentReductionMaxOp =
-    SegmentReductionFunctor<DML_REDUCE_FUNCTION_MAX, type>;
-
-template <typename type>
-using SegmentReductionMinOp =
-    SegmentReductionFunctor<DML_REDUCE_FUNCTION_MIN, type>;
-
-template <typename type>
-using SegmentReductionProdOp =
-    SegmentReductionFunctor<DML_REDUCE_FUNCTION_MULTIPLY, type>;
-
-#define REGISTER_UNSORTED_SEGMENT_REDUCTION_DML_KERNEL(type)               \
-  REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL(type, "UnsortedSegmentSum",   \
-                                             SegmentReductionSumOp<type>); \
-  REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL(type, "UnsortedSegmentMax",   \
-                                             SegmentReductionMaxOp<type>); \
-  REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL(type, "UnsortedSegmentMin",   \
-                                             SegmentReductionMinOp<type>); \
-  REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL(type, "UnsortedSegmentProd",  \
-                                             SegmentReductionProdOp<type>);
-
-TF_CALL_float(REGISTER_UNSORTED_SEGMENT_REDUCTION_DML_KERNEL);
-TF_CALL_half(REGISTER_UNSORTED_SEGMENT_REDUCTION_DML_KERNEL);
-TF_CALL_int32(REGISTER_UNSORTED_SEGMENT_REDUCTION_DML_KERNEL);
-#undef REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL
-#undef REGISTER_UNSORTED_SEGMENT_REDUCTION_KERNEL_INDEX
-#undef REGISTER_UNSORTED_SEGMENT_REDUCTION_DML_KERNEL
-*/
+// Only the sum is registered: the adaptive functor keeps its memory bounded
+// for any segment count, while Min/Max/Prod only have the masked-reduce
+// strategy (DML has no cumulative min/max) and would regress to unbounded
+// intermediates. SegmentSum itself also stays unregistered; its output row
+// count comes from the last element of a device-resident ids tensor, which
+// would force a readback and a graph recompile every step.
+#define REGISTER_UNSORTED_SEGMENT_SUM_KERNEL_INDEX(type, index_type) \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("UnsortedSegmentSum")                                     \
+          .Device(DEVICE_DML)                                        \
+          .HostMemory("num_segments")                                \
+          .TypeConstraint<type>("T")                                 \
+          .TypeConstraint<index_type>("Tindices"),                   \
+      DmlKernelWrapper<                                              \
+          DmlSegmentReductionKernel<AdaptiveSegmentSumFunctor<type>>, \
+          SegmentReductionShapeHelper>)
+
+#define REGISTER_UNSORTED_SEGMENT_SUM_KERNEL(type)         \
+  REGISTER_UNSORTED_SEGMENT_SUM_KERNEL_INDEX(type, int32); \
+  REGISTER_UNSORTED_SEGMENT_SUM_KERNEL_INDEX(type, int64);
+
+TF_CALL_float(REGISTER_UNSORTED_SEGMENT_SUM_KERNEL);
+TF_CALL_half(REGISTER_UNSORTED_SEGMENT_SUM_KERNEL);
+TF_CALL_int32(REGISTER_UNSORTED_SEGMENT_SUM_KERNEL);
+#undef REGISTER_UNSORTED_SEGMENT_SUM_KERNEL
+#undef REGISTER_UNSORTED_SEGMENT_SUM_KERNEL_INDEX
 
 }  // namespace tensorflow
@@ -299,8 +299,11 @@ class SelectV2InitHelper : public BaseSelectInitHelper {
         BCast::ToShape(then_bcast.y_reshape()),
         BCast::ToShape(else_bcast.y_reshape()), broadcasted_output_shape_);
 
+    // Gate on whether coalescing succeeded rather than on the raw rank: shapes
+    // with more than 8 dimensions are still executable with strided broadcast
+    // descs as long as their non-broadcast dimensions coalesce down to 8D.
     OP_REQUIRES(
-        ctx, broadcasted_output_shape_.dims() <= 8,
+        ctx, simple_ternary.has_value(),
         errors::InvalidArgument(
             "DML doesn't support more than 8 dimensions for Select after "
             "collapsing non-broadcast dimensions together, but could "
@@ -43,6 +43,87 @@ static absl::InlinedVector<uint32_t, 5> GetSliceSizes(
   return uint32_sizes;
 }
 
+class SliceInitHelper : public InitializationHelper {
+ public:
+  using Attributes = EmptyAttributes;
+
+  SliceInitHelper(OpKernelContext* ctx, std::shared_ptr<const Attributes> attr) {}
+
+  // A slice which only trims the outermost non-trivial dimension selects a
+  // contiguous range of the input's buffer, so the output can alias the input
+  // at an offset instead of copying.
+  absl::optional<Tensor> GetContiguousInputView(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const override {
+    const Tensor& input = ctx->input(0);
+
+    // 64-bit integer kernels pad their tensor descs past the logical end of
+    // the data, which a tightly-sized view can't satisfy.
+    if (Is64BitIntegerType(input.dtype())) {
+      return absl::nullopt;
+    }
+
+    if (ctx->input_memory_type(0) != DEVICE_MEMORY || ctx->input_is_ref(0)) {
+      return absl::nullopt;
+    }
+
+    auto offsets = IntTensorToVec<uint32_t>(ctx->input(1));
+    auto sizes = GetSliceSizes(ctx->input(2), input.shape(), offsets);
+
+    // At most one dimension may be partially included in the slice, and every
+    // dimension before it must have size 1; otherwise the selected elements
+    // aren't contiguous in memory.
+    int partial_dim = -1;
+    for (int i = 0; i < input.dims(); ++i) {
+      if (offsets[i] == 0 && sizes[i] == input.dim_size(i)) {
+        continue;
+      }
+      if (partial_dim >= 0) {
+        return absl::nullopt;
+      }
+      partial_dim = i;
+    }
+
+    int64 element_offset = 0;
+    if (partial_dim >= 0) {
+      for (int i = 0; i < partial_dim; ++i) {
+        if (input.dim_size(i) != 1) {
+          return absl::nullopt;
+        }
+      }
+
+      int64 inner_elements = 1;
+      for (int i = partial_dim + 1; i < input.dims(); ++i) {
+        inner_elements *= input.dim_size(i);
+      }
+      element_offset = offsets[partial_dim] * inner_elements;
+    }
+
+    // DML buffer regions require the view's offset and size in bytes to be
+    // 4-byte aligned.
+    const int64 element_size = DataTypeSize(input.dtype());
+    const int64 output_elements = output_shapes[output_index].num_elements();
+    if ((element_offset * element_size) % 4 != 0 ||
+        (output_elements * element_size) % 4 != 0) {
+      return absl::nullopt;
+    }
+
+    Tensor flat;
+    if (!flat.CopyFrom(input, TensorShape({input.NumElements()}))) {
+      return absl::nullopt;
+    }
+
+    Tensor view;
+    if (!view.CopyFrom(flat.Slice(element_offset,
+                                  element_offset + output_elements),
+                       output_shapes[output_index])) {
+      return absl::nullopt;
+    }
+
+    return view;
+  }
+};
+
 class SliceShapeHelper : public ShapeHelper {
  public:
   std::vector<TensorShape> GetOutputShapes(
@@ -76,7 +157,7 @@ class SliceShapeHelper : public ShapeHelper {
 
 class DmlSliceKernel : public DmlKernel {
  public:
-  using InitHelper = NoOpInitializationHelper;
+  using InitHelper = SliceInitHelper;
 
   explicit DmlSliceKernel(DmlKernelConstruction* ctx,
                           const InitHelper* init_helper) {
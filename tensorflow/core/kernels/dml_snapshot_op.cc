@@ -14,28 +14,29 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 
 namespace tensorflow {
+
+// Snapshot exists to decouple its output from future mutations of its input
+// (typically a variable about to be updated in place). On DML the copy is
+// deferred until such a mutation actually happens: this kernel just aliases
+// its input, and every in-place writer checks for outstanding aliases of the
+// buffer before mutating it — resource variable kernels through
+// dml_util::CanUpdateVariableInPlace, legacy ref kernels through
+// dml_util::EnsureRefTensorCopyOnWrite — and redirects the variable to fresh
+// storage when any remain, leaving the old buffer to the aliases. Most
+// snapshots never see a writer and therefore never pay for a copy. Buffers
+// that aren't variables are never mutated after allocation (kernels only
+// write through allocate_output or refcount-gated forwarding), so aliasing
+// them is unconditionally safe.
 class DmlSnapshotOp : public OpKernel {
  public:
   explicit DmlSnapshotOp(OpKernelConstruction* context) : OpKernel(context) {}
 
   void Compute(OpKernelContext* context) override {
-    const Tensor& input = context->input(0);
-    Tensor* output = nullptr;
-    // Try to use buffer forwarding to avoid an explicit copy.
-    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
-                                {0}, 0, input.shape(), &output));
-    if (!output->SharesBufferWith(input)) {
-      DeviceContext* device_context = context->op_device_context();
-      Device* device = static_cast<Device*>(context->device());
-
-      device_context->CopyTensorInSameDevice(
-          &input, device, output,
-          [context](const Status& s) { OP_REQUIRES_OK(context, s); });
-    }
+    context->set_output(0, context->input(0));
   }
 };
 
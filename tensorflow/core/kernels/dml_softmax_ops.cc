@@ -14,9 +14,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
+
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/kernels/dml_kernel_wrapper.h"
 #include "tensorflow/core/kernels/dml_ops_common.h"
 #include "tensorflow/core/util/bcast.h"
@@ -185,4 +190,154 @@ class DmlSoftmaxXentWithLogitsKernel : public DmlKernel {
                                            SoftmaxXentWithLogitsShapeHelper>);
 TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
+
+// Softmax over the valid prefix of each row of a padded variable-length
+// batch. The usual masking recipe — add a large negative bias, then run a
+// full-width Softmax — costs two extra full passes over the logits (the mask
+// materialization and the add) before the softmax even starts, all of it
+// proportional to padding. This op folds the mask generation, the bias and
+// the softmax into one compiled DML graph driven directly by a per-row
+// `lengths` tensor: no mask tensor ever materializes, and padded lanes come
+// out as exact zeros (a length-0 row is all zeros, not NaN).
+//
+// `lengths` must have the logits' shape minus the trailing (class) dimension.
+// Unlike the other _Dml-prefixed internal ops, this one is intended to be
+// invoked by name from model tooling, since no existing TF op carries the
+// lengths tensor to rewrite from.
+REGISTER_OP("DmlSegmentedSoftmax")
+    .Input("logits: T")
+    .Input("lengths: int32")
+    .Output("softmax: T")
+    .Attr("T: {half, float}")
+    .SetShapeFn(shape_inference::UnchangedShape);
+
+class DmlSegmentedSoftmaxInitHelper : public InitializationHelper {
+ public:
+  using Attributes = EmptyAttributes;
+
+  DmlSegmentedSoftmaxInitHelper(OpKernelContext* ctx,
+                                std::shared_ptr<const Attributes> attr) {
+    const TensorShape& logits_shape = ctx->input(0).shape();
+    const TensorShape& lengths_shape = ctx->input(1).shape();
+
+    OP_REQUIRES(ctx, logits_shape.dims() >= 1,
+                errors::InvalidArgument(
+                    "logits must have at least 1 dimension, but has shape ",
+                    logits_shape.DebugString()));
+    OP_REQUIRES(
+        ctx, lengths_shape.dims() == logits_shape.dims() - 1,
+        errors::InvalidArgument("lengths must have the logits' shape without "
+                                "its last dimension, but logits has shape ",
+                                logits_shape.DebugString(),
+                                " and lengths has shape ",
+                                lengths_shape.DebugString()));
+    for (int i = 0; i < lengths_shape.dims(); ++i) {
+      OP_REQUIRES(
+          ctx, lengths_shape.dim_size(i) == logits_shape.dim_size(i),
+          errors::InvalidArgument("lengths must have the logits' shape "
+                                  "without its last dimension, but logits has "
+                                  "shape ",
+                                  logits_shape.DebugString(),
+                                  " and lengths has shape ",
+                                  lengths_shape.DebugString()));
+    }
+  }
+};
+
+class DmlSegmentedSoftmaxKernel : public DmlKernel {
+ public:
+  using InitHelper = DmlSegmentedSoftmaxInitHelper;
+
+  explicit DmlSegmentedSoftmaxKernel(DmlKernelConstruction* ctx,
+                                     const InitHelper* init_helper) {
+    CHECK(ctx->GetInputCount() == 2);
+    CHECK(ctx->GetOutputCount() == 1);
+
+    const TensorShape& logits_shape = ctx->GetInputTensorShape(0);
+
+    // DML's softmax activation requires rank <= 2, so collapse all leading
+    // dimensions into one batch dimension, mirroring DmlMaxActivationKernel.
+    uint32_t batch_size = 1;
+    for (int i = 0; i < logits_shape.dims() - 1; ++i) {
+      batch_size *= static_cast<uint32_t>(logits_shape.dim_size(i));
+    }
+    const uint32_t width =
+        static_cast<uint32_t>(logits_shape.dim_size(logits_shape.dims() - 1));
+
+    TensorShape collapsed_logits_shape({batch_size, width});
+    TensorShape collapsed_lengths_shape({batch_size, 1});
+
+    DmlTensorInfo logits_info;
+    logits_info.kernel_index = 0;
+    logits_info.desc =
+        DmlTensorDesc::Create(ctx->GetInputDataType(0), collapsed_logits_shape,
+                              collapsed_logits_shape);
+
+    DmlTensorInfo lengths_info;
+    lengths_info.kernel_index = 1;
+    lengths_info.desc =
+        DmlTensorDesc::Create(ctx->GetInputDataType(1),
+                              collapsed_lengths_shape, collapsed_lengths_shape);
+
+    DmlTensorInfo output_info;
+    output_info.kernel_index = 0;
+    output_info.desc =
+        DmlTensorDesc::Create(ctx->GetOutputDataType(0), collapsed_logits_shape,
+                              collapsed_logits_shape);
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {logits_info, lengths_info};
+    tensors.outputs = {output_info};
+
+    auto input_descs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto logits = dml::InputTensor(scope, 0, input_descs[0]);
+    auto lengths = dml::InputTensor(scope, 1, input_descs[1]);
+
+    dml::TensorDesc::Dimensions row_sizes = {1, 1, batch_size, width};
+
+    // Column indices 0..width-1, broadcast down the batch; lengths broadcast
+    // across the row. A lane is valid when its column precedes the length.
+    auto col_start = dml::ScalarUnion(0, DML_TENSOR_DATA_TYPE_INT32);
+    auto col_delta = dml::ScalarUnion(1, DML_TENSOR_DATA_TYPE_INT32);
+    auto col_indices =
+        dml::FillValueSequence(scope, {1, 1, 1, width},
+                               DML_TENSOR_DATA_TYPE_INT32, col_start,
+                               col_delta);
+    col_indices = dml::Reinterpret(col_indices, row_sizes,
+                                   dml::TensorDesc::Dimensions({0, 0, 0, 1}));
+    auto row_lengths = dml::Reinterpret(
+        lengths, row_sizes, dml::TensorDesc::Dimensions({0, 0, 1, 0}));
+    auto valid = col_indices < row_lengths;
+
+    auto data_type = GetDmlDataTypeFromTfDataType(ctx->GetInputDataType(0));
+    auto int_zero = dml::ScalarTensor<int32_t>(scope, 0, row_sizes);
+    auto zero = dml::Reinterpret(int_zero, data_type);
+    auto neg_max = dml::Cast(
+        dml::ScalarTensor<float>(scope, -std::numeric_limits<float>::max(),
+                                 row_sizes),
+        data_type);
+
+    // Padded lanes contribute exp(-max) == 0 to the row sum, so the valid
+    // prefix normalizes exactly as if the row ended at its length; the final
+    // select makes the padded lanes (and whole length-0 rows) exact zeros.
+    auto probs = dml::ActivationSoftmax(dml::If(valid, logits, neg_max));
+    auto result = dml::If(valid, probs, zero);
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, {result});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define DML_REGISTER_KERNEL(type)                             \
+  REGISTER_KERNEL_BUILDER(Name("DmlSegmentedSoftmax")         \
+                              .Device(DEVICE_DML)             \
+                              .TypeConstraint<type>("T"),     \
+                          DmlKernelWrapper<DmlSegmentedSoftmaxKernel, \
+                                           GetOutputShapeAsInputShapeHelper>);
+TF_CALL_DML_FLOAT_TYPES(DML_REGISTER_KERNEL);
+#undef DML_REGISTER_KERNEL
 }  // namespace tensorflow
\ No newline at end of file
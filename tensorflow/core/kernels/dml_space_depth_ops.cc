@@ -85,6 +85,68 @@ class SpaceDepthInitHelper : public InitializationHelper {
               "Image width ", input_width_, " and height ", input_height_,
               " should be divisible by block_size: ", attr->block_size));
     }
+
+    // Both operators are a fixed permutation of a six-dimensional view of the
+    // input, where the spatial or depth dimension is split into block-sized
+    // pieces. As with Transpose, a permutation which only moves dimensions
+    // across size-1 dimensions doesn't change the memory layout at all - e.g.
+    // DepthToSpace on a [N, H, 1, C] input, or SpaceToDepth when the width
+    // equals the block size - so those cases can alias the input buffer
+    // instead of dispatching a full copy.
+    const uint32_t bs = attr->block_size;
+    std::array<int64, 6> view_sizes;
+    std::array<int, 6> perm;
+    if (operator_type == DML_OPERATOR_DEPTH_TO_SPACE) {
+      if (attr->data_format == FORMAT_NHWC) {
+        view_sizes = {batch_size_, input_height_, input_width_, bs, bs,
+                      input_depth_ / (bs * bs)};
+        perm = {0, 1, 3, 2, 4, 5};
+      } else {
+        view_sizes = {batch_size_, bs, bs, input_depth_ / (bs * bs),
+                      input_height_, input_width_};
+        perm = {0, 3, 4, 1, 5, 2};
+      }
+    } else {
+      if (attr->data_format == FORMAT_NHWC) {
+        view_sizes = {batch_size_, input_height_ / bs, bs, input_width_ / bs,
+                      bs, input_depth_};
+        perm = {0, 1, 3, 2, 4, 5};
+      } else {
+        view_sizes = {batch_size_, input_depth_, input_height_ / bs, bs,
+                      input_width_ / bs, bs};
+        perm = {0, 3, 5, 1, 2, 4};
+      }
+    }
+
+    layout_preserving_ = true;
+    int prev_nontrivial_dim = -1;
+    for (int i = 0; i < 6; ++i) {
+      if (view_sizes[perm[i]] > 1) {
+        if (perm[i] < prev_nontrivial_dim) {
+          layout_preserving_ = false;
+          break;
+        }
+        prev_nontrivial_dim = perm[i];
+      }
+    }
+  }
+
+  // Layout-preserving rearrangements don't need to move any data; the output
+  // can alias the input's buffer with the blocked shape.
+  absl::optional<Tensor> GetContiguousInputView(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const override {
+    if (!layout_preserving_ || ctx->input_memory_type(0) != DEVICE_MEMORY ||
+        ctx->input_is_ref(0)) {
+      return absl::nullopt;
+    }
+
+    Tensor view;
+    if (view.CopyFrom(ctx->input(0), output_shapes[output_index])) {
+      return view;
+    }
+
+    return absl::nullopt;
   }
 
   TensorFormat GetDataFormat() const { return attr_->data_format; }
@@ -100,6 +162,7 @@ class SpaceDepthInitHelper : public InitializationHelper {
   int input_height_;
   int input_width_;
   int input_depth_;
+  bool layout_preserving_;
 };
 
 template <DML_OPERATOR_TYPE operator_type>
@@ -73,8 +73,6 @@ struct SparseXentTraits<float> {
   static inline DML_SCALAR_UNION GetOneValue() {
     return TfTensorTypeTraits<float>::ToDmlScalar(1.0f);
   }
-
-  static inline float GetEpsilonValue() { return 1e-20f; }
 };
 
 template <>
@@ -87,10 +85,6 @@ struct SparseXentTraits<Eigen::half> {
     return TfTensorTypeTraits<Eigen::half>::ToDmlScalar(
         TfTensorTypeTraits<Eigen::half>::FromFloat(1.0f));
   }
-
-  static inline Eigen::half GetEpsilonValue() {
-    return TfTensorTypeTraits<Eigen::half>::FromFloat(1e-6f);
-  }
 };
 
 template <typename T, typename TIndex>
@@ -134,10 +128,22 @@ class DmlSparseXentKernel : public DmlKernel {
         TfTensorTypeTraits<T>::dml_type, SparseXentTraits<T>::GetZeroValue(),
         SparseXentTraits<T>::GetOneValue());
 
-    auto epsilon = dml::ScalarTensor(
-        scope, SparseXentTraits<T>::GetEpsilonValue(), logits_dimensions);
-
-    auto probs = dml::ActivationSoftmax(logits);
+    // Loss and gradient share one softmax decomposition instead of pairing
+    // ActivationSoftmax with a second log-over-probs pass: the max/exp/sum
+    // intermediates feed both outputs, so the [batch, num_classes] logits are
+    // only walked once. The loss reduces to logsumexp minus the label's
+    // shifted logit - exact, stable, and free of the epsilon the
+    // log(probs + eps) formulation needed - with the label logit read by a
+    // per-row gather rather than a one-hot dot product over the full vocab.
+    dml::TensorDesc::Dimensions row_broadcast_strides = {0, 0, 1, 0};
+
+    auto max_logits = dml::Reduce(logits, DML_REDUCE_FUNCTION_MAX, {3});
+    auto shifted = logits - dml::Reinterpret(max_logits, logits_dimensions,
+                                             row_broadcast_strides);
+    auto exps = dml::Exp(shifted);
+    auto sum_exps = dml::Reduce(exps, DML_REDUCE_FUNCTION_SUM, {3});
+    auto probs = exps / dml::Reinterpret(sum_exps, logits_dimensions,
+                                         row_broadcast_strides);
 
     const uint32_t axis = 3;
     auto labels =
@@ -149,9 +155,8 @@ class DmlSparseXentKernel : public DmlKernel {
     } else {
       bp = probs - probs;
     }
-    auto intermediate = labels * dml::Log(probs + epsilon);
-    auto loss =
-        -dml::Reduce(intermediate, DML_REDUCE_FUNCTION_SUM, /*Axis*/ {3});
+    auto label_logit = dml::GatherElements(shifted, sparse_labels, axis);
+    auto loss = dml::Log(sum_exps) - label_logit;
 
     Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
         scope.Compile(DML_EXECUTION_FLAG_NONE, {loss, bp});
@@ -279,6 +279,96 @@ class StridedSliceInitHelper : public InitializationHelper {
                                   "but received ",
                                   input_shape.dims()));
     }
+
+    // Keep the canonical slice around so GetContiguousInputView can decide
+    // whether the output is a contiguous window of the input.
+    is_grad_op_ = is_grad_op;
+    input_shape_ = input_shape;
+    begin_ = std::move(begin);
+    end_ = std::move(end);
+    strides_ = std::move(strides);
+  }
+
+  // A slice which only trims the outermost non-trivial dimension (with unit
+  // strides everywhere) selects a contiguous range of the input's buffer, so
+  // the output can alias the input at an offset instead of copying.
+  absl::optional<Tensor> GetContiguousInputView(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const override {
+    // The grad kernel scatters its input into a larger output, which is never
+    // a view of it.
+    if (is_grad_op_) {
+      return absl::nullopt;
+    }
+
+    const Tensor& input = ctx->input(0);
+
+    // 64-bit integer kernels pad their tensor descs past the logical end of
+    // the data, which a tightly-sized view can't satisfy.
+    if (Is64BitIntegerType(input.dtype())) {
+      return absl::nullopt;
+    }
+
+    if (ctx->input_memory_type(0) != DEVICE_MEMORY || ctx->input_is_ref(0)) {
+      return absl::nullopt;
+    }
+
+    // At most one dimension may be partially included in the slice, and every
+    // dimension before it must have size 1; otherwise the selected elements
+    // aren't contiguous in memory. Any non-unit stride breaks contiguity.
+    int partial_dim = -1;
+    for (int i = 0; i < input_shape_.dims(); ++i) {
+      if (strides_[i] != 1) {
+        return absl::nullopt;
+      }
+      if (begin_[i] == 0 && end_[i] == input_shape_.dim_size(i)) {
+        continue;
+      }
+      if (partial_dim >= 0) {
+        return absl::nullopt;
+      }
+      partial_dim = i;
+    }
+
+    int64 element_offset = 0;
+    if (partial_dim >= 0) {
+      for (int i = 0; i < partial_dim; ++i) {
+        if (input_shape_.dim_size(i) != 1) {
+          return absl::nullopt;
+        }
+      }
+
+      int64 inner_elements = 1;
+      for (int i = partial_dim + 1; i < input_shape_.dims(); ++i) {
+        inner_elements *= input_shape_.dim_size(i);
+      }
+      element_offset = begin_[partial_dim] * inner_elements;
+    }
+
+    // DML buffer regions require the view's offset and size in bytes to be
+    // 4-byte aligned.
+    const int64 element_size = DataTypeSize(input.dtype());
+    const int64 output_elements = output_shapes[output_index].num_elements();
+    if ((element_offset * element_size) % 4 != 0 ||
+        (output_elements * element_size) % 4 != 0) {
+      return absl::nullopt;
+    }
+
+    Tensor flat;
+    if (!flat.CopyFrom(input, TensorShape({input.NumElements()}))) {
+      return absl::nullopt;
+    }
+
+    // Shrunk and inserted axes reshape the window without changing its
+    // element count, so the view adopts the output shape directly.
+    Tensor view;
+    if (!view.CopyFrom(flat.Slice(element_offset,
+                                  element_offset + output_elements),
+                       output_shapes[output_index])) {
+      return absl::nullopt;
+    }
+
+    return view;
   }
 
   const TensorShape& GetOutputShape() const { return output_shape_; }
@@ -292,6 +382,11 @@ class StridedSliceInitHelper : public InitializationHelper {
   TensorShape output_shape_;
   absl::optional<SimplifiedSlice> simple_slice_;
   bool is_identity_;
+  bool is_grad_op_;
+  TensorShape input_shape_;
+  gtl::InlinedVector<int64, 4> begin_;
+  gtl::InlinedVector<int64, 4> end_;
+  gtl::InlinedVector<int64, 4> strides_;
 };
 
 using InitHelper = StridedSliceInitHelper;
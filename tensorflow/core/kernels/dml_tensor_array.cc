@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "dml_tensor_array.h"
 
+#include <map>
+
 #include "tensorflow/core/common_runtime/dml/dml_common.h"
 #include "tensorflow/core/common_runtime/dml/dml_device.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
@@ -26,18 +28,35 @@ namespace tensor_array {
 
 Status DmlAddToTensor(OpKernelContext* ctx, Tensor* sum, const Tensor* current,
                       const Tensor* add) {
-  NodeDef def;
-  def.set_op("AddV2");
-  def.add_input("x");
-  def.add_input("y");
-  SetAttrValue(sum->dtype(), &(*def.mutable_attr())["T"]);
-
-  // Delegate to DML's kernel for Add
-  Status s;
-  auto op_kernel = CreateOpKernel(DEVICE_DML, ctx->device(),
-                                  ctx->get_allocator(AllocatorAttributes()),
-                                  def, TF_GRAPH_DEF_VERSION, &s);
-  TF_RETURN_IF_ERROR(s);
+  // TensorArray gradient aggregation runs once per write in while-loop
+  // decoders, so the delegated AddV2 kernels are cached per device and data
+  // type instead of being constructed on every call.
+  static mutex* mu = new mutex;
+  static auto* kernels = new std::map<std::pair<const DeviceBase*, DataType>,
+                                      std::unique_ptr<OpKernel>>;
+
+  OpKernel* op_kernel = nullptr;
+  {
+    mutex_lock lock(*mu);
+    auto& cached_kernel = (*kernels)[{ctx->device(), sum->dtype()}];
+
+    if (!cached_kernel) {
+      NodeDef def;
+      def.set_op("AddV2");
+      def.add_input("x");
+      def.add_input("y");
+      SetAttrValue(sum->dtype(), &(*def.mutable_attr())["T"]);
+
+      // Delegate to DML's kernel for Add
+      Status s;
+      cached_kernel = CreateOpKernel(DEVICE_DML, ctx->device(),
+                                     ctx->get_allocator(AllocatorAttributes()),
+                                     def, TF_GRAPH_DEF_VERSION, &s);
+      TF_RETURN_IF_ERROR(s);
+    }
+
+    op_kernel = cached_kernel.get();
+  }
 
   absl::InlinedVector<TensorValue, 4> inputs = {
       TensorValue(const_cast<Tensor*>(current)),
@@ -46,20 +65,22 @@ Status DmlAddToTensor(OpKernelContext* ctx, Tensor* sum, const Tensor* current,
   AllocatorAttributes output_attrs[] = {AllocatorAttributes()};
 
   OpKernelContext::Params op_ctx_params;
-  op_ctx_params.op_kernel = op_kernel.get();
+  op_ctx_params.op_kernel = op_kernel;
   op_ctx_params.device = ctx->device();
   op_ctx_params.inputs = &inputs;
   op_ctx_params.output_attr_array = output_attrs;
 
   OpKernelContext op_ctx(&op_ctx_params, 1);
   op_kernel->Compute(&op_ctx);
+  TF_RETURN_IF_ERROR(op_ctx.status());
 
-  TensorValue out = op_ctx.release_output(0);
-  ctx->device()->CopyTensorInSameDevice(
-      out.tensor, sum, ctx->op_device_context(),
-      [ctx](const Status& s) { OP_REQUIRES_OK(ctx, s); });
+  // The delegated kernel allocated a fresh buffer for its output, so steal it
+  // instead of dispatching another copy into *sum. The caller's tensor only
+  // needs to hold the aggregated value; nothing references its old buffer.
+  std::unique_ptr<Tensor> out(op_ctx.release_output(0).tensor);
+  *sum = std::move(*out);
 
-  return op_ctx.status();
+  return Status::OK();
 }
 
 void DmlTensorSetZero(OpKernelContext* ctx, Tensor* value) {
@@ -86,6 +86,29 @@ class TopKShapeHelper : public ShapeHelper {
   }
 };
 
+// Splitting each row into blocks, selecting the top k of every block in
+// parallel, and then selecting the top k of the surviving candidates does far
+// less sorting work than a single TOP_K over the whole row. Returns the
+// number of blocks to split each row into, or 1 if the single-pass path
+// should be used.
+static uint32_t GetTopKBlockCount(uint32_t n, uint32_t k) {
+  if (k < 128 || n < 16384) {
+    return 1;
+  }
+
+  // Blocks must divide the row evenly (padding the row would risk selecting
+  // out-of-range indices), hold at least k elements each, and produce a
+  // candidate set substantially smaller than the row itself.
+  for (uint32_t block_count : {16u, 8u, 4u, 2u}) {
+    if (n % block_count == 0 && n / block_count >= k &&
+        2 * block_count * k <= n) {
+      return block_count;
+    }
+  }
+
+  return 1;
+}
+
 class DmlTopKKernel : public DmlKernel {
  public:
   using InitHelper = DmlTopKInitHelper;
@@ -97,6 +120,17 @@ class DmlTopKKernel : public DmlKernel {
     const TensorShape& tensor_shape = ctx->GetInputTensorShape(0);
     const TensorShape& output_shape = ctx->GetOutputTensorShape(0);
 
+    const uint32_t n =
+        static_cast<uint32_t>(tensor_shape.dim_size(tensor_shape.dims() - 1));
+    const uint32_t block_count =
+        GetTopKBlockCount(n, static_cast<uint32_t>(init_helper->GetK()));
+
+    if (block_count > 1) {
+      InitializeBlockSelect(ctx, static_cast<uint32_t>(init_helper->GetK()), n,
+                            block_count);
+      return;
+    }
+
     DmlKernelTensors tensors;
     DmlTensorInfo input;
     input.kernel_index = 0;
@@ -130,6 +164,79 @@ class DmlTopKKernel : public DmlKernel {
     DML_OPERATOR_DESC op_desc = {DML_OPERATOR_TOP_K, &topk_desc};
     Initialize(ctx, std::move(tensors), op_desc);
   }
+
+ private:
+  // Two-level selection for large k over long rows: split each row into
+  // blocks, take the top k of every block in parallel, then take the top k of
+  // the candidates and rebase the winning indices onto row coordinates. The
+  // whole selection still compiles into a single DML operator.
+  void InitializeBlockSelect(DmlKernelConstruction* ctx, uint32_t k, uint32_t n,
+                             uint32_t block_count) {
+    const TensorShape& tensor_shape = ctx->GetInputTensorShape(0);
+    const uint32_t batch_size =
+        static_cast<uint32_t>(tensor_shape.num_elements()) / n;
+    const uint32_t block_size = n / block_count;
+
+    dml::TensorDesc::Dimensions input_sizes = {1, batch_size, block_count,
+                                               block_size};
+    dml::TensorDesc::Dimensions output_sizes = {1, 1, batch_size, k};
+
+    DmlTensorInfo input;
+    input.kernel_index = 0;
+    input.desc = DmlTensorDesc::Create(ctx->GetInputDataType(0), input_sizes,
+                                       input_sizes);
+
+    DmlKernelTensors tensors;
+    tensors.inputs = {input};
+    for (uint32_t i = 0; i < ctx->GetOutputCount(); ++i) {
+      DmlTensorInfo output;
+      output.kernel_index = i;
+      output.desc = DmlTensorDesc::Create(ctx->GetOutputDataType(i),
+                                          output_sizes, output_sizes);
+      if (i == 1) {
+        output.desc.ForceUnsignedDataType();
+      }
+      tensors.outputs.push_back(std::move(output));
+    }
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto input_tensor = dml::InputTensor(scope, 0, inputs[0]);
+
+    // Top k of every block, selected in parallel across the row.
+    auto block_topk =
+        dml::TopK(input_tensor, 3, k, DML_AXIS_DIRECTION_DECREASING);
+
+    // Rebase each block's indices onto the whole row.
+    auto block_offsets = dml::FillValueSequence(
+        scope, {1, 1, block_count, 1}, DML_TENSOR_DATA_TYPE_UINT32,
+        dml::ScalarUnion(0, DML_TENSOR_DATA_TYPE_UINT32),
+        dml::ScalarUnion(block_size, DML_TENSOR_DATA_TYPE_UINT32));
+
+    dml::TensorDesc::Dimensions candidate_sizes = {1, batch_size, block_count,
+                                                   k};
+    auto candidate_indices =
+        block_topk.index +
+        dml::Reinterpret(block_offsets, candidate_sizes,
+                         dml::TensorDesc::Dimensions({0, 0, 1, 0}));
+
+    // Top k of the surviving candidates, viewed as one row per batch.
+    dml::TensorDesc::Dimensions flat_sizes = {1, 1, batch_size,
+                                              block_count * k};
+    auto candidate_values = dml::Reinterpret(block_topk.value, flat_sizes, {});
+    candidate_indices = dml::Reinterpret(candidate_indices, flat_sizes, {});
+
+    auto final_topk =
+        dml::TopK(candidate_values, 3, k, DML_AXIS_DIRECTION_DECREASING);
+
+    auto result_indices =
+        dml::GatherElements(candidate_indices, final_topk.index, 3);
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op = scope.Compile(
+        DML_EXECUTION_FLAG_NONE, {final_topk.value, result_indices});
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
 };
 
 #define DML_REGISTER_KERNEL(type)                                \
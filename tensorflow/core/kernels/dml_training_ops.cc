@@ -15,10 +15,14 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cfloat>
+#include <numeric>
 
 #include "tensorflow/core/common_runtime/dml/dml_operator_helper.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/kernels/dml_kernel_wrapper.h"
 #include "tensorflow/core/kernels/dml_ops_common.h"
 #include "tensorflow/core/kernels/training_op_helpers.h"
@@ -27,9 +31,15 @@ namespace tensorflow {
 
 // Provides common implementations for the training kernels. These training
 // kernels all generally follow the same pattern:
-//   * They modify their input tensors as opposed to producing outputs. This
-//     requires staging in temporary buffers, and then copying back to the
-//     input.
+//   * They modify their input tensors as opposed to producing outputs.
+//     Kernels whose DML expressions are purely elementwise (each output
+//     element depends only on the same element of each variable input) opt
+//     into in-place execution via inplace_allowed, binding the variable
+//     buffers directly as outputs. Kernels which can't make that guarantee
+//     stage into temporary buffers and copy back to the input, which costs an
+//     extra read+write of every variable per step. This matters for
+//     microbatched training, where gradients accumulate into variables across
+//     several steps per apply and the update traffic dominates bandwidth.
 //   * They have resource- and non-resource versions. The non-resource versions
 //     use ref tensors which require some additional logic.
 //   * Because we want to maintain common code between the resource and
@@ -81,6 +91,19 @@ class DmlTrainingKernel : public DmlKernel {
       // We don't support sparse tensors (yet?)
       const bool sparse = false;
 
+      // For resource variables (whose mutex we hold exclusively — see
+      // MaybeLockVariableInputMutexesInOrder), skip the defensive copy when
+      // the buffer's extra references all belong to GPU reads ordered before
+      // this kernel's execution on the compute queue.
+      if (op_ctx_->input_dtype(index) == DT_RESOURCE) {
+        core::RefCountPtr<Var> variable;
+        TF_CHECK_OK(
+            LookupResource(op_ctx_, HandleFromInput(op_ctx_, index), &variable));
+        if (dml_util::CanUpdateVariableInPlace(op_ctx_, variable.get())) {
+          return *variable->tensor();
+        }
+      }
+
       Tensor tensor;
       TF_CHECK_OK(GetInputTensorFromVariable(
           op_ctx_, index, use_exclusive_lock_, sparse,
@@ -559,13 +582,180 @@ class DmlAdamKernelWrapper
 TF_CALL_DML_FLOAT_TYPES(REGISTER_KERNEL);
 #undef REGISTER_KERNEL
 
+// Internal op produced by DmlOptimizerFusionPass. Applies the dense Adam
+// update to N variables as one compiled DML graph, so the optimizer phase of
+// a model with hundreds of variables costs a few dispatches instead of one
+// per variable. The inputs are blocked per role (all vars, all ms, all vs,
+// then the six shared scalars, then all grads); variable i is updated from
+// grad i. The pass only groups ApplyAdam nodes that share the same scalar
+// input tensors, so beta1_power/beta2_power/lr/beta1/beta2/epsilon appear
+// once.
+REGISTER_OP("_DmlFusedApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("T: {half, float}")
+    .Attr("N: int >= 1")
+    .Attr("use_locking: bool = true")
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. The DML runtime's
+optimizer fusion pass is expected to create this operator.
+)doc");
+
+class DmlFusedApplyAdamKernel : public DmlTrainingKernel {
+ public:
+  using InitHelper = NoOpInitializationHelper;
+
+  explicit DmlFusedApplyAdamKernel(DmlKernelConstruction* ctx,
+                                   const InitHelper* init_helper)
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
+    auto* op_ctx = ctx->GetOpKernelContext();
+
+    int32 num_vars;
+    TF_CHECK_OK(ctx->GetAttr("N", &num_vars));
+
+    CHECK(ctx->GetInputCount() == static_cast<uint32_t>(4 * num_vars + 6));
+    CHECK(ctx->GetOutputCount() == 0);
+
+    const int scalars_base = 3 * num_vars;
+    const int grads_base = scalars_base + 6;
+
+    std::vector<int> variable_indices(3 * num_vars);
+    std::iota(variable_indices.begin(), variable_indices.end(), 0);
+    PrepareVariableTensors(op_ctx, variable_indices);
+    VariableTensorAccessor var_accessor = LockVariableTensors(op_ctx);
+
+    static const char* const kScalarNames[] = {
+        "beta1_power", "beta2_power", "lr", "beta1", "beta2", "epsilon"};
+    for (int i = 0; i < 6; ++i) {
+      const TensorShape& scalar_shape =
+          ctx->GetInputTensorShape(scalars_base + i);
+      OP_REQUIRES(op_ctx, TensorShapeUtils::IsScalar(scalar_shape),
+                  errors::InvalidArgument(kScalarNames[i], " is not a scalar: ",
+                                          scalar_shape.DebugString()));
+    }
+
+    std::vector<TensorShape> input_shapes(4 * num_vars + 6);
+    std::vector<TensorShape> output_shapes(3 * num_vars);
+    for (int i = 0; i < num_vars; ++i) {
+      const TensorShape& var_shape = var_accessor.GetShape(i);
+      const TensorShape& m_shape = var_accessor.GetShape(num_vars + i);
+      const TensorShape& v_shape = var_accessor.GetShape(2 * num_vars + i);
+      const TensorShape& grad_shape = ctx->GetInputTensorShape(grads_base + i);
+
+      OP_REQUIRES(op_ctx, var_shape.IsSameSize(m_shape),
+                  errors::InvalidArgument(
+                      "var and m do not have the same shape",
+                      var_shape.DebugString(), " ", m_shape.DebugString()));
+      OP_REQUIRES(op_ctx, var_shape.IsSameSize(v_shape),
+                  errors::InvalidArgument(
+                      "var and v do not have the same shape",
+                      var_shape.DebugString(), " ", v_shape.DebugString()));
+      OP_REQUIRES(op_ctx, var_shape.IsSameSize(grad_shape),
+                  errors::InvalidArgument(
+                      "var and grad do not have the same shape",
+                      var_shape.DebugString(), " ", grad_shape.DebugString()));
+
+      input_shapes[i] = var_shape;
+      input_shapes[num_vars + i] = m_shape;
+      input_shapes[2 * num_vars + i] = v_shape;
+      input_shapes[grads_base + i] = grad_shape;
+
+      output_shapes[i] = var_shape;
+      output_shapes[num_vars + i] = m_shape;
+      output_shapes[2 * num_vars + i] = v_shape;
+    }
+    for (int i = 0; i < 6; ++i) {
+      input_shapes[scalars_base + i] =
+          ctx->GetInputTensorShape(scalars_base + i);
+    }
+
+    DmlKernelTensors tensors =
+        GetTensorInfos(ctx, absl::nullopt, input_shapes, output_shapes);
+
+    auto inputs = GetDmlTensorDescs(tensors.inputs);
+
+    auto scope = dml::Graph(ctx->GetDmlDevice());
+    auto beta1_power =
+        dml::InputTensor(scope, scalars_base, inputs[scalars_base]);
+    auto beta2_power =
+        dml::InputTensor(scope, scalars_base + 1, inputs[scalars_base + 1]);
+    auto lr = dml::InputTensor(scope, scalars_base + 2, inputs[scalars_base + 2]);
+    auto beta1 =
+        dml::InputTensor(scope, scalars_base + 3, inputs[scalars_base + 3]);
+    auto beta2 =
+        dml::InputTensor(scope, scalars_base + 4, inputs[scalars_base + 4]);
+    auto epsilon =
+        dml::InputTensor(scope, scalars_base + 5, inputs[scalars_base + 5]);
+
+    // The scalar subgraph is shared by all N updates; DML evaluates it once.
+    auto alpha = lr * (dml::Sqrt(1 - beta2_power) / (1 - beta1_power));
+
+    // Same math as DmlApplyAdamWithAmsgradKernel minus the vhat clamp, once
+    // per variable. Compile sees N independent subgraphs and schedules them
+    // into a handful of dispatches.
+    std::vector<dml::Expression> graph_outputs(3 * num_vars);
+    for (int i = 0; i < num_vars; ++i) {
+      auto var = dml::InputTensor(scope, i, inputs[i]);
+      auto m = dml::InputTensor(scope, num_vars + i, inputs[num_vars + i]);
+      auto v =
+          dml::InputTensor(scope, 2 * num_vars + i, inputs[2 * num_vars + i]);
+      auto grad =
+          dml::InputTensor(scope, grads_base + i, inputs[grads_base + i]);
+
+      const auto& desired_shape = var.GetOutputDesc().sizes;
+
+      // Broadcasts a scalar into a tensor with this variable's shape.
+      auto BCast = [&](dml::Expression input) {
+        // Because we're broadcasting a scalar, just set all strides to 0
+        dml::TensorDesc::Dimensions bcast_strides = {0, 0, 0, 0};
+        return dml::Reinterpret(input, desired_shape, bcast_strides);
+      };
+
+      m += (grad - m) * BCast(1 - beta1);
+      v += (grad * grad - v) * BCast(1 - beta2);
+      var -= m * BCast(alpha) / (dml::Sqrt(v) + BCast(epsilon));
+
+      graph_outputs[i] = var;
+      graph_outputs[num_vars + i] = m;
+      graph_outputs[2 * num_vars + i] = v;
+    }
+
+    Microsoft::WRL::ComPtr<IDMLCompiledOperator> compiled_op =
+        scope.Compile(DML_EXECUTION_FLAG_NONE, graph_outputs);
+
+    Initialize(ctx, std::move(tensors), compiled_op.Get());
+  }
+};
+
+#define REGISTER_KERNEL(type)                                       \
+  REGISTER_KERNEL_BUILDER(                                          \
+      Name("_DmlFusedApplyAdam")                                    \
+          .Device(DEVICE_DML)                                       \
+          .HostMemory("var")                                        \
+          .HostMemory("m")                                          \
+          .HostMemory("v")                                          \
+          .TypeConstraint<type>("T"),                               \
+      DmlKernelWrapper<DmlFusedApplyAdamKernel, NoOutputShapeHelper>);
+
+TF_CALL_DML_FLOAT_TYPES(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
 class DmlApplyAdamWithAmsgradKernel : public DmlTrainingKernel {
  public:
   using InitHelper = GetBroadcastedOutputShapeHelper::InitHelper;
 
   explicit DmlApplyAdamWithAmsgradKernel(DmlKernelConstruction* ctx,
                                          const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 11);
@@ -685,7 +875,7 @@ class DmlApplyAdaMaxKernel : public DmlTrainingKernel {
 
   explicit DmlApplyAdaMaxKernel(DmlKernelConstruction* ctx,
                                 const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 9);
@@ -794,7 +984,7 @@ class DmlApplyGradientDescentKernel : public DmlTrainingKernel {
 
   DmlApplyGradientDescentKernel(DmlKernelConstruction* ctx,
                                 const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 3);
@@ -865,7 +1055,7 @@ class DmlApplyAdadeltaKernel : public DmlTrainingKernel {
 
   DmlApplyAdadeltaKernel(DmlKernelConstruction* ctx,
                          const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 7);
@@ -964,7 +1154,7 @@ class DmlApplyAdagradKernel : public DmlTrainingKernel {
 
   DmlApplyAdagradKernel(DmlKernelConstruction* ctx,
                         const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     // ApplyAdagradV2 has an additional input
@@ -1084,7 +1274,7 @@ class DmlApplyMomentumKernel : public DmlTrainingKernel {
 
   explicit DmlApplyMomentumKernel(DmlKernelConstruction* ctx,
                                   const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 5);
@@ -1175,7 +1365,7 @@ class DmlApplyKerasMomentumKernel : public DmlTrainingKernel {
 
   explicit DmlApplyKerasMomentumKernel(DmlKernelConstruction* ctx,
                                        const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 5);
@@ -1262,7 +1452,7 @@ class DmlApplyRMSPropKernel : public DmlTrainingKernel {
 
   explicit DmlApplyRMSPropKernel(DmlKernelConstruction* ctx,
                                  const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 8);
@@ -1366,7 +1556,7 @@ class DmlApplyCenteredRMSPropKernel : public DmlTrainingKernel {
 
   explicit DmlApplyCenteredRMSPropKernel(DmlKernelConstruction* ctx,
                                          const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 9);
@@ -1481,7 +1671,7 @@ class DmlApplyAddSignKernel : public DmlTrainingKernel {
 
   explicit DmlApplyAddSignKernel(DmlKernelConstruction* ctx,
                                  const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 7);
@@ -1575,7 +1765,7 @@ class DmlApplyPowerSignKernel : public DmlTrainingKernel {
 
   explicit DmlApplyPowerSignKernel(DmlKernelConstruction* ctx,
                                    const InitHelper* init_helper)
-      : DmlTrainingKernel(ctx) {
+      : DmlTrainingKernel(ctx, true /* inplace_allowed */) {
     auto* op_ctx = ctx->GetOpKernelContext();
 
     CHECK(ctx->GetInputCount() == 7);
@@ -171,12 +171,52 @@ class TransposeInitHelper : public InitializationHelper {
                     "DML doesn't support more than 5D for Transpose, but ",
                     simple_transpose_.input_shape.dims(),
                     " dimensions were provided."));
+
+    // A transpose which only moves dimensions across size-1 dimensions (i.e.
+    // the dimensions with more than one element keep their relative order)
+    // doesn't change the memory layout; it's just a reshape.
+    layout_preserving_ = true;
+    int prev_nontrivial_dim = -1;
+    for (int64 i = 0; i < perm_tensor.NumElements(); ++i) {
+      int input_dim = perm_tensor.dtype() == DT_INT32
+                          ? static_cast<int>(perm_tensor.flat<int32>()(i))
+                          : static_cast<int>(perm_tensor.flat<int64>()(i));
+
+      if (input_shape.dim_size(input_dim) > 1) {
+        if (input_dim < prev_nontrivial_dim) {
+          layout_preserving_ = false;
+          break;
+        }
+        prev_nontrivial_dim = input_dim;
+      }
+    }
+  }
+
+  // Layout-preserving transposes don't need to move any data; the output can
+  // alias the input's buffer with the permuted shape.
+  absl::optional<Tensor> GetContiguousInputView(
+      OpKernelContext* ctx, absl::Span<const TensorShape> output_shapes,
+      int output_index) const override {
+    if (!layout_preserving_ || ctx->input_memory_type(0) != DEVICE_MEMORY ||
+        ctx->input_is_ref(0)) {
+      return absl::nullopt;
+    }
+
+    // The view shares the whole buffer at offset zero, so no alignment or
+    // desc padding concerns arise.
+    Tensor view;
+    if (view.CopyFrom(ctx->input(0), output_shapes[output_index])) {
+      return view;
+    }
+
+    return absl::nullopt;
   }
 
   SimpleTranspose GetSimpleTranspose() const { return simple_transpose_; }
 
  private:
   SimpleTranspose simple_transpose_;
+  bool layout_preserving_;
 };
 
 class TransposeShapeHelper : public ShapeHelper {
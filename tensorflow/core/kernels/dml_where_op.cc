@@ -123,9 +123,15 @@ REGISTER_OP("DmlNonzeroCoordinates")
 TF_CALL_DML_ALL_TYPES(DML_REGISTER_KERNEL);
 #undef DML_REGISTER_KERNEL
 
+// Runs DmlNonzeroCoordinates and begins the readback of the nonzero count
+// into `num_nonzero_elements_cpu`, but does NOT wait for it: `readback_done`
+// is notified when the count is available. This lets the caller enqueue more
+// GPU work (the int64 cast) that overlaps with the readback's round trip
+// instead of leaving the GPU idle until the host learns the count.
 static Status ComputeNonzeroCoordinates(OpKernelContext* ctx,
                                         const NodeDef& node_def,
-                                        uint32_t& num_nonzero_elements,
+                                        Tensor& num_nonzero_elements_cpu,
+                                        Notification& readback_done,
                                         TensorValue& nonzero_coordinates) {
   Status s;
   auto op_kernel = CreateOpKernel(DEVICE_DML, ctx->device(),
@@ -149,31 +155,24 @@ static Status ComputeNonzeroCoordinates(OpKernelContext* ctx,
   op_kernel->Compute(&op_ctx);
   TF_RETURN_IF_ERROR(op_ctx.status());
 
-  // Copy the nonzero count to the CPU
-  Tensor num_nonzero_elements_tensor_cpu;
+  // Begin copying the nonzero count to the CPU. The device context holds a
+  // reference on the count tensor for the duration of the copy.
   AllocatorAttributes attr;
   attr.set_on_host(true);
-  TF_RETURN_IF_ERROR(
-      ctx, ctx->allocate_temp(DT_UINT32, TensorShape({}),
-                              &num_nonzero_elements_tensor_cpu, attr));
+  TF_RETURN_IF_ERROR(ctx, ctx->allocate_temp(DT_UINT32, TensorShape({}),
+                                             &num_nonzero_elements_cpu, attr));
 
   TensorValue num_nonzero_elements_tensor = op_ctx.release_output(0);
   nonzero_coordinates = op_ctx.release_output(1);
 
-  Notification note;
   ctx->op_device_context()->CopyDeviceTensorToCPU(
       num_nonzero_elements_tensor.tensor, "",
-      static_cast<Device*>(ctx->device()), &num_nonzero_elements_tensor_cpu,
-      [&note, ctx](const Status& copy_status) {
+      static_cast<Device*>(ctx->device()), &num_nonzero_elements_cpu,
+      [&readback_done, ctx](const Status& copy_status) {
         OP_REQUIRES_OK(ctx, copy_status);
-        note.Notify();
+        readback_done.Notify();
       });
 
-  note.WaitForNotification();
-  TF_RETURN_IF_ERROR(ctx->status());
-
-  num_nonzero_elements = num_nonzero_elements_tensor_cpu.scalar<uint32_t>()();
-
   return Status::OK();
 }
 
@@ -227,16 +226,29 @@ class DmlWhereKernel : public OpKernel {
                     "DML doesn't support more than 5D for Where, but ",
                     input_dims, " dimensions were provided."));
 
-    uint32_t num_nonzero_elements;
+    Tensor num_nonzero_elements_cpu;
+    Notification readback_done;
     TensorValue nonzero_coordinates;
 
     OP_REQUIRES_OK(ctx, ComputeNonzeroCoordinates(
                             ctx, nonzero_coordinates_node_def_,
-                            num_nonzero_elements, nonzero_coordinates));
-
-    // Where only supports int64 as an output, but DML outputs uint32
+                            num_nonzero_elements_cpu, readback_done,
+                            nonzero_coordinates));
+
+    // Where only supports int64 as an output, but DML outputs uint32. Enqueue
+    // the cast while the count readback is still in flight; the cast doesn't
+    // depend on the count, so the GPU converts the coordinates during the
+    // readback's round trip instead of serializing behind it. This sync is the
+    // unavoidable minimum for Where: TF requires the host-visible output shape
+    // before the kernel returns, and everything else stays on the GPU
+    // timeline.
     OP_REQUIRES_OK(ctx, ComputeCast(ctx, cast_node_def_, nonzero_coordinates));
 
+    readback_done.WaitForNotification();
+    OP_REQUIRES_OK(ctx, ctx->status());
+    uint32_t num_nonzero_elements =
+        num_nonzero_elements_cpu.scalar<uint32_t>()();
+
     // Now that we know the number of nonzero elements, create the output shape
     // and allocate the output
     TensorShape output_shape({num_nonzero_elements, input_dims});
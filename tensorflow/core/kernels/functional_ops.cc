@@ -171,7 +171,8 @@ class IfOp : public AsyncOpKernel {
           then_handle_(then_handle),
           else_handle_(else_handle),
           done_(std::move(done)),
-          lib_(CHECK_NOTNULL(ctx_->function_library())) {
+          lib_(CHECK_NOTNULL(ctx_->function_library())),
+          op_run_(down_cast<Device*>(ctx_->device())) {
       SetRunOptions(ctx_, &opts_, true /* always_collect_stats */);
       for (int i = 1; i < ctx_->num_inputs(); ++i) {
         args_.push_back(ctx_->input(i));
@@ -212,6 +213,10 @@ class IfOp : public AsyncOpKernel {
     FHandle else_handle_;
     DoneCallback done_;
     FunctionLibraryRuntime* const lib_;
+    // Holds the device's op-run bracket open until this call completes, so
+    // the branch's ops batch with the caller's instead of flushing at the
+    // function boundary.
+    ScopedOpRun op_run_;
     FunctionLibraryRuntime::Options opts_;
     TensorVec args_;
     TensorVec rets_;
@@ -266,7 +271,8 @@ class CaseOp : public AsyncOpKernel {
           branch_(branch),
           branch_handles_(branch_handles),
           done_(std::move(done)),
-          lib_(CHECK_NOTNULL(ctx_->function_library())) {
+          lib_(CHECK_NOTNULL(ctx_->function_library())),
+          op_run_(down_cast<Device*>(ctx_->device())) {
       SetRunOptions(ctx_, &opts_, true /* always_collect_stats */);
       for (int i = 1; i < ctx_->num_inputs(); ++i) {
         args_.push_back(ctx_->input(i));
@@ -310,6 +316,8 @@ class CaseOp : public AsyncOpKernel {
     std::vector<FHandle> branch_handles_;
     DoneCallback done_;
     FunctionLibraryRuntime* const lib_;
+    // See IfOp::State::op_run_.
+    ScopedOpRun op_run_;
     FunctionLibraryRuntime::Options opts_;
     TensorVec args_;
     TensorVec rets_;
@@ -383,7 +391,8 @@ class WhileOp : public AsyncOpKernel {
           cond_handle_(cond_handle),
           body_handle_(body_handle),
           done_(std::move(done)),
-          lib_(CHECK_NOTNULL(ctx_->function_library())) {
+          lib_(CHECK_NOTNULL(ctx_->function_library())),
+          op_run_(down_cast<Device*>(ctx_->device())) {
       SetRunOptions(ctx_, &opts_, false /* always_collect_stats */);
       for (int i = 0; i < ctx_->num_inputs(); ++i) {
         args_.push_back(ctx_->input(i));
@@ -401,6 +410,9 @@ class WhileOp : public AsyncOpKernel {
     const FHandle body_handle_;
     const DoneCallback done_;
     FunctionLibraryRuntime* const lib_;
+    // See IfOp::State::op_run_. For While this additionally spans all cond
+    // and body iterations, so per-iteration work batches together.
+    ScopedOpRun op_run_;
     FunctionLibraryRuntime::Options opts_;
     TensorVec args_;
     TensorVec rets_;
@@ -572,6 +584,7 @@ class ForOp : public AsyncOpKernel {
           ctx_(ctx),
           done_(std::move(done)),
           lib_(CHECK_NOTNULL(ctx_->function_library())),
+          op_run_(down_cast<Device*>(ctx_->device())),
           args_(1 + ctx_->num_inputs() - 3) {
       args_[0] = Tensor(DT_INT32, {});
       iter_ = &args_[0].scalar<int32>()();
@@ -595,6 +608,8 @@ class ForOp : public AsyncOpKernel {
     OpKernelContext* const ctx_;
     const DoneCallback done_;
     FunctionLibraryRuntime* const lib_;
+    // See IfOp::State::op_run_; spans all loop iterations.
+    ScopedOpRun op_run_;
     FunctionLibraryRuntime::Options opts_;
     TensorVec args_;
     TensorVec rets_;
@@ -20,6 +20,7 @@ limitations under the License.
 #include <type_traits>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -30,7 +31,7 @@ limitations under the License.
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps a flat_hash_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
@@ -134,25 +135,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
     tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    // Flat storage: one control byte per slot plus the key/value array.
+    return sizeof(MutableHashTableOfScalars) +
+           table_.bucket_count() * (sizeof(K) + sizeof(V) + 1);
   }
 
  private:
   mutable mutex mu_;
-  std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  absl::flat_hash_map<K, V> table_ GUARDED_BY(mu_);
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a flat_hash_map. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -272,24 +266,18 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
     tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    // Flat storage: one control byte per slot plus the key/value array.
+    // Values spilled out of the inlined array are not counted.
+    return sizeof(MutableHashTableOfTensors) +
+           table_.bucket_count() * (sizeof(K) + sizeof(ValueArray) + 1);
   }
 
  private:
   TensorShape value_shape_;
   mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ GUARDED_BY(mu_);
+  absl::flat_hash_map<K, ValueArray> table_ GUARDED_BY(mu_);
 };
 
 namespace {
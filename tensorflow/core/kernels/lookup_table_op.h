@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/macros.h"
@@ -148,19 +154,25 @@ inline const Variant& SubtleMustCopyIfIntegral(const Variant& value) {
   return value;
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
-// is specified.
+// Lookup table backed by sharded flat (open-addressing) hash maps, where the
+// key and value data type is specified.
 //
 // This table is recommended for any variations to key values.
 //
 // For look up, the table is required to be initialized (allocated
-// and populated). Once the table is marked as initialized it becomes read-only.
+// and populated). Once the table is marked as initialized it becomes
+// read-only, so Find needs no locking.
+//
+// The table is split into a fixed number of shards by key hash. During
+// initialization each shard is owned by exactly one task, so large
+// initializer batches insert in parallel on the intra-op pool without any
+// synchronization.
 //
 // Sample use case:
 //
 // HashTable<int64, int64> table;  // int64 -> int64.
 // table.Prepare(10); // Prepare the underlying data structure, the number of
-//                    // elements is required by interface, but not used.
+//                    // elements is used to presize the shards.
 // // Populate the table, elements could be added in one or multiple calls.
 // table.Insert(key_tensor, value_tensor); // Populate the table.
 // ...
@@ -171,7 +183,12 @@ inline const Variant& SubtleMustCopyIfIntegral(const Variant& value) {
 template <class K, class V>
 class HashTable : public InitializableLookupTable {
  public:
-  HashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+  HashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    if (ctx->device() != nullptr &&
+        ctx->device()->tensorflow_cpu_worker_threads() != nullptr) {
+      init_workers_ = ctx->device()->tensorflow_cpu_worker_threads()->workers;
+    }
+  }
 
   size_t size() const override {
     // return the size of the table only if it's initialized, otherwise 0.
@@ -179,7 +196,14 @@ class HashTable : public InitializableLookupTable {
       return 0;
     }
     std::atomic_thread_fence(std::memory_order_acquire);
-    return table_ ? table_->size() : 0;
+    if (!shards_) {
+      return 0;
+    }
+    size_t ret = 0;
+    for (const auto& shard : *shards_) {
+      ret += shard.size();
+    }
+    return ret;
   }
 
   Status ExportValues(OpKernelContext* context) override {
@@ -187,7 +211,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64 size = table_->size();
+    const int64 size = this->size();
 
     Tensor* keys;
     Tensor* values;
@@ -199,9 +223,11 @@ class HashTable : public InitializableLookupTable {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64 i = 0;
-    for (auto it = table_->begin(); it != table_->end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const auto& shard : *shards_) {
+      for (auto it = shard.begin(); it != shard.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
     return Status::OK();
   }
@@ -211,38 +237,90 @@ class HashTable : public InitializableLookupTable {
   DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
 
  protected:
-  Status DoPrepare(size_t unused) override {
+  Status DoPrepare(size_t size) override {
     if (is_initialized_) {
       return errors::Aborted("HashTable already initialized.");
     }
-    if (!table_) {
-      table_ = std::unique_ptr<std::unordered_map<K, V>>(
-          new std::unordered_map<K, V>());
+    if (!shards_) {
+      shards_.reset(new std::vector<absl::flat_hash_map<K, V>>(kNumShards));
+    }
+    if (size > 0) {
+      // Presize so initialization does not rehash mid-stream.
+      for (auto& shard : *shards_) {
+        shard.reserve(size / kNumShards + 1);
+      }
     }
     return Status::OK();
   };
 
-  Status DoLazyPrepare(std::function<int64(void)> unused) override {
-    constexpr size_t kUnusedSize = 0;
-    return DoPrepare(kUnusedSize);
+  Status DoLazyPrepare(std::function<int64(void)> size_fn) override {
+    const int64 size = size_fn();
+    return DoPrepare(size < 0 ? 0 : static_cast<size_t>(size));
   }
 
   Status DoInsert(const Tensor& keys, const Tensor& values) override {
-    if (!table_) {
+    if (!shards_) {
       return errors::FailedPrecondition("HashTable is not prepared.");
     }
 
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
-    for (int64 i = 0; i < key_values.size(); ++i) {
+    const int64 n = key_values.size();
+
+    auto insert_one = [&key_values, &value_values](
+                          int64 i,
+                          absl::flat_hash_map<K, V>* shard) -> Status {
       const K key = SubtleMustCopyIfIntegral(key_values(i));
       const V value = SubtleMustCopyIfIntegral(value_values(i));
-      const V& previous_value = gtl::LookupOrInsert(table_.get(), key, value);
-      if (previous_value != value) {
+      const auto result = shard->emplace(key, value);
+      if (!result.second && result.first->second != value) {
         return errors::FailedPrecondition(
             "HashTable has different value for same key. Key ", key, " has ",
-            previous_value, " and trying to add value ", value);
+            result.first->second, " and trying to add value ", value);
       }
+      return Status::OK();
+    };
+
+    if (init_workers_ == nullptr || n < kParallelInitThreshold) {
+      for (int64 i = 0; i < n; ++i) {
+        TF_RETURN_IF_ERROR(
+            insert_one(i, &(*shards_)[ShardOf(key_values(i))]));
+      }
+      return Status::OK();
+    }
+
+    // Compute each key's shard once up front, then hand each task a
+    // disjoint set of shards so insertion needs no locking.
+    std::vector<uint8> shard_ids(n);
+    for (int64 i = 0; i < n; ++i) {
+      shard_ids[i] = ShardOf(key_values(i));
+    }
+    Status statuses[kNumShards];
+    auto insert_shard = [&insert_one, &shard_ids, &statuses, this,
+                         n](int shard) {
+      auto* table = &(*shards_)[shard];
+      for (int64 i = 0; i < n; ++i) {
+        if (shard_ids[i] != shard) {
+          continue;
+        }
+        Status s = insert_one(i, table);
+        if (!s.ok()) {
+          statuses[shard] = s;
+          return;
+        }
+      }
+    };
+    BlockingCounter counter(kNumShards - 1);
+    for (int shard = 1; shard < kNumShards; ++shard) {
+      init_workers_->Schedule([&insert_shard, &counter, shard]() {
+        insert_shard(shard);
+        counter.DecrementCount();
+      });
+    }
+    insert_shard(0);
+    counter.Wait();
+    for (const Status& s : statuses) {
+      TF_RETURN_IF_ERROR(s);
     }
     return Status::OK();
   }
@@ -254,23 +332,39 @@ class HashTable : public InitializableLookupTable {
     auto value_values = value->flat<V>();
 
     for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          *table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+      // Reference binding avoids copying string keys on the lookup path.
+      const K& key_value = SubtleMustCopyIfIntegral(key_values(i));
+      const auto& shard = (*shards_)[ShardOf(key_value)];
+      const auto it = shard.find(key_value);
+      value_values(i) = (it != shard.end()) ? it->second : default_val;
     }
     return Status::OK();
   }
 
   int64 MemoryUsed() const override {
-    if (table_) {
-      const int64 num_elements = table_->size();
-      return num_elements * (sizeof(K) + sizeof(V));
-    } else {
+    if (!shards_) {
       return 0;
     }
+    int64 ret = sizeof(HashTable);
+    for (const auto& shard : *shards_) {
+      // One control byte per slot in addition to the flat key/value array.
+      ret += shard.bucket_count() * (sizeof(K) + sizeof(V) + 1);
+    }
+    return ret;
   }
 
  private:
-  std::unique_ptr<std::unordered_map<K, V>> table_;
+  static constexpr int kNumShards = 16;
+  // Below this many keys per batch the sharding bookkeeping costs more than
+  // the parallelism recovers.
+  static constexpr int64 kParallelInitThreshold = 16384;
+
+  uint32 ShardOf(const K& key) const {
+    return typename absl::flat_hash_map<K, V>::hasher()(key) % kNumShards;
+  }
+
+  thread::ThreadPool* init_workers_ = nullptr;  // not owned
+  std::unique_ptr<std::vector<absl::flat_hash_map<K, V>>> shards_;
 };
 
 }  // namespace lookup
@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <cstring>
+
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 
 namespace tensorflow {
@@ -48,6 +51,54 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return Status::OK();
 }
 
+// Converts `token` to the tensor's dtype and stores it in the scalar tensor
+// `t`. `line_number` is only used for error messages.
+Status SetTensorValueFromToken(StringPiece token, int64 line_number,
+                               Tensor* tensor) {
+  const DataType& dtype = tensor->dtype();
+  switch (dtype) {
+    case DT_INT32: {
+      int32 value;
+      if (!strings::safe_strto32(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int32.");
+      }
+      tensor->flat<int32>()(0) = value;
+    } break;
+    case DT_INT64: {
+      int64 value;
+      if (!strings::safe_strto64(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int64.");
+      }
+      tensor->flat<int64>()(0) = value;
+    } break;
+    case DT_FLOAT: {
+      float value;
+      if (!strings::safe_strtof(string(token).c_str(), &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid float.");
+      }
+      tensor->flat<float>()(0) = value;
+    } break;
+    case DT_DOUBLE: {
+      double value;
+      if (!strings::safe_strtod(string(token).c_str(), &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid double.");
+      }
+      tensor->flat<double>()(0) = value;
+    } break;
+    case DT_STRING:
+      tensor->flat<tstring>()(0).assign(token.data(), token.size());
+      break;
+    default:
+      return errors::InvalidArgument("Data type ", DataTypeString(dtype),
+                                     " not supported.");
+  }
+  return Status::OK();
+}
+
 // Iterator that reads a text file. Each iteration process one line, it parses
 // the line and populates the keys and values tensors used for initialization
 // with a single key and corresponding value.
@@ -199,58 +250,182 @@ class TextFileLineIterator
       return Status::OK();
     }
     const string& token = (index == kWholeLine) ? line : tokens[index];
-    const DataType& dtype = tensor->dtype();
-    switch (dtype) {
-      case DT_INT32: {
-        int32 value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int32.");
-        }
-        tensor->flat<int32>()(0) = value;
-      } break;
-      case DT_INT64: {
-        int64 value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int64.");
-        }
-        tensor->flat<int64>()(0) = value;
-      } break;
-      case DT_FLOAT: {
-        float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid float.");
-        }
-        tensor->flat<float>()(0) = value;
-      } break;
-      case DT_DOUBLE: {
-        double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid double.");
-        }
-        tensor->flat<double>()(0) = value;
-      } break;
-      case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
-        break;
-      default:
-        valid_ = false;
-        return errors::InvalidArgument("Data type ", DataTypeString(dtype),
-                                       " not supported.");
+    Status s = SetTensorValueFromToken(token, next_id_, tensor);
+    if (!s.ok()) {
+      valid_ = false;
     }
-    return Status::OK();
+    return s;
   }
 
   TF_DISALLOW_COPY_AND_ASSIGN(TextFileLineIterator);
 };
 
+// Iterator that serves vocabulary lines straight out of a read-only memory
+// mapping of the file. Compared to TextFileLineIterator this avoids the
+// per-line string allocation of buffered reads and the second full pass that
+// counting lines with ReadLine() costs when vocab_size is unknown: lines are
+// StringPiece slices of the mapping and the line count is a memchr scan.
+// Large vocab files (tens of millions of lines) initialize in seconds
+// instead of minutes.
+class MmapVocabFileIterator
+    : public InitializableLookupTable::InitTableIterator {
+ public:
+  MmapVocabFileIterator(std::unique_ptr<ReadOnlyMemoryRegion> region,
+                        const string& filename, int64 vocab_size,
+                        char delimiter, DataType key_dtype, int64 key_index,
+                        DataType value_dtype, int64 value_index)
+      : region_(std::move(region)),
+        filename_(filename),
+        vocab_size_(vocab_size),
+        delimiter_(delimiter),
+        key_index_(key_index),
+        value_index_(value_index),
+        status_(Status::OK()) {
+    key_ = Tensor(key_dtype, TensorShape({}));
+    value_ = Tensor(value_dtype, TensorShape({}));
+    pos_ = static_cast<const char*>(region_->data());
+    end_ = pos_ + region_->length();
+    ignore_split_ = std::max(key_index_, value_index_) < 0;
+    valid_ = true;
+    next_id_ = 0;
+    Next();
+  }
+
+  void Next() override {
+    if (!valid_) return;
+
+    if (pos_ >= end_) {
+      if (vocab_size_ != -1 && next_id_ != vocab_size_) {
+        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
+                                          ": expected ", vocab_size_,
+                                          " but got ", next_id_);
+      } else {
+        status_ = errors::OutOfRange("Reached the end of ", filename_);
+      }
+      valid_ = false;
+      return;
+    }
+    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
+      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                   << vocab_size_ << " records.";
+      LOG(WARNING) << "next_id_  : " << next_id_;
+      status_ = errors::OutOfRange("Finished reading ", vocab_size_,
+                                   " of lines from ", filename_);
+      valid_ = false;
+      return;
+    }
+
+    const char* newline =
+        static_cast<const char*>(memchr(pos_, '\n', end_ - pos_));
+    StringPiece line(pos_, (newline ? newline : end_) - pos_);
+    pos_ = newline ? newline + 1 : end_;
+    if (!line.empty() && line[line.size() - 1] == '\r') {
+      line.remove_suffix(1);
+    }
+
+    if (line.empty()) {
+      status_ = errors::InvalidArgument("Invalid content in ", filename_,
+                                        ": empty line found at position ",
+                                        pos_ - static_cast<const char*>(
+                                                   region_->data()),
+                                        ".");
+      valid_ = false;
+      return;
+    }
+
+    gtl::InlinedVector<StringPiece, 4> tokens;
+    if (!ignore_split_) {
+      SplitLine(line, &tokens);
+      if (std::max(key_index_, value_index_) >= tokens.size()) {
+        status_ = errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", next_id_,
+            " (", line, ") : expected ", std::max(key_index_, value_index_),
+            " got ", tokens.size());
+        valid_ = false;
+        return;
+      }
+    }
+    status_ = SetValue(line, tokens, key_index_, &key_);
+    if (!status_.ok()) {
+      valid_ = false;
+      return;
+    }
+    status_ = SetValue(line, tokens, value_index_, &value_);
+    if (!status_.ok()) {
+      valid_ = false;
+      return;
+    }
+
+    next_id_++;
+  }
+
+  bool Valid() const override { return valid_; }
+
+  const Tensor& keys() const override { return key_; }
+
+  const Tensor& values() const override { return value_; }
+
+  Status status() const override { return status_; }
+
+  int64 total_size() const override {
+    if (vocab_size_ == -1) {
+      // One pass over the mapping; no line materialization.
+      int64 num_lines = 0;
+      const char* p = static_cast<const char*>(region_->data());
+      const char* end = p + region_->length();
+      while (p < end) {
+        const char* newline =
+            static_cast<const char*>(memchr(p, '\n', end - p));
+        ++num_lines;
+        p = newline ? newline + 1 : end;
+      }
+      *const_cast<int64*>(&vocab_size_) = num_lines;
+    }
+    return vocab_size_;
+  }
+
+ private:
+  void SplitLine(StringPiece line,
+                 gtl::InlinedVector<StringPiece, 4>* tokens) const {
+    size_t start = 0;
+    for (size_t i = 0; i <= line.size(); ++i) {
+      if (i == line.size() || line[i] == delimiter_) {
+        tokens->emplace_back(line.data() + start, i - start);
+        start = i + 1;
+      }
+    }
+  }
+
+  Status SetValue(StringPiece line,
+                  const gtl::InlinedVector<StringPiece, 4>& tokens,
+                  int64 index, Tensor* tensor) {
+    if (index == kLineNumber) {
+      tensor->flat<int64>()(0) = next_id_;
+      return Status::OK();
+    }
+    StringPiece token = (index == kWholeLine) ? line : tokens[index];
+    return SetTensorValueFromToken(token, next_id_, tensor);
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  const string filename_;
+  int64 vocab_size_;
+  const char delimiter_;
+  const int64 key_index_;
+  const int64 value_index_;
+
+  Tensor key_;
+  Tensor value_;
+  const char* pos_;
+  const char* end_;
+  bool valid_;
+  bool ignore_split_;
+  int64 next_id_;
+  Status status_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MmapVocabFileIterator);
+};
+
 Status GetTableHandle(const string& input_name, OpKernelContext* ctx,
                       string* container, string* table_handle) {
   {
@@ -364,20 +539,34 @@ Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
         DataTypeString(table->value_dtype()));
   }
 
-  TextFileLineIterator iter;
-  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, env));
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
   // time.
-  Status s = table->Initialize(iter);
-  if (errors::IsFailedPrecondition(s) && table->is_initialized()) {
-    LOG(INFO) << "Table trying to initialize from file " << filename
-              << " is already initialized.";
-    return Status::OK();
+  auto filter_already_initialized = [&](Status s) {
+    if (errors::IsFailedPrecondition(s) && table->is_initialized()) {
+      LOG(INFO) << "Table trying to initialize from file " << filename
+                << " is already initialized.";
+      return Status::OK();
+    }
+    return s;
+  };
+
+  // Bulk path: serve lines straight out of a read-only mapping of the file.
+  // Filesystems that cannot be memory-mapped (e.g. remote object stores)
+  // fall back to buffered line reads below.
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  if (env->NewReadOnlyMemoryRegionFromFile(filename, &region).ok()) {
+    MmapVocabFileIterator iter(std::move(region), filename, vocab_size,
+                               delimiter, key_dtype, key_index, value_dtype,
+                               value_index);
+    return filter_already_initialized(table->Initialize(iter));
   }
-  return s;
+
+  TextFileLineIterator iter;
+  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
+                               key_index, value_dtype, value_index, env));
+  return filter_already_initialized(table->Initialize(iter));
 }
 
 }  // namespace lookup
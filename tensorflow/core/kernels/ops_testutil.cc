@@ -18,6 +18,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 #endif
 
+#ifdef TENSORFLOW_USE_DIRECTML
+#include "tensorflow/core/common_runtime/dml/dml_device.h"
+#include "tensorflow/core/common_runtime/dml/dml_execution_context.h"
+#include "tensorflow/core/common_runtime/dml/dml_gpu_profiler.h"
+#include "tensorflow/core/lib/core/notification.h"
+#endif
+
 #include "tensorflow/core/kernels/ops_testutil.h"
 
 namespace tensorflow {
@@ -33,6 +40,15 @@ void OpsTestBase::SetDevice(const DeviceType& device_type,
       OptimizerOptions());
 
   device_type_ = device_type;
+#ifdef TENSORFLOW_USE_DIRECTML
+  if (device_type == DeviceType(DEVICE_DML)) {
+    // DML device memory isn't CPU-addressable, so inputs are filled on the
+    // host and copied to the device when the kernel runs (see
+    // CopyInputsToDevice).
+    allocator_ = cpu_allocator();
+    return;
+  }
+#endif
 #ifdef GOOGLE_CUDA
   if (device_type == DEVICE_GPU) {
     managed_allocator_.reset(new GpuManagedAllocator());
@@ -48,9 +64,127 @@ void OpsTestBase::SetDevice(const DeviceType& device_type,
 #endif
 }
 
+#ifdef TENSORFLOW_USE_DIRECTML
+Status OpsTestBase::CopyInputsToDevice() {
+  if (device_inputs_.size() == inputs_.size()) {
+    // Inputs were already uploaded on a previous run.
+    return Status::OK();
+  }
+  gtl::STLDeleteElements(&device_tensors_);
+  device_tensors_.clear();
+  device_inputs_.clear();
+
+  const MemoryTypeVector& memory_types = kernel_->input_memory_types();
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    Tensor* host_tensor = inputs_[i].tensor;
+    if (memory_types[i] == HOST_MEMORY || inputs_[i].is_ref() ||
+        !DataTypeCanUseMemcpy(host_tensor->dtype()) ||
+        host_tensor->TotalBytes() == 0) {
+      device_inputs_.push_back(inputs_[i]);
+      continue;
+    }
+
+    Tensor* device_tensor =
+        new Tensor(device_->GetAllocator(AllocatorAttributes()),
+                   host_tensor->dtype(), host_tensor->shape());
+    device_tensors_.push_back(device_tensor);
+
+    Notification note;
+    Status copy_status;
+    device_->dml_device_context()->CopyCPUTensorToDevice(
+        host_tensor, device_, device_tensor,
+        [&note, &copy_status](const Status& s) {
+          copy_status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!copy_status.ok()) {
+      return copy_status;
+    }
+    device_inputs_.push_back({nullptr, device_tensor});
+  }
+  return Status::OK();
+}
+#endif
+
+Status OpsTestBase::RunOpKernelBenchmark(int warmup_iters, int timed_iters,
+                                         double* wall_us_per_iter,
+                                         double* gpu_us_per_iter) {
+  CHECK_GT(timed_iters, 0);
+  *wall_us_per_iter = 0;
+  *gpu_us_per_iter = 0;
+
+  for (int i = 0; i < warmup_iters; ++i) {
+    TF_RETURN_IF_ERROR(RunOpKernel());
+  }
+  // Drain the device so warmup work doesn't bleed into the timed runs.
+  TF_RETURN_IF_ERROR(device_->Sync());
+
+#ifdef TENSORFLOW_USE_DIRECTML
+  DmlGpuProfiler* profiler = nullptr;
+  if (device_type_ == DeviceType(DEVICE_DML)) {
+    profiler = static_cast<DmlDevice*>(device_)
+                   ->GetExecutionContext()
+                   ->GetGpuProfiler();
+    if (profiler) {
+      profiler->StartStepCapture();
+    }
+  }
+#endif
+
+  const uint64 start_us = Env::Default()->NowMicros();
+  for (int i = 0; i < timed_iters; ++i) {
+    TF_RETURN_IF_ERROR(RunOpKernel());
+  }
+  TF_RETURN_IF_ERROR(device_->Sync());
+  const uint64 end_us = Env::Default()->NowMicros();
+  *wall_us_per_iter = static_cast<double>(end_us - start_us) / timed_iters;
+
+#ifdef TENSORFLOW_USE_DIRECTML
+  if (profiler) {
+    // The Sync above flushed and drained the device, so every timestamp pair
+    // has resolved into the profiler's readback buffer.
+    const double frequency =
+        static_cast<double>(profiler->timestamp_frequency());
+    double total_us = 0;
+    for (const auto& event : profiler->StopStepCapture()) {
+      total_us += event.duration_ticks * 1e6 / frequency;
+    }
+    *gpu_us_per_iter = total_us / timed_iters;
+  }
+#endif
+  return Status::OK();
+}
+
 Tensor* OpsTestBase::GetOutput(int output_index) {
   CHECK_LT(output_index, context_->num_outputs());
   Tensor* output = context_->mutable_output(output_index);
+#ifdef TENSORFLOW_USE_DIRECTML
+  if (device_type_ == DeviceType(DEVICE_DML)) {
+    if (kernel_->output_memory_types()[output_index] == HOST_MEMORY ||
+        !DataTypeCanUseMemcpy(output->dtype()) || output->TotalBytes() == 0) {
+      return output;
+    }
+    managed_outputs_.resize(context_->num_outputs());
+    // Read the output back to the host if we haven't done so.
+    if (!managed_outputs_[output_index]) {
+      Tensor* host_output =
+          new Tensor(allocator(), output->dtype(), output->shape());
+      Notification note;
+      Status copy_status;
+      device_->dml_device_context()->CopyDeviceTensorToCPU(
+          output, "", device_, host_output,
+          [&note, &copy_status](const Status& s) {
+            copy_status = s;
+            note.Notify();
+          });
+      note.WaitForNotification();
+      TF_CHECK_OK(copy_status);
+      managed_outputs_[output_index] = host_output;
+    }
+    return managed_outputs_[output_index];
+  }
+#endif
 #ifdef GOOGLE_CUDA
   if (device_type_ == DEVICE_GPU) {
     managed_outputs_.resize(context_->num_outputs());
@@ -92,6 +92,9 @@ class OpsTestBase : public ::testing::Test {
   ~OpsTestBase() override {
     gtl::STLDeleteElements(&tensors_);
     gtl::STLDeleteElements(&managed_outputs_);
+#ifdef TENSORFLOW_USE_DIRECTML
+    gtl::STLDeleteElements(&device_tensors_);
+#endif
     context_.reset(nullptr);
     params_.reset(nullptr);
   }
@@ -184,6 +187,13 @@ class OpsTestBase : public ::testing::Test {
     params_->device = device_;
     params_->frame_iter = FrameAndIter(0, 0);
     params_->inputs = &inputs_;
+#ifdef TENSORFLOW_USE_DIRECTML
+    if (device_type_ == DeviceType(DEVICE_DML)) {
+      Status s = CopyInputsToDevice();
+      if (!s.ok()) return s;
+      params_->inputs = &device_inputs_;
+    }
+#endif
     params_->op_kernel = kernel_.get();
     step_container_.reset(new ScopedStepContainer(0, [](const string&) {}));
     params_->step_container = step_container_.get();
@@ -217,6 +227,18 @@ class OpsTestBase : public ::testing::Test {
   // REQUIRES: 0 <= output_index < context_->num_outputs()
   Tensor* GetOutput(int output_index);
 
+  // Runs the kernel `timed_iters` times after `warmup_iters` untimed runs
+  // (letting one-time costs like kernel compilation settle), and reports the
+  // average wall time per run through `wall_us_per_iter`. On a DML device,
+  // `gpu_us_per_iter` additionally reports the GPU execution time per run
+  // measured with the device's timestamp-query profiler (zero when the
+  // adapter doesn't support timestamp queries); on other devices it is
+  // always zero. Wall time includes dispatch and scheduling overhead, so
+  // comparing the two shows whether a slow op is CPU- or GPU-bound.
+  Status RunOpKernelBenchmark(int warmup_iters, int timed_iters,
+                              double* wall_us_per_iter,
+                              double* gpu_us_per_iter);
+
   Allocator* allocator() { return allocator_; }
 
   const DataTypeVector& output_types() const { return kernel_->output_types(); }
@@ -238,6 +260,14 @@ class OpsTestBase : public ::testing::Test {
     return input;
   }
 
+#ifdef TENSORFLOW_USE_DIRECTML
+  // Uploads host-filled inputs to the DML device, populating
+  // device_inputs_. Inputs the kernel expects in host memory, ref inputs,
+  // and inputs that can't be memcpy'd are passed through unchanged. Copies
+  // are reused across runs until more inputs are added.
+  Status CopyInputsToDevice();
+#endif
+
   // device_mgr_ owns device_.
   std::unique_ptr<DeviceMgr> device_mgr_;
   Device* device_;
@@ -256,6 +286,12 @@ class OpsTestBase : public ::testing::Test {
   gtl::InlinedVector<TensorValue, 4> inputs_;
   // Owns Tensors.
   std::vector<Tensor*> tensors_;
+#ifdef TENSORFLOW_USE_DIRECTML
+  // Device-side copies of inputs_, used in place of inputs_ when running on
+  // a DML device. device_tensors_ owns the copied tensors.
+  gtl::InlinedVector<TensorValue, 4> device_inputs_;
+  std::vector<Tensor*> device_tensors_;
+#endif
   // Copies of the outputs in unified memory (host and device accessible).
   std::vector<Tensor*> managed_outputs_;
 
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/partitioned_function_ops.h"
 
 #include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -253,6 +254,12 @@ void PartitionedCallOp::RunFunction(FunctionLibraryRuntime::Handle handle,
 
   std::vector<Tensor>* rets = new std::vector<Tensor>;
   const string& func_name = func_->name();
+
+  // Hold the device's op-run bracket open until the callee completes, so
+  // devices that batch submitted work (e.g. DML) don't flush at the
+  // function-call boundary: the callee's ops, despite running on a nested
+  // executor, batch together with the caller's.
+  ScopedOpRun* op_run = new ScopedOpRun(static_cast<Device*>(ctx->device()));
   profiler::TraceMe trace_me(
       [&] {
         return absl::StrCat(
@@ -261,8 +268,8 @@ void PartitionedCallOp::RunFunction(FunctionLibraryRuntime::Handle handle,
       },
       /*level=*/2);
   lib->Run(run_opts, handle, inputs, rets,
-           [rets, rendez, done, ctx, func_name,
-            step_container](const Status& status) {
+           [rets, rendez, done, ctx, func_name, step_container,
+            op_run](const Status& status) {
              if (!status.ok()) {
                const string function_and_msg =
                    strings::StrCat(errors::FormatFunctionForError(func_name),
@@ -274,6 +281,7 @@ void PartitionedCallOp::RunFunction(FunctionLibraryRuntime::Handle handle,
                }
              }
              delete rets;
+             delete op_run;
              delete step_container;
              rendez->Unref();
              done();
@@ -77,7 +77,9 @@ limitations under the License.
 #include "tensorflow/core/util/util.h"
 
 #ifdef TENSORFLOW_USE_DIRECTML
+#include "tensorflow/core/common_runtime/dml/dml_device.h"
 #include "tensorflow/core/common_runtime/dml/dml_util.h"
+#include "tensorflow/core/common_runtime/dml/dml_variable_arena.h"
 #endif  // TENSORFLOW_USE_DIRECTML
 
 namespace tensorflow {
@@ -605,11 +607,82 @@ TF_CALL_variant(REGISTER_GPU_KERNELS);
 class DmlAssignVariableOp : public AssignVariableOpBase {
  public:
   explicit DmlAssignVariableOp(OpKernelConstruction* c)
-      : AssignVariableOpBase(c) {}
+      : AssignVariableOpBase(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("dtype", &dtype_));
+  }
 
   void Compute(OpKernelContext* context) override {
+    if (TryPackedAssign(context)) {
+      return;
+    }
     ComputeImpl(context, &dml_util::CopyTensorInSameDevice);
   }
+
+ private:
+  // Routes small variables' backing stores through the device's variable
+  // arena, which packs them into shared allocations at stable offsets instead
+  // of one BFC chunk apiece. Returns false if this assignment should fall back
+  // to the regular adopt-the-input path (large value, arena disabled,
+  // mismatched dtype, arena OOM, ...); returns true if the assignment, or its
+  // failure status, has been fully handled.
+  bool TryPackedAssign(OpKernelContext* context) {
+    const Tensor& value = context->input(1);
+    if (value.dtype() != dtype_ || value.TotalBytes() == 0 ||
+        value.TotalBytes() > DmlVariableArena::kMaxPackedAllocationBytes) {
+      return false;
+    }
+
+    auto* device = static_cast<DmlDevice*>(context->device());
+    DmlVariableArena* arena = device->GetVariableArena();
+    if (arena == nullptr) {
+      return false;
+    }
+
+    core::RefCountPtr<Var> variable;
+    Status status = LookupOrCreateResource<Var>(
+        context, HandleFromInput(context, 0), &variable, [this](Var** ptr) {
+          *ptr = new Var(dtype_);
+          return Status::OK();
+        });
+    if (!status.ok()) {
+      context->SetStatus(status);
+      return true;
+    }
+
+    mutex_lock ml(*variable->mu());
+    if (variable->tensor()->dtype() != dtype_ ||
+        variable->copy_on_read_mode.load()) {
+      // Let ComputeImpl produce the dtype error / do the copy-on-read copy.
+      return false;
+    }
+
+    Tensor* var_tensor = variable->tensor();
+
+    // Keep the existing packed buffer (and therefore its offset) when it's
+    // the right shape and provably safe to overwrite in place.
+    const bool reuse_in_place =
+        variable->is_initialized &&
+        var_tensor->shape().IsSameSize(value.shape()) &&
+        arena->Owns(var_tensor->tensor_data().data()) &&
+        dml_util::CanUpdateVariableInPlace(context, variable.get());
+
+    if (!reuse_in_place) {
+      Tensor packed(arena, dtype_, value.shape());
+      if (!packed.IsInitialized()) {
+        return false;  // Arena allocation failed; fall back to adoption.
+      }
+      *var_tensor = packed;
+    }
+
+    // Unlike the adopt-the-input path, assigning by copy costs a small
+    // device-side copy; in exchange the variable keeps a stable, packed
+    // backing store instead of aliasing whatever produced the value.
+    dml_util::CopyTensorInSameDevice(context, var_tensor, value);
+    variable->is_initialized = true;
+    return true;
+  }
+
+  DataType dtype_;
 };
 
 #define REGISTER_DML_KERNEL(type)                            \
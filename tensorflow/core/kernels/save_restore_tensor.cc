@@ -37,6 +37,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+const char kCheckpointDeltaBaseKey[] = "_CHECKPOINT_DELTA_BASE";
+
 void SaveTensors(
     OpKernelContext* context,
     checkpoint::TensorSliceWriter::CreateBuilderFunction builder_func,
@@ -237,6 +239,14 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64 kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Number of threads used for threaded restores.
+const int kRestoreThreadPoolSize = 8;
+
+// Small tensors are restored in contiguous runs of at least this many, each
+// run sharing one reader, so they parallelize across runs without losing the
+// read locality of the sorted key order (or paying one reader per tensor).
+const size_t kMinSmallTensorsPerGroup = 16;
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -338,12 +348,36 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   BundleReader default_reader(Env::Default(), prefix_string);
   TF_RETURN_IF_ERROR(default_reader.status());
 
+  // A differential checkpoint records the full checkpoint it chains to under
+  // a reserved key; tensors absent from this bundle are read from that base.
+  string base_prefix;
+  std::unique_ptr<BundleReader> base_reader;
+  if (default_reader.Contains(kCheckpointDeltaBaseKey)) {
+    Tensor base_tensor;
+    TF_RETURN_IF_ERROR(
+        default_reader.Lookup(kCheckpointDeltaBaseKey, &base_tensor));
+    base_prefix = base_tensor.scalar<tstring>()();
+    base_reader.reset(new BundleReader(Env::Default(), base_prefix));
+    if (!base_reader->status().ok()) {
+      return errors::NotFound(
+          "Checkpoint ", prefix_string,
+          " is a differential checkpoint whose base bundle ", base_prefix,
+          " could not be opened: ", base_reader->status().error_message(),
+          ". Differential checkpoints are only restorable while their base "
+          "checkpoint is retained.");
+    }
+  }
+
   std::vector<string> mismatched_errors;
   for (const size_t i : sorted_name_idx) {
     TensorShape restored_full_shape;
     DataType original_dtype;
     const string& tensor_name = tensor_names_flat(i);
-    TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
+    BundleReader* reader = &default_reader;
+    if (base_reader != nullptr && !default_reader.Contains(tensor_name)) {
+      reader = base_reader.get();
+    }
+    TF_RETURN_IF_ERROR(reader->LookupDtypeAndShape(
         tensor_name, &original_dtype, &restored_full_shape));
     if (dtypes[i] != original_dtype) {
       string error_msg = strings::StrCat(
@@ -361,10 +395,22 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
+    BundleReader* owning_reader = &default_reader;
+    string reader_prefix = prefix_string;
+    if (base_reader != nullptr && !default_reader.Contains(tensor_name)) {
+      owning_reader = base_reader.get();
+      reader_prefix = base_prefix;
+    }
     auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
-    if (op->should_run_in_pool(&default_reader)) {
+        new RestoreOp{context, i, tensor_name, shape_and_slice, reader_prefix};
+    if (op->should_run_in_pool(owning_reader)) {
       pool_restore_ops.emplace_back(op);
+    } else if (base_reader != nullptr) {
+      // Chained restores resolve each small tensor to the bundle that holds
+      // it, so run them here with the right reader rather than through the
+      // single-bundle grouped path below.
+      direct_restore_ops.emplace_back(op);
+      TF_RETURN_IF_ERROR(op->run(owning_reader));
     } else {
       direct_restore_ops.emplace_back(op);
     }
@@ -374,17 +420,49 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
+    auto ensure_reader_pool = [&reader_pool]() {
+      if (!reader_pool) {
+        reader_pool.reset(new thread::ThreadPool(
+            Env::Default(), "restore_tensors", kRestoreThreadPoolSize));
+      }
+    };
     if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
+      ensure_reader_pool();
       for (auto& op : pool_restore_ops) {
         reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
       }
     }
 
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    if (base_reader != nullptr) {
+      // Small tensors of a chained restore already ran inline above.
+    } else if (direct_restore_ops.size() >= 2 * kMinSmallTensorsPerGroup) {
+      // Enough small tensors to be worth restoring concurrently: split them
+      // into contiguous runs of the sorted key order and give each run its
+      // own reader on the pool.
+      ensure_reader_pool();
+      size_t num_groups =
+          std::min<size_t>(kRestoreThreadPoolSize,
+                           direct_restore_ops.size() / kMinSmallTensorsPerGroup);
+      size_t group_size =
+          (direct_restore_ops.size() + num_groups - 1) / num_groups;
+      for (size_t start = 0; start < direct_restore_ops.size();
+           start += group_size) {
+        size_t end = std::min(start + group_size, direct_restore_ops.size());
+        reader_pool->Schedule(
+            [&direct_restore_ops, &prefix_string, start, end]() {
+              BundleReader reader(Env::Default(), prefix_string);
+              for (size_t j = start; j < end; ++j) {
+                RestoreOp* op = direct_restore_ops[j].get();
+                op->status =
+                    reader.status().ok() ? op->run(&reader) : reader.status();
+              }
+            });
+      }
+    } else {
+      // Read small tensors from the op thread
+      for (auto& op : direct_restore_ops) {
+        TF_RETURN_IF_ERROR(op->run(&default_reader));
+      }
     }
   }
 
@@ -392,6 +470,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto& op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  for (auto& op : direct_restore_ops) {
+    TF_RETURN_IF_ERROR(op->status);
+  }
 
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
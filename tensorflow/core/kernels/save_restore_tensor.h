@@ -55,6 +55,11 @@ void RestoreTensor(OpKernelContext* context,
 
 // V2 checkpoint format.
 
+// Reserved bundle key under which a differential checkpoint records the
+// prefix of the full checkpoint it chains to.  RestoreTensorsV2 reads tensors
+// absent from the bundle being restored from that base bundle instead.
+extern const char kCheckpointDeltaBaseKey[];
+
 // Invokes the V2 checkpoint read path to read tensors.
 //
 // "context" is only used for allocating outputs.  In particular, the inputs are
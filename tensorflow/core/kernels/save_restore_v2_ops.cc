@@ -16,19 +16,24 @@ limitations under the License.
 // See docs in ../ops/io_ops.cc.
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -85,6 +90,161 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Writes the given tensors to a bundle at "prefix_string". Factored out of
+// SaveV2::Compute so that asynchronous saves can run the serialization on a
+// background thread.
+Status WriteTensorsToBundle(const string& prefix_string,
+                            const std::vector<string>& tensor_names,
+                            const std::vector<string>& shape_and_slices,
+                            const std::vector<Tensor>& tensors) {
+  BundleWriter writer(Env::Default(), prefix_string);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const string& tensor_name = tensor_names[i];
+    const Tensor& tensor = tensors[i];
+
+    if (!shape_and_slices[i].empty()) {
+      const string& shape_spec = shape_and_slices[i];
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice "
+            "specification does not match the "
+            "shape of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+  }
+  return writer.Finish();
+}
+
+// State shared by all asynchronous SaveV2 invocations in the process. At most
+// one background save is in flight at a time; a failure is surfaced on the
+// next SaveV2 call so checkpointing errors are not silently dropped.
+struct AsyncSaveState {
+  mutex mu;
+  condition_variable done_cv;
+  bool in_flight GUARDED_BY(mu) = false;
+  Status last_status GUARDED_BY(mu);
+};
+
+AsyncSaveState* GetAsyncSaveState() {
+  static AsyncSaveState* state = new AsyncSaveState;
+  return state;
+}
+
+bool AsyncSaveEnabled() {
+  bool enabled = false;
+  TF_CHECK_OK(
+      ReadBoolFromEnvVar("TF_CHECKPOINT_ASYNC_SAVE", false, &enabled));
+  return enabled;
+}
+
+// State for differential checkpointing. Tracks the prefix of the last full
+// checkpoint written by this process and a fingerprint of every tensor as it
+// appears in that base, so that subsequent saves can skip tensors that have
+// not changed since the base was written.
+struct DeltaSaveState {
+  mutex mu;
+  string base_prefix GUARDED_BY(mu);
+  std::unordered_map<string, uint64> base_fingerprints GUARDED_BY(mu);
+  int64 saves_since_base GUARDED_BY(mu) = 0;
+};
+
+DeltaSaveState* GetDeltaSaveState() {
+  static DeltaSaveState* state = new DeltaSaveState;
+  return state;
+}
+
+bool DeltaSaveEnabled() {
+  bool enabled = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_CHECKPOINT_DELTA", false, &enabled));
+  return enabled;
+}
+
+uint64 TensorFingerprint(const Tensor& tensor) {
+  uint64 fp = Fingerprint64(tensor.tensor_data());
+  fp = FingerprintCat64(fp, static_cast<uint64>(tensor.dtype()));
+  for (int d = 0; d < tensor.dims(); ++d) {
+    fp = FingerprintCat64(fp, static_cast<uint64>(tensor.dim_size(d)));
+  }
+  return fp;
+}
+
+// Applies differential checkpointing to the tensors about to be saved. Every
+// TF_CHECKPOINT_DELTA_FULL_EVERY-th save (and the first) is written in full
+// and becomes the base; saves in between drop tensors whose fingerprints
+// match the base and record the base prefix under kCheckpointDeltaBaseKey so
+// RestoreTensorsV2 can chain to it. Sliced saves and non-memcpyable dtypes
+// are always written in full. The chain is always one level deep: every
+// delta compares against (and restores through) the base bundle directly.
+void FilterDeltaTensors(const string& prefix_string, std::vector<string>* names,
+                        std::vector<string>* specs,
+                        std::vector<Tensor>* tensors) {
+  int64 full_every;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_CHECKPOINT_DELTA_FULL_EVERY", 10,
+                                  &full_every));
+  DeltaSaveState* state = GetDeltaSaveState();
+  mutex_lock l(state->mu);
+  if (state->base_prefix.empty() ||
+      state->saves_since_base + 1 >= full_every) {
+    // Full save: rebuild the base fingerprints.
+    state->base_prefix = prefix_string;
+    state->saves_since_base = 0;
+    state->base_fingerprints.clear();
+    for (size_t i = 0; i < tensors->size(); ++i) {
+      const Tensor& tensor = (*tensors)[i];
+      if ((*specs)[i].empty() && DataTypeCanUseMemcpy(tensor.dtype())) {
+        state->base_fingerprints[(*names)[i]] = TensorFingerprint(tensor);
+      }
+    }
+    return;
+  }
+
+  std::vector<string> kept_names;
+  std::vector<string> kept_specs;
+  std::vector<Tensor> kept_tensors;
+  for (size_t i = 0; i < tensors->size(); ++i) {
+    const Tensor& tensor = (*tensors)[i];
+    bool unchanged = false;
+    if ((*specs)[i].empty() && DataTypeCanUseMemcpy(tensor.dtype())) {
+      auto it = state->base_fingerprints.find((*names)[i]);
+      unchanged = it != state->base_fingerprints.end() &&
+                  it->second == TensorFingerprint(tensor);
+    }
+    if (!unchanged) {
+      kept_names.push_back(std::move((*names)[i]));
+      kept_specs.push_back(std::move((*specs)[i]));
+      kept_tensors.push_back(std::move((*tensors)[i]));
+    }
+  }
+  VLOG(1) << "Delta checkpoint " << prefix_string << ": writing "
+          << kept_tensors.size() << " of " << tensors->size()
+          << " tensors against base " << state->base_prefix;
+  state->saves_since_base++;
+
+  Tensor base_tensor(DT_STRING, TensorShape({}));
+  base_tensor.scalar<tstring>()() = state->base_prefix;
+  kept_names.push_back(kCheckpointDeltaBaseKey);
+  kept_specs.push_back("");
+  kept_tensors.push_back(std::move(base_tensor));
+
+  names->swap(kept_names);
+  specs->swap(kept_specs);
+  tensors->swap(kept_tensors);
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
@@ -105,36 +265,62 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+    const bool async_save = AsyncSaveEnabled();
 
+    std::vector<string> names(num_tensors);
+    std::vector<string> specs(num_tensors);
+    std::vector<Tensor> tensors;
+    tensors.reserve(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      names[i] = tensor_names_flat(i);
+      specs[i] = shape_and_slices_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
+      if (async_save) {
+        // Inputs may alias variable memory (e.g. CPU-resident ref variables),
+        // which training keeps mutating once this op returns. Snapshot them
+        // into private buffers before handing off to the background thread;
+        // this is a host memcpy, much cheaper than the disk write it unblocks.
+        tensors.push_back(tensor::DeepCopy(tensor));
       } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+        tensors.push_back(tensor);
       }
     }
-    OP_REQUIRES_OK(context, writer.Finish());
+
+    if (DeltaSaveEnabled()) {
+      FilterDeltaTensors(prefix_string, &names, &specs, &tensors);
+    }
+
+    if (!async_save) {
+      OP_REQUIRES_OK(
+          context, WriteTensorsToBundle(prefix_string, names, specs, tensors));
+      return;
+    }
+
+    AsyncSaveState* state = GetAsyncSaveState();
+    {
+      mutex_lock l(state->mu);
+      // Serialize overlapping saves; a second checkpoint while the previous
+      // one is still being written waits here rather than interleaving.
+      while (state->in_flight) {
+        state->done_cv.wait(l);
+      }
+      Status prev = state->last_status;
+      state->last_status = Status::OK();
+      OP_REQUIRES_OK(context, prev);
+      state->in_flight = true;
+    }
+    Env::Default()->SchedClosure([state, prefix_string, names, specs,
+                                  tensors]() {
+      Status s = WriteTensorsToBundle(prefix_string, names, specs, tensors);
+      if (!s.ok()) {
+        LOG(ERROR) << "Asynchronous checkpoint save to " << prefix_string
+                   << " failed: " << s;
+      }
+      mutex_lock l(state->mu);
+      state->last_status = s;
+      state->in_flight = false;
+      state->done_cv.notify_all();
+    });
   }
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
@@ -88,6 +88,14 @@ REGISTER_KERNEL_BUILDER(Name("_ScopedAllocator").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("_ScopedAllocator").Device(DEVICE_GPU),
                         ScopedAllocatorOp);
 
+#ifdef TENSORFLOW_USE_DIRECTML
+// These kernels never touch tensor data; they only compute offsets into the
+// backing tensor's (tagged) base pointer, which is valid arithmetic for DML
+// device allocations.
+REGISTER_KERNEL_BUILDER(Name("_ScopedAllocator").Device(DEVICE_DML),
+                        ScopedAllocatorOp);
+#endif  // TENSORFLOW_USE_DIRECTML
+
 class ScopedAllocatorConcatOp : public OpKernel {
  public:
   explicit ScopedAllocatorConcatOp(OpKernelConstruction* context)
@@ -169,6 +177,11 @@ REGISTER_KERNEL_BUILDER(Name("_ScopedAllocatorConcat").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("_ScopedAllocatorConcat").Device(DEVICE_GPU),
                         ScopedAllocatorConcatOp);
 
+#ifdef TENSORFLOW_USE_DIRECTML
+REGISTER_KERNEL_BUILDER(Name("_ScopedAllocatorConcat").Device(DEVICE_DML),
+                        ScopedAllocatorConcatOp);
+#endif  // TENSORFLOW_USE_DIRECTML
+
 class ScopedAllocatorSplitOp : public OpKernel {
  public:
   explicit ScopedAllocatorSplitOp(OpKernelConstruction* context)
@@ -231,4 +244,9 @@ REGISTER_KERNEL_BUILDER(Name("_ScopedAllocatorSplit").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("_ScopedAllocatorSplit").Device(DEVICE_GPU),
                         ScopedAllocatorSplitOp);
 
+#ifdef TENSORFLOW_USE_DIRECTML
+REGISTER_KERNEL_BUILDER(Name("_ScopedAllocatorSplit").Device(DEVICE_DML),
+                        ScopedAllocatorSplitOp);
+#endif  // TENSORFLOW_USE_DIRECTML
+
 }  // namespace tensorflow
@@ -19,17 +19,168 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Row-parallel CSR fast path for the CPU kernel.
+//
+// The COO nonzero loop below (see the functor at the end of this file)
+// scatters into output rows in index order, which has poor locality and, per
+// the TODO there, resisted multi-threading. Grouping the nonzeros by output
+// row once turns the product into independent per-row accumulations that
+// shard cleanly across the intra-op pool.
+//
+// Feature-lookup workloads run many steps against the same sparsity pattern
+// (same indices, different values), so the row partition is cached, keyed by
+// a fingerprint of the raw indices bytes and the dimensions the bounds
+// checks depend on. A fingerprint collision would silently reuse the wrong
+// partition, but at 64 bits that risk is accepted, as with other
+// fingerprint-keyed caches in the runtime.
+
+// Minimum number of nonzeros before the CSR path pays for its preprocessing
+// (or a fingerprint probe) per call.
+constexpr int64 kCsrNnzThreshold = 512;
+
+// Maximum cached patterns per index type. The cache is cleared when full;
+// steady-state serving uses only a handful of patterns.
+constexpr int kCsrPatternCacheMaxEntries = 16;
+
+template <typename Tindices>
+struct CsrPattern {
+  std::vector<int64> row_ptr;  // size num_rows + 1
+  std::vector<Tindices> cols;  // column of each nonzero, in CSR order
+  std::vector<int64> perm;     // CSR position -> position in a_values
+};
+
+template <typename Tindices>
+Status GetOrBuildCsrPattern(
+    const Tensor& a_indices_t, int64 num_rows, int64 inner_dim,
+    std::shared_ptr<const CsrPattern<Tindices>>* pattern) {
+  static mutex* mu = new mutex;
+  static auto* cache =
+      new std::unordered_map<uint64,
+                             std::shared_ptr<const CsrPattern<Tindices>>>;
+
+  uint64 key = Fingerprint64(a_indices_t.tensor_data());
+  key = FingerprintCat64(key, static_cast<uint64>(num_rows));
+  key = FingerprintCat64(key, static_cast<uint64>(inner_dim));
+  {
+    mutex_lock l(*mu);
+    auto it = cache->find(key);
+    if (it != cache->end()) {
+      *pattern = it->second;
+      return Status::OK();
+    }
+  }
+
+  auto a_indices = a_indices_t.matrix<Tindices>();
+  const int64 nnz = a_indices_t.dim_size(0);
+  auto built = std::make_shared<CsrPattern<Tindices>>();
+  built->row_ptr.assign(num_rows + 1, 0);
+  for (int64 i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, 0));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, 1));
+    if (!FastBoundsCheck(k, inner_dim)) {
+      return errors::InvalidArgument("k (", k, ") from index[", i,
+                                     ",1] out of bounds (>=", inner_dim, ")");
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return errors::InvalidArgument("m (", m, ") from index[", i,
+                                     ",0] out of bounds (>=", num_rows, ")");
+    }
+    ++built->row_ptr[m + 1];
+  }
+  for (int64 m = 0; m < num_rows; ++m) {
+    built->row_ptr[m + 1] += built->row_ptr[m];
+  }
+  built->cols.resize(nnz);
+  built->perm.resize(nnz);
+  std::vector<int64> next(built->row_ptr.begin(), built->row_ptr.end() - 1);
+  for (int64 i = 0; i < nnz; ++i) {
+    const int64 m = static_cast<int64>(a_indices(i, 0));
+    const int64 pos = next[m]++;
+    built->cols[pos] = a_indices(i, 1);
+    built->perm[pos] = i;
+  }
+
+  {
+    mutex_lock l(*mu);
+    if (cache->size() >= kCsrPatternCacheMaxEntries) {
+      cache->clear();
+    }
+    (*cache)[key] = built;
+  }
+  *pattern = std::move(built);
+  return Status::OK();
+}
+
+// Computes out = A * B for non-adjoint A and B, with rows of the output
+// sharded across the intra-op pool. Bounds were validated when the pattern
+// was built (the dimensions they depend on are part of the cache key).
+template <typename T, typename Tindices>
+Status CsrSparseDenseMatMulCpu(OpKernelContext* ctx,
+                               typename TTypes<T>::Matrix out,
+                               const Tensor& a_indices_t,
+                               typename TTypes<T>::ConstVec a_values,
+                               typename TTypes<T>::ConstMatrix b) {
+  const int64 num_rows = out.dimension(0);
+  const int64 rhs_right = out.dimension(1);
+  const int64 inner_dim = b.dimension(0);
+
+  std::shared_ptr<const CsrPattern<Tindices>> pattern;
+  TF_RETURN_IF_ERROR(GetOrBuildCsrPattern<Tindices>(a_indices_t, num_rows,
+                                                    inner_dim, &pattern));
+  const CsrPattern<Tindices>& p = *pattern;
+
+  const T* values = a_values.data();
+  const T* b_data = b.data();
+  T* out_data = out.data();
+
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  const int64 avg_nnz_per_row =
+      std::max(int64{1}, static_cast<int64>(p.cols.size()) / num_rows);
+  // A multiply-add per output element touched, on rhs_right-wide rows.
+  const int64 cost_per_row = avg_nnz_per_row * rhs_right * 2;
+  Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+        cost_per_row,
+        [&p, values, b_data, out_data, rhs_right](int64 row_begin,
+                                                  int64 row_end) {
+          for (int64 m = row_begin; m < row_end; ++m) {
+            T* out_row = out_data + m * rhs_right;
+            for (int64 n = 0; n < rhs_right; ++n) {
+              out_row[n] = T(0);
+            }
+            for (int64 pos = p.row_ptr[m]; pos < p.row_ptr[m + 1]; ++pos) {
+              const T a_value = values[p.perm[pos]];
+              const T* b_row = b_data + static_cast<int64>(p.cols[pos]) * rhs_right;
+              for (int64 n = 0; n < rhs_right; ++n) {
+                out_row[n] += a_value * b_row[n];
+              }
+            }
+          }
+        });
+  return Status::OK();
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tindices>
 class SparseTensorDenseMatMulOp : public OpKernel {
  public:
@@ -133,6 +284,14 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       return;
     }
 
+    if (std::is_same<Device, CPUDevice>::value && !adjoint_a_ && !adjoint_b_ &&
+        nnz >= kCsrNnzThreshold && outer_left > 1) {
+      OP_REQUIRES_OK(ctx, CsrSparseDenseMatMulCpu<T, Tindices>(
+                              ctx, out->matrix<T>(), *a_indices,
+                              a_values->vec<T>(), b->matrix<T>()));
+      return;
+    }
+
 #define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                        \
   if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                        \
     Status functor_status = functor::SparseTensorDenseMatMulFunctor<       \
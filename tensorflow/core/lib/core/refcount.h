@@ -48,6 +48,11 @@ class RefCounted {
   // object.
   bool RefCountIsOne() const;
 
+  // Return the current reference count. The value is inherently racy when
+  // other threads may add or drop references; callers that act on it must
+  // otherwise guarantee that no new references can appear concurrently.
+  int_fast32_t RefCount() const;
+
  protected:
   // Make destructor protected so that RefCounted objects cannot
   // be instantiated directly. Only subclasses can be instantiated.
@@ -112,6 +117,10 @@ inline bool RefCounted::RefCountIsOne() const {
   return (ref_.load(std::memory_order_acquire) == 1);
 }
 
+inline int_fast32_t RefCounted::RefCount() const {
+  return ref_.load(std::memory_order_acquire);
+}
+
 }  // namespace core
 }  // namespace tensorflow
 
@@ -0,0 +1,147 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/pipelined_inputstream.h"
+
+#include <algorithm>
+
+namespace tensorflow {
+namespace io {
+
+constexpr size_t PipelinedInputStream::kChunkBytes;
+
+PipelinedInputStream::PipelinedInputStream(InputStreamInterface* input_stream,
+                                           size_t readahead_bytes,
+                                           bool owns_input_stream)
+    : input_stream_(input_stream),
+      readahead_bytes_(std::max(readahead_bytes, kChunkBytes)),
+      owns_input_stream_(owns_input_stream) {
+  StartWorker();
+}
+
+PipelinedInputStream::~PipelinedInputStream() {
+  StopWorker();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+void PipelinedInputStream::StartWorker() {
+  worker_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "pipelined_inputstream", [this]() { WorkerLoop(); }));
+}
+
+void PipelinedInputStream::StopWorker() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    work_cv_.notify_all();
+  }
+  worker_.reset();  // joins the thread
+}
+
+void PipelinedInputStream::WorkerLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && buffered_bytes_ >= readahead_bytes_) {
+        work_cv_.wait(l);
+      }
+      if (cancelled_) {
+        return;
+      }
+    }
+
+    // Read outside the lock: this is where the expensive work (e.g. inflate)
+    // happens, concurrently with the consumer draining earlier chunks.
+    string chunk;
+    Status s = input_stream_->ReadNBytes(kChunkBytes, &chunk);
+
+    mutex_lock l(mu_);
+    if (!chunk.empty()) {
+      buffered_bytes_ += chunk.size();
+      chunks_.push_back(std::move(chunk));
+    }
+    if (!s.ok()) {
+      // Terminal: OUT_OF_RANGE at clean EOF, or a real error. Either way the
+      // consumer drains what was produced and then sees this status.
+      worker_status_ = s;
+      worker_done_ = true;
+      bytes_cv_.notify_all();
+      return;
+    }
+    bytes_cv_.notify_all();
+  }
+}
+
+Status PipelinedInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+
+  mutex_lock l(mu_);
+  while (static_cast<int64>(result->size()) < bytes_to_read) {
+    while (chunks_.empty() && !worker_done_) {
+      bytes_cv_.wait(l);
+    }
+    if (chunks_.empty()) {
+      pos_ += result->size();
+      return worker_status_;
+    }
+
+    const string& front = chunks_.front();
+    size_t available = front.size() - front_pos_;
+    size_t needed = bytes_to_read - result->size();
+    size_t to_copy = std::min(available, needed);
+    result->append(front, front_pos_, to_copy);
+    front_pos_ += to_copy;
+    if (front_pos_ == front.size()) {
+      buffered_bytes_ -= front.size();
+      chunks_.pop_front();
+      front_pos_ = 0;
+      work_cv_.notify_all();
+    }
+  }
+  pos_ += bytes_to_read;
+  return Status::OK();
+}
+
+int64 PipelinedInputStream::Tell() const {
+  mutex_lock l(mu_);
+  return pos_;
+}
+
+Status PipelinedInputStream::Reset() {
+  StopWorker();
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  {
+    mutex_lock l(mu_);
+    chunks_.clear();
+    front_pos_ = 0;
+    buffered_bytes_ = 0;
+    worker_done_ = false;
+    worker_status_ = Status::OK();
+    cancelled_ = false;
+    pos_ = 0;
+  }
+  StartWorker();
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
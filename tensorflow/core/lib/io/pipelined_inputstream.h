@@ -0,0 +1,97 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_PIPELINED_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_PIPELINED_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace io {
+
+// Runs an InputStreamInterface on a background thread, reading ahead of the
+// consumer through a bounded, ordered queue of chunks. This pipelines the
+// cost of producing bytes (e.g. inflating a compressed stream) with the
+// consumer's own work, so a decompression-bound reader is no longer limited
+// to one core's worth of inflate throughput interleaved with parsing.
+//
+// The wrapped stream is only ever accessed from the worker thread between
+// construction/Reset() and destruction/the next Reset(), so any
+// single-threaded stream (ZlibInputStream in particular) is safe to wrap.
+//
+// A single instance is NOT safe for concurrent use by multiple threads.
+class PipelinedInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of input_stream unless owns_input_stream is set
+  // to true. input_stream must outlive *this then.
+  //
+  // The worker stays at most readahead_bytes ahead of the consumer.
+  PipelinedInputStream(InputStreamInterface* input_stream,
+                       size_t readahead_bytes,
+                       bool owns_input_stream = false);
+
+  ~PipelinedInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Granularity of worker reads and of queue entries.
+  static constexpr size_t kChunkBytes = 256 * 1024;
+
+  void StartWorker();
+  // Blocks until the worker thread has exited.
+  void StopWorker();
+  void WorkerLoop();
+
+  InputStreamInterface* input_stream_;  // not owned, unless owns_input_stream_
+  const size_t readahead_bytes_;
+  const bool owns_input_stream_;
+
+  mutable mutex mu_;
+  condition_variable work_cv_ GUARDED_BY(mu_);   // wakes the worker
+  condition_variable bytes_cv_ GUARDED_BY(mu_);  // wakes the consumer
+
+  // Chunks the worker has produced but the consumer hasn't fully read, in
+  // stream order. front_pos_ is the consumer's offset into the front chunk.
+  std::deque<string> chunks_ GUARDED_BY(mu_);
+  size_t front_pos_ GUARDED_BY(mu_) = 0;
+  size_t buffered_bytes_ GUARDED_BY(mu_) = 0;
+
+  // Set once the worker has stopped producing; worker_status_ then holds the
+  // terminal status of the wrapped stream (OUT_OF_RANGE at clean EOF).
+  bool worker_done_ GUARDED_BY(mu_) = false;
+  Status worker_status_ GUARDED_BY(mu_);
+  bool cancelled_ GUARDED_BY(mu_) = false;
+
+  int64 pos_ GUARDED_BY(mu_) = 0;  // bytes returned to the consumer
+
+  std::unique_ptr<Thread> worker_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PipelinedInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_PIPELINED_INPUTSTREAM_H_
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/pipelined_inputstream.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/env.h"
 
@@ -46,6 +47,14 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
+#else
+    options.zstd_options = io::ZstdCompressionOptions::DEFAULT();
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,6 +80,29 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
+    if (options.decompression_readahead_bytes > 0) {
+      // Move inflate onto a background thread so it overlaps with record
+      // parsing and the caller's own processing of the records.
+      input_stream_.reset(new PipelinedInputStream(
+          input_stream_.release(),
+          static_cast<size_t>(options.decompression_readahead_bytes), true));
+    }
+#endif  // IS_SLIM_BUILD
+  } else if (options.compression_type == RecordReaderOptions::ZSTD_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Zstd compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    input_stream_.reset(new ZstdInputStream(
+        input_stream_.release(), options.zstd_options.input_buffer_size,
+        options.zstd_options, true));
+    if (options.decompression_readahead_bytes > 0) {
+      // Frame decode already runs on a pool inside ZstdInputStream; the
+      // pipeline additionally overlaps it with record parsing and the
+      // caller's own processing of the records.
+      input_stream_.reset(new PipelinedInputStream(
+          input_stream_.release(),
+          static_cast<size_t>(options.decompression_readahead_bytes), true));
+    }
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -202,5 +234,56 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+MemoryRegionRecordReader::MemoryRegionRecordReader(
+    const ReadOnlyMemoryRegion* region)
+    : region_(region) {}
+
+Status MemoryRegionRecordReader::ReadRecord(StringPiece* record) {
+  const char* data = static_cast<const char*>(region_->data());
+  const uint64 size = region_->length();
+
+  if (offset_ == size) {
+    return errors::OutOfRange("eof");
+  }
+  if (size - offset_ < RecordReader::kHeaderSize) {
+    return errors::DataLoss("truncated record at ", offset_);
+  }
+
+  const char* header = data + offset_;
+  const uint32 masked_length_crc =
+      core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_length_crc) !=
+      crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset_);
+  }
+
+  const uint64 length = core::DecodeFixed64(header);
+  if (length > size - offset_ - RecordReader::kHeaderSize ||
+      size - offset_ - RecordReader::kHeaderSize - length <
+          RecordReader::kFooterSize) {
+    return errors::DataLoss("truncated record at ", offset_);
+  }
+
+  const char* payload = header + RecordReader::kHeaderSize;
+  const uint32 masked_data_crc = core::DecodeFixed32(payload + length);
+  if (crc32c::Unmask(masked_data_crc) != crc32c::Value(payload, length)) {
+    return errors::DataLoss("corrupted record at ", offset_);
+  }
+
+  *record = StringPiece(payload, length);
+  offset_ += RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+  return Status::OK();
+}
+
+Status MemoryRegionRecordReader::SeekOffset(uint64 offset) {
+  if (offset > region_->length()) {
+    return errors::InvalidArgument("Trying to seek offset: ", offset,
+                                   " which is beyond the file size: ",
+                                   region_->length());
+  }
+  offset_ = offset;
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
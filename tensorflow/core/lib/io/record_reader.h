@@ -22,6 +22,8 @@ limitations under the License.
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
@@ -29,12 +31,17 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
 class RecordReaderOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    ZSTD_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
   // If buffer_size is non-zero, then all reads must be sequential, and no
@@ -42,12 +49,20 @@ class RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If non-zero and compression is enabled, decompression runs on a
+  // background thread that stays up to this many decompressed bytes ahead of
+  // the reader, pipelining inflate with record parsing and consumption.
+  int64 decompression_readahead_bytes = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
 #if !defined(IS_SLIM_BUILD)
   // Options specific to zlib compression.
   ZlibCompressionOptions zlib_options;
+
+  // Options specific to zstd compression.
+  ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -152,6 +167,38 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Reads TFRecord data directly out of a read-only memory region, e.g. a
+// memory-mapped uncompressed TFRecord file. Records are returned as zero-copy
+// slices of the region, so reading a record touches the payload bytes once
+// (for checksum verification) instead of copying them through a stream
+// buffer. Returned slices remain valid for the lifetime of the region, which
+// must outlive this reader.
+//
+// Note: this class is not thread safe; external synchronization required.
+class MemoryRegionRecordReader {
+ public:
+  // Create a reader over "*region". "*region" must remain live while this
+  // reader and any slices it returned are in use.
+  explicit MemoryRegionRecordReader(const ReadOnlyMemoryRegion* region);
+
+  // Reads the next record as a slice of the underlying region. Returns OK on
+  // success, OUT_OF_RANGE for end of file, or something else for an error.
+  Status ReadRecord(StringPiece* record);
+
+  // Returns the current offset in the file.
+  uint64 TellOffset() { return offset_; }
+
+  // Seek to this offset within the file and set this offset as the current
+  // offset.
+  Status SeekOffset(uint64 offset);
+
+ private:
+  const ReadOnlyMemoryRegion* const region_;
+  uint64 offset_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryRegionRecordReader);
+};
+
 }  // namespace io
 }  // namespace tensorflow
 
@@ -158,6 +158,43 @@ TEST(RecordReaderWriterTest, TestBasics) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestMemoryRegion) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_mmap_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+    io::MemoryRegionRecordReader reader(region.get());
+    StringPiece record;
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ("abc", record);
+    // The record is a zero-copy slice of the mapping, not a copy.
+    EXPECT_GE(record.data(), static_cast<const char*>(region->data()));
+    EXPECT_LE(record.data() + record.size(),
+              static_cast<const char*>(region->data()) + region->length());
+    uint64 second_record_offset = reader.TellOffset();
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ("defg", record);
+    CHECK_EQ(reader.ReadRecord(&record).code(), error::OUT_OF_RANGE);
+
+    // Re-read the second record after seeking back to it.
+    TF_CHECK_OK(reader.SeekOffset(second_record_offset));
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ("defg", record);
+  }
+}
+
 TEST(RecordReaderWriterTest, TestZlib) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_zlib_test";
@@ -196,6 +233,51 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZstd) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zstd_test";
+
+  // Exercise both multi-frame output (tiny frames) and single-frame output,
+  // and both the parallel frame decoder and the streaming decoder.
+  for (int64 frame_size : {16, 1 << 20}) {
+    for (int32 parallel_decodes : {1, 4}) {
+      {
+        std::unique_ptr<WritableFile> file;
+        TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+        io::RecordWriterOptions options;
+        options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+        options.zstd_options.frame_size_bytes = frame_size;
+        io::RecordWriter writer(file.get(), options);
+        TF_EXPECT_OK(writer.WriteRecord("abc"));
+        TF_EXPECT_OK(writer.WriteRecord("defg"));
+        TF_EXPECT_OK(writer.WriteRecord(string(1000, 'x')));
+        TF_CHECK_OK(writer.Flush());
+      }
+
+      {
+        std::unique_ptr<RandomAccessFile> read_file;
+        // Read it back with the RecordReader.
+        TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+        io::RecordReaderOptions options;
+        options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
+        options.zstd_options.num_parallel_decodes = parallel_decodes;
+        io::RecordReader reader(read_file.get(), options);
+        uint64 offset = 0;
+        string record;
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ("abc", record);
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ("defg", record);
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(string(1000, 'x'), record);
+        CHECK_EQ(reader.ReadRecord(&offset, &record).code(),
+                 error::OUT_OF_RANGE);
+      }
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
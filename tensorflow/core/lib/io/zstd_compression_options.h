@@ -0,0 +1,64 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+class ZstdCompressionOptions {
+ public:
+  static ZstdCompressionOptions DEFAULT();
+
+  // Size of the buffer used for caching compressed data read from the source
+  // stream.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the buffer where compressed output is cached before being written
+  // to the destination file.
+  int64 output_buffer_size = 256 << 10;
+
+  // From the zstd manual (https://facebook.github.io/zstd/zstd_manual.html):
+  // compression levels typically range from 1 (fastest) to 22 (best ratio);
+  // level 3 is the library default and a good speed/ratio compromise for
+  // record data.
+  int8 compression_level = 3;
+
+  // The writer closes the current frame and starts a new one once this many
+  // uncompressed bytes have been appended to it. Each frame is an
+  // independently decodable unit of the standard zstd format, so smaller
+  // frames cost a little ratio but let readers decompress many frames in
+  // parallel.
+  int64 frame_size_bytes = 256 << 10;
+
+  // Maximum number of complete frames the reader decompresses concurrently.
+  // Values <= 1 select the plain streaming decoder. Only multi-frame inputs
+  // (e.g. files produced by the writer above) benefit; a single-frame file
+  // decodes serially regardless.
+  int32 num_parallel_decodes = 4;
+};
+
+inline ZstdCompressionOptions ZstdCompressionOptions::DEFAULT() {
+  return ZstdCompressionOptions();
+}
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
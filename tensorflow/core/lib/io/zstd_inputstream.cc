@@ -0,0 +1,301 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+
+namespace {
+
+// If this many compressed bytes are buffered without containing a single
+// complete frame, the input is effectively single-frame (or has frames far
+// larger than anything the writer produces) and buffering whole frames for
+// parallel decode would cost unbounded memory. Fall back to the streaming
+// decoder instead.
+constexpr size_t kMaxFrameProbeBytes = 64 << 20;
+
+}  // namespace
+
+struct ZstdInputStream::StreamState {
+  ZSTD_DStream* dstream = nullptr;
+
+  StreamState() { dstream = ZSTD_createDStream(); }
+  ~StreamState() {
+    if (dstream) ZSTD_freeDStream(dstream);
+  }
+};
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 const ZstdCompressionOptions& zstd_options,
+                                 bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      zstd_options_(zstd_options) {
+  if (zstd_options_.num_parallel_decodes > 1) {
+    thread_pool_.reset(new thread::ThreadPool(
+        Env::Default(), "zstd_inputstream",
+        zstd_options_.num_parallel_decodes));
+  }
+}
+
+ZstdInputStream::~ZstdInputStream() {
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  compressed_.clear();
+  compressed_pos_ = 0;
+  input_eof_ = false;
+  decompressed_.clear();
+  front_pos_ = 0;
+  stream_state_.reset();
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status ZstdInputStream::FillCompressed() {
+  if (input_eof_) {
+    return Status::OK();
+  }
+  string chunk;
+  Status s = input_stream_->ReadNBytes(input_buffer_capacity_, &chunk);
+  if (errors::IsOutOfRange(s)) {
+    // A partial chunk may still have been read.
+    input_eof_ = true;
+  } else {
+    TF_RETURN_IF_ERROR(s);
+  }
+  compressed_.append(chunk);
+  return Status::OK();
+}
+
+/*static*/ Status ZstdInputStream::DecompressFrame(const char* data,
+                                                   size_t size,
+                                                   string* result) {
+  result->clear();
+
+  const unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+  if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+    return errors::DataLoss("not a valid zstd frame");
+  }
+
+  if (content_size != ZSTD_CONTENTSIZE_UNKNOWN) {
+    // The frame header records the decompressed size (frames written by
+    // ZstdOutputBuffer always do), so the output can be decoded in one shot.
+    result->resize(content_size);
+    if (content_size == 0) {
+      // Skippable or empty frame.
+      return Status::OK();
+    }
+    const size_t ret =
+        ZSTD_decompress(&(*result)[0], result->size(), data, size);
+    if (ZSTD_isError(ret)) {
+      return errors::DataLoss("zstd decompression failed: ",
+                              ZSTD_getErrorName(ret));
+    }
+    result->resize(ret);
+    return Status::OK();
+  }
+
+  // Unknown content size: stream-decode the frame into a growing buffer.
+  StreamState state;
+  ZSTD_inBuffer input = {data, size, 0};
+  string chunk;
+  while (input.pos < input.size) {
+    chunk.resize(ZSTD_DStreamOutSize());
+    ZSTD_outBuffer output = {&chunk[0], chunk.size(), 0};
+    const size_t ret = ZSTD_decompressStream(state.dstream, &output, &input);
+    if (ZSTD_isError(ret)) {
+      return errors::DataLoss("zstd decompression failed: ",
+                              ZSTD_getErrorName(ret));
+    }
+    result->append(chunk.data(), output.pos);
+    if (ret == 0) {
+      break;
+    }
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::Decompress() {
+  if (thread_pool_) {
+    // Split complete frames off the front of the compressed buffer, reading
+    // more input as needed, until a batch is assembled or the input ends.
+    std::vector<std::pair<size_t, size_t>> frames;  // (offset, size) pairs
+    while (frames.size() <
+           static_cast<size_t>(zstd_options_.num_parallel_decodes)) {
+      const size_t avail = compressed_.size() - compressed_pos_;
+      if (avail == 0) {
+        if (input_eof_) break;
+        TF_RETURN_IF_ERROR(FillCompressed());
+        continue;
+      }
+      const size_t frame_size = ZSTD_findFrameCompressedSize(
+          compressed_.data() + compressed_pos_, avail);
+      if (ZSTD_isError(frame_size)) {
+        // Either the frame isn't completely buffered yet or the data is
+        // corrupt; more input disambiguates the two.
+        if (!input_eof_) {
+          if (frames.empty() && avail >= kMaxFrameProbeBytes) {
+            // No frame boundary within the probe budget: this input can't be
+            // decoded frame-parallel with bounded memory. Switch to the
+            // streaming decoder for the rest of the stream.
+            thread_pool_.reset();
+            break;
+          }
+          TF_RETURN_IF_ERROR(FillCompressed());
+          continue;
+        }
+        if (!frames.empty()) {
+          // Decode what we have; the error resurfaces on the next call.
+          break;
+        }
+        return errors::DataLoss("truncated or corrupt zstd frame: ",
+                                ZSTD_getErrorName(frame_size));
+      }
+      frames.emplace_back(compressed_pos_, frame_size);
+      compressed_pos_ += frame_size;
+    }
+
+    if (thread_pool_) {
+      if (frames.empty()) {
+        return Status::OK();  // Clean EOF.
+      }
+
+      std::vector<string> outputs(frames.size());
+      std::vector<Status> statuses(frames.size());
+      if (frames.size() == 1) {
+        statuses[0] = DecompressFrame(compressed_.data() + frames[0].first,
+                                      frames[0].second, &outputs[0]);
+      } else {
+        BlockingCounter counter(frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+          thread_pool_->Schedule([this, &frames, &outputs, &statuses, &counter,
+                                  i]() {
+            statuses[i] = DecompressFrame(compressed_.data() + frames[i].first,
+                                          frames[i].second, &outputs[i]);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
+      }
+
+      for (size_t i = 0; i < frames.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        if (!outputs[i].empty()) {
+          decompressed_.push_back(std::move(outputs[i]));
+        }
+      }
+
+      compressed_.erase(0, compressed_pos_);
+      compressed_pos_ = 0;
+      return Status::OK();
+    }
+    // Fell through to the streaming decoder below.
+  }
+
+  if (!stream_state_) {
+    stream_state_.reset(new StreamState());
+  }
+
+  // Produce at least one decompressed chunk, or hit clean EOF.
+  while (decompressed_.empty()) {
+    if (compressed_pos_ >= compressed_.size()) {
+      compressed_.clear();
+      compressed_pos_ = 0;
+      if (input_eof_) {
+        return Status::OK();  // Clean EOF.
+      }
+      TF_RETURN_IF_ERROR(FillCompressed());
+      continue;
+    }
+
+    ZSTD_inBuffer input = {compressed_.data() + compressed_pos_,
+                           compressed_.size() - compressed_pos_, 0};
+    string chunk;
+    chunk.resize(ZSTD_DStreamOutSize());
+    ZSTD_outBuffer output = {&chunk[0], chunk.size(), 0};
+
+    const size_t ret =
+        ZSTD_decompressStream(stream_state_->dstream, &output, &input);
+    if (ZSTD_isError(ret)) {
+      return errors::DataLoss("zstd decompression failed: ",
+                              ZSTD_getErrorName(ret));
+    }
+    compressed_pos_ += input.pos;
+
+    if (output.pos > 0) {
+      chunk.resize(output.pos);
+      decompressed_.push_back(std::move(chunk));
+    } else if (ret != 0 && input_eof_ &&
+               compressed_pos_ >= compressed_.size()) {
+      return errors::DataLoss("truncated zstd stream");
+    }
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+
+  while (static_cast<int64>(result->size()) < bytes_to_read) {
+    if (decompressed_.empty()) {
+      TF_RETURN_IF_ERROR(Decompress());
+      if (decompressed_.empty()) {
+        return errors::OutOfRange("EOF reached");
+      }
+    }
+
+    const string& front = decompressed_.front();
+    const size_t take =
+        std::min<size_t>(front.size() - front_pos_,
+                         bytes_to_read - static_cast<int64>(result->size()));
+    result->append(front, front_pos_, take);
+    front_pos_ += take;
+    bytes_read_ += take;
+    if (front_pos_ == front.size()) {
+      decompressed_.pop_front();
+      front_pos_ = 0;
+    }
+  }
+  return Status::OK();
+}
+
+int64 ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tensorflow
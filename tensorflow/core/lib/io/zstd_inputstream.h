@@ -0,0 +1,119 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// A ZstdInputStream provides support for reading a stream compressed with
+// zstd (https://facebook.github.io/zstd/). The input may consist of any
+// number of concatenated zstd frames.
+//
+// When `num_parallel_decodes` is greater than 1 and the input contains
+// multiple frames, complete frames are split apart and decompressed
+// concurrently on a thread pool, in batches, with the decompressed bytes
+// delivered in stream order. Frames are the unit of parallelism: files
+// written by ZstdOutputBuffer close a frame every `frame_size_bytes`
+// uncompressed bytes precisely so that readers can take advantage of this.
+//
+// A given instance of a ZstdInputStream is NOT safe for concurrent use
+// by multiple threads.
+class ZstdInputStream : public InputStreamInterface {
+ public:
+  // Creates a ZstdInputStream for `input_stream`, reading compressed bytes
+  // `input_buffer_bytes` at a time.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZstdInputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                  const ZstdCompressionOptions& zstd_options,
+                  bool owns_input_stream);
+
+  ~ZstdInputStream();
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the input is not valid zstd data.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Reads more compressed bytes from `input_stream_` into `compressed_`.
+  // Sets `input_eof_` once the wrapped stream is exhausted.
+  Status FillCompressed();
+
+  // Decompresses more of `compressed_` into `decompressed_`, either by
+  // splitting off complete frames and decoding a batch of them in parallel,
+  // or by running the streaming decoder when parallelism is off.
+  Status Decompress();
+
+  // Decompresses exactly one complete frame of `size` bytes at `data`.
+  static Status DecompressFrame(const char* data, size_t size, string* result);
+
+  const bool owns_input_stream_;
+  InputStreamInterface* input_stream_;
+  const size_t input_buffer_capacity_;
+  ZstdCompressionOptions const zstd_options_;
+
+  // Pool used for parallel frame decodes; null when num_parallel_decodes <= 1.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  // Compressed bytes read from `input_stream_` but not yet decoded.
+  // compressed_pos_ is the offset of the first undecoded byte.
+  string compressed_;
+  size_t compressed_pos_ = 0;
+  bool input_eof_ = false;
+
+  // Decompressed bytes not yet returned to the caller, in stream order.
+  // front_pos_ is the caller's offset into the front chunk.
+  std::deque<string> decompressed_;
+  size_t front_pos_ = 0;
+
+  // Streaming decoder state, used when parallel decode is off. Kept behind a
+  // forward declaration so zstd.h stays out of this header.
+  struct StreamState;
+  std::unique_ptr<StreamState> stream_state_;
+
+  // Number of *uncompressed* bytes that have been read from this stream.
+  int64 bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_INPUTSTREAM_H_
@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd_outputbuffer.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+struct ZstdOutputBuffer::CompressionState {
+  ZSTD_CCtx* cctx = nullptr;
+
+  CompressionState() { cctx = ZSTD_createCCtx(); }
+  ~CompressionState() {
+    if (cctx) ZSTD_freeCCtx(cctx);
+  }
+};
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   const ZstdCompressionOptions& options)
+    : file_(file), options_(options) {}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (file_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  state_.reset(new CompressionState());
+  if (state_->cctx == nullptr) {
+    return errors::Internal("Failed to create zstd compression context");
+  }
+  input_buffer_.reserve(options_.frame_size_bytes);
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::CompressBufferedInput() {
+  if (input_buffer_.empty()) {
+    return Status::OK();
+  }
+
+  output_buffer_.resize(ZSTD_compressBound(input_buffer_.size()));
+  // ZSTD_compressCCtx writes one complete frame whose header records the
+  // content size; that is what lets readers allocate output up front and
+  // decode frames in parallel.
+  const size_t compressed_size = ZSTD_compressCCtx(
+      state_->cctx, &output_buffer_[0], output_buffer_.size(),
+      input_buffer_.data(), input_buffer_.size(), options_.compression_level);
+  if (ZSTD_isError(compressed_size)) {
+    return errors::DataLoss("zstd compression failed: ",
+                            ZSTD_getErrorName(compressed_size));
+  }
+
+  TF_RETURN_IF_ERROR(
+      file_->Append(StringPiece(output_buffer_.data(), compressed_size)));
+  input_buffer_.clear();
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Writer not initialized or previously closed");
+  }
+  while (!data.empty()) {
+    const size_t space = options_.frame_size_bytes - input_buffer_.size();
+    const size_t take = std::min<size_t>(space, data.size());
+    input_buffer_.append(data.data(), take);
+    data.remove_prefix(take);
+    if (input_buffer_.size() ==
+        static_cast<size_t>(options_.frame_size_bytes)) {
+      TF_RETURN_IF_ERROR(CompressBufferedInput());
+    }
+  }
+  return Status::OK();
+}
+
+#if defined(PLATFORM_GOOGLE)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(StringPiece(fragment)));
+  }
+  return Status::OK();
+}
+#endif
+
+Status ZstdOutputBuffer::Flush() {
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Writer not initialized or previously closed");
+  }
+  TF_RETURN_IF_ERROR(CompressBufferedInput());
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (file_ == nullptr) {
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(CompressBufferedInput());
+  state_.reset();
+  file_ = nullptr;
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Writer not initialized or previously closed");
+  }
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Tell(int64* position) {
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Writer not initialized or previously closed");
+  }
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+Portions Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_OUTPUTBUFFER_H_
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/zstd_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Provides support for writing zstd-compressed output to file
+// (https://facebook.github.io/zstd/).
+//
+// Input is buffered and emitted as a sequence of independent zstd frames, one
+// per `frame_size_bytes` of uncompressed data (plus a final short frame at
+// Flush/Close). Each frame header records the decompressed size, so readers
+// can split the file at frame boundaries and decompress the frames in
+// parallel (see ZstdInputStream). The output is standard multi-frame zstd and
+// decodable by any conforming decoder.
+//
+// A given instance of a ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Creates a ZstdOutputBuffer that compresses to `file`. Does not take
+  // ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, const ZstdCompressionOptions& options);
+
+  ~ZstdOutputBuffer();
+
+  // Initializes the compression context. This call is required before any
+  // other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the compression pipeline. The data is buffered and
+  // compressed one frame at a time; call `Flush()` to force out a partial
+  // frame.
+  Status Append(StringPiece data) override;
+
+#if defined(PLATFORM_GOOGLE)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any buffered input as a (short) frame and writes all output to
+  // file. Frequent flushing shortens frames and costs compression ratio.
+  Status Flush() override;
+
+  // Compresses any buffered input and writes all output to file. No stream
+  // epilogue is needed — every frame is self-contained.
+  //
+  // After calling this, any further calls to `Append()`, `Flush()` or
+  // `Close()` will fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses any buffered input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Compresses the buffered input as one frame and appends it to `file_`.
+  // No-op when the buffer is empty.
+  Status CompressBufferedInput();
+
+  WritableFile* file_;  // Not owned
+  ZstdCompressionOptions const options_;
+
+  // Uncompressed bytes belonging to the frame currently being accumulated.
+  string input_buffer_;
+
+  // Scratch space for one compressed frame.
+  string output_buffer_;
+
+  // Compression context, reused across frames. Kept behind a forward
+  // declaration so zstd.h stays out of this header.
+  struct CompressionState;
+  std::unique_ptr<CompressionState> state_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_OUTPUTBUFFER_H_
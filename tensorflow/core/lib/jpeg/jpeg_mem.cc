@@ -91,7 +91,7 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   // unpack the argball
   const int datasize = argball->datasize_;
   const auto& flags = argball->flags_;
-  const int ratio = flags.ratio;
+  int ratio = flags.ratio;
   int components = flags.components;
   int stride = flags.stride;              // may be 0
   int64* const nwarn = argball->pnwarn_;  // may be NULL
@@ -158,6 +158,24 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
       jpeg_destroy_decompress(&cinfo);
       return nullptr;
   }
+  // With a target size and no explicit ratio, pick the deepest libjpeg
+  // downscale whose output still covers the target, so the IDCT skips the
+  // pixels a following resize would throw away.
+  if (ratio == 1 && (flags.target_height > 0 || flags.target_width > 0)) {
+    while (ratio < 8) {
+      const int next_ratio = ratio * 2;
+      const int scaled_height =
+          (static_cast<int>(cinfo.image_height) + next_ratio - 1) / next_ratio;
+      const int scaled_width =
+          (static_cast<int>(cinfo.image_width) + next_ratio - 1) / next_ratio;
+      if ((flags.target_height > 0 && scaled_height < flags.target_height) ||
+          (flags.target_width > 0 && scaled_width < flags.target_width)) {
+        break;
+      }
+      ratio = next_ratio;
+    }
+  }
+
   cinfo.do_fancy_upsampling = boolean(flags.fancy_upscaling);
   cinfo.scale_num = 1;
   cinfo.scale_denom = ratio;
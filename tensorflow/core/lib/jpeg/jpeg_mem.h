@@ -38,6 +38,15 @@ struct UncompressFlags {
   // size in both directions).
   int ratio = 1;
 
+  // If positive and ratio == 1, the decoder picks the largest ratio in
+  // {8, 4, 2, 1} whose scaled output still covers this many pixels in the
+  // corresponding dimension. libjpeg then skips the discarded DCT
+  // coefficients during decode, so a following resize down to the target
+  // size only pays for the pixels it keeps. Either dimension may be left 0
+  // to constrain only the other.
+  int target_height = 0;
+  int target_width = 0;
+
   // The number of bytes per pixel (1, 3 or 4), or 0 for autodetect.
   int components = 0;
 
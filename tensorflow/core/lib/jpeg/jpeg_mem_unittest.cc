@@ -96,6 +96,41 @@ TEST(JpegMemTest, Jpeg) {
   TestJPEG(env, data_path + "jpeg_merge_test1_cmyk.jpg");
 }
 
+TEST(JpegMemTest, JpegTargetSize) {
+  Env* env = Env::Default();
+  string jpeg;
+  ReadFileToStringOrDie(env, string(kTestData) + "jpeg_merge_test1.jpg",
+                        &jpeg);
+  const int fsize = jpeg.size();
+  const uint8* const temp = bit_cast<const uint8*>(jpeg.data());
+
+  // Decode at full size to learn the image dimensions.
+  int w, h, c;
+  std::unique_ptr<uint8[]> imgdata;
+  UncompressFlags flags;
+  flags.components = 3;
+  imgdata.reset(Uncompress(temp, fsize, flags, &w, &h, &c, nullptr));
+  CHECK(imgdata != nullptr);
+
+  // A target of a quarter of the image must select ratio 4 (ratio 8 would
+  // undershoot it).
+  int w4, h4, c4;
+  flags.target_height = (h + 3) / 4;
+  flags.target_width = (w + 3) / 4;
+  imgdata.reset(Uncompress(temp, fsize, flags, &w4, &h4, &c4, nullptr));
+  CHECK(imgdata != nullptr);
+  CHECK_EQ(h4, (h + 3) / 4);
+  CHECK_EQ(w4, (w + 3) / 4);
+
+  // An explicit ratio wins over the target size.
+  int w2, h2, c2;
+  flags.ratio = 2;
+  imgdata.reset(Uncompress(temp, fsize, flags, &w2, &h2, &c2, nullptr));
+  CHECK(imgdata != nullptr);
+  CHECK_EQ(h2, (h + 1) / 2);
+  CHECK_EQ(w2, (w + 1) / 2);
+}
+
 void TestCropAndDecodeJpeg(Env* env, const string& jpegfile,
                            const UncompressFlags& default_flags) {
   // Read the data from the jpeg file into memory
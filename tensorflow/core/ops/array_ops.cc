@@ -1459,6 +1459,47 @@ REGISTER_OP("GatherV2")
       return Status::OK();
     });
 
+REGISTER_OP("_DmlFusedGatherConcat")
+    .Input("params: N * T")
+    .Input("indices: N * Tindices")
+    .Output("output: T")
+    .Attr("N: int >= 2")
+    .Attr("T: {half, float}")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      int64 n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+
+      // All indices tensors must agree on shape; the output is that shape
+      // with the summed embedding widths appended.
+      ShapeHandle indices_shape = c->UnknownShape();
+      for (int64 i = n; i < 2 * n; ++i) {
+        TF_RETURN_IF_ERROR(
+            c->Merge(indices_shape, c->input(i), &indices_shape));
+      }
+
+      DimensionHandle total_width = c->MakeDim(0);
+      for (int64 i = 0; i < n; ++i) {
+        ShapeHandle params_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, &params_shape));
+        TF_RETURN_IF_ERROR(
+            c->Add(total_width, c->Dim(params_shape, 1), &total_width));
+      }
+
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(indices_shape, c->Vector(total_width), &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Gathers rows from N 2-D embedding tables and concatenates the results along
+the last axis, equivalent to ConcatV2 applied to N axis-0 GatherV2 lookups.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("GatherNd")
     .Input("params: Tparams")
@@ -644,6 +644,18 @@ REGISTER_OP("IteratorGetNextSync")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn(IteratorGetNextShapeFn);
 
+// Returns `N` elements in one invocation, amortizing per-op dispatch overhead
+// over `N` steps. `output_types` and `output_shapes` describe the flattened
+// components of all `N` elements, i.e. they repeat the element structure `N`
+// times.
+REGISTER_OP("IteratorGetNextN")
+    .Input("iterator: resource")
+    .Output("components: output_types")
+    .Attr("N: int >= 1")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(IteratorGetNextShapeFn);
+
 // TODO(b/124308596): Instead of conservatively marking this op as stateful,
 // implement a mechanism to determine whether `dataset` has a side-effect
 // and use it to decide whether to use a stateless or stateful version of this
@@ -267,6 +267,28 @@ REGISTER_OP("ResizeBilinear")
     .Attr("half_pixel_centers: bool = false")
     .SetShapeFn(ResizeShapeFn);
 
+// --------------------------------------------------------------------------
+REGISTER_OP("_DmlFusedResizeNormalize")
+    .Input("images: T")
+    .Input("size: int32")
+    .Input("shift: out_type")
+    .Input("scale: out_type")
+    .Output("output: out_type")
+    .Attr("T: {int8, uint8, int16, uint16, int32, int64, half, float}")
+    .Attr("out_type: {half, float} = DT_FLOAT")
+    .Attr("align_corners: bool = false")
+    .Attr("half_pixel_centers: bool = false")
+    .SetShapeFn(ResizeShapeFn)
+    .Doc(R"doc(
+Resizes `images` with bilinear interpolation and applies an affine
+normalization, equivalent to `(Cast(ResizeBilinear(images, size)) - shift) *
+scale`. `shift` and `scale` must be scalars or vectors that broadcast over the
+channel dimension.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("ScaleAndTranslate")
     .Input("images: T")
@@ -415,6 +437,8 @@ REGISTER_OP("DecodeJpeg")
     .Attr("try_recover_truncated: bool = false")
     .Attr("acceptable_fraction: float = 1.0")
     .Attr("dct_method: string = ''")
+    .Attr("target_height: int = 0")
+    .Attr("target_width: int = 0")
     .Output("image: uint8")
     .SetShapeFn(DecodeImageShapeFn);
 
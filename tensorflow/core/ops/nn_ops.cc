@@ -246,6 +246,22 @@ REGISTER_OP("_FusedBatchNormEx")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_DmlFusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {half, float}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Layer normalization over the last dimension of `x`, fused from the
+decomposed mean/variance/normalize subgraph by grappler.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("FusedBatchNormGrad")
     .Input("y_backprop: T")
     .Input("x: T")
@@ -387,7 +403,7 @@ REGISTER_OP("_FusedConv2D")
     .Input("filter: T")
     .Input("args: num_args * T")
     .Output("output: T")
-    .Attr("T: {float, double}")
+    .Attr("T: {half, float, double}")
     .Attr("num_args: int >= 0")
     .Attr("strides: list(int)")
     .Attr(GetPaddingAttrStringWithExplicit())
@@ -21,6 +21,8 @@ limitations under the License.
 #include <io.h>
 #undef StrCat
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/posix/error.h"
@@ -97,17 +100,79 @@ SSIZE_T pread(HANDLE hfile, char* src, size_t num_bytes, uint64_t offset) {
   return result;
 }
 
+// Size of each overlapped readahead block, and the default number of blocks
+// kept in flight ahead of a sequential reader.
+constexpr size_t kReadaheadBlockBytes = 1 << 20;
+constexpr size_t kDefaultReadaheadSlots = 4;
+
+// Number of overlapped readahead blocks to keep in flight for sequential
+// reads, configurable with TF_WINDOWS_FILE_READAHEAD_SLOTS (0 disables
+// readahead). Read once; the value applies to all files opened afterwards.
+size_t ReadaheadSlotCount() {
+  static const size_t count = [] {
+    const char* value = getenv("TF_WINDOWS_FILE_READAHEAD_SLOTS");
+    if (value == nullptr) {
+      return kDefaultReadaheadSlots;
+    }
+    long parsed = strtol(value, nullptr, 10);
+    if (parsed < 0) {
+      return kDefaultReadaheadSlots;
+    }
+    return static_cast<size_t>(parsed);
+  }();
+  return count;
+}
+
 // read() based random-access
 class WindowsRandomAccessFile : public RandomAccessFile {
  private:
+  // One overlapped readahead request. The handle's FILE_FLAG_OVERLAPPED flag
+  // means ReadFile only starts the transfer; the kernel fills `buffer` while
+  // the caller is busy consuming earlier blocks.
+  struct ReadaheadSlot {
+    OVERLAPPED overlapped = {};
+    HANDLE event = NULL;
+    std::unique_ptr<char[]> buffer;
+    uint64 offset = 0;
+    DWORD bytes = 0;              // Valid bytes in `buffer` once completed.
+    DWORD error = ERROR_SUCCESS;  // ERROR_HANDLE_EOF counts as success.
+    bool in_flight = false;
+    bool valid = false;
+  };
+
   string filename_;
   HANDLE hfile_;
 
+  // Readahead state. Reads that arrive at `expected_offset_` extend the
+  // sequential streak; once a streak is established, subsequent reads are
+  // served through the readahead slots so the next blocks are already in
+  // flight. Random reads bypass this path (and its mutex) entirely.
+  mutable mutex mu_;
+  mutable std::vector<ReadaheadSlot> slots_ GUARDED_BY(mu_);
+  mutable uint64 expected_offset_ GUARDED_BY(mu_) = 0;
+  mutable int sequential_streak_ GUARDED_BY(mu_) = 0;
+
  public:
   WindowsRandomAccessFile(const string& fname, HANDLE hfile)
       : filename_(fname), hfile_(hfile) {}
   ~WindowsRandomAccessFile() override {
     if (hfile_ != NULL && hfile_ != INVALID_HANDLE_VALUE) {
+      // In-flight readahead requests reference the OVERLAPPED structures and
+      // buffers owned by the slots; cancel and drain them before the handle
+      // and slots go away.
+      mutex_lock l(mu_);
+      if (!slots_.empty()) {
+        ::CancelIoEx(hfile_, NULL);
+        for (ReadaheadSlot& slot : slots_) {
+          if (slot.in_flight) {
+            DWORD bytes = 0;
+            ::GetOverlappedResult(hfile_, &slot.overlapped, &bytes, TRUE);
+          }
+          if (slot.event != NULL) {
+            ::CloseHandle(slot.event);
+          }
+        }
+      }
       ::CloseHandle(hfile_);
     }
   }
@@ -119,6 +184,16 @@ class WindowsRandomAccessFile : public RandomAccessFile {
 
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
+    if (ReadaheadSlotCount() > 0) {
+      mutex_lock l(mu_);
+      bool sequential = (offset == expected_offset_);
+      sequential_streak_ = sequential ? sequential_streak_ + 1 : 0;
+      expected_offset_ = offset + n;
+      if (sequential_streak_ > 0) {
+        return ReadSequential(offset, n, result, scratch);
+      }
+    }
+
     Status s;
     char* dst = scratch;
     while (n > 0 && s.ok()) {
@@ -144,6 +219,184 @@ class WindowsRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+ private:
+  // Serves a sequential read from the readahead slots, issuing overlapped
+  // reads for the blocks that follow so they complete while the caller
+  // processes this one. Blocks are aligned to kReadaheadBlockBytes.
+  Status ReadSequential(uint64 offset, size_t n, StringPiece* result,
+                        char* scratch) const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (slots_.empty()) {
+      slots_.resize(ReadaheadSlotCount());
+    }
+    Status s;
+    char* dst = scratch;
+    while (n > 0 && s.ok()) {
+      uint64 block_start = offset - (offset % kReadaheadBlockBytes);
+      ReadaheadSlot* slot = FindSlot(block_start);
+      if (slot == nullptr) {
+        slot = AcquireSlot(block_start);
+        if (slot == nullptr || !IssueRead(slot, block_start)) {
+          s = IOErrorFromWindowsError("Failed to ReadFile: " + filename_,
+                                      ::GetLastError());
+          break;
+        }
+      }
+      if (slot->in_flight) {
+        WaitForSlot(slot);
+      }
+      if (slot->error != ERROR_SUCCESS) {
+        DWORD error = slot->error;
+        slot->valid = false;
+        s = IOErrorFromWindowsError("Failed to ReadFile: " + filename_, error);
+        break;
+      }
+      uint64 block_pos = offset - block_start;
+      if (block_pos >= slot->bytes) {
+        s = Status(error::OUT_OF_RANGE, "Read fewer bytes than requested");
+        break;
+      }
+      size_t available =
+          std::min(n, static_cast<size_t>(slot->bytes - block_pos));
+      memcpy(dst, slot->buffer.get() + block_pos, available);
+      offset += available;
+      dst += available;
+      n -= available;
+      // A short block means EOF; don't issue readahead past it.
+      if (slot->bytes == kReadaheadBlockBytes) {
+        TopUpReadahead(block_start + kReadaheadBlockBytes);
+      }
+    }
+    *result = StringPiece(scratch, dst - scratch);
+    return s;
+  }
+
+  ReadaheadSlot* FindSlot(uint64 block_start) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (ReadaheadSlot& slot : slots_) {
+      if ((slot.valid || slot.in_flight) && slot.offset == block_start) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns a slot that may be reused for `block_start`: preferably one that
+  // is idle, otherwise the one covering the oldest block. Never steals an
+  // in-flight slot without draining it first.
+  ReadaheadSlot* AcquireSlot(uint64 block_start) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ReadaheadSlot* candidate = nullptr;
+    for (ReadaheadSlot& slot : slots_) {
+      if (!slot.valid && !slot.in_flight) {
+        candidate = &slot;
+        break;
+      }
+      if (candidate == nullptr || slot.offset < candidate->offset) {
+        candidate = &slot;
+      }
+    }
+    if (candidate != nullptr && candidate->in_flight) {
+      WaitForSlot(candidate);
+    }
+    return candidate;
+  }
+
+  // Starts an overlapped read of one block into the slot. Returns false on a
+  // hard failure to issue the request (GetLastError() holds the cause).
+  bool IssueRead(ReadaheadSlot* slot, uint64 block_start) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (slot->event == NULL) {
+      slot->event = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+      if (slot->event == NULL) {
+        return false;
+      }
+    }
+    if (slot->buffer == nullptr) {
+      slot->buffer.reset(new char[kReadaheadBlockBytes]);
+    }
+    ::ResetEvent(slot->event);
+    slot->overlapped = {};
+    ULARGE_INTEGER offset_union;
+    offset_union.QuadPart = block_start;
+    slot->overlapped.Offset = offset_union.LowPart;
+    slot->overlapped.OffsetHigh = offset_union.HighPart;
+    slot->overlapped.hEvent = slot->event;
+    slot->offset = block_start;
+    slot->bytes = 0;
+    slot->error = ERROR_SUCCESS;
+    slot->valid = false;
+
+    DWORD bytes_read = 0;
+    BOOL read_result =
+        ::ReadFile(hfile_, slot->buffer.get(),
+                   static_cast<DWORD>(kReadaheadBlockBytes), &bytes_read,
+                   &slot->overlapped);
+    if (read_result == TRUE) {
+      // Completed synchronously (e.g. served from the system cache).
+      slot->bytes = bytes_read;
+      slot->valid = true;
+      return true;
+    }
+    DWORD last_error = ::GetLastError();
+    if (last_error == ERROR_IO_PENDING) {
+      slot->in_flight = true;
+      return true;
+    }
+    if (last_error == ERROR_HANDLE_EOF) {
+      // Reading at or past EOF; a zero-length valid block marks the end.
+      slot->valid = true;
+      return true;
+    }
+    return false;
+  }
+
+  // Blocks until the slot's overlapped read completes and records its result.
+  void WaitForSlot(ReadaheadSlot* slot) const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    DWORD bytes_read = 0;
+    BOOL overlapped_result =
+        ::GetOverlappedResult(hfile_, &slot->overlapped, &bytes_read, TRUE);
+    slot->in_flight = false;
+    slot->valid = true;
+    slot->bytes = bytes_read;
+    if (overlapped_result == FALSE) {
+      DWORD last_error = ::GetLastError();
+      // EOF yields a short (possibly empty) but successful block.
+      slot->error =
+          (last_error == ERROR_HANDLE_EOF) ? ERROR_SUCCESS : last_error;
+    }
+  }
+
+  // Issues overlapped reads for the blocks starting at `next_block` into any
+  // idle slots, leaving blocks that are already cached or in flight alone.
+  void TopUpReadahead(uint64 next_block) const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (size_t i = 0; i + 1 < slots_.size(); ++i) {
+      uint64 block_start = next_block + i * kReadaheadBlockBytes;
+      if (FindSlot(block_start) != nullptr) {
+        continue;
+      }
+      ReadaheadSlot* slot = nullptr;
+      for (ReadaheadSlot& candidate : slots_) {
+        if (!candidate.valid && !candidate.in_flight) {
+          slot = &candidate;
+          break;
+        }
+        // Blocks behind the reader have been consumed; reuse them.
+        if (!candidate.in_flight && candidate.offset < next_block) {
+          slot = &candidate;
+          break;
+        }
+      }
+      if (slot == nullptr) {
+        break;  // All slots hold useful blocks or are in flight.
+      }
+      if (!IssueRead(slot, block_start)) {
+        // Readahead is best-effort; the failure resurfaces on the blocking
+        // path if the block is actually needed.
+        break;
+      }
+    }
+  }
 };
 
 class WindowsWritableFile : public WritableFile {
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/util/batch_util.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -291,6 +293,62 @@ Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
   }
 }
 
+template <typename T>
+Status HandleElementToPaddedSlice(const Tensor& element, Tensor* parent,
+                                  int index, const Tensor& padding,
+                                  bool contiguous_prefix) {
+  const int64 slice_elems = parent->NumElements() / parent->dim_size(0);
+  T* slice_data = parent->flat<T>().data() + index * slice_elems;
+  const T& pad_value = padding.scalar<T>()();
+  if (contiguous_prefix) {
+    const int64 n = element.NumElements();
+    if (n > slice_elems) {
+      return errors::Internal(
+          "HandleElementToPaddedSlice Cannot copy slice: element has ", n,
+          " entries but the parent slice has only ", slice_elems, ".");
+    }
+    std::copy_n(element.flat<T>().data(), n, slice_data);
+    std::fill(slice_data + n, slice_data + slice_elems, pad_value);
+    return Status::OK();
+  }
+  // The gap is not contiguous; fill the slice and copy the element over it.
+  std::fill(slice_data, slice_data + slice_elems, pad_value);
+  return CopyElementToLargerSlice(element, parent, index);
+}
+
+Status CopyElementToPaddedSlice(const Tensor& element, Tensor* parent,
+                                int index, const Tensor& padding) {
+  if (parent->dims() != element.dims() + 1) {
+    return errors::Internal(
+        "Mismatched ranks.  Element's rank is: ", element.dims(),
+        " but element is meant to be a slice in output Tensor having rank: ",
+        parent->dims(), " (should be: ", element.dims() + 1, ")");
+  }
+  // When only the leading dimension is padded, the element occupies a
+  // contiguous prefix of the slice and the gap is a contiguous suffix, so
+  // each can be written in a single pass.
+  bool contiguous_prefix = true;
+  for (int d = 1; d < element.dims(); ++d) {
+    if (element.dim_size(d) != parent->dim_size(d + 1)) {
+      contiguous_prefix = false;
+      break;
+    }
+  }
+#define HANDLE_TYPE(T)                                                        \
+  case DataTypeToEnum<T>::value: {                                            \
+    return HandleElementToPaddedSlice<T>(element, parent, index, padding,     \
+                                         contiguous_prefix);                  \
+  }
+
+  switch (element.dtype()) {
+    TF_CALL_DATASET_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      return errors::Unimplemented(
+          "CopyElementToPaddedSlice Unhandled data type: ", element.dtype());
+  }
+}
+
 Status SetElementZero(Tensor* element, const Tensor& padding) {
 #define HANDLE_TYPE(T)                                     \
   if (element->dtype() == DataTypeToEnum<T>::value) {      \
@@ -48,6 +48,14 @@ Status SetElementZero(Tensor* element, const Tensor& padding);
 Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
                                 int index);
 
+// Copies `element` into the index^th slice of `parent` (in the 0th
+// dimension) and assigns the scalar stored in `padding` to the positions of
+// the slice that the element does not cover. Unlike zero-initializing the
+// whole output with `SetElementZero` and then copying elements over it, only
+// the true padding gap is written in addition to the element itself.
+Status CopyElementToPaddedSlice(const Tensor& element, Tensor* parent,
+                                int index, const Tensor& padding);
+
 }  // namespace batch_util
 }  // namespace tensorflow
 
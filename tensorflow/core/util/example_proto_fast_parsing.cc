@@ -64,6 +64,42 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Decodes a packed run of varint-encoded int64 values in [ptr, end) and
+// appends them to `int64_list`. Decoding straight off the flat buffer avoids
+// the per-element CodedInputStream bookkeeping, and 64 bits of continuation
+// bits are tested at once so runs of single-byte varints - the common case
+// for id/label features - cost one branch per eight values. Returns false if
+// the run ends inside a varint or a varint exceeds ten bytes.
+template <typename Result>
+bool DecodePackedVarint64(const uint8* ptr, const uint8* end,
+                          Result* int64_list) {
+  while (ptr < end) {
+    if (end - ptr >= static_cast<ptrdiff_t>(sizeof(uint64))) {
+      uint64 word;
+      memcpy(&word, ptr, sizeof(uint64));
+      if ((word & 0x8080808080808080ULL) == 0) {
+        // Eight single-byte varints.
+        for (int i = 0; i < 8; ++i) {
+          int64_list->push_back(static_cast<int64>(ptr[i]));
+        }
+        ptr += 8;
+        continue;
+      }
+    }
+    uint64 result = 0;
+    int shift = 0;
+    uint8 byte;
+    do {
+      if (ptr == end || shift >= 64) return false;
+      byte = *ptr++;
+      result |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    int64_list->push_back(static_cast<int64>(result));
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -240,11 +276,18 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        // The stream aliases a flat buffer, so the packed run can be decoded
+        // directly from it (see DecodePackedVarint64) instead of going
+        // through the stream one varint at a time.
+        const void* buffer;
+        int size;
+        if (!stream.GetDirectBufferPointer(&buffer, &size)) return false;
+        if (static_cast<uint32>(size) < packed_length) return false;
+        const uint8* ptr = static_cast<const uint8*>(buffer);
+        if (!DecodePackedVarint64(ptr, ptr + packed_length, int64_list)) {
+          return false;
         }
+        stream.Skip(packed_length);
 
         stream.PopLimit(packed_limit);
       } else {  // non-packed
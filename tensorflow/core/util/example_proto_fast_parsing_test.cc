@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
@@ -170,6 +171,26 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64MixedVarintWidths) {
+  // Exercises the bulk varint decoder: long runs of single-byte varints
+  // (taken eight at a time), multi-byte varints, negative values (ten-byte
+  // varints), and a run length that is not a multiple of eight.
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  for (int i = 0; i < 20; ++i) {
+    int64_list->add_value(i % 2);
+  }
+  int64_list->add_value(1 << 20);
+  int64_list->add_value(std::numeric_limits<int64>::max());
+  int64_list->add_value(-1);
+  int64_list->add_value(std::numeric_limits<int64>::min());
+  for (int i = 0; i < 7; ++i) {
+    int64_list->add_value(127);
+  }
+  TestCorrectness(Serialize(example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
@@ -15,11 +15,33 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Dynamic self-scheduling is on by default. Set
+// TF_DYNAMIC_WORK_SHARDING=false to restore the fixed up-front
+// partitioning (Eigen ParallelFor / Sharder::Do).
+bool DynamicWorkShardingEnabled() {
+  static const bool enabled = [] {
+    bool enabled = true;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_DYNAMIC_WORK_SHARDING", true, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+}  // namespace
+
 /* ABSL_CONST_INIT */ thread_local int per_thread_max_parallism = 1000000;
 
 void SetPerThreadMaxParallelism(int max_parallelism) {
@@ -41,6 +63,13 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
     work(0, total);
     return;
   }
+  if (DynamicWorkShardingEnabled()) {
+    Sharder::DoDynamic(
+        total, cost_per_unit, work,
+        [&workers](Sharder::Closure c) { workers->Schedule(c); },
+        std::min(max_parallelism, workers->NumThreads()));
+    return;
+  }
   if (max_parallelism >= workers->NumThreads()) {
     workers->ParallelFor(total, cost_per_unit, work);
     return;
@@ -50,6 +79,40 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
               max_parallelism);
 }
 
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
+           ShardingCostModel* cost_model,
+           std::function<void(int64, int64)> work) {
+  DCHECK(cost_model != nullptr);
+  const int64 cost_per_unit = cost_model->cost_per_unit();
+  const uint64 start_nanos = Env::Default()->NowNanos();
+  Shard(max_parallelism, workers, total, cost_per_unit, std::move(work));
+  if (total > 0) {
+    const uint64 elapsed_nanos = Env::Default()->NowNanos() - start_nanos;
+    // The region ran on up to "parallelism" threads; scale wall time back
+    // up to a single-threaded-equivalent cost. This over-reports when the
+    // pool was not fully engaged, which the moving average absorbs.
+    const int parallelism =
+        std::max(1, std::min({max_parallelism, GetPerThreadMaxParallelism(),
+                              workers->NumThreads()}));
+    cost_model->Report(total, static_cast<int64>(elapsed_nanos) * parallelism);
+  }
+}
+
+void ShardingCostModel::Report(int64 total, int64 elapsed_nanos) {
+  if (total <= 0 || elapsed_nanos <= 0) {
+    return;
+  }
+  const int64 measured = std::max(int64{1}, elapsed_nanos / total);
+  const int64 old_cost = cost_per_unit_.load(std::memory_order_relaxed);
+  // Exponential moving average with weight 1/4 on the new sample; round
+  // increases up so a small estimate is not stuck below a slightly larger
+  // measurement. Concurrent reports may drop each other's updates; that
+  // only slows convergence.
+  const int64 diff = measured - old_cost;
+  const int64 step = diff > 0 ? (diff + 3) / 4 : diff / 4;
+  cost_per_unit_.store(old_cost + step, std::memory_order_relaxed);
+}
+
 // DEPRECATED: Prefer threadpool->TransformRangeConcurrently, which allows you
 // to directly specify the shard size.
 void Sharder::Do(int64 total, int64 cost_per_unit, const Work& work,
@@ -93,4 +156,56 @@ void Sharder::Do(int64 total, int64 cost_per_unit, const Work& work,
   counter.Wait();
 }
 
+void Sharder::DoDynamic(int64 total, int64 cost_per_unit, const Work& work,
+                        const Runner& runner, int max_parallelism) {
+  cost_per_unit = std::max(int64{1}, cost_per_unit);
+  // As in Do(), do not engage more threads than can be kept busy for at
+  // least kMinCostPerShard (~10us at 1ns per cost unit) each.
+  static const int64 kMinCostPerShard = 10000;
+  const int num_workers =
+      std::max<int>(1, std::min(static_cast<int64>(max_parallelism),
+                                total * cost_per_unit / kMinCostPerShard));
+  // The smallest chunk worth the atomic claim and scheduling overhead.
+  const int64 min_chunk_size =
+      std::max(int64{1}, kMinCostPerShard / cost_per_unit);
+  if (num_workers <= 1 || min_chunk_size >= total) {
+    work(0, total);
+    return;
+  }
+
+  // Threads repeatedly claim the next chunk of [0, total) from a shared
+  // counter. Each claim takes half of an even split of what appears to
+  // remain, so chunk sizes decay geometrically towards min_chunk_size:
+  // cheap prefixes are consumed in large chunks, while the tail is handed
+  // out finely to whichever threads are still free.
+  std::atomic<int64> next(0);
+  auto claim_loop = [&work, &next, total, min_chunk_size, num_workers]() {
+    for (;;) {
+      const int64 seen = next.load(std::memory_order_relaxed);
+      if (seen >= total) {
+        return;
+      }
+      // "seen" may be stale; that only perturbs the decay schedule.
+      const int64 chunk_size =
+          std::max(min_chunk_size, (total - seen) / (2 * num_workers));
+      const int64 start = next.fetch_add(chunk_size, std::memory_order_relaxed);
+      if (start >= total) {
+        return;
+      }
+      work(start, std::min(start + chunk_size, total));
+    }
+  };
+
+  BlockingCounter counter(num_workers - 1);
+  for (int i = 1; i < num_workers; ++i) {
+    runner([&claim_loop, &counter]() {
+      claim_loop();
+      counter.DecrementCount();
+    });
+  }
+  // The calling thread participates too.
+  claim_loop();
+  counter.Wait();
+}
+
 }  // end namespace tensorflow
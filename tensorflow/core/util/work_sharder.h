@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -57,6 +59,44 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work);
 
+// Self-tuning per-callsite cost estimate for Shard().
+//
+// A callsite whose per-unit cost is hard to guess statically (e.g. it
+// depends on input string lengths) can keep one of these objects alive
+// across invocations (typically as a function-local static) and use the
+// Shard() overload below. Each invocation is timed and the measurement is
+// folded into an exponential moving average, so the estimate converges to
+// the workload actually seen at that callsite.
+//
+// Thread-safe. Concurrent reports may drop updates, which only slows
+// convergence.
+class ShardingCostModel {
+ public:
+  // "initial_cost_per_unit" seeds the estimate and has the same meaning as
+  // Shard()'s cost_per_unit argument.
+  explicit ShardingCostModel(int64 initial_cost_per_unit)
+      : cost_per_unit_(std::max(int64{1}, initial_cost_per_unit)) {}
+
+  int64 cost_per_unit() const {
+    return cost_per_unit_.load(std::memory_order_relaxed);
+  }
+
+  // Records that "total" units of work took "elapsed_nanos" of
+  // single-threaded-equivalent time.
+  void Report(int64 total, int64 elapsed_nanos);
+
+ private:
+  std::atomic<int64> cost_per_unit_;
+};
+
+// Like Shard() above, but reads the per-unit cost estimate from
+// "cost_model" and reports the measured cost of this invocation back to it.
+//
+// REQUIRES: cost_model != nullptr
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
+           ShardingCostModel* cost_model,
+           std::function<void(int64, int64)> work);
+
 // Each thread has an associated option to express the desired maximum
 // parallelism. Its default is a very large quantity.
 //
@@ -94,6 +134,16 @@ class Sharder {
   // schedule a closure. Shard() uses thread::ThreadPool instead.
   static void Do(int64 total, int64 cost_per_unit, const Work& work,
                  const Runner& runner, int max_parallelism);
+
+  // Like Do(), but workers claim chunks of [0, total) dynamically from a
+  // shared counter instead of being assigned fixed blocks up front. Chunk
+  // sizes start at a fraction of the remaining range and decay
+  // geometrically, so threads that draw expensive units shed the tail of
+  // the range to idle threads. This keeps the pool busy when per-unit
+  // costs are skewed (variable-length strings, ragged rows), at the price
+  // of one atomic fetch-add per chunk.
+  static void DoDynamic(int64 total, int64 cost_per_unit, const Work& work,
+                        const Runner& runner, int max_parallelism);
 };
 
 }  // end namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <vector>
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/logging.h"
@@ -52,12 +54,14 @@ void RunSharding(int64 num_workers, int64 total, int64 cost_per_unit,
   EXPECT_EQ(num_done_work, total);
   if (std::min(num_workers, per_thread_max_parallelism) <
       threads->NumThreads()) {
-    // If the intention is to limit the parallelism explicitly, we'd
-    // better honor it. Ideally, even if per_thread_max_parallelism >
-    // num_workers, we should expect that Shard() implementation do
-    // not over-shard. Unfortunately, ThreadPoolDevice::parallelFor
-    // tends to over-shard.
-    EXPECT_LE(num_shards, 1 + per_thread_max_parallelism);
+    // Dynamic chunking deliberately creates more chunks than threads, but
+    // the decay schedule bounds the count: every claim takes at least
+    // 1/(2*p) of the remaining range (or the minimum chunk size), so
+    // O(p * log(total)) claims exhaust [0, total).
+    const int64 p = std::min(num_workers, per_thread_max_parallelism);
+    const double log_total =
+        std::log2(static_cast<double>(std::max(total, int64{2})));
+    EXPECT_LE(num_shards, 1 + 2 * p * (2 + log_total));
   }
 }
 
@@ -89,6 +93,58 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(ShardingCostModel, ConvergesTowardsReports) {
+  ShardingCostModel cost_model(10);
+  EXPECT_EQ(10, cost_model.cost_per_unit());
+  for (int i = 0; i < 100; ++i) {
+    cost_model.Report(100, 100 * 1000);  // 1000ns per unit.
+  }
+  EXPECT_GT(cost_model.cost_per_unit(), 900);
+  EXPECT_LE(cost_model.cost_per_unit(), 1000);
+  // Empty and non-positive measurements are ignored.
+  cost_model.Report(0, 1000);
+  cost_model.Report(100, 0);
+  EXPECT_GT(cost_model.cost_per_unit(), 900);
+}
+
+TEST(Shard, CostModelOverload) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  ShardingCostModel cost_model(1000);
+  const int64 total = 1 << 16;
+  std::atomic<int64> num_elements(0);
+  Shard(4, &threads, total, &cost_model,
+        [&num_elements](int64 start, int64 limit) {
+          num_elements += limit - start;
+        });
+  EXPECT_EQ(num_elements.load(), total);
+}
+
+TEST(Shard, DynamicChunkingSkewedCosts) {
+  // A workload where the last unit costs as much as all others combined
+  // must not leave the whole tail on one thread's plate: the chunks
+  // containing the tail should be small.
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  const int64 total = 1 << 20;
+  mutex mu;
+  int64 last_chunk_size = -1;
+  std::atomic<int64> num_elements(0);
+  Sharder::DoDynamic(total, 100,
+                     [&](int64 start, int64 limit) {
+                       num_elements += limit - start;
+                       if (limit == total) {
+                         mutex_lock l(mu);
+                         last_chunk_size = limit - start;
+                       }
+                     },
+                     [&threads](Sharder::Closure c) { threads.Schedule(c); },
+                     4);
+  EXPECT_EQ(num_elements.load(), total);
+  // With 4 workers the final claim covers at most
+  // max(min_chunk, total / (2 * 4)) units.
+  EXPECT_GE(last_chunk_size, 1);
+  EXPECT_LE(last_chunk_size, total / 8);
+}
+
 void BM_Sharding(int iters, int arg) {
   thread::ThreadPool threads(Env::Default(), "test", 16);
   const int64 total = 1LL << 30;
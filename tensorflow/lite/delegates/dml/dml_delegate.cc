@@ -0,0 +1,761 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// TFLite delegate backed by the DirectML runtime in
+// tensorflow/core/common_runtime/dml. Each delegated partition is lowered to
+// a single compiled DML operator graph via DirectMLX, executed through the
+// shared DmlExecutionContext with the same batching and submission machinery
+// the TF kernels use. Partition inputs are uploaded through the upload heap
+// (constants once, at prepare time), outputs are read back through the
+// readback heap, and Invoke blocks on the readback events to honor TFLite's
+// synchronous execution contract.
+//
+// The supported op set is the float32 elementwise family, which lowers
+// directly to DML expressions without layout conversion. Ops with weights and
+// layouts (convolutions, fully-connected) need an NHWC-to-DML lowering pass
+// and are left on the CPU for now; TFLite partitions around them.
+
+#include "tensorflow/lite/delegates/dml/dml_delegate.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/dml/dml_common.h"
+#include "tensorflow/core/common_runtime/dml/dml_device_cache.h"
+#include "tensorflow/core/common_runtime/dml/dml_device_state.h"
+#include "tensorflow/core/common_runtime/dml/dml_execution_context.h"
+#include "tensorflow/core/common_runtime/dml/dml_readback_heap.h"
+#include "tensorflow/core/common_runtime/dml/dml_upload_heap.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/lite/builtin_op_data.h"
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/c_api_internal.h"
+
+namespace tflite {
+namespace dml_delegate {
+
+using Microsoft::WRL::ComPtr;
+using tensorflow::DmlDeviceCache;
+using tensorflow::DmlDeviceState;
+using tensorflow::DmlGpuEvent;
+
+// DML buffer tensor descs are at most 4D here; TFLite tensors of lower rank
+// are padded with leading 1s.
+constexpr int kMaxRank = 4;
+
+struct DmlDelegateData {
+  TfLiteDmlDelegateOptions options;
+  const DmlDeviceState* state;
+  TfLiteDelegate delegate;
+};
+
+int64_t NumElements(const TfLiteTensor& tensor) {
+  int64_t count = 1;
+  for (int i = 0; i < tensor.dims->size; ++i) {
+    count *= tensor.dims->data[i];
+  }
+  return count;
+}
+
+bool IsTensorSupported(const TfLiteTensor& tensor) {
+  if (tensor.type != kTfLiteFloat32) {
+    return false;
+  }
+  if (tensor.dims == nullptr || tensor.dims->size > kMaxRank) {
+    return false;
+  }
+  // Dynamic tensors change shape at eval time; this delegate compiles shapes
+  // into the DML operator.
+  if (tensor.allocation_type == kTfLiteDynamic) {
+    return false;
+  }
+  for (int i = 0; i < tensor.dims->size; ++i) {
+    if (tensor.dims->data[i] < 0) {
+      return false;
+    }
+  }
+  const int64_t elements = NumElements(tensor);
+  return elements > 0 && elements <= UINT32_MAX;
+}
+
+bool IsActivationSupported(TfLiteFusedActivation activation) {
+  return activation == kTfLiteActNone || activation == kTfLiteActRelu ||
+         activation == kTfLiteActRelu6;
+}
+
+// Binary ops support identical shapes, or a scalar on either side
+// (broadcast with zero strides, the same way the TF DML kernels broadcast
+// scalar hyperparameters).
+bool AreBinaryShapesSupported(const TfLiteTensor& a, const TfLiteTensor& b) {
+  if (NumElements(a) == 1 || NumElements(b) == 1) {
+    return true;
+  }
+  return TfLiteIntArrayEqual(a.dims, b.dims);
+}
+
+bool IsNodeSupported(TfLiteContext* context, TfLiteNode* node,
+                     TfLiteRegistration* registration) {
+  for (int i = 0; i < node->inputs->size; ++i) {
+    if (!IsTensorSupported(context->tensors[node->inputs->data[i]])) {
+      return false;
+    }
+  }
+  for (int i = 0; i < node->outputs->size; ++i) {
+    if (!IsTensorSupported(context->tensors[node->outputs->data[i]])) {
+      return false;
+    }
+  }
+
+  auto binary_supported = [&](TfLiteFusedActivation activation) {
+    return node->inputs->size == 2 && IsActivationSupported(activation) &&
+           AreBinaryShapesSupported(context->tensors[node->inputs->data[0]],
+                                    context->tensors[node->inputs->data[1]]);
+  };
+
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinAdd:
+      return binary_supported(
+          static_cast<const TfLiteAddParams*>(node->builtin_data)->activation);
+    case kTfLiteBuiltinSub:
+      return binary_supported(
+          static_cast<const TfLiteSubParams*>(node->builtin_data)->activation);
+    case kTfLiteBuiltinMul:
+      return binary_supported(
+          static_cast<const TfLiteMulParams*>(node->builtin_data)->activation);
+    case kTfLiteBuiltinDiv:
+      return binary_supported(
+          static_cast<const TfLiteDivParams*>(node->builtin_data)->activation);
+    case kTfLiteBuiltinMaximum:
+    case kTfLiteBuiltinMinimum:
+      return binary_supported(kTfLiteActNone);
+    case kTfLiteBuiltinRelu:
+    case kTfLiteBuiltinRelu6:
+    case kTfLiteBuiltinLogistic:
+    case kTfLiteBuiltinTanh:
+    case kTfLiteBuiltinAbs:
+    case kTfLiteBuiltinSqrt:
+    case kTfLiteBuiltinRsqrt:
+    case kTfLiteBuiltinExp:
+    case kTfLiteBuiltinLog:
+      return node->inputs->size == 1;
+    default:
+      return false;
+  }
+}
+
+dml::TensorDesc::Dimensions DimensionsForTensor(const TfLiteTensor& tensor) {
+  dml::TensorDesc::Dimensions dims = {1, 1, 1, 1};
+  const int rank = tensor.dims->size;
+  for (int i = 0; i < rank; ++i) {
+    dims[kMaxRank - rank + i] = static_cast<uint32_t>(tensor.dims->data[i]);
+  }
+  return dims;
+}
+
+// One delegated partition: a compiled DML operator plus the GPU buffers and
+// binding state needed to execute it.
+class DmlDelegateKernel {
+ public:
+  explicit DmlDelegateKernel(DmlDelegateData* delegate_data)
+      : state_(delegate_data->state) {}
+
+  ~DmlDelegateKernel() {
+    // The execution context only borrows the compiled op, buffers and
+    // descriptor heaps; don't release them under an in-flight dispatch.
+    if (compiled_op_) {
+      state_->execution_context->GetCurrentCompletionEvent().WaitForSignal();
+    }
+  }
+
+  TfLiteStatus Init(TfLiteContext* context,
+                    const TfLiteDelegateParams* params) {
+    node_indices_.assign(
+        params->nodes_to_replace->data,
+        params->nodes_to_replace->data + params->nodes_to_replace->size);
+    input_indices_.assign(
+        params->input_tensors->data,
+        params->input_tensors->data + params->input_tensors->size);
+    output_indices_.assign(
+        params->output_tensors->data,
+        params->output_tensors->data + params->output_tensors->size);
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context) {
+    // Tensor shapes are compiled into the DML operator, so a resize requires
+    // recompiling; unchanged shapes reuse the compiled op as-is.
+    std::vector<std::vector<int>> shapes;
+    for (int tensor_index : input_indices_) {
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      shapes.emplace_back(tensor.dims->data,
+                          tensor.dims->data + tensor.dims->size);
+    }
+    if (compiled_op_ && shapes == prepared_shapes_) {
+      return kTfLiteOk;
+    }
+    if (compiled_op_) {
+      // Replacing buffers the GPU may still be reading requires the same
+      // caution as the destructor.
+      state_->execution_context->GetCurrentCompletionEvent().WaitForSignal();
+      buffers_.clear();
+      compiled_op_ = nullptr;
+    }
+
+    TF_LITE_ENSURE_STATUS(BuildAndCompile(context));
+    TF_LITE_ENSURE_STATUS(CreateBuffers(context));
+    TF_LITE_ENSURE_STATUS(InitializeAndBind(context));
+
+    prepared_shapes_ = std::move(shapes);
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Invoke(TfLiteContext* context) {
+    // Upload the partition's non-constant inputs. Constants were uploaded
+    // once at prepare time.
+    for (int tensor_index : input_indices_) {
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      if (tensor.allocation_type == kTfLiteMmapRo) {
+        continue;
+      }
+      TF_LITE_ENSURE_STATUS(UploadTensor(context, tensor_index));
+    }
+
+    // The binding table is fully bound at prepare time; each dispatch hands
+    // the execution context its own reference.
+    (void)state_->execution_context->ExecuteOperator(
+        compiled_op_.Get(), ComPtr<IDMLBindingTable>(exec_binding_table_),
+        exec_descriptor_heap_.Get());
+
+    // Read outputs back into the TFLite tensors. The flush kicks off the GPU
+    // before blocking; completion rides the readbacks' own events (see
+    // DMLDeviceContext::CopyDeviceTensorToCPU for why the flush event alone
+    // isn't sufficient with a dedicated copy queue).
+    std::vector<DmlGpuEvent> readback_events;
+    for (int tensor_index : output_indices_) {
+      TfLiteTensor& tensor = context->tensors[tensor_index];
+      auto dst = absl::Span<uint8_t>(
+          reinterpret_cast<uint8_t*>(tensor.data.raw), tensor.bytes);
+      auto event_or = state_->readback_heap->ReadbackFromGpu(
+          dst, buffers_.at(tensor_index).Get(), 0,
+          D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+      if (!event_or.ok()) {
+        context->ReportError(context, "TfLiteDmlDelegate: readback failed: %s",
+                             event_or.status().error_message().c_str());
+        return kTfLiteError;
+      }
+      readback_events.push_back(event_or.ConsumeValueOrDie());
+    }
+
+    auto flush_or = state_->execution_context->Flush();
+    if (!flush_or.ok()) {
+      context->ReportError(context, "TfLiteDmlDelegate: flush failed: %s",
+                           flush_or.status().error_message().c_str());
+      return kTfLiteError;
+    }
+
+    for (DmlGpuEvent& event : readback_events) {
+      event.WaitForSignal();
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  TfLiteStatus BuildAndCompile(TfLiteContext* context) {
+    dml::Graph scope(state_->dml_device.Get());
+
+    // Partition inputs become DML graph inputs, in the order TFLite lists
+    // them; that order also defines the input binding order.
+    std::map<int, dml::Expression> expressions;
+    uint32_t dml_input_index = 0;
+    for (int tensor_index : input_indices_) {
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      auto desc = dml::TensorDesc(DML_TENSOR_DATA_TYPE_FLOAT32,
+                                  DimensionsForTensor(tensor));
+      expressions.emplace(
+          tensor_index, dml::InputTensor(scope, dml_input_index++, desc));
+    }
+
+    for (int node_index : node_indices_) {
+      TfLiteNode* node = nullptr;
+      TfLiteRegistration* registration = nullptr;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, node_index, &node, &registration));
+
+      auto input = [&](int i) {
+        return expressions.at(node->inputs->data[i]);
+      };
+
+      dml::Expression result;
+      switch (registration->builtin_code) {
+        case kTfLiteBuiltinAdd:
+          result = ApplyActivation(
+              BroadcastBinary(input(0), input(1),
+                              [](dml::Expression a, dml::Expression b) {
+                                return a + b;
+                              }),
+              static_cast<const TfLiteAddParams*>(node->builtin_data)
+                  ->activation);
+          break;
+        case kTfLiteBuiltinSub:
+          result = ApplyActivation(
+              BroadcastBinary(input(0), input(1),
+                              [](dml::Expression a, dml::Expression b) {
+                                return a - b;
+                              }),
+              static_cast<const TfLiteSubParams*>(node->builtin_data)
+                  ->activation);
+          break;
+        case kTfLiteBuiltinMul:
+          result = ApplyActivation(
+              BroadcastBinary(input(0), input(1),
+                              [](dml::Expression a, dml::Expression b) {
+                                return a * b;
+                              }),
+              static_cast<const TfLiteMulParams*>(node->builtin_data)
+                  ->activation);
+          break;
+        case kTfLiteBuiltinDiv:
+          result = ApplyActivation(
+              BroadcastBinary(input(0), input(1),
+                              [](dml::Expression a, dml::Expression b) {
+                                return a / b;
+                              }),
+              static_cast<const TfLiteDivParams*>(node->builtin_data)
+                  ->activation);
+          break;
+        case kTfLiteBuiltinMaximum:
+          result = BroadcastBinary(input(0), input(1),
+                                   [](dml::Expression a, dml::Expression b) {
+                                     return dml::Max(a, b);
+                                   });
+          break;
+        case kTfLiteBuiltinMinimum:
+          result = BroadcastBinary(input(0), input(1),
+                                   [](dml::Expression a, dml::Expression b) {
+                                     return dml::Min(a, b);
+                                   });
+          break;
+        case kTfLiteBuiltinRelu:
+          result = dml::ActivationRelu(input(0));
+          break;
+        case kTfLiteBuiltinRelu6:
+          result = dml::Clip(input(0), 0.0f, 6.0f);
+          break;
+        case kTfLiteBuiltinLogistic:
+          result = dml::ActivationSigmoid(input(0));
+          break;
+        case kTfLiteBuiltinTanh:
+          result = dml::ActivationTanh(input(0));
+          break;
+        case kTfLiteBuiltinAbs:
+          result = dml::Abs(input(0));
+          break;
+        case kTfLiteBuiltinSqrt:
+          result = dml::Sqrt(input(0));
+          break;
+        case kTfLiteBuiltinRsqrt:
+          result = dml::Recip(dml::Sqrt(input(0)));
+          break;
+        case kTfLiteBuiltinExp:
+          result = dml::Exp(input(0));
+          break;
+        case kTfLiteBuiltinLog:
+          result = dml::Log(input(0));
+          break;
+        default:
+          context->ReportError(context,
+                               "TfLiteDmlDelegate: unexpected builtin %d",
+                               registration->builtin_code);
+          return kTfLiteError;
+      }
+
+      expressions[node->outputs->data[0]] = result;
+    }
+
+    std::vector<dml::Expression> outputs;
+    for (int tensor_index : output_indices_) {
+      outputs.push_back(expressions.at(tensor_index));
+    }
+
+    compiled_op_ = scope.Compile(DML_EXECUTION_FLAG_NONE, outputs);
+    return kTfLiteOk;
+  }
+
+  // Broadcasts the scalar side of a binary op to the other side's shape with
+  // zero strides, then applies `op`.
+  template <typename Op>
+  dml::Expression BroadcastBinary(dml::Expression a, dml::Expression b,
+                                  Op&& op) {
+    auto a_sizes = a.GetOutputDesc().sizes;
+    auto b_sizes = b.GetOutputDesc().sizes;
+    if (!std::equal(a_sizes.begin(), a_sizes.end(), b_sizes.begin())) {
+      dml::TensorDesc::Dimensions broadcast_strides = {0, 0, 0, 0};
+      if (IsScalar(a_sizes)) {
+        a = dml::Reinterpret(a, b_sizes, broadcast_strides);
+      } else {
+        b = dml::Reinterpret(b, a_sizes, broadcast_strides);
+      }
+    }
+    return op(a, b);
+  }
+
+  static bool IsScalar(const dml::TensorDesc::Dimensions& sizes) {
+    for (uint32_t size : sizes) {
+      if (size != 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static dml::Expression ApplyActivation(dml::Expression input,
+                                         TfLiteFusedActivation activation) {
+    switch (activation) {
+      case kTfLiteActRelu:
+        return dml::ActivationRelu(input);
+      case kTfLiteActRelu6:
+        return dml::Clip(input, 0.0f, 6.0f);
+      default:
+        return input;
+    }
+  }
+
+  TfLiteStatus CreateBuffers(TfLiteContext* context) {
+    auto create_buffer = [&](uint64_t size) -> ComPtr<ID3D12Resource> {
+      ComPtr<ID3D12Resource> buffer;
+      CD3DX12_HEAP_PROPERTIES heap_props(D3D12_HEAP_TYPE_DEFAULT);
+      CD3DX12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Buffer(
+          size, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+      if (FAILED(state_->d3d_device->CreateCommittedResource(
+              &heap_props, D3D12_HEAP_FLAG_NONE, &resource_desc,
+              D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+              IID_PPV_ARGS(&buffer)))) {
+        return nullptr;
+      }
+      return buffer;
+    };
+
+    auto create_tensor_buffer = [&](int tensor_index) -> TfLiteStatus {
+      if (buffers_.count(tensor_index) != 0) {
+        return kTfLiteOk;  // a tensor that is both an input and an output
+      }
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      ComPtr<ID3D12Resource> buffer = create_buffer(tensor.bytes);
+      if (!buffer) {
+        context->ReportError(
+            context, "TfLiteDmlDelegate: failed to allocate %zu device bytes",
+            tensor.bytes);
+        return kTfLiteError;
+      }
+      buffers_.emplace(tensor_index, std::move(buffer));
+      return kTfLiteOk;
+    };
+
+    for (int tensor_index : input_indices_) {
+      TF_LITE_ENSURE_STATUS(create_tensor_buffer(tensor_index));
+    }
+    for (int tensor_index : output_indices_) {
+      TF_LITE_ENSURE_STATUS(create_tensor_buffer(tensor_index));
+    }
+
+    DML_BINDING_PROPERTIES exec_props = compiled_op_->GetBindingProperties();
+    if (exec_props.TemporaryResourceSize > 0) {
+      temporary_buffer_ = create_buffer(exec_props.TemporaryResourceSize);
+      TF_LITE_ENSURE(context, temporary_buffer_ != nullptr);
+    }
+    if (exec_props.PersistentResourceSize > 0) {
+      persistent_buffer_ = create_buffer(exec_props.PersistentResourceSize);
+      TF_LITE_ENSURE(context, persistent_buffer_ != nullptr);
+    }
+
+    // Constant inputs never change between invokes, so their upload happens
+    // once here instead of per inference.
+    for (int tensor_index : input_indices_) {
+      if (context->tensors[tensor_index].allocation_type == kTfLiteMmapRo) {
+        TF_LITE_ENSURE_STATUS(UploadTensor(context, tensor_index));
+      }
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus InitializeAndBind(TfLiteContext* context) {
+    IDMLCompiledOperator* compiled_ops[] = {compiled_op_.Get()};
+    TF_LITE_ENSURE(
+        context, SUCCEEDED(state_->dml_device->CreateOperatorInitializer(
+                     1, compiled_ops, IID_PPV_ARGS(&initializer_))));
+
+    DML_BINDING_PROPERTIES init_props = initializer_->GetBindingProperties();
+    DML_BINDING_PROPERTIES exec_props = compiled_op_->GetBindingProperties();
+
+    if (init_props.TemporaryResourceSize >
+        (temporary_buffer_ ? temporary_buffer_->GetDesc().Width : 0)) {
+      CD3DX12_HEAP_PROPERTIES heap_props(D3D12_HEAP_TYPE_DEFAULT);
+      CD3DX12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Buffer(
+          init_props.TemporaryResourceSize,
+          D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+      TF_LITE_ENSURE(
+          context, SUCCEEDED(state_->d3d_device->CreateCommittedResource(
+                       &heap_props, D3D12_HEAP_FLAG_NONE, &resource_desc,
+                       D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+                       IID_PPV_ARGS(&temporary_buffer_))));
+    }
+
+    // Initialization and execution each get their own descriptor heap and
+    // binding table: the initialize dispatch is recorded asynchronously, so
+    // its descriptors must not be overwritten by the execute bindings.
+    auto create_binding_state =
+        [&](IDMLDispatchable* dispatchable, uint32_t descriptor_count,
+            ComPtr<ID3D12DescriptorHeap>* heap,
+            ComPtr<IDMLBindingTable>* table) -> TfLiteStatus {
+      descriptor_count = std::max(1u, descriptor_count);
+
+      D3D12_DESCRIPTOR_HEAP_DESC heap_desc = {};
+      heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+      heap_desc.NumDescriptors = descriptor_count;
+      heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+      TF_LITE_ENSURE(context,
+                     SUCCEEDED(state_->d3d_device->CreateDescriptorHeap(
+                         &heap_desc, IID_PPV_ARGS(&*heap))));
+
+      DML_BINDING_TABLE_DESC table_desc = {};
+      table_desc.Dispatchable = dispatchable;
+      table_desc.CPUDescriptorHandle =
+          (*heap)->GetCPUDescriptorHandleForHeapStart();
+      table_desc.GPUDescriptorHandle =
+          (*heap)->GetGPUDescriptorHandleForHeapStart();
+      table_desc.SizeInDescriptors = descriptor_count;
+      TF_LITE_ENSURE(context, SUCCEEDED(state_->dml_device->CreateBindingTable(
+                                  &table_desc, IID_PPV_ARGS(&*table))));
+      return kTfLiteOk;
+    };
+
+    ComPtr<ID3D12DescriptorHeap> init_heap;
+    ComPtr<IDMLBindingTable> init_table;
+    TF_LITE_ENSURE_STATUS(create_binding_state(initializer_.Get(),
+                                               init_props.RequiredDescriptorCount,
+                                               &init_heap, &init_table));
+
+    DML_BUFFER_BINDING temp_binding = {};
+    DML_BINDING_DESC temp_desc = {DML_BINDING_TYPE_BUFFER, &temp_binding};
+    if (init_props.TemporaryResourceSize > 0) {
+      temp_binding = {temporary_buffer_.Get(), 0,
+                      init_props.TemporaryResourceSize};
+      init_table->BindTemporaryResource(&temp_desc);
+    }
+
+    DML_BUFFER_BINDING persistent_binding = {};
+    DML_BINDING_DESC persistent_desc = {DML_BINDING_TYPE_BUFFER,
+                                        &persistent_binding};
+    if (exec_props.PersistentResourceSize > 0) {
+      // The initializer writes the persistent resource as its output.
+      persistent_binding = {persistent_buffer_.Get(), 0,
+                            exec_props.PersistentResourceSize};
+      init_table->BindOutputs(1, &persistent_desc);
+    }
+
+    (void)state_->execution_context->InitializeOperator(
+        initializer_.Get(), std::move(init_table), init_heap.Get());
+    init_descriptor_heap_ = std::move(init_heap);
+
+    TF_LITE_ENSURE_STATUS(create_binding_state(
+        compiled_op_.Get(), exec_props.RequiredDescriptorCount,
+        &exec_descriptor_heap_, &exec_binding_table_));
+
+    std::vector<DML_BUFFER_BINDING> input_buffer_bindings(
+        input_indices_.size());
+    std::vector<DML_BINDING_DESC> input_bindings(input_indices_.size());
+    for (size_t i = 0; i < input_indices_.size(); ++i) {
+      const TfLiteTensor& tensor = context->tensors[input_indices_[i]];
+      input_buffer_bindings[i] = {buffers_.at(input_indices_[i]).Get(), 0,
+                                  tensor.bytes};
+      input_bindings[i] = {DML_BINDING_TYPE_BUFFER, &input_buffer_bindings[i]};
+    }
+    exec_binding_table_->BindInputs(
+        static_cast<uint32_t>(input_bindings.size()), input_bindings.data());
+
+    std::vector<DML_BUFFER_BINDING> output_buffer_bindings(
+        output_indices_.size());
+    std::vector<DML_BINDING_DESC> output_bindings(output_indices_.size());
+    for (size_t i = 0; i < output_indices_.size(); ++i) {
+      const TfLiteTensor& tensor = context->tensors[output_indices_[i]];
+      output_buffer_bindings[i] = {buffers_.at(output_indices_[i]).Get(), 0,
+                                   tensor.bytes};
+      output_bindings[i] = {DML_BINDING_TYPE_BUFFER,
+                            &output_buffer_bindings[i]};
+    }
+    exec_binding_table_->BindOutputs(
+        static_cast<uint32_t>(output_bindings.size()), output_bindings.data());
+
+    if (exec_props.TemporaryResourceSize > 0) {
+      temp_binding = {temporary_buffer_.Get(), 0,
+                      exec_props.TemporaryResourceSize};
+      exec_binding_table_->BindTemporaryResource(&temp_desc);
+    }
+    if (exec_props.PersistentResourceSize > 0) {
+      exec_binding_table_->BindPersistentResource(&persistent_desc);
+    }
+
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus UploadTensor(TfLiteContext* context, int tensor_index) {
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    auto src = absl::Span<const uint8_t>(
+        reinterpret_cast<const uint8_t*>(tensor.data.raw), tensor.bytes);
+    auto event_or = state_->upload_heap->BeginUploadToGpu(
+        buffers_.at(tensor_index).Get(), 0,
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, src);
+    if (!event_or.ok()) {
+      context->ReportError(context, "TfLiteDmlDelegate: upload failed: %s",
+                           event_or.status().error_message().c_str());
+      return kTfLiteError;
+    }
+    // Uploads may ride the dedicated copy queue; order compute after them.
+    state_->execution_context->QueueDependency(event_or.ConsumeValueOrDie());
+    return kTfLiteOk;
+  }
+
+  const DmlDeviceState* state_;
+
+  std::vector<int> node_indices_;
+  std::vector<int> input_indices_;
+  std::vector<int> output_indices_;
+  std::vector<std::vector<int>> prepared_shapes_;
+
+  ComPtr<IDMLCompiledOperator> compiled_op_;
+  ComPtr<IDMLOperatorInitializer> initializer_;
+  std::map<int, ComPtr<ID3D12Resource>> buffers_;  // keyed by tensor index
+  ComPtr<ID3D12Resource> temporary_buffer_;
+  ComPtr<ID3D12Resource> persistent_buffer_;
+  ComPtr<ID3D12DescriptorHeap> init_descriptor_heap_;
+  ComPtr<ID3D12DescriptorHeap> exec_descriptor_heap_;
+  ComPtr<IDMLBindingTable> exec_binding_table_;
+};
+
+TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
+  const TfLiteRegistration kRegistration = {
+      // .init
+      [](TfLiteContext* context, const char* buffer, size_t) -> void* {
+        const auto* params =
+            reinterpret_cast<const TfLiteDelegateParams*>(buffer);
+        auto* delegate_data =
+            reinterpret_cast<DmlDelegateData*>(params->delegate->data_);
+        auto kernel = std::make_unique<DmlDelegateKernel>(delegate_data);
+        if (kernel->Init(context, params) != kTfLiteOk) {
+          return nullptr;
+        }
+        return kernel.release();
+      },
+      // .free
+      [](TfLiteContext*, void* buffer) -> void {
+        delete reinterpret_cast<DmlDelegateKernel*>(buffer);
+      },
+      // .prepare
+      [](TfLiteContext* context, TfLiteNode* node) -> TfLiteStatus {
+        if (node->user_data == nullptr) {
+          return kTfLiteError;
+        }
+        return reinterpret_cast<DmlDelegateKernel*>(node->user_data)
+            ->Prepare(context);
+      },
+      // .invoke
+      [](TfLiteContext* context, TfLiteNode* node) -> TfLiteStatus {
+        return reinterpret_cast<DmlDelegateKernel*>(node->user_data)
+            ->Invoke(context);
+      },
+      nullptr,              // .profiling_string
+      0,                    // .builtin_code
+      "TfLiteDmlDelegate",  // .custom_name
+      1,                    // .version
+  };
+
+  TfLiteIntArray* plan = nullptr;
+  TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+
+  std::vector<int> supported_nodes;
+  for (int i = 0; i < plan->size; ++i) {
+    const int node_index = plan->data[i];
+    TfLiteNode* node = nullptr;
+    TfLiteRegistration* registration = nullptr;
+    TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+        context, node_index, &node, &registration));
+    if (IsNodeSupported(context, node, registration)) {
+      supported_nodes.push_back(node_index);
+    }
+  }
+
+  TfLiteIntArray* ops_to_replace =
+      TfLiteIntArrayCreate(static_cast<int>(supported_nodes.size()));
+  for (size_t i = 0; i < supported_nodes.size(); ++i) {
+    ops_to_replace->data[i] = supported_nodes[i];
+  }
+  const TfLiteStatus status = context->ReplaceNodeSubsetsWithDelegateKernels(
+      context, kRegistration, ops_to_replace, delegate);
+  TfLiteIntArrayFree(ops_to_replace);
+  return status;
+}
+
+}  // namespace dml_delegate
+}  // namespace tflite
+
+TfLiteDmlDelegateOptions TfLiteDmlDelegateOptionsDefault() {
+  TfLiteDmlDelegateOptions options;
+  options.adapter_index = 0;
+  return options;
+}
+
+TfLiteDelegate* TfLiteDmlDelegateCreate(
+    const TfLiteDmlDelegateOptions* options) {
+  TfLiteDmlDelegateOptions resolved_options =
+      options != nullptr ? *options : TfLiteDmlDelegateOptionsDefault();
+
+  auto& device_cache = tensorflow::DmlDeviceCache::Instance();
+  if (resolved_options.adapter_index < 0 ||
+      static_cast<uint32_t>(resolved_options.adapter_index) >=
+          device_cache.GetAdapterCount()) {
+    return nullptr;
+  }
+
+  const auto& adapter =
+      device_cache.GetAdapter(resolved_options.adapter_index);
+  const tensorflow::DmlDeviceState* state =
+      device_cache.GetOrCreateDeviceState(resolved_options.adapter_index,
+                                          tensorflow::GPUOptions(),
+                                          adapter.QueryAvailableLocalMemory());
+
+  auto* delegate_data = new tflite::dml_delegate::DmlDelegateData();
+  delegate_data->options = resolved_options;
+  delegate_data->state = state;
+  delegate_data->delegate = {
+      reinterpret_cast<void*>(delegate_data),  // .data_
+      tflite::dml_delegate::DelegatePrepare,   // .Prepare
+      nullptr,                                 // .CopyFromBufferHandle
+      nullptr,                                 // .CopyToBufferHandle
+      nullptr,                                 // .FreeBufferHandle
+      kTfLiteDelegateFlagsNone,                // .flags
+  };
+  return &delegate_data->delegate;
+}
+
+void TfLiteDmlDelegateDelete(TfLiteDelegate* delegate) {
+  if (delegate == nullptr) {
+    return;
+  }
+  delete reinterpret_cast<tflite::dml_delegate::DmlDelegateData*>(
+      delegate->data_);
+}
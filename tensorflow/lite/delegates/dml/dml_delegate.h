@@ -0,0 +1,74 @@
+/* Copyright (c) Microsoft Corporation.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_DML_DML_DELEGATE_H_
+#define TENSORFLOW_LITE_DELEGATES_DML_DML_DELEGATE_H_
+
+#include <stdint.h>
+
+#include "tensorflow/lite/c/c_api_internal.h"
+
+#ifdef SWIG
+#define TFL_CAPI_EXPORT
+#else
+#if defined(_WIN32)
+#ifdef TFL_COMPILE_LIBRARY
+#define TFL_CAPI_EXPORT __declspec(dllexport)
+#else
+#define TFL_CAPI_EXPORT __declspec(dllimport)
+#endif  // TFL_COMPILE_LIBRARY
+#else
+#define TFL_CAPI_EXPORT __attribute__((visibility("default")))
+#endif  // _WIN32
+#endif  // SWIG
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A TFLite delegate that runs supported subgraphs on a DirectML device,
+// reusing the DirectML runtime from tensorflow/core/common_runtime/dml (the
+// device state, allocator, execution context and upload/readback heaps), so
+// TFLite models get GPU acceleration on any D3D12-capable adapter. Nodes the
+// delegate can't map stay on the CPU; TFLite partitions the graph around
+// them.
+//
+// Always use TfLiteDmlDelegateOptionsDefault() to create a new instance of
+// TfLiteDmlDelegateOptions, otherwise every newly added option may break
+// inference.
+struct TFL_CAPI_EXPORT TfLiteDmlDelegateOptions {
+  // Index of the DirectML adapter to run on, in the runtime's enumeration
+  // order (fastest adapter first, matching the DML_VISIBLE_DEVICES /
+  // TF device-ordinal numbering).
+  int32_t adapter_index;
+};
+
+TFL_CAPI_EXPORT TfLiteDmlDelegateOptions TfLiteDmlDelegateOptionsDefault();
+
+// Creates a new delegate instance that needs to be destroyed with
+// TfLiteDmlDelegateDelete when delegation is no longer used. Returns null if
+// the adapter index is out of range or no DirectML-capable adapter exists.
+// When `options` is null, the default options are used.
+TFL_CAPI_EXPORT TfLiteDelegate* TfLiteDmlDelegateCreate(
+    const TfLiteDmlDelegateOptions* options);
+
+// Destroys a delegate created with TfLiteDmlDelegateCreate.
+TFL_CAPI_EXPORT void TfLiteDmlDelegateDelete(TfLiteDelegate* delegate);
+
+#ifdef __cplusplus
+}
+#endif  // __cplusplus
+
+#endif  // TENSORFLOW_LITE_DELEGATES_DML_DML_DELEGATE_H_
@@ -234,6 +234,18 @@ port::StatusOr<void*> GetPixDsoHandle() {
 #endif
 }
 
+port::StatusOr<void*> GetPixGpuCapturerDsoHandle() {
+#if _WIN32
+  // Ships with the PIX application rather than the event runtime
+  // redistributable; resolves if the DLL was placed on the search path or
+  // injected into the process by an attached PIX.
+  return GetDsoHandle("WinPixGpuCapturer", "", GetModuleDirectory());
+#else
+  return port::Status(port::error::UNIMPLEMENTED,
+                      "PIX GPU captures are not supported in WSL");
+#endif
+}
+
 port::StatusOr<void*> GetKernel32DsoHandle() {
 #if _WIN32
   return GetDsoHandle("Kernel32", "");
@@ -330,6 +342,11 @@ port::StatusOr<void*> GetPixDsoHandle() {
   return *result;
 }
 
+port::StatusOr<void*> GetPixGpuCapturerDsoHandle() {
+  static auto result = new auto(DsoLoader::GetPixGpuCapturerDsoHandle());
+  return *result;
+}
+
 port::StatusOr<void*> GetKernel32DsoHandle() {
   static auto result = new auto(DsoLoader::GetKernel32DsoHandle());
   return *result;
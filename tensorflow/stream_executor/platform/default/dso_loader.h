@@ -54,6 +54,7 @@ port::StatusOr<void*> GetHipDsoHandle();
 port::StatusOr<void*> GetDirectMLDsoHandle();
 port::StatusOr<void*> GetDirectMLDebugDsoHandle();
 port::StatusOr<void*> GetPixDsoHandle();
+port::StatusOr<void*> GetPixGpuCapturerDsoHandle();
 port::StatusOr<void*> GetKernel32DsoHandle();
 
 // The following method tries to dlopen all necessary GPU libraries for the GPU
@@ -90,6 +91,7 @@ port::StatusOr<void*> GetHipDsoHandle();
 port::StatusOr<void*> GetDirectMLDsoHandle();
 port::StatusOr<void*> GetDirectMLDebugDsoHandle();
 port::StatusOr<void*> GetPixDsoHandle();
+port::StatusOr<void*> GetPixGpuCapturerDsoHandle();
 port::StatusOr<void*> GetKernel32DsoHandle();
 }  // namespace CachedDsoLoader
 
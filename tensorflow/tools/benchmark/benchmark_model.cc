@@ -26,16 +26,20 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/default_device.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/platform/logging.h"
@@ -244,11 +248,147 @@ void SleepSeconds(double sleep_seconds) {
 #endif
 }
 
+// A single row in the comparison table printed when a batch size sweep or an
+// adapter comparison is requested.
+struct SweepResult {
+  string device;
+  string description;
+  int batch_size;
+  int64 num_runs;
+  double avg_time_us;
+  double items_per_second;
+};
+
+// Returns the TF device names ("/device:DML:N") of every DML device on the
+// system, in device-ID order. Empty when this build has no DML device
+// registered or no adapter qualified.
+std::vector<string> ListDmlDevices() {
+  std::vector<string> dml_devices;
+  std::vector<string> physical_devices;
+  if (!DeviceFactory::ListAllPhysicalDevices(&physical_devices).ok()) {
+    return dml_devices;
+  }
+  const string prefix = "/physical_device:DML:";
+  for (const string& name : physical_devices) {
+    if (str_util::StartsWith(name, prefix)) {
+      dml_devices.push_back(
+          strings::StrCat("/device:DML:", name.substr(prefix.size())));
+    }
+  }
+  return dml_devices;
+}
+
+// Looks up the physical_device_desc of `device_name` (a short name such as
+// "/device:DML:0") in the session's device list, so the comparison table can
+// name the adapter behind each device.
+string GetDeviceDescription(Session* session, const string& device_name) {
+  if (device_name.empty()) {
+    return "";
+  }
+  std::vector<DeviceAttributes> devices;
+  if (session->ListDevices(&devices).ok()) {
+    for (const DeviceAttributes& device : devices) {
+      if (str_util::EndsWith(device.name(), device_name) &&
+          !device.physical_device_desc().empty()) {
+        return device.physical_device_desc();
+      }
+    }
+  }
+  return "";
+}
+
+// Returns a copy of `inputs` with the leading dimension of every input layer
+// replaced by `batch_size`.
+std::vector<InputLayerInfo> ApplyBatchSize(std::vector<InputLayerInfo> inputs,
+                                           int batch_size) {
+  for (InputLayerInfo& input : inputs) {
+    if (input.shape.dims() > 0) {
+      input.shape.set_dim(0, batch_size);
+    }
+    if (static_cast<int64>(input.initialization_values.size()) >
+        input.shape.num_elements()) {
+      LOG(WARNING) << "Dropping initialization values for input " << input.name
+                   << "; they don't fit a batch size of " << batch_size;
+      input.initialization_values.clear();
+    }
+  }
+  return inputs;
+}
+
+// Times the graph once per entry in `batch_sizes` (or once with the original
+// shapes when the sweep is empty) and appends one row per timing to
+// `results`.
+Status BenchmarkDevice(const string& device, const string& description,
+                       const std::vector<int>& batch_sizes,
+                       double sleep_seconds, int num_runs, double max_time_s,
+                       const std::vector<InputLayerInfo>& inputs,
+                       const std::vector<string>& outputs,
+                       const std::vector<string>& targets, Session* session,
+                       std::vector<SweepResult>* results) {
+  std::vector<int> sweep = batch_sizes;
+  if (sweep.empty()) {
+    sweep.push_back(inputs.empty() || inputs[0].shape.dims() == 0
+                        ? 1
+                        : static_cast<int>(inputs[0].shape.dim_size(0)));
+  }
+
+  for (int batch_size : sweep) {
+    std::vector<InputLayerInfo> batch_inputs =
+        batch_sizes.empty() ? inputs : ApplyBatchSize(inputs, batch_size);
+
+    int64 total_time_us = 0;
+    int64 actual_num_runs = 0;
+    TF_RETURN_IF_ERROR(TimeMultipleRuns(
+        sleep_seconds, num_runs, max_time_s, batch_inputs, outputs, targets,
+        session, nullptr, &total_time_us, &actual_num_runs));
+
+    SweepResult result;
+    result.device = device;
+    result.description = description;
+    result.batch_size = batch_size;
+    result.num_runs = actual_num_runs;
+    result.avg_time_us = actual_num_runs > 0
+                             ? total_time_us /
+                                   static_cast<double>(actual_num_runs)
+                             : 0.0;
+    result.items_per_second =
+        total_time_us > 0
+            ? batch_size * actual_num_runs / (total_time_us / 1000000.0)
+            : 0.0;
+    results->push_back(result);
+  }
+
+  return Status::OK();
+}
+
+// Prints the rows gathered by BenchmarkDevice as a fixed-width table.
+void PrintComparisonTable(const std::vector<SweepResult>& results) {
+  LOG(INFO) << "Benchmark comparison:";
+  LOG(INFO) << strings::Printf("%-18s %-40s %8s %8s %14s %12s", "Device",
+                               "Adapter", "Batch", "Runs", "Avg time (us)",
+                               "Items/sec");
+  for (const SweepResult& result : results) {
+    LOG(INFO) << strings::Printf(
+        "%-18s %-40.40s %8d %8lld %14.1f %12.1f", result.device.c_str(),
+        result.description.c_str(), result.batch_size,
+        static_cast<long long>(result.num_runs), result.avg_time_us,
+        result.items_per_second);
+  }
+}
+
 }  // namespace
 
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
                          std::unique_ptr<GraphDef>* graph_def) {
+  return InitializeSession(num_threads, graph, /*device=*/"", session,
+                           graph_def);
+}
+
+Status InitializeSession(int num_threads, const string& graph,
+                         const string& device,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def) {
   LOG(INFO) << "Loading TensorFlow.";
 
   tensorflow::SessionOptions options;
@@ -257,6 +397,11 @@ Status InitializeSession(int num_threads, const string& graph,
     config.set_intra_op_parallelism_threads(num_threads);
     config.set_inter_op_parallelism_threads(num_threads);
   }
+  if (!device.empty()) {
+    // Ops with no kernel on the requested device (e.g. summaries) fall back
+    // to the CPU instead of failing placement.
+    config.set_allow_soft_placement(true);
+  }
   LOG(INFO) << "Got config, " << config.device_count_size() << " devices";
 
   session->reset(tensorflow::NewSession(options));
@@ -272,6 +417,10 @@ Status InitializeSession(int num_threads, const string& graph,
     return s;
   }
 
+  if (!device.empty()) {
+    graph::SetDefaultDevice(device, graph_def->get());
+  }
+
   s = (*session)->Create(*(graph_def->get()));
   if (!s.ok()) {
     LOG(ERROR) << "Could not create TensorFlow Session: " << s;
@@ -374,6 +523,9 @@ int Main(int argc, char** argv) {
   string input_layer_values_string = "";
   string output_layer_string = "output:0";
   string target_layer_string = "";
+  string device = "";
+  string batch_sizes_string = "";
+  bool compare_adapters = false;
   int max_num_runs = 1000;
   string max_time = "10.0";
   string inference_delay = "-1.0";
@@ -403,6 +555,15 @@ int Main(int argc, char** argv) {
            "values to initialize the inputs with"),
       Flag("output_layer", &output_layer_string, "output layer name"),
       Flag("target_layer", &target_layer_string, "target layer name"),
+      Flag("device", &device,
+           "device to place the graph on, e.g. /device:DML:0 (empty lets "
+           "TensorFlow choose)"),
+      Flag("batch_sizes", &batch_sizes_string,
+           "comma-separated batch sizes to sweep; each replaces the leading "
+           "dimension of every input layer"),
+      Flag("compare_adapters", &compare_adapters,
+           "whether to also time the graph on every DML device and print a "
+           "comparison table"),
       Flag("max_num_runs", &max_num_runs, "number of runs max"),
       Flag("max_time", &max_time, "length to run max"),
       Flag("inference_delay", &inference_delay,
@@ -475,6 +636,9 @@ int Main(int argc, char** argv) {
   LOG(INFO) << "Input types: [" << input_layer_type_string << "]";
   LOG(INFO) << "Output layers: [" << output_layer_string << "]";
   LOG(INFO) << "Target layers: [" << target_layer_string << "]";
+  LOG(INFO) << "Device: [" << device << "]";
+  LOG(INFO) << "Batch sizes: [" << batch_sizes_string << "]";
+  LOG(INFO) << "Compare adapters: [" << compare_adapters << "]";
   LOG(INFO) << "Num runs: [" << max_num_runs << "]";
   LOG(INFO) << "Inter-inference delay (seconds): [" << inference_delay << "]";
   LOG(INFO) << "Inter-benchmark delay (seconds): [" << inter_benchmark_delay
@@ -491,7 +655,7 @@ int Main(int argc, char** argv) {
 
   int64 initialization_start_us = Env::Default()->NowMicros();
   Status initialize_status =
-      InitializeSession(num_threads, graph, &session, &graph_def);
+      InitializeSession(num_threads, graph, device, &session, &graph_def);
   int64 initialization_end_us = Env::Default()->NowMicros();
   double initialization_time_s =
       (initialization_end_us - initialization_start_us) / 1000000.0;
@@ -565,6 +729,14 @@ int Main(int argc, char** argv) {
     inputs.push_back(input);
   }
 
+  std::vector<int> batch_size_list;
+  for (const string& size_string : str_util::Split(batch_sizes_string, ',')) {
+    int32 batch_size;
+    CHECK(strings::safe_strto32(size_string, &batch_size))
+        << "Incorrect batch size specified: " << size_string;
+    batch_size_list.push_back(batch_size);
+  }
+
   // If requested, run through the graph first to preinitialize everything
   // before the benchmarking runs.
   int64 warmup_time_us = 0;
@@ -696,6 +868,92 @@ int Main(int argc, char** argv) {
     }
   }
 
+  std::vector<SweepResult> comparison;
+
+  if (!batch_size_list.empty()) {
+    // Sweep the requested batch sizes on the session benchmarked above.
+    SleepSeconds(inter_benchmark_sleep_seconds);
+    Status sweep_status = BenchmarkDevice(
+        device.empty() ? "default" : device,
+        GetDeviceDescription(session.get(), device), batch_size_list,
+        inter_inference_sleep_seconds, max_num_runs,
+        max_benchmark_time_seconds, inputs, output_layers, target_layers,
+        session.get(), &comparison);
+    if (!sweep_status.ok()) {
+      LOG(ERROR) << "Batch size sweep failed with " << sweep_status;
+      return -1;
+    }
+  }
+
+  if (compare_adapters) {
+    // Time the same graph on every DML device, each in its own session with
+    // the whole graph pinned to that device. This only compares end-to-end
+    // times; for per-op GPU times on a single device, use --device together
+    // with the stats pass above (with FULL_TRACE, the DML tracing layer adds
+    // /device:DML:N/stream:all lanes to the step stats).
+    std::vector<string> dml_devices = ListDmlDevices();
+    if (dml_devices.empty()) {
+      LOG(WARNING) << "--compare_adapters was requested but no DML devices "
+                      "are available.";
+    }
+
+    for (const string& dml_device : dml_devices) {
+      SleepSeconds(inter_benchmark_sleep_seconds);
+      LOG(INFO) << "Benchmarking on " << dml_device;
+
+      std::unique_ptr<Session> device_session;
+      std::unique_ptr<GraphDef> device_graph_def;
+      Status device_status =
+          InitializeSession(num_threads, graph, dml_device, &device_session,
+                            &device_graph_def);
+      if (!device_status.ok()) {
+        LOG(ERROR) << "Could not initialize a session on " << dml_device
+                   << ": " << device_status;
+        return -1;
+      }
+
+      if (!init_ops.empty()) {
+        device_status = InitializeVariables(device_session.get(), init_ops);
+        if (!device_status.ok()) {
+          LOG(ERROR) << "Graph variables initialization failed with "
+                     << device_status;
+          return -1;
+        }
+      }
+
+      // Warm up so first-run initialization (kernel compilation, allocator
+      // growth) doesn't skew the comparison.
+      if (warmup_runs > 0) {
+        int64 device_warmup_time_us = 0;
+        int64 device_warmup_runs = 0;
+        device_status = TimeMultipleRuns(
+            inter_inference_sleep_seconds, warmup_runs, -1.0, inputs,
+            output_layers, target_layers, device_session.get(), nullptr,
+            &device_warmup_time_us, &device_warmup_runs);
+        if (!device_status.ok()) {
+          LOG(ERROR) << "Warmup on " << dml_device << " failed with "
+                     << device_status;
+          return -1;
+        }
+      }
+
+      device_status = BenchmarkDevice(
+          dml_device, GetDeviceDescription(device_session.get(), dml_device),
+          batch_size_list, inter_inference_sleep_seconds, max_num_runs,
+          max_benchmark_time_seconds, inputs, output_layers, target_layers,
+          device_session.get(), &comparison);
+      if (!device_status.ok()) {
+        LOG(ERROR) << "Benchmark on " << dml_device << " failed with "
+                   << device_status;
+        return -1;
+      }
+    }
+  }
+
+  if (!comparison.empty()) {
+    PrintComparisonTable(comparison);
+  }
+
   return 0;
 }
 
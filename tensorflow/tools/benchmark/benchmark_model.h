@@ -35,6 +35,15 @@ Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
                          std::unique_ptr<GraphDef>* graph_def);
 
+// Same, but first pins every node without an explicit device assignment to
+// `device` (e.g. "/device:DML:0"), with soft placement enabled so ops with no
+// kernel on that device fall back to the CPU. An empty device leaves
+// placement to TensorFlow.
+Status InitializeSession(int num_threads, const string& graph,
+                         const string& device,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def);
+
 // Does a single run of the model that's been loaded into the given session.
 Status RunBenchmark(const std::vector<InputLayerInfo>& inputs,
                     const std::vector<string>& outputs,